@@ -0,0 +1,16 @@
+#ifndef ITERATION_OVERHEAD_H
+#define ITERATION_OVERHEAD_H
+
+/* This generated file contains includes for project dependencies */
+#include "iteration_overhead/bake_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,74 @@
+#include <iteration_overhead.h>
+#include <stdio.h>
+
+// Queries with only plain And terms on component ids use a specialized
+// iterator that only has to update the table, count and component pointers for
+// each result. Queries that need more (optional terms, bitsets for disabled
+// components, inherited components) use the generic iterator.
+//
+// This example measures the per-table overhead of both iterators by running
+// each query across many tables with a single entity.
+
+#define TABLE_COUNT (1000)
+#define ITERATIONS (10000)
+
+typedef struct {
+    double x, y;
+} Position, Velocity;
+
+typedef struct {
+    double value;
+} Mass;
+
+static
+double measure(ecs_world_t *world, ecs_query_t *q) {
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+
+    for (int i = 0; i < ITERATIONS; i ++) {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        while (ecs_query_next(&it)) {
+            Position *p = ecs_field(&it, Position, 1);
+            Velocity *v = ecs_field(&it, Velocity, 2);
+            for (int j = 0; j < it.count; j ++) {
+                p[j].x += v[j].x;
+                p[j].y += v[j].y;
+            }
+        }
+    }
+
+    // Return nanoseconds per iterated table
+    return ecs_time_measure(&t) * 1000 * 1000 * 1000 / 
+        (ITERATIONS * TABLE_COUNT);
+}
+
+int main(int argc, char *argv[]) {
+    ecs_world_t *world = ecs_init_w_args(argc, argv);
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    // Create one table per entity by adding a unique tag to each entity
+    for (int i = 0; i < TABLE_COUNT; i ++) {
+        ecs_entity_t e = ecs_new_id(world);
+        ecs_set(world, e, Position, {0, 0});
+        ecs_set(world, e, Velocity, {1, 1});
+        ecs_add_id(world, e, ecs_new_id(world));
+    }
+
+    // Only And terms, uses the fast path iterator
+    ecs_query_t *q_trivial = ecs_query_new(world, "Position, Velocity");
+
+    // The optional term requires the generic iterator
+    ecs_query_t *q_generic = ecs_query_new(world, "Position, Velocity, ?Mass");
+
+    printf("trivial query: %.2f ns per table\n", measure(world, q_trivial));
+    printf("generic query: %.2f ns per table\n", measure(world, q_generic));
+
+    // Output (numbers depend on the hardware):
+    //  trivial query: 28.81 ns per table
+    //  generic query: 38.58 ns per table
+
+    return ecs_fini(world);
+}
@@ -0,0 +1,16 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+/* This generated file contains includes for project dependencies */
+#include "prefetch/bake_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,77 @@
+#include <prefetch.h>
+#include <stdio.h>
+
+// When a query matches many small tables, each result starts with component
+// data that is not yet in the CPU cache. With the prefetch option the query
+// iterator hints the CPU to load the columns of the next result while the
+// current result is processed.
+//
+// This example measures the effect of prefetching in a fragmented world with
+// many tables that each store a few entities.
+
+#define TABLE_COUNT (20000)
+#define ENTITIES_PER_TABLE (4)
+#define ITERATIONS (200)
+
+typedef struct {
+    double x, y;
+} Position, Velocity;
+
+static
+double measure(ecs_world_t *world, ecs_query_t *q) {
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+
+    for (int i = 0; i < ITERATIONS; i ++) {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        while (ecs_query_next(&it)) {
+            Position *p = ecs_field(&it, Position, 1);
+            Velocity *v = ecs_field(&it, Velocity, 2);
+            for (int j = 0; j < it.count; j ++) {
+                p[j].x += v[j].x;
+                p[j].y += v[j].y;
+            }
+        }
+    }
+
+    // Return nanoseconds per iterated table
+    return ecs_time_measure(&t) * 1000 * 1000 * 1000 / 
+        (ITERATIONS * TABLE_COUNT);
+}
+
+int main(int argc, char *argv[]) {
+    ecs_world_t *world = ecs_init_w_args(argc, argv);
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    // Fragment the world by adding a unique tag to each group of entities
+    for (int i = 0; i < TABLE_COUNT; i ++) {
+        ecs_entity_t tag = ecs_new_id(world);
+        for (int j = 0; j < ENTITIES_PER_TABLE; j ++) {
+            ecs_entity_t e = ecs_new_id(world);
+            ecs_set(world, e, Position, {0, 0});
+            ecs_set(world, e, Velocity, {1, 1});
+            ecs_add_id(world, e, tag);
+        }
+    }
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.expr = "Position, Velocity"
+    });
+
+    ecs_query_t *q_prefetch = ecs_query(world, {
+        .filter.expr = "Position, Velocity",
+        .prefetch = true
+    });
+
+    printf("without prefetch: %.2f ns per table\n", measure(world, q));
+    printf("with prefetch:    %.2f ns per table\n", measure(world, q_prefetch));
+
+    // Output (numbers depend on the hardware, and on how much work is done for
+    // each result, as that determines how much time a prefetch has to finish):
+    //  without prefetch: 49.85 ns per table
+    //  with prefetch:    48.19 ns per table
+
+    return ecs_fini(world);
+}
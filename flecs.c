@@ -514,6 +514,8 @@ struct ecs_table_t {
     ecs_type_info_t **type_info;     /* Cached type info */
 
     int32_t *dirty_state;            /* Keep track of changes in columns */
+    ecs_vec_t *dirty_rows;           /* Per row dirty state of columns */
+    uint64_t bloom;                  /* Signature of ids (and wildcards) */
 
     int16_t sw_count;
     int16_t sw_offset;
@@ -595,6 +597,7 @@ struct ecs_query_table_match_t {
     ecs_query_table_match_t *next_match;
 
     int32_t *monitor;         /* Used to monitor table for changes */
+    int32_t *changed_monitor; /* Monitor before iterating changed rows */
 };
 
 /** A single table can occur multiple times in the cache when a term matches
@@ -636,6 +639,19 @@ typedef struct ecs_query_allocators_t {
     ecs_block_allocator_t monitors;
 } ecs_query_allocators_t;
 
+/* Profiling counters for query (only collected with FLECS_QUERY_COUNTERS). 
+ * Counters are stored per stage, so that threads iterating the same query
+ * don't write to the same counters. */
+typedef struct ecs_query_counters_t {
+    int64_t table_count;        /* Number of results yielded */
+    int64_t entity_count;       /* Number of entities yielded */
+    int64_t skip_count;         /* Tables skipped without yielding a result */
+    int64_t change_check_count; /* Number of change detection checks */
+    int64_t bytes_touched;      /* Bytes of component data yielded */
+    ecs_ftime_t rematch_time;   /* Time spent rematching tables */
+    ecs_ftime_t sort_time;      /* Time spent sorting tables */
+} ecs_query_counters_t;
+
 /** Query that is automatically matched against tables */
 struct ecs_query_t {
     ecs_header_t hdr;
@@ -674,10 +690,16 @@ struct ecs_query_t {
     ecs_flags32_t flags;
 
     int32_t cascade_by;         /* Identify cascade column */
+    int32_t max_batch;          /* Maximum number of rows per result */
     int32_t match_count;        /* How often have tables been (un)matched */
     int32_t prev_match_count;   /* Track if sorting is needed */
     int32_t rematch_count;      /* Track which tables were added during rematch */
 
+    /* Table matching index */
+    ecs_id_t index_ids[2];      /* Ids under which query is indexed */
+    uint64_t bloom;             /* Signature of ids matched tables must have */
+    int32_t match_event_id;     /* Last table event query was notified for */
+
     /* Mixins */
     ecs_world_t *world;
     ecs_iterable_t iterable;
@@ -784,6 +806,47 @@ typedef struct ecs_cmd_entry_t {
  * threads. Stage pointers can be passed to the world argument of API 
  * operations, which causes the operation to be ran on the stage instead of the
  * world. */
+#ifdef FLECS_TRACING
+/* Event recorded by the tracing addon */
+typedef struct ecs_trace_event_t {
+    uint64_t time;               /* Timestamp in nanoseconds */
+    ecs_entity_t entity;         /* System, observer or pipeline (optional) */
+    int32_t kind;                /* ecs_trace_kind_t */
+    bool begin;                  /* Begin or end of event */
+} ecs_trace_event_t;
+
+/* Ring buffer with trace events. Only the thread of the stage writes to it, so
+ * recording an event doesn't require synchronization. */
+typedef struct ecs_trace_buffer_t {
+    ecs_trace_event_t *events;
+    int32_t size;                /* Number of events (power of 2) */
+    uint64_t head;               /* Total number of recorded events */
+} ecs_trace_buffer_t;
+#endif
+
+#ifdef FLECS_PERF_COUNTERS
+/* Hardware counters collected for a system */
+typedef struct ecs_perf_counters_t {
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t cache_misses;       /* Last level cache misses */
+    uint64_t branch_misses;
+} ecs_perf_counters_t;
+
+#define FLECS_PERF_COUNTER_COUNT\
+    ((int32_t)(sizeof(ecs_perf_counters_t) / sizeof(uint64_t)))
+
+/* Hardware counters of a stage. Counters are opened by the thread that runs
+ * the stage, and only count events for that thread. */
+typedef struct ecs_stage_perf_t {
+    int32_t fd[FLECS_PERF_COUNTER_COUNT];   /* Descriptors (-1 if unavailable) */
+    int32_t slot[FLECS_PERF_COUNTER_COUNT]; /* Index in group read (or -1) */
+    int32_t slot_count;          /* Number of counters in group */
+    bool initialized;            /* Whether counters have been opened */
+    ecs_map_t systems;           /* map<system, ecs_perf_counters_t> */
+} ecs_stage_perf_t;
+#endif
+
 struct ecs_stage_t {
     ecs_header_t hdr;
 
@@ -818,6 +881,18 @@ struct ecs_stage_t {
     /* Thread specific allocators */
     ecs_stage_allocators_t allocators;
     ecs_allocator_t allocator;
+
+#ifdef FLECS_TRACING
+    ecs_trace_buffer_t *trace;   /* Trace events (NULL if not tracing) */
+#endif
+
+#ifdef FLECS_PERF_COUNTERS
+    ecs_stage_perf_t perf;       /* Hardware counters for systems */
+#endif
+
+#ifdef FLECS_QUERY_COUNTERS
+    ecs_map_t query_counters;    /* map<ecs_query_t*, ecs_query_counters_t> */
+#endif
 };
 
 /* Component monitor */
@@ -859,6 +934,11 @@ typedef struct ecs_store_t {
     ecs_vector_t *marked_ids;    /* vector<ecs_marked_ids_t> */
 } ecs_store_t;
 
+/* Thread that reads the world while it is in a reader window */
+typedef struct ecs_reader_t {
+    bool stop;                   /* Set when the reader should stop */
+} ecs_reader_t;
+
 /* fini actions */
 typedef struct ecs_action_elem_t {
     ecs_fini_action_t action;
@@ -903,6 +983,13 @@ struct ecs_world_t {
     /* Used to track when cache needs to be updated */
     ecs_monitor_set_t monitors;    /* map<id, ecs_monitor_t> */
 
+    /* -- Query matching -- */
+    ecs_map_t query_index;         /* map<id, ecs_vec_t<ecs_query_t*>> */
+    ecs_vec_t unindexed_queries;   /* Queries evaluated for each new table */
+    ecs_vec_t pending_queries;     /* Queries created while notifying index */
+    int32_t query_index_notifying; /* Is query index being notified */
+    bool query_index_dirty;        /* Index has queries removed while notifying */
+
     /* -- Systems -- */
     ecs_entity_t pipeline;             /* Current pipeline */
 
@@ -921,6 +1008,13 @@ struct ecs_world_t {
     int32_t workers_running;     /* Number of threads running */
     int32_t workers_waiting;     /* Number of workers waiting on sync */
 
+    /* -- Readers -- */
+    ecs_os_mutex_t reader_mutex; /* Mutex for reader state */
+    ecs_os_cond_t reader_cond;   /* Signal that reader window changed */
+    int32_t reader_count;        /* Number of registered readers */
+    int32_t readers_active;      /* Number of readers accessing the world */
+    bool reader_window_open;     /* Readers may access the world */
+
     /* -- Time management -- */
     ecs_time_t world_start_time; /* Timestamp of simulation start */
     ecs_time_t frame_start_time; /* Timestamp of frame start */
@@ -929,6 +1023,13 @@ struct ecs_world_t {
     /* -- Metrics -- */
     ecs_world_info_t info;
 
+#ifdef FLECS_STATS
+    /* -- Latency histograms -- */
+    ecs_histogram_t frame_time_hist;
+    ecs_histogram_t merge_time_hist;
+    ecs_histogram_t sync_time_hist;
+#endif
+
     /* -- World flags -- */
     ecs_flags32_t flags;
 
@@ -938,6 +1039,11 @@ struct ecs_world_t {
 
     void *context;               /* Application context */
     ecs_vector_t *fini_actions;  /* Callbacks to execute when world exits */
+
+#ifdef FLECS_TRACING
+    int32_t trace_size;          /* Events per stage (0 if not tracing) */
+    uint64_t trace_start;        /* Timestamp when tracing started */
+#endif
 };
 
 #endif
@@ -1043,6 +1149,17 @@ typedef struct ecs_reachable_cache_t {
     ecs_vec_t ids; /* vec<reachable_elem_t> */
 } ecs_reachable_cache_t;
 
+/* Reverse index for relationships with the TargetIndex property. The index
+ * keeps track of which entities (sources) have a pair with a target, and at
+ * which slot a source is stored for a target, so it can be removed in O(1). */
+typedef struct ecs_target_index_t {
+    ecs_map_t sources;    /* map<target, ecs_vec_t<ecs_entity_t>> */
+    ecs_map_t slots;      /* map<pair(source, target), int32_t> */
+    int32_t count;        /* Number of (source, target) pairs in index */
+    ecs_size_t size;      /* Memory used by index, in bytes */
+    ecs_size_t map_size;  /* Memory used by index maps, in bytes */
+} ecs_target_index_t;
+
 /* Payload for id index which contains all datastructures for an id. */
 struct ecs_id_record_t {
     /* Cache with all tables that contain the id. Must be first member. */
@@ -1060,6 +1177,13 @@ struct ecs_id_record_t {
     /* Name lookup index (currently only used for ChildOf pairs) */
     ecs_hashmap_t *name_index;
 
+    /* Target index (only set for (R, *) records with TargetIndex property) */
+    ecs_target_index_t *target_index;
+
+    /* Tables with id sorted by table id, used to intersect the tables of
+     * multiple ids. Not populated for wildcard ids. */
+    ecs_vec_t sorted_tables; /* vec<ecs_table_t*> */
+
     /* Cached pointer to type info for id, if id contains data. */
     const ecs_type_info_t *type_info;
 
@@ -1124,6 +1248,38 @@ ecs_hashmap_t* flecs_id_name_index_get(
     const ecs_world_t *world,
     ecs_id_t id);
 
+/* Ensure (R, *) id record has target index */
+ecs_target_index_t* flecs_target_index_ensure(
+    ecs_world_t *world,
+    ecs_entity_t rel);
+
+/* Free target index of (R, *) id record */
+void flecs_target_index_free(
+    ecs_world_t *world,
+    ecs_id_record_t *idr);
+
+/* Add entities in table to target indices for added ids */
+void flecs_target_index_add(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t row,
+    int32_t count,
+    const ecs_type_t *added);
+
+/* Remove entities in table from target indices for removed ids */
+void flecs_target_index_remove(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t row,
+    int32_t count,
+    const ecs_type_t *removed);
+
+/* Get sources for target from target index */
+const ecs_entity_t* flecs_target_index_get(
+    const ecs_target_index_t *ti,
+    ecs_entity_t target,
+    int32_t *count_out);
+
 /* Find table record for id */
 ecs_table_record_t* flecs_table_record_get(
     const ecs_world_t *world,
@@ -1135,6 +1291,25 @@ const ecs_table_record_t* flecs_id_record_get_table(
     const ecs_id_record_t *idr,
     const ecs_table_t *table);
 
+/* Add table to sorted table list of id record */
+void flecs_id_record_sorted_add(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_table_t *table);
+
+/* Remove table from sorted table list of id record */
+void flecs_id_record_sorted_remove(
+    ecs_id_record_t *idr,
+    const ecs_table_t *table);
+
+/* Find index of first table in sorted table list with id >= table_id, starting
+ * from index. Uses galloping search, which is efficient when subsequent calls
+ * search for increasing table ids. */
+int32_t flecs_id_record_sorted_seek(
+    const ecs_id_record_t *idr,
+    int32_t index,
+    uint64_t table_id);
+
 /* Bootstrap cached id records */
 void flecs_init_id_records(
     ecs_world_t *world);
@@ -1253,6 +1428,10 @@ bool flecs_iter_next_instanced(
     ecs_iter_t *it,
     bool result);
 
+void flecs_offset_iter(
+    ecs_iter_t *it,
+    int32_t offset);
+
 #endif
 
 /**
@@ -1425,7 +1604,25 @@ ecs_table_t *flecs_table_traverse_remove(
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
-    ecs_entity_t component);
+    ecs_entity_t component,
+    int32_t row);
+
+/* Mark range of rows dirty for storage column */
+void flecs_table_mark_rows_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t row,
+    int32_t count);
+
+/* Get signature bit for id */
+uint64_t flecs_id_bloom(
+    ecs_id_t id);
+
+/* Enable tracking which rows changed for each column */
+void flecs_table_track_rows(
+    ecs_world_t *world,
+    ecs_table_t *table);
 
 void flecs_table_notify(
     ecs_world_t *world,
@@ -1712,6 +1909,38 @@ bool flecs_defer_purge(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+/* Register thread that reads the world during reader windows */
+void flecs_reader_register(
+    ecs_world_t *world);
+
+/* Unregister reader. The reader thread must have been joined. */
+void flecs_reader_unregister(
+    ecs_world_t *world);
+
+/* Wait until a reader window is open. Returns false when the reader should
+ * stop. A successful call must be followed up with flecs_reader_end. */
+bool flecs_reader_begin(
+    ecs_world_t *world,
+    ecs_reader_t *reader);
+
+/* Stop accessing the world */
+void flecs_reader_end(
+    ecs_world_t *world);
+
+/* Signal reader that it should stop */
+void flecs_reader_stop(
+    ecs_world_t *world,
+    ecs_reader_t *reader);
+
+/* Allow readers to access the world. Called when the world enters readonly
+ * mode, or while the main thread is idle. */
+void flecs_reader_window_begin(
+    ecs_world_t *world);
+
+/* Disallow readers from accessing the world, waits for active readers */
+void flecs_reader_window_end(
+    ecs_world_t *world);
+
 #endif
 
 /**
@@ -2221,16 +2450,180 @@ bool flecs_filter_match_table(
     int32_t skip_term,
     ecs_flags32_t iter_flags);
 
+/* Number of rows for which predicates are evaluated at a time */
+#define FLECS_ROW_BLOCK_SIZE (64)
+
+/* Callback that can further restrict the rows selected by filter predicates.
+ * Returns false if no rows in this or later blocks can match. */
+typedef bool (*flecs_row_select_action_t)(
+    void *ctx,
+    int32_t row,
+    int32_t count,
+    uint8_t *sel);
+
+/* Find next range of rows in [row, end) for which filter predicates and the
+ * optional select callback pass. Returns the first row of the range, or -1 if
+ * no rows are left. */
+int32_t flecs_filter_rows_next(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_table_t *table,
+    const ecs_id_t *ids,
+    const int32_t *columns,
+    const ecs_entity_t *sources,
+    flecs_row_select_action_t select,
+    void *select_ctx,
+    int32_t *row,
+    int32_t end,
+    int32_t *count_out);
+
 ecs_iter_t flecs_filter_iter_w_flags(
     const ecs_world_t *stage,
     const ecs_filter_t *filter,
     ecs_flags32_t flags);
 
+#ifdef FLECS_META
+/* Initialize iterator for the entities in a member index that can pass the
+ * term predicate. If iter is NULL, this only tests if the index can be used
+ * for the predicate. Returns -1 if the index can't be used. */
+int flecs_member_index_iter_predicate(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    ecs_entity_t component,
+    const ecs_term_predicate_t *pred,
+    ecs_member_index_iter_t *iter);
+
+/* Find next range of consecutive rows in a table for member index iterator */
+bool flecs_member_index_iter_next(
+    const ecs_world_t *world,
+    ecs_member_index_iter_t *iter,
+    ecs_table_t **table_out,
+    int32_t *row_out,
+    int32_t *count_out);
+#endif
+
+#ifdef FLECS_TRACING
+/* Allocate/free trace buffer for stage (called on stage init/fini) */
+void flecs_trace_stage_init(
+    ecs_world_t *world,
+    ecs_stage_t *stage);
+
+void flecs_trace_stage_fini(
+    ecs_stage_t *stage);
+
+/* Record trace event in buffer of stage */
+void flecs_trace_record(
+    ecs_stage_t *stage,
+    ecs_trace_kind_t kind,
+    ecs_entity_t entity,
+    bool begin);
+
+#define flecs_trace_begin(stage, kind, entity)\
+    ((stage)->trace ? flecs_trace_record(stage, kind, entity, true) : (void)0)
+
+#define flecs_trace_end(stage, kind, entity)\
+    ((stage)->trace ? flecs_trace_record(stage, kind, entity, false) : (void)0)
+#else
+#define flecs_trace_stage_init(world, stage)
+#define flecs_trace_stage_fini(stage)
+#define flecs_trace_begin(stage, kind, entity)
+#define flecs_trace_end(stage, kind, entity)
+#endif
+
+#ifdef FLECS_STATS
+/* Add sample (in seconds) to latency histogram */
+void flecs_histogram_record(
+    ecs_histogram_t *hist,
+    ecs_ftime_t value);
+#else
+#define flecs_histogram_record(hist, value)
+#endif
+
+#ifdef FLECS_PERF_COUNTERS
+/* Initialize/free hardware counters of stage (called on stage init/fini) */
+void flecs_perf_stage_init(
+    ecs_stage_t *stage);
+
+void flecs_perf_stage_fini(
+    ecs_stage_t *stage);
+
+/* Read current counter values for the thread of the stage. Returns false if
+ * counters are not available. */
+bool flecs_perf_read(
+    ecs_stage_t *stage,
+    ecs_perf_counters_t *out);
+
+/* Add difference between current counters and begin to counters of system */
+void flecs_perf_record(
+    ecs_stage_t *stage,
+    ecs_entity_t system,
+    const ecs_perf_counters_t *begin);
+
+/* Get sum of hardware counters for system across all stages */
+void flecs_perf_get(
+    const ecs_world_t *world,
+    ecs_entity_t system,
+    ecs_perf_counters_t *out);
+#else
+#define flecs_perf_stage_init(stage)
+#define flecs_perf_stage_fini(stage)
+#endif
+
+#ifdef FLECS_QUERY_COUNTERS
+/* Get profiling counters of query for stage (or world, for stage 0) */
+ecs_query_counters_t* flecs_query_counters(
+    const ecs_world_t *stage,
+    ecs_query_t *query);
+
+/* Sum profiling counters of query across stages */
+void flecs_query_counters_get(
+    const ecs_world_t *world,
+    const ecs_query_t *query,
+    ecs_query_counters_t *out);
+
+/* Add result of iterator to the profiling counters of query */
+void flecs_query_count_result(
+    ecs_query_t *query,
+    const ecs_iter_t *it);
+
+#define flecs_query_counter_add(stage, query, counter, value)\
+    (flecs_query_counters(stage, query)->counter += (value))
+#else
+#define flecs_query_count_result(query, it)
+#define flecs_query_counter_add(stage, query, counter, value)
+#endif
+
+/* Estimate cardinality of filter. When match_vars is true, terms matched on
+ * variables other than This also constrain the estimate (used by rules). */
+ecs_estimate_t flecs_filter_estimate(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter,
+    bool match_vars);
+
+/* Hint the CPU to load memory that will be accessed soon into the cache */
+#if defined(ECS_TARGET_GNU) || defined(ECS_TARGET_CLANG)
+#define flecs_prefetch(ptr) __builtin_prefetch(ptr)
+#elif defined(ECS_TARGET_MSVC) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define flecs_prefetch(ptr) _mm_prefetch((const char*)(ptr), _MM_HINT_T0)
+#else
+#define flecs_prefetch(ptr) ((void)(ptr))
+#endif
+
 void flecs_query_notify(
     ecs_world_t *world,
     ecs_query_t *query,
     ecs_query_event_t *event);
 
+/* Notify queries that can match the event table */
+void flecs_query_index_notify(
+    ecs_world_t *world,
+    ecs_query_event_t *event);
+
+/* Free resources of query index */
+void flecs_query_index_fini(
+    ecs_world_t *world);
+
 ecs_id_t flecs_to_public_id(
     ecs_id_t id);
 
@@ -2335,11 +2728,19 @@ int flecs_entity_compare_qsort(
     const void *e1,
     const void *e2);
 
-/* Convert floating point to string */
-char * ecs_ftoa(
+/* Convert integer to string, returns pointer to end of string. The buffer must
+ * be able to hold at least 21 characters. */
+char* flecs_itoa(
+    char *buf,
+    int64_t v);
+
+/* Convert floating point to string, returns pointer to end of string. The
+ * buffer must be able to hold at least 64 characters. */
+char* flecs_ftoa(
+    char *buf,
     double f, 
-    char * buf, 
-    int precision);
+    int precision,
+    char nan_delim);
 
 uint64_t flecs_string_hash(
     const void *ptr);
@@ -2782,6 +3183,13 @@ void flecs_table_append_to_records(
     ecs_assert(tr->hdr.cache != NULL, ECS_INTERNAL_ERROR, NULL);
 }
 
+uint64_t flecs_id_bloom(
+    ecs_id_t id)
+{
+    /* Fibonacci hashing, use the upper 6 bits to select one of 64 bits */
+    return 1ull << ((id * 0x9E3779B97F4A7C15ull) >> 58);
+}
+
 void flecs_table_init(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -2997,8 +3405,19 @@ void flecs_table_init(
         /* Claim id record so it stays alive as long as the table exists */
         flecs_id_record_claim(world, idr);
 
+        /* Add table to list used for intersecting tables of ids */
+        flecs_id_record_sorted_add(world, idr, table);
+
+        /* Add id to signature used to quickly reject queries */
+        table->bloom |= flecs_id_bloom(idr->id);
+
         /* Initialize event flags */
         table->flags |= idr->flags & EcsIdEventMask;
+
+        /* Initialize relationship index flags */
+        if (idr->flags & EcsIdTargetIndex) {
+            table->flags |= EcsTableHasTargetIndex;
+        }
     }
 
     world->store.records = records;
@@ -3025,6 +3444,7 @@ void flecs_table_records_unregister(
         (void)id;
 
         ecs_table_cache_remove(cache, table, &tr->hdr);
+        flecs_id_record_sorted_remove((ecs_id_record_t*)cache, table);
         flecs_id_record_release(world, (ecs_id_record_t*)cache);
     }
 
@@ -3288,6 +3708,123 @@ void flecs_dtor_all_components(
     }
 }
 
+/* Add row dirty state for new rows. New rows are marked as changed for all
+ * columns by incrementing the column dirty state. */
+static
+void flecs_table_dirty_rows_add(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count)
+{
+    ecs_vec_t *rows = table->dirty_rows;
+    if (!rows || !count) {
+        return;
+    }
+
+    int32_t c, column_count = table->storage_count;
+    int32_t *dirty_state = table->dirty_state;
+    for (c = 0; c < column_count; c ++) {
+        dirty_state[c + 1] ++;
+    }
+
+    ecs_size_t size = column_count * ECS_SIZEOF(int32_t);
+    int32_t i, *states = ecs_vec_grow(&world->allocator, rows, size, count);
+    for (i = 0; i < count; i ++) {
+        ecs_os_memcpy(&states[i * column_count], &dirty_state[1], size);
+    }
+}
+
+/* Make sure that the row dirty state has an element for each row in table */
+static
+void flecs_table_dirty_rows_sync(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_vec_t *rows = table->dirty_rows;
+    if (!rows) {
+        return;
+    }
+
+    int32_t count = table->data.entities.count;
+    int32_t row_count = ecs_vec_count(rows);
+    if (row_count < count) {
+        flecs_table_dirty_rows_add(world, table, count - row_count);
+    } else if (row_count > count) {
+        ecs_vec_set_count(&world->allocator, rows, 
+            table->storage_count * ECS_SIZEOF(int32_t), count);
+    }
+}
+
+static
+void flecs_table_dirty_rows_fini(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_vec_t *rows = table->dirty_rows;
+    if (rows) {
+        ecs_vec_fini(&world->allocator, rows, 
+            table->storage_count * ECS_SIZEOF(int32_t));
+        flecs_free_t(&world->allocator, ecs_vec_t, rows);
+        table->dirty_rows = NULL;
+    }
+}
+
+void flecs_table_track_rows(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    if (table->dirty_rows || !table->storage_count) {
+        return;
+    }
+
+    /* Existing rows get the current column state, which means that they are
+     * only reported as changed to queries that haven't seen the columns yet */
+    int32_t i, count = ecs_table_count(table);
+    int32_t column_count = table->storage_count;
+    ecs_size_t size = column_count * ECS_SIZEOF(int32_t);
+    int32_t *dirty_state = flecs_table_get_dirty_state(world, table);
+    ecs_vec_t *rows = table->dirty_rows = flecs_alloc_t(
+        &world->allocator, ecs_vec_t);
+    ecs_vec_init(&world->allocator, rows, size, count);
+    if (!count) {
+        return;
+    }
+
+    int32_t *states = ecs_vec_grow(&world->allocator, rows, size, count);
+    for (i = 0; i < count; i ++) {
+        ecs_os_memcpy(&states[i * column_count], &dirty_state[1], size);
+    }
+}
+
+void flecs_table_mark_rows_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t row,
+    int32_t count)
+{
+    ecs_assert(column >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(column < table->storage_count, ECS_INTERNAL_ERROR, NULL);
+    (void)world;
+
+    int32_t *dirty_state = table->dirty_state;
+    if (!dirty_state) {
+        return;
+    }
+
+    int32_t state = ++ dirty_state[column + 1];
+    ecs_vec_t *rows = table->dirty_rows;
+    if (rows) {
+        ecs_assert(row + count <= ecs_vec_count(rows), 
+            ECS_INTERNAL_ERROR, NULL);
+        int32_t i, column_count = table->storage_count;
+        int32_t *states = ecs_vec_first(rows);
+        for (i = row; i < row + count; i ++) {
+            states[i * column_count + column] = state;
+        }
+    }
+}
+
 static
 void flecs_table_fini_data(
     ecs_world_t *world,
@@ -3355,6 +3892,10 @@ void flecs_table_fini_data(
     ecs_vec_fini_t(&world->allocator, &data->entities, ecs_entity_t);
     ecs_vec_fini_t(&world->allocator, &data->records, ecs_record_t*);
 
+    if (data == &table->data) {
+        flecs_table_dirty_rows_sync(world, table);
+    }
+
     if (deactivate && count) {
         flecs_table_set_empty(world, table);
     }
@@ -3453,6 +3994,7 @@ void flecs_table_free(
         flecs_hashmap_remove(&world->store.table_map, &ids, ecs_table_t*);
     }
 
+    flecs_table_dirty_rows_fini(world, table);
     flecs_wfree_n(world, int32_t, table->storage_count + 1, table->dirty_state);
     flecs_wfree_n(world, int32_t, table->storage_count + table->type.count, 
         table->storage_map);
@@ -3562,7 +4104,8 @@ void flecs_table_mark_table_dirty(
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
-    ecs_entity_t component)
+    ecs_entity_t component,
+    int32_t row)
 {
     ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
     ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -3570,7 +4113,7 @@ void flecs_table_mark_dirty(
     if (table->dirty_state) {
         int32_t index = ecs_search(world, table->storage_table, component, 0);
         ecs_assert(index != -1, ECS_INTERNAL_ERROR, NULL);
-        table->dirty_state[index + 1] ++;
+        flecs_table_mark_rows_dirty(world, table, index, row, 1);
     }
 }
 
@@ -3851,6 +4394,9 @@ int32_t flecs_table_grow_data(
 
     /* If the table is monitored indicate that there has been a change */
     flecs_table_mark_table_dirty(world, table, 0);
+    if (data == &table->data) {
+        flecs_table_dirty_rows_add(world, table, to_add);
+    }
 
     if (!(world->flags & EcsWorldReadonly) && !cur_count) {
         flecs_table_set_empty(world, table);
@@ -3910,6 +4456,7 @@ int32_t flecs_table_append(
  
     /* If the table is monitored indicate that there has been a change */
     flecs_table_mark_table_dirty(world, table, 0);
+    flecs_table_dirty_rows_add(world, table, 1);
     ecs_assert(count >= 0, ECS_INTERNAL_ERROR, NULL);
 
     ecs_type_info_t **type_info = table->type_info;
@@ -4049,7 +4596,11 @@ void flecs_table_delete(
     }     
 
     /* If the table is monitored indicate that there has been a change */
-    flecs_table_mark_table_dirty(world, table, 0);    
+    flecs_table_mark_table_dirty(world, table, 0);
+    if (table->dirty_rows) {
+        ecs_vec_remove(table->dirty_rows, 
+            table->storage_count * ECS_SIZEOF(int32_t), index);
+    }
 
     /* If table is empty, deactivate it */
     if (!count) {
@@ -4403,6 +4954,29 @@ void flecs_table_swap_bitset_columns(
     }
 }
 
+static
+void flecs_table_swap_dirty_rows(
+    ecs_table_t *table,
+    int32_t row_1,
+    int32_t row_2)
+{
+    ecs_vec_t *rows = table->dirty_rows;
+    if (!rows) {
+        return;
+    }
+
+    int32_t c, column_count = table->storage_count;
+    int32_t *states_1 = ecs_vec_get(rows, 
+        column_count * ECS_SIZEOF(int32_t), row_1);
+    int32_t *states_2 = ecs_vec_get(rows, 
+        column_count * ECS_SIZEOF(int32_t), row_2);
+    for (c = 0; c < column_count; c ++) {
+        int32_t tmp = states_1[c];
+        states_1[c] = states_2[c];
+        states_2[c] = tmp;
+    }
+}
+
 void flecs_table_swap(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -4449,6 +5023,7 @@ void flecs_table_swap(
 
     flecs_table_swap_switch_columns(table, &table->data, row_1, row_2);
     flecs_table_swap_bitset_columns(table, &table->data, row_1, row_2);  
+    flecs_table_swap_dirty_rows(table, row_1, row_2);
 
     ecs_vec_t *columns = table->data.columns;
     if (!columns) {
@@ -4697,6 +5272,18 @@ void flecs_table_merge(
             src_data, dst_data);
     }
 
+    if (move_data) {
+        /* Moved data replaces the rows of the table */
+        if (dst_table->dirty_rows) {
+            ecs_vec_clear(dst_table->dirty_rows);
+        }
+    }
+
+    flecs_table_dirty_rows_sync(world, dst_table);
+    if (src_table != dst_table) {
+        flecs_table_dirty_rows_sync(world, src_table);
+    }
+
     if (src_count) {
         if (!dst_count) {
             flecs_table_set_empty(world, dst_table);
@@ -4732,6 +5319,12 @@ void flecs_table_replace_data(
         flecs_table_init_data(world, table);
     }
 
+    /* Replaced rows are reported as changed */
+    if (table->dirty_rows) {
+        ecs_vec_clear(table->dirty_rows);
+        flecs_table_dirty_rows_sync(world, table);
+    }
+
     int32_t count = ecs_table_count(table);
 
     if (!prev_count && count) {
@@ -5749,6 +6342,10 @@ void flecs_notify_on_add(
             flecs_set_union(world, table, row, count, added);
         }
 
+        if (table_flags & EcsTableHasTargetIndex) {
+            flecs_target_index_add(world, table, row, count, added);
+        }
+
         if (table_flags & (EcsTableHasOnAdd|EcsTableHasIsA|EcsTableHasObserved)) {
             flecs_emit(world, world, &(ecs_event_desc_t){
                 .event = EcsOnAdd,
@@ -5788,6 +6385,10 @@ void flecs_notify_on_remove(
             .observable = world
         });
     }
+
+    if (removed->count && (table->flags & EcsTableHasTargetIndex)) {
+        flecs_target_index_remove(world, table, row, count, removed);
+    }
 }
 
 static
@@ -8077,7 +8678,7 @@ void flecs_modified_id_if(
     ecs_type_t ids = { .array = &id, .count = 1 };
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
-    flecs_table_mark_dirty(world, table, id);
+    flecs_table_mark_dirty(world, table, id, ECS_RECORD_TO_ROW(r->row));
     flecs_defer_end(world, stage);
 error:
     return;
@@ -8109,7 +8710,7 @@ void ecs_modified_id(
     ecs_type_t ids = { .array = &id, .count = 1 };
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
-    flecs_table_mark_dirty(world, table, id);
+    flecs_table_mark_dirty(world, table, id, ECS_RECORD_TO_ROW(r->row));
     flecs_defer_end(world, stage);
 error:
     return;
@@ -8146,7 +8747,7 @@ void flecs_copy_ptr_w_id(
         ecs_os_memset(dst.ptr, 0, size);
     }
 
-    flecs_table_mark_dirty(world, r->table, id);
+    flecs_table_mark_dirty(world, r->table, id, ECS_RECORD_TO_ROW(r->row));
 
     ecs_table_t *table = r->table;
     if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
@@ -8194,7 +8795,7 @@ void flecs_move_ptr_w_id(
         ecs_os_memcpy(dst.ptr, ptr, flecs_utosize(size));
     }
 
-    flecs_table_mark_dirty(world, r->table, id);
+    flecs_table_mark_dirty(world, r->table, id, ECS_RECORD_TO_ROW(r->row));
 
     if (cmd_kind == EcsOpSet) {
         ecs_table_t *table = r->table;
@@ -8449,6 +9050,31 @@ ecs_entity_t ecs_get_target_for_id(
     }
 }
 
+const ecs_entity_t* ecs_get_sources(
+    const ecs_world_t *world,
+    ecs_entity_t rel,
+    ecs_entity_t target,
+    int32_t *count_out)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(rel != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(target != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count_out != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    world = ecs_get_world(world);
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, 
+        ecs_pair(rel, EcsWildcard));
+    if (!idr || !idr->target_index) {
+        *count_out = 0;
+        return NULL;
+    }
+
+    return flecs_target_index_get(idr->target_index, target, count_out);
+error:
+    return NULL;
+}
+
 static
 const char* flecs_get_identifier(
     const ecs_world_t *world,
@@ -9597,6 +10223,8 @@ void flecs_stages_merge(
         ecs_os_get_time(&t_start);
     }
 
+    flecs_trace_begin(stage, EcsTraceMerge, 0);
+
     ecs_dbg_3("#[magenta]merge");
     ecs_log_push_3();
 
@@ -9625,7 +10253,9 @@ void flecs_stages_merge(
     flecs_eval_component_monitors(world);
 
     if (measure_frame_time) {
-        world->info.merge_time_total += (float)ecs_time_measure(&t_start);
+        ecs_ftime_t merge_time = (ecs_ftime_t)ecs_time_measure(&t_start);
+        world->info.merge_time_total += merge_time;
+        flecs_histogram_record(&world->merge_time_hist, merge_time);
     }
 
     world->info.merge_count_total ++; 
@@ -9636,6 +10266,8 @@ void flecs_stages_merge(
     }
     
     ecs_log_pop_3();
+
+    flecs_trace_end(stage, EcsTraceMerge, 0);
 }
 
 static
@@ -10009,6 +10641,14 @@ void flecs_stage_init(
     ecs_vec_init_t(&stage->allocator, &stage->commands, ecs_cmd_t, 0);
     flecs_sparse_init(&stage->cmd_entries, &stage->allocator,
         &stage->allocators.cmd_entry_chunk, ecs_cmd_entry_t);
+
+    flecs_trace_stage_init(world, stage);
+    flecs_perf_stage_init(stage);
+
+#ifdef FLECS_QUERY_COUNTERS
+    ecs_map_init(&stage->query_counters, ecs_query_counters_t, 
+        &stage->allocator, 0);
+#endif
 }
 
 void flecs_stage_fini(
@@ -10024,6 +10664,11 @@ void flecs_stage_fini(
 
     ecs_poly_fini(stage, ecs_stage_t);
 
+    flecs_trace_stage_fini(stage);
+    flecs_perf_stage_fini(stage);
+#ifdef FLECS_QUERY_COUNTERS
+    ecs_map_fini(&stage->query_counters);
+#endif
     flecs_sparse_fini(&stage->cmd_entries);
 
     ecs_vec_fini_t(&stage->allocator, &stage->commands, ecs_cmd_t);
@@ -10140,6 +10785,106 @@ error:
     return NULL;
 }
 
+void flecs_reader_register(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(ecs_os_has_threading(), ECS_MISSING_OS_API, "threading");
+
+    if (!world->reader_count) {
+        world->reader_mutex = ecs_os_mutex_new();
+        world->reader_cond = ecs_os_cond_new();
+    }
+    world->reader_count ++;
+error:
+    return;
+}
+
+void flecs_reader_unregister(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_assert(world->reader_count > 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(world->readers_active == 0, ECS_INTERNAL_ERROR, NULL);
+
+    if (!(-- world->reader_count)) {
+        ecs_os_cond_free(world->reader_cond);
+        ecs_os_mutex_free(world->reader_mutex);
+        world->reader_window_open = false;
+    }
+}
+
+bool flecs_reader_begin(
+    ecs_world_t *world,
+    ecs_reader_t *reader)
+{
+    ecs_os_mutex_lock(world->reader_mutex);
+
+    while (!reader->stop && !world->reader_window_open) {
+        ecs_os_cond_wait(world->reader_cond, world->reader_mutex);
+    }
+
+    bool result = !reader->stop;
+    if (result) {
+        world->readers_active ++;
+    }
+
+    ecs_os_mutex_unlock(world->reader_mutex);
+    return result;
+}
+
+void flecs_reader_end(
+    ecs_world_t *world)
+{
+    ecs_os_mutex_lock(world->reader_mutex);
+    ecs_assert(world->readers_active > 0, ECS_INTERNAL_ERROR, NULL);
+    if (!(-- world->readers_active)) {
+        ecs_os_cond_broadcast(world->reader_cond);
+    }
+    ecs_os_mutex_unlock(world->reader_mutex);
+}
+
+void flecs_reader_stop(
+    ecs_world_t *world,
+    ecs_reader_t *reader)
+{
+    ecs_os_mutex_lock(world->reader_mutex);
+    reader->stop = true;
+    ecs_os_cond_broadcast(world->reader_cond);
+    ecs_os_mutex_unlock(world->reader_mutex);
+}
+
+void flecs_reader_window_begin(
+    ecs_world_t *world)
+{
+    if (!world->reader_count) {
+        return;
+    }
+
+    ecs_os_mutex_lock(world->reader_mutex);
+    if (!world->reader_window_open) {
+        world->reader_window_open = true;
+        ecs_os_cond_broadcast(world->reader_cond);
+    }
+    ecs_os_mutex_unlock(world->reader_mutex);
+}
+
+void flecs_reader_window_end(
+    ecs_world_t *world)
+{
+    if (!world->reader_count) {
+        return;
+    }
+
+    /* Readers can't be interrupted, wait until active readers are done */
+    ecs_os_mutex_lock(world->reader_mutex);
+    world->reader_window_open = false;
+    while (world->readers_active) {
+        ecs_os_cond_wait(world->reader_cond, world->reader_mutex);
+    }
+    ecs_os_mutex_unlock(world->reader_mutex);
+}
+
 bool ecs_readonly_begin(
     ecs_world_t *world)
 {
@@ -10173,6 +10918,9 @@ bool ecs_readonly_begin(
         ECS_BIT_SET(world->flags, EcsWorldMultiThreaded);
     }
 
+    /* Structural changes are deferred, so readers can access the world */
+    flecs_reader_window_begin(world);
+
     return is_readonly;
 }
 
@@ -10182,6 +10930,8 @@ void ecs_readonly_end(
     ecs_poly_assert(world, ecs_world_t);
     ecs_check(world->flags & EcsWorldReadonly, ECS_INVALID_OPERATION, NULL);
 
+    flecs_reader_window_end(world);
+
     /* After this it is safe again to mutate the world directly */
     ECS_BIT_CLEAR(world->flags, EcsWorldReadonly);
     ECS_BIT_CLEAR(world->flags, EcsWorldMultiThreaded);
@@ -10306,6 +11056,241 @@ error:
     return false;
 }
 
+/**
+ * @file perf_counters.c
+ * @brief Hardware counters for systems (only with FLECS_PERF_COUNTERS).
+ *
+ * Counters are read with perf_event_open, which is only available on Linux.
+ * Each stage opens its own counters from the thread that runs the stage, and
+ * stores the counters per system. This means that counting doesn't require
+ * synchronization between worker threads. When counters can't be opened (for
+ * example because the platform is not Linux, the CPU doesn't expose hardware
+ * events or permission is denied) all counters are reported as 0.
+ */
+
+/* syscall is not declared when only _POSIX_C_SOURCE is defined */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+
+#ifdef FLECS_PERF_COUNTERS
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+static const uint64_t flecs_perf_config[] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static
+int32_t flecs_perf_open(
+    uint64_t config,
+    int32_t group_fd)
+{
+    struct perf_event_attr attr;
+    ecs_os_memset_t(&attr, 0, struct perf_event_attr);
+    attr.size = sizeof(struct perf_event_attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    /* pid = 0, cpu = -1: count events for calling thread on any CPU */
+    return (int32_t)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static
+void flecs_perf_stage_open(
+    ecs_stage_t *stage)
+{
+    ecs_stage_perf_t *perf = &stage->perf;
+    int32_t i, leader = -1, err = 0;
+
+    for (i = 0; i < FLECS_PERF_COUNTER_COUNT; i ++) {
+        int32_t fd = flecs_perf_open(flecs_perf_config[i], leader);
+        if (fd == -1) {
+            if (!err) {
+                err = errno;
+            }
+            continue;
+        }
+
+        /* First counter that opens successfully becomes the group leader, so
+         * that all counters can be read with a single system call. */
+        if (leader == -1) {
+            leader = fd;
+        }
+
+        perf->fd[i] = fd;
+        perf->slot[i] = perf->slot_count ++;
+    }
+
+    if (err) {
+        ecs_warn("perf counters: not all counters are available for "
+            "stage %d (%s)", stage->id, strerror(err));
+    }
+}
+
+static
+void flecs_perf_stage_close(
+    ecs_stage_t *stage)
+{
+    int32_t i;
+    for (i = 0; i < FLECS_PERF_COUNTER_COUNT; i ++) {
+        if (stage->perf.fd[i] != -1) {
+            close(stage->perf.fd[i]);
+        }
+    }
+}
+
+static
+bool flecs_perf_stage_read(
+    ecs_stage_t *stage,
+    uint64_t *values)
+{
+    ecs_stage_perf_t *perf = &stage->perf;
+    if (!perf->slot_count) {
+        return false;
+    }
+
+    int32_t i, leader = -1;
+    for (i = 0; i < FLECS_PERF_COUNTER_COUNT; i ++) {
+        if (perf->slot[i] == 0) {
+            leader = perf->fd[i];
+            break;
+        }
+    }
+
+    /* Layout of group read is { nr, values[nr] } */
+    uint64_t buf[1 + FLECS_PERF_COUNTER_COUNT];
+    ssize_t size = (ssize_t)(ECS_SIZEOF(uint64_t) * (1 + perf->slot_count));
+    if (read(leader, buf, (size_t)size) != size) {
+        return false;
+    }
+
+    for (i = 0; i < FLECS_PERF_COUNTER_COUNT; i ++) {
+        int32_t slot = perf->slot[i];
+        values[i] = slot != -1 ? buf[1 + slot] : 0;
+    }
+
+    return true;
+}
+
+#else
+
+static
+void flecs_perf_stage_open(
+    ecs_stage_t *stage)
+{
+    ecs_warn("perf counters: not supported on this platform (stage %d)",
+        stage->id);
+}
+
+static
+void flecs_perf_stage_close(
+    ecs_stage_t *stage)
+{
+    (void)stage;
+}
+
+static
+bool flecs_perf_stage_read(
+    ecs_stage_t *stage,
+    uint64_t *values)
+{
+    (void)stage;
+    (void)values;
+    return false;
+}
+
+#endif
+
+void flecs_perf_stage_init(
+    ecs_stage_t *stage)
+{
+    ecs_stage_perf_t *perf = &stage->perf;
+    int32_t i;
+    for (i = 0; i < FLECS_PERF_COUNTER_COUNT; i ++) {
+        perf->fd[i] = -1;
+        perf->slot[i] = -1;
+    }
+    perf->slot_count = 0;
+    perf->initialized = false;
+    ecs_map_init(&perf->systems, ecs_perf_counters_t, &stage->allocator, 0);
+}
+
+void flecs_perf_stage_fini(
+    ecs_stage_t *stage)
+{
+    if (stage->perf.initialized) {
+        flecs_perf_stage_close(stage);
+    }
+    ecs_map_fini(&stage->perf.systems);
+}
+
+bool flecs_perf_read(
+    ecs_stage_t *stage,
+    ecs_perf_counters_t *out)
+{
+    /* Counters must be opened by the thread that reads them, which is why they
+     * are opened on first use instead of when the stage is created. */
+    if (!stage->perf.initialized) {
+        flecs_perf_stage_open(stage);
+        stage->perf.initialized = true;
+    }
+
+    return flecs_perf_stage_read(stage, (uint64_t*)out);
+}
+
+void flecs_perf_record(
+    ecs_stage_t *stage,
+    ecs_entity_t system,
+    const ecs_perf_counters_t *begin)
+{
+    ecs_perf_counters_t end;
+    if (!flecs_perf_stage_read(stage, (uint64_t*)&end)) {
+        return;
+    }
+
+    ecs_perf_counters_t *dst = ecs_map_ensure(
+        &stage->perf.systems, ecs_perf_counters_t, system);
+    dst->cycles += end.cycles - begin->cycles;
+    dst->instructions += end.instructions - begin->instructions;
+    dst->cache_misses += end.cache_misses - begin->cache_misses;
+    dst->branch_misses += end.branch_misses - begin->branch_misses;
+}
+
+void flecs_perf_get(
+    const ecs_world_t *world,
+    ecs_entity_t system,
+    ecs_perf_counters_t *out)
+{
+    ecs_os_zeromem(out);
+
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        const ecs_perf_counters_t *src = ecs_map_get(
+            &world->stages[i].perf.systems, ecs_perf_counters_t, system);
+        if (src) {
+            out->cycles += src->cycles;
+            out->instructions += src->instructions;
+            out->cache_misses += src->cache_misses;
+            out->branch_misses += src->branch_misses;
+        }
+    }
+}
+
+#endif
+
 
 static
 ecs_size_t flecs_allocator_size(
@@ -12868,8 +13853,7 @@ static const double rounders[MAX_PRECISION + 1] =
 	0.00000000005		// 10
 };
 
-static
-char* flecs_strbuf_itoa(
+char* flecs_itoa(
     char *buf,
     int64_t v)
 {
@@ -12880,19 +13864,21 @@ char* flecs_strbuf_itoa(
 	if (!v) {
 		*ptr++ = '0';
     } else {
+        /* Negate as unsigned, so that INT64_MIN doesn't overflow */
+        uint64_t uv = (uint64_t)v;
         if (v < 0) {
             ptr[0] = '-';
             ptr ++;
-            v *= -1;
+            uv = 0 - uv;
         }
 
 		char *p = ptr;
-		while (v) {
-            int64_t vdiv = v / 10;
-            int64_t vmod = v - (vdiv * 10);
+		while (uv) {
+            uint64_t vdiv = uv / 10;
+            uint64_t vmod = uv - (vdiv * 10);
 			p[0] = (char)('0' + vmod);
             p ++;
-			v = vdiv;
+			uv = vdiv;
 		}
 
 		p1 = p;
@@ -12908,35 +13894,38 @@ char* flecs_strbuf_itoa(
 }
 
 static
-int flecs_strbuf_ftoa(
-    ecs_strbuf_t *out, 
+char* flecs_ftoa_special(
+    char *ptr,
+    const char *value,
+    char nan_delim)
+{
+    if (nan_delim) {
+        *ptr++ = nan_delim;
+    }
+    ecs_os_memcpy(ptr, value, 3);
+    ptr += 3;
+    if (nan_delim) {
+        *ptr++ = nan_delim;
+    }
+    return ptr;
+}
+
+char* flecs_ftoa(
+    char *buf,
     double f, 
     int precision,
     char nan_delim)
 {
-    char buf[64];
 	char * ptr = buf;
 	char c;
 	int64_t intPart;
     int64_t exp = 0;
 
     if (isnan(f)) {
-        if (nan_delim) {
-            ecs_strbuf_appendch(out, nan_delim);
-            ecs_strbuf_appendlit(out, "NaN");
-            return ecs_strbuf_appendch(out, nan_delim);
-        } else {
-            return ecs_strbuf_appendlit(out, "NaN");
-        }
+        return flecs_ftoa_special(buf, "NaN", nan_delim);
     }
     if (isinf(f)) {
-        if (nan_delim) {
-            ecs_strbuf_appendch(out, nan_delim);
-            ecs_strbuf_appendlit(out, "Inf");
-            return ecs_strbuf_appendch(out, nan_delim);
-        } else {
-            return ecs_strbuf_appendlit(out, "Inf");
-        }
+        return flecs_ftoa_special(buf, "Inf", nan_delim);
     }
 
 	if (precision > MAX_PRECISION) {
@@ -12971,7 +13960,7 @@ int flecs_strbuf_ftoa(
 	intPart = (int64_t)f;
 	f -= (double)intPart;
 
-    ptr = flecs_strbuf_itoa(ptr, intPart);
+    ptr = flecs_itoa(ptr, intPart);
 
 	if (precision) {
 		*ptr++ = '.';
@@ -13033,7 +14022,7 @@ int flecs_strbuf_ftoa(
 
 
         ptr[0] = 'e';
-        ptr = flecs_strbuf_itoa(ptr + 1, exp);
+        ptr = flecs_itoa(ptr + 1, exp);
 
         if (nan_delim) {
             ptr[0] = nan_delim;
@@ -13043,6 +14032,18 @@ int flecs_strbuf_ftoa(
         ptr[0] = '\0';
     }
     
+    return ptr;
+}
+
+static
+int flecs_strbuf_ftoa(
+    ecs_strbuf_t *out, 
+    double f, 
+    int precision,
+    char nan_delim)
+{
+    char buf[64];
+    char *ptr = flecs_ftoa(buf, f, precision, nan_delim);
     return ecs_strbuf_appendstrn(out, buf, (int32_t)(ptr - buf));
 }
 
@@ -13332,6 +14333,51 @@ bool ecs_strbuf_appendstrn(
     return flecs_strbuf_appendstr(b, str, len);
 }
 
+bool ecs_strbuf_appendbin(
+    ecs_strbuf_t *b,
+    const void* data,
+    int32_t n)
+{
+    ecs_assert(b != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(data != NULL || !n, ECS_INVALID_PARAMETER, NULL);
+    flecs_strbuf_init(b);
+
+    int32_t memLeftInElement = flecs_strbuf_memLeftInCurrentElement(b);
+    int32_t memLeft = flecs_strbuf_memLeft(b);
+    if (memLeft <= 0) {
+        return false;
+    }
+
+    /* Never write more than what the buffer can store */
+    if (n > memLeft) {
+        n = memLeft;
+    }
+
+    /* Same as flecs_strbuf_appendstr, but data can contain \0 characters */
+    const char *ptr = data;
+    if (n <= memLeftInElement) {
+        ecs_os_memcpy(flecs_strbuf_ptr(b), ptr, n);
+        b->current->pos += n;
+    } else {
+        ecs_os_memcpy(flecs_strbuf_ptr(b), ptr, memLeftInElement);
+        b->current->pos += memLeftInElement;
+        ptr += memLeftInElement;
+        n -= memLeftInElement;
+
+        if (n < ECS_STRBUF_ELEMENT_SIZE) {
+            flecs_strbuf_grow(b);
+            ecs_os_memcpy(flecs_strbuf_ptr(b), ptr, n);
+            b->current->pos += n;
+        } else {
+            char *remainder = ecs_os_malloc(n);
+            ecs_os_memcpy(remainder, ptr, n);
+            flecs_strbuf_grow_str(b, remainder, remainder, n);
+        }
+    }
+
+    return flecs_strbuf_memLeft(b) > 0;
+}
+
 bool ecs_strbuf_appendch(
     ecs_strbuf_t *b,
     char ch)
@@ -13346,7 +14392,7 @@ bool ecs_strbuf_appendint(
 {
     ecs_assert(b != NULL, ECS_INVALID_PARAMETER, NULL); 
     char numbuf[32];
-    char *ptr = flecs_strbuf_itoa(numbuf, v);
+    char *ptr = flecs_itoa(numbuf, v);
     return ecs_strbuf_appendstrn(b, numbuf, flecs_ito(int32_t, ptr - numbuf));
 }
 
@@ -13398,16 +14444,30 @@ bool ecs_strbuf_mergebuff(
     if (src_buffer->elementCount) {
         if (src_buffer->buf) {
             return ecs_strbuf_appendstrn(
-                dst_buffer, src_buffer->buf, src_buffer->length);
+                dst_buffer, src_buffer->buf, src_buffer->current->pos);
         } else {
             ecs_strbuf_element *e = (ecs_strbuf_element*)&src_buffer->firstElement;
 
             /* Copy first element as it is inlined in the src buffer */
             ecs_strbuf_appendstrn(dst_buffer, e->buf, e->pos);
 
-            while ((e = e->next)) {
-                dst_buffer->current->next = ecs_os_malloc(sizeof(ecs_strbuf_element));
-                *dst_buffer->current->next = *e;
+            if (e->next) {
+                if (dst_buffer->buf) {
+                    /* Can't link elements into application buffer */
+                    while ((e = e->next)) {
+                        ecs_strbuf_appendstrn(dst_buffer, e->buf, e->pos);
+                    }
+                    ecs_strbuf_reset(src_buffer);
+                    return true;
+                }
+
+                /* Move remaining elements to the destination buffer */
+                flecs_strbuf_init(dst_buffer);
+                dst_buffer->size += dst_buffer->current->pos + 
+                    src_buffer->size - e->pos;
+                dst_buffer->current->next = e->next;
+                dst_buffer->current = src_buffer->current;
+                dst_buffer->elementCount += src_buffer->elementCount - 1;
             }
         }
 
@@ -15606,10 +16666,14 @@ typedef struct ecs_system_t {
     
     /* Schedule parameters */
     bool multi_threaded;
+    bool multi_threaded_groups;
     bool no_readonly;
 
     int64_t invoke_count;           /* Number of times system is invoked */
     float time_spent;               /* Time spent on running system */
+#ifdef FLECS_STATS
+    ecs_histogram_t time_hist;      /* Time spent per invocation */
+#endif
     ecs_ftime_t time_passed;        /* Time passed since last invocation */
     int64_t last_frame;             /* Last frame for which the system was considered */
 
@@ -16690,6 +17754,7 @@ void ecs_run_pipeline(
     int32_t stage_count = ecs_get_stage_count(world);
 
     ecs_worker_begin(stage->thread_ctx);
+    flecs_trace_begin(stage, EcsTracePipelineOp, pipeline);
 
     ecs_time_t st = {0};
     bool measure_time = false;
@@ -16746,7 +17811,11 @@ void ecs_run_pipeline(
                  * current position (system). If there are a lot of systems
                  * in the pipeline this can be an expensive operation, but
                  * should happen infrequently. */
+                flecs_trace_end(stage, EcsTracePipelineOp, pipeline);
+                flecs_trace_begin(stage, EcsTraceWorkerSync, 0);
                 bool rebuild = ecs_worker_sync(world, pq);
+                flecs_trace_end(stage, EcsTraceWorkerSync, 0);
+                flecs_trace_begin(stage, EcsTracePipelineOp, pipeline);
                 pq = (EcsPipeline*)ecs_get(world, pipeline, EcsPipeline);
                 if (rebuild) {
                     i = pq->cur_i;
@@ -16759,7 +17828,8 @@ void ecs_run_pipeline(
 
                 if (measure_time) {
                     /* Reset timer after merge */
-                    ecs_time_measure(&st);
+                    flecs_histogram_record(&world->sync_time_hist,
+                        (ecs_ftime_t)ecs_time_measure(&st));
                 }
             }
         }
@@ -16770,7 +17840,15 @@ done:
         world->info.system_time_total += (ecs_ftime_t)ecs_time_measure(&st);
     }
 
+    flecs_trace_end(stage, EcsTracePipelineOp, pipeline);
+    flecs_trace_begin(stage, EcsTraceWorkerSync, 0);
     ecs_worker_end(stage->thread_ctx);
+    flecs_trace_end(stage, EcsTraceWorkerSync, 0);
+
+    if (measure_time) {
+        flecs_histogram_record(&world->sync_time_hist,
+            (ecs_ftime_t)ecs_time_measure(&st));
+    }
 }
 
 bool ecs_progress(
@@ -17020,7 +18098,7 @@ void MonitorStats(ecs_iter_t *it) {
             if (kind == ecs_id(EcsWorldStats)) {
                 ecs_world_stats_repeat_last(stats);
             } else if (kind == ecs_id(EcsPipelineStats)) {
-                ecs_world_stats_repeat_last(stats);
+                ecs_pipeline_stats_repeat_last(stats);
             }
         }
         hdr->reduce_count = 0;
@@ -17535,6 +18613,227 @@ void FlecsTimerImport(
 
 #endif
 
+/**
+ * @file addons/tracing.c
+ * @brief Tracing addon.
+ */
+
+
+#ifdef FLECS_TRACING
+
+static
+const char* flecs_trace_kind_str(
+    int32_t kind)
+{
+    switch(kind) {
+    case EcsTraceFrame: return "frame";
+    case EcsTracePipelineOp: return "pipeline";
+    case EcsTraceSystem: return "system";
+    case EcsTraceMerge: return "merge";
+    case EcsTraceWorkerSync: return "sync";
+    case EcsTraceObserver: return "observer";
+    default: return "unknown";
+    }
+}
+
+void flecs_trace_stage_init(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    int32_t size = world->trace_size;
+    if (!size) {
+        stage->trace = NULL;
+        return;
+    }
+
+    ecs_trace_buffer_t *trace = ecs_os_calloc_t(ecs_trace_buffer_t);
+    trace->events = ecs_os_malloc_n(ecs_trace_event_t, size);
+    trace->size = size;
+    trace->head = 0;
+    stage->trace = trace;
+}
+
+void flecs_trace_stage_fini(
+    ecs_stage_t *stage)
+{
+    ecs_trace_buffer_t *trace = stage->trace;
+    if (trace) {
+        ecs_os_free(trace->events);
+        ecs_os_free(trace);
+        stage->trace = NULL;
+    }
+}
+
+void flecs_trace_record(
+    ecs_stage_t *stage,
+    ecs_trace_kind_t kind,
+    ecs_entity_t entity,
+    bool begin)
+{
+    ecs_trace_buffer_t *trace = stage->trace;
+    ecs_trace_event_t *ev = &trace->events[
+        trace->head & (uint64_t)(trace->size - 1)];
+    ev->time = ecs_os_now();
+    ev->entity = entity;
+    ev->kind = kind;
+    ev->begin = begin;
+    trace->head ++;
+}
+
+void ecs_tracing_start(
+    ecs_world_t *world,
+    int32_t event_count)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(event_count >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_os_has_time(), ECS_MISSING_OS_API, "now");
+    ecs_check(!(world->flags & EcsWorldReadonly), ECS_INVALID_OPERATION, NULL);
+
+    if (!event_count) {
+        event_count = ECS_TRACING_DEFAULT_EVENT_COUNT;
+    }
+
+    /* Round up to power of 2, so ring buffer index can be computed with mask */
+    int32_t size = 1;
+    while (size < event_count) {
+        size <<= 1;
+    }
+
+    ecs_tracing_stop(world);
+
+    world->trace_size = size;
+    world->trace_start = ecs_os_now();
+
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        flecs_trace_stage_init(world, &world->stages[i]);
+    }
+error:
+    return;
+}
+
+void ecs_tracing_stop(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(!(world->flags & EcsWorldReadonly), ECS_INVALID_OPERATION, NULL);
+
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        flecs_trace_stage_fini(&world->stages[i]);
+    }
+
+    world->trace_size = 0;
+error:
+    return;
+}
+
+bool ecs_tracing_enabled(
+    const ecs_world_t *world)
+{
+    world = ecs_get_world(world);
+    return world->trace_size != 0;
+}
+
+static
+void flecs_trace_name_to_json(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    const ecs_trace_event_t *ev)
+{
+    ecs_strbuf_appendch(buf, '"');
+
+    if (ev->entity && ecs_is_alive(world, ev->entity)) {
+        char *path = ecs_get_fullpath(world, ev->entity);
+        const char *ptr;
+        for (ptr = path; *ptr; ptr ++) {
+            char ch = *ptr;
+            if (ch == '"' || ch == '\\') {
+                ecs_strbuf_appendch(buf, '\\');
+            }
+            ecs_strbuf_appendch(buf, ch);
+        }
+        ecs_os_free(path);
+    } else if (ev->entity) {
+        ecs_strbuf_append(buf, "#%u", (uint32_t)ev->entity);
+    } else {
+        ecs_strbuf_appendstr(buf, flecs_trace_kind_str(ev->kind));
+    }
+
+    ecs_strbuf_appendch(buf, '"');
+}
+
+static
+void flecs_trace_stage_to_json(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    const ecs_stage_t *stage)
+{
+    const ecs_trace_buffer_t *trace = stage->trace;
+    uint64_t mask = (uint64_t)(trace->size - 1);
+    uint64_t i = 0, head = trace->head;
+    if (head > (uint64_t)trace->size) {
+        i = head - (uint64_t)trace->size;
+    }
+
+    ecs_strbuf_list_next(buf);
+    ecs_strbuf_append(buf,
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,"
+        "\"args\":{\"name\":\"%s %d\"}}", stage->id,
+            stage->id ? "worker" : "main", stage->id);
+
+    /* When the ring buffer wrapped around, the first events may end scopes
+     * for which the begin event was overwritten. Don't emit those. */
+    int32_t depth = 0;
+    for (; i < head; i ++) {
+        const ecs_trace_event_t *ev = &trace->events[i & mask];
+        if (ev->begin) {
+            depth ++;
+        } else if (!depth) {
+            continue;
+        } else {
+            depth --;
+        }
+
+        uint64_t time = ev->time - world->trace_start;
+        ecs_strbuf_list_next(buf);
+        ecs_strbuf_appendlit(buf, "{\"name\":");
+        flecs_trace_name_to_json(world, buf, ev);
+        ecs_strbuf_append(buf,
+            ",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":0,"
+            "\"tid\":%d}", flecs_trace_kind_str(ev->kind), 
+                ev->begin ? 'B' : 'E', (unsigned long long)(time / 1000), 
+                (uint32_t)(time % 1000), stage->id);
+    }
+}
+
+char* ecs_tracing_to_json(
+    const ecs_world_t *world)
+{
+    world = ecs_get_world(world);
+    if (!world->trace_size) {
+        return NULL;
+    }
+
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_strbuf_appendlit(&buf, "{\"traceEvents\":");
+    ecs_strbuf_list_push(&buf, "[", ",");
+
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        const ecs_stage_t *stage = &world->stages[i];
+        if (stage->trace) {
+            flecs_trace_stage_to_json(world, &buf, stage);
+        }
+    }
+
+    ecs_strbuf_list_pop(&buf, "]");
+    ecs_strbuf_appendlit(&buf, ",\"displayTimeUnit\":\"ms\"}");
+    return ecs_strbuf_get(&buf);
+}
+
+#endif
+
 #include <ctype.h>
 
 /* Utilities for C++ API */
@@ -22473,7 +23772,9 @@ ecs_rule_t* ecs_rule_init(
         goto error;
     }
 
-    result->world = world;
+    /* Rules may be created for a stage, but entity lookups during evaluation
+     * require the actual world */
+    result->world = (ecs_world_t*)ecs_get_world(world);
 
     /* Rule has no terms */
     if (!result->filter.term_count) {
@@ -22481,6 +23782,12 @@ ecs_rule_t* ecs_rule_init(
         goto error;
     }
 
+    /* Rules don't evaluate term predicates or member indices */
+    if (ECS_BIT_IS_SET(result->filter.flags, EcsFilterHasPredicates)) {
+        rule_error(result, "rules do not support term predicates");
+        goto error;
+    }
+
     ecs_term_t *terms = result->filter.terms;
     int32_t i, term_count = result->filter.term_count;
 
@@ -22566,6 +23873,13 @@ const ecs_filter_t* ecs_rule_get_filter(
     return &rule->filter; 
 }
 
+ecs_estimate_t ecs_rule_estimate(
+    const ecs_rule_t *rule)
+{
+    ecs_poly_assert(rule, ecs_rule_t);
+    return flecs_filter_estimate(rule->world, &rule->filter, true);
+}
+
 /* Quick convenience function to get a variable from an id */
 static
 ecs_rule_var_t* get_variable(
@@ -25053,6 +26367,95 @@ ecs_vector_t* serialize_component(
     return ops;
 }
 
+#ifdef FLECS_JSON
+
+static
+void serialize_json_op_add(
+    ecs_vector_t **program,
+    ecs_strbuf_t *literals,
+    int32_t *literal,
+    ecs_meta_type_op_kind_t kind,
+    ecs_size_t offset)
+{
+    int32_t written = ecs_strbuf_written(literals);
+    ecs_meta_json_op_t *op = ecs_vector_add(program, ecs_meta_json_op_t);
+    op->kind = kind;
+    op->offset = offset;
+    op->literal = literal[0];
+    op->literal_len = written - literal[0];
+    literal[0] = written;
+}
+
+/* Flatten type ops into a program that alternates between literals and values.
+ * Literals are computed the same way as the JSON serializer computes member
+ * names & separators, so that the program produces the same output. */
+static
+void serialize_json_program(
+    ecs_vector_t *ops,
+    EcsMetaTypeSerialized *ptr)
+{
+    ecs_meta_type_op_t *op_ptr = ecs_vector_first(ops, ecs_meta_type_op_t);
+    int32_t i, count = ecs_vector_count(ops);
+    int32_t members[ECS_META_MAX_SCOPE_DEPTH] = {0};
+    int32_t sp = 0, literal = 0;
+
+    ecs_vector_t *program = NULL;
+    ecs_strbuf_t literals = ECS_STRBUF_INIT;
+
+    for (i = 0; i < count; i ++) {
+        ecs_meta_type_op_t *op = &op_ptr[i];
+        if (op->count > 1) {
+            goto unsupported; /* Inline array */
+        }
+
+        if (op->name) {
+            if (members[sp] ++) {
+                ecs_strbuf_appendlit(&literals, ", ");
+            }
+            ecs_strbuf_appendch(&literals, '"');
+            char *name = ecs_astresc('"', op->name);
+            ecs_strbuf_appendstr(&literals, name);
+            ecs_os_free(name);
+            ecs_strbuf_appendlit(&literals, "\":");
+        }
+
+        switch(op->kind) {
+        case EcsOpPush:
+            if (++ sp >= ECS_META_MAX_SCOPE_DEPTH) {
+                goto unsupported;
+            }
+            members[sp] = 0;
+            ecs_strbuf_appendch(&literals, '{');
+            break;
+        case EcsOpPop:
+            sp --;
+            ecs_strbuf_appendch(&literals, '}');
+            break;
+        default:
+            if (op->kind < EcsOpPrimitive) {
+                goto unsupported; /* Enum, bitmask, array or vector */
+            }
+            serialize_json_op_add(
+                &program, &literals, &literal, op->kind, op->offset);
+            break;
+        }
+    }
+
+    serialize_json_op_add(&program, &literals, &literal, EcsOpPop, 0);
+
+    ptr->json_ops = program;
+    ptr->json_literals = ecs_strbuf_get(&literals);
+    if (!ptr->json_literals) {
+        ptr->json_literals = ecs_os_strdup("");
+    }
+    return;
+unsupported:
+    ecs_vector_free(program);
+    ecs_strbuf_reset(&literals);
+}
+
+#endif
+
 void ecs_meta_type_serialized_init(
     ecs_iter_t *it)
 {
@@ -25071,9 +26474,76 @@ void ecs_meta_type_serialized_init(
         }
 
         ptr->ops = ops;
+        ptr->json_ops = NULL;
+        ptr->json_literals = NULL;
+#ifdef FLECS_JSON
+        serialize_json_program(ops, ptr);
+#endif
     }
 }
 
+int ecs_meta_member_offset(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const char *member,
+    ecs_size_t *offset_out,
+    ecs_entity_t *type_out)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(member != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    const EcsMetaTypeSerialized *ser = ecs_get(
+        world, type, EcsMetaTypeSerialized);
+    if (!ser) {
+        return -1;
+    }
+
+    ecs_meta_type_op_t *push_op = ecs_vector_first(
+        ser->ops, ecs_meta_type_op_t);
+    const char *name = member;
+    char token[ECS_MAX_TOKEN_SIZE];
+
+    do {
+        if (!push_op || push_op->kind != EcsOpPush || !push_op->members) {
+            return -1;
+        }
+
+        const char *sep = strchr(name, '.');
+        ecs_size_t len = sep ? (ecs_size_t)(sep - name) : ecs_os_strlen(name);
+        if (!len || len >= ECS_MAX_TOKEN_SIZE) {
+            return -1;
+        }
+
+        ecs_os_memcpy(token, name, len);
+        token[len] = '\0';
+
+        /* Member indices are relative to the operation after the push */
+        const uint64_t *cur_ptr = flecs_name_index_find_ptr(
+            push_op->members, token, 0, 0);
+        if (!cur_ptr) {
+            return -1;
+        }
+
+        ecs_meta_type_op_t *op = &push_op[1 + cur_ptr[0]];
+        if (!sep) {
+            if (op->count > 1 || op->kind <= EcsOpScope) {
+                /* Only members that hold a single value can be resolved */
+                return -1;
+            }
+
+            /* Operation offsets are relative to the serialized type */
+            *offset_out = op->offset;
+            *type_out = op->type;
+            return 0;
+        }
+
+        push_op = op;
+        name = sep + 1;
+    } while (true);
+error:
+    return -1;
+}
+
 #endif
 
 
@@ -25114,12 +26584,16 @@ void ecs_meta_dtor_serialized(
     }
 
     ecs_vector_free(ptr->ops); 
+    ecs_vector_free(ptr->json_ops);
+    ecs_os_free(ptr->json_literals);
 }
 
 static ECS_COPY(EcsMetaTypeSerialized, dst, src, {
     ecs_meta_dtor_serialized(dst);
 
     dst->ops = ecs_vector_copy(src->ops, ecs_meta_type_op_t);
+    dst->json_ops = ecs_vector_copy(src->json_ops, ecs_meta_json_op_t);
+    dst->json_literals = ecs_os_strdup(src->json_literals);
 
     int32_t o, count = ecs_vector_count(src->ops);
     ecs_meta_type_op_t *ops = ecs_vector_first(src->ops, ecs_meta_type_op_t);
@@ -25135,7 +26609,11 @@ static ECS_COPY(EcsMetaTypeSerialized, dst, src, {
 static ECS_MOVE(EcsMetaTypeSerialized, dst, src, {
     ecs_meta_dtor_serialized(dst);
     dst->ops = src->ops;
+    dst->json_ops = src->json_ops;
+    dst->json_literals = src->json_literals;
     src->ops = NULL;
+    src->json_ops = NULL;
+    src->json_literals = NULL;
 })
 
 static ECS_DTOR(EcsMetaTypeSerialized, ptr, { 
@@ -27567,6 +29045,939 @@ error:
 
 #endif
 
+/**
+ * @file addons/meta/index.c
+ * @brief Secondary indices on component members.
+ *
+ * A member index maps the value of a struct member to the entities that have
+ * that value. Values are converted to unsigned 64 bit keys that preserve the
+ * ordering of the original type, which allows all scalar types to share the
+ * same index implementation.
+ *
+ * A sorted index stores (key, entity) pairs in a list of chunks. Pairs are
+ * ordered by (key, entity) within and across chunks, so that the result of a
+ * range lookup is a run of consecutive chunk slices. An insert or remove only
+ * moves elements inside a single chunk, and chunks are split when they are
+ * full and merged when they become sparse. A hash index stores an entity array
+ * per key. Both index kinds keep a map from entity to its current key, so that
+ * the old value can be removed when a component is set or removed.
+ *
+ * The index is stored as the context of an observer that listens for OnSet and
+ * UnSet events on the component, so that deleting the index entity also
+ * cleans up the index.
+ */
+
+
+#ifdef FLECS_META
+
+#define ECS_MEMBER_INDEX_SIGN (1ull << 63)
+
+/* Max number of elements in a chunk of a sorted index */
+#define FLECS_MEMBER_INDEX_CHUNK_SIZE (256)
+
+/* Chunks with fewer elements are merged with their neighbour */
+#define FLECS_MEMBER_INDEX_CHUNK_MIN (FLECS_MEMBER_INDEX_CHUNK_SIZE / 4)
+
+typedef struct ecs_member_index_chunk_t {
+    int32_t count;
+    uint64_t keys[FLECS_MEMBER_INDEX_CHUNK_SIZE];
+    ecs_entity_t entities[FLECS_MEMBER_INDEX_CHUNK_SIZE];
+} ecs_member_index_chunk_t;
+
+typedef struct ecs_member_index_elem_t {
+    uint64_t key;               /* Current key of entity */
+    int32_t slot;               /* Position of entity in bucket (hash only) */
+} ecs_member_index_elem_t;
+
+typedef struct ecs_member_index_t {
+    ecs_world_t *world;
+    ecs_entity_t component;
+    ecs_entity_t member;
+    ecs_member_index_kind_t kind;
+    ecs_primitive_kind_t type_kind;
+    ecs_size_t offset;
+
+    ecs_map_t elems;            /* map<entity, ecs_member_index_elem_t> */
+    ecs_map_t buckets;          /* map<key, ecs_vec_t<ecs_entity_t>> (hash) */
+    ecs_vec_t chunks;           /* vec<ecs_member_index_chunk_t*> (sorted) */
+    ecs_vec_t result;           /* vec<ecs_entity_t>, for multi-chunk lookups */
+} ecs_member_index_t;
+
+static
+uint64_t flecs_member_index_signed_key(
+    int64_t value)
+{
+    return (uint64_t)value ^ ECS_MEMBER_INDEX_SIGN;
+}
+
+static
+uint64_t flecs_member_index_float_key(
+    double value)
+{
+    if (value == 0) {
+        value = 0; /* Make sure -0 and 0 map to the same key */
+    }
+
+    uint64_t bits;
+    ecs_os_memcpy(&bits, &value, ECS_SIZEOF(double));
+    if (bits & ECS_MEMBER_INDEX_SIGN) {
+        return ~bits;
+    } else {
+        return bits | ECS_MEMBER_INDEX_SIGN;
+    }
+}
+
+/* Convert value to key with the same ordering as the value */
+static
+uint64_t flecs_member_index_key(
+    ecs_primitive_kind_t kind,
+    const void *ptr)
+{
+    switch(kind) {
+    case EcsBool:  return *(const bool*)ptr;
+    case EcsChar:  return flecs_member_index_signed_key(*(const char*)ptr);
+    case EcsByte:  return *(const ecs_byte_t*)ptr;
+    case EcsU8:    return *(const uint8_t*)ptr;
+    case EcsU16:   return *(const uint16_t*)ptr;
+    case EcsU32:   return *(const uint32_t*)ptr;
+    case EcsU64:   return *(const uint64_t*)ptr;
+    case EcsUPtr:  return *(const uintptr_t*)ptr;
+    case EcsI8:    return flecs_member_index_signed_key(*(const int8_t*)ptr);
+    case EcsI16:   return flecs_member_index_signed_key(*(const int16_t*)ptr);
+    case EcsI32:   return flecs_member_index_signed_key(*(const int32_t*)ptr);
+    case EcsI64:   return flecs_member_index_signed_key(*(const int64_t*)ptr);
+    case EcsIPtr:  return flecs_member_index_signed_key(*(const intptr_t*)ptr);
+    case EcsF32:   return flecs_member_index_float_key(*(const float*)ptr);
+    case EcsF64:   return flecs_member_index_float_key(*(const double*)ptr);
+    case EcsEntity: return *(const ecs_entity_t*)ptr;
+    case EcsString:
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+static
+bool flecs_member_index_before(
+    uint64_t key_1,
+    ecs_entity_t e_1,
+    uint64_t key_2,
+    ecs_entity_t e_2)
+{
+    return key_1 < key_2 || (key_1 == key_2 && e_1 < e_2);
+}
+
+/* Find first element in sorted index that is not ordered before (key, e). If
+ * all elements are ordered before (key, e), this returns the end of the last
+ * chunk, or chunk 0 if the index is empty. */
+static
+int32_t flecs_member_index_lower_bound(
+    const ecs_member_index_t *index,
+    uint64_t key,
+    ecs_entity_t e,
+    int32_t *chunk_out)
+{
+    ecs_member_index_chunk_t **chunks = ecs_vec_first_t(
+        &index->chunks, ecs_member_index_chunk_t*);
+    int32_t lo = 0, hi = ecs_vec_count(&index->chunks);
+    if (!hi) {
+        *chunk_out = 0;
+        return 0;
+    }
+
+    /* Find first chunk with a last element that's not ordered before (key, e) */
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        ecs_member_index_chunk_t *chunk = chunks[mid];
+        int32_t last = chunk->count - 1;
+        if (flecs_member_index_before(
+            chunk->keys[last], chunk->entities[last], key, e)) 
+        {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo == ecs_vec_count(&index->chunks)) {
+        *chunk_out = lo - 1;
+        return chunks[lo - 1]->count;
+    }
+
+    ecs_member_index_chunk_t *chunk = chunks[lo];
+    *chunk_out = lo;
+
+    hi = chunk->count;
+    lo = 0;
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        if (flecs_member_index_before(
+            chunk->keys[mid], chunk->entities[mid], key, e)) 
+        {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static
+ecs_member_index_chunk_t* flecs_member_index_chunk_new(
+    ecs_member_index_t *index,
+    int32_t at)
+{
+    ecs_allocator_t *a = &index->world->allocator;
+    ecs_member_index_chunk_t *chunk = flecs_alloc_t(
+        a, ecs_member_index_chunk_t);
+    chunk->count = 0;
+
+    int32_t count = ecs_vec_count(&index->chunks);
+    ecs_vec_append_t(a, &index->chunks, ecs_member_index_chunk_t*);
+    ecs_member_index_chunk_t **chunks = ecs_vec_first_t(
+        &index->chunks, ecs_member_index_chunk_t*);
+    if (at != count) {
+        ecs_os_memmove(&chunks[at + 1], &chunks[at], 
+            ECS_SIZEOF(ecs_member_index_chunk_t*) * (count - at));
+    }
+    chunks[at] = chunk;
+
+    return chunk;
+}
+
+static
+void flecs_member_index_chunk_free(
+    ecs_member_index_t *index,
+    int32_t at)
+{
+    ecs_member_index_chunk_t **chunks = ecs_vec_first_t(
+        &index->chunks, ecs_member_index_chunk_t*);
+    int32_t count = ecs_vec_count(&index->chunks);
+    flecs_free_t(&index->world->allocator, ecs_member_index_chunk_t, 
+        chunks[at]);
+    ecs_os_memmove(&chunks[at], &chunks[at + 1],
+        ECS_SIZEOF(ecs_member_index_chunk_t*) * (count - at - 1));
+    ecs_vec_remove_last(&index->chunks);
+}
+
+/* Move elements [row, count) of chunk to the start of dst */
+static
+void flecs_member_index_chunk_move(
+    ecs_member_index_chunk_t *dst,
+    ecs_member_index_chunk_t *src,
+    int32_t row)
+{
+    int32_t move = src->count - row;
+    ecs_os_memcpy(&dst->keys[dst->count], &src->keys[row], 
+        ECS_SIZEOF(uint64_t) * move);
+    ecs_os_memcpy(&dst->entities[dst->count], &src->entities[row], 
+        ECS_SIZEOF(ecs_entity_t) * move);
+    dst->count += move;
+    src->count = row;
+}
+
+static
+void flecs_member_index_sorted_insert(
+    ecs_member_index_t *index,
+    ecs_entity_t e,
+    uint64_t key)
+{
+    int32_t cur;
+    int32_t row = flecs_member_index_lower_bound(index, key, e, &cur);
+    ecs_member_index_chunk_t *chunk;
+
+    if (!ecs_vec_count(&index->chunks)) {
+        chunk = flecs_member_index_chunk_new(index, 0);
+    } else {
+        chunk = ecs_vec_get_t(&index->chunks, 
+            ecs_member_index_chunk_t*, cur)[0];
+        if (chunk->count == FLECS_MEMBER_INDEX_CHUNK_SIZE) {
+            /* Split chunk, move upper half to new chunk */
+            ecs_member_index_chunk_t *next = 
+                flecs_member_index_chunk_new(index, cur + 1);
+            int32_t half = FLECS_MEMBER_INDEX_CHUNK_SIZE / 2;
+            flecs_member_index_chunk_move(next, chunk, half);
+            if (row > half) {
+                chunk = next;
+                row -= half;
+            }
+        }
+    }
+
+    int32_t count = chunk->count;
+    if (row != count) {
+        ecs_os_memmove(&chunk->keys[row + 1], &chunk->keys[row],
+            ECS_SIZEOF(uint64_t) * (count - row));
+        ecs_os_memmove(&chunk->entities[row + 1], &chunk->entities[row],
+            ECS_SIZEOF(ecs_entity_t) * (count - row));
+    }
+    chunk->keys[row] = key;
+    chunk->entities[row] = e;
+    chunk->count ++;
+}
+
+static
+void flecs_member_index_sorted_remove(
+    ecs_member_index_t *index,
+    ecs_entity_t e,
+    uint64_t key)
+{
+    int32_t cur;
+    int32_t row = flecs_member_index_lower_bound(index, key, e, &cur);
+    ecs_member_index_chunk_t **chunks = ecs_vec_first_t(
+        &index->chunks, ecs_member_index_chunk_t*);
+    ecs_member_index_chunk_t *chunk = chunks[cur];
+    int32_t count = chunk->count;
+    ecs_assert(row < count, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(chunk->entities[row] == e, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_os_memmove(&chunk->keys[row], &chunk->keys[row + 1],
+        ECS_SIZEOF(uint64_t) * (count - row - 1));
+    ecs_os_memmove(&chunk->entities[row], &chunk->entities[row + 1],
+        ECS_SIZEOF(ecs_entity_t) * (count - row - 1));
+    count = -- chunk->count;
+
+    if (!count) {
+        flecs_member_index_chunk_free(index, cur);
+    } else if (count < FLECS_MEMBER_INDEX_CHUNK_MIN) {
+        /* Merge sparse chunk with a neighbour if the result fits */
+        int32_t chunk_count = ecs_vec_count(&index->chunks);
+        if ((cur + 1) < chunk_count && 
+            (count + chunks[cur + 1]->count) <= FLECS_MEMBER_INDEX_CHUNK_SIZE)
+        {
+            flecs_member_index_chunk_move(chunk, chunks[cur + 1], 0);
+            flecs_member_index_chunk_free(index, cur + 1);
+        } else if (cur && 
+            (count + chunks[cur - 1]->count) <= FLECS_MEMBER_INDEX_CHUNK_SIZE)
+        {
+            flecs_member_index_chunk_move(chunks[cur - 1], chunk, 0);
+            flecs_member_index_chunk_free(index, cur);
+        }
+    }
+}
+
+static
+void flecs_member_index_insert(
+    ecs_member_index_t *index,
+    ecs_entity_t e,
+    uint64_t key)
+{
+    ecs_allocator_t *a = &index->world->allocator;
+    ecs_member_index_elem_t *elem = ecs_map_ensure(
+        &index->elems, ecs_member_index_elem_t, e);
+    elem->key = key;
+
+    if (index->kind == EcsMemberIndexSorted) {
+        flecs_member_index_sorted_insert(index, e, key);
+    } else {
+        ecs_vec_t *bucket = ecs_map_get(&index->buckets, ecs_vec_t, key);
+        if (!bucket) {
+            bucket = ecs_map_ensure(&index->buckets, ecs_vec_t, key);
+            ecs_vec_init_t(a, bucket, ecs_entity_t, 0);
+        }
+        elem->slot = ecs_vec_count(bucket);
+        ecs_vec_append_t(a, bucket, ecs_entity_t)[0] = e;
+    }
+}
+
+static
+void flecs_member_index_remove(
+    ecs_member_index_t *index,
+    ecs_entity_t e)
+{
+    ecs_member_index_elem_t *elem = ecs_map_get(
+        &index->elems, ecs_member_index_elem_t, e);
+    if (!elem) {
+        return;
+    }
+
+    uint64_t key = elem->key;
+
+    if (index->kind == EcsMemberIndexSorted) {
+        flecs_member_index_sorted_remove(index, e, key);
+    } else {
+        ecs_vec_t *bucket = ecs_map_get(&index->buckets, ecs_vec_t, key);
+        ecs_assert(bucket != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        int32_t slot = elem->slot;
+        ecs_entity_t *entities = ecs_vec_first_t(bucket, ecs_entity_t);
+        int32_t last = ecs_vec_count(bucket) - 1;
+        ecs_assert(entities[slot] == e, ECS_INTERNAL_ERROR, NULL);
+        if (slot != last) {
+            ecs_entity_t moved = entities[last];
+            entities[slot] = moved;
+            ecs_member_index_elem_t *moved_elem = ecs_map_get(
+                &index->elems, ecs_member_index_elem_t, moved);
+            ecs_assert(moved_elem != NULL, ECS_INTERNAL_ERROR, NULL);
+            moved_elem->slot = slot;
+        }
+        ecs_vec_remove_last(bucket);
+
+        if (!ecs_vec_count(bucket)) {
+            ecs_vec_fini_t(&index->world->allocator, bucket, ecs_entity_t);
+            ecs_map_remove(&index->buckets, key);
+        }
+    }
+
+    ecs_map_remove(&index->elems, e);
+}
+
+static
+void flecs_member_index_set(
+    ecs_member_index_t *index,
+    ecs_entity_t e,
+    const void *ptr)
+{
+    uint64_t key = flecs_member_index_key(index->type_kind,
+        ECS_OFFSET(ptr, index->offset));
+
+    ecs_member_index_elem_t *elem = ecs_map_get(
+        &index->elems, ecs_member_index_elem_t, e);
+    if (elem) {
+        if (elem->key == key) {
+            return; /* Value didn't change */
+        }
+        flecs_member_index_remove(index, e);
+    }
+
+    flecs_member_index_insert(index, e, key);
+}
+
+static
+void flecs_member_index_free(
+    void *ctx)
+{
+    ecs_member_index_t *index = ctx;
+    ecs_allocator_t *a = &index->world->allocator;
+
+    ecs_map_iter_t it = ecs_map_iter(&index->buckets);
+    ecs_vec_t *bucket;
+    while ((bucket = ecs_map_next(&it, ecs_vec_t, NULL))) {
+        ecs_vec_fini_t(a, bucket, ecs_entity_t);
+    }
+
+    ecs_member_index_chunk_t **chunks = ecs_vec_first_t(
+        &index->chunks, ecs_member_index_chunk_t*);
+    int32_t i, count = ecs_vec_count(&index->chunks);
+    for (i = 0; i < count; i ++) {
+        flecs_free_t(a, ecs_member_index_chunk_t, chunks[i]);
+    }
+
+    ecs_map_fini(&index->buckets);
+    ecs_map_fini(&index->elems);
+    ecs_vec_fini_t(a, &index->chunks, ecs_member_index_chunk_t*);
+    ecs_vec_fini_t(a, &index->result, ecs_entity_t);
+    ecs_os_free(index);
+}
+
+static
+void flecs_member_index_observer(
+    ecs_iter_t *it)
+{
+    ecs_member_index_t *index = it->ctx;
+    int32_t i, count = it->count;
+
+    if (it->event == EcsOnSet) {
+        ecs_size_t size = flecs_uto(ecs_size_t, ecs_field_size(it, 1));
+        void *ptr = ecs_field_w_size(it, flecs_ito(size_t, size), 1);
+        for (i = 0; i < count; i ++) {
+            flecs_member_index_set(index, it->entities[i],
+                ECS_ELEM(ptr, size, i));
+        }
+    } else {
+        for (i = 0; i < count; i ++) {
+            flecs_member_index_remove(index, it->entities[i]);
+        }
+    }
+}
+
+/* Resolve type kind of member, returns 0 if type cannot be indexed */
+static
+ecs_primitive_kind_t flecs_member_index_type_kind(
+    const ecs_world_t *world,
+    ecs_entity_t type)
+{
+    const EcsPrimitive *p = ecs_get(world, type, EcsPrimitive);
+    if (p) {
+        if (p->kind == EcsString) {
+            return 0;
+        }
+        return p->kind;
+    }
+
+    if (ecs_has(world, type, EcsEnum)) {
+        return EcsI32;
+    }
+
+    if (ecs_has(world, type, EcsBitmask)) {
+        return EcsU32;
+    }
+
+    return 0;
+}
+
+ecs_entity_t ecs_member_index_init(
+    ecs_world_t *world,
+    const ecs_member_index_desc_t *desc)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->member != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_entity_t member = desc->member;
+    const EcsMember *m = ecs_get(world, member, EcsMember);
+    if (!m) {
+        char *path = ecs_get_fullpath(world, member);
+        ecs_err("cannot create index for '%s': entity is not a member", path);
+        ecs_os_free(path);
+        return 0;
+    }
+
+    ecs_entity_t component = ecs_get_target(world, member, EcsChildOf, 0);
+    const EcsStruct *st = ecs_get(world, component, EcsStruct);
+    ecs_check(st != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_member_t *members = ecs_vector_first(st->members, ecs_member_t);
+    int32_t i, count = ecs_vector_count(st->members);
+    for (i = 0; i < count; i ++) {
+        if (members[i].member == member) {
+            break;
+        }
+    }
+    ecs_check(i != count, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_primitive_kind_t kind = flecs_member_index_type_kind(world, m->type);
+    if (!kind || members[i].count > 1) {
+        char *path = ecs_get_fullpath(world, member);
+        ecs_err("cannot create index for '%s': member is not a scalar", path);
+        ecs_os_free(path);
+        return 0;
+    }
+
+    world = (ecs_world_t*)ecs_get_world(world);
+
+    ecs_member_index_t *index = ecs_os_calloc_t(ecs_member_index_t);
+    index->world = world;
+    index->component = component;
+    index->member = member;
+    index->kind = desc->kind;
+    index->type_kind = kind;
+    index->offset = members[i].offset;
+    ecs_map_init(&index->elems, ecs_member_index_elem_t,
+        &world->allocator, 0);
+    ecs_map_init(&index->buckets, ecs_vec_t, &world->allocator, 0);
+    ecs_vec_init_t(&world->allocator, &index->chunks, 
+        ecs_member_index_chunk_t*, 0);
+    ecs_vec_init_t(&world->allocator, &index->result, ecs_entity_t, 0);
+
+    /* Populate index with values of existing entities */
+    ecs_iter_t it = ecs_term_iter(world, &(ecs_term_t){
+        .id = component,
+        .src.flags = EcsSelf
+    });
+    while (ecs_term_next(&it)) {
+        ecs_size_t size = flecs_uto(ecs_size_t, ecs_field_size(&it, 1));
+        void *ptr = ecs_field_w_size(&it, flecs_ito(size_t, size), 1);
+        for (i = 0; i < it.count; i ++) {
+            flecs_member_index_set(index, it.entities[i],
+                ECS_ELEM(ptr, size, i));
+        }
+    }
+
+    ecs_entity_t result = ecs_observer_init(world, &(ecs_observer_desc_t){
+        .entity = desc->entity,
+        .filter.terms = {{ .id = component, .src.flags = EcsSelf }},
+        .events = { EcsOnSet, EcsUnSet },
+        .callback = flecs_member_index_observer,
+        .ctx = index,
+        .ctx_free = flecs_member_index_free
+    });
+
+    if (!result) {
+        flecs_member_index_free(index);
+    }
+
+    return result;
+error:
+    return 0;
+}
+
+static
+ecs_member_index_t* flecs_member_index_get(
+    const ecs_world_t *world,
+    ecs_entity_t index)
+{
+    const EcsPoly *poly = ecs_poly_bind_get(world, index, ecs_observer_t);
+    if (!poly) {
+        return NULL;
+    }
+
+    ecs_observer_t *observer = poly->poly;
+    if (!observer || observer->callback != flecs_member_index_observer) {
+        return NULL;
+    }
+
+    return observer->ctx;
+}
+
+/* Move iterator to next chunk of lookup */
+static
+bool flecs_member_index_iter_chunk(
+    ecs_member_index_iter_t *iter)
+{
+    if (iter->chunk >= iter->last_chunk) {
+        return false;
+    }
+
+    const ecs_member_index_t *index = iter->index;
+    ecs_member_index_chunk_t *chunk = ecs_vec_get_t(&index->chunks, 
+        ecs_member_index_chunk_t*, ++ iter->chunk)[0];
+    iter->entities = chunk->entities;
+    iter->cur = 0;
+    if (iter->chunk == iter->last_chunk) {
+        iter->count = iter->last_count;
+    } else {
+        iter->count = chunk->count;
+    }
+
+    return true;
+}
+
+/* Find the chunk slices of a sorted index with keys in [min, max] */
+static
+void flecs_member_index_range(
+    const ecs_member_index_t *index,
+    const uint64_t *min,
+    const uint64_t *max,
+    ecs_member_index_iter_t *iter)
+{
+    int32_t chunk_count = ecs_vec_count(&index->chunks);
+    if (!chunk_count) {
+        return;
+    }
+
+    ecs_member_index_chunk_t **chunks = ecs_vec_first_t(
+        &index->chunks, ecs_member_index_chunk_t*);
+    int32_t lo_chunk = 0, lo = 0;
+    int32_t hi_chunk = chunk_count - 1, hi = chunks[hi_chunk]->count;
+
+    if (min) {
+        lo = flecs_member_index_lower_bound(index, min[0], 0, &lo_chunk);
+    }
+    if (max && max[0] != UINT64_MAX) {
+        hi = flecs_member_index_lower_bound(index, max[0] + 1, 0, &hi_chunk);
+    }
+
+    if (hi_chunk < lo_chunk || (hi_chunk == lo_chunk && hi <= lo)) {
+        return;
+    }
+
+    iter->entities = &chunks[lo_chunk]->entities[lo];
+    iter->chunk = lo_chunk;
+    iter->last_chunk = hi_chunk;
+    iter->last_count = hi;
+    if (lo_chunk == hi_chunk) {
+        iter->count = hi - lo;
+    } else {
+        iter->count = chunks[lo_chunk]->count - lo;
+    }
+}
+
+/* Initialize iterator for entities with a value in [min, max] */
+static
+int flecs_member_index_lookup(
+    const ecs_member_index_t *index,
+    const void *min,
+    const void *max,
+    ecs_member_index_iter_t *iter)
+{
+    ecs_primitive_kind_t kind = index->type_kind;
+    *iter = (ecs_member_index_iter_t){ .index = index };
+
+    if (index->kind == EcsMemberIndexHash) {
+        ecs_check(min != NULL && max != NULL, ECS_INVALID_PARAMETER,
+            "hash index only supports equality lookups");
+        uint64_t key = flecs_member_index_key(kind, min);
+        ecs_check(key == flecs_member_index_key(kind, max),
+            ECS_INVALID_PARAMETER, "hash index only supports equality lookups");
+
+        ecs_vec_t *bucket = ecs_map_get(&index->buckets, ecs_vec_t, key);
+        if (bucket) {
+            iter->entities = ecs_vec_first_t(bucket, ecs_entity_t);
+            iter->count = ecs_vec_count(bucket);
+        }
+        return 0;
+    }
+
+    uint64_t min_key, max_key;
+    if (min) {
+        min_key = flecs_member_index_key(kind, min);
+    }
+    if (max) {
+        max_key = flecs_member_index_key(kind, max);
+    }
+
+    flecs_member_index_range(index, min ? &min_key : NULL, 
+        max ? &max_key : NULL, iter);
+
+    return 0;
+error:
+    return -1;
+}
+
+const ecs_entity_t* ecs_member_index_find(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *min,
+    const void *max,
+    int32_t *count_out)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count_out != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    *count_out = 0;
+
+    ecs_member_index_t *ptr = flecs_member_index_get(world, index);
+    ecs_check(ptr != NULL, ECS_INVALID_PARAMETER, "entity is not an index");
+
+    ecs_member_index_iter_t iter;
+    if (flecs_member_index_lookup(ptr, min, max, &iter)) {
+        return NULL;
+    }
+
+    if (iter.chunk == iter.last_chunk) {
+        /* Result is stored in a single chunk or bucket */
+        *count_out = iter.count;
+        return iter.count ? iter.entities : NULL;
+    }
+
+    /* Result spans multiple chunks, copy to result buffer */
+    ecs_allocator_t *a = &ptr->world->allocator;
+    ecs_vec_clear(&ptr->result);
+    do {
+        ecs_entity_t *dst = ecs_vec_grow_t(a, &ptr->result, ecs_entity_t, 
+            iter.count);
+        ecs_os_memcpy_n(dst, iter.entities, ecs_entity_t, iter.count);
+    } while (flecs_member_index_iter_chunk(&iter));
+
+    *count_out = ecs_vec_count(&ptr->result);
+    return ecs_vec_first_t(&ptr->result, ecs_entity_t);
+error:
+    return NULL;
+}
+
+ecs_iter_t ecs_member_index_iter(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *min,
+    const void *max)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_member_index_t *ptr = flecs_member_index_get(world, index);
+    ecs_check(ptr != NULL, ECS_INVALID_PARAMETER, "entity is not an index");
+
+    const ecs_world_t *real_world = ecs_get_world(world);
+
+    ecs_iter_t it = {
+        .world = (ecs_world_t*)world,
+        .real_world = (ecs_world_t*)real_world,
+        .next = ecs_member_index_next
+    };
+
+    if (flecs_member_index_lookup(ptr, min, max, 
+        &it.priv.iter.member_index)) 
+    {
+        goto error;
+    }
+
+    return it;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+bool flecs_member_index_iter_next(
+    const ecs_world_t *world,
+    ecs_member_index_iter_t *iter,
+    ecs_table_t **table_out,
+    int32_t *row_out,
+    int32_t *count_out)
+{
+    do {
+        const ecs_entity_t *entities = iter->entities;
+        int32_t i = iter->cur, count = iter->count;
+
+        for (; i < count; i ++) {
+            ecs_record_t *r = flecs_entities_get(world, entities[i]);
+            if (!r || !r->table) {
+                continue;
+            }
+
+            /* Combine entities that are stored in consecutive rows of the 
+             * same table into a single result */
+            ecs_table_t *table = r->table;
+            int32_t row = ECS_RECORD_TO_ROW(r->row), run = 1;
+            for (i ++; i < count; i ++, run ++) {
+                ecs_record_t *next = flecs_entities_get(world, entities[i]);
+                if (!next || next->table != table ||
+                    ECS_RECORD_TO_ROW(next->row) != (row + run))
+                {
+                    break;
+                }
+            }
+
+            iter->cur = i;
+            *table_out = table;
+            *row_out = row;
+            *count_out = run;
+            return true;
+        }
+
+        iter->cur = count;
+    } while (flecs_member_index_iter_chunk(iter));
+
+    return false;
+}
+
+bool ecs_member_index_next(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_member_index_next, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_table_t *table;
+    int32_t row, count;
+    if (flecs_member_index_iter_next(it->real_world, 
+        &it->priv.iter.member_index, &table, &row, &count)) 
+    {
+        flecs_iter_populate_data(it->real_world, it, table, row, count, 
+            NULL, NULL);
+        ECS_BIT_SET(it->flags, EcsIterIsValid);
+        return true;
+    }
+
+    ECS_BIT_CLEAR(it->flags, EcsIterIsValid);
+error:
+    return false;
+}
+
+/* Type of predicate that tests values of the indexed member */
+static
+ecs_predicate_kind_t flecs_member_index_predicate_kind(
+    ecs_primitive_kind_t kind)
+{
+    switch(kind) {
+    case EcsBool:   return EcsPredicateU8;
+    case EcsChar:   return EcsPredicateI8;
+    case EcsByte:   return EcsPredicateU8;
+    case EcsU8:     return EcsPredicateU8;
+    case EcsU16:    return EcsPredicateU16;
+    case EcsU32:    return EcsPredicateU32;
+    case EcsU64:    return EcsPredicateU64;
+    case EcsI8:     return EcsPredicateI8;
+    case EcsI16:    return EcsPredicateI16;
+    case EcsI32:    return EcsPredicateI32;
+    case EcsI64:    return EcsPredicateI64;
+    case EcsF32:    return EcsPredicateF32;
+    case EcsF64:    return EcsPredicateF64;
+    case EcsEntity: return EcsPredicateU64;
+    case EcsUPtr:   
+        return ECS_SIZEOF(uintptr_t) == 8 ? EcsPredicateU64 : EcsPredicateU32;
+    case EcsIPtr:   
+        return ECS_SIZEOF(intptr_t) == 8 ? EcsPredicateI64 : EcsPredicateI32;
+    case EcsString:
+    default:
+        return EcsPredicateNone;
+    }
+}
+
+/* Convert predicate operand to value of the indexed member */
+static
+void flecs_member_index_predicate_value(
+    const ecs_member_index_t *index,
+    const ecs_term_predicate_t *pred,
+    void *out)
+{
+    double v = pred->value;
+    if (index->type_kind == EcsBool) {
+        *(bool*)out = v != 0;
+        return;
+    }
+
+    switch(pred->kind) {
+    case EcsPredicateI8:  *(int8_t*)out = (int8_t)v; break;
+    case EcsPredicateI16: *(int16_t*)out = (int16_t)v; break;
+    case EcsPredicateI32: *(int32_t*)out = (int32_t)v; break;
+    case EcsPredicateI64: *(int64_t*)out = (int64_t)v; break;
+    case EcsPredicateU8:  *(uint8_t*)out = (uint8_t)v; break;
+    case EcsPredicateU16: *(uint16_t*)out = (uint16_t)v; break;
+    case EcsPredicateU32: *(uint32_t*)out = (uint32_t)v; break;
+    case EcsPredicateU64: *(uint64_t*)out = (uint64_t)v; break;
+    case EcsPredicateF32: *(float*)out = (float)v; break;
+    case EcsPredicateF64: *(double*)out = v; break;
+    case EcsPredicateNone:
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+int flecs_member_index_iter_predicate(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    ecs_entity_t component,
+    const ecs_term_predicate_t *pred,
+    ecs_member_index_iter_t *iter)
+{
+    ecs_member_index_t *ptr = flecs_member_index_get(world, index);
+    if (!ptr || ptr->component != component || ptr->offset != pred->offset) {
+        return -1;
+    }
+
+    if (flecs_member_index_predicate_kind(ptr->type_kind) != pred->kind) {
+        return -1;
+    }
+
+    bool has_min = false, has_max = false;
+    switch(pred->op) {
+    case EcsPredicateEq:
+        has_min = has_max = true;
+        break;
+    case EcsPredicateLt:
+    case EcsPredicateLtEq:
+        has_max = true;
+        break;
+    case EcsPredicateGt:
+    case EcsPredicateGtEq:
+        has_min = true;
+        break;
+    case EcsPredicateNeq:
+    case EcsPredicateMaskAny:
+    case EcsPredicateMaskAll:
+    case EcsPredicateMaskNone:
+    default:
+        return -1;
+    }
+
+    if (ptr->kind == EcsMemberIndexHash && !(has_min && has_max)) {
+        return -1;
+    }
+
+    if (!iter) {
+        return 0;
+    }
+
+    /* The range includes the operand, so that exclusive comparisons return a
+     * superset of the result. Rows are still tested with the predicate. */
+    uint64_t value = 0;
+    flecs_member_index_predicate_value(ptr, pred, &value);
+    return flecs_member_index_lookup(ptr, has_min ? &value : NULL, 
+        has_max ? &value : NULL, iter);
+}
+
+#endif
+
 
 
 #ifdef FLECS_EXPR
@@ -29735,6 +32146,170 @@ void flecs_stats_copy_last(
     }
 }
 
+#define FLECS_HISTOGRAM_SUB_BITS (3)
+#define FLECS_HISTOGRAM_SUB_COUNT (1 << FLECS_HISTOGRAM_SUB_BITS)
+
+static
+int32_t flecs_histogram_bucket(
+    uint64_t value)
+{
+    if (value < FLECS_HISTOGRAM_SUB_COUNT) {
+        return (int32_t)value;
+    }
+
+    int32_t msb = 0;
+    uint64_t v = value;
+    while (v >>= 1) {
+        msb ++;
+    }
+
+    /* Each power of 2 is split up in SUB_COUNT linear buckets */
+    int32_t shift = msb - FLECS_HISTOGRAM_SUB_BITS;
+    int32_t bucket = (shift + 1) * FLECS_HISTOGRAM_SUB_COUNT + 
+        (int32_t)((value >> shift) & (FLECS_HISTOGRAM_SUB_COUNT - 1));
+    if (bucket >= ECS_HISTOGRAM_BUCKET_COUNT) {
+        bucket = ECS_HISTOGRAM_BUCKET_COUNT - 1;
+    }
+
+    return bucket;
+}
+
+static
+ecs_float_t flecs_histogram_bucket_value(
+    int32_t bucket)
+{
+    /* Return middle of bucket range, in seconds */
+    if (bucket < FLECS_HISTOGRAM_SUB_COUNT) {
+        return ((ecs_float_t)bucket + (ecs_float_t)0.5) / (ecs_float_t)1e6;
+    }
+
+    int32_t shift = bucket / FLECS_HISTOGRAM_SUB_COUNT - 1;
+    int32_t sub = bucket % FLECS_HISTOGRAM_SUB_COUNT;
+    uint64_t lower = (uint64_t)(FLECS_HISTOGRAM_SUB_COUNT + sub) << shift;
+    uint64_t width = (uint64_t)1 << shift;
+    return ((ecs_float_t)lower + (ecs_float_t)width / 2) / (ecs_float_t)1e6;
+}
+
+void flecs_histogram_record(
+    ecs_histogram_t *hist,
+    ecs_ftime_t value)
+{
+    if (value < 0) {
+        value = 0;
+    }
+
+    /* Bucket values are in microseconds */
+    uint64_t us = (uint64_t)((double)value * 1e6);
+    hist->count[flecs_histogram_bucket(us)] ++;
+}
+
+/* Compute percentiles for samples recorded between start and cur */
+static
+void flecs_histogram_percentiles(
+    const ecs_histogram_t *cur,
+    const ecs_histogram_t *start,
+    ecs_latency_t *l,
+    int32_t t)
+{
+    static const double p[] = { 0.5, 0.9, 0.99, 0.999 };
+    ecs_float_t *dst[] = { &l->p50[t], &l->p90[t], &l->p99[t], &l->p999[t] };
+    uint32_t total = 0, rank[4], seen = 0;
+    int32_t i, r = 0;
+
+    for (i = 0; i < ECS_HISTOGRAM_BUCKET_COUNT; i ++) {
+        /* Unsigned arithmetic, so difference is valid after overflow */
+        total += cur->count[i] - start->count[i];
+    }
+
+    for (i = 0; i < 4; i ++) {
+        double frank = p[i] * (double)total;
+        rank[i] = (uint32_t)frank;
+        if ((double)rank[i] < frank) {
+            rank[i] ++;
+        }
+        *dst[i] = 0;
+    }
+
+    if (!total) {
+        return;
+    }
+
+    for (i = 0; i < ECS_HISTOGRAM_BUCKET_COUNT && r < 4; i ++) {
+        seen += cur->count[i] - start->count[i];
+        while (r < 4 && seen >= rank[r]) {
+            *dst[r] = flecs_histogram_bucket_value(i);
+            r ++;
+        }
+    }
+}
+
+static
+void flecs_latency_record(
+    ecs_latency_t *l,
+    int32_t t,
+    const ecs_histogram_t *cur)
+{
+    flecs_histogram_percentiles(cur, &l->last, l, t);
+    l->start = l->last;
+    l->last = *cur;
+}
+
+static
+void flecs_latency_reduce(
+    ecs_latency_t *dst,
+    const ecs_latency_t *src,
+    int32_t t_dst)
+{
+    /* The last histogram of src includes all samples up to now, so samples for
+     * the reduced interval are the ones recorded since the last reduction. */
+    flecs_latency_record(dst, t_dst, &src->last);
+}
+
+static
+void flecs_latency_reduce_last(
+    ecs_latency_t *dst,
+    const ecs_latency_t *src,
+    int32_t t_dst,
+    int32_t t_src)
+{
+    /* Combine the last two measurements by computing the percentiles from the
+     * start of the previous measurement */
+    int32_t t_dst_next = t_next(t_dst);
+    dst->start = src->start;
+    flecs_histogram_percentiles(&dst->last, &dst->start, dst, t_dst);
+
+    /* Restore old value */
+    dst->p50[t_dst_next] = src->p50[t_src];
+    dst->p90[t_dst_next] = src->p90[t_src];
+    dst->p99[t_dst_next] = src->p99[t_src];
+    dst->p999[t_dst_next] = src->p999[t_src];
+}
+
+static
+void flecs_latency_copy(
+    ecs_latency_t *dst,
+    const ecs_latency_t *src,
+    int32_t t_dst,
+    int32_t t_src)
+{
+    dst->p50[t_dst] = src->p50[t_src];
+    dst->p90[t_dst] = src->p90[t_src];
+    dst->p99[t_dst] = src->p99[t_src];
+    dst->p999[t_dst] = src->p999[t_src];
+}
+
+static
+void flecs_latency_copy_last(
+    ecs_latency_t *dst,
+    const ecs_latency_t *src,
+    int32_t t_dst,
+    int32_t t_src)
+{
+    flecs_latency_copy(dst, src, t_dst, t_src);
+    dst->start = src->start;
+    dst->last = src->last;
+}
+
 void ecs_world_stats_get(
     const ecs_world_t *world,
     ecs_world_stats_t *s)
@@ -29781,6 +32356,7 @@ void ecs_world_stats_get(
     ECS_GAUGE_RECORD(&s->ids.type_count, t, ecs_sparse_count(world->type_info));
     ECS_COUNTER_RECORD(&s->ids.create_count, t, world->info.id_create_total);
     ECS_COUNTER_RECORD(&s->ids.delete_count, t, world->info.id_delete_total);
+    ECS_GAUGE_RECORD(&s->ids.target_index_count, t, world->info.target_index_count);
 
     ECS_GAUGE_RECORD(&s->queries.query_count, t, ecs_count_id(world, EcsQuery));
     ECS_GAUGE_RECORD(&s->queries.observer_count, t, ecs_count_id(world, EcsObserver));
@@ -29788,6 +32364,7 @@ void ecs_world_stats_get(
 
     ECS_COUNTER_RECORD(&s->tables.create_count, t, world->info.table_create_total);
     ECS_COUNTER_RECORD(&s->tables.delete_count, t, world->info.table_delete_total);
+    ECS_COUNTER_RECORD(&s->tables.match_count, t, world->info.table_match_total);
     ECS_GAUGE_RECORD(&s->tables.count, t, world->info.table_count);
     ECS_GAUGE_RECORD(&s->tables.empty_count, t, world->info.empty_table_count);
     ECS_GAUGE_RECORD(&s->tables.tag_only_count, t, world->info.tag_table_count);
@@ -29824,6 +32401,12 @@ void ecs_world_stats_get(
     ECS_COUNTER_RECORD(&s->memory.stack_free_count, t, ecs_stack_allocator_free_count);
     ECS_GAUGE_RECORD(&s->memory.stack_outstanding_alloc_count, t, outstanding_allocs);
 
+    ECS_GAUGE_RECORD(&s->memory.target_index_memory, t, world->info.target_index_memory);
+
+    flecs_latency_record(&s->latency.frame_time, t, &world->frame_time_hist);
+    flecs_latency_record(&s->latency.merge_time, t, &world->merge_time_hist);
+    flecs_latency_record(&s->latency.sync_time, t, &world->sync_time_hist);
+
 error:
     return;
 }
@@ -29834,6 +32417,12 @@ void ecs_world_stats_reduce(
 {
     flecs_stats_reduce(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst), 
         ECS_METRIC_FIRST(src), (dst->t = t_next(dst->t)), src->t);
+    flecs_latency_reduce(&dst->latency.frame_time, 
+        &src->latency.frame_time, dst->t);
+    flecs_latency_reduce(&dst->latency.merge_time, 
+        &src->latency.merge_time, dst->t);
+    flecs_latency_reduce(&dst->latency.sync_time, 
+        &src->latency.sync_time, dst->t);
 }
 
 void ecs_world_stats_reduce_last(
@@ -29843,6 +32432,12 @@ void ecs_world_stats_reduce_last(
 {
     flecs_stats_reduce_last(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst), 
         ECS_METRIC_FIRST(src), (dst->t = t_prev(dst->t)), src->t, count);
+    flecs_latency_reduce_last(&dst->latency.frame_time, 
+        &src->latency.frame_time, dst->t, src->t);
+    flecs_latency_reduce_last(&dst->latency.merge_time, 
+        &src->latency.merge_time, dst->t, src->t);
+    flecs_latency_reduce_last(&dst->latency.sync_time, 
+        &src->latency.sync_time, dst->t, src->t);
 }
 
 void ecs_world_stats_repeat_last(
@@ -29850,6 +32445,13 @@ void ecs_world_stats_repeat_last(
 {
     flecs_stats_repeat_last(ECS_METRIC_FIRST(stats), ECS_METRIC_LAST(stats),
         (stats->t = t_next(stats->t)));
+    int32_t prev = t_prev(stats->t);
+    flecs_latency_copy(&stats->latency.frame_time, 
+        &stats->latency.frame_time, stats->t, prev);
+    flecs_latency_copy(&stats->latency.merge_time, 
+        &stats->latency.merge_time, stats->t, prev);
+    flecs_latency_copy(&stats->latency.sync_time, 
+        &stats->latency.sync_time, stats->t, prev);
 }
 
 void ecs_world_stats_copy_last(
@@ -29858,6 +32460,12 @@ void ecs_world_stats_copy_last(
 {
     flecs_stats_copy_last(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst),
         ECS_METRIC_FIRST(src), dst->t, t_next(src->t));
+    flecs_latency_copy_last(&dst->latency.frame_time, 
+        &src->latency.frame_time, dst->t, t_next(src->t));
+    flecs_latency_copy_last(&dst->latency.merge_time, 
+        &src->latency.merge_time, dst->t, t_next(src->t));
+    flecs_latency_copy_last(&dst->latency.sync_time, 
+        &src->latency.sync_time, dst->t, t_next(src->t));
 }
 
 void ecs_query_stats_get(
@@ -29885,6 +32493,18 @@ void ecs_query_stats_get(
         ECS_GAUGE_RECORD(&s->matched_empty_table_count, t, 0);
     }
 
+#ifdef FLECS_QUERY_COUNTERS
+    ecs_query_counters_t c;
+    flecs_query_counters_get(ecs_get_world(world), query, &c);
+    ECS_COUNTER_RECORD(&s->iterated_table_count, t, c.table_count);
+    ECS_COUNTER_RECORD(&s->iterated_entity_count, t, c.entity_count);
+    ECS_COUNTER_RECORD(&s->skipped_table_count, t, c.skip_count);
+    ECS_COUNTER_RECORD(&s->change_check_count, t, c.change_check_count);
+    ECS_COUNTER_RECORD(&s->bytes_touched, t, c.bytes_touched);
+    ECS_COUNTER_RECORD(&s->rematch_time, t, c.rematch_time);
+    ECS_COUNTER_RECORD(&s->sort_time, t, c.sort_time);
+#endif
+
 error:
     return;
 }
@@ -29946,6 +32566,16 @@ bool ecs_system_stats_get(
     ECS_COUNTER_RECORD(&s->invoke_count, t, ptr->invoke_count);
     ECS_GAUGE_RECORD(&s->active, t, !ecs_has_id(world, system, EcsEmpty));
     ECS_GAUGE_RECORD(&s->enabled, t, !ecs_has_id(world, system, EcsDisabled));
+    flecs_latency_record(&s->time_latency, t, &ptr->time_hist);
+
+#ifdef FLECS_PERF_COUNTERS
+    ecs_perf_counters_t perf;
+    flecs_perf_get(world, system, &perf);
+    ECS_COUNTER_RECORD(&s->cycles, t, perf.cycles);
+    ECS_COUNTER_RECORD(&s->instructions, t, perf.instructions);
+    ECS_COUNTER_RECORD(&s->cache_misses, t, perf.cache_misses);
+    ECS_COUNTER_RECORD(&s->branch_misses, t, perf.branch_misses);
+#endif
 
     s->task = !(ptr->query->filter.flags & EcsFilterMatchThis);
 
@@ -29962,6 +32592,8 @@ void ecs_system_stats_reduce(
     dst->task = src->task;
     flecs_stats_reduce(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst), 
         ECS_METRIC_FIRST(src), dst->query.t, src->query.t);
+    flecs_latency_reduce(&dst->time_latency, &src->time_latency, 
+        dst->query.t);
 }
 
 void ecs_system_stats_reduce_last(
@@ -29973,6 +32605,8 @@ void ecs_system_stats_reduce_last(
     dst->task = src->task;
     flecs_stats_reduce_last(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst), 
         ECS_METRIC_FIRST(src), dst->query.t, src->query.t, count);
+    flecs_latency_reduce_last(&dst->time_latency, &src->time_latency, 
+        dst->query.t, src->query.t);
 }
 
 void ecs_system_stats_repeat_last(
@@ -29981,6 +32615,8 @@ void ecs_system_stats_repeat_last(
     ecs_query_stats_repeat_last(&stats->query);
     flecs_stats_repeat_last(ECS_METRIC_FIRST(stats), ECS_METRIC_LAST(stats),
         (stats->query.t));
+    flecs_latency_copy(&stats->time_latency, &stats->time_latency,
+        stats->query.t, t_prev(stats->query.t));
 }
 
 void ecs_system_stats_copy_last(
@@ -29991,6 +32627,8 @@ void ecs_system_stats_copy_last(
     dst->task = src->task;
     flecs_stats_copy_last(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst),
         ECS_METRIC_FIRST(src), dst->query.t, t_next(src->query.t));
+    flecs_latency_copy_last(&dst->time_latency, &src->time_latency,
+        dst->query.t, t_next(src->query.t));
 }
 
 #endif
@@ -30212,6 +32850,7 @@ void ecs_world_stats_log(
     flecs_gauge_print("type count", t, &s->ids.type_count);
     flecs_counter_print("id create count", t, &s->ids.create_count);
     flecs_counter_print("id delete count", t, &s->ids.delete_count);
+    flecs_gauge_print("target index count", t, &s->ids.target_index_count);
     ecs_trace("");
     flecs_gauge_print("alive entity count", t, &s->entities.count);
     flecs_gauge_print("not alive entity count", t, &s->entities.not_alive_count);
@@ -30228,6 +32867,7 @@ void ecs_world_stats_log(
     flecs_gauge_print("table cache record count", t, &s->tables.record_count);
     flecs_counter_print("table create count", t, &s->tables.create_count);
     flecs_counter_print("table delete count", t, &s->tables.delete_count);
+    flecs_counter_print("table match count", t, &s->tables.match_count);
     ecs_trace("");
     flecs_counter_print("add commands", t, &s->commands.add_count);
     flecs_counter_print("remove commands", t, &s->commands.remove_count);
@@ -31407,6 +34047,29 @@ ecs_snapshot_t* ecs_snapshot_take_w_iter(
     return result;
 }
 
+/* Add or remove table entities to/from relationship target indices */
+static
+void flecs_snapshot_index_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    bool add)
+{
+    if (!(table->flags & EcsTableHasTargetIndex)) {
+        return;
+    }
+
+    int32_t count = ecs_table_count(table);
+    if (!count) {
+        return;
+    }
+
+    if (add) {
+        flecs_target_index_add(world, table, 0, count, &table->type);
+    } else {
+        flecs_target_index_remove(world, table, 0, count, &table->type);
+    }
+}
+
 /* Restoring an unfiltered snapshot restores the world to the exact state it was
  * when the snapshot was taken. */
 static
@@ -31424,6 +34087,16 @@ void restore_unfiltered(
     int32_t i, count = (int32_t)flecs_sparse_last_id(&world->store.tables);
     int32_t snapshot_count = ecs_vector_count(snapshot->tables);
 
+    /* Replacing table data doesn't emit events, so remove entities from the
+     * relationship target indices before any table data is restored */
+    for (i = 0; i <= count; i ++) {
+        ecs_table_t *world_table = flecs_sparse_get(
+            &world->store.tables, ecs_table_t, (uint32_t)i);
+        if (world_table) {
+            flecs_snapshot_index_table(world, world_table, false);
+        }
+    }
+
     for (i = 0; i <= count; i ++) {
         ecs_table_t *world_table = flecs_sparse_get(
             &world->store.tables, ecs_table_t, (uint32_t)i);
@@ -31449,6 +34122,7 @@ void restore_unfiltered(
 
             if (snapshot_table->data) {
                 flecs_table_replace_data(world, table, snapshot_table->data);
+                flecs_snapshot_index_table(world, table, true);
             }
         
         /* If the world table still exists, replace its data */
@@ -31459,6 +34133,7 @@ void restore_unfiltered(
             if (snapshot_table->data) {
                 flecs_table_replace_data(
                     world, world_table, snapshot_table->data);
+                flecs_snapshot_index_table(world, world_table, true);
             } else {
                 flecs_table_clear_data(
                     world, world_table, &world_table->data);
@@ -31537,6 +34212,10 @@ void restore_filtered(
             ecs_entity_t e = entities[i];
             ecs_record_t *r = flecs_entities_get(world, e);
             if (r && r->table) {
+                if (r->table->flags & EcsTableHasTargetIndex) {
+                    flecs_target_index_remove(world, r->table, 
+                        ECS_RECORD_TO_ROW(r->row), 1, &r->table->type);
+                }
                 flecs_table_delete(world, r->table, 
                     ECS_RECORD_TO_ROW(r->row), true);
             } else {
@@ -31551,6 +34230,11 @@ void restore_filtered(
 
         flecs_table_merge(world, table, table, &table->data, snapshot_table->data);
 
+        if (new_count && (table->flags & EcsTableHasTargetIndex)) {
+            flecs_target_index_add(world, table, old_count, new_count, 
+                &table->type);
+        }
+
         /* Run OnSet systems for merged entities */
         if (new_count) {
             flecs_notify_on_set(
@@ -31740,6 +34424,13 @@ ecs_entity_t ecs_run_intern(
         stage = &world->stages[0];
     }
 
+    flecs_trace_begin(stage, EcsTraceSystem, system);
+
+#ifdef FLECS_PERF_COUNTERS
+    ecs_perf_counters_t perf_begin;
+    bool measure_perf = measure_time && flecs_perf_read(stage, &perf_begin);
+#endif
+
     /* Prepare the query iterator */
     ecs_iter_t pit, wit, qit = ecs_query_iter(thread_ctx, system_data->query);
     ecs_iter_t *it = &qit;
@@ -31752,8 +34443,12 @@ ecs_entity_t ecs_run_intern(
     }
 
     if (stage_count > 1 && system_data->multi_threaded) {
-        wit = ecs_worker_iter(it, stage_index, stage_count);
-        it = &wit;
+        if (system_data->multi_threaded_groups) {
+            ecs_query_set_group_worker(&qit, stage_index, stage_count);
+        } else {
+            wit = ecs_worker_iter(it, stage_index, stage_count);
+            it = &wit;
+        }
     }
 
     qit.system = system;
@@ -31776,7 +34471,11 @@ ecs_entity_t ecs_run_intern(
                 action(&qit);
             }
         } else {
+            /* The query iterator of each worker visits all tables, so count 
+             * the results the system actually processes. */
+            qit.priv.iter.query.skip_counters = true;
             while (ecs_iter_next(it)) {
+                flecs_query_count_result(system_data->query, it);
                 action(it);
             }
         }
@@ -31785,13 +34484,30 @@ ecs_entity_t ecs_run_intern(
     }
 
     if (measure_time) {
-        system_data->time_spent += (float)ecs_time_measure(&time_start);
+        ecs_ftime_t time_spent = (ecs_ftime_t)ecs_time_measure(&time_start);
+        system_data->time_spent += (float)time_spent;
+
+        /* Only record latency on the main thread, so that each sample is an 
+         * invocation and not a slice of a multi threaded invocation. Workers
+         * run in parallel, so the slice of the main thread approximates the
+         * duration of the invocation. */
+        if (!stage_index) {
+            flecs_histogram_record(&system_data->time_hist, time_spent);
+        }
     }
 
+#ifdef FLECS_PERF_COUNTERS
+    if (measure_perf) {
+        flecs_perf_record(stage, system, &perf_begin);
+    }
+#endif
+
     system_data->invoke_count ++;
 
     flecs_defer_end(world, stage);
 
+    flecs_trace_end(stage, EcsTraceSystem, system);
+
     return it->interrupted_by;
 }
 
@@ -31941,6 +34657,13 @@ ecs_entity_t ecs_system_init(
         system->multi_threaded = desc->multi_threaded;
         system->no_readonly = desc->no_readonly;
 
+        if (desc->multi_threaded_groups) {
+            ecs_assert(query->group_by != NULL, ECS_INVALID_PARAMETER, 
+                "multi_threaded_groups requires group_by");
+            system->multi_threaded = true;
+            system->multi_threaded_groups = true;
+        }
+
         if (desc->interval != 0 || desc->rate != 0 || desc->tick_source != 0) {
 #ifdef FLECS_TIMER
             if (desc->interval != 0) {
@@ -31984,6 +34707,12 @@ ecs_entity_t ecs_system_init(
         if (desc->multi_threaded) {
             system->multi_threaded = desc->multi_threaded;
         }
+        if (desc->multi_threaded_groups) {
+            ecs_check(system->query->group_by != NULL, ECS_INVALID_PARAMETER,
+                "multi_threaded_groups requires group_by");
+            system->multi_threaded = true;
+            system->multi_threaded_groups = true;
+        }
         if (desc->no_readonly) {
             system->no_readonly = desc->no_readonly;
         }
@@ -32018,6 +34747,12 @@ void FlecsSystemImport(
 
 #ifdef FLECS_JSON
 
+/* Size of local buffer used by serializer programs */
+#define FLECS_JSON_PROGRAM_BUFFER_SIZE (256)
+
+/* Max number of characters written for a single value by serializer programs */
+#define FLECS_JSON_MAX_VALUE_SIZE (64)
+
 void flecs_json_next(
     ecs_strbuf_t *buf);
 
@@ -32086,6 +34821,160 @@ void flecs_json_id(
 ecs_primitive_kind_t flecs_json_op_to_primitive_kind(
     ecs_meta_type_op_kind_t kind);
 
+bool flecs_json_skip_variable(
+    const char *name);
+
+bool flecs_json_skip_id(
+    const ecs_world_t *world,
+    ecs_id_t id,
+    const ecs_entity_to_json_desc_t *desc,
+    ecs_entity_t ent,
+    ecs_entity_t inst,
+    ecs_entity_t *pred_out,
+    ecs_entity_t *obj_out,
+    ecs_entity_t *role_out,
+    bool *hidden_out);
+
+/* CBOR major types */
+typedef enum ecs_cbor_major_t {
+    EcsCborUint = 0,
+    EcsCborNegInt = 1,
+    EcsCborBytes = 2,
+    EcsCborText = 3,
+    EcsCborArray = 4,
+    EcsCborMap = 5,
+    EcsCborTag = 6,
+    EcsCborSimple = 7
+} ecs_cbor_major_t;
+
+/* Additional information values of the initial byte */
+#define FLECS_CBOR_UINT8 (24)
+#define FLECS_CBOR_UINT16 (25)
+#define FLECS_CBOR_UINT32 (26)
+#define FLECS_CBOR_UINT64 (27)
+#define FLECS_CBOR_INDEFINITE (31)
+
+/* Simple values & floats (major type 7) */
+#define FLECS_CBOR_FALSE (0xf4)
+#define FLECS_CBOR_TRUE (0xf5)
+#define FLECS_CBOR_NULL (0xf6)
+#define FLECS_CBOR_FLOAT32 (0xfa)
+#define FLECS_CBOR_FLOAT64 (0xfb)
+#define FLECS_CBOR_BREAK (0xff)
+
+void flecs_cbor_head(
+    ecs_strbuf_t *buf,
+    uint8_t major,
+    uint64_t value);
+
+void flecs_cbor_uint(
+    ecs_strbuf_t *buf,
+    uint64_t value);
+
+void flecs_cbor_int(
+    ecs_strbuf_t *buf,
+    int64_t value);
+
+void flecs_cbor_float32(
+    ecs_strbuf_t *buf,
+    float value);
+
+void flecs_cbor_float64(
+    ecs_strbuf_t *buf,
+    double value);
+
+void flecs_cbor_bool(
+    ecs_strbuf_t *buf,
+    bool value);
+
+void flecs_cbor_null(
+    ecs_strbuf_t *buf);
+
+void flecs_cbor_array(
+    ecs_strbuf_t *buf,
+    int32_t count);
+
+void flecs_cbor_array_push(
+    ecs_strbuf_t *buf);
+
+void flecs_cbor_array_pop(
+    ecs_strbuf_t *buf);
+
+void flecs_cbor_object_push(
+    ecs_strbuf_t *buf);
+
+void flecs_cbor_object_pop(
+    ecs_strbuf_t *buf);
+
+void flecs_cbor_string(
+    ecs_strbuf_t *buf,
+    const char *value);
+
+void flecs_cbor_stringn(
+    ecs_strbuf_t *buf,
+    const char *value,
+    int32_t len);
+
+#define flecs_cbor_stringl(buf, value)\
+    flecs_cbor_stringn(buf, value, sizeof(value) - 1)
+
+/* Append contents of str as text string, resets str */
+void flecs_cbor_strbuf(
+    ecs_strbuf_t *buf,
+    ecs_strbuf_t *str);
+
+void flecs_cbor_path(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_entity_t e);
+
+void flecs_cbor_label(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_entity_t e);
+
+void flecs_cbor_color(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_entity_t e);
+
+void flecs_cbor_id(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_id_t id);
+
+void flecs_cbor_typed_array(
+    ecs_strbuf_t *buf,
+    uint64_t tag,
+    const void *data,
+    ecs_size_t size);
+
+/* Returns typed array tag for primitive kind, or 0 if kind can't be packed */
+uint64_t flecs_cbor_typed_array_tag(
+    ecs_meta_type_op_kind_t kind);
+
+/* Returns typed array tag for a type if values of the type can be written as a
+ * single typed array, or 0 if the type can't be packed. */
+uint64_t flecs_cbor_packed_tag(
+    const ecs_meta_type_op_t *ops,
+    int32_t op_count,
+    ecs_size_t size);
+
+int flecs_cbor_read_head(
+    const uint8_t **ptr,
+    const uint8_t *end,
+    ecs_cbor_major_t *major_out,
+    uint64_t *value_out,
+    bool *indefinite_out);
+
+bool flecs_cbor_is_break(
+    const uint8_t *ptr,
+    const uint8_t *end);
+
+double flecs_cbor_to_float(
+    uint8_t initial,
+    uint64_t value);
+
 #endif
 
 
@@ -32255,7 +35144,7 @@ ecs_primitive_kind_t flecs_json_op_to_primitive_kind(
 static
 int json_ser_type(
     const ecs_world_t *world,
-    ecs_vector_t *ser, 
+    const EcsMetaTypeSerialized *ser,
     const void *base, 
     ecs_strbuf_t *str);
 
@@ -32394,6 +35283,23 @@ int json_ser_type_elements(
     const EcsComponent *comp = ecs_get(world, type, EcsComponent);
     ecs_assert(comp != NULL, ECS_INTERNAL_ERROR, NULL);
 
+    if (ser->json_ops) {
+        flecs_json_array_push(str);
+
+        const void *ptr = base;
+        int32_t i;
+        for (i = 0; i < elem_count; i ++) {
+            ecs_strbuf_list_next(str);
+            if (json_ser_type(world, ser, ptr, str)) {
+                return -1;
+            }
+            ptr = ECS_OFFSET(ptr, comp->size);
+        }
+
+        flecs_json_array_pop(str);
+        return 0;
+    }
+
     ecs_meta_type_op_t *ops = ecs_vector_first(ser->ops, ecs_meta_type_op_t);
     int32_t op_count = ecs_vector_count(ser->ops);
 
@@ -32566,16 +35472,129 @@ error:
     return -1;
 }
 
+/* Run the flattened serializer program of a type. Values are formatted into a
+ * local buffer after the literal that precedes them, so that most values only
+ * require a single append to the output buffer. */
+static
+int json_ser_program(
+    const ecs_world_t *world,
+    const EcsMetaTypeSerialized *ser,
+    const void *base, 
+    ecs_strbuf_t *str) 
+{
+    ecs_meta_json_op_t *ops = ecs_vector_first(
+        ser->json_ops, ecs_meta_json_op_t);
+    int32_t i, count = ecs_vector_count(ser->json_ops);
+    const char *literals = ser->json_literals;
+    char buf[FLECS_JSON_PROGRAM_BUFFER_SIZE];
+    int32_t len = 0;
+
+    for (i = 0; i < count; i ++) {
+        ecs_meta_json_op_t *op = &ops[i];
+        const char *literal = &literals[op->literal];
+        int32_t literal_len = op->literal_len;
+
+        /* Make sure literal & largest formatted value fit in buffer */
+        if ((len + literal_len + FLECS_JSON_MAX_VALUE_SIZE) > ECS_SIZEOF(buf)) {
+            ecs_strbuf_appendstrn(str, buf, len);
+            len = 0;
+            if ((literal_len + FLECS_JSON_MAX_VALUE_SIZE) > ECS_SIZEOF(buf)) {
+                ecs_strbuf_appendstrn(str, literal, literal_len);
+                literal_len = 0;
+            }
+        }
+
+        ecs_os_memcpy(&buf[len], literal, literal_len);
+        len += literal_len;
+
+        const void *ptr = ECS_OFFSET(base, op->offset);
+        char *cur = &buf[len];
+
+        switch(op->kind) {
+        case EcsOpPop:
+            /* Last op, only contains trailing literal */
+            break;
+        case EcsOpBool:
+            if (*(bool*)ptr) {
+                ecs_os_memcpy(cur, "true", 4);
+                cur += 4;
+            } else {
+                ecs_os_memcpy(cur, "false", 5);
+                cur += 5;
+            }
+            break;
+        case EcsOpByte:
+        case EcsOpU8:
+            cur = flecs_itoa(cur, flecs_uto(int64_t, *(uint8_t*)ptr));
+            break;
+        case EcsOpU16:
+            cur = flecs_itoa(cur, flecs_uto(int64_t, *(uint16_t*)ptr));
+            break;
+        case EcsOpU32:
+            cur = flecs_itoa(cur, flecs_uto(int64_t, *(uint32_t*)ptr));
+            break;
+        case EcsOpI8:
+            cur = flecs_itoa(cur, flecs_ito(int64_t, *(int8_t*)ptr));
+            break;
+        case EcsOpI16:
+            cur = flecs_itoa(cur, flecs_ito(int64_t, *(int16_t*)ptr));
+            break;
+        case EcsOpI32:
+            cur = flecs_itoa(cur, flecs_ito(int64_t, *(int32_t*)ptr));
+            break;
+        case EcsOpI64:
+            cur = flecs_itoa(cur, *(int64_t*)ptr);
+            break;
+        case EcsOpIPtr:
+            cur = flecs_itoa(cur, flecs_ito(int64_t, *(intptr_t*)ptr));
+            break;
+        case EcsOpF32:
+            cur = flecs_ftoa(cur, (ecs_f64_t)*(ecs_f32_t*)ptr, 10, '"');
+            break;
+        case EcsOpF64:
+            cur = flecs_ftoa(cur, *(ecs_f64_t*)ptr, 10, '"');
+            break;
+        case EcsOpU64:
+            if (*(uint64_t*)ptr <= INT64_MAX) {
+                cur = flecs_itoa(cur, (int64_t)*(uint64_t*)ptr);
+                break;
+            }
+            /* fall through */
+        default: {
+            /* Values that require escaping or lookups use the regular
+             * serializer, which appends directly to the output buffer */
+            ecs_strbuf_appendstrn(str, buf, len);
+            cur = buf;
+            ecs_meta_type_op_t value_op = { .kind = op->kind };
+            if (json_ser_type_op(world, &value_op, ptr, str)) {
+                return -1;
+            }
+            break;
+        }
+        }
+
+        len = (int32_t)(cur - buf);
+    }
+
+    ecs_strbuf_appendstrn(str, buf, len);
+
+    return 0;
+}
+
 /* Iterate over the type ops of a type */
 static
 int json_ser_type(
     const ecs_world_t *world,
-    ecs_vector_t *v_ops,
+    const EcsMetaTypeSerialized *ser,
     const void *base, 
     ecs_strbuf_t *str) 
 {
-    ecs_meta_type_op_t *ops = ecs_vector_first(v_ops, ecs_meta_type_op_t);
-    int32_t count = ecs_vector_count(v_ops);
+    if (ser->json_ops) {
+        return json_ser_program(world, ser, base, str);
+    }
+
+    ecs_meta_type_op_t *ops = ecs_vector_first(ser->ops, ecs_meta_type_op_t);
+    int32_t count = ecs_vector_count(ser->ops);
     return json_ser_type_ops(world, ops, count, base, str, 0);
 }
 
@@ -32595,7 +35614,7 @@ int array_to_json_buf_w_type_data(
 
         do {
             ecs_strbuf_list_next(buf);
-            if (json_ser_type(world, ser->ops, ptr, buf)) {
+            if (json_ser_type(world, ser, ptr, buf)) {
                 return -1;
             }
 
@@ -32604,7 +35623,7 @@ int array_to_json_buf_w_type_data(
 
         flecs_json_array_pop(buf);
     } else {
-        if (json_ser_type(world, ser->ops, ptr, buf)) {
+        if (json_ser_type(world, ser, ptr, buf)) {
             return -1;
         }
     }
@@ -32672,8 +35691,7 @@ char* ecs_ptr_to_json(
     return ecs_array_to_json(world, type, ptr, 0);
 }
 
-static
-bool skip_id(
+bool flecs_json_skip_id(
     const ecs_world_t *world,
     ecs_id_t id,
     const ecs_entity_to_json_desc_t *desc,
@@ -32762,7 +35780,7 @@ int flecs_json_append_type_labels(
     int32_t i;
     for (i = 0; i < count; i ++) {
         ecs_entity_t pred = 0, obj = 0, role = 0;
-        if (skip_id(world, ids[i], desc, ent, inst, &pred, &obj, &role, 0)) {
+        if (flecs_json_skip_id(world, ids[i], desc, ent, inst, &pred, &obj, &role, 0)) {
             continue;
         }
 
@@ -32819,7 +35837,7 @@ int flecs_json_append_type_values(
         bool hidden;
         ecs_entity_t pred = 0, obj = 0, role = 0;
         ecs_id_t id = ids[i];
-        if (skip_id(world, id, desc, ent, inst, &pred, &obj, &role, 
+        if (flecs_json_skip_id(world, id, desc, ent, inst, &pred, &obj, &role, 
             &hidden)) 
         {
             continue;
@@ -32836,7 +35854,7 @@ int flecs_json_append_type_values(
                     ecs_assert(ptr != NULL, ECS_INTERNAL_ERROR, NULL);
 
                     flecs_json_next(buf);
-                    if (json_ser_type(world, ser->ops, ptr, buf) != 0) {
+                    if (json_ser_type(world, ser, ptr, buf) != 0) {
                         /* Entity contains invalid value */
                         return -1;
                     }
@@ -32882,7 +35900,7 @@ int flecs_json_append_type_info(
         bool hidden;
         ecs_entity_t pred = 0, obj = 0, role = 0;
         ecs_id_t id = ids[i];
-        if (skip_id(world, id, desc, ent, inst, &pred, &obj, &role, 
+        if (flecs_json_skip_id(world, id, desc, ent, inst, &pred, &obj, &role, 
             &hidden)) 
         {
             continue;
@@ -32938,7 +35956,7 @@ int flecs_json_append_type_hidden(
         bool hidden;
         ecs_entity_t pred = 0, obj = 0, role = 0;
         ecs_id_t id = ids[i];
-        if (skip_id(world, id, desc, ent, inst, &pred, &obj, &role, 
+        if (flecs_json_skip_id(world, id, desc, ent, inst, &pred, &obj, &role, 
             &hidden)) 
         {
             continue;
@@ -32976,7 +35994,7 @@ int flecs_json_append_type(
 
     for (i = 0; i < count; i ++) {
         ecs_entity_t pred = 0, obj = 0, role = 0;
-        if (skip_id(world, ids[i], desc, ent, inst, &pred, &obj, &role, 0)) {
+        if (flecs_json_skip_id(world, ids[i], desc, ent, inst, &pred, &obj, &role, 0)) {
             continue;
         }
 
@@ -33182,7 +36200,6 @@ char* ecs_entity_to_json(
     return ecs_strbuf_get(&buf);
 }
 
-static
 bool flecs_json_skip_variable(
     const char *name)
 {
@@ -33666,6 +36683,179 @@ void flecs_json_serialize_iter_result(
     flecs_json_object_pop(buf);
 }
 
+/* Copy of an iterator result that stays valid after the iterator advances */
+typedef struct ecs_json_iter_result_t {
+    ecs_iter_t it;
+    int32_t weight;
+} ecs_json_iter_result_t;
+
+/* Contiguous range of results serialized by a single thread */
+typedef struct ecs_json_iter_job_t {
+    const ecs_world_t *world;
+    const ecs_iter_to_json_desc_t *desc;
+    ecs_json_iter_result_t **results;
+    int32_t start;
+    int32_t end;
+    ecs_strbuf_t buf;
+} ecs_json_iter_job_t;
+
+static
+ecs_size_t flecs_json_iter_array_size(
+    ecs_size_t elem_size,
+    int32_t count)
+{
+    return (elem_size * count + 7) & ~7;
+}
+
+#define flecs_json_copy_array(dst, ptr, src, count)\
+    if (src) {\
+        ecs_os_memcpy(ptr, src, ECS_SIZEOF(*(src)) * (count));\
+        (dst) = (void*)(ptr);\
+        (ptr) = ECS_OFFSET(ptr,\
+            flecs_json_iter_array_size(ECS_SIZEOF(*(src)), count));\
+    }
+
+/* Copy the arrays of the current result that the iterator may overwrite when
+ * it moves to the next result. Component data and names point to storage that
+ * isn't modified while serializing, and are not copied. */
+static
+ecs_json_iter_result_t* flecs_json_iter_result_copy(
+    const ecs_iter_t *it)
+{
+    int32_t field_count = it->field_count;
+    int32_t count = it->entities ? it->count : 0;
+    int32_t var_count = it->variables ? it->variable_count : 0;
+
+    ecs_size_t size = 
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_json_iter_result_t), 1) +
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_id_t), field_count) +
+        flecs_json_iter_array_size(ECS_SIZEOF(int32_t), field_count) +
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_entity_t), field_count) +
+        flecs_json_iter_array_size(ECS_SIZEOF(void*), field_count) +
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_ref_t), field_count) +
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_entity_t), count) +
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_var_t), var_count);
+
+    ecs_json_iter_result_t *result = ecs_os_malloc(size);
+    result->it = *it;
+    result->weight = it->count + 1;
+
+    ecs_iter_t *dst = &result->it;
+    void *ptr = ECS_OFFSET(result, 
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_json_iter_result_t), 1));
+    flecs_json_copy_array(dst->ids, ptr, it->ids, field_count);
+    flecs_json_copy_array(dst->columns, ptr, it->columns, field_count);
+    flecs_json_copy_array(dst->sources, ptr, it->sources, field_count);
+    flecs_json_copy_array(dst->ptrs, ptr, it->ptrs, field_count);
+    flecs_json_copy_array(dst->references, ptr, it->references, field_count);
+    flecs_json_copy_array(dst->entities, ptr, it->entities, count);
+    flecs_json_copy_array(dst->variables, ptr, it->variables, var_count);
+
+    return result;
+}
+
+static
+void* flecs_json_iter_job(
+    void *arg)
+{
+    ecs_json_iter_job_t *job = arg;
+
+    /* Start a list, so that results are separated like in the output */
+    ecs_strbuf_list_push(&job->buf, "", ", ");
+
+    int32_t i;
+    for (i = job->start; i < job->end; i ++) {
+        flecs_json_serialize_iter_result(
+            job->world, &job->results[i]->it, &job->buf, job->desc);
+    }
+
+    ecs_strbuf_list_pop(&job->buf, "");
+    return NULL;
+}
+
+/* Collect results from the iterator, then serialize ranges of results with
+ * roughly the same number of entities on separate threads. Each thread writes
+ * to its own buffer, which are concatenated in order. */
+static
+void flecs_json_serialize_iter_results_parallel(
+    const ecs_world_t *world,
+    ecs_iter_t *it,
+    ecs_strbuf_t *buf,
+    const ecs_iter_to_json_desc_t *desc)
+{
+    ecs_vector_t *results = NULL;
+    int64_t total = 0;
+
+    ecs_iter_next_action_t next = it->next;
+    while (next(it)) {
+        ecs_json_iter_result_t **elem = ecs_vector_add(
+            &results, ecs_json_iter_result_t*);
+        *elem = flecs_json_iter_result_copy(it);
+        total += (*elem)->weight;
+    }
+
+    int32_t i, result_count = ecs_vector_count(results);
+    ecs_json_iter_result_t **ptrs = ecs_vector_first(
+        results, ecs_json_iter_result_t*);
+
+    int32_t job_count = desc->threads;
+    if (job_count > result_count) {
+        job_count = result_count;
+    }
+    if (!job_count) {
+        ecs_vector_free(results);
+        return;
+    }
+
+    ecs_json_iter_job_t *jobs = ecs_os_calloc_n(ecs_json_iter_job_t, 
+        job_count);
+    ecs_os_thread_t *threads = ecs_os_calloc_n(ecs_os_thread_t, job_count);
+
+    int32_t job = 0;
+    int64_t weight = 0;
+    for (i = 0; i < job_count; i ++) {
+        jobs[i].world = world;
+        jobs[i].desc = desc;
+        jobs[i].results = ptrs;
+    }
+
+    for (i = 0; i < result_count; i ++) {
+        weight += ptrs[i]->weight;
+        jobs[job].end = i + 1;
+        if (job < (job_count - 1) && 
+            weight >= total * (job + 1) / job_count) 
+        {
+            job ++;
+            jobs[job].start = i + 1;
+            jobs[job].end = i + 1;
+        }
+    }
+
+    /* Last job runs on the calling thread */
+    for (i = 0; i < (job_count - 1); i ++) {
+        threads[i] = ecs_os_thread_new(flecs_json_iter_job, &jobs[i]);
+    }
+    flecs_json_iter_job(&jobs[job_count - 1]);
+
+    for (i = 0; i < job_count; i ++) {
+        if (i < (job_count - 1)) {
+            ecs_os_thread_join(threads[i]);
+        }
+        if (ecs_strbuf_written(&jobs[i].buf)) {
+            ecs_strbuf_list_next(buf);
+            ecs_strbuf_mergebuff(buf, &jobs[i].buf);
+        }
+    }
+
+    for (i = 0; i < result_count; i ++) {
+        ecs_os_free(ptrs[i]);
+    }
+
+    ecs_os_free(threads);
+    ecs_os_free(jobs);
+    ecs_vector_free(results);
+}
+
 int ecs_iter_to_json_buf(
     const ecs_world_t *world,
     ecs_iter_t *it,
@@ -33699,9 +36889,13 @@ int ecs_iter_to_json_buf(
     /* Use instancing for improved performance */
     ECS_BIT_SET(it->flags, EcsIterIsInstanced);
 
-    ecs_iter_next_action_t next = it->next;
-    while (next(it)) {
-        flecs_json_serialize_iter_result(world, it, buf, desc);
+    if (desc && desc->threads > 1 && ecs_os_has_threading()) {
+        flecs_json_serialize_iter_results_parallel(world, it, buf, desc);
+    } else {
+        ecs_iter_next_action_t next = it->next;
+        while (next(it)) {
+            flecs_json_serialize_iter_result(world, it, buf, desc);
+        }
     }
 
     flecs_json_array_pop(buf);
@@ -34195,446 +37389,3118 @@ error:
 
 #endif
 
+/**
+ * @file addons/json/cbor.c
+ * @brief CBOR (RFC 8949) encoding utilities.
+ *
+ * The binary serializer writes the same data model as the JSON serializer, so
+ * that clients can decode a reply into the same structure regardless of the
+ * format. Multi-byte values in item headers are big endian as required by the
+ * specification, typed arrays (RFC 8746) use the byte order of the host.
+ */
 
-#ifdef FLECS_REST
 
-typedef struct {
-    ecs_world_t *world;
-    ecs_entity_t entity;
-    ecs_http_server_t *srv;
-    int32_t rc;
-} ecs_rest_ctx_t;
+#ifdef FLECS_JSON
 
-static ECS_COPY(EcsRest, dst, src, {
-    ecs_rest_ctx_t *impl = src->impl;
-    if (impl) {
-        impl->rc ++;
-    }
+static
+void flecs_cbor_byte(
+    ecs_strbuf_t *buf,
+    uint8_t value)
+{
+    ecs_strbuf_appendch(buf, (char)value);
+}
 
-    ecs_os_strset(&dst->ipaddr, src->ipaddr);
-    dst->port = src->port;
-    dst->impl = impl;
-})
+void flecs_cbor_head(
+    ecs_strbuf_t *buf,
+    uint8_t major,
+    uint64_t value)
+{
+    uint8_t bytes[9];
+    int32_t count;
+    major = (uint8_t)(major << 5);
 
-static ECS_MOVE(EcsRest, dst, src, {
-    *dst = *src;
-    src->ipaddr = NULL;
-    src->impl = NULL;
-})
+    if (value < FLECS_CBOR_UINT8) {
+        bytes[0] = (uint8_t)(major | value);
+        count = 0;
+    } else if (value <= UINT8_MAX) {
+        bytes[0] = (uint8_t)(major | FLECS_CBOR_UINT8);
+        count = 1;
+    } else if (value <= UINT16_MAX) {
+        bytes[0] = (uint8_t)(major | FLECS_CBOR_UINT16);
+        count = 2;
+    } else if (value <= UINT32_MAX) {
+        bytes[0] = (uint8_t)(major | FLECS_CBOR_UINT32);
+        count = 4;
+    } else {
+        bytes[0] = (uint8_t)(major | FLECS_CBOR_UINT64);
+        count = 8;
+    }
 
-static ECS_DTOR(EcsRest, ptr, { 
-    ecs_rest_ctx_t *impl = ptr->impl;
-    if (impl) {
-        impl->rc --;
-        if (!impl->rc) {
-            ecs_http_server_fini(impl->srv);
-            ecs_os_free(impl);
-        }
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        bytes[count - i] = (uint8_t)(value >> (i * 8));
     }
-    ecs_os_free(ptr->ipaddr);
-})
 
-static char *rest_last_err;
+    ecs_strbuf_appendbin(buf, bytes, count + 1);
+}
 
-static 
-void flecs_rest_capture_log(
-    int32_t level, 
-    const char *file, 
-    int32_t line, 
-    const char *msg)
+void flecs_cbor_uint(
+    ecs_strbuf_t *buf,
+    uint64_t value)
 {
-    (void)file; (void)line;
+    flecs_cbor_head(buf, EcsCborUint, value);
+}
 
-    if (!rest_last_err && level < 0) {
-        rest_last_err = ecs_os_strdup(msg);
+void flecs_cbor_int(
+    ecs_strbuf_t *buf,
+    int64_t value)
+{
+    if (value >= 0) {
+        flecs_cbor_head(buf, EcsCborUint, (uint64_t)value);
+    } else {
+        /* Negative integers are encoded as -1 - value */
+        flecs_cbor_head(buf, EcsCborNegInt, (uint64_t)(-1 - value));
     }
 }
 
-static
-char* flecs_rest_get_captured_log(void) {
-    char *result = rest_last_err;
-    rest_last_err = NULL;
-    return result;
+void flecs_cbor_float32(
+    ecs_strbuf_t *buf,
+    float value)
+{
+    uint32_t bits;
+    ecs_os_memcpy(&bits, &value, 4);
+
+    uint8_t bytes[5] = { FLECS_CBOR_FLOAT32,
+        (uint8_t)(bits >> 24), (uint8_t)(bits >> 16),
+        (uint8_t)(bits >> 8), (uint8_t)bits };
+    ecs_strbuf_appendbin(buf, bytes, 5);
 }
 
-static
-void flecs_reply_verror(
-    ecs_http_reply_t *reply,
-    const char *fmt,
-    va_list args)
+void flecs_cbor_float64(
+    ecs_strbuf_t *buf,
+    double value)
 {
-    ecs_strbuf_appendlit(&reply->body, "{\"error\":\"");
-    ecs_strbuf_vappend(&reply->body, fmt, args);
-    ecs_strbuf_appendlit(&reply->body, "\"}");
+    uint64_t bits;
+    ecs_os_memcpy(&bits, &value, 8);
+
+    uint8_t bytes[9];
+    bytes[0] = FLECS_CBOR_FLOAT64;
+    int32_t i;
+    for (i = 0; i < 8; i ++) {
+        bytes[8 - i] = (uint8_t)(bits >> (i * 8));
+    }
+    ecs_strbuf_appendbin(buf, bytes, 9);
 }
 
-static
-void flecs_reply_error(
-    ecs_http_reply_t *reply,
-    const char *fmt,
-    ...)
+void flecs_cbor_bool(
+    ecs_strbuf_t *buf,
+    bool value)
 {
-    va_list args;
-    va_start(args, fmt);
-    flecs_reply_verror(reply, fmt, args);
-    va_end(args);
+    flecs_cbor_byte(buf, value ? FLECS_CBOR_TRUE : FLECS_CBOR_FALSE);
 }
 
-static
-void flecs_rest_bool_param(
-    const ecs_http_request_t *req,
-    const char *name,
-    bool *value_out)
+void flecs_cbor_null(
+    ecs_strbuf_t *buf)
 {
-    const char *value = ecs_http_get_param(req, name);
-    if (value) {
-        if (!ecs_os_strcmp(value, "true")) {
-            value_out[0] = true;
-        } else {
-            value_out[0] = false;
-        }
-    }
+    flecs_cbor_byte(buf, FLECS_CBOR_NULL);
 }
 
-static
-void flecs_rest_int_param(
-    const ecs_http_request_t *req,
-    const char *name,
-    int32_t *value_out)
+void flecs_cbor_array(
+    ecs_strbuf_t *buf,
+    int32_t count)
 {
-    const char *value = ecs_http_get_param(req, name);
-    if (value) {
-        *value_out = atoi(value);
-    }
+    flecs_cbor_head(buf, EcsCborArray, flecs_uto(uint64_t, count));
 }
 
-static
-void flecs_rest_string_param(
-    const ecs_http_request_t *req,
-    const char *name,
-    char **value_out)
+void flecs_cbor_array_push(
+    ecs_strbuf_t *buf)
 {
-    const char *value = ecs_http_get_param(req, name);
-    if (value) {
-        *value_out = (char*)value;
-    }
+    flecs_cbor_byte(buf, (EcsCborArray << 5) | FLECS_CBOR_INDEFINITE);
 }
 
-static
-void flecs_rest_parse_json_ser_entity_params(
-    ecs_entity_to_json_desc_t *desc,
-    const ecs_http_request_t *req)
+void flecs_cbor_array_pop(
+    ecs_strbuf_t *buf)
 {
-    flecs_rest_bool_param(req, "path", &desc->serialize_path);
-    flecs_rest_bool_param(req, "label", &desc->serialize_label);
-    flecs_rest_bool_param(req, "brief", &desc->serialize_brief);
-    flecs_rest_bool_param(req, "link", &desc->serialize_link);
-    flecs_rest_bool_param(req, "color", &desc->serialize_color);
-    flecs_rest_bool_param(req, "id_labels", &desc->serialize_id_labels);
-    flecs_rest_bool_param(req, "base", &desc->serialize_base);
-    flecs_rest_bool_param(req, "values", &desc->serialize_values);
-    flecs_rest_bool_param(req, "private", &desc->serialize_private);
-    flecs_rest_bool_param(req, "type_info", &desc->serialize_type_info);
+    flecs_cbor_byte(buf, FLECS_CBOR_BREAK);
 }
 
-static
-void flecs_rest_parse_json_ser_iter_params(
-    ecs_iter_to_json_desc_t *desc,
-    const ecs_http_request_t *req)
+void flecs_cbor_object_push(
+    ecs_strbuf_t *buf)
 {
-    flecs_rest_bool_param(req, "term_ids", &desc->serialize_term_ids);
-    flecs_rest_bool_param(req, "ids", &desc->serialize_ids);
-    flecs_rest_bool_param(req, "sources", &desc->serialize_sources);
-    flecs_rest_bool_param(req, "variables", &desc->serialize_variables);
-    flecs_rest_bool_param(req, "is_set", &desc->serialize_is_set);
-    flecs_rest_bool_param(req, "values", &desc->serialize_values);
-    flecs_rest_bool_param(req, "entities", &desc->serialize_entities);
-    flecs_rest_bool_param(req, "entity_labels", &desc->serialize_entity_labels);
-    flecs_rest_bool_param(req, "entity_ids", &desc->serialize_entity_ids);
-    flecs_rest_bool_param(req, "variable_labels", &desc->serialize_variable_labels);
-    flecs_rest_bool_param(req, "variable_ids", &desc->serialize_variable_ids);
-    flecs_rest_bool_param(req, "colors", &desc->serialize_colors);
-    flecs_rest_bool_param(req, "duration", &desc->measure_eval_duration);
-    flecs_rest_bool_param(req, "type_info", &desc->serialize_type_info);
+    flecs_cbor_byte(buf, (EcsCborMap << 5) | FLECS_CBOR_INDEFINITE);
 }
 
-static
-bool flecs_rest_reply_entity(
-    ecs_world_t *world,
-    const ecs_http_request_t* req,
-    ecs_http_reply_t *reply)
+void flecs_cbor_object_pop(
+    ecs_strbuf_t *buf)
 {
-    char *path = &req->path[7];
-    ecs_dbg_2("rest: request entity '%s'", path);
-
-    ecs_entity_t e = ecs_lookup_path_w_sep(
-        world, 0, path, "/", NULL, false);
-    if (!e) {
-        ecs_dbg_2("rest: entity '%s' not found", path);
-        flecs_reply_error(reply, "entity '%s' not found", path);
-        reply->code = 404;
-        return true;
-    }
+    flecs_cbor_byte(buf, FLECS_CBOR_BREAK);
+}
 
-    ecs_entity_to_json_desc_t desc = ECS_ENTITY_TO_JSON_INIT;
-    flecs_rest_parse_json_ser_entity_params(&desc, req);
+void flecs_cbor_stringn(
+    ecs_strbuf_t *buf,
+    const char *value,
+    int32_t len)
+{
+    flecs_cbor_head(buf, EcsCborText, flecs_uto(uint64_t, len));
+    ecs_strbuf_appendbin(buf, value, len);
+}
 
-    ecs_entity_to_json_buf(world, e, &reply->body, &desc);
-    return true;
+void flecs_cbor_string(
+    ecs_strbuf_t *buf,
+    const char *value)
+{
+    if (value) {
+        flecs_cbor_stringn(buf, value, ecs_os_strlen(value));
+    } else {
+        flecs_cbor_null(buf);
+    }
 }
 
-static
-bool flecs_rest_reply_query(
-    ecs_world_t *world,
-    const ecs_http_request_t* req,
-    ecs_http_reply_t *reply)
+void flecs_cbor_strbuf(
+    ecs_strbuf_t *buf,
+    ecs_strbuf_t *str)
 {
-    const char *q = ecs_http_get_param(req, "q");
-    if (!q) {
-        ecs_strbuf_appendlit(&reply->body, "Missing parameter 'q'");
-        reply->code = 400; /* bad request */
-        return true;
+    int32_t len = ecs_strbuf_written(str);
+    if (len <= ECS_STRBUF_ELEMENT_SIZE) {
+        /* Don't allocate for strings that fit in the first element */
+        flecs_cbor_stringn(buf, ecs_strbuf_get_small(str), len);
+        ecs_strbuf_reset(str);
+    } else {
+        char *value = ecs_strbuf_get(str);
+        flecs_cbor_stringn(buf, value, len);
+        ecs_os_free(value);
     }
+}
 
-    ecs_dbg_2("rest: request query '%s'", q);
-    bool prev_color = ecs_log_enable_colors(false);
-    ecs_os_api_log_t prev_log_ = ecs_os_api.log_;
-    ecs_os_api.log_ = flecs_rest_capture_log;
+void flecs_cbor_path(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_entity_t e)
+{
+    ecs_strbuf_t str = ECS_STRBUF_INIT;
+    ecs_get_path_w_sep_buf(world, 0, e, ".", "", &str);
+    flecs_cbor_strbuf(buf, &str);
+}
 
-    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
-        .expr = q
-    });
-    if (!r) {
-        char *err = flecs_rest_get_captured_log();
-        char *escaped_err = ecs_astresc('"', err);
-        flecs_reply_error(reply, escaped_err);
-        reply->code = 400; /* bad request */
-        ecs_os_free(escaped_err);
-        ecs_os_free(err);
+void flecs_cbor_label(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_entity_t e)
+{
+    const char *lbl = NULL;
+#ifdef FLECS_DOC
+    lbl = ecs_doc_get_name(world, e);
+#else
+    lbl = ecs_get_name(world, e);
+#endif
+
+    if (lbl) {
+        flecs_cbor_string(buf, lbl);
     } else {
-        ecs_iter_to_json_desc_t desc = ECS_ITER_TO_JSON_INIT;
-        flecs_rest_parse_json_ser_iter_params(&desc, req);
+        flecs_cbor_uint(buf, 0);
+    }
+}
 
-        int32_t offset = 0;
-        int32_t limit = 1000;
+void flecs_cbor_color(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_entity_t e)
+{
+    (void)world;
+    (void)e;
 
-        flecs_rest_int_param(req, "offset", &offset);
-        flecs_rest_int_param(req, "limit", &limit);
+    const char *color = NULL;
+#ifdef FLECS_DOC
+    color = ecs_doc_get_color(world, e);
+#endif
 
-        ecs_iter_t it = ecs_rule_iter(world, r);
-        ecs_iter_t pit = ecs_page_iter(&it, offset, limit);
-        ecs_iter_to_json_buf(world, &pit, &reply->body, &desc);
-        ecs_rule_fini(r);
+    if (color) {
+        flecs_cbor_string(buf, color);
+    } else {
+        flecs_cbor_uint(buf, 0);
     }
+}
 
-    ecs_os_api.log_ = prev_log_;
-    ecs_log_enable_colors(prev_color);
-
-    return true;
+void flecs_cbor_id(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_id_t id)
+{
+    ecs_strbuf_t str = ECS_STRBUF_INIT;
+    ecs_id_str_buf(world, id, &str);
+    flecs_cbor_strbuf(buf, &str);
 }
 
-#ifdef FLECS_MONITOR
+void flecs_cbor_typed_array(
+    ecs_strbuf_t *buf,
+    uint64_t tag,
+    const void *data,
+    ecs_size_t size)
+{
+    flecs_cbor_head(buf, EcsCborTag, tag);
+    flecs_cbor_head(buf, EcsCborBytes, flecs_uto(uint64_t, size));
+    ecs_strbuf_appendbin(buf, data, size);
+}
 
 static
-void _flecs_rest_array_append(
-    ecs_strbuf_t *reply,
-    const char *field,
-    int32_t field_len,
-    const ecs_float_t *values,
-    int32_t t)
+bool flecs_cbor_little_endian(void) {
+    uint16_t value = 1;
+    return ((uint8_t*)&value)[0] == 1;
+}
+
+uint64_t flecs_cbor_typed_array_tag(
+    ecs_meta_type_op_kind_t kind)
 {
-    ecs_strbuf_list_appendch(reply, '"');
-    ecs_strbuf_appendstrn(reply, field, field_len);
-    ecs_strbuf_appendlit(reply, "\":");
-    ecs_strbuf_list_push(reply, "[", ",");
+    /* Typed array tags are encoded as 0b010_f_s_e_ll, where f is set for
+     * floating point types, s for signed integers, e for little endian and
+     * ll is the size class of the element. */
+    uint64_t tag;
+    switch(kind) {
+    case EcsOpByte:
+    case EcsOpU8:  return 64; /* Endianness does not apply to 8 bit types */
+    case EcsOpI8:  return 72;
+    case EcsOpU16: tag = 65; break;
+    case EcsOpU32: tag = 66; break;
+    case EcsOpU64: tag = 67; break;
+    case EcsOpI16: tag = 73; break;
+    case EcsOpI32: tag = 74; break;
+    case EcsOpI64: tag = 75; break;
+    case EcsOpF32: tag = 81; break;
+    case EcsOpF64: tag = 82; break;
+    default:
+        return 0;
+    }
 
-    int32_t i;
-    for (i = t + 1; i <= (t + ECS_STAT_WINDOW); i ++) {
-        int32_t index = i % ECS_STAT_WINDOW;
-        ecs_strbuf_list_next(reply);
-        ecs_strbuf_appendflt(reply, (double)values[index], '"');
+    if (flecs_cbor_little_endian()) {
+        tag |= 4;
     }
 
-    ecs_strbuf_list_pop(reply, "]");
+    return tag;
 }
 
-#define flecs_rest_array_append(reply, field, values, t)\
-    _flecs_rest_array_append(reply, field, sizeof(field) - 1, values, t)
-
-static
-void flecs_rest_gauge_append(
-    ecs_strbuf_t *reply,
-    const ecs_metric_t *m,
-    const char *field,
-    int32_t field_len,
-    int32_t t,
-    const char *brief,
-    int32_t brief_len)
+uint64_t flecs_cbor_packed_tag(
+    const ecs_meta_type_op_t *ops,
+    int32_t op_count,
+    ecs_size_t size)
 {
-    ecs_strbuf_list_appendch(reply, '"');
-    ecs_strbuf_appendstrn(reply, field, field_len);
-    ecs_strbuf_appendlit(reply, "\":");
-    ecs_strbuf_list_push(reply, "{", ",");
+    ecs_meta_type_op_kind_t kind = EcsOpPush;
+    ecs_size_t packed_size = 0;
 
-    flecs_rest_array_append(reply, "avg", m->gauge.avg, t);
-    flecs_rest_array_append(reply, "min", m->gauge.min, t);
-    flecs_rest_array_append(reply, "max", m->gauge.max, t);
+    int32_t i;
+    for (i = 0; i < op_count; i ++) {
+        const ecs_meta_type_op_t *op = &ops[i];
+        if (op->kind == EcsOpPush || op->kind == EcsOpPop) {
+            if (op->count > 1) {
+                /* Inline array of structs */
+                return 0;
+            }
+            continue;
+        }
 
-    if (brief) {
-        ecs_strbuf_list_appendlit(reply, "\"brief\":\"");
-        ecs_strbuf_appendstrn(reply, brief, brief_len);
-        ecs_strbuf_appendch(reply, '"');
+        if (kind == EcsOpPush) {
+            kind = op->kind;
+        } else if (kind != op->kind) {
+            return 0;
+        }
+
+        packed_size += op->size * op->count;
     }
 
-    ecs_strbuf_list_pop(reply, "}");
-}
+    if (packed_size != size) {
+        /* Type has padding, or contains non-trivial members */
+        return 0;
+    }
 
-static
-void flecs_rest_counter_append(
-    ecs_strbuf_t *reply,
-    const ecs_metric_t *m,
-    const char *field,
-    int32_t field_len,
-    int32_t t,
-    const char *brief,
-    int32_t brief_len)
-{
-    flecs_rest_gauge_append(reply, m, field, field_len, t, brief, brief_len);
+    return flecs_cbor_typed_array_tag(kind);
 }
 
-#define ECS_GAUGE_APPEND_T(reply, s, field, t, brief)\
-    flecs_rest_gauge_append(reply, &(s)->field, #field, sizeof(#field) - 1, t, brief, sizeof(brief) - 1)
+int flecs_cbor_read_head(
+    const uint8_t **ptr_ref,
+    const uint8_t *end,
+    ecs_cbor_major_t *major_out,
+    uint64_t *value_out,
+    bool *indefinite_out)
+{
+    const uint8_t *ptr = *ptr_ref;
+    if (ptr >= end) {
+        return -1;
+    }
 
-#define ECS_COUNTER_APPEND_T(reply, s, field, t, brief)\
-    flecs_rest_counter_append(reply, &(s)->field, #field, sizeof(#field) - 1, t, brief, sizeof(brief) - 1)
+    uint8_t initial = *ptr ++;
+    uint8_t info = initial & 31;
+    *major_out = (ecs_cbor_major_t)(initial >> 5);
+    *indefinite_out = false;
 
-#define ECS_GAUGE_APPEND(reply, s, field, brief)\
-    ECS_GAUGE_APPEND_T(reply, s, field, (s)->t, brief)
+    int32_t count = 0;
+    if (info < FLECS_CBOR_UINT8) {
+        *value_out = info;
+    } else if (info == FLECS_CBOR_UINT8) {
+        count = 1;
+    } else if (info == FLECS_CBOR_UINT16) {
+        count = 2;
+    } else if (info == FLECS_CBOR_UINT32) {
+        count = 4;
+    } else if (info == FLECS_CBOR_UINT64) {
+        count = 8;
+    } else if (info == FLECS_CBOR_INDEFINITE) {
+        *indefinite_out = true;
+        *value_out = 0;
+    } else {
+        return -1;
+    }
 
-#define ECS_COUNTER_APPEND(reply, s, field, brief)\
-    ECS_COUNTER_APPEND_T(reply, s, field, (s)->t, brief)
+    if (count) {
+        if ((end - ptr) < count) {
+            return -1;
+        }
 
-static
-void flecs_world_stats_to_json(
-    ecs_strbuf_t *reply,
-    const EcsWorldStats *monitor_stats)
-{
-    const ecs_world_stats_t *stats = &monitor_stats->stats;
+        uint64_t value = 0;
+        int32_t i;
+        for (i = 0; i < count; i ++) {
+            value = (value << 8) | ptr[i];
+        }
+        ptr += count;
+        *value_out = value;
+    }
 
-    ecs_strbuf_list_push(reply, "{", ",");
-    ECS_GAUGE_APPEND(reply, stats, entities.count, "Alive entity ids in the world");
-    ECS_GAUGE_APPEND(reply, stats, entities.not_alive_count, "Not alive entity ids in the world");
+    *ptr_ref = ptr;
+    return 0;
+}
 
-    ECS_GAUGE_APPEND(reply, stats, performance.fps, "Frames per second");
-    ECS_COUNTER_APPEND(reply, stats, performance.frame_time, "Time spent in frame");
-    ECS_COUNTER_APPEND(reply, stats, performance.system_time, "Time spent on running systems in frame");
-    ECS_COUNTER_APPEND(reply, stats, performance.emit_time, "Time spent on notifying observers in frame");
-    ECS_COUNTER_APPEND(reply, stats, performance.merge_time, "Time spent on merging commands in frame");
-    ECS_COUNTER_APPEND(reply, stats, performance.rematch_time, "Time spent on revalidating query caches in frame");
+bool flecs_cbor_is_break(
+    const uint8_t *ptr,
+    const uint8_t *end)
+{
+    return ptr < end && ptr[0] == FLECS_CBOR_BREAK;
+}
 
-    ECS_COUNTER_APPEND(reply, stats, commands.add_count, "Add commands executed");
-    ECS_COUNTER_APPEND(reply, stats, commands.remove_count, "Remove commands executed");
-    ECS_COUNTER_APPEND(reply, stats, commands.delete_count, "Delete commands executed");
-    ECS_COUNTER_APPEND(reply, stats, commands.clear_count, "Clear commands executed");
-    ECS_COUNTER_APPEND(reply, stats, commands.set_count, "Set commands executed");
-    ECS_COUNTER_APPEND(reply, stats, commands.get_mut_count, "Get_mut commands executed");
-    ECS_COUNTER_APPEND(reply, stats, commands.modified_count, "Modified commands executed");
-    ECS_COUNTER_APPEND(reply, stats, commands.other_count, "Misc commands executed");
-    ECS_COUNTER_APPEND(reply, stats, commands.discard_count, "Commands for already deleted entities");
-    ECS_COUNTER_APPEND(reply, stats, commands.batched_entity_count, "Entities with batched commands");
-    ECS_COUNTER_APPEND(reply, stats, commands.batched_count, "Number of commands batched");
+double flecs_cbor_to_float(
+    uint8_t initial,
+    uint64_t value)
+{
+    if (initial == FLECS_CBOR_FLOAT32) {
+        uint32_t bits = (uint32_t)value;
+        float result;
+        ecs_os_memcpy(&result, &bits, 4);
+        return (double)result;
+    } else {
+        double result;
+        ecs_os_memcpy(&result, &value, 8);
+        return result;
+    }
+}
 
-    ECS_COUNTER_APPEND(reply, stats, frame.merge_count, "Number of merges (sync points)");
-    ECS_COUNTER_APPEND(reply, stats, frame.pipeline_build_count, "Pipeline rebuilds (happen when systems become active/enabled)");
-    ECS_COUNTER_APPEND(reply, stats, frame.systems_ran, "Systems ran in frame");
-    ECS_COUNTER_APPEND(reply, stats, frame.observers_ran, "Number of times an observer was invoked in frame");
-    ECS_COUNTER_APPEND(reply, stats, frame.event_emit_count, "Events emitted in frame");
-    ECS_COUNTER_APPEND(reply, stats, frame.rematch_count, "Number of query cache revalidations");
+#endif
 
-    ECS_GAUGE_APPEND(reply, stats, tables.count, "Tables in the world (including empty)");
-    ECS_GAUGE_APPEND(reply, stats, tables.empty_count, "Empty tables in the world");
-    ECS_GAUGE_APPEND(reply, stats, tables.tag_only_count, "Tables with only tags");
-    ECS_GAUGE_APPEND(reply, stats, tables.trivial_only_count, "Tables with only trivial types (no hooks)");
-    ECS_GAUGE_APPEND(reply, stats, tables.record_count, "Table records registered with search indices");
-    ECS_GAUGE_APPEND(reply, stats, tables.storage_count, "Component storages for all tables");
-    ECS_COUNTER_APPEND(reply, stats, tables.create_count, "Number of new tables created");
-    ECS_COUNTER_APPEND(reply, stats, tables.delete_count, "Number of tables deleted");
+/**
+ * @file addons/json/serialize_cbor.c
+ * @brief Serialize values, entities and iterators to CBOR.
+ *
+ * The output has the same structure as the JSON serializer. Columns of types
+ * that consist of a single primitive type without padding are written as a
+ * typed array, which lets a serializer copy the component data as is.
+ */
 
-    ECS_GAUGE_APPEND(reply, stats, ids.count, "Component, tag and pair ids in use");
-    ECS_GAUGE_APPEND(reply, stats, ids.tag_count, "Tag ids in use");
-    ECS_GAUGE_APPEND(reply, stats, ids.component_count, "Component ids in use");
-    ECS_GAUGE_APPEND(reply, stats, ids.pair_count, "Pair ids in use");
-    ECS_GAUGE_APPEND(reply, stats, ids.wildcard_count, "Wildcard ids in use");
-    ECS_GAUGE_APPEND(reply, stats, ids.type_count, "Registered component types");
-    ECS_COUNTER_APPEND(reply, stats, ids.create_count, "Number of new component, tag and pair ids created");
-    ECS_COUNTER_APPEND(reply, stats, ids.delete_count, "Number of component, pair and tag ids deleted");
 
-    ECS_GAUGE_APPEND(reply, stats, queries.query_count, "Queries in the world");
-    ECS_GAUGE_APPEND(reply, stats, queries.observer_count, "Observers in the world");
-    ECS_GAUGE_APPEND(reply, stats, queries.system_count, "Systems in the world");
+#ifdef FLECS_JSON
 
-    ECS_COUNTER_APPEND(reply, stats, memory.alloc_count, "Allocations by OS API");
-    ECS_COUNTER_APPEND(reply, stats, memory.realloc_count, "Reallocs by OS API");
-    ECS_COUNTER_APPEND(reply, stats, memory.free_count, "Frees by OS API");
-    ECS_GAUGE_APPEND(reply, stats, memory.outstanding_alloc_count, "Outstanding allocations by OS API");
-    ECS_COUNTER_APPEND(reply, stats, memory.block_alloc_count, "Blocks allocated by block allocators");
-    ECS_COUNTER_APPEND(reply, stats, memory.block_free_count, "Blocks freed by block allocators");
-    ECS_GAUGE_APPEND(reply, stats, memory.block_outstanding_alloc_count, "Outstanding block allocations");
-    ECS_COUNTER_APPEND(reply, stats, memory.stack_alloc_count, "Pages allocated by stack allocators");
-    ECS_COUNTER_APPEND(reply, stats, memory.stack_free_count, "Pages freed by stack allocators");
-    ECS_GAUGE_APPEND(reply, stats, memory.stack_outstanding_alloc_count, "Outstanding page allocations");
-    ecs_strbuf_list_pop(reply, "}");
-}
+static
+int flecs_cbor_ser_type_ops(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *ops,
+    int32_t op_count,
+    const void *base,
+    ecs_strbuf_t *buf,
+    int32_t in_array);
 
+/* Serialize enumeration */
 static
-void flecs_system_stats_to_json(
-    ecs_world_t *world,
-    ecs_strbuf_t *reply,
-    ecs_entity_t system,
-    const ecs_system_stats_t *stats)
+int flecs_cbor_ser_enum(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *op,
+    const void *base,
+    ecs_strbuf_t *buf)
 {
-    ecs_strbuf_list_push(reply, "{", ",");
-    ecs_strbuf_list_appendlit(reply, "\"name\":\"");
-    ecs_get_path_w_sep_buf(world, 0, system, ".", NULL, reply);
-    ecs_strbuf_appendch(reply, '"');
+    const EcsEnum *enum_type = ecs_get(world, op->type, EcsEnum);
+    ecs_check(enum_type != NULL, ECS_INVALID_PARAMETER, NULL);
 
-    if (!stats->task) {
-        ECS_GAUGE_APPEND(reply, &stats->query, matched_table_count, "");
-        ECS_GAUGE_APPEND(reply, &stats->query, matched_entity_count, "");
+    int32_t value = *(int32_t*)base;
+    ecs_enum_constant_t *constant = ecs_map_get(
+        enum_type->constants, ecs_enum_constant_t, value);
+    if (!constant) {
+        goto error;
     }
 
-    ECS_COUNTER_APPEND_T(reply, stats, time_spent, stats->query.t, "");
-    ecs_strbuf_list_pop(reply, "}");
+    flecs_cbor_string(buf, ecs_get_name(world, constant->constant));
+    return 0;
+error:
+    return -1;
 }
 
+/* Serialize bitmask */
 static
-void flecs_pipeline_stats_to_json(
-    ecs_world_t *world,
-    ecs_strbuf_t *reply,
-    const EcsPipelineStats *stats)
+int flecs_cbor_ser_bitmask(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *op,
+    const void *ptr,
+    ecs_strbuf_t *buf)
 {
-    ecs_strbuf_list_push(reply, "[", ",");
-
-    int32_t i, count = ecs_vector_count(stats->stats.systems);
-    ecs_entity_t *ids = ecs_vector_first(stats->stats.systems, ecs_entity_t);
-    for (i = 0; i < count; i ++) {
-        ecs_entity_t id = ids[i];
-        
-        ecs_strbuf_list_next(reply);
+    const EcsBitmask *bitmask_type = ecs_get(world, op->type, EcsBitmask);
+    ecs_check(bitmask_type != NULL, ECS_INVALID_PARAMETER, NULL);
 
-        if (id) {
-            ecs_system_stats_t *sys_stats = ecs_map_get(
-                    &stats->stats.system_stats, ecs_system_stats_t, id);
-            flecs_system_stats_to_json(world, reply, id, sys_stats);
-        } else {
-            /* Sync point */
-            ecs_strbuf_list_push(reply, "{", ",");
-            ecs_strbuf_list_pop(reply, "}");
-        }
+    uint32_t value = *(uint32_t*)ptr;
+    if (!value) {
+        flecs_cbor_uint(buf, 0);
+        return 0;
     }
 
-    ecs_strbuf_list_pop(reply, "]");
-}
+    ecs_strbuf_t str = ECS_STRBUF_INIT;
+    ecs_map_key_t key;
+    ecs_bitmask_constant_t *constant;
+    ecs_map_iter_t it = ecs_map_iter(bitmask_type->constants);
+    while ((constant = ecs_map_next(&it, ecs_bitmask_constant_t, &key))) {
+        if ((value & key) == key) {
+            if (ecs_strbuf_written(&str)) {
+                ecs_strbuf_appendch(&str, '|');
+            }
+            ecs_strbuf_appendstr(&str, ecs_get_name(world, constant->constant));
+            value -= (uint32_t)key;
+        }
+    }
+
+    if (value != 0) {
+        /* All bits must have been matched by a constant */
+        ecs_strbuf_reset(&str);
+        goto error;
+    }
+
+    flecs_cbor_strbuf(buf, &str);
+    return 0;
+error:
+    return -1;
+}
+
+/* Serialize elements of a contiguous array */
+static
+int flecs_cbor_ser_elements(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *ops,
+    int32_t op_count,
+    const void *base,
+    int32_t elem_count,
+    int32_t elem_size,
+    ecs_strbuf_t *buf)
+{
+    flecs_cbor_array(buf, elem_count);
+
+    const void *ptr = base;
+
+    int i;
+    for (i = 0; i < elem_count; i ++) {
+        if (flecs_cbor_ser_type_ops(world, ops, op_count, ptr, buf, 1)) {
+            return -1;
+        }
+        ptr = ECS_OFFSET(ptr, elem_size);
+    }
+
+    return 0;
+}
+
+static
+int flecs_cbor_ser_type_elements(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const void *base,
+    int32_t elem_count,
+    ecs_strbuf_t *buf)
+{
+    const EcsMetaTypeSerialized *ser = ecs_get(
+        world, type, EcsMetaTypeSerialized);
+    ecs_assert(ser != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    const EcsComponent *comp = ecs_get(world, type, EcsComponent);
+    ecs_assert(comp != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_meta_type_op_t *ops = ecs_vector_first(ser->ops, ecs_meta_type_op_t);
+    int32_t op_count = ecs_vector_count(ser->ops);
+
+    return flecs_cbor_ser_elements(
+        world, ops, op_count, base, elem_count, comp->size, buf);
+}
+
+/* Serialize array */
+static
+int flecs_cbor_ser_array(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *op,
+    const void *ptr,
+    ecs_strbuf_t *buf)
+{
+    const EcsArray *a = ecs_get(world, op->type, EcsArray);
+    ecs_assert(a != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    return flecs_cbor_ser_type_elements(
+        world, a->type, ptr, a->count, buf);
+}
+
+/* Serialize vector */
+static
+int flecs_cbor_ser_vector(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *op,
+    const void *base,
+    ecs_strbuf_t *buf)
+{
+    ecs_vector_t *value = *(ecs_vector_t**)base;
+    if (!value) {
+        flecs_cbor_null(buf);
+        return 0;
+    }
+
+    const EcsVector *v = ecs_get(world, op->type, EcsVector);
+    ecs_assert(v != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    const EcsComponent *comp = ecs_get(world, v->type, EcsComponent);
+    ecs_assert(comp != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t count = ecs_vector_count(value);
+    void *array = ecs_vector_first_t(value, comp->size, comp->alignment);
+
+    /* Serialize contiguous buffer of vector */
+    return flecs_cbor_ser_type_elements(world, v->type, array, count, buf);
+}
+
+/* Forward serialization to the different type kinds */
+static
+int flecs_cbor_ser_type_op(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *op,
+    const void *base,
+    ecs_strbuf_t *buf)
+{
+    const void *ptr = ECS_OFFSET(base, op->offset);
+
+    switch(op->kind) {
+    case EcsOpPush:
+    case EcsOpPop:
+        /* Should not be parsed as single op */
+        ecs_throw(ECS_INVALID_PARAMETER, NULL);
+        break;
+    case EcsOpEnum:
+        return flecs_cbor_ser_enum(world, op, ptr, buf);
+    case EcsOpBitmask:
+        return flecs_cbor_ser_bitmask(world, op, ptr, buf);
+    case EcsOpArray:
+        return flecs_cbor_ser_array(world, op, ptr, buf);
+    case EcsOpVector:
+        return flecs_cbor_ser_vector(world, op, ptr, buf);
+    case EcsOpBool:
+        flecs_cbor_bool(buf, *(const ecs_bool_t*)ptr);
+        break;
+    case EcsOpChar:
+        flecs_cbor_int(buf, *(const ecs_char_t*)ptr);
+        break;
+    case EcsOpByte:
+        flecs_cbor_uint(buf, *(const ecs_byte_t*)ptr);
+        break;
+    case EcsOpU8:
+        flecs_cbor_uint(buf, *(const ecs_u8_t*)ptr);
+        break;
+    case EcsOpU16:
+        flecs_cbor_uint(buf, *(const ecs_u16_t*)ptr);
+        break;
+    case EcsOpU32:
+        flecs_cbor_uint(buf, *(const ecs_u32_t*)ptr);
+        break;
+    case EcsOpU64:
+        flecs_cbor_uint(buf, *(const ecs_u64_t*)ptr);
+        break;
+    case EcsOpUPtr:
+        flecs_cbor_uint(buf, *(const ecs_uptr_t*)ptr);
+        break;
+    case EcsOpI8:
+        flecs_cbor_int(buf, *(const ecs_i8_t*)ptr);
+        break;
+    case EcsOpI16:
+        flecs_cbor_int(buf, *(const ecs_i16_t*)ptr);
+        break;
+    case EcsOpI32:
+        flecs_cbor_int(buf, *(const ecs_i32_t*)ptr);
+        break;
+    case EcsOpI64:
+        flecs_cbor_int(buf, *(const ecs_i64_t*)ptr);
+        break;
+    case EcsOpIPtr:
+        flecs_cbor_int(buf, *(const ecs_iptr_t*)ptr);
+        break;
+    case EcsOpF32:
+        flecs_cbor_float32(buf, *(const ecs_f32_t*)ptr);
+        break;
+    case EcsOpF64:
+        flecs_cbor_float64(buf, *(const ecs_f64_t*)ptr);
+        break;
+    case EcsOpString:
+        flecs_cbor_string(buf, *(const char**)ptr);
+        break;
+    case EcsOpEntity: {
+        ecs_entity_t e = *(const ecs_entity_t*)ptr;
+        if (!e) {
+            flecs_cbor_uint(buf, 0);
+        } else {
+            flecs_cbor_path(buf, world, e);
+        }
+        break;
+    }
+    default:
+        ecs_throw(ECS_INTERNAL_ERROR, NULL);
+        break;
+    }
+
+    return 0;
+error:
+    return -1;
+}
+
+/* Iterate over a slice of the type ops array */
+static
+int flecs_cbor_ser_type_ops(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *ops,
+    int32_t op_count,
+    const void *base,
+    ecs_strbuf_t *buf,
+    int32_t in_array)
+{
+    for (int i = 0; i < op_count; i ++) {
+        ecs_meta_type_op_t *op = &ops[i];
+
+        if (in_array <= 0) {
+            if (op->name) {
+                flecs_cbor_string(buf, op->name);
+            }
+
+            int32_t elem_count = op->count;
+            if (elem_count > 1) {
+                /* Serialize inline array */
+                if (flecs_cbor_ser_elements(world, op, op->op_count, base,
+                    elem_count, op->size, buf))
+                {
+                    return -1;
+                }
+
+                i += op->op_count - 1;
+                continue;
+            }
+        }
+
+        switch(op->kind) {
+        case EcsOpPush:
+            flecs_cbor_object_push(buf);
+            in_array --;
+            break;
+        case EcsOpPop:
+            flecs_cbor_object_pop(buf);
+            in_array ++;
+            break;
+        default:
+            if (flecs_cbor_ser_type_op(world, op, base, buf)) {
+                goto error;
+            }
+            break;
+        }
+    }
+
+    return 0;
+error:
+    return -1;
+}
+
+/* Serialize value, or column of values. Columns are written as a typed array
+ * if the layout of the type allows for it. */
+static
+int flecs_cbor_ser_values(
+    const ecs_world_t *world,
+    const void *ptr,
+    int32_t count,
+    ecs_strbuf_t *buf,
+    const EcsComponent *comp,
+    const EcsMetaTypeSerialized *ser)
+{
+    ecs_meta_type_op_t *ops = ecs_vector_first(ser->ops, ecs_meta_type_op_t);
+    int32_t op_count = ecs_vector_count(ser->ops);
+
+    if (!count) {
+        return flecs_cbor_ser_type_ops(world, ops, op_count, ptr, buf, 0);
+    }
+
+    ecs_size_t size = comp->size;
+    uint64_t tag = flecs_cbor_packed_tag(ops, op_count, size);
+    if (tag) {
+        flecs_cbor_typed_array(buf, tag, ptr, size * count);
+        return 0;
+    }
+
+    flecs_cbor_array(buf, count);
+    do {
+        if (flecs_cbor_ser_type_ops(world, ops, op_count, ptr, buf, 0)) {
+            return -1;
+        }
+
+        ptr = ECS_OFFSET(ptr, size);
+    } while (-- count);
+
+    return 0;
+}
+
+int ecs_array_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const void *ptr,
+    int32_t count,
+    ecs_strbuf_t *buf)
+{
+    const EcsComponent *comp = ecs_get(world, type, EcsComponent);
+    if (!comp) {
+        char *path = ecs_get_fullpath(world, type);
+        ecs_err("cannot serialize to CBOR, '%s' is not a component", path);
+        ecs_os_free(path);
+        return -1;
+    }
+
+    const EcsMetaTypeSerialized *ser = ecs_get(
+        world, type, EcsMetaTypeSerialized);
+    if (!ser) {
+        char *path = ecs_get_fullpath(world, type);
+        ecs_err("cannot serialize to CBOR, '%s' has no reflection data", path);
+        ecs_os_free(path);
+        return -1;
+    }
+
+    return flecs_cbor_ser_values(world, ptr, count, buf, comp, ser);
+}
+
+int ecs_ptr_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const void *ptr,
+    ecs_strbuf_t *buf)
+{
+    return ecs_array_to_cbor_buf(world, type, ptr, 0, buf);
+}
+
+static
+bool flecs_cbor_union_target(
+    const ecs_world_t *world,
+    ecs_entity_t ent,
+    ecs_entity_t *pred,
+    ecs_entity_t *obj)
+{
+    if (*obj && (*pred == EcsUnion)) {
+        *pred = *obj;
+        *obj = ecs_get_target(world, ent, *pred, 0);
+        if (!ecs_is_alive(world, *obj)) {
+            /* Union relationships aren't automatically cleaned up, so they
+             * can contain invalid entity ids. */
+            return false;
+        }
+    }
+    return true;
+}
+
+static
+void flecs_cbor_append_type_labels(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    const ecs_id_t *ids,
+    int32_t count,
+    ecs_entity_t ent,
+    ecs_entity_t inst,
+    const ecs_entity_to_json_desc_t *desc)
+{
+    flecs_cbor_stringl(buf, "id_labels");
+    flecs_cbor_array_push(buf);
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t pred = 0, obj = 0, role = 0;
+        if (flecs_json_skip_id(world, ids[i], desc, ent, inst, &pred, &obj,
+            &role, 0))
+        {
+            continue;
+        }
+
+        if (!flecs_cbor_union_target(world, ent, &pred, &obj)) {
+            continue;
+        }
+
+        flecs_cbor_array(buf, 1 + (obj != 0));
+        flecs_cbor_label(buf, world, pred);
+        if (obj) {
+            flecs_cbor_label(buf, world, obj);
+        }
+    }
+
+    flecs_cbor_array_pop(buf);
+}
+
+static
+int flecs_cbor_append_type_values(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    const ecs_id_t *ids,
+    int32_t count,
+    ecs_entity_t ent,
+    ecs_entity_t inst,
+    const ecs_entity_to_json_desc_t *desc)
+{
+    flecs_cbor_stringl(buf, "values");
+    flecs_cbor_array_push(buf);
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        bool hidden;
+        ecs_entity_t pred = 0, obj = 0, role = 0;
+        ecs_id_t id = ids[i];
+        if (flecs_json_skip_id(world, id, desc, ent, inst, &pred, &obj, &role,
+            &hidden))
+        {
+            continue;
+        }
+
+        if (hidden) {
+            if (desc->serialize_hidden) {
+                flecs_cbor_uint(buf, 0);
+            }
+            continue;
+        }
+
+        const EcsComponent *comp = NULL;
+        const EcsMetaTypeSerialized *ser = NULL;
+        ecs_entity_t typeid = ecs_get_typeid(world, id);
+        if (typeid) {
+            comp = ecs_get(world, typeid, EcsComponent);
+            ser = ecs_get(world, typeid, EcsMetaTypeSerialized);
+        }
+
+        if (comp && ser) {
+            const void *ptr = ecs_get_id(world, ent, id);
+            ecs_assert(ptr != NULL, ECS_INTERNAL_ERROR, NULL);
+            if (flecs_cbor_ser_values(world, ptr, 0, buf, comp, ser)) {
+                /* Entity contains invalid value */
+                return -1;
+            }
+        } else {
+            flecs_cbor_uint(buf, 0);
+        }
+    }
+
+    flecs_cbor_array_pop(buf);
+    return 0;
+}
+
+static
+void flecs_cbor_append_type_hidden(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    const ecs_id_t *ids,
+    int32_t count,
+    ecs_entity_t ent,
+    ecs_entity_t inst,
+    const ecs_entity_to_json_desc_t *desc)
+{
+    flecs_cbor_stringl(buf, "hidden");
+    flecs_cbor_array_push(buf);
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        bool hidden;
+        ecs_entity_t pred = 0, obj = 0, role = 0;
+        if (flecs_json_skip_id(world, ids[i], desc, ent, inst, &pred, &obj,
+            &role, &hidden))
+        {
+            continue;
+        }
+
+        flecs_cbor_bool(buf, hidden);
+    }
+
+    flecs_cbor_array_pop(buf);
+}
+
+static
+int flecs_cbor_append_type(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    ecs_entity_t ent,
+    ecs_entity_t inst,
+    const ecs_entity_to_json_desc_t *desc)
+{
+    const ecs_id_t *ids = NULL;
+    int32_t i, count = 0;
+
+    const ecs_type_t *type = ecs_get_type(world, ent);
+    if (type) {
+        ids = type->array;
+        count = type->count;
+    }
+
+    flecs_cbor_stringl(buf, "ids");
+    flecs_cbor_array_push(buf);
+
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t pred = 0, obj = 0, role = 0;
+        if (flecs_json_skip_id(world, ids[i], desc, ent, inst, &pred, &obj,
+            &role, 0))
+        {
+            continue;
+        }
+
+        if (!flecs_cbor_union_target(world, ent, &pred, &obj)) {
+            continue;
+        }
+
+        flecs_cbor_array(buf, 1 + ((obj || role) != 0) + (role != 0));
+        flecs_cbor_path(buf, world, pred);
+        if (obj || role) {
+            if (obj) {
+                flecs_cbor_path(buf, world, obj);
+            } else {
+                flecs_cbor_uint(buf, 0);
+            }
+            if (role) {
+                flecs_cbor_string(buf, ecs_id_flag_str(role));
+            }
+        }
+    }
+
+    flecs_cbor_array_pop(buf);
+
+#ifdef FLECS_DOC
+    if (desc->serialize_id_labels) {
+        flecs_cbor_append_type_labels(world, buf, ids, count, ent, inst, desc);
+    }
+#endif
+
+    if (desc->serialize_values) {
+        if (flecs_cbor_append_type_values(
+            world, buf, ids, count, ent, inst, desc))
+        {
+            return -1;
+        }
+    }
+
+    if (desc->serialize_hidden && ent != inst) {
+        flecs_cbor_append_type_hidden(world, buf, ids, count, ent, inst, desc);
+    }
+
+    return 0;
+}
+
+static
+int flecs_cbor_append_base(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    ecs_entity_t ent,
+    ecs_entity_t inst,
+    const ecs_entity_to_json_desc_t *desc)
+{
+    const ecs_type_t *type = ecs_get_type(world, ent);
+    ecs_id_t *ids = NULL;
+    int32_t i, count = 0;
+    if (type) {
+        ids = type->array;
+        count = type->count;
+    }
+
+    for (i = 0; i < count; i ++) {
+        ecs_id_t id = ids[i];
+        if (ECS_HAS_RELATION(id, EcsIsA)) {
+            if (flecs_cbor_append_base(
+                world, buf, ecs_pair_second(world, id), inst, desc))
+            {
+                return -1;
+            }
+        }
+    }
+
+    flecs_cbor_object_push(buf);
+    flecs_cbor_stringl(buf, "path");
+    flecs_cbor_path(buf, world, ent);
+
+    if (flecs_cbor_append_type(world, buf, ent, inst, desc)) {
+        return -1;
+    }
+
+    flecs_cbor_object_pop(buf);
+
+    return 0;
+}
+
+int ecs_entity_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_strbuf_t *buf,
+    const ecs_entity_to_json_desc_t *desc)
+{
+    if (!entity || !ecs_is_valid(world, entity)) {
+        return -1;
+    }
+
+    ecs_entity_to_json_desc_t default_desc = ECS_ENTITY_TO_JSON_INIT;
+    if (!desc) {
+        desc = &default_desc;
+    }
+
+    flecs_cbor_object_push(buf);
+
+    if (desc->serialize_path) {
+        flecs_cbor_stringl(buf, "path");
+        ecs_strbuf_t path = ECS_STRBUF_INIT;
+        ecs_get_path_w_sep_buf(world, 0, entity, ".", NULL, &path);
+        flecs_cbor_strbuf(buf, &path);
+    }
+
+#ifdef FLECS_DOC
+    if (desc->serialize_label) {
+        flecs_cbor_stringl(buf, "label");
+        const char *doc_name = ecs_doc_get_name(world, entity);
+        if (doc_name) {
+            flecs_cbor_string(buf, doc_name);
+        } else {
+            char num_buf[20];
+            ecs_os_sprintf(num_buf, "%u", (uint32_t)entity);
+            flecs_cbor_string(buf, num_buf);
+        }
+    }
+
+    if (desc->serialize_brief) {
+        const char *doc_brief = ecs_doc_get_brief(world, entity);
+        if (doc_brief) {
+            flecs_cbor_stringl(buf, "brief");
+            flecs_cbor_string(buf, doc_brief);
+        }
+    }
+
+    if (desc->serialize_link) {
+        const char *doc_link = ecs_doc_get_link(world, entity);
+        if (doc_link) {
+            flecs_cbor_stringl(buf, "link");
+            flecs_cbor_string(buf, doc_link);
+        }
+    }
+
+    if (desc->serialize_color) {
+        const char *doc_color = ecs_doc_get_color(world, entity);
+        if (doc_color) {
+            flecs_cbor_stringl(buf, "color");
+            flecs_cbor_string(buf, doc_color);
+        }
+    }
+#endif
+
+    const ecs_type_t *type = ecs_get_type(world, entity);
+    ecs_id_t *ids = NULL;
+    int32_t i, count = 0;
+    if (type) {
+        ids = type->array;
+        count = type->count;
+    }
+
+    if (desc->serialize_base) {
+        if (ecs_has_pair(world, entity, EcsIsA, EcsWildcard)) {
+            flecs_cbor_stringl(buf, "is_a");
+            flecs_cbor_array_push(buf);
+
+            for (i = 0; i < count; i ++) {
+                ecs_id_t id = ids[i];
+                if (ECS_HAS_RELATION(id, EcsIsA)) {
+                    if (flecs_cbor_append_base(
+                        world, buf, ecs_pair_second(world, id), entity, desc))
+                    {
+                        return -1;
+                    }
+                }
+            }
+
+            flecs_cbor_array_pop(buf);
+        }
+    }
+
+    if (flecs_cbor_append_type(world, buf, entity, entity, desc)) {
+        return -1;
+    }
+
+    flecs_cbor_object_pop(buf);
+
+    return 0;
+}
+
+static
+void flecs_cbor_serialize_iter_variables(
+    ecs_iter_t *it,
+    ecs_strbuf_t *buf)
+{
+    char **variable_names = it->variable_names;
+    int32_t var_count = it->variable_count;
+    int32_t actual_count = 0;
+
+    for (int i = 0; i < var_count; i ++) {
+        const char *var_name = variable_names[i];
+        if (flecs_json_skip_variable(var_name)) continue;
+
+        if (!actual_count) {
+            flecs_cbor_stringl(buf, "vars");
+            flecs_cbor_array_push(buf);
+            actual_count ++;
+        }
+
+        flecs_cbor_string(buf, var_name);
+    }
+
+    if (actual_count) {
+        flecs_cbor_array_pop(buf);
+    }
+}
+
+static
+void flecs_cbor_serialize_iter_result_variables(
+    const ecs_world_t *world,
+    const ecs_iter_t *it,
+    ecs_strbuf_t *buf,
+    const char *member,
+    int32_t member_len,
+    char kind)
+{
+    char **variable_names = it->variable_names;
+    ecs_var_t *variables = it->variables;
+    int32_t var_count = it->variable_count;
+    int32_t actual_count = 0;
+
+    for (int i = 0; i < var_count; i ++) {
+        const char *var_name = variable_names[i];
+        if (flecs_json_skip_variable(var_name)) continue;
+
+        if (!actual_count) {
+            flecs_cbor_stringn(buf, member, member_len);
+            flecs_cbor_array_push(buf);
+            actual_count ++;
+        }
+
+        ecs_entity_t e = variables[i].entity;
+        if (kind == 'p') {
+            flecs_cbor_path(buf, world, e);
+        } else if (kind == 'l') {
+            flecs_cbor_label(buf, world, e);
+        } else {
+            flecs_cbor_uint(buf, e);
+        }
+    }
+
+    if (actual_count) {
+        flecs_cbor_array_pop(buf);
+    }
+}
+
+static
+void flecs_cbor_serialize_iter_result_entities(
+    const ecs_world_t *world,
+    const ecs_iter_t *it,
+    ecs_strbuf_t *buf,
+    const char *member,
+    int32_t member_len,
+    char kind)
+{
+    int32_t i, count = it->count;
+    if (!count) {
+        return;
+    }
+
+    flecs_cbor_stringn(buf, member, member_len);
+
+    ecs_entity_t *entities = it->entities;
+    if (kind == 'i') {
+        /* Entity ids have the same layout as an array of uint64 */
+        flecs_cbor_typed_array(buf, flecs_cbor_typed_array_tag(EcsOpU64),
+            entities, ECS_SIZEOF(ecs_entity_t) * count);
+        return;
+    }
+
+    flecs_cbor_array(buf, count);
+    for (i = 0; i < count; i ++) {
+        if (kind == 'p') {
+            flecs_cbor_path(buf, world, entities[i]);
+        } else if (kind == 'l') {
+            flecs_cbor_label(buf, world, entities[i]);
+        } else {
+            flecs_cbor_color(buf, world, entities[i]);
+        }
+    }
+}
+
+static
+void flecs_cbor_serialize_iter_result_values(
+    const ecs_world_t *world,
+    const ecs_iter_t *it,
+    ecs_strbuf_t *buf)
+{
+    flecs_cbor_stringl(buf, "values");
+
+    int32_t i, field_count = it->field_count;
+    flecs_cbor_array(buf, field_count);
+
+    for (i = 0; i < field_count; i ++) {
+        const void *ptr = NULL;
+        if (it->ptrs) {
+            ptr = it->ptrs[i];
+        }
+
+        bool is_set = ecs_field_is_set(it, i + 1);
+        if (!ptr && is_set) {
+            /* No data in column */
+            flecs_cbor_uint(buf, 0);
+            continue;
+        }
+
+        if (ecs_field_is_writeonly(it, i + 1)) {
+            flecs_cbor_uint(buf, 0);
+            continue;
+        }
+
+        const EcsComponent *comp = NULL;
+        const EcsMetaTypeSerialized *ser = NULL;
+        ecs_entity_t type = ecs_get_typeid(world, it->ids[i]);
+        if (type) {
+            comp = ecs_get(world, type, EcsComponent);
+            ser = ecs_get(world, type, EcsMetaTypeSerialized);
+        }
+
+        if (!comp || !ser) {
+            flecs_cbor_uint(buf, 0);
+            continue;
+        }
+
+        /* If term is not set, append empty array. This indicates that the term
+         * could have had data but doesn't */
+        if (!is_set) {
+            ecs_assert(ptr == NULL, ECS_INTERNAL_ERROR, NULL);
+            flecs_cbor_array(buf, 0);
+            continue;
+        }
+
+        if (ecs_field_is_self(it, i + 1)) {
+            flecs_cbor_ser_values(world, ptr, it->count, buf, comp, ser);
+        } else {
+            flecs_cbor_ser_values(world, ptr, 0, buf, comp, ser);
+        }
+    }
+}
+
+static
+void flecs_cbor_serialize_iter_result(
+    const ecs_world_t *world,
+    const ecs_iter_t *it,
+    ecs_strbuf_t *buf,
+    const ecs_iter_to_json_desc_t *desc)
+{
+    int32_t i, field_count = it->field_count;
+
+    flecs_cbor_object_push(buf);
+
+    if (desc->serialize_ids) {
+        flecs_cbor_stringl(buf, "ids");
+        flecs_cbor_array(buf, field_count);
+        for (i = 0; i < field_count; i ++) {
+            flecs_cbor_id(buf, world, ecs_field_id(it, i + 1));
+        }
+
+        flecs_cbor_stringl(buf, "sources");
+        flecs_cbor_array(buf, field_count);
+        for (i = 0; i < field_count; i ++) {
+            ecs_entity_t subj = it->sources[i];
+            if (subj) {
+                flecs_cbor_path(buf, world, subj);
+            } else {
+                flecs_cbor_uint(buf, 0);
+            }
+        }
+    }
+
+    if (desc->serialize_variables) {
+        flecs_cbor_serialize_iter_result_variables(
+            world, it, buf, "vars", 4, 'p');
+    }
+
+    if (desc->serialize_variable_labels) {
+        flecs_cbor_serialize_iter_result_variables(
+            world, it, buf, "var_labels", 10, 'l');
+    }
+
+    if (desc->serialize_variable_ids) {
+        flecs_cbor_serialize_iter_result_variables(
+            world, it, buf, "var_ids", 7, 'i');
+    }
+
+    if (desc->serialize_is_set) {
+        flecs_cbor_stringl(buf, "is_set");
+        flecs_cbor_array(buf, field_count);
+        for (i = 0; i < field_count; i ++) {
+            flecs_cbor_bool(buf, ecs_field_is_set(it, i + 1));
+        }
+    }
+
+    if (desc->serialize_entities) {
+        flecs_cbor_serialize_iter_result_entities(
+            world, it, buf, "entities", 8, 'p');
+    }
+
+    if (desc->serialize_entity_labels) {
+        flecs_cbor_serialize_iter_result_entities(
+            world, it, buf, "entity_labels", 13, 'l');
+    }
+
+    if (desc->serialize_entity_ids) {
+        flecs_cbor_serialize_iter_result_entities(
+            world, it, buf, "entity_ids", 10, 'i');
+    }
+
+    if (desc->serialize_colors) {
+        flecs_cbor_serialize_iter_result_entities(
+            world, it, buf, "colors", 6, 'c');
+    }
+
+    if (desc->serialize_values) {
+        flecs_cbor_serialize_iter_result_values(world, it, buf);
+    }
+
+    flecs_cbor_object_pop(buf);
+}
+
+int ecs_iter_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_iter_t *it,
+    ecs_strbuf_t *buf,
+    const ecs_iter_to_json_desc_t *desc)
+{
+    ecs_iter_to_json_desc_t default_desc = ECS_ITER_TO_JSON_INIT;
+    if (!desc) {
+        desc = &default_desc;
+    }
+
+    ecs_time_t duration = {0};
+    if (desc->measure_eval_duration) {
+        ecs_time_measure(&duration);
+    }
+
+    flecs_cbor_object_push(buf);
+
+    /* Serialize component ids of the terms (usually provided by query) */
+    int32_t i, field_count = it->field_count;
+    if (desc->serialize_term_ids && field_count) {
+        flecs_cbor_stringl(buf, "ids");
+        flecs_cbor_array(buf, field_count);
+        for (i = 0; i < field_count; i ++) {
+            flecs_cbor_id(buf, world, it->terms[i].id);
+        }
+    }
+
+    /* Serialize variable names, if iterator has any */
+    flecs_cbor_serialize_iter_variables(it, buf);
+
+    /* Serialize results */
+    flecs_cbor_stringl(buf, "results");
+    flecs_cbor_array_push(buf);
+
+    /* Use instancing for improved performance */
+    ECS_BIT_SET(it->flags, EcsIterIsInstanced);
+
+    ecs_iter_next_action_t next = it->next;
+    while (next(it)) {
+        flecs_cbor_serialize_iter_result(world, it, buf, desc);
+    }
+
+    flecs_cbor_array_pop(buf);
+
+    if (desc->measure_eval_duration) {
+        double dt = ecs_time_measure(&duration);
+        flecs_cbor_stringl(buf, "eval_duration");
+        flecs_cbor_float64(buf, dt);
+    }
+
+    flecs_cbor_object_pop(buf);
+
+    return 0;
+}
+
+#endif
+
+/**
+ * @file addons/json/deserialize_cbor.c
+ * @brief Deserialize CBOR into values.
+ */
+
+
+#ifdef FLECS_JSON
+
+static
+const uint8_t* flecs_cbor_parse_value(
+    ecs_meta_cursor_t *cur,
+    const uint8_t *ptr,
+    const uint8_t *end);
+
+/* Text strings aren't terminated, copy to buffer before passing to cursor */
+static
+const uint8_t* flecs_cbor_parse_text(
+    const uint8_t *ptr,
+    const uint8_t *end,
+    uint64_t len,
+    char *token,
+    char **str_out)
+{
+    if ((uint64_t)(end - ptr) < len) {
+        return NULL;
+    }
+
+    char *str = token;
+    if (len >= ECS_MAX_TOKEN_SIZE) {
+        str = ecs_os_malloc(flecs_uto(ecs_size_t, len + 1));
+    }
+
+    ecs_os_memcpy(str, ptr, flecs_uto(ecs_size_t, len));
+    str[len] = '\0';
+    *str_out = str;
+
+    return ptr + len;
+}
+
+static
+const uint8_t* flecs_cbor_parse_elements(
+    ecs_meta_cursor_t *cur,
+    const uint8_t *ptr,
+    const uint8_t *end,
+    uint64_t count,
+    bool indefinite)
+{
+    if (ecs_meta_push(cur) != 0) {
+        return NULL;
+    }
+
+    if (!ecs_meta_is_collection(cur)) {
+        ecs_err("cbor: unexpected array for non-collection type");
+        return NULL;
+    }
+
+    uint64_t i;
+    for (i = 0; indefinite || i < count; i ++) {
+        if (indefinite && flecs_cbor_is_break(ptr, end)) {
+            ptr ++;
+            break;
+        }
+
+        if (i && ecs_meta_next(cur) != 0) {
+            return NULL;
+        }
+
+        if (!(ptr = flecs_cbor_parse_value(cur, ptr, end))) {
+            return NULL;
+        }
+    }
+
+    if (ecs_meta_pop(cur) != 0) {
+        return NULL;
+    }
+
+    return ptr;
+}
+
+static
+const uint8_t* flecs_cbor_parse_members(
+    ecs_meta_cursor_t *cur,
+    const uint8_t *ptr,
+    const uint8_t *end,
+    uint64_t count,
+    bool indefinite)
+{
+    if (ecs_meta_push(cur) != 0) {
+        return NULL;
+    }
+
+    if (ecs_meta_is_collection(cur)) {
+        ecs_err("cbor: unexpected map for collection type");
+        return NULL;
+    }
+
+    uint64_t i;
+    for (i = 0; indefinite || i < count; i ++) {
+        if (indefinite && flecs_cbor_is_break(ptr, end)) {
+            ptr ++;
+            break;
+        }
+
+        ecs_cbor_major_t major;
+        uint64_t len;
+        bool key_indefinite;
+        if (flecs_cbor_read_head(&ptr, end, &major, &len, &key_indefinite)) {
+            return NULL;
+        }
+
+        if (major != EcsCborText || key_indefinite) {
+            ecs_err("cbor: expected text string for member name");
+            return NULL;
+        }
+
+        char token[ECS_MAX_TOKEN_SIZE], *name;
+        if (!(ptr = flecs_cbor_parse_text(ptr, end, len, token, &name))) {
+            return NULL;
+        }
+
+        int result = ecs_meta_member(cur, name);
+        if (name != token) {
+            ecs_os_free(name);
+        }
+
+        if (result != 0) {
+            return NULL;
+        }
+
+        if (!(ptr = flecs_cbor_parse_value(cur, ptr, end))) {
+            return NULL;
+        }
+    }
+
+    if (ecs_meta_pop(cur) != 0) {
+        return NULL;
+    }
+
+    return ptr;
+}
+
+static
+const uint8_t* flecs_cbor_parse_value(
+    ecs_meta_cursor_t *cur,
+    const uint8_t *ptr,
+    const uint8_t *end)
+{
+    ecs_cbor_major_t major;
+    uint64_t value;
+    bool indefinite;
+
+    if (ptr >= end) {
+        ecs_err("cbor: unexpected end of data");
+        return NULL;
+    }
+
+    uint8_t initial = ptr[0];
+    if (flecs_cbor_read_head(&ptr, end, &major, &value, &indefinite)) {
+        ecs_err("cbor: invalid item header");
+        return NULL;
+    }
+
+    int result = 0;
+    switch(major) {
+    case EcsCborUint:
+        result = ecs_meta_set_uint(cur, value);
+        break;
+    case EcsCborNegInt:
+        result = ecs_meta_set_int(cur, -1 - (int64_t)value);
+        break;
+    case EcsCborText: {
+        if (indefinite) {
+            ecs_err("cbor: indefinite length strings are not supported");
+            return NULL;
+        }
+
+        char token[ECS_MAX_TOKEN_SIZE], *str;
+        if (!(ptr = flecs_cbor_parse_text(ptr, end, value, token, &str))) {
+            return NULL;
+        }
+
+        result = ecs_meta_set_string(cur, str);
+        if (str != token) {
+            ecs_os_free(str);
+        }
+        break;
+    }
+    case EcsCborArray:
+        return flecs_cbor_parse_elements(cur, ptr, end, value, indefinite);
+    case EcsCborMap:
+        return flecs_cbor_parse_members(cur, ptr, end, value, indefinite);
+    case EcsCborSimple:
+        if (initial == FLECS_CBOR_FALSE) {
+            result = ecs_meta_set_bool(cur, false);
+        } else if (initial == FLECS_CBOR_TRUE) {
+            result = ecs_meta_set_bool(cur, true);
+        } else if (initial == FLECS_CBOR_NULL) {
+            result = ecs_meta_set_null(cur);
+        } else if (initial == FLECS_CBOR_FLOAT32 ||
+            initial == FLECS_CBOR_FLOAT64)
+        {
+            result = ecs_meta_set_float(cur,
+                flecs_cbor_to_float(initial, value));
+        } else {
+            ecs_err("cbor: unsupported simple value %u", initial);
+            return NULL;
+        }
+        break;
+    case EcsCborBytes:
+    case EcsCborTag:
+    default:
+        ecs_err("cbor: unexpected item of major type %d", major);
+        return NULL;
+    }
+
+    if (result != 0) {
+        return NULL;
+    }
+
+    return ptr;
+}
+
+/* Copy typed array into values, swap bytes if data has different endianness */
+static
+const uint8_t* flecs_cbor_parse_typed_array(
+    const ecs_world_t *world,
+    const uint8_t *ptr,
+    const uint8_t *end,
+    ecs_entity_t type,
+    uint64_t tag,
+    void *data_out,
+    int32_t count)
+{
+    const EcsComponent *comp = ecs_get(world, type, EcsComponent);
+    const EcsMetaTypeSerialized *ser = ecs_get(
+        world, type, EcsMetaTypeSerialized);
+    ecs_assert(comp != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(ser != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    uint64_t type_tag = flecs_cbor_packed_tag(
+        ecs_vector_first(ser->ops, ecs_meta_type_op_t),
+        ecs_vector_count(ser->ops), comp->size);
+
+    /* Endianness bit is the only one that's allowed to differ */
+    if (!type_tag || (type_tag | 4) != (tag | 4)) {
+        char *path = ecs_get_fullpath(world, type);
+        ecs_err("cbor: typed array %u does not match type '%s'",
+            (uint32_t)tag, path);
+        ecs_os_free(path);
+        return NULL;
+    }
+
+    ecs_cbor_major_t major;
+    uint64_t len;
+    bool indefinite;
+    if (flecs_cbor_read_head(&ptr, end, &major, &len, &indefinite)) {
+        return NULL;
+    }
+
+    ecs_size_t size = comp->size * count;
+    if (major != EcsCborBytes || indefinite || len != (uint64_t)size ||
+        (uint64_t)(end - ptr) < len)
+    {
+        ecs_err("cbor: invalid size for typed array");
+        return NULL;
+    }
+
+    ecs_os_memcpy(data_out, ptr, size);
+
+    if (type_tag != tag) {
+        int32_t elem_size = 1 << (tag & 3);
+        if (tag & 16) {
+            elem_size *= 2; /* Float sizes start at 16 bits */
+        }
+
+        uint8_t *bytes = data_out;
+        int32_t i, j;
+        for (i = 0; i < size; i += elem_size) {
+            for (j = 0; j < elem_size / 2; j ++) {
+                uint8_t tmp = bytes[i + j];
+                bytes[i + j] = bytes[i + elem_size - j - 1];
+                bytes[i + elem_size - j - 1] = tmp;
+            }
+        }
+    }
+
+    return ptr + len;
+}
+
+const void* ecs_parse_cbor(
+    const ecs_world_t *world,
+    const void *data,
+    ecs_size_t size,
+    ecs_entity_t type,
+    void *data_out,
+    int32_t count)
+{
+    const uint8_t *ptr = data;
+    const uint8_t *end = ptr + size;
+
+    if (!count) {
+        ecs_meta_cursor_t cur = ecs_meta_cursor(world, type, data_out);
+        if (cur.valid == false) {
+            return NULL;
+        }
+        return flecs_cbor_parse_value(&cur, ptr, end);
+    }
+
+    const EcsComponent *comp = ecs_get(world, type, EcsComponent);
+    if (!comp) {
+        return NULL;
+    }
+
+    ecs_cbor_major_t major;
+    uint64_t value;
+    bool indefinite;
+    if (flecs_cbor_read_head(&ptr, end, &major, &value, &indefinite)) {
+        ecs_err("cbor: invalid item header");
+        return NULL;
+    }
+
+    if (major == EcsCborTag) {
+        return flecs_cbor_parse_typed_array(
+            world, ptr, end, type, value, data_out, count);
+    }
+
+    if (major != EcsCborArray) {
+        ecs_err("cbor: expected array or typed array");
+        return NULL;
+    }
+
+    if (!indefinite && value != (uint64_t)count) {
+        ecs_err("cbor: array does not have %d elements", count);
+        return NULL;
+    }
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_meta_cursor_t cur = ecs_meta_cursor(
+            world, type, ECS_ELEM(data_out, comp->size, i));
+        if (cur.valid == false) {
+            return NULL;
+        }
+
+        if (!(ptr = flecs_cbor_parse_value(&cur, ptr, end))) {
+            return NULL;
+        }
+    }
+
+    if (indefinite) {
+        if (!flecs_cbor_is_break(ptr, end)) {
+            ecs_err("cbor: array does not have %d elements", count);
+            return NULL;
+        }
+        ptr ++;
+    }
+
+    return ptr;
+}
+
+#endif
+
+
+#ifdef FLECS_REST
+
+/* Interval (ns) at which the REST thread checks for requests */
+#define ECS_REST_POLL_INTERVAL (1000 * 1000)
+
+/* Max number of rows serialized per iterator result. Large tables are split up
+ * so that a streamed reply can be flushed before it exceeds the chunk size. */
+#define ECS_REST_STREAM_ROW_COUNT (256)
+
+/* Max number of compiled rules cached by the query endpoint */
+#define ECS_REST_RULE_CACHE_SIZE (32)
+
+/* Default & minimum interval (ms) between updates sent to a subscriber */
+#define ECS_REST_SUBSCRIPTION_INTERVAL (100)
+#define ECS_REST_SUBSCRIPTION_INTERVAL_MIN (10)
+
+/* Time (s) after which an idle subscription sends a comment, so that closed
+ * connections are detected */
+#define ECS_REST_SUBSCRIPTION_KEEP_ALIVE (5.0)
+
+/* Compiled rule for a query expression, with the last reply for the rule */
+typedef struct {
+    char *expr;
+    ecs_rule_t *rule;
+    int64_t last_used;
+
+    /* Value of id_delete_total when the ids of the rule were last checked */
+    int64_t id_delete_total;
+
+    /* Last reply, valid while params & state of matched tables are the same */
+    char *body;
+    ecs_size_t body_size;
+    uint64_t params_hash;
+    uint64_t state;
+} ecs_rest_cached_rule_t;
+
+/* Paths of entities that no longer match a subscription (observer ctx) */
+typedef struct {
+    ecs_strbuf_t paths;
+    int32_t count;
+} ecs_rest_removed_t;
+
+/* Query that sends changed results to a client as server-sent events */
+typedef struct {
+    char *expr;
+    ecs_iter_to_json_desc_t desc;
+    ecs_http_stream_t *stream;
+    ecs_ftime_t interval;
+    ecs_ftime_t elapsed; /* Time since last update */
+    ecs_ftime_t idle; /* Time since data was last sent */
+
+    /* Created on main thread when subscription is first updated */
+    ecs_query_t *query;
+    ecs_entity_t observer;
+    ecs_rest_removed_t *removed; /* Owned by observer */
+} ecs_rest_subscription_t;
+
+typedef struct {
+    ecs_world_t *world;
+    ecs_entity_t entity;
+    ecs_http_server_t *srv;
+    int32_t rc;
+
+    /* Subscriptions are added by the thread that handles requests, and are
+     * updated on the main thread */
+    ecs_os_mutex_t sub_lock;
+    ecs_vector_t *subs_new; /* vector<ecs_rest_subscription_t*> (sub_lock) */
+    ecs_vector_t *subs; /* vector<ecs_rest_subscription_t*> */
+
+    /* Query endpoint caches */
+    ecs_rest_cached_rule_t rules[ECS_REST_RULE_CACHE_SIZE];
+    int32_t rule_count;
+    int64_t rule_use_count;
+    uint64_t etag_seed;  /* Prevents ETag reuse by different server instances */
+
+    /* Tables matched by queries that don't track changes yet. Change tracking
+     * is enabled on the main thread (sub_lock) */
+    ecs_vector_t *tables_untracked; /* vector<uint64_t> */
+
+    /* Used when requests are handled on a separate thread */
+    ecs_world_t *stage;
+    ecs_os_thread_t thread;
+    ecs_reader_t reader;
+} ecs_rest_ctx_t;
+
+static
+void flecs_rest_thread_fini(
+    ecs_rest_ctx_t *impl);
+
+static
+void flecs_rest_rule_cache_fini(
+    ecs_rest_ctx_t *impl);
+
+static
+void flecs_rest_subscriptions_fini(
+    ecs_rest_ctx_t *impl);
+
+static ECS_COPY(EcsRest, dst, src, {
+    ecs_rest_ctx_t *impl = src->impl;
+    if (impl) {
+        impl->rc ++;
+    }
+
+    ecs_os_strset(&dst->ipaddr, src->ipaddr);
+    dst->port = src->port;
+    dst->threaded = src->threaded;
+    dst->impl = impl;
+})
+
+static ECS_MOVE(EcsRest, dst, src, {
+    *dst = *src;
+    src->ipaddr = NULL;
+    src->impl = NULL;
+})
+
+static ECS_DTOR(EcsRest, ptr, { 
+    ecs_rest_ctx_t *impl = ptr->impl;
+    if (impl) {
+        impl->rc --;
+        if (!impl->rc) {
+            flecs_rest_thread_fini(impl);
+            flecs_rest_rule_cache_fini(impl);
+            flecs_rest_subscriptions_fini(impl);
+            ecs_vector_free(impl->tables_untracked);
+            ecs_http_server_fini(impl->srv);
+            ecs_os_mutex_free(impl->sub_lock);
+            ecs_os_free(impl);
+        }
+    }
+    ecs_os_free(ptr->ipaddr);
+})
+
+static char *rest_last_err;
+
+static 
+void flecs_rest_capture_log(
+    int32_t level, 
+    const char *file, 
+    int32_t line, 
+    const char *msg)
+{
+    (void)file; (void)line;
+
+    if (!rest_last_err && level < 0) {
+        rest_last_err = ecs_os_strdup(msg);
+    }
+}
+
+static
+char* flecs_rest_get_captured_log(void) {
+    char *result = rest_last_err;
+    rest_last_err = NULL;
+    return result;
+}
+
+static
+void flecs_reply_verror(
+    ecs_strbuf_t *buf,
+    const char *fmt,
+    va_list args)
+{
+    ecs_strbuf_appendlit(buf, "{\"error\":\"");
+    ecs_strbuf_vappend(buf, fmt, args);
+    ecs_strbuf_appendlit(buf, "\"}");
+}
+
+static
+void flecs_reply_error_buf(
+    ecs_strbuf_t *buf,
+    const char *fmt,
+    ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    flecs_reply_verror(buf, fmt, args);
+    va_end(args);
+}
+
+static
+void flecs_reply_error(
+    ecs_http_reply_t *reply,
+    const char *fmt,
+    ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    flecs_reply_verror(&reply->body, fmt, args);
+    va_end(args);
+}
+
+static
+void flecs_rest_bool_param(
+    const ecs_http_request_t *req,
+    const char *name,
+    bool *value_out)
+{
+    const char *value = ecs_http_get_param(req, name);
+    if (value) {
+        if (!ecs_os_strcmp(value, "true")) {
+            value_out[0] = true;
+        } else {
+            value_out[0] = false;
+        }
+    }
+}
+
+static
+void flecs_rest_int_param(
+    const ecs_http_request_t *req,
+    const char *name,
+    int32_t *value_out)
+{
+    const char *value = ecs_http_get_param(req, name);
+    if (value) {
+        *value_out = atoi(value);
+    }
+}
+
+static
+void flecs_rest_string_param(
+    const ecs_http_request_t *req,
+    const char *name,
+    char **value_out)
+{
+    const char *value = ecs_http_get_param(req, name);
+    if (value) {
+        *value_out = (char*)value;
+    }
+}
+
+static
+void flecs_rest_parse_json_ser_entity_params(
+    ecs_entity_to_json_desc_t *desc,
+    const ecs_http_request_t *req)
+{
+    flecs_rest_bool_param(req, "path", &desc->serialize_path);
+    flecs_rest_bool_param(req, "label", &desc->serialize_label);
+    flecs_rest_bool_param(req, "brief", &desc->serialize_brief);
+    flecs_rest_bool_param(req, "link", &desc->serialize_link);
+    flecs_rest_bool_param(req, "color", &desc->serialize_color);
+    flecs_rest_bool_param(req, "id_labels", &desc->serialize_id_labels);
+    flecs_rest_bool_param(req, "base", &desc->serialize_base);
+    flecs_rest_bool_param(req, "values", &desc->serialize_values);
+    flecs_rest_bool_param(req, "private", &desc->serialize_private);
+    flecs_rest_bool_param(req, "type_info", &desc->serialize_type_info);
+}
+
+static
+void flecs_rest_parse_json_ser_iter_params(
+    ecs_iter_to_json_desc_t *desc,
+    const ecs_http_request_t *req)
+{
+    flecs_rest_bool_param(req, "term_ids", &desc->serialize_term_ids);
+    flecs_rest_bool_param(req, "ids", &desc->serialize_ids);
+    flecs_rest_bool_param(req, "sources", &desc->serialize_sources);
+    flecs_rest_bool_param(req, "variables", &desc->serialize_variables);
+    flecs_rest_bool_param(req, "is_set", &desc->serialize_is_set);
+    flecs_rest_bool_param(req, "values", &desc->serialize_values);
+    flecs_rest_bool_param(req, "entities", &desc->serialize_entities);
+    flecs_rest_bool_param(req, "entity_labels", &desc->serialize_entity_labels);
+    flecs_rest_bool_param(req, "entity_ids", &desc->serialize_entity_ids);
+    flecs_rest_bool_param(req, "variable_labels", &desc->serialize_variable_labels);
+    flecs_rest_bool_param(req, "variable_ids", &desc->serialize_variable_ids);
+    flecs_rest_bool_param(req, "colors", &desc->serialize_colors);
+    flecs_rest_bool_param(req, "duration", &desc->measure_eval_duration);
+    flecs_rest_bool_param(req, "type_info", &desc->serialize_type_info);
+}
+
+/* Clients can request CBOR instead of JSON with the Accept header */
+static
+bool flecs_rest_accept_cbor(
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    const char *accept = ecs_http_get_header(req, "Accept");
+    if (accept && strstr(accept, "application/cbor")) {
+        reply->content_type = "application/cbor";
+        return true;
+    }
+    return false;
+}
+
+static
+bool flecs_rest_reply_entity(
+    ecs_world_t *world,
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    char *path = &req->path[7];
+    ecs_dbg_2("rest: request entity '%s'", path);
+
+    ecs_entity_t e = ecs_lookup_path_w_sep(
+        world, 0, path, "/", NULL, false);
+    if (!e) {
+        ecs_dbg_2("rest: entity '%s' not found", path);
+        flecs_reply_error(reply, "entity '%s' not found", path);
+        reply->code = 404;
+        return true;
+    }
+
+    ecs_entity_to_json_desc_t desc = ECS_ENTITY_TO_JSON_INIT;
+    flecs_rest_parse_json_ser_entity_params(&desc, req);
+
+    ecs_strbuf_appendlit(&reply->headers, "Vary: Accept\r\n");
+    if (flecs_rest_accept_cbor(req, reply)) {
+        ecs_entity_to_cbor_buf(world, e, &reply->body, &desc);
+    } else {
+        ecs_entity_to_json_buf(world, e, &reply->body, &desc);
+    }
+    return true;
+}
+
+typedef struct {
+    ecs_http_reply_t *reply;
+    int32_t remaining; /* Rows left to serialize for current result */
+    bool buffered; /* Don't flush, send reply when it is complete */
+    bool flushed;
+    bool aborted;
+} ecs_rest_stream_t;
+
+/* Iterator that flushes the reply each time the serialized body exceeds the
+ * chunk size, so that large query results are sent in chunks. */
+static
+bool flecs_rest_iter_next(
+    ecs_iter_t *it)
+{
+    ecs_rest_stream_t *stream = it->ctx;
+    ecs_http_reply_t *reply = stream->reply;
+
+    if (!stream->buffered && 
+        ecs_strbuf_written(&reply->body) >= ECS_HTTP_CHUNK_SIZE) 
+    {
+        stream->flushed = true;
+        if (ecs_http_reply_flush(reply)) {
+            /* Connection was closed, stop serializing */
+            stream->aborted = true;
+            return false;
+        }
+    }
+
+    int32_t count;
+    if (stream->remaining) {
+        /* Serialize next rows of current result */
+        count = it->count;
+        it->offset += count;
+        flecs_offset_iter(it, count);
+        count = stream->remaining;
+    } else {
+        ecs_iter_t *chain_it = it->chain_it;
+        if (!ecs_iter_next(chain_it)) {
+            return false;
+        }
+
+        /* Copy everything up to the private iterator data */
+        ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+        it->ctx = stream;
+        ECS_BIT_SET(it->flags, EcsIterIsInstanced);
+        count = it->count;
+    }
+
+    if (count > ECS_REST_STREAM_ROW_COUNT && it->table) {
+        stream->remaining = count - ECS_REST_STREAM_ROW_COUNT;
+        count = ECS_REST_STREAM_ROW_COUNT;
+    } else {
+        stream->remaining = 0;
+    }
+
+    it->count = count;
+    return true;
+}
+
+static
+void flecs_rest_cached_rule_fini(
+    ecs_rest_cached_rule_t *cr)
+{
+    ecs_rule_fini(cr->rule);
+    ecs_os_free(cr->expr);
+    ecs_os_free(cr->body);
+}
+
+static
+void flecs_rest_rule_cache_fini(
+    ecs_rest_ctx_t *impl)
+{
+    int32_t i;
+    for (i = 0; i < impl->rule_count; i ++) {
+        flecs_rest_cached_rule_fini(&impl->rules[i]);
+    }
+    impl->rule_count = 0;
+}
+
+static
+bool flecs_rest_term_id_alive(
+    const ecs_world_t *world,
+    const ecs_term_id_t *term_id)
+{
+    if (!term_id->id || (term_id->flags & EcsIsVariable)) {
+        return true;
+    }
+    return ecs_is_alive(world, term_id->id);
+}
+
+/* Rules store the ids of resolved entities. Check if they're still alive. */
+static
+bool flecs_rest_rule_ids_alive(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule)
+{
+    const ecs_filter_t *filter = ecs_rule_get_filter(rule);
+    int32_t i;
+    for (i = 0; i < filter->term_count; i ++) {
+        const ecs_term_t *term = &filter->terms[i];
+        if (!flecs_rest_term_id_alive(world, &term->src) ||
+            !flecs_rest_term_id_alive(world, &term->first) ||
+            !flecs_rest_term_id_alive(world, &term->second))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Find compiled rule for expression, or compile and add it to the cache. When
+ * the cache is full, the least recently used rule is evicted. */
+static
+ecs_rest_cached_rule_t* flecs_rest_get_rule(
+    ecs_rest_ctx_t *impl,
+    ecs_world_t *world,
+    const char *expr)
+{
+    int64_t id_delete_total = impl->world->info.id_delete_total;
+    ecs_rest_cached_rule_t *cr = NULL;
+    int32_t i;
+    for (i = 0; i < impl->rule_count; i ++) {
+        if (!ecs_os_strcmp(impl->rules[i].expr, expr)) {
+            cr = &impl->rules[i];
+            break;
+        }
+    }
+
+    /* Evict rule if one of its ids was deleted since it was last used */
+    if (cr && cr->id_delete_total != id_delete_total) {
+        if (flecs_rest_rule_ids_alive(impl->world, cr->rule)) {
+            cr->id_delete_total = id_delete_total;
+        } else {
+            flecs_rest_cached_rule_fini(cr);
+            impl->rules[i] = impl->rules[-- impl->rule_count];
+            cr = NULL;
+        }
+    }
+
+    if (!cr) {
+        ecs_rule_t *rule = ecs_rule_init(world, &(ecs_filter_desc_t){
+            .expr = expr
+        });
+        if (!rule) {
+            return NULL;
+        }
+
+        if (impl->rule_count < ECS_REST_RULE_CACHE_SIZE) {
+            cr = &impl->rules[impl->rule_count ++];
+        } else {
+            cr = &impl->rules[0];
+            for (i = 1; i < impl->rule_count; i ++) {
+                if (impl->rules[i].last_used < cr->last_used) {
+                    cr = &impl->rules[i];
+                }
+            }
+            flecs_rest_cached_rule_fini(cr);
+        }
+
+        ecs_os_zeromem(cr);
+        cr->expr = ecs_os_strdup(expr);
+        cr->rule = rule;
+        cr->id_delete_total = id_delete_total;
+    }
+
+    cr->last_used = ++ impl->rule_use_count;
+    return cr;
+}
+
+/* Hash of request parameters, so that replies for requests with different 
+ * serializer parameters, offset, limit or format get a different ETag. */
+static
+uint64_t flecs_rest_params_hash(
+    ecs_rest_ctx_t *impl,
+    const ecs_http_request_t* req,
+    bool cbor)
+{
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_strbuf_append(&buf, "%llx", (unsigned long long)impl->etag_seed);
+    if (cbor) {
+        ecs_strbuf_appendlit(&buf, "&cbor");
+    }
+
+    int32_t i;
+    for (i = 0; i < req->param_count; i ++) {
+        ecs_strbuf_appendch(&buf, '&');
+        ecs_strbuf_appendstr(&buf, req->params[i].key);
+        ecs_strbuf_appendch(&buf, '=');
+        ecs_strbuf_appendstr(&buf, req->params[i].value);
+    }
+
+    ecs_size_t len = ecs_strbuf_written(&buf);
+    char *str = ecs_strbuf_get(&buf);
+    uint64_t result = flecs_hash(str, len);
+    ecs_os_free(str);
+    return result;
+}
+
+/* Append change counters of table to the rule state. Returns false if the table
+ * doesn't track changes yet, in which case it is added to the list of tables
+ * for which the main thread enables change tracking. */
+static
+bool flecs_rest_table_state(
+    ecs_rest_ctx_t *impl,
+    ecs_strbuf_t *buf,
+    const ecs_table_t *table)
+{
+    if (!table) {
+        return true;
+    }
+
+    int32_t *dirty_state = table->dirty_state;
+    if (!dirty_state) {
+        ecs_os_mutex_lock(impl->sub_lock);
+        uint64_t *elem = ecs_vector_add(&impl->tables_untracked, uint64_t);
+        *elem = table->id;
+        ecs_os_mutex_unlock(impl->sub_lock);
+        return false;
+    }
+
+    ecs_strbuf_appendbin(buf, &table->id, ECS_SIZEOF(uint64_t));
+    ecs_strbuf_appendbin(buf, dirty_state, 
+        (table->storage_count + 1) * ECS_SIZEOF(int32_t));
+    return true;
+}
+
+/* Hash of the change counters of the tables matched by a rule. Tables change
+ * when entities are added or removed, and when components are written by a
+ * query or set with ecs_set/ecs_modified. Returns false if the state can't be 
+ * determined because a table doesn't track changes yet. */
+static
+bool flecs_rest_rule_state(
+    ecs_rest_ctx_t *impl,
+    ecs_world_t *world,
+    const ecs_rule_t *rule,
+    uint64_t *state_out)
+{
+    ecs_world_t *real_world = impl->world;
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+
+    /* Tables are recycled, so include counters for created & deleted tables */
+    ecs_strbuf_appendbin(&buf, &real_world->info.table_create_total, 
+        ECS_SIZEOF(int64_t));
+    ecs_strbuf_appendbin(&buf, &real_world->info.table_delete_total, 
+        ECS_SIZEOF(int64_t));
+
+    bool tracked = true;
+    ecs_iter_t it = ecs_rule_iter(world, rule);
+    while (ecs_rule_next(&it)) {
+        if (!flecs_rest_table_state(impl, &buf, it.table)) {
+            tracked = false;
+        }
+
+        /* Fields can be matched on other entities than the result entities */
+        int32_t i;
+        for (i = 0; i < it.field_count; i ++) {
+            ecs_entity_t src = it.sources[i];
+            if (src && !flecs_rest_table_state(
+                impl, &buf, ecs_get_table(real_world, src))) 
+            {
+                tracked = false;
+            }
+        }
+    }
+
+    ecs_size_t len = ecs_strbuf_written(&buf);
+    char *str = ecs_strbuf_get(&buf);
+    *state_out = flecs_hash(str, len);
+    ecs_os_free(str);
+    return tracked;
+}
+
+/* Enable change tracking for tables matched by queries. Runs on the main 
+ * thread, as it allocates from the world. */
+static
+void flecs_rest_track_tables(
+    ecs_rest_ctx_t *impl)
+{
+    ecs_world_t *world = impl->world;
+
+    ecs_os_mutex_lock(impl->sub_lock);
+    ecs_vector_t *tables = impl->tables_untracked;
+    impl->tables_untracked = NULL;
+    ecs_os_mutex_unlock(impl->sub_lock);
+
+    int32_t i, count = ecs_vector_count(tables);
+    uint64_t *ids = ecs_vector_first(tables, uint64_t);
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *table = flecs_sparse_get(
+            &world->store.tables, ecs_table_t, ids[i]);
+        if (table) {
+            flecs_table_get_dirty_state(world, table);
+        }
+    }
+
+    ecs_vector_free(tables);
+}
+
+static
+bool flecs_rest_reply_query(
+    ecs_rest_ctx_t *impl,
+    ecs_world_t *world,
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    const char *q = ecs_http_get_param(req, "q");
+    if (!q) {
+        ecs_strbuf_appendlit(&reply->body, "Missing parameter 'q'");
+        reply->code = 400; /* bad request */
+        return true;
+    }
+
+    ecs_dbg_2("rest: request query '%s'", q);
+    bool prev_color = ecs_log_enable_colors(false);
+    ecs_os_api_log_t prev_log_ = ecs_os_api.log_;
+    ecs_os_api.log_ = flecs_rest_capture_log;
+
+    ecs_rest_cached_rule_t *cr = flecs_rest_get_rule(impl, world, q);
+    if (!cr) {
+        char *err = flecs_rest_get_captured_log();
+        char *escaped_err = ecs_astresc('"', err);
+        flecs_reply_error(reply, escaped_err);
+        reply->code = 400; /* bad request */
+        ecs_os_free(escaped_err);
+        ecs_os_free(err);
+    } else {
+        bool cbor = flecs_rest_accept_cbor(req, reply);
+        ecs_strbuf_appendlit(&reply->headers, "Vary: Accept\r\n");
+
+        /* The reply can be reused while the matched tables haven't changed.
+         * Replies for tables that don't track changes yet are not cached. */
+        uint64_t params_hash = flecs_rest_params_hash(impl, req, cbor);
+        uint64_t state = 0;
+        bool tracked = flecs_rest_rule_state(impl, world, cr->rule, &state);
+        char etag[64] = {0};
+        if (tracked) {
+            ecs_os_sprintf(etag, "\"%llx-%llx\"", 
+                (unsigned long long)params_hash, 
+                (unsigned long long)state);
+            ecs_strbuf_append(&reply->headers, "ETag: %s\r\n", etag);
+        }
+
+        const char *if_none_match = ecs_http_get_header(req, "If-None-Match");
+        if (tracked && if_none_match && !ecs_os_strcmp(if_none_match, etag)) {
+            reply->code = 304;
+            reply->status = "Not Modified";
+        } else if (tracked && cr->body && cr->params_hash == params_hash && 
+            cr->state == state) 
+        {
+            ecs_strbuf_appendbin(&reply->body, cr->body, cr->body_size);
+        } else {
+            ecs_rule_t *r = cr->rule;
+            ecs_iter_to_json_desc_t desc = ECS_ITER_TO_JSON_INIT;
+            flecs_rest_parse_json_ser_iter_params(&desc, req);
+
+            int32_t offset = 0;
+            int32_t limit = 1000;
+
+            flecs_rest_int_param(req, "offset", &offset);
+            flecs_rest_int_param(req, "limit", &limit);
+
+            ecs_iter_t it = ecs_rule_iter(world, r);
+            ecs_iter_t pit = ecs_page_iter(&it, offset, limit);
+            ECS_BIT_SET(pit.flags, EcsIterIsInstanced);
+
+            /* A flush blocks while the client hasn't read earlier chunks. The
+             * REST thread can't block while reading the world, as that would
+             * also block the main thread, so its replies are sent when done */
+            ecs_rest_stream_t stream = { 
+                .reply = reply, 
+                .buffered = impl->thread != 0
+            };
+            ecs_iter_t sit = pit;
+            sit.next = flecs_rest_iter_next;
+            sit.fini = NULL;
+            sit.chain_it = &pit;
+            sit.ctx = &stream;
+
+            /* Iterator is created for the stage, but the serializer reads
+             * component metadata which isn't allowed on async stages */
+            if (cbor) {
+                ecs_iter_to_cbor_buf(impl->world, &sit, &reply->body, &desc);
+            } else {
+                ecs_iter_to_json_buf(impl->world, &sit, &reply->body, &desc);
+            }
+            if (stream.aborted) {
+                /* Cleanup resources of iterator that wasn't depleted */
+                ecs_iter_fini(&it);
+            } else if (tracked && !stream.flushed) {
+                /* Only cache replies that weren't streamed, as the body of a
+                 * streamed reply is no longer available */
+                ecs_size_t body_size = ecs_strbuf_written(&reply->body);
+                char *body = ecs_strbuf_get(&reply->body);
+                ecs_strbuf_appendbin(&reply->body, body, body_size);
+                ecs_os_free(cr->body);
+                cr->body = body;
+                cr->body_size = body_size;
+                cr->params_hash = params_hash;
+                cr->state = state;
+            }
+        }
+    }
+
+    ecs_os_api.log_ = prev_log_;
+    ecs_log_enable_colors(prev_color);
+
+    return true;
+}
+
+static
+void flecs_rest_removed_free(
+    void *ptr)
+{
+    ecs_rest_removed_t *removed = ptr;
+    ecs_strbuf_reset(&removed->paths);
+    ecs_os_free(removed);
+}
+
+/* Collect entities that no longer match the subscription query */
+static
+void flecs_rest_subscription_on_remove(
+    ecs_iter_t *it)
+{
+    ecs_rest_removed_t *removed = it->ctx;
+    int32_t i;
+    for (i = 0; i < it->count; i ++) {
+        if (removed->count ++) {
+            ecs_strbuf_appendch(&removed->paths, ',');
+        }
+        ecs_strbuf_appendch(&removed->paths, '"');
+        ecs_get_path_w_sep_buf(it->real_world, 0, it->entities[i], ".", "", 
+            &removed->paths);
+        ecs_strbuf_appendch(&removed->paths, '"');
+    }
+}
+
+/* Create query & observer for subscription */
+static
+int flecs_rest_subscription_init(
+    ecs_world_t *world,
+    ecs_rest_subscription_t *sub)
+{
+    ecs_filter_t *f = ecs_filter_init(world, &(ecs_filter_desc_t){
+        .expr = sub->expr
+    });
+    if (!f) {
+        return -1;
+    }
+
+    /* Subscriptions only read data, so they shouldn't mark results as changed
+     * when they are iterated */
+    int32_t i;
+    for (i = 0; i < f->term_count; i ++) {
+        ecs_term_t *term = &f->terms[i];
+        if (term->inout == EcsInOutDefault || term->inout == EcsInOut) {
+            term->inout = EcsIn;
+        }
+    }
+
+    sub->query = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms_buffer = f->terms,
+        .filter.terms_buffer_count = f->term_count,
+        .track_rows = true
+    });
+
+    if (sub->query) {
+        /* Removed entities are reported when a queried for component is 
+         * removed, or when the entity is deleted */
+        sub->removed = ecs_os_calloc_t(ecs_rest_removed_t);
+        sub->observer = ecs_observer_init(world, &(ecs_observer_desc_t){
+            .filter.terms_buffer = f->terms,
+            .filter.terms_buffer_count = f->term_count,
+            .events = { EcsOnRemove },
+            .callback = flecs_rest_subscription_on_remove,
+            .ctx = sub->removed,
+            .ctx_free = flecs_rest_removed_free
+        });
+        if (!sub->observer) {
+            flecs_rest_removed_free(sub->removed);
+            sub->removed = NULL;
+        }
+    }
+
+    ecs_filter_fini(f);
+
+    return sub->query ? 0 : -1;
+}
+
+static
+void flecs_rest_subscription_fini(
+    ecs_world_t *world,
+    ecs_rest_subscription_t *sub)
+{
+    /* Queries & observers are cleaned up by the world when it is deleted */
+    if (!(world->flags & EcsWorldFini)) {
+        if (sub->query) {
+            ecs_query_fini(sub->query);
+        }
+        if (sub->observer) {
+            ecs_delete(world, sub->observer);
+        }
+    }
+
+    ecs_http_stream_close(sub->stream);
+    ecs_os_free(sub->expr);
+    ecs_os_free(sub);
+}
+
+static
+void flecs_rest_subscriptions_fini(
+    ecs_rest_ctx_t *impl)
+{
+    int32_t i, count = ecs_vector_count(impl->subs_new);
+    ecs_rest_subscription_t **subs = ecs_vector_first(
+        impl->subs_new, ecs_rest_subscription_t*);
+    for (i = 0; i < count; i ++) {
+        flecs_rest_subscription_fini(impl->world, subs[i]);
+    }
+
+    count = ecs_vector_count(impl->subs);
+    subs = ecs_vector_first(impl->subs, ecs_rest_subscription_t*);
+    for (i = 0; i < count; i ++) {
+        flecs_rest_subscription_fini(impl->world, subs[i]);
+    }
+
+    ecs_vector_free(impl->subs_new);
+    ecs_vector_free(impl->subs);
+    impl->subs_new = NULL;
+    impl->subs = NULL;
+}
+
+/* Iterator that counts the number of results, so that updates without changed
+ * rows aren't sent */
+static
+bool flecs_rest_subscription_next(
+    ecs_iter_t *it)
+{
+    int32_t *result_count = it->ctx;
+    ecs_iter_t *chain_it = it->chain_it;
+    if (!ecs_iter_next(chain_it)) {
+        return false;
+    }
+
+    /* Copy everything up to the private iterator data */
+    ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+    it->ctx = result_count;
+    ECS_BIT_SET(it->flags, EcsIterIsInstanced);
+    result_count[0] ++;
+    return true;
+}
+
+/* Write event with rows that changed since the last update */
+static
+void flecs_rest_subscription_update(
+    ecs_world_t *world,
+    ecs_rest_subscription_t *sub,
+    ecs_strbuf_t *buf)
+{
+    ecs_strbuf_t changed = ECS_STRBUF_INIT;
+    int32_t result_count = 0;
+
+    if (ecs_query_changed(sub->query, NULL)) {
+        ecs_iter_t qit = ecs_query_iter(world, sub->query);
+        ECS_BIT_SET(qit.flags, EcsIterIsInstanced);
+        ECS_BIT_SET(qit.flags, EcsIterChangedOnly);
+
+        ecs_iter_t it = qit;
+        it.next = flecs_rest_subscription_next;
+        it.fini = NULL;
+        it.chain_it = &qit;
+        it.ctx = &result_count;
+        ecs_iter_to_json_buf(world, &it, &changed, &sub->desc);
+    }
+
+    ecs_rest_removed_t *removed = sub->removed;
+    if (!result_count && (!removed || !removed->count)) {
+        ecs_strbuf_reset(&changed);
+        return;
+    }
+
+    ecs_strbuf_appendlit(buf, "event: update\ndata: {\"removed\":[");
+    if (removed && removed->count) {
+        ecs_strbuf_mergebuff(buf, &removed->paths);
+        removed->count = 0;
+    }
+    ecs_strbuf_appendlit(buf, "], \"changed\":");
+    if (result_count) {
+        ecs_strbuf_mergebuff(buf, &changed);
+    } else {
+        ecs_strbuf_reset(&changed);
+        ecs_strbuf_appendlit(buf, "{\"results\":[]}");
+    }
+    ecs_strbuf_appendlit(buf, "}\n\n");
+}
+
+/* Send changes to subscribers. Runs on the main thread, as subscriptions 
+ * create queries. */
+static
+void flecs_rest_subscriptions_progress(
+    ecs_rest_ctx_t *impl,
+    ecs_ftime_t delta_time)
+{
+    ecs_world_t *world = impl->world;
+
+    ecs_os_mutex_lock(impl->sub_lock);
+    int32_t i, count = ecs_vector_count(impl->subs_new);
+    ecs_rest_subscription_t **subs = ecs_vector_first(
+        impl->subs_new, ecs_rest_subscription_t*);
+    for (i = 0; i < count; i ++) {
+        ecs_rest_subscription_t **elem = ecs_vector_add(
+            &impl->subs, ecs_rest_subscription_t*);
+        *elem = subs[i];
+    }
+    ecs_vector_clear(impl->subs_new);
+    ecs_os_mutex_unlock(impl->sub_lock);
+
+    count = ecs_vector_count(impl->subs);
+    if (!count) {
+        return;
+    }
+
+    bool prev_color = ecs_log_enable_colors(false);
+    ecs_os_api_log_t prev_log_ = ecs_os_api.log_;
+    ecs_os_api.log_ = flecs_rest_capture_log;
+
+    subs = ecs_vector_first(impl->subs, ecs_rest_subscription_t*);
+    for (i = count - 1; i >= 0; i --) {
+        ecs_rest_subscription_t *sub = subs[i];
+        ecs_strbuf_t buf = ECS_STRBUF_INIT;
+
+        if (!sub->query) {
+            if (flecs_rest_subscription_init(world, sub)) {
+                char *err = flecs_rest_get_captured_log();
+                char *escaped_err = ecs_astresc('"', err);
+                ecs_strbuf_appendlit(&buf, "event: error\ndata: ");
+                flecs_reply_error_buf(&buf, "%s", escaped_err);
+                ecs_strbuf_appendlit(&buf, "\n\n");
+                ecs_http_stream_send(sub->stream, &buf);
+                ecs_os_free(escaped_err);
+                ecs_os_free(err);
+                goto remove;
+            }
+
+            /* Send current results immediately */
+            sub->elapsed = sub->interval;
+        }
+
+        sub->elapsed += delta_time;
+        sub->idle += delta_time;
+        if (sub->elapsed < sub->interval) {
+            continue;
+        }
+
+        /* Don't send updates to clients that haven't received the previous 
+         * update. Changes are sent with the next update. */
+        if (ecs_http_stream_queued(sub->stream)) {
+            continue;
+        }
+
+        sub->elapsed = 0;
+        flecs_rest_subscription_update(world, sub, &buf);
+        if (!ecs_strbuf_written(&buf) && 
+            sub->idle > (ecs_ftime_t)ECS_REST_SUBSCRIPTION_KEEP_ALIVE) 
+        {
+            ecs_strbuf_appendlit(&buf, ": keep-alive\n\n");
+        }
+
+        if (ecs_strbuf_written(&buf)) {
+            sub->idle = 0;
+            if (ecs_http_stream_send(sub->stream, &buf)) {
+                /* Connection was closed */
+                goto remove;
+            }
+        }
+
+        continue;
+remove:
+        ecs_strbuf_reset(&buf);
+        flecs_rest_subscription_fini(world, sub);
+        ecs_vector_remove(impl->subs, ecs_rest_subscription_t*, i);
+        subs = ecs_vector_first(impl->subs, ecs_rest_subscription_t*);
+    }
+
+    ecs_os_api.log_ = prev_log_;
+    ecs_log_enable_colors(prev_color);
+}
+
+static
+bool flecs_rest_reply_subscribe(
+    ecs_rest_ctx_t *impl,
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    const char *q = ecs_http_get_param(req, "q");
+    if (!q) {
+        ecs_strbuf_appendlit(&reply->body, "Missing parameter 'q'");
+        reply->code = 400; /* bad request */
+        return true;
+    }
+
+    ecs_http_stream_t *stream = ecs_http_reply_open_stream(reply);
+    if (!stream) {
+        flecs_reply_error(reply, "subscriptions require HTTP/1.1");
+        reply->code = 400; /* bad request */
+        return true;
+    }
+
+    ecs_dbg_2("rest: subscribe to query '%s'", q);
+
+    reply->content_type = "text/event-stream";
+    ecs_strbuf_appendlit(&reply->headers, "Cache-Control: no-cache\r\n");
+
+    int32_t interval = ECS_REST_SUBSCRIPTION_INTERVAL;
+    flecs_rest_int_param(req, "interval", &interval);
+    if (interval < ECS_REST_SUBSCRIPTION_INTERVAL_MIN) {
+        interval = ECS_REST_SUBSCRIPTION_INTERVAL_MIN;
+    }
+
+    ecs_rest_subscription_t *sub = ecs_os_calloc_t(ecs_rest_subscription_t);
+    sub->expr = ecs_os_strdup(q);
+    sub->desc = ECS_ITER_TO_JSON_INIT;
+    flecs_rest_parse_json_ser_iter_params(&sub->desc, req);
+    sub->stream = stream;
+    sub->interval = (ecs_ftime_t)interval / (ecs_ftime_t)1000.0;
+
+    ecs_os_mutex_lock(impl->sub_lock);
+    ecs_rest_subscription_t **elem = ecs_vector_add(
+        &impl->subs_new, ecs_rest_subscription_t*);
+    *elem = sub;
+    ecs_os_mutex_unlock(impl->sub_lock);
+
+    return true;
+}
+
+#ifdef FLECS_MONITOR
+
+static
+void _flecs_rest_array_append(
+    ecs_strbuf_t *reply,
+    const char *field,
+    int32_t field_len,
+    const ecs_float_t *values,
+    int32_t t)
+{
+    ecs_strbuf_list_appendch(reply, '"');
+    ecs_strbuf_appendstrn(reply, field, field_len);
+    ecs_strbuf_appendlit(reply, "\":");
+    ecs_strbuf_list_push(reply, "[", ",");
+
+    int32_t i;
+    for (i = t + 1; i <= (t + ECS_STAT_WINDOW); i ++) {
+        int32_t index = i % ECS_STAT_WINDOW;
+        ecs_strbuf_list_next(reply);
+        ecs_strbuf_appendflt(reply, (double)values[index], '"');
+    }
+
+    ecs_strbuf_list_pop(reply, "]");
+}
+
+#define flecs_rest_array_append(reply, field, values, t)\
+    _flecs_rest_array_append(reply, field, sizeof(field) - 1, values, t)
+
+static
+void flecs_rest_gauge_append(
+    ecs_strbuf_t *reply,
+    const ecs_metric_t *m,
+    const char *field,
+    int32_t field_len,
+    int32_t t,
+    const char *brief,
+    int32_t brief_len)
+{
+    ecs_strbuf_list_appendch(reply, '"');
+    ecs_strbuf_appendstrn(reply, field, field_len);
+    ecs_strbuf_appendlit(reply, "\":");
+    ecs_strbuf_list_push(reply, "{", ",");
+
+    flecs_rest_array_append(reply, "avg", m->gauge.avg, t);
+    flecs_rest_array_append(reply, "min", m->gauge.min, t);
+    flecs_rest_array_append(reply, "max", m->gauge.max, t);
+
+    if (brief) {
+        ecs_strbuf_list_appendlit(reply, "\"brief\":\"");
+        ecs_strbuf_appendstrn(reply, brief, brief_len);
+        ecs_strbuf_appendch(reply, '"');
+    }
+
+    ecs_strbuf_list_pop(reply, "}");
+}
+
+static
+void flecs_rest_counter_append(
+    ecs_strbuf_t *reply,
+    const ecs_metric_t *m,
+    const char *field,
+    int32_t field_len,
+    int32_t t,
+    const char *brief,
+    int32_t brief_len)
+{
+    flecs_rest_gauge_append(reply, m, field, field_len, t, brief, brief_len);
+}
+
+static
+void flecs_rest_latency_append(
+    ecs_strbuf_t *reply,
+    const ecs_latency_t *l,
+    const char *field,
+    int32_t field_len,
+    int32_t t,
+    const char *brief,
+    int32_t brief_len)
+{
+    ecs_strbuf_list_appendch(reply, '"');
+    ecs_strbuf_appendstrn(reply, field, field_len);
+    ecs_strbuf_appendlit(reply, "\":");
+    ecs_strbuf_list_push(reply, "{", ",");
+
+    flecs_rest_array_append(reply, "p50", l->p50, t);
+    flecs_rest_array_append(reply, "p90", l->p90, t);
+    flecs_rest_array_append(reply, "p99", l->p99, t);
+    flecs_rest_array_append(reply, "p999", l->p999, t);
+
+    if (brief) {
+        ecs_strbuf_list_appendlit(reply, "\"brief\":\"");
+        ecs_strbuf_appendstrn(reply, brief, brief_len);
+        ecs_strbuf_appendch(reply, '"');
+    }
+
+    ecs_strbuf_list_pop(reply, "}");
+}
+
+#define ECS_GAUGE_APPEND_T(reply, s, field, t, brief)\
+    flecs_rest_gauge_append(reply, &(s)->field, #field, sizeof(#field) - 1, t, brief, sizeof(brief) - 1)
+
+#define ECS_COUNTER_APPEND_T(reply, s, field, t, brief)\
+    flecs_rest_counter_append(reply, &(s)->field, #field, sizeof(#field) - 1, t, brief, sizeof(brief) - 1)
+
+#define ECS_GAUGE_APPEND(reply, s, field, brief)\
+    ECS_GAUGE_APPEND_T(reply, s, field, (s)->t, brief)
+
+#define ECS_COUNTER_APPEND(reply, s, field, brief)\
+    ECS_COUNTER_APPEND_T(reply, s, field, (s)->t, brief)
+
+#define ECS_LATENCY_APPEND_T(reply, s, field, t, brief)\
+    flecs_rest_latency_append(reply, &(s)->field, #field, sizeof(#field) - 1, t, brief, sizeof(brief) - 1)
+
+#define ECS_LATENCY_APPEND(reply, s, field, brief)\
+    ECS_LATENCY_APPEND_T(reply, s, field, (s)->t, brief)
+
+static
+void flecs_world_stats_to_json(
+    ecs_strbuf_t *reply,
+    const EcsWorldStats *monitor_stats)
+{
+    const ecs_world_stats_t *stats = &monitor_stats->stats;
+
+    ecs_strbuf_list_push(reply, "{", ",");
+    ECS_GAUGE_APPEND(reply, stats, entities.count, "Alive entity ids in the world");
+    ECS_GAUGE_APPEND(reply, stats, entities.not_alive_count, "Not alive entity ids in the world");
+
+    ECS_GAUGE_APPEND(reply, stats, performance.fps, "Frames per second");
+    ECS_COUNTER_APPEND(reply, stats, performance.frame_time, "Time spent in frame");
+    ECS_COUNTER_APPEND(reply, stats, performance.system_time, "Time spent on running systems in frame");
+    ECS_COUNTER_APPEND(reply, stats, performance.emit_time, "Time spent on notifying observers in frame");
+    ECS_COUNTER_APPEND(reply, stats, performance.merge_time, "Time spent on merging commands in frame");
+    ECS_COUNTER_APPEND(reply, stats, performance.rematch_time, "Time spent on revalidating query caches in frame");
+    ECS_LATENCY_APPEND(reply, stats, latency.frame_time, "Percentiles of time spent in frame");
+    ECS_LATENCY_APPEND(reply, stats, latency.merge_time, "Percentiles of time spent in merge");
+    ECS_LATENCY_APPEND(reply, stats, latency.sync_time, "Percentiles of time spent in sync points");
+
+    ECS_COUNTER_APPEND(reply, stats, commands.add_count, "Add commands executed");
+    ECS_COUNTER_APPEND(reply, stats, commands.remove_count, "Remove commands executed");
+    ECS_COUNTER_APPEND(reply, stats, commands.delete_count, "Delete commands executed");
+    ECS_COUNTER_APPEND(reply, stats, commands.clear_count, "Clear commands executed");
+    ECS_COUNTER_APPEND(reply, stats, commands.set_count, "Set commands executed");
+    ECS_COUNTER_APPEND(reply, stats, commands.get_mut_count, "Get_mut commands executed");
+    ECS_COUNTER_APPEND(reply, stats, commands.modified_count, "Modified commands executed");
+    ECS_COUNTER_APPEND(reply, stats, commands.other_count, "Misc commands executed");
+    ECS_COUNTER_APPEND(reply, stats, commands.discard_count, "Commands for already deleted entities");
+    ECS_COUNTER_APPEND(reply, stats, commands.batched_entity_count, "Entities with batched commands");
+    ECS_COUNTER_APPEND(reply, stats, commands.batched_count, "Number of commands batched");
+
+    ECS_COUNTER_APPEND(reply, stats, frame.merge_count, "Number of merges (sync points)");
+    ECS_COUNTER_APPEND(reply, stats, frame.pipeline_build_count, "Pipeline rebuilds (happen when systems become active/enabled)");
+    ECS_COUNTER_APPEND(reply, stats, frame.systems_ran, "Systems ran in frame");
+    ECS_COUNTER_APPEND(reply, stats, frame.observers_ran, "Number of times an observer was invoked in frame");
+    ECS_COUNTER_APPEND(reply, stats, frame.event_emit_count, "Events emitted in frame");
+    ECS_COUNTER_APPEND(reply, stats, frame.rematch_count, "Number of query cache revalidations");
+
+    ECS_GAUGE_APPEND(reply, stats, tables.count, "Tables in the world (including empty)");
+    ECS_GAUGE_APPEND(reply, stats, tables.empty_count, "Empty tables in the world");
+    ECS_GAUGE_APPEND(reply, stats, tables.tag_only_count, "Tables with only tags");
+    ECS_GAUGE_APPEND(reply, stats, tables.trivial_only_count, "Tables with only trivial types (no hooks)");
+    ECS_GAUGE_APPEND(reply, stats, tables.record_count, "Table records registered with search indices");
+    ECS_GAUGE_APPEND(reply, stats, tables.storage_count, "Component storages for all tables");
+    ECS_COUNTER_APPEND(reply, stats, tables.create_count, "Number of new tables created");
+    ECS_COUNTER_APPEND(reply, stats, tables.delete_count, "Number of tables deleted");
+    ECS_COUNTER_APPEND(reply, stats, tables.match_count, "Number of table/query match evaluations");
+
+    ECS_GAUGE_APPEND(reply, stats, ids.count, "Component, tag and pair ids in use");
+    ECS_GAUGE_APPEND(reply, stats, ids.tag_count, "Tag ids in use");
+    ECS_GAUGE_APPEND(reply, stats, ids.component_count, "Component ids in use");
+    ECS_GAUGE_APPEND(reply, stats, ids.pair_count, "Pair ids in use");
+    ECS_GAUGE_APPEND(reply, stats, ids.wildcard_count, "Wildcard ids in use");
+    ECS_GAUGE_APPEND(reply, stats, ids.type_count, "Registered component types");
+    ECS_COUNTER_APPEND(reply, stats, ids.create_count, "Number of new component, tag and pair ids created");
+    ECS_COUNTER_APPEND(reply, stats, ids.delete_count, "Number of component, pair and tag ids deleted");
+    ECS_GAUGE_APPEND(reply, stats, ids.target_index_count, "Entries in relationship target indices");
+
+    ECS_GAUGE_APPEND(reply, stats, queries.query_count, "Queries in the world");
+    ECS_GAUGE_APPEND(reply, stats, queries.observer_count, "Observers in the world");
+    ECS_GAUGE_APPEND(reply, stats, queries.system_count, "Systems in the world");
+
+    ECS_COUNTER_APPEND(reply, stats, memory.alloc_count, "Allocations by OS API");
+    ECS_COUNTER_APPEND(reply, stats, memory.realloc_count, "Reallocs by OS API");
+    ECS_COUNTER_APPEND(reply, stats, memory.free_count, "Frees by OS API");
+    ECS_GAUGE_APPEND(reply, stats, memory.outstanding_alloc_count, "Outstanding allocations by OS API");
+    ECS_COUNTER_APPEND(reply, stats, memory.block_alloc_count, "Blocks allocated by block allocators");
+    ECS_COUNTER_APPEND(reply, stats, memory.block_free_count, "Blocks freed by block allocators");
+    ECS_GAUGE_APPEND(reply, stats, memory.block_outstanding_alloc_count, "Outstanding block allocations");
+    ECS_COUNTER_APPEND(reply, stats, memory.stack_alloc_count, "Pages allocated by stack allocators");
+    ECS_COUNTER_APPEND(reply, stats, memory.stack_free_count, "Pages freed by stack allocators");
+    ECS_GAUGE_APPEND(reply, stats, memory.stack_outstanding_alloc_count, "Outstanding page allocations");
+    ECS_GAUGE_APPEND(reply, stats, memory.target_index_memory, "Memory used by relationship target indices");
+    ecs_strbuf_list_pop(reply, "}");
+}
+
+static
+void flecs_system_stats_to_json(
+    ecs_world_t *world,
+    ecs_strbuf_t *reply,
+    ecs_entity_t system,
+    const ecs_system_stats_t *stats)
+{
+    ecs_strbuf_list_push(reply, "{", ",");
+    ecs_strbuf_list_appendlit(reply, "\"name\":\"");
+    ecs_get_path_w_sep_buf(world, 0, system, ".", NULL, reply);
+    ecs_strbuf_appendch(reply, '"');
+
+    if (!stats->task) {
+        ECS_GAUGE_APPEND(reply, &stats->query, matched_table_count, "");
+        ECS_GAUGE_APPEND(reply, &stats->query, matched_entity_count, "");
+#ifdef FLECS_QUERY_COUNTERS
+        ECS_COUNTER_APPEND(reply, &stats->query, iterated_table_count, "");
+        ECS_COUNTER_APPEND(reply, &stats->query, iterated_entity_count, "");
+        ECS_COUNTER_APPEND(reply, &stats->query, skipped_table_count, "");
+        ECS_COUNTER_APPEND(reply, &stats->query, change_check_count, "");
+        ECS_COUNTER_APPEND(reply, &stats->query, bytes_touched, "");
+        ECS_COUNTER_APPEND(reply, &stats->query, rematch_time, "");
+        ECS_COUNTER_APPEND(reply, &stats->query, sort_time, "");
+#endif
+    }
+
+    ECS_COUNTER_APPEND_T(reply, stats, time_spent, stats->query.t, "");
+    ECS_LATENCY_APPEND_T(reply, stats, time_latency, stats->query.t, "");
+#ifdef FLECS_PERF_COUNTERS
+    ECS_COUNTER_APPEND_T(reply, stats, cycles, stats->query.t, "");
+    ECS_COUNTER_APPEND_T(reply, stats, instructions, stats->query.t, "");
+    ECS_COUNTER_APPEND_T(reply, stats, cache_misses, stats->query.t, "");
+    ECS_COUNTER_APPEND_T(reply, stats, branch_misses, stats->query.t, "");
+#endif
+    ecs_strbuf_list_pop(reply, "}");
+}
+
+static
+void flecs_pipeline_stats_to_json(
+    ecs_world_t *world,
+    ecs_strbuf_t *reply,
+    const EcsPipelineStats *stats)
+{
+    ecs_strbuf_list_push(reply, "[", ",");
+
+    int32_t i, count = ecs_vector_count(stats->stats.systems);
+    ecs_entity_t *ids = ecs_vector_first(stats->stats.systems, ecs_entity_t);
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t id = ids[i];
+        
+        ecs_strbuf_list_next(reply);
+
+        if (id) {
+            ecs_system_stats_t *sys_stats = ecs_map_get(
+                    &stats->stats.system_stats, ecs_system_stats_t, id);
+            flecs_system_stats_to_json(world, reply, id, sys_stats);
+        } else {
+            /* Sync point */
+            ecs_strbuf_list_push(reply, "{", ",");
+            ecs_strbuf_list_pop(reply, "}");
+        }
+    }
+
+    ecs_strbuf_list_pop(reply, "]");
+}
 
 static
 bool flecs_rest_reply_stats(
@@ -34678,6 +40544,366 @@ bool flecs_rest_reply_stats(
 
     return true;
 }
+
+/* Metric names are derived from the stats field, so "entities.count" becomes
+ * "flecs_entities_count". */
+static
+void flecs_rest_metric_name(
+    ecs_strbuf_t *reply,
+    const char *field,
+    int32_t field_len)
+{
+    char name[64];
+    ecs_assert(field_len < 64, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t i;
+    for (i = 0; i < field_len; i ++) {
+        char ch = field[i];
+        name[i] = ch == '.' ? '_' : ch;
+    }
+
+    ecs_strbuf_appendlit(reply, "flecs_");
+    ecs_strbuf_appendstrn(reply, name, field_len);
+}
+
+static
+void flecs_rest_metric_family(
+    ecs_strbuf_t *reply,
+    const char *field,
+    int32_t field_len,
+    const char *type,
+    const char *brief,
+    int32_t brief_len)
+{
+    ecs_strbuf_appendlit(reply, "# TYPE ");
+    flecs_rest_metric_name(reply, field, field_len);
+    ecs_strbuf_appendch(reply, ' ');
+    ecs_strbuf_appendstr(reply, type);
+    ecs_strbuf_appendch(reply, '\n');
+
+    if (brief_len) {
+        ecs_strbuf_appendlit(reply, "# HELP ");
+        flecs_rest_metric_name(reply, field, field_len);
+        ecs_strbuf_appendch(reply, ' ');
+        ecs_strbuf_appendstrn(reply, brief, brief_len);
+        ecs_strbuf_appendch(reply, '\n');
+    }
+}
+
+static
+void flecs_rest_metric_value(
+    ecs_strbuf_t *reply,
+    ecs_float_t value)
+{
+    ecs_strbuf_appendch(reply, ' ');
+    ecs_strbuf_appendflt(reply, (double)value, 0);
+    ecs_strbuf_appendch(reply, '\n');
+}
+
+static
+void flecs_rest_gauge_metric(
+    ecs_strbuf_t *reply,
+    const ecs_metric_t *m,
+    const char *field,
+    int32_t field_len,
+    int32_t t,
+    const char *brief,
+    int32_t brief_len)
+{
+    flecs_rest_metric_family(reply, field, field_len, "gauge", 
+        brief, brief_len);
+    flecs_rest_metric_name(reply, field, field_len);
+    flecs_rest_metric_value(reply, m->gauge.avg[t]);
+}
+
+/* Counters hold the running total, the rate is left to the scraper */
+static
+void flecs_rest_counter_metric(
+    ecs_strbuf_t *reply,
+    const ecs_metric_t *m,
+    const char *field,
+    int32_t field_len,
+    int32_t t,
+    const char *brief,
+    int32_t brief_len)
+{
+    flecs_rest_metric_family(reply, field, field_len, "counter", 
+        brief, brief_len);
+    flecs_rest_metric_name(reply, field, field_len);
+    ecs_strbuf_appendlit(reply, "_total");
+    flecs_rest_metric_value(reply, m->counter.value[t]);
+}
+
+static
+void flecs_rest_latency_quantile(
+    ecs_strbuf_t *reply,
+    const char *field,
+    int32_t field_len,
+    const char *quantile,
+    ecs_float_t value)
+{
+    flecs_rest_metric_name(reply, field, field_len);
+    ecs_strbuf_appendlit(reply, "{quantile=\"");
+    ecs_strbuf_appendstr(reply, quantile);
+    ecs_strbuf_appendlit(reply, "\"}");
+    flecs_rest_metric_value(reply, value);
+}
+
+static
+void flecs_rest_latency_metric(
+    ecs_strbuf_t *reply,
+    const ecs_latency_t *l,
+    const char *field,
+    int32_t field_len,
+    int32_t t,
+    const char *brief,
+    int32_t brief_len)
+{
+    flecs_rest_metric_family(reply, field, field_len, "summary", 
+        brief, brief_len);
+    flecs_rest_latency_quantile(reply, field, field_len, "0.5", l->p50[t]);
+    flecs_rest_latency_quantile(reply, field, field_len, "0.9", l->p90[t]);
+    flecs_rest_latency_quantile(reply, field, field_len, "0.99", l->p99[t]);
+    flecs_rest_latency_quantile(reply, field, field_len, "0.999", l->p999[t]);
+}
+
+#define ECS_GAUGE_METRIC(reply, s, field, brief)\
+    flecs_rest_gauge_metric(reply, &(s)->field, #field, sizeof(#field) - 1, (s)->t, brief, sizeof(brief) - 1)
+
+#define ECS_COUNTER_METRIC(reply, s, field, brief)\
+    flecs_rest_counter_metric(reply, &(s)->field, #field, sizeof(#field) - 1, (s)->t, brief, sizeof(brief) - 1)
+
+#define ECS_LATENCY_METRIC(reply, s, field, brief)\
+    flecs_rest_latency_metric(reply, &(s)->field, #field, sizeof(#field) - 1, (s)->t, brief, sizeof(brief) - 1)
+
+static
+void flecs_world_stats_to_metrics(
+    ecs_strbuf_t *reply,
+    const ecs_world_stats_t *stats)
+{
+    ECS_GAUGE_METRIC(reply, stats, entities.count, "Alive entity ids in the world");
+    ECS_GAUGE_METRIC(reply, stats, entities.not_alive_count, "Not alive entity ids in the world");
+
+    ECS_GAUGE_METRIC(reply, stats, performance.fps, "Frames per second");
+    ECS_COUNTER_METRIC(reply, stats, performance.frame_time, "Time spent in frame");
+    ECS_COUNTER_METRIC(reply, stats, performance.system_time, "Time spent on running systems in frame");
+    ECS_COUNTER_METRIC(reply, stats, performance.emit_time, "Time spent on notifying observers in frame");
+    ECS_COUNTER_METRIC(reply, stats, performance.merge_time, "Time spent on merging commands in frame");
+    ECS_COUNTER_METRIC(reply, stats, performance.rematch_time, "Time spent on revalidating query caches in frame");
+    ECS_LATENCY_METRIC(reply, stats, latency.frame_time, "Percentiles of time spent in frame");
+    ECS_LATENCY_METRIC(reply, stats, latency.merge_time, "Percentiles of time spent in merge");
+    ECS_LATENCY_METRIC(reply, stats, latency.sync_time, "Percentiles of time spent in sync points");
+
+    ECS_COUNTER_METRIC(reply, stats, commands.add_count, "Add commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.remove_count, "Remove commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.delete_count, "Delete commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.clear_count, "Clear commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.set_count, "Set commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.get_mut_count, "Get_mut commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.modified_count, "Modified commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.other_count, "Misc commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.discard_count, "Commands for already deleted entities");
+    ECS_COUNTER_METRIC(reply, stats, commands.batched_entity_count, "Entities with batched commands");
+    ECS_COUNTER_METRIC(reply, stats, commands.batched_count, "Number of commands batched");
+
+    ECS_COUNTER_METRIC(reply, stats, frame.frame_count, "Frames processed");
+    ECS_COUNTER_METRIC(reply, stats, frame.merge_count, "Number of merges (sync points)");
+    ECS_COUNTER_METRIC(reply, stats, frame.pipeline_build_count, "Pipeline rebuilds (happen when systems become active/enabled)");
+    ECS_COUNTER_METRIC(reply, stats, frame.systems_ran, "Systems ran");
+    ECS_COUNTER_METRIC(reply, stats, frame.observers_ran, "Number of times an observer was invoked");
+    ECS_COUNTER_METRIC(reply, stats, frame.event_emit_count, "Events emitted");
+    ECS_COUNTER_METRIC(reply, stats, frame.rematch_count, "Number of query cache revalidations");
+
+    ECS_GAUGE_METRIC(reply, stats, tables.count, "Tables in the world (including empty)");
+    ECS_GAUGE_METRIC(reply, stats, tables.empty_count, "Empty tables in the world");
+    ECS_GAUGE_METRIC(reply, stats, tables.tag_only_count, "Tables with only tags");
+    ECS_GAUGE_METRIC(reply, stats, tables.trivial_only_count, "Tables with only trivial types (no hooks)");
+    ECS_GAUGE_METRIC(reply, stats, tables.record_count, "Table records registered with search indices");
+    ECS_GAUGE_METRIC(reply, stats, tables.storage_count, "Component storages for all tables");
+    ECS_COUNTER_METRIC(reply, stats, tables.create_count, "Number of new tables created");
+    ECS_COUNTER_METRIC(reply, stats, tables.delete_count, "Number of tables deleted");
+    ECS_COUNTER_METRIC(reply, stats, tables.match_count, "Number of table/query match evaluations");
+
+    ECS_GAUGE_METRIC(reply, stats, ids.count, "Component, tag and pair ids in use");
+    ECS_GAUGE_METRIC(reply, stats, ids.tag_count, "Tag ids in use");
+    ECS_GAUGE_METRIC(reply, stats, ids.component_count, "Component ids in use");
+    ECS_GAUGE_METRIC(reply, stats, ids.pair_count, "Pair ids in use");
+    ECS_GAUGE_METRIC(reply, stats, ids.wildcard_count, "Wildcard ids in use");
+    ECS_GAUGE_METRIC(reply, stats, ids.type_count, "Registered component types");
+    ECS_COUNTER_METRIC(reply, stats, ids.create_count, "Number of new component, tag and pair ids created");
+    ECS_COUNTER_METRIC(reply, stats, ids.delete_count, "Number of component, pair and tag ids deleted");
+    ECS_GAUGE_METRIC(reply, stats, ids.target_index_count, "Entries in relationship target indices");
+
+    ECS_GAUGE_METRIC(reply, stats, queries.query_count, "Queries in the world");
+    ECS_GAUGE_METRIC(reply, stats, queries.observer_count, "Observers in the world");
+    ECS_GAUGE_METRIC(reply, stats, queries.system_count, "Systems in the world");
+
+    ECS_COUNTER_METRIC(reply, stats, memory.alloc_count, "Allocations by OS API");
+    ECS_COUNTER_METRIC(reply, stats, memory.realloc_count, "Reallocs by OS API");
+    ECS_COUNTER_METRIC(reply, stats, memory.free_count, "Frees by OS API");
+    ECS_GAUGE_METRIC(reply, stats, memory.outstanding_alloc_count, "Outstanding allocations by OS API");
+    ECS_COUNTER_METRIC(reply, stats, memory.block_alloc_count, "Blocks allocated by block allocators");
+    ECS_COUNTER_METRIC(reply, stats, memory.block_free_count, "Blocks freed by block allocators");
+    ECS_GAUGE_METRIC(reply, stats, memory.block_outstanding_alloc_count, "Outstanding block allocations");
+    ECS_COUNTER_METRIC(reply, stats, memory.stack_alloc_count, "Pages allocated by stack allocators");
+    ECS_COUNTER_METRIC(reply, stats, memory.stack_free_count, "Pages freed by stack allocators");
+    ECS_GAUGE_METRIC(reply, stats, memory.stack_outstanding_alloc_count, "Outstanding page allocations");
+    ECS_GAUGE_METRIC(reply, stats, memory.target_index_memory, "Memory used by relationship target indices");
+}
+
+/* Label values may not contain unescaped quotes, backslashes or newlines */
+static
+void flecs_rest_metric_system_label(
+    ecs_world_t *world,
+    ecs_strbuf_t *reply,
+    ecs_entity_t system)
+{
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_get_path_w_sep_buf(world, 0, system, ".", NULL, &buf);
+
+    /* Don't allocate for paths that fit in the first element */
+    int32_t i, len = ecs_strbuf_written(&buf);
+    char *path;
+    if (len <= ECS_STRBUF_ELEMENT_SIZE) {
+        path = ecs_strbuf_get_small(&buf);
+    } else {
+        path = ecs_strbuf_get(&buf);
+    }
+
+    ecs_strbuf_appendlit(reply, "{system=\"");
+    for (i = 0; i < len; i ++) {
+        char ch = path[i];
+        if (ch == '"' || ch == '\\') {
+            ecs_strbuf_appendch(reply, '\\');
+            ecs_strbuf_appendch(reply, ch);
+        } else if (ch == '\n') {
+            ecs_strbuf_appendlit(reply, "\\n");
+        } else {
+            ecs_strbuf_appendch(reply, ch);
+        }
+    }
+    ecs_strbuf_appendlit(reply, "\"}");
+
+    if (len <= ECS_STRBUF_ELEMENT_SIZE) {
+        ecs_strbuf_reset(&buf);
+    } else {
+        ecs_os_free(path);
+    }
+}
+
+typedef enum ecs_rest_system_metric_t {
+    EcsRestSystemTimeSpent,
+    EcsRestSystemInvokeCount,
+    EcsRestSystemMatchedTableCount,
+    EcsRestSystemMatchedEntityCount
+} ecs_rest_system_metric_t;
+
+/* All samples of a metric family must be contiguous, so systems are visited
+ * once for each family. */
+static
+void flecs_pipeline_stats_to_metrics(
+    ecs_world_t *world,
+    ecs_strbuf_t *reply,
+    const ecs_pipeline_stats_t *stats,
+    ecs_rest_system_metric_t kind,
+    const char *name,
+    const char *type,
+    const char *brief)
+{
+    bool counter = !ecs_os_strcmp(type, "counter");
+    flecs_rest_metric_family(reply, name, ecs_os_strlen(name), type, 
+        brief, ecs_os_strlen(brief));
+
+    int32_t i, count = ecs_vector_count(stats->systems);
+    ecs_entity_t *ids = ecs_vector_first(stats->systems, ecs_entity_t);
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t id = ids[i];
+        if (!id) {
+            continue; /* Sync point */
+        }
+
+        const ecs_system_stats_t *sys_stats = ecs_map_get(
+            &stats->system_stats, ecs_system_stats_t, id);
+        int32_t t = sys_stats->query.t;
+        ecs_float_t value;
+        switch(kind) {
+        case EcsRestSystemTimeSpent:
+            value = sys_stats->time_spent.counter.value[t];
+            break;
+        case EcsRestSystemInvokeCount:
+            value = sys_stats->invoke_count.counter.value[t];
+            break;
+        case EcsRestSystemMatchedTableCount:
+            if (sys_stats->task) {
+                continue;
+            }
+            value = sys_stats->query.matched_table_count.gauge.avg[t];
+            break;
+        case EcsRestSystemMatchedEntityCount:
+            if (sys_stats->task) {
+                continue;
+            }
+            value = sys_stats->query.matched_entity_count.gauge.avg[t];
+            break;
+        default:
+            continue;
+        }
+
+        flecs_rest_metric_name(reply, name, ecs_os_strlen(name));
+        if (counter) {
+            ecs_strbuf_appendlit(reply, "_total");
+        }
+        flecs_rest_metric_system_label(world, reply, id);
+        flecs_rest_metric_value(reply, value);
+    }
+}
+
+static
+bool flecs_rest_reply_metrics(
+    ecs_world_t *world,
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    (void)req;
+
+    /* Stats are read from the world when replying from the REST thread */
+    world = (ecs_world_t*)ecs_get_world(world);
+
+    const EcsWorldStats *world_stats = ecs_get_pair(world, EcsWorld, 
+        EcsWorldStats, EcsPeriod1s);
+    const EcsPipelineStats *pipeline_stats = ecs_get_pair(world, EcsWorld, 
+        EcsPipelineStats, EcsPeriod1s);
+    if (!world_stats) {
+        flecs_reply_error(reply, "monitor module is not imported");
+        reply->code = 404;
+        return false;
+    }
+
+    reply->content_type = 
+        "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+    ecs_strbuf_t *buf = &reply->body;
+    flecs_world_stats_to_metrics(buf, &world_stats->stats);
+
+    if (pipeline_stats) {
+        const ecs_pipeline_stats_t *stats = &pipeline_stats->stats;
+        flecs_pipeline_stats_to_metrics(world, buf, stats,
+            EcsRestSystemTimeSpent, "system.time_spent", "counter",
+            "Time spent processing a system");
+        flecs_pipeline_stats_to_metrics(world, buf, stats,
+            EcsRestSystemInvokeCount, "system.invoke_count", "counter",
+            "Number of times a system was invoked");
+        flecs_pipeline_stats_to_metrics(world, buf, stats,
+            EcsRestSystemMatchedTableCount, "system.matched_table_count", 
+            "gauge", "Tables matched by a system");
+        flecs_pipeline_stats_to_metrics(world, buf, stats,
+            EcsRestSystemMatchedEntityCount, "system.matched_entity_count", 
+            "gauge", "Entities matched by a system");
+    }
+
+    ecs_strbuf_appendlit(buf, "# EOF\n");
+    return true;
+}
 #else
 static
 bool flecs_rest_reply_stats(
@@ -34690,6 +40916,18 @@ bool flecs_rest_reply_stats(
     (void)reply;
     return false;
 }
+
+static
+bool flecs_rest_reply_metrics(
+    ecs_world_t *world,
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    (void)world;
+    (void)req;
+    (void)reply;
+    return false;
+}
 #endif
 
 static
@@ -34782,7 +41020,7 @@ bool flecs_rest_reply(
     void *ctx)
 {
     ecs_rest_ctx_t *impl = ctx;
-    ecs_world_t *world = impl->world;
+    ecs_world_t *world = impl->stage ? impl->stage : impl->world;
 
     if (req->path == NULL) {
         ecs_dbg("rest: bad request (missing path)");
@@ -34800,12 +41038,20 @@ bool flecs_rest_reply(
         
         /* Query endpoint */
         } else if (!ecs_os_strcmp(req->path, "query")) {
-            return flecs_rest_reply_query(world, req, reply);
+            return flecs_rest_reply_query(impl, world, req, reply);
+
+        /* Subscription endpoint */
+        } else if (!ecs_os_strcmp(req->path, "subscribe")) {
+            return flecs_rest_reply_subscribe(impl, req, reply);
 
         /* Stats endpoint */
         } else if (!ecs_os_strncmp(req->path, "stats/", 6)) {
             return flecs_rest_reply_stats(world, req, reply);
 
+        /* Metrics endpoint */
+        } else if (!ecs_os_strcmp(req->path, "metrics")) {
+            return flecs_rest_reply_metrics(world, req, reply);
+
         /* Tables endpoint */
         } else if (!ecs_os_strncmp(req->path, "tables", 6)) {
             return flecs_rest_reply_tables(world, req, reply);
@@ -34818,6 +41064,63 @@ bool flecs_rest_reply(
     return false;
 }
 
+static
+void* flecs_rest_thread(
+    void *arg)
+{
+    ecs_rest_ctx_t *impl = arg;
+    ecs_world_t *world = impl->world;
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+
+    /* Handle requests while the world can be read. Don't hold on to the world
+     * between polls, so the main thread doesn't wait for the REST thread. */
+    while (flecs_reader_begin(world, &impl->reader)) {
+        ecs_ftime_t delta_time = (ecs_ftime_t)ecs_time_measure(&t);
+        ecs_http_server_dequeue(impl->srv, delta_time);
+        flecs_reader_end(world);
+        ecs_os_sleep(0, ECS_REST_POLL_INTERVAL);
+    }
+
+    return NULL;
+}
+
+static
+void flecs_rest_thread_init(
+    ecs_rest_ctx_t *impl)
+{
+    ecs_world_t *world = impl->world;
+    if (!ecs_os_has_threading()) {
+        ecs_warn("rest: threading not available, handling requests on "
+            "main thread");
+        return;
+    }
+
+    /* Requests are handled on an async stage, so iterators don't use the 
+     * allocators of the main thread */
+    impl->stage = ecs_async_stage_new(world);
+    impl->reader = (ecs_reader_t){0};
+    flecs_reader_register(world);
+    impl->thread = ecs_os_thread_new(flecs_rest_thread, impl);
+}
+
+static
+void flecs_rest_thread_fini(
+    ecs_rest_ctx_t *impl)
+{
+    if (!impl->thread) {
+        return;
+    }
+
+    ecs_world_t *world = impl->world;
+    flecs_reader_stop(world, &impl->reader);
+    ecs_os_thread_join(impl->thread);
+    flecs_reader_unregister(world);
+    ecs_async_stage_free(impl->stage);
+    impl->thread = 0;
+    impl->stage = NULL;
+}
+
 static
 void flecs_on_set_rest(ecs_iter_t *it)
 {
@@ -34829,7 +41132,7 @@ void flecs_on_set_rest(ecs_iter_t *it)
             rest[i].port = ECS_REST_DEFAULT_PORT;
         }
 
-        ecs_rest_ctx_t *srv_ctx = ecs_os_malloc_t(ecs_rest_ctx_t);
+        ecs_rest_ctx_t *srv_ctx = ecs_os_calloc_t(ecs_rest_ctx_t);
         ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
             .ipaddr = rest[i].ipaddr,
             .port = rest[i].port,
@@ -34845,10 +41148,21 @@ void flecs_on_set_rest(ecs_iter_t *it)
             continue;
         }
 
-        srv_ctx->world = it->world;
+        srv_ctx->world = (ecs_world_t*)ecs_get_world(it->world);
         srv_ctx->entity = it->entities[i];
         srv_ctx->srv = srv;
         srv_ctx->rc = 1;
+        srv_ctx->stage = NULL;
+        srv_ctx->thread = 0;
+        srv_ctx->sub_lock = ecs_os_mutex_new();
+        srv_ctx->etag_seed = (uintptr_t)srv_ctx;
+        if (ecs_os_has_time()) {
+            srv_ctx->etag_seed ^= ecs_os_now();
+        }
+
+        if (rest[i].threaded) {
+            flecs_rest_thread_init(srv_ctx);
+        }
 
         rest[i].impl = srv_ctx;
 
@@ -34869,12 +41183,26 @@ void DequeueRest(ecs_iter_t *it) {
     int32_t i;
     for(i = 0; i < it->count; i ++) {
         ecs_rest_ctx_t *ctx = rest[i].impl;
-        if (ctx) {
+        if (ctx && !ctx->thread) {
             ecs_http_server_dequeue(ctx->srv, it->delta_time);
         }
     } 
 }
 
+static
+void UpdateRestSubscriptions(ecs_iter_t *it) {
+    EcsRest *rest = ecs_field(it, EcsRest, 1);
+
+    int32_t i;
+    for(i = 0; i < it->count; i ++) {
+        ecs_rest_ctx_t *ctx = rest[i].impl;
+        if (ctx) {
+            flecs_rest_subscriptions_progress(ctx, it->delta_time);
+            flecs_rest_track_tables(ctx);
+        }
+    } 
+}
+
 void FlecsRestImport(
     ecs_world_t *world)
 {
@@ -34893,6 +41221,15 @@ void FlecsRestImport(
     });
 
     ECS_SYSTEM(world, DequeueRest, EcsPostFrame, EcsRest);
+
+    /* Subscriptions create queries and tables are enabled for change tracking,
+     * which requires access to the world */
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, {.name = "UpdateRestSubscriptions", .add = { ecs_dependson(EcsPostFrame) }}),
+        .query.filter.terms = {{ .id = ecs_id(EcsRest) }},
+        .callback = UpdateRestSubscriptions,
+        .no_readonly = true
+    });
 }
 
 #endif
@@ -34956,6 +41293,7 @@ void FlecsCoreDocImport(
     ecs_doc_set_brief(world, EcsExclusive, "Exclusive relationship property");
     ecs_doc_set_brief(world, EcsSymmetric, "Symmetric relationship property");
     ecs_doc_set_brief(world, EcsWith, "With relationship property");
+    ecs_doc_set_brief(world, EcsTargetIndex, "TargetIndex relationship property");
     ecs_doc_set_brief(world, EcsOnDelete, "OnDelete relationship cleanup property");
     ecs_doc_set_brief(world, EcsOnDeleteTarget, "OnDeleteTarget relationship cleanup property");
     ecs_doc_set_brief(world, EcsDefaultChildComponent, "Sets default component hint for children of entity");
@@ -34979,6 +41317,7 @@ void FlecsCoreDocImport(
     ecs_doc_set_link(world, EcsExclusive, URL_ROOT "#exclusive-property");
     ecs_doc_set_link(world, EcsSymmetric, URL_ROOT "#symmetric-property");
     ecs_doc_set_link(world, EcsWith, URL_ROOT "#with-property");
+    ecs_doc_set_link(world, EcsTargetIndex, URL_ROOT "#targetindex-property");
     ecs_doc_set_link(world, EcsOnDelete, URL_ROOT "#cleanup-properties");
     ecs_doc_set_link(world, EcsOnDeleteTarget, URL_ROOT "#cleanup-properties");
     ecs_doc_set_link(world, EcsRemove, URL_ROOT "#cleanup-properties");
@@ -35075,6 +41414,7 @@ void FlecsCoreDocImport(
 #include <ws2tcpip.h>
 #include <windows.h>
 typedef SOCKET ecs_http_socket_t;
+typedef WSABUF ecs_http_iovec_t;
 #else
 #include <unistd.h>
 #include <arpa/inet.h>
@@ -35083,7 +41423,19 @@ typedef SOCKET ecs_http_socket_t;
 #include <netdb.h>
 #include <strings.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/uio.h>
 typedef int ecs_http_socket_t;
+typedef struct iovec ecs_http_iovec_t;
+#endif
+
+/* Use epoll on Linux, poll (WSAPoll on Windows) on other platforms */
+#if defined(ECS_TARGET_LINUX)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#define ECS_HTTP_EPOLL
 #endif
 
 #if !defined(MSG_NOSIGNAL)
@@ -35093,11 +41445,26 @@ typedef int ecs_http_socket_t;
 /* Max length of request method */
 #define ECS_HTTP_METHOD_LEN_MAX (8) 
 
-/* Timeout (s) before connection purge */
+/* Timeout (s) before purging a connection that didn't send a full request */
 #define ECS_HTTP_CONNECTION_PURGE_TIMEOUT (1.0)
 
-/* Number of dequeues before purging */
-#define ECS_HTTP_CONNECTION_PURGE_RETRY_COUNT (5)
+/* Timeout (s) before closing a kept alive connection without requests */
+#define ECS_HTTP_CONNECTION_KEEP_ALIVE_TIMEOUT (10.0)
+
+/* Max number of requests per connection that are waiting for a reply. When
+ * reached, the server stops reading from the connection until replies are
+ * sent. */
+#define ECS_HTTP_PIPELINE_MAX (32)
+
+/* Max time (ms) the server thread waits for socket events */
+#define ECS_HTTP_POLL_TIMEOUT (100)
+
+/* Max number of socket events handled per poll */
+#define ECS_HTTP_POLL_EVENT_COUNT (256)
+
+/* Poll ids for sockets that aren't connections */
+#define ECS_HTTP_POLL_ID_LISTEN (UINT64_MAX)
+#define ECS_HTTP_POLL_ID_WAKE (UINT64_MAX - 1)
 
 /* Minimum interval between dequeueing requests (ms) */
 #define ECS_HTTP_MIN_DEQUEUE_INTERVAL (100)
@@ -35105,32 +41472,46 @@ typedef int ecs_http_socket_t;
 /* Minimum interval between printing statistics (ms) */
 #define ECS_HTTP_MIN_STATS_INTERVAL (10 * 1000)
 
-/* Max length of headers in reply */
-#define ECS_HTTP_REPLY_HEADER_SIZE (1024)
-
 /* Receive buffer size */
 #define ECS_HTTP_SEND_RECV_BUFFER_SIZE (16 * 1024)
 
 /* Max length of request (path + query + headers + body) */
 #define ECS_HTTP_REQUEST_LEN_MAX (10 * 1024 * 1024)
 
-/* Total number of outstanding send requests */
-#define ECS_HTTP_SEND_QUEUE_MAX (256)
+/* Max number of buffers written to a socket with a single call */
+#define ECS_HTTP_IOV_MAX (16)
+
+/* Max number of bytes of a streamed reply that can be queued. When reached,
+ * ecs_http_reply_flush blocks until queued data has been sent. */
+#define ECS_HTTP_STREAM_QUEUE_MAX (4 * ECS_HTTP_CHUNK_SIZE)
+
+/* Timeout (s) before closing a connection that doesn't read replies */
+#define ECS_HTTP_SEND_TIMEOUT (10.0)
 
-/* Send request queue */
+/* Socket events a connection is interested in */
+#define ECS_HTTP_EVENT_READ (1)
+#define ECS_HTTP_EVENT_WRITE (2)
+
+/* Reply that is sent to a connection */
 typedef struct ecs_http_send_request_t {
-    ecs_http_socket_t sock;
+    uint64_t conn_id;
+    char *headers;
+    int32_t header_length;
     char *content;
     int32_t content_length;
+    int32_t written;           /* Bytes written (headers + content) */
+    int32_t stream_size;       /* Bytes that count towards stream queue limit */
+    uint64_t stream_id;        /* Open stream reply belongs to (optional) */
+    bool more;                 /* More chunks follow for the same reply */
 } ecs_http_send_request_t;
 
-typedef struct ecs_http_send_queue_t {
-    ecs_http_send_request_t requests[ECS_HTTP_SEND_QUEUE_MAX];
-    int32_t cur;
-    int32_t count;
-    ecs_os_thread_t thread;
-    int32_t wait_ms;
-} ecs_http_send_queue_t;
+/* Socket event returned by poll */
+typedef struct ecs_http_poll_event_t {
+    uint64_t id;               /* Connection id, or ECS_HTTP_POLL_ID_* */
+    bool read;
+    bool write;
+    bool hangup;
+} ecs_http_poll_event_t;
 
 /* HTTP server struct */
 struct ecs_http_server_t {
@@ -35144,8 +41525,9 @@ struct ecs_http_server_t {
     ecs_http_reply_action_t callback;
     void *ctx;
 
-    ecs_sparse_t *connections; /* sparse<http_connection_t> */
-    ecs_sparse_t *requests; /* sparse<http_request_t> */
+    ecs_sparse_t *connections; /* sparse<http_connection_t> (server thread) */
+    ecs_sparse_t *requests; /* sparse<http_request_t> (protected by lock) */
+    ecs_sparse_t *streams; /* sparse<ecs_http_stream_t> (protected by lock) */
 
     bool initialized;
 
@@ -35159,9 +41541,30 @@ struct ecs_http_server_t {
     ecs_ftime_t request_time_total; /* total time spent on requests */
     int32_t requests_processed; /* requests processed in last stats interval */
     int32_t requests_processed_total; /* total requests processed */
+    int32_t requests_reused; /* requests on reused connections in last stats interval */
+    int32_t requests_reused_total; /* total requests on reused connections */
     int32_t dequeue_count; /* number of dequeues in last stats interval */ 
 
-    ecs_http_send_queue_t send_queue;
+    /* Replies enqueued by the thread that dequeues requests. The server thread
+     * is woken up with the wake socket (eventfd or pipe) when replies are
+     * enqueued, so it doesn't have to poll the queue. */
+    ecs_vector_t *send_queue; /* vector<ecs_http_send_request_t> (lock) */
+    ecs_vector_t *send_queue_swap; /* used by server thread to swap queue */
+    ecs_http_socket_t wake[2];
+
+    uint64_t request_seq; /* used to handle requests in order of arrival */
+
+    /* Set while a thread handles requests. The server waits for handlers to
+     * return before it is stopped, as they reference requests. (lock) */
+    bool dequeueing;
+    ecs_os_cond_t dequeue_cond;
+
+#ifdef ECS_HTTP_EPOLL
+    int epoll_fd;
+#else
+    ecs_vector_t *poll_fds; /* vector<struct pollfd> */
+    ecs_vector_t *poll_ids; /* vector<uint64_t> */
+#endif
 };
 
 /** Fragment state, used by HTTP request parser */
@@ -35198,45 +41601,145 @@ typedef struct {
     char *header_buf_ptr;
     char header_buf[32];
     bool parse_content_length;
+    bool http_1_1;
     bool invalid;
 } ecs_http_fragment_t;
 
+/** Connection state */
+typedef enum {
+    HttpConnStateOpen,        /* Receiving requests and sending replies */
+    HttpConnStateClosing,     /* Close after replies for requests are sent */
+    HttpConnStateClosed       /* Socket closed while requests were processed */
+} HttpConnState;
+
 /** Extend public connection type with fragment data */
 typedef struct {
     ecs_http_connection_t pub;
     ecs_http_socket_t sock;
+    HttpConnState state;
+
+    /* Request that is being received */
+    ecs_http_fragment_t frag;
+
+    /* Replies that are being sent, in the order requests were received */
+    ecs_vector_t *replies; /* vector<ecs_http_send_request_t> */
+
+    /* Requests that are enqueued, but haven't been replied to */
+    int32_t pending;
 
-    /* Connection is purged after both timeout expires and connection has
-     * exceeded retry count. This ensures that a connection does not immediately
-     * timeout when a frame takes longer than usual */
-    ecs_ftime_t dequeue_timeout;
-    int32_t dequeue_retries;    
+    /* Number of requests received on connection */
+    int32_t request_count;
+
+    /* Socket events connection is registered for */
+    int32_t events;
+    bool write_blocked;
+
+    /* Open stream that is sending a reply to the connection */
+    uint64_t stream_id;
+
+    /* Replies to requests pipelined after the request that opened the stream,
+     * which are sent after the stream is closed */
+    ecs_vector_t *deferred; /* vector<ecs_http_send_request_t> */
+
+    /* Flow control for streamed replies. The thread that handles a request 
+     * waits until queued chunks for the connection have been sent. (lock) */
+    ecs_os_cond_t stream_cond;
+    int32_t stream_bytes;
+    bool stream_closed;
+
+    /* Connection is purged when it doesn't send a complete request before 
+     * timeout expires, or when it's idle for longer than keep alive timeout */
+    ecs_ftime_t idle_time;
 } ecs_http_connection_impl_t;
 
 typedef struct {
     ecs_http_request_t pub;
     uint64_t conn_id; /* for sanity check */
+    uint64_t seq; /* order in which requests were received */
+    int32_t reuse_count; /* requests previously received on connection */
+    bool keep_alive;
+    bool http_1_1;
     void *res;
 } ecs_http_request_impl_t;
 
+/** Requests that are being handled by ecs_http_server_dequeue */
+typedef struct {
+    ecs_http_server_t *srv;
+    ecs_http_request_impl_t **requests;
+    ecs_http_send_request_t *replies;
+    int32_t handled; /* requests for which reply has been created */
+    int32_t posted; /* replies that have been posted to the send queue */
+} ecs_http_dequeue_t;
+
+/** Reply that is being created by a request handler */
+typedef struct {
+    ecs_http_dequeue_t *dq;
+    ecs_http_request_impl_t *req;
+    ecs_http_stream_t *open; /* Set by ecs_http_reply_open_stream */
+    bool started; /* Set when first chunk is sent by ecs_http_reply_flush */
+} ecs_http_reply_ctx_t;
+
+/** Reply that remains open after the request handler returns */
+struct ecs_http_stream_t {
+    uint64_t id;
+    ecs_http_server_t *srv;
+    uint64_t conn_id;
+    int32_t queued; /* Bytes that haven't been written yet (lock) */
+    bool started; /* Set when first reply is posted (lock) */
+    bool closed; /* Set when connection is closed (lock) */
+    bool closing; /* Closed before first reply was posted (lock) */
+
+    /* Chunks sent before the first reply was posted (lock) */
+    ecs_vector_t *backlog; /* vector<ecs_http_send_request_t> */
+};
+
 static
-ecs_size_t http_send(
-    ecs_http_socket_t sock, 
-    const void *buf, 
-    ecs_size_t size, 
-    int flags)
+void http_iov_set(
+    ecs_http_iovec_t *iov,
+    char *buf,
+    ecs_size_t size)
 {
     ecs_assert(size >= 0, ECS_INTERNAL_ERROR, NULL);
 #ifdef ECS_TARGET_POSIX
-    ssize_t send_bytes = send(sock, buf, flecs_itosize(size), 
-        flags | MSG_NOSIGNAL);
+    iov->iov_base = buf;
+    iov->iov_len = flecs_itosize(size);
+#else
+    iov->buf = buf;
+    iov->len = (ULONG)size;
+#endif
+}
+
+static
+ecs_size_t http_sendv(
+    ecs_http_socket_t sock,
+    ecs_http_iovec_t *iov,
+    int32_t count)
+{
+#ifdef ECS_TARGET_POSIX
+    struct msghdr msg = {0};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = flecs_itosize(count);
+    ssize_t send_bytes = sendmsg(sock, &msg, MSG_NOSIGNAL);
     return flecs_itoi32(send_bytes);
 #else
-    int send_bytes = send(sock, buf, size, flags);
+    DWORD send_bytes = 0;
+    if (WSASend(sock, iov, (DWORD)count, &send_bytes, 0, NULL, NULL)) {
+        return -1;
+    }
     return flecs_itoi32(send_bytes);
 #endif
 }
 
+static
+bool http_would_block(void) {
+#if defined(ECS_TARGET_WINDOWS)
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    /* An interrupted call is retried on the next socket event */
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
 static
 ecs_size_t http_recv(
     ecs_http_socket_t sock,
@@ -35253,7 +41756,9 @@ ecs_size_t http_recv(
     ret = flecs_itoi32(recv_bytes);
 #endif
     if (ret == -1) {
-        ecs_dbg("recv failed: %s (sock = %d)", ecs_os_strerror(errno), sock);
+        if (!http_would_block()) {
+            ecs_dbg("recv failed: %s (sock = %d)", ecs_os_strerror(errno), sock);
+        }
     } else if (ret == 0) {
         ecs_dbg("recv: received 0 bytes (sock = %d)", sock);
     }
@@ -35262,24 +41767,22 @@ ecs_size_t http_recv(
 }
 
 static
-void http_sock_set_timeout(
-    ecs_http_socket_t sock,
-    int32_t timeout_ms)
+void http_sock_nonblock(
+    ecs_http_socket_t sock)
 {
-    int r;
-#ifdef ECS_TARGET_POSIX
-    struct timeval tv;
-    tv.tv_sec = timeout_ms * 1000;
-    tv.tv_usec = 0;
-    r = setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof tv);
+#if defined(ECS_TARGET_WINDOWS)
+    u_long v = 1;
+    if (ioctlsocket(sock, FIONBIO, &v)) {
+        ecs_warn("http: failed to make socket non-blocking: %d", 
+            WSAGetLastError());
+    }
 #else
-    DWORD t = (DWORD)timeout_ms;
-    r = setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&t, sizeof t);
-#endif
-    if (r) {
-        ecs_warn("http: failed to set socket timeout: %s", 
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (flags == -1 || fcntl(sock, F_SETFL, flags | O_NONBLOCK)) {
+        ecs_warn("http: failed to make socket non-blocking: %s", 
             ecs_os_strerror(errno));
     }
+#endif
 }
 
 static
@@ -35381,19 +41884,104 @@ void http_request_free(ecs_http_request_impl_t *req) {
     flecs_sparse_remove(req->pub.conn->server->requests, req->pub.id);
 }
 
+static
+void http_send_request_free(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    ecs_http_send_request_t *r)
+{
+    if (r->stream_size && conn) {
+        /* Unblock thread that is waiting for chunks to be sent. If the chunk
+         * wasn't sent, the connection was closed and streaming can stop. */
+        ecs_os_mutex_lock(srv->lock);
+        conn->stream_bytes -= r->stream_size;
+        if (r->written != (r->header_length + r->content_length)) {
+            conn->stream_closed = true;
+        }
+        ecs_os_cond_signal(conn->stream_cond);
+        ecs_os_mutex_unlock(srv->lock);
+    }
+    r->stream_size = 0;
+
+    if (r->stream_id) {
+        /* Stream is no longer registered after it is closed */
+        ecs_os_mutex_lock(srv->lock);
+        ecs_http_stream_t *stream = flecs_sparse_get(
+            srv->streams, ecs_http_stream_t, r->stream_id);
+        if (stream) {
+            stream->queued -= r->header_length + r->content_length;
+            if (r->written != (r->header_length + r->content_length)) {
+                stream->closed = true;
+            }
+        }
+        ecs_os_mutex_unlock(srv->lock);
+        r->stream_id = 0;
+    }
+
+    ecs_os_free(r->headers);
+    ecs_os_free(r->content);
+    r->headers = NULL;
+    r->content = NULL;
+}
+
+static
+void http_replies_free(ecs_http_connection_impl_t *conn) {
+    int32_t i, count = ecs_vector_count(conn->replies);
+    ecs_http_send_request_t *replies = ecs_vector_first(
+        conn->replies, ecs_http_send_request_t);
+    for (i = 0; i < count; i ++) {
+        http_send_request_free(conn->pub.server, conn, &replies[i]);
+    }
+    ecs_vector_free(conn->replies);
+    conn->replies = NULL;
+
+    /* Deferred replies haven't been counted as replied to yet */
+    count = ecs_vector_count(conn->deferred);
+    replies = ecs_vector_first(conn->deferred, ecs_http_send_request_t);
+    for (i = 0; i < count; i ++) {
+        if (!replies[i].more) {
+            conn->pending --;
+        }
+        http_send_request_free(conn->pub.server, conn, &replies[i]);
+    }
+    ecs_vector_free(conn->deferred);
+    conn->deferred = NULL;
+}
+
 static
 void http_connection_free(ecs_http_connection_impl_t *conn) {
     ecs_assert(conn != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(conn->pub.id != 0, ECS_INTERNAL_ERROR, NULL);
     uint64_t conn_id = conn->pub.id;
 
+    /* Closing the socket also removes it from the poll set */
     if (http_socket_is_valid(conn->sock)) {
         http_close(&conn->sock);
     }
 
+    ecs_strbuf_reset(&conn->frag.buf);
+    http_replies_free(conn);
+    ecs_os_cond_free(conn->stream_cond);
+
     flecs_sparse_remove(conn->pub.server->connections, conn_id);
 }
 
+static
+void http_stream_free(
+    ecs_http_stream_t *stream)
+{
+    ecs_http_server_t *srv = stream->srv;
+    int32_t i, count = ecs_vector_count(stream->backlog);
+    ecs_http_send_request_t *chunks = ecs_vector_first(
+        stream->backlog, ecs_http_send_request_t);
+    for (i = 0; i < count; i ++) {
+        ecs_os_free(chunks[i].headers);
+        ecs_os_free(chunks[i].content);
+    }
+    ecs_vector_free(stream->backlog);
+    flecs_sparse_remove(srv->streams, stream->id);
+}
+
 // https://stackoverflow.com/questions/10156409/convert-hex-string-char-to-int
 static
 char http_hex_2_int(char a, char b){
@@ -35463,67 +42051,101 @@ void http_header_buf_append(
         frag->header_buf_ptr[0] = ch;
         frag->header_buf_ptr ++;
     } else {
-        frag->header_buf_ptr[0] = '\0';
+        frag->header_buf[ECS_SIZEOF(frag->header_buf) - 1] = '\0';
     }
 }
 
+
 static
-void http_enqueue_request(
+bool http_header_value_is(
+    const char *value,
+    const char *expect)
+{
+    /* Header values like "keep-alive" and "close" are case insensitive */
+    for (; *value && *expect; value ++, expect ++) {
+        char ch = *value;
+        if (ch >= 'A' && ch <= 'Z') {
+            ch = (char)(ch - 'A' + 'a');
+        }
+        if (ch != *expect) {
+            return false;
+        }
+    }
+    return !*value && !*expect;
+}
+
+static
+bool http_enqueue_request(
     ecs_http_connection_impl_t *conn,
-    uint64_t conn_id,
     ecs_http_fragment_t *frag)
 {
     ecs_http_server_t *srv = conn->pub.server;
+    char *res = ecs_strbuf_get(&frag->buf);
+    if (!res) {
+        return false;
+    }
 
     ecs_os_mutex_lock(srv->lock);
-    bool is_alive = conn->pub.id == conn_id;
-
-    if (!is_alive || frag->invalid) { 
-        /* Don't enqueue invalid requests or requests for purged connections */
-        ecs_strbuf_reset(&frag->buf);
-    } else {
-        char *res = ecs_strbuf_get(&frag->buf);
-        if (res) {
-            ecs_http_request_impl_t *req = flecs_sparse_add(
-                srv->requests, ecs_http_request_impl_t);
-            req->pub.id = flecs_sparse_last_id(srv->requests);
-            req->conn_id = conn->pub.id;
-
-            req->pub.conn = (ecs_http_connection_t*)conn;
-            req->pub.method = frag->method;
-            req->pub.path = res + 1;
-            if (frag->body_offset) {
-                req->pub.body = &res[frag->body_offset];
-            }
-            int32_t i, count = frag->header_count;
-            for (i = 0; i < count; i ++) {
-                req->pub.headers[i].key = &res[frag->header_offsets[i]];
-                req->pub.headers[i].value = &res[frag->header_value_offsets[i]];
-            }
-            count = frag->param_count;
-            for (i = 0; i < count; i ++) {
-                req->pub.params[i].key = &res[frag->param_offsets[i]];
-                req->pub.params[i].value = &res[frag->param_value_offsets[i]];
-                http_decode_url_str((char*)req->pub.params[i].value);
-            }
+    ecs_http_request_impl_t *req = flecs_sparse_add(
+        srv->requests, ecs_http_request_impl_t);
+    req->pub.id = flecs_sparse_last_id(srv->requests);
+    req->conn_id = conn->pub.id;
+
+    req->pub.conn = (ecs_http_connection_t*)conn;
+    req->pub.method = frag->method;
+    req->pub.path = res + 1;
+    req->pub.body = NULL;
+    if (frag->body_offset) {
+        req->pub.body = &res[frag->body_offset];
+    }
+    int32_t i, count = frag->header_count;
+    for (i = 0; i < count; i ++) {
+        req->pub.headers[i].key = &res[frag->header_offsets[i]];
+        req->pub.headers[i].value = &res[frag->header_value_offsets[i]];
+    }
+    count = frag->param_count;
+    for (i = 0; i < count; i ++) {
+        req->pub.params[i].key = &res[frag->param_offsets[i]];
+        req->pub.params[i].value = &res[frag->param_value_offsets[i]];
+        http_decode_url_str((char*)req->pub.params[i].value);
+    }
+
+    req->pub.header_count = frag->header_count;
+    req->pub.param_count = frag->param_count;
+    req->res = res;
 
-            req->pub.header_count = frag->header_count;
-            req->pub.param_count = frag->param_count;
-            req->res = res;
+    /* HTTP/1.1 connections are kept alive unless the client closes them */
+    bool keep_alive = frag->http_1_1;
+    const char *connection = ecs_http_get_header(&req->pub, "Connection");
+    if (connection) {
+        if (http_header_value_is(connection, "close")) {
+            keep_alive = false;
+        } else if (http_header_value_is(connection, "keep-alive")) {
+            keep_alive = true;
         }
     }
 
+    req->keep_alive = keep_alive;
+    req->http_1_1 = frag->http_1_1;
+    req->reuse_count = conn->request_count;
+    req->seq = srv->request_seq ++;
     ecs_os_mutex_unlock(srv->lock);
+
+    conn->pending ++;
+    conn->request_count ++;
+
+    return keep_alive;
 }
 
 static
 bool http_parse_request(
     ecs_http_fragment_t *frag,
     const char* req_frag, 
-    ecs_size_t req_frag_len) 
+    ecs_size_t req_frag_len,
+    ecs_size_t *consumed) 
 {
     int32_t i;
-    for (i = 0; i < req_frag_len; i++) {
+    for (i = 0; i < req_frag_len && frag->state != HttpFragStateDone; i++) {
         char c = req_frag[i];
         switch (frag->state) {
         case HttpFragStateBegin:
@@ -35562,8 +42184,12 @@ bool http_parse_request(
             break;
         case HttpFragStateVersion:
             if (c == '\r') {
+                http_header_buf_append(frag, '\0');
+                frag->http_1_1 = !ecs_os_strcmp(frag->header_buf, "HTTP/1.1");
                 frag->state = HttpFragStateCR;
-            } /* version is not stored */
+            } else {
+                http_header_buf_append(frag, c);
+            }
             break;
         case HttpFragStateHeaderStart:
             if (http_header_writable(frag)) {
@@ -35673,6 +42299,9 @@ bool http_parse_request(
         }
     }
 
+    /* Remaining data belongs to the next (pipelined) request */
+    *consumed = i;
+
     if (frag->state == HttpFragStateDone) {
         return true;
     } else {
@@ -35681,190 +42310,548 @@ bool http_parse_request(
 }
 
 static
-ecs_http_send_request_t* http_send_queue_post(
-    ecs_http_server_t *srv)
+void http_append_send_headers(
+    ecs_strbuf_t *hdrs,
+    int code, 
+    const char* status, 
+    const char* content_type,  
+    ecs_strbuf_t *extra_headers,
+    ecs_size_t content_len,
+    bool keep_alive) 
 {
-    /* This function should only be called while the server is locked. Before 
-     * the lock is released, the returned element should be populated. */
-    ecs_http_send_queue_t *sq = &srv->send_queue;
-    ecs_assert(sq->count <= ECS_HTTP_SEND_QUEUE_MAX, ECS_INTERNAL_ERROR, NULL);
-    if (sq->count == ECS_HTTP_SEND_QUEUE_MAX) {
-        return NULL;
+    ecs_strbuf_appendlit(hdrs, "HTTP/1.1 ");
+    ecs_strbuf_appendint(hdrs, code);
+    ecs_strbuf_appendch(hdrs, ' ');
+    ecs_strbuf_appendstr(hdrs, status);
+    ecs_strbuf_appendlit(hdrs, "\r\n");
+
+    ecs_strbuf_appendlit(hdrs, "Content-Type: ");
+    ecs_strbuf_appendstr(hdrs, content_type);
+    ecs_strbuf_appendlit(hdrs, "\r\n");
+
+    if (content_len >= 0) {
+        ecs_strbuf_appendlit(hdrs, "Content-Length: ");
+        ecs_strbuf_append(hdrs, "%d", content_len);
+        ecs_strbuf_appendlit(hdrs, "\r\n");
+    } else {
+        /* Length of streamed reply is not known in advance */
+        ecs_strbuf_appendlit(hdrs, "Transfer-Encoding: chunked\r\n");
     }
 
-    /* Don't enqueue new requests if server is shutting down */
-    if (!srv->should_run) {
-        return NULL;
+    if (keep_alive) {
+        ecs_strbuf_appendlit(hdrs, "Connection: keep-alive\r\n");
+    } else {
+        ecs_strbuf_appendlit(hdrs, "Connection: close\r\n");
     }
 
-    /* Return element at end of the queue */
-    return &sq->requests[(sq->cur + sq->count ++) % ECS_HTTP_SEND_QUEUE_MAX];
+    ecs_strbuf_appendlit(hdrs, "Server: flecs\r\n");
+
+    ecs_strbuf_mergebuff(hdrs, extra_headers);
+
+    ecs_strbuf_appendlit(hdrs, "\r\n");
 }
 
 static
-ecs_http_send_request_t* http_send_queue_get(
+int http_poll_init(
     ecs_http_server_t *srv)
 {
-    ecs_http_send_request_t *result = NULL;
-    ecs_os_mutex_lock(srv->lock);
-    ecs_http_send_queue_t *sq = &srv->send_queue;
-    if (sq->count) {
-        result = &sq->requests[sq->cur];
-        sq->cur = (sq->cur + 1) % ECS_HTTP_SEND_QUEUE_MAX;
-        sq->count --;
+    srv->wake[0] = srv->wake[1] = HTTP_SOCKET_INVALID;
+
+#if defined(ECS_HTTP_EPOLL)
+    srv->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (srv->epoll_fd == -1) {
+        ecs_err("http: failed to create epoll instance: %s", 
+            ecs_os_strerror(errno));
+        return -1;
     }
-    return result;
+
+    /* Wake up server thread with eventfd when replies are enqueued */
+    srv->wake[0] = srv->wake[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (srv->wake[0] == -1) {
+        ecs_err("http: failed to create eventfd: %s", ecs_os_strerror(errno));
+        return -1;
+    }
+
+    struct epoll_event ev = { .events = EPOLLIN };
+    ev.data.u64 = ECS_HTTP_POLL_ID_WAKE;
+    if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, srv->wake[0], &ev)) {
+        ecs_err("http: failed to add eventfd to epoll: %s", 
+            ecs_os_strerror(errno));
+        return -1;
+    }
+#elif !defined(ECS_TARGET_WINDOWS)
+    /* Wake up server thread with pipe when replies are enqueued */
+    if (pipe(srv->wake)) {
+        ecs_err("http: failed to create pipe: %s", ecs_os_strerror(errno));
+        srv->wake[0] = srv->wake[1] = HTTP_SOCKET_INVALID;
+        return -1;
+    }
+    http_sock_nonblock(srv->wake[0]);
+    http_sock_nonblock(srv->wake[1]);
+#else
+    /* No eventfd or pipe that works with WSAPoll. The server thread picks up
+     * enqueued replies when the poll times out. */
+#endif
+
+    return 0;
 }
 
 static
-void* http_server_send_queue(void* arg) {
-    ecs_http_server_t *srv = arg;
-    int32_t wait_ms = srv->send_queue.wait_ms;
+void http_poll_fini(
+    ecs_http_server_t *srv)
+{
+#if defined(ECS_HTTP_EPOLL)
+    if (srv->epoll_fd != -1) {
+        close(srv->epoll_fd);
+    }
+    if (http_socket_is_valid(srv->wake[0])) {
+        close(srv->wake[0]);
+    }
+#elif !defined(ECS_TARGET_WINDOWS)
+    if (http_socket_is_valid(srv->wake[0])) {
+        close(srv->wake[0]);
+        close(srv->wake[1]);
+    }
+#endif
+#if !defined(ECS_HTTP_EPOLL)
+    ecs_vector_free(srv->poll_fds);
+    ecs_vector_free(srv->poll_ids);
+#endif
+}
 
-    /* Run for as long as the server is running or there are messages. When the
-     * server is stopping, no new messages will be enqueued */
-    while (srv->should_run || srv->send_queue.count) {
-        ecs_http_send_request_t* r = http_send_queue_get(srv);
-        if (!r) {
-            ecs_os_mutex_unlock(srv->lock);
-            /* If the queue is empty, wait so we don't run too fast */
-            if (srv->should_run) {
-                ecs_os_sleep(0, wait_ms);
-            }
-        } else {
-            ecs_size_t written = http_send(
-                r->sock, r->content, r->content_length, 0);
-            if (written != r->content_length) {
-                ecs_err("http: failed to write HTTP response body: %s",
-                    ecs_os_strerror(errno));
-            }
-            ecs_os_free(r->content);
-            if (http_socket_is_valid(r->sock)) {
-                http_close(&r->sock);
-            }
-            ecs_os_mutex_unlock(srv->lock);
-        }
+#if defined(ECS_HTTP_EPOLL)
+static
+uint32_t http_epoll_events(
+    int32_t events)
+{
+    uint32_t result = 0;
+    if (events & ECS_HTTP_EVENT_READ) {
+        result |= EPOLLIN;
     }
-    return NULL;
+    if (events & ECS_HTTP_EVENT_WRITE) {
+        result |= EPOLLOUT;
+    }
+    return result;
 }
+#endif
 
 static
-void http_append_send_headers(
-    ecs_strbuf_t *hdrs,
-    int code, 
-    const char* status, 
-    const char* content_type,  
-    ecs_strbuf_t *extra_headers,
-    ecs_size_t content_len) 
+void http_poll_add(
+    ecs_http_server_t *srv,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
 {
-    ecs_strbuf_appendlit(hdrs, "HTTP/1.1 ");
-    ecs_strbuf_appendint(hdrs, code);
-    ecs_strbuf_appendch(hdrs, ' ');
-    ecs_strbuf_appendstr(hdrs, status);
-    ecs_strbuf_appendlit(hdrs, "\r\n");
+#if defined(ECS_HTTP_EPOLL)
+    struct epoll_event ev = { .events = http_epoll_events(events) };
+    ev.data.u64 = id;
+    if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, sock, &ev)) {
+        ecs_err("http: failed to add socket to epoll: %s", 
+            ecs_os_strerror(errno));
+    }
+#else
+    /* Poll set is rebuilt every iteration */
+    (void)srv;
+    (void)sock;
+    (void)id;
+    (void)events;
+#endif
+}
 
-    ecs_strbuf_appendlit(hdrs, "Content-Type: ");
-    ecs_strbuf_appendstr(hdrs, content_type);
-    ecs_strbuf_appendlit(hdrs, "\r\n");
+static
+void http_conn_set_events(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    int32_t events)
+{
+    if (conn->events == events) {
+        return;
+    }
 
-    ecs_strbuf_appendlit(hdrs, "Content-Length: ");
-    ecs_strbuf_append(hdrs, "%d", content_len);
-    ecs_strbuf_appendlit(hdrs, "\r\n");
+#if defined(ECS_HTTP_EPOLL)
+    struct epoll_event ev = { .events = http_epoll_events(events) };
+    ev.data.u64 = conn->pub.id;
+    if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_MOD, conn->sock, &ev)) {
+        ecs_err("http: failed to modify socket events: %s", 
+            ecs_os_strerror(errno));
+    }
+#else
+    (void)srv;
+#endif
 
-    ecs_strbuf_appendlit(hdrs, "Server: flecs\r\n");
+    conn->events = events;
+}
 
-    ecs_strbuf_mergebuff(hdrs, extra_headers);
+#if !defined(ECS_HTTP_EPOLL)
+static
+void http_poll_fd_add(
+    ecs_http_server_t *srv,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    struct pollfd *fd = ecs_vector_add(&srv->poll_fds, struct pollfd);
+    fd->fd = sock;
+    fd->events = 0;
+    fd->revents = 0;
+    if (events & ECS_HTTP_EVENT_READ) {
+        fd->events |= POLLIN;
+    }
+    if (events & ECS_HTTP_EVENT_WRITE) {
+        fd->events |= POLLOUT;
+    }
 
-    ecs_strbuf_appendlit(hdrs, "\r\n");
+    uint64_t *fd_id = ecs_vector_add(&srv->poll_ids, uint64_t);
+    *fd_id = id;
 }
+#endif
 
 static
-void http_send_reply(
-    ecs_http_connection_impl_t* conn, 
-    ecs_http_reply_t* reply) 
+int32_t http_poll_wait(
+    ecs_http_server_t *srv,
+    ecs_http_poll_event_t *events)
 {
-    char hdrs[ECS_HTTP_REPLY_HEADER_SIZE];
-    ecs_strbuf_t hdr_buf = ECS_STRBUF_INIT;
-    hdr_buf.buf = hdrs;
-    hdr_buf.max = ECS_HTTP_REPLY_HEADER_SIZE;
-    hdr_buf.buf = hdrs;
+    int32_t i, count = 0;
+
+#if defined(ECS_HTTP_EPOLL)
+    struct epoll_event evs[ECS_HTTP_POLL_EVENT_COUNT];
+    int result = epoll_wait(srv->epoll_fd, evs, ECS_HTTP_POLL_EVENT_COUNT, 
+        ECS_HTTP_POLL_TIMEOUT);
+    if (result == -1) {
+        if (errno != EINTR) {
+            ecs_err("http: epoll_wait failed: %s", ecs_os_strerror(errno));
+        }
+        return 0;
+    }
+
+    for (i = 0; i < result; i ++) {
+        ecs_http_poll_event_t *ev = &events[count ++];
+        ev->id = evs[i].data.u64;
+        ev->read = (evs[i].events & EPOLLIN) != 0;
+        ev->write = (evs[i].events & EPOLLOUT) != 0;
+        ev->hangup = (evs[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+    }
+#else
+    ecs_vector_clear(srv->poll_fds);
+    ecs_vector_clear(srv->poll_ids);
+
+    if (http_socket_is_valid(srv->sock)) {
+        http_poll_fd_add(srv, srv->sock, 
+            ECS_HTTP_POLL_ID_LISTEN, ECS_HTTP_EVENT_READ);
+    }
+    if (http_socket_is_valid(srv->wake[0])) {
+        http_poll_fd_add(srv, srv->wake[0], 
+            ECS_HTTP_POLL_ID_WAKE, ECS_HTTP_EVENT_READ);
+    }
 
-    char *content = ecs_strbuf_get(&reply->body);
-    int32_t content_length = reply->body.length - 1;
+    int32_t conn_count = flecs_sparse_count(srv->connections);
+    for (i = 1; i < conn_count; i ++) {
+        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense(
+            srv->connections, ecs_http_connection_impl_t, i);
+        if (conn->events) {
+            http_poll_fd_add(srv, conn->sock, conn->pub.id, conn->events);
+        }
+    }
 
-    /* Use asynchronous send queue for outgoing data so send operations won't
-     * hold up main thread */
-    ecs_http_send_request_t *req = NULL;
-    if (content_length > 0) {
-        req = http_send_queue_post(conn->pub.server);
-        if (!req) {
-            reply->code = 503; /* queue full, server is busy */
+    struct pollfd *fds = ecs_vector_first(srv->poll_fds, struct pollfd);
+    uint64_t *ids = ecs_vector_first(srv->poll_ids, uint64_t);
+    int32_t fd_count = ecs_vector_count(srv->poll_fds);
+#if defined(ECS_TARGET_WINDOWS)
+    int result = WSAPoll(fds, (ULONG)fd_count, ECS_HTTP_POLL_TIMEOUT);
+#else
+    int result = poll(fds, (nfds_t)fd_count, ECS_HTTP_POLL_TIMEOUT);
+#endif
+    if (result == -1) {
+        if (errno != EINTR) {
+            ecs_err("http: poll failed: %s", ecs_os_strerror(errno));
         }
+        return 0;
     }
 
-    /* First, send the response HTTP headers */
-    http_append_send_headers(&hdr_buf, reply->code, reply->status, 
-        reply->content_type, &reply->headers, content_length);
+    for (i = 0; i < fd_count && count < ECS_HTTP_POLL_EVENT_COUNT; i ++) {
+        short revents = fds[i].revents;
+        if (!revents) {
+            continue;
+        }
 
-    ecs_size_t hdrs_len = ecs_strbuf_written(&hdr_buf);
-    hdrs[hdrs_len] = '\0';
-    ecs_size_t written = http_send(conn->sock, hdrs, hdrs_len, 0);
+        ecs_http_poll_event_t *ev = &events[count ++];
+        ev->id = ids[i];
+        ev->read = (revents & POLLIN) != 0;
+        ev->write = (revents & POLLOUT) != 0;
+        ev->hangup = (revents & (POLLHUP | POLLERR | POLLNVAL)) != 0;
+    }
+#endif
 
-    if (written != hdrs_len) {
-        ecs_err("http: failed to write HTTP response headers to '%s:%s': %s",
-            conn->pub.host, conn->pub.port, ecs_os_strerror(errno));
-        return;
+    return count;
+}
+
+static
+void http_wake(
+    ecs_http_server_t *srv)
+{
+#if defined(ECS_HTTP_EPOLL)
+    uint64_t v = 1;
+    ssize_t r = write(srv->wake[1], &v, sizeof(v));
+    (void)r;
+#elif !defined(ECS_TARGET_WINDOWS)
+    char ch = 0;
+    ssize_t r = write(srv->wake[1], &ch, 1);
+    (void)r;
+#else
+    (void)srv;
+#endif
+}
+
+static
+void http_wake_drain(
+    ecs_http_server_t *srv)
+{
+#if defined(ECS_HTTP_EPOLL)
+    uint64_t v;
+    ssize_t r = read(srv->wake[0], &v, sizeof(v));
+    (void)r;
+#elif !defined(ECS_TARGET_WINDOWS)
+    char buf[64];
+    while (read(srv->wake[0], buf, sizeof(buf)) > 0) { }
+#else
+    (void)srv;
+#endif
+}
+
+static
+void http_conn_update_events(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    int32_t events = 0;
+    if (conn->state == HttpConnStateOpen && 
+        conn->pending < ECS_HTTP_PIPELINE_MAX) 
+    {
+        events |= ECS_HTTP_EVENT_READ;
+    }
+    if (conn->write_blocked) {
+        events |= ECS_HTTP_EVENT_WRITE;
     }
+    http_conn_set_events(srv, conn, events);
+}
 
-    /* Second, enqueue send request for response body */
-    if (req) {
-        req->sock = conn->sock;
-        req->content = content;
-        req->content_length = content_length;
+static
+void http_conn_close(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    (void)srv;
+    ecs_dbg_2("http: closing connection '%s:%s'", 
+        conn->pub.host, conn->pub.port);
+
+    http_replies_free(conn);
 
-        /* Take ownership of values */
-        reply->body.content = NULL;
-        conn->sock = HTTP_SOCKET_INVALID;
+    if (conn->pending) {
+        /* Requests that are being processed reference the connection, so it
+         * can't be freed yet. The connection is freed when the last reply for
+         * its requests arrives. */
+        http_close(&conn->sock);
+        ecs_strbuf_reset(&conn->frag.buf);
+        conn->events = 0;
+        conn->write_blocked = false;
+        conn->state = HttpConnStateClosed;
+    } else {
+        http_connection_free(conn);
     }
 }
 
 static
-void http_recv_request(
+void http_conn_recv(
     ecs_http_server_t *srv,
-    ecs_http_connection_impl_t *conn, 
-    uint64_t conn_id,
-    ecs_http_socket_t sock)
+    ecs_http_connection_impl_t *conn)
 {
-    ecs_size_t bytes_read;
+    ecs_size_t bytes_read = 1;
     char recv_buf[ECS_HTTP_SEND_RECV_BUFFER_SIZE];
-    ecs_http_fragment_t frag = {0};
 
-    while ((bytes_read = http_recv(
-        sock, recv_buf, ECS_SIZEOF(recv_buf), 0)) > 0) 
+    /* Stop reading when too many requests are waiting for a reply. Remaining
+     * requests stay in the socket buffer until replies have been sent. */
+    while (conn->state == HttpConnStateOpen && 
+        conn->pending < ECS_HTTP_PIPELINE_MAX) 
     {
-        bool is_alive = conn->pub.id == conn_id;
-        if (!is_alive) {
-            /* Connection has been purged by main thread */
-            return;
+        bytes_read = http_recv(
+            conn->sock, recv_buf, ECS_SIZEOF(recv_buf), 0);
+        if (bytes_read <= 0) {
+            break;
+        }
+
+        conn->idle_time = 0;
+
+        /* Buffer can contain multiple (pipelined) requests */
+        ecs_size_t offset = 0, consumed;
+        while (offset < bytes_read && conn->state == HttpConnStateOpen) {
+            if (!http_parse_request(&conn->frag, &recv_buf[offset], 
+                bytes_read - offset, &consumed))
+            {
+                break;
+            }
+
+            offset += consumed;
+
+            if (conn->frag.invalid) {
+                /* Don't enqueue invalid requests */
+                http_conn_close(srv, conn);
+                return;
+            }
+
+            ecs_dbg_2("http: request received from '%s:%s'", 
+                conn->pub.host, conn->pub.port);
+
+            if (!http_enqueue_request(conn, &conn->frag)) {
+                /* Don't read new requests if connection isn't kept alive */
+                conn->state = HttpConnStateClosing;
+            }
+
+            conn->frag.state = HttpFragStateBegin;
         }
+    }
 
-        if (http_parse_request(&frag, recv_buf, bytes_read)) {
-            http_enqueue_request(conn, conn_id, &frag);
+    if (bytes_read == 0) {
+        /* Connection closed by peer. Send replies for requests that were 
+         * already received before closing the socket. */
+        if (conn->pending || ecs_vector_count(conn->replies)) {
+            conn->state = HttpConnStateClosing;
+        } else {
+            http_conn_close(srv, conn);
             return;
         }
+    } else if (bytes_read < 0 && !http_would_block()) {
+        http_conn_close(srv, conn);
+        return;
     }
 
-    /* Partial request received, cleanup resources */
-    ecs_strbuf_reset(&frag.buf);
+    http_conn_update_events(srv, conn);
+}
 
-    /* No request was enqueued, flag connection so it'll get purged */
-    ecs_os_mutex_lock(srv->lock);
-    if (conn->pub.id == conn_id) {
-        /* Only flag connection if it was still alive */
-        conn->dequeue_timeout = ECS_HTTP_CONNECTION_PURGE_TIMEOUT;
-        conn->dequeue_retries = ECS_HTTP_CONNECTION_PURGE_RETRY_COUNT;
+static
+void http_conn_flush(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    ecs_http_iovec_t iov[ECS_HTTP_IOV_MAX];
+    int32_t i, count;
+
+    while ((count = ecs_vector_count(conn->replies))) {
+        ecs_http_send_request_t *replies = ecs_vector_first(
+            conn->replies, ecs_http_send_request_t);
+
+        /* Gather queued replies & chunks so they're sent with a single call */
+        int32_t iov_count = 0;
+        for (i = 0; i < count && iov_count < (ECS_HTTP_IOV_MAX - 1); i ++) {
+            ecs_http_send_request_t *r = &replies[i];
+            ecs_size_t offset = r->written - r->header_length;
+            if (offset < 0) {
+                http_iov_set(&iov[iov_count ++], &r->headers[r->written], 
+                    -offset);
+                offset = 0;
+            }
+            if (offset < r->content_length) {
+                http_iov_set(&iov[iov_count ++], &r->content[offset], 
+                    r->content_length - offset);
+            }
+        }
+
+        ecs_size_t written = 0;
+        if (iov_count) {
+            written = http_sendv(conn->sock, iov, iov_count);
+            if (written < 0) {
+                if (http_would_block()) {
+                    /* Socket buffer is full, continue when socket is 
+                     * writable */
+                    conn->write_blocked = true;
+                    http_conn_update_events(srv, conn);
+                    return;
+                }
+
+                if (errno == EPIPE || errno == ECONNRESET) {
+                    /* Client closed connection before reply was sent */
+                    ecs_dbg_2("http: connection '%s:%s' closed by client",
+                        conn->pub.host, conn->pub.port);
+                } else {
+                    ecs_err("http: failed to write HTTP response to '%s:%s': %s",
+                        conn->pub.host, conn->pub.port, ecs_os_strerror(errno));
+                }
+                http_conn_close(srv, conn);
+                return;
+            }
+
+            conn->idle_time = 0;
+        }
+
+        /* Replies must be sent in order, remove sent replies from the front of
+         * the queue */
+        int32_t sent = 0;
+        for (i = 0; i < count; i ++) {
+            ecs_http_send_request_t *r = &replies[i];
+            ecs_size_t remaining = 
+                r->header_length + r->content_length - r->written;
+            if (remaining > written) {
+                r->written += written;
+                break;
+            }
+
+            r->written += remaining;
+            written -= remaining;
+
+            if (!r->more) {
+                ecs_dbg_2("http: reply sent to '%s:%s'", 
+                    conn->pub.host, conn->pub.port);
+            }
+
+            http_send_request_free(srv, conn, r);
+            sent ++;
+        }
+
+        if (sent) {
+            ecs_os_memmove(replies, &replies[sent], 
+                ECS_SIZEOF(ecs_http_send_request_t) * (count - sent));
+            ecs_vector_set_count(&conn->replies, ecs_http_send_request_t, 
+                count - sent);
+        }
+    }
+
+    conn->write_blocked = false;
+
+    if (conn->state == HttpConnStateClosing && !conn->pending) {
+        http_conn_close(srv, conn);
+        return;
+    }
+
+    http_conn_update_events(srv, conn);
+}
+
+static
+void http_conn_event(
+    ecs_http_server_t *srv,
+    const ecs_http_poll_event_t *ev)
+{
+    /* Connection may have been closed by a previous event */
+    ecs_http_connection_impl_t *conn = flecs_sparse_get(
+        srv->connections, ecs_http_connection_impl_t, ev->id);
+    if (!conn || conn->state == HttpConnStateClosed) {
+        return;
+    }
+
+    if (ev->read || ev->hangup) {
+        if (conn->events & ECS_HTTP_EVENT_READ) {
+            http_conn_recv(srv, conn);
+        } else if (ev->hangup) {
+            http_conn_close(srv, conn);
+            return;
+        }
+    }
+
+    if (ev->write) {
+        conn = flecs_sparse_get(
+            srv->connections, ecs_http_connection_impl_t, ev->id);
+        if (conn && conn->state != HttpConnStateClosed && conn->write_blocked) {
+            http_conn_flush(srv, conn);
+        }
     }
-    ecs_os_mutex_unlock(srv->lock);
 }
 
 static
@@ -35874,17 +42861,18 @@ void http_init_connection(
     struct sockaddr_storage *remote_addr, 
     ecs_size_t remote_addr_len) 
 {
-    http_sock_set_timeout(sock_conn, 100);
+    http_sock_nonblock(sock_conn);
     http_sock_keep_alive(sock_conn);
 
     /* Create new connection */
-    ecs_os_mutex_lock(srv->lock);
     ecs_http_connection_impl_t *conn = flecs_sparse_add(
         srv->connections, ecs_http_connection_impl_t);
-    uint64_t conn_id = conn->pub.id = flecs_sparse_last_id(srv->connections);
+    ecs_os_memset_t(conn, 0, ecs_http_connection_impl_t);
+    conn->pub.id = flecs_sparse_last_id(srv->connections);
     conn->pub.server = srv;
     conn->sock = sock_conn;
-    ecs_os_mutex_unlock(srv->lock);
+    conn->state = HttpConnStateOpen;
+    conn->stream_cond = ecs_os_cond_new();
 
     char *remote_host = conn->pub.host;
     char *remote_port = conn->pub.port;
@@ -35902,14 +42890,183 @@ void http_init_connection(
     ecs_dbg_2("http: connection established from '%s:%s'", 
         remote_host, remote_port);
 
-    http_recv_request(srv, conn, conn_id, sock_conn);
-
-    ecs_dbg_2("http: request received from '%s:%s'", 
-        remote_host, remote_port);
+    http_poll_add(srv, sock_conn, conn->pub.id, ECS_HTTP_EVENT_READ);
+    conn->events = ECS_HTTP_EVENT_READ;
 }
 
 static
 void http_accept_connections(
+    ecs_http_server_t* srv)
+{
+    ecs_http_socket_t sock_conn;
+    struct sockaddr_storage remote_addr;
+    ecs_size_t remote_addr_len;
+
+    /* Accept until there are no more pending connections */
+    while (srv->should_run) {
+        remote_addr_len = ECS_SIZEOF(remote_addr);
+        sock_conn = http_accept(srv->sock, (struct sockaddr*) &remote_addr, 
+            &remote_addr_len);
+
+        if (!http_socket_is_valid(sock_conn)) {
+            if (!http_would_block()) {
+                ecs_dbg("http: connection attempt failed: %s", 
+                    ecs_os_strerror(errno));
+            }
+            break;
+        }
+
+        http_init_connection(srv, sock_conn, &remote_addr, remote_addr_len);
+    }
+}
+
+/* Add reply to the replies that are sent to a connection. Replies to requests
+ * that were pipelined after a request that opened a stream can't be sent in
+ * between the chunks of the stream, and are deferred until it is closed. */
+static
+void http_conn_add_reply(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    ecs_http_send_request_t *r)
+{
+    if (conn->stream_id && r->stream_id != conn->stream_id) {
+        if (r->stream_size) {
+            /* Don't block the thread that is flushing the reply while it is
+             * deferred, as the stream may be closed by the same thread */
+            ecs_os_mutex_lock(srv->lock);
+            conn->stream_bytes -= r->stream_size;
+            ecs_os_cond_signal(conn->stream_cond);
+            ecs_os_mutex_unlock(srv->lock);
+            r->stream_size = 0;
+        }
+
+        ecs_http_send_request_t *dst = ecs_vector_add(
+            &conn->deferred, ecs_http_send_request_t);
+        *dst = *r;
+        return;
+    }
+
+    if (!r->more) {
+        conn->pending --;
+    }
+
+    ecs_http_send_request_t *dst = ecs_vector_add(
+        &conn->replies, ecs_http_send_request_t);
+    *dst = *r;
+
+    if (r->stream_id) {
+        if (r->more) {
+            conn->stream_id = r->stream_id;
+        } else {
+            /* Last chunk of stream, send deferred replies. A deferred reply
+             * can open a new stream, which defers the replies after it. */
+            ecs_vector_t *deferred = conn->deferred;
+            conn->stream_id = 0;
+            conn->deferred = NULL;
+
+            int32_t i, count = ecs_vector_count(deferred);
+            ecs_http_send_request_t *replies = ecs_vector_first(
+                deferred, ecs_http_send_request_t);
+            for (i = 0; i < count; i ++) {
+                http_conn_add_reply(srv, conn, &replies[i]);
+            }
+            ecs_vector_free(deferred);
+        }
+    }
+}
+
+static
+void http_process_send_queue(
+    ecs_http_server_t *srv)
+{
+    /* Swap queues so replies can be sent without holding the lock */
+    ecs_os_mutex_lock(srv->lock);
+    ecs_vector_t *queue = srv->send_queue;
+    srv->send_queue = srv->send_queue_swap;
+    srv->send_queue_swap = queue;
+    ecs_os_mutex_unlock(srv->lock);
+
+    int32_t i, count = ecs_vector_count(queue);
+    ecs_http_send_request_t *replies = ecs_vector_first(
+        queue, ecs_http_send_request_t);
+
+    for (i = 0; i < count; i ++) {
+        ecs_http_send_request_t *r = &replies[i];
+        ecs_http_connection_impl_t *conn = flecs_sparse_get(
+            srv->connections, ecs_http_connection_impl_t, r->conn_id);
+        ecs_assert(conn != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(conn->pending > 0, ECS_INTERNAL_ERROR, NULL);
+
+        if (conn->state == HttpConnStateClosed) {
+            /* Connection was closed while request was processed */
+            if (!r->more) {
+                conn->pending --;
+            }
+            http_send_request_free(srv, conn, r);
+            if (!conn->pending) {
+                http_connection_free(conn);
+            }
+            continue;
+        }
+
+        http_conn_add_reply(srv, conn, r);
+
+        if (conn->write_blocked) {
+            /* Reply is sent when socket becomes writable */
+            http_conn_update_events(srv, conn);
+        } else {
+            http_conn_flush(srv, conn);
+        }
+    }
+
+    ecs_vector_clear(queue);
+}
+
+static
+void http_purge_connections(
+    ecs_http_server_t *srv,
+    ecs_ftime_t delta_time)
+{
+    int32_t i, count = flecs_sparse_count(srv->connections);
+    for (i = count - 1; i >= 1; i --) {
+        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense(
+            srv->connections, ecs_http_connection_impl_t, i);
+
+        if (conn->write_blocked) {
+            /* Close connections of clients that don't read replies */
+            conn->idle_time += delta_time;
+            if (conn->idle_time > (ecs_ftime_t)ECS_HTTP_SEND_TIMEOUT) {
+                ecs_dbg("http: send to '%s:%s' timed out (sock = %d)", 
+                    conn->pub.host, conn->pub.port, conn->sock);
+                http_conn_close(srv, conn);
+            }
+            continue;
+        }
+
+        if (conn->state != HttpConnStateOpen || conn->pending || 
+            ecs_vector_count(conn->replies)) 
+        {
+            continue;
+        }
+
+        /* Use a short timeout for connections that haven't sent a complete
+         * request, and a longer timeout for idle kept alive connections */
+        ecs_ftime_t timeout = (ecs_ftime_t)ECS_HTTP_CONNECTION_KEEP_ALIVE_TIMEOUT;
+        if (!conn->request_count || conn->frag.state != HttpFragStateBegin) {
+            timeout = (ecs_ftime_t)ECS_HTTP_CONNECTION_PURGE_TIMEOUT;
+        }
+
+        conn->idle_time += delta_time;
+        if (conn->idle_time > timeout) {
+            ecs_dbg("http: purging connection '%s:%s' (sock = %d)", 
+                conn->pub.host, conn->pub.port, conn->sock);
+            http_conn_close(srv, conn);
+        }
+    }
+}
+
+static
+int http_server_listen(
     ecs_http_server_t* srv, 
     const struct sockaddr* addr, 
     ecs_size_t addr_len) 
@@ -35923,7 +43080,7 @@ void http_accept_connections(
         if (result) {
             ecs_warn("http: WSAStartup failed with GetLastError = %d\n", 
                 GetLastError());
-            return;
+            return -1;
         }
     } else {
         http_close(&testsocket);
@@ -35945,165 +43102,525 @@ void http_accept_connections(
         ecs_os_strcpy(addr_port, "unknown");
     }
 
-    ecs_os_mutex_lock(srv->lock);
-    if (srv->should_run) {
-        ecs_dbg_2("http: initializing connection socket");
+    ecs_dbg_2("http: initializing connection socket");
+
+    sock = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
+    if (!http_socket_is_valid(sock)) {
+        ecs_err("http: unable to create new connection socket: %s", 
+            ecs_os_strerror(errno));
+        return -1;
+    }
+
+    int reuse = 1;
+    int result = setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, 
+        (char*)&reuse, ECS_SIZEOF(reuse)); 
+    if (result) {
+        ecs_warn("http: failed to setsockopt: %s", ecs_os_strerror(errno));
+    }
 
-        sock = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
-        if (!http_socket_is_valid(sock)) {
-            ecs_err("http: unable to create new connection socket: %s", 
+    if (addr->sa_family == AF_INET6) {
+        int ipv6only = 0;
+        if (setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, 
+            (char*)&ipv6only, ECS_SIZEOF(ipv6only)))
+        {
+            ecs_warn("http: failed to setsockopt: %s", 
                 ecs_os_strerror(errno));
-            ecs_os_mutex_unlock(srv->lock);
-            goto done;
         }
+    }
 
-        int reuse = 1;
-        int result = setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, 
-            (char*)&reuse, ECS_SIZEOF(reuse)); 
-        if (result) {
-            ecs_warn("http: failed to setsockopt: %s", ecs_os_strerror(errno));
-        }
+    result = http_bind(sock, addr, addr_len);
+    if (result) {
+        ecs_err("http: failed to bind to '%s:%s': %s", 
+            addr_host, addr_port, ecs_os_strerror(errno));
+        http_close(&sock);
+        return -1;
+    }
 
-        if (addr->sa_family == AF_INET6) {
-            int ipv6only = 0;
-            if (setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, 
-                (char*)&ipv6only, ECS_SIZEOF(ipv6only)))
-            {
-                ecs_warn("http: failed to setsockopt: %s", 
-                    ecs_os_strerror(errno));
-            }
-        }
+    result = listen(sock, SOMAXCONN);
+    if (result) {
+        ecs_warn("http: could not listen for SOMAXCONN (%d) connections: %s", 
+            SOMAXCONN, ecs_os_strerror(errno));
+    }
 
-        result = http_bind(sock, addr, addr_len);
-        if (result) {
-            ecs_err("http: failed to bind to '%s:%s': %s", 
-                addr_host, addr_port, ecs_os_strerror(errno));
-            ecs_os_mutex_unlock(srv->lock);
-            goto done;
-        }
+    http_sock_nonblock(sock);
+    http_poll_add(srv, sock, ECS_HTTP_POLL_ID_LISTEN, ECS_HTTP_EVENT_READ);
+    srv->sock = sock;
 
-        srv->sock = sock;
+    ecs_trace("http: listening for incoming connections on '%s:%s'",
+        addr_host, addr_port);
 
-        result = listen(srv->sock, SOMAXCONN);
-        if (result) {
-            ecs_warn("http: could not listen for SOMAXCONN (%d) connections: %s", 
-                SOMAXCONN, ecs_os_strerror(errno));
-        }
+    return 0;
+}
+
+static
+void* http_server_thread(void* arg) {
+    ecs_http_server_t *srv = arg;
+    struct sockaddr_in addr;
+    ecs_os_zeromem(&addr);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(srv->port);
 
-        ecs_trace("http: listening for incoming connections on '%s:%s'",
-            addr_host, addr_port);
+    if (!srv->ipaddr) {
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
     } else {
-        ecs_dbg_2("http: server shut down while initializing");
+        inet_pton(AF_INET, srv->ipaddr, &(addr.sin_addr));
     }
-    ecs_os_mutex_unlock(srv->lock);
 
-    ecs_http_socket_t sock_conn;
-    struct sockaddr_storage remote_addr;
-    ecs_size_t remote_addr_len;
+    if (http_server_listen(srv, (struct sockaddr*)&addr, ECS_SIZEOF(addr))) {
+        return NULL;
+    }
 
+    ecs_http_poll_event_t events[ECS_HTTP_POLL_EVENT_COUNT];
+    ecs_time_t t = {0};
+    ecs_ftime_t purge_time = 0;
+    bool has_time = ecs_os_has_time();
+    if (has_time) {
+        ecs_time_measure(&t);
+    }
+
+    /* Single thread multiplexes accepting connections, receiving requests and
+     * sending replies, so a slow client can't hold up other clients. */
     while (srv->should_run) {
-        remote_addr_len = ECS_SIZEOF(remote_addr);
-        sock_conn = http_accept(srv->sock, (struct sockaddr*) &remote_addr, 
-            &remote_addr_len);
+        int32_t i, count = http_poll_wait(srv, events);
+        for (i = 0; i < count; i ++) {
+            ecs_http_poll_event_t *ev = &events[i];
+            if (ev->id == ECS_HTTP_POLL_ID_LISTEN) {
+                http_accept_connections(srv);
+            } else if (ev->id == ECS_HTTP_POLL_ID_WAKE) {
+                http_wake_drain(srv);
+            } else {
+                http_conn_event(srv, ev);
+            }
+        }
 
-        if (sock_conn == -1) {
-            if (srv->should_run) {
-                ecs_dbg("http: connection attempt failed: %s", 
-                    ecs_os_strerror(errno));
+        http_process_send_queue(srv);
+
+        if (has_time) {
+            purge_time += (ecs_ftime_t)ecs_time_measure(&t);
+            if ((1000 * purge_time) > (ecs_ftime_t)ECS_HTTP_POLL_TIMEOUT) {
+                http_purge_connections(srv, purge_time);
+                purge_time = 0;
             }
-            continue;
         }
+    }
 
-        http_init_connection(srv, sock_conn, &remote_addr, remote_addr_len);
+    http_close(&srv->sock);
+
+    ecs_trace("http: no longer accepting connections on port %u", srv->port);
+
+    return NULL;
+}
+
+/* Post chunks that were sent to stream before its first reply was posted */
+static
+void http_stream_start(
+    ecs_http_server_t *srv,
+    const ecs_http_send_request_t *first)
+{
+    ecs_http_stream_t *stream = flecs_sparse_get(
+        srv->streams, ecs_http_stream_t, first->stream_id);
+    ecs_assert(stream != NULL, ECS_INTERNAL_ERROR, NULL);
+    stream->queued += first->header_length + first->content_length;
+    stream->started = true;
+
+    int32_t i, count = ecs_vector_count(stream->backlog);
+    ecs_http_send_request_t *chunks = ecs_vector_first(
+        stream->backlog, ecs_http_send_request_t);
+    for (i = 0; i < count; i ++) {
+        ecs_http_send_request_t *r = ecs_vector_add(
+            &srv->send_queue, ecs_http_send_request_t);
+        *r = chunks[i];
     }
+    ecs_vector_free(stream->backlog);
+    stream->backlog = NULL;
 
-done:
+    if (stream->closing) {
+        flecs_sparse_remove(srv->streams, stream->id);
+    }
+}
+
+static
+void http_post_replies(
+    ecs_http_dequeue_t *dq)
+{
+    ecs_http_server_t *srv = dq->srv;
+    int32_t i;
+
+    /* Requests must be freed before replies are posted, as the server thread 
+     * can free the connection of a request after its last reply is sent */
     ecs_os_mutex_lock(srv->lock);
-    if (http_socket_is_valid(sock) && errno != EBADF) {
-        http_close(&sock);
-        srv->sock = sock;
+    for (i = dq->posted; i < dq->handled; i ++) {
+        http_request_free(dq->requests[i]);
+    }
+    for (i = dq->posted; i < dq->handled; i ++) {
+        ecs_http_send_request_t *r = ecs_vector_add(
+            &srv->send_queue, ecs_http_send_request_t);
+        *r = dq->replies[i];
+        if (r->stream_id) {
+            http_stream_start(srv, r);
+        }
     }
     ecs_os_mutex_unlock(srv->lock);
 
-    ecs_trace("http: no longer accepting connections on '%s:%s'",
-        addr_host, addr_port);
+    if (dq->posted != dq->handled) {
+        dq->posted = dq->handled;
+        http_wake(srv);
+    }
 }
 
 static
-void* http_server_thread(void* arg) {
-    ecs_http_server_t *srv = arg;
-    struct sockaddr_in addr;
-    ecs_os_zeromem(&addr);
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(srv->port);
+char* http_strbuf_take(
+    ecs_strbuf_t *buf,
+    ecs_size_t *length)
+{
+    *length = ecs_strbuf_written(buf);
+    char *result = ecs_strbuf_get(buf);
 
-    if (!srv->ipaddr) {
-        addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    } else {
-        inet_pton(AF_INET, srv->ipaddr, &(addr.sin_addr));
+    /* Reinitialize buffer but keep list state, so that a serializer that is 
+     * writing to the buffer can continue appending */
+    ecs_strbuf_t empty = ECS_STRBUF_INIT;
+    ecs_os_memcpy_n(empty.list_stack, buf->list_stack, ecs_strbuf_list_elem,
+        (buf->list_sp + 1));
+    empty.list_sp = buf->list_sp;
+    *buf = empty;
+
+    return result;
+}
+
+static
+void http_chunk_init(
+    ecs_http_send_request_t *out,
+    ecs_strbuf_t *hdrs,
+    ecs_strbuf_t *body,
+    bool last)
+{
+    ecs_size_t length = ecs_strbuf_written(body);
+    if (length) {
+        ecs_strbuf_append(hdrs, "%x\r\n", length);
+        ecs_strbuf_appendlit(body, "\r\n");
+    }
+    if (last) {
+        ecs_strbuf_appendlit(body, "0\r\n\r\n");
     }
 
-    http_accept_connections(srv, (struct sockaddr*)&addr, ECS_SIZEOF(addr));
-    return NULL;
+    out->header_length = ecs_strbuf_written(hdrs);
+    out->headers = ecs_strbuf_get(hdrs);
+    out->content = http_strbuf_take(body, &out->content_length);
+    out->written = 0;
+    out->more = !last;
+}
+
+int ecs_http_reply_flush(
+    ecs_http_reply_t *reply)
+{
+    ecs_check(reply != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_http_reply_ctx_t *stream = reply->stream;
+    if (!stream) {
+        /* Reply wasn't created by the server, body is sent when complete */
+        return 0;
+    }
+
+    ecs_http_request_impl_t *req = stream->req;
+    ecs_http_server_t *srv = stream->dq->srv;
+
+    /* Connection isn't freed while it has requests that are being handled */
+    ecs_http_connection_impl_t *conn = 
+        (ecs_http_connection_impl_t*)req->pub.conn;
+
+    if (!req->http_1_1) {
+        /* Chunked transfer encoding is not supported by HTTP/1.0 */
+        return 0;
+    }
+
+    if (!ecs_strbuf_written(&reply->body)) {
+        return 0;
+    }
+
+    /* Make sure replies to earlier requests are sent first */
+    http_post_replies(stream->dq);
+
+    ecs_http_send_request_t chunk = { .conn_id = req->conn_id };
+    ecs_strbuf_t hdrs = ECS_STRBUF_INIT;
+    if (!stream->started) {
+        http_append_send_headers(&hdrs, reply->code, reply->status, 
+            reply->content_type, &reply->headers, -1, req->keep_alive);
+        stream->started = true;
+    }
+
+    http_chunk_init(&chunk, &hdrs, &reply->body, false);
+    chunk.stream_size = chunk.header_length + chunk.content_length;
+
+    ecs_os_mutex_lock(srv->lock);
+    ecs_http_send_request_t *r = ecs_vector_add(
+        &srv->send_queue, ecs_http_send_request_t);
+    *r = chunk;
+    conn->stream_bytes += chunk.stream_size;
+    http_wake(srv);
+
+    /* Wait until enough queued data has been sent. Clients that don't read
+     * data are disconnected after ECS_HTTP_SEND_TIMEOUT. Check should_run 
+     * first, as connections are freed when the server is stopped. */
+    while (srv->should_run && !conn->stream_closed &&
+        conn->stream_bytes > ECS_HTTP_STREAM_QUEUE_MAX) 
+    {
+        ecs_os_cond_wait(conn->stream_cond, srv->lock);
+    }
+
+    bool closed = !srv->should_run || conn->stream_closed;
+    ecs_os_mutex_unlock(srv->lock);
+
+    return closed ? -1 : 0;
+error:
+    return -1;
 }
 
 static
 void http_handle_request(
-    ecs_http_server_t *srv,
-    ecs_http_request_impl_t *req)
+    ecs_http_dequeue_t *dq,
+    ecs_http_request_impl_t *req,
+    ecs_http_send_request_t *out)
 {
+    ecs_http_server_t *srv = dq->srv;
+    ecs_http_reply_ctx_t ctx = { .dq = dq, .req = req };
     ecs_http_reply_t reply = ECS_HTTP_REPLY_INIT;
-    ecs_http_connection_impl_t *conn = 
-        (ecs_http_connection_impl_t*)req->pub.conn;
+    reply.stream = &ctx;
 
     if (srv->callback((ecs_http_request_t*)req, &reply, srv->ctx) == false) {
-        reply.code = 404;
-        reply.status = "Resource not found";
+        if (ctx.started || ctx.open) {
+            ecs_err("http: cannot return 404 after reply is flushed");
+        } else {
+            reply.code = 404;
+            reply.status = "Resource not found";
+        }
     }
 
-    http_send_reply(conn, &reply);
-    ecs_dbg_2("http: reply sent to '%s:%s'", conn->pub.host, conn->pub.port);
+    ecs_os_zeromem(out);
+    out->conn_id = req->conn_id;
+
+    ecs_strbuf_t hdrs = ECS_STRBUF_INIT;
+    if (ctx.open) {
+        /* Send headers & body as first chunk of stream */
+        if (!ctx.started) {
+            http_append_send_headers(&hdrs, reply.code, reply.status, 
+                reply.content_type, &reply.headers, -1, req->keep_alive);
+        }
+        http_chunk_init(out, &hdrs, &reply.body, false);
+        out->stream_id = ctx.open->id;
+    } else if (ctx.started) {
+        /* Send remainder of streamed reply as last chunk */
+        http_chunk_init(out, &hdrs, &reply.body, true);
+    } else {
+        ecs_size_t content_length = ecs_strbuf_written(&reply.body);
+        http_append_send_headers(&hdrs, reply.code, reply.status, 
+            reply.content_type, &reply.headers, content_length, 
+                req->keep_alive);
+        out->header_length = ecs_strbuf_written(&hdrs);
+        out->headers = ecs_strbuf_get(&hdrs);
+        out->content = http_strbuf_take(&reply.body, &out->content_length);
+    }
 
     http_reply_free(&reply);
-    http_request_free(req);
-    http_connection_free(conn);
+}
+
+ecs_http_stream_t* ecs_http_reply_open_stream(
+    ecs_http_reply_t *reply)
+{
+    ecs_check(reply != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_http_reply_ctx_t *ctx = reply->stream;
+    ecs_check(ctx != NULL, ECS_INVALID_OPERATION, 
+        "reply must be created by the server");
+
+    if (!ctx->req->http_1_1) {
+        /* Chunked transfer encoding is not supported by HTTP/1.0 */
+        return NULL;
+    }
+
+    if (!ctx->open) {
+        ecs_http_server_t *srv = ctx->dq->srv;
+        ecs_os_mutex_lock(srv->lock);
+        ecs_http_stream_t *stream = flecs_sparse_add(
+            srv->streams, ecs_http_stream_t);
+        ecs_os_zeromem(stream);
+        stream->id = flecs_sparse_last_id(srv->streams);
+        stream->srv = srv;
+        stream->conn_id = ctx->req->conn_id;
+        ecs_os_mutex_unlock(srv->lock);
+        ctx->open = stream;
+    }
+
+    return ctx->open;
+error:
+    return NULL;
+}
+
+int ecs_http_stream_send(
+    ecs_http_stream_t *stream,
+    ecs_strbuf_t *buf)
+{
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(buf != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_http_server_t *srv = stream->srv;
+    ecs_http_send_request_t chunk = { 
+        .conn_id = stream->conn_id, 
+        .stream_id = stream->id 
+    };
+
+    ecs_strbuf_t hdrs = ECS_STRBUF_INIT;
+    if (ecs_strbuf_written(buf)) {
+        http_chunk_init(&chunk, &hdrs, buf, false);
+    }
+
+    ecs_os_mutex_lock(srv->lock);
+    bool closed = stream->closed || !srv->should_run;
+    if (!closed && chunk.content_length) {
+        stream->queued += chunk.header_length + chunk.content_length;
+        if (stream->started) {
+            ecs_http_send_request_t *r = ecs_vector_add(
+                &srv->send_queue, ecs_http_send_request_t);
+            *r = chunk;
+            http_wake(srv);
+        } else {
+            ecs_http_send_request_t *r = ecs_vector_add(
+                &stream->backlog, ecs_http_send_request_t);
+            *r = chunk;
+        }
+    }
+    ecs_os_mutex_unlock(srv->lock);
+
+    if (closed) {
+        ecs_os_free(chunk.headers);
+        ecs_os_free(chunk.content);
+        return -1;
+    }
+
+    return 0;
+error:
+    return -1;
+}
+
+int32_t ecs_http_stream_queued(
+    const ecs_http_stream_t *stream)
+{
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_http_server_t *srv = stream->srv;
+    ecs_os_mutex_lock(srv->lock);
+    int32_t result = stream->queued;
+    ecs_os_mutex_unlock(srv->lock);
+    return result;
+error:
+    return 0;
+}
+
+void ecs_http_stream_close(
+    ecs_http_stream_t *stream)
+{
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_http_server_t *srv = stream->srv;
+    ecs_http_send_request_t chunk = { 
+        .conn_id = stream->conn_id, 
+        .stream_id = stream->id 
+    };
+
+    ecs_strbuf_t hdrs = ECS_STRBUF_INIT;
+    ecs_strbuf_t body = ECS_STRBUF_INIT;
+    http_chunk_init(&chunk, &hdrs, &body, true);
+
+    ecs_os_mutex_lock(srv->lock);
+    bool running = srv->should_run;
+    if (!running) {
+        http_stream_free(stream);
+    } else if (stream->started) {
+        /* Last chunk releases the connection */
+        flecs_sparse_remove(srv->streams, stream->id);
+        ecs_http_send_request_t *r = ecs_vector_add(
+            &srv->send_queue, ecs_http_send_request_t);
+        *r = chunk;
+        http_wake(srv);
+    } else {
+        /* Stream is removed when first reply is posted */
+        ecs_http_send_request_t *r = ecs_vector_add(
+            &stream->backlog, ecs_http_send_request_t);
+        *r = chunk;
+        stream->closing = true;
+    }
+    ecs_os_mutex_unlock(srv->lock);
+
+    if (!running) {
+        ecs_os_free(chunk.content);
+    }
+error:
+    return;
+}
+
+static
+int http_request_compare(
+    const void *ptr1,
+    const void *ptr2)
+{
+    const ecs_http_request_impl_t *r1 = *(ecs_http_request_impl_t*const*)ptr1;
+    const ecs_http_request_impl_t *r2 = *(ecs_http_request_impl_t*const*)ptr2;
+    return (r1->seq > r2->seq) - (r1->seq < r2->seq);
 }
 
 static
 int32_t http_dequeue_requests(
-    ecs_http_server_t *srv,
-    ecs_ftime_t delta_time)
+    ecs_http_server_t *srv)
 {
+    /* Copy out request pointers, so the server thread isn't blocked while
+     * request handlers run. Requests are not freed until replies are posted,
+     * and the connection of a request is kept alive until it gets a reply. */
     ecs_os_mutex_lock(srv->lock);
+    int32_t i, request_count = flecs_sparse_count(srv->requests) - 1;
+    if (request_count <= 0) {
+        ecs_os_mutex_unlock(srv->lock);
+        return 0;
+    }
 
-    int32_t i, request_count = flecs_sparse_count(srv->requests);
-    for (i = request_count - 1; i >= 1; i --) {
-        ecs_http_request_impl_t *req = flecs_sparse_get_dense(
-            srv->requests, ecs_http_request_impl_t, i);
-        http_handle_request(srv, req);
+    ecs_http_request_impl_t **requests = ecs_os_malloc_n(
+        ecs_http_request_impl_t*, request_count);
+    for (i = 0; i < request_count; i ++) {
+        requests[i] = flecs_sparse_get_dense(
+            srv->requests, ecs_http_request_impl_t, i + 1);
     }
+    srv->dequeueing = true;
+    ecs_os_mutex_unlock(srv->lock);
 
-    int32_t connections_count = flecs_sparse_count(srv->connections);
-    for (i = connections_count - 1; i >= 1; i --) {
-        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense(
-            srv->connections, ecs_http_connection_impl_t, i);
+    /* Handle requests in order of arrival, so that replies for pipelined 
+     * requests are enqueued in the same order as the requests */
+    ecs_qsort_t(requests, request_count, ecs_http_request_impl_t*, 
+        http_request_compare);
 
-        conn->dequeue_timeout += delta_time;
-        conn->dequeue_retries ++;
-        
-        if ((conn->dequeue_timeout > 
-            (ecs_ftime_t)ECS_HTTP_CONNECTION_PURGE_TIMEOUT) &&
-             (conn->dequeue_retries > ECS_HTTP_CONNECTION_PURGE_RETRY_COUNT)) 
-        {
-            ecs_dbg("http: purging connection '%s:%s' (sock = %d)", 
-                conn->pub.host, conn->pub.port, conn->sock);
-            http_connection_free(conn);
+    ecs_http_dequeue_t dq = {
+        .srv = srv,
+        .requests = requests,
+        .replies = ecs_os_malloc_n(ecs_http_send_request_t, request_count)
+    };
+
+    for (i = 0; i < request_count; i ++) {
+        if (requests[i]->reuse_count) {
+            srv->requests_reused ++;
+            srv->requests_reused_total ++;
         }
+
+        http_handle_request(&dq, requests[i], &dq.replies[i]);
+        dq.handled ++;
     }
 
+    http_post_replies(&dq);
+
+    ecs_os_mutex_lock(srv->lock);
+    srv->dequeueing = false;
+    ecs_os_cond_broadcast(srv->dequeue_cond);
     ecs_os_mutex_unlock(srv->lock);
 
-    return request_count - 1;
+    ecs_os_free(requests);
+    ecs_os_free(dq.replies);
+
+    return request_count;
 }
 
 const char* ecs_http_get_header(
@@ -36138,6 +43655,7 @@ ecs_http_server_t* ecs_http_server_init(
 
     ecs_http_server_t* srv = ecs_os_calloc_t(ecs_http_server_t);
     srv->lock = ecs_os_mutex_new();
+    srv->dequeue_cond = ecs_os_cond_new();
     srv->sock = HTTP_SOCKET_INVALID;
 
     srv->should_run = false;
@@ -36147,17 +43665,15 @@ ecs_http_server_t* ecs_http_server_init(
     srv->ctx = desc->ctx;
     srv->port = desc->port;
     srv->ipaddr = desc->ipaddr;
-    srv->send_queue.wait_ms = desc->send_queue_wait_ms;
-    if (!srv->send_queue.wait_ms) {
-        srv->send_queue.wait_ms = 100 * 1000 * 1000;
-    }
 
     srv->connections = flecs_sparse_new(NULL, NULL, ecs_http_connection_impl_t);
     srv->requests = flecs_sparse_new(NULL, NULL, ecs_http_request_impl_t);
+    srv->streams = flecs_sparse_new(NULL, NULL, ecs_http_stream_t);
 
     /* Start at id 1 */
     flecs_sparse_new_id(srv->connections);
     flecs_sparse_new_id(srv->requests);
+    flecs_sparse_new_id(srv->streams);
 
 #ifndef ECS_TARGET_WINDOWS
     /* Ignore pipe signal. SIGPIPE can occur when a message is sent to a client
@@ -36165,6 +43681,11 @@ ecs_http_server_t* ecs_http_server_init(
     signal(SIGPIPE, SIG_IGN);
 #endif
 
+    if (http_poll_init(srv)) {
+        ecs_http_server_fini(srv);
+        return NULL;
+    }
+
     return srv;
 error:
     return NULL;
@@ -36176,9 +43697,21 @@ void ecs_http_server_fini(
     if (srv->should_run) {
         ecs_http_server_stop(srv);
     }
+    http_poll_fini(srv);
+    ecs_os_cond_free(srv->dequeue_cond);
     ecs_os_mutex_free(srv->lock);
     flecs_sparse_free(srv->connections);
     flecs_sparse_free(srv->requests);
+
+    /* Free streams that weren't closed by the application */
+    int32_t i, count = flecs_sparse_count(srv->streams);
+    for (i = count - 1; i >= 1; i --) {
+        http_stream_free(flecs_sparse_get_dense(
+            srv->streams, ecs_http_stream_t, i));
+    }
+    flecs_sparse_free(srv->streams);
+    ecs_vector_free(srv->send_queue);
+    ecs_vector_free(srv->send_queue_swap);
     ecs_os_free(srv);
 }
 
@@ -36199,11 +43732,6 @@ int ecs_http_server_start(
         goto error;
     }
 
-    srv->send_queue.thread = ecs_os_thread_new(http_server_send_queue, srv);
-    if (!srv->send_queue.thread) {
-        goto error;
-    }
-
     return 0;
 error:
     return -1;
@@ -36221,17 +43749,28 @@ void ecs_http_server_stop(
 
     ecs_os_mutex_lock(srv->lock);
     srv->should_run = false;
-    if (http_socket_is_valid(srv->sock)) {
-        http_close(&srv->sock);
-    }
     ecs_os_mutex_unlock(srv->lock);
 
+    http_wake(srv);
     ecs_os_thread_join(srv->thread);
-    ecs_os_thread_join(srv->send_queue.thread);
-    ecs_trace("http: server threads shut down");
+    ecs_trace("http: server thread shut down");
+
+    /* Wake up handlers that wait for chunks to be sent, as the server thread
+     * no longer sends them, and wait until handlers have returned. */
+    int i, count = flecs_sparse_count(srv->connections);
+    ecs_os_mutex_lock(srv->lock);
+    for (i = 1; i < count; i ++) {
+        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense(
+            srv->connections, ecs_http_connection_impl_t, i);
+        ecs_os_cond_broadcast(conn->stream_cond);
+    }
+    while (srv->dequeueing) {
+        ecs_os_cond_wait(srv->dequeue_cond, srv->lock);
+    }
+    ecs_os_mutex_unlock(srv->lock);
 
     /* Cleanup all outstanding requests */
-    int i, count = flecs_sparse_count(srv->requests);
+    count = flecs_sparse_count(srv->requests);
     for (i = count - 1; i >= 1; i --) {
         http_request_free(flecs_sparse_get_dense(
             srv->requests, ecs_http_request_impl_t, i));
@@ -36244,6 +43783,15 @@ void ecs_http_server_stop(
             srv->connections, ecs_http_connection_impl_t, i));
     }
 
+    /* Free replies that weren't sent */
+    count = ecs_vector_count(srv->send_queue);
+    ecs_http_send_request_t *replies = ecs_vector_first(
+        srv->send_queue, ecs_http_send_request_t);
+    for (i = 0; i < count; i ++) {
+        http_send_request_free(srv, NULL, &replies[i]);
+    }
+    ecs_vector_clear(srv->send_queue);
+
     ecs_assert(flecs_sparse_count(srv->connections) == 1, 
         ECS_INTERNAL_ERROR, NULL);
     ecs_assert(flecs_sparse_count(srv->requests) == 1,
@@ -36272,7 +43820,7 @@ void ecs_http_server_dequeue(
 
         ecs_time_t t = {0};
         ecs_time_measure(&t);
-        int32_t request_count = http_dequeue_requests(srv, srv->dequeue_timeout);
+        int32_t request_count = http_dequeue_requests(srv);
         srv->requests_processed += request_count;
         srv->requests_processed_total += request_count;
         ecs_ftime_t time_spent = (ecs_ftime_t)ecs_time_measure(&t);
@@ -36285,10 +43833,13 @@ void ecs_http_server_dequeue(
         (ecs_ftime_t)ECS_HTTP_MIN_STATS_INTERVAL) 
     {
         srv->stats_timeout = 0;
-        ecs_dbg("http: processed %d requests in %.3fs (avg %.3fs / dequeue)",
-            srv->requests_processed, (double)srv->request_time, 
+        ecs_dbg("http: processed %d requests (%d on reused connections) in "
+            "%.3fs (avg %.3fs / dequeue)",
+            srv->requests_processed, srv->requests_reused,
+            (double)srv->request_time, 
             (double)(srv->request_time / (ecs_ftime_t)srv->dequeue_count));
         srv->requests_processed = 0;
+        srv->requests_reused = 0;
         srv->request_time = 0;
         srv->dequeue_count = 0;
     }
@@ -38466,6 +46017,9 @@ const ecs_entity_t EcsChildOf =               ECS_HI_COMPONENT_ID + 25;
 const ecs_entity_t EcsIsA =                   ECS_HI_COMPONENT_ID + 26;
 const ecs_entity_t EcsDependsOn =             ECS_HI_COMPONENT_ID + 27;
 
+/* Relationship indexing */
+const ecs_entity_t EcsTargetIndex =           ECS_HI_COMPONENT_ID + 28;
+
 /* Identifier tags */
 const ecs_entity_t EcsName =                  ECS_HI_COMPONENT_ID + 30;
 const ecs_entity_t EcsSymbol =                ECS_HI_COMPONENT_ID + 31;
@@ -39038,6 +46592,9 @@ void flecs_log_addons(void) {
     #ifdef FLECS_JOURNAL
         ecs_trace("FLECS_JOURNAL");
     #endif
+    #ifdef FLECS_TRACING
+        ecs_trace("FLECS_TRACING");
+    #endif
     #ifdef FLECS_APP
         ecs_trace("FLECS_APP");
     #endif
@@ -39109,6 +46666,11 @@ ecs_world_t *ecs_mini(void) {
         &world->allocator, &world->allocators.sparse_chunk, 
         ecs_type_info_t);
     ecs_map_init_w_params(&world->id_index_hi, &world->allocators.ptr);
+    ecs_map_init(&world->query_index, ecs_vec_t, &world->allocator, 0);
+    ecs_vec_init_t(&world->allocator, &world->unindexed_queries, 
+        ecs_query_t*, 0);
+    ecs_vec_init_t(&world->allocator, &world->pending_queries, 
+        ecs_query_t*, 0);
     flecs_sparse_init(&world->id_index_lo, NULL, 
         &world->allocators.id_record_chunk, ecs_id_record_t);
     flecs_observable_init(&world->observable);
@@ -39602,6 +47164,7 @@ int ecs_fini(
     /* This will destroy all entities and components. After this point no more
      * user code is executed. */
     flecs_fini_store(world);
+    flecs_query_index_fini(world);
 
     /* Purge deferred operations from the queue. This discards operations but
      * makes sure that any resources in the queue are freed */
@@ -39913,6 +47476,11 @@ ecs_ftime_t flecs_insert_sleep(
      * should take. */
     ecs_ftime_t sleep_time = sleep / (ecs_ftime_t)4.0;
 
+    /* World isn't modified while sleeping, so readers can access it. Process
+     * table events first, so that readers don't have to. */
+    flecs_process_pending_tables(world);
+    flecs_reader_window_begin(world);
+
     do {
         /* Only call sleep when sleep_time is not 0. On some platforms, even
          * a sleep with a timeout of 0 can cause stutter. */
@@ -39925,6 +47493,8 @@ ecs_ftime_t flecs_insert_sleep(
     } while ((target_delta_time - delta_time) > 
         (sleep_time / (ecs_ftime_t)2.0));
 
+    flecs_reader_window_end(world);
+
     *stop = now;
     return delta_time;
 }
@@ -39973,7 +47543,9 @@ void flecs_stop_measure_frame(
 
     if (world->flags & EcsWorldMeasureFrameTime) {
         ecs_time_t t = world->frame_start_time;
-        world->info.frame_time_total += (ecs_ftime_t)ecs_time_measure(&t);
+        ecs_ftime_t frame_time = (ecs_ftime_t)ecs_time_measure(&t);
+        world->info.frame_time_total += frame_time;
+        flecs_histogram_record(&world->frame_time_hist, frame_time);
     }
 }
 
@@ -39986,6 +47558,8 @@ ecs_ftime_t ecs_frame_begin(
     ecs_check(user_delta_time != 0 || ecs_os_has_time(), 
         ECS_MISSING_OS_API, "get_time");
 
+    flecs_trace_begin(&world->stages[0], EcsTraceFrame, 0);
+
     /* Start measuring total frame time */
     ecs_ftime_t delta_time = flecs_start_measure_frame(world, user_delta_time);
     if (user_delta_time == 0) {
@@ -40020,6 +47594,8 @@ void ecs_frame_end(
     }
 
     flecs_stop_measure_frame(world);
+
+    flecs_trace_end(&world->stages[0], EcsTraceFrame, 0);
 error:
     return;
 }
@@ -40037,6 +47613,14 @@ void flecs_notify_queries(
 {
     ecs_poly_assert(world, ecs_world_t); 
 
+    if (event->kind == EcsQueryTableMatch || 
+        event->kind == EcsQueryTableUnmatch) 
+    {
+        /* Only notify queries that can match the table */
+        flecs_query_index_notify(world, event);
+        return;
+    }
+
     ecs_id_record_t *idr = flecs_id_record_get(world, 
         ecs_pair(ecs_id(EcsPoly), EcsQuery));
     if (!idr) {
@@ -42294,6 +49878,158 @@ int flecs_term_finalize(
     return 0;
 }
 
+#ifdef FLECS_META
+static
+ecs_predicate_kind_t flecs_predicate_kind_from_type(
+    const ecs_world_t *world,
+    ecs_entity_t type)
+{
+    const EcsPrimitive *p = ecs_get(world, type, EcsPrimitive);
+    if (p) {
+        switch(p->kind) {
+        case EcsBool:   return EcsPredicateU8;
+        case EcsChar:   return EcsPredicateI8;
+        case EcsByte:   return EcsPredicateU8;
+        case EcsU8:     return EcsPredicateU8;
+        case EcsU16:    return EcsPredicateU16;
+        case EcsU32:    return EcsPredicateU32;
+        case EcsU64:    return EcsPredicateU64;
+        case EcsI8:     return EcsPredicateI8;
+        case EcsI16:    return EcsPredicateI16;
+        case EcsI32:    return EcsPredicateI32;
+        case EcsI64:    return EcsPredicateI64;
+        case EcsF32:    return EcsPredicateF32;
+        case EcsF64:    return EcsPredicateF64;
+        case EcsEntity: return EcsPredicateU64;
+        case EcsUPtr:   
+            return ECS_SIZEOF(uintptr_t) == 8 ? 
+                EcsPredicateU64 : EcsPredicateU32;
+        case EcsIPtr:   
+            return ECS_SIZEOF(intptr_t) == 8 ? 
+                EcsPredicateI64 : EcsPredicateI32;
+        default:
+            return EcsPredicateNone;
+        }
+    }
+
+    if (ecs_has(world, type, EcsEnum)) {
+        return EcsPredicateI32;
+    }
+
+    if (ecs_has(world, type, EcsBitmask)) {
+        return EcsPredicateU32;
+    }
+
+    return EcsPredicateNone;
+}
+#endif
+
+static
+int flecs_term_finalize_predicate(
+    const ecs_world_t *world,
+    ecs_term_t *term,
+    ecs_filter_finalize_ctx_t *ctx)
+{
+    ecs_term_predicate_t *pred = &term->predicate;
+    if (!pred->member && !pred->kind) {
+        return 0;
+    }
+
+    ecs_entity_t type = ecs_get_typeid(world, term->id);
+    const ecs_type_info_t *ti = type ? ecs_get_type_info(world, type) : NULL;
+    if (!ti) {
+        flecs_filter_error(ctx, "predicate requires a component");
+        return -1;
+    }
+
+    if (pred->member) {
+#ifdef FLECS_META
+        ecs_entity_t member_type = 0;
+        if (ecs_meta_member_offset(world, type, pred->member, &pred->offset, 
+            &member_type))
+        {
+            flecs_filter_error(ctx, "unknown member '%s' for predicate", 
+                pred->member);
+            return -1;
+        }
+
+        pred->kind = flecs_predicate_kind_from_type(world, member_type);
+        if (!pred->kind) {
+            flecs_filter_error(ctx, "member '%s' cannot be used in predicate",
+                pred->member);
+            return -1;
+        }
+
+        /* Member is resolved, don't hold on to the (not owned) name */
+        pred->member = NULL;
+#else
+        flecs_filter_error(ctx, "predicates with member require FLECS_META");
+        return -1;
+#endif
+    }
+
+    if (term->oper != EcsAnd) {
+        flecs_filter_error(ctx, "predicate requires a term with And operator");
+        return -1;
+    }
+
+    if (ecs_term_match_0(term)) {
+        flecs_filter_error(ctx, "predicate requires a term with a source");
+        return -1;
+    }
+
+    if (pred->kind < EcsPredicateI8 || pred->kind > EcsPredicateF64) {
+        flecs_filter_error(ctx, "invalid predicate kind");
+        return -1;
+    }
+
+    if (pred->op < EcsPredicateEq || pred->op > EcsPredicateMaskNone) {
+        flecs_filter_error(ctx, "invalid predicate operation");
+        return -1;
+    }
+
+    if (pred->op >= EcsPredicateMaskAny && pred->kind >= EcsPredicateF32) {
+        flecs_filter_error(ctx, "mask predicate requires an integer value");
+        return -1;
+    }
+
+    static const ecs_size_t kind_size[] = {
+        [EcsPredicateI8] = 1, [EcsPredicateI16] = 2, 
+        [EcsPredicateI32] = 4, [EcsPredicateI64] = 8,
+        [EcsPredicateU8] = 1, [EcsPredicateU16] = 2, 
+        [EcsPredicateU32] = 4, [EcsPredicateU64] = 8,
+        [EcsPredicateF32] = 4, [EcsPredicateF64] = 8
+    };
+
+    if (pred->offset < 0 || (pred->offset + kind_size[pred->kind]) > ti->size) {
+        flecs_filter_error(ctx, "predicate value is out of component bounds");
+        return -1;
+    }
+
+    if (pred->index) {
+#ifdef FLECS_META
+        if (!ecs_term_match_this(term) || (term->src.flags & EcsUp)) {
+            flecs_filter_error(ctx, 
+                "predicate with index requires a term that matches $this "
+                "with self");
+            return -1;
+        }
+
+        if (flecs_member_index_iter_predicate(
+            world, pred->index, type, pred, NULL)) 
+        {
+            flecs_filter_error(ctx, "index cannot be used for predicate");
+            return -1;
+        }
+#else
+        flecs_filter_error(ctx, "predicates with index require FLECS_META");
+        return -1;
+#endif
+    }
+
+    return 0;
+}
+
 ecs_id_t flecs_to_public_id(
     ecs_id_t id)
 {
@@ -42309,10 +50045,14 @@ ecs_id_t flecs_from_public_id(
     ecs_id_t id)
 {
     if (ECS_HAS_ID_FLAG(id, PAIR)) {
+        /* Don't create the id record, so this can be used by threads that
+         * only read the world */
         ecs_entity_t first = ECS_PAIR_FIRST(id);
-        ecs_id_record_t *idr = flecs_id_record_ensure(world, 
+        ecs_id_record_t *idr = flecs_id_record_get(world, 
             ecs_pair(first, EcsWildcard));
-        if (idr->flags & EcsIdUnion) {
+        bool is_union = idr ? (idr->flags & EcsIdUnion) != 0 :
+            ecs_has_id(world, first, EcsUnion);
+        if (is_union) {
             return ecs_pair(EcsUnion, first);
         }
     }
@@ -42554,6 +50294,10 @@ int ecs_filter_finalize(
             return -1;
         }
 
+        if (flecs_term_finalize_predicate(world, term, &ctx)) {
+            return -1;
+        }
+
         is_or = term->oper == EcsOr;
         field_count += !(is_or && prev_or);
         term->field_index = field_count - 1;
@@ -42579,6 +50323,10 @@ int ecs_filter_finalize(
             ECS_BIT_CLEAR(f->flags, EcsFilterMatchOnlyThis);
         }
 
+        if (term->predicate.kind) {
+            ECS_BIT_SET(f->flags, EcsFilterHasPredicates);
+        }
+
         if (term->id == EcsPrefab) {
             ECS_BIT_SET(f->flags, EcsFilterMatchPrefab);
         }
@@ -43377,6 +51125,176 @@ bool flecs_filter_match_table(
     return !is_or || or_result;
 }
 
+/* Predicates are evaluated in blocks of rows. The compare loops don't branch
+ * and write to a selection buffer, which lets compilers vectorize them. */
+#define FLECS_PREDICATE_TEST(T, expr)\
+    for (i = 0; i < count; i ++) {\
+        T v = *(const T*)ECS_ELEM(ptr, stride, i);\
+        sel[i] &= (uint8_t)(expr);\
+    }
+
+#define FLECS_PREDICATE_CMP(T)\
+    case EcsPredicateEq:   { FLECS_PREDICATE_TEST(T, v == c) } break;\
+    case EcsPredicateNeq:  { FLECS_PREDICATE_TEST(T, v != c) } break;\
+    case EcsPredicateLt:   { FLECS_PREDICATE_TEST(T, v < c) } break;\
+    case EcsPredicateLtEq: { FLECS_PREDICATE_TEST(T, v <= c) } break;\
+    case EcsPredicateGt:   { FLECS_PREDICATE_TEST(T, v > c) } break;\
+    case EcsPredicateGtEq: { FLECS_PREDICATE_TEST(T, v >= c) } break;
+
+#define FLECS_PREDICATE_INT(T) {\
+        T c = (T)pred->value, m = (T)pred->mask;\
+        switch(pred->op) {\
+        FLECS_PREDICATE_CMP(T)\
+        case EcsPredicateMaskAny:  { FLECS_PREDICATE_TEST(T, (v & m) != 0) } break;\
+        case EcsPredicateMaskAll:  { FLECS_PREDICATE_TEST(T, (v & m) == m) } break;\
+        case EcsPredicateMaskNone: { FLECS_PREDICATE_TEST(T, (v & m) == 0) } break;\
+        }\
+    }
+
+#define FLECS_PREDICATE_FLOAT(T) {\
+        T c = (T)pred->value;\
+        switch(pred->op) {\
+        FLECS_PREDICATE_CMP(T)\
+        default: ecs_abort(ECS_INTERNAL_ERROR, NULL);\
+        }\
+    }
+
+static
+void flecs_predicate_eval(
+    const ecs_term_predicate_t *pred,
+    const void *ptr,
+    ecs_size_t stride,
+    int32_t count,
+    uint8_t *sel)
+{
+    int32_t i;
+    switch(pred->kind) {
+    case EcsPredicateI8:  FLECS_PREDICATE_INT(int8_t)   break;
+    case EcsPredicateI16: FLECS_PREDICATE_INT(int16_t)  break;
+    case EcsPredicateI32: FLECS_PREDICATE_INT(int32_t)  break;
+    case EcsPredicateI64: FLECS_PREDICATE_INT(int64_t)  break;
+    case EcsPredicateU8:  FLECS_PREDICATE_INT(uint8_t)  break;
+    case EcsPredicateU16: FLECS_PREDICATE_INT(uint16_t) break;
+    case EcsPredicateU32: FLECS_PREDICATE_INT(uint32_t) break;
+    case EcsPredicateU64: FLECS_PREDICATE_INT(uint64_t) break;
+    case EcsPredicateF32: FLECS_PREDICATE_FLOAT(float)  break;
+    case EcsPredicateF64: FLECS_PREDICATE_FLOAT(double) break;
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+/* Evaluate predicates for a block of rows. Returns false if the predicate of a
+ * shared component fails, in which case none of the rows match. */
+static
+bool flecs_filter_predicate_block(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_table_t *table,
+    const ecs_id_t *ids,
+    const int32_t *columns,
+    const ecs_entity_t *sources,
+    int32_t row,
+    int32_t count,
+    uint8_t *sel)
+{
+    ecs_term_t *terms = filter->terms;
+    int32_t t, term_count = filter->term_count;
+
+    ecs_os_memset(sel, 1, count);
+
+    for (t = 0; t < term_count; t ++) {
+        ecs_term_t *term = &terms[t];
+        if (!term->predicate.kind) {
+            continue;
+        }
+
+        int32_t field = term->field_index;
+        int32_t column = columns[field];
+        ecs_entity_t src = sources[field];
+        const void *ptr;
+        ecs_size_t stride;
+
+        if (column > 0 && !src) {
+            int32_t storage_column = ecs_table_type_to_storage_index(
+                table, column - 1);
+            ecs_assert(storage_column != -1, ECS_INTERNAL_ERROR, NULL);
+            stride = table->type_info[storage_column]->size;
+            ptr = ECS_ELEM(ecs_vec_first(
+                &table->data.columns[storage_column]), stride, row);
+        } else {
+            /* Shared component, value is the same for all rows */
+            ptr = src ? ecs_get_id(world, src, ids[field]) : NULL;
+            if (!ptr) {
+                return false;
+            }
+            stride = 0;
+        }
+
+        flecs_predicate_eval(&term->predicate, 
+            ECS_OFFSET(ptr, term->predicate.offset), stride, count, sel);
+    }
+
+    return true;
+}
+
+int32_t flecs_filter_rows_next(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_table_t *table,
+    const ecs_id_t *ids,
+    const int32_t *columns,
+    const ecs_entity_t *sources,
+    flecs_row_select_action_t select,
+    void *select_ctx,
+    int32_t *row,
+    int32_t end,
+    int32_t *count_out)
+{
+    uint8_t sel[FLECS_ROW_BLOCK_SIZE];
+    int32_t cur = *row, first = -1;
+
+    while (cur < end) {
+        int32_t i = 0, count = ECS_MIN(end - cur, FLECS_ROW_BLOCK_SIZE);
+        if (!flecs_filter_predicate_block(world, filter, table, ids, columns, 
+            sources, cur, count, sel))
+        {
+            break;
+        }
+
+        if (select && !select(select_ctx, cur, count, sel)) {
+            break;
+        }
+
+        if (first == -1) {
+            /* Find start of range */
+            for (; i < count && !sel[i]; i ++) { }
+            if (i == count) {
+                cur += count;
+                continue;
+            }
+            first = cur + i;
+        }
+
+        /* Find end of range, which may continue into the next block */
+        for (; i < count && sel[i]; i ++) { }
+        if (i != count) {
+            *row = cur + i;
+            *count_out = cur + i - first;
+            return first;
+        }
+
+        cur += count;
+    }
+
+    *row = end;
+    if (first != -1) {
+        *count_out = end - first;
+    }
+    
+    return first;
+}
+
 static
 void term_iter_init_no_data(
     ecs_term_iter_t *iter)
@@ -43844,6 +51762,318 @@ error:
     return -2;
 }
 
+/* Does term only match tables that are in the table cache of its id */
+static
+bool flecs_filter_term_is_self(
+    const ecs_world_t *world,
+    const ecs_term_t *term)
+{
+    ecs_flags32_t trav_flags = term->src.flags & EcsTraverseFlags;
+    if (trav_flags != EcsSelf) {
+        /* Up(IsA) is equivalent to Self when there are no IsA relationships */
+        if (trav_flags != (EcsSelf|EcsUp) || term->src.trav != EcsIsA) {
+            return false;
+        }
+        const ecs_id_record_t *idr_isa = world->idr_isa_wildcard;
+        if (idr_isa && (flecs_table_cache_count(&idr_isa->cache) || 
+            flecs_table_cache_empty_count(&idr_isa->cache)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Max number of tables of the smallest term that are tested against the other
+ * terms when estimating the cardinality of a filter. */
+#define FLECS_ESTIMATE_SAMPLE_COUNT (32)
+
+ecs_estimate_t flecs_filter_estimate(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter,
+    bool match_vars)
+{
+    ecs_estimate_t result = {0};
+    world = ecs_get_world(world);
+
+    ecs_term_t *terms = filter->terms;
+    int32_t i, term_count = filter->term_count;
+    bool match_empty = (filter->flags & EcsFilterMatchEmptyTables) != 0;
+    bool has_this = false;
+
+    /* Id records of terms that are tested against the sampled tables */
+    ecs_id_record_t *idrs[ECS_TERM_DESC_CACHE_SIZE];
+    bool is_not[ECS_TERM_DESC_CACHE_SIZE];
+    int32_t idr_count = 0, min_count = 0;
+    ecs_id_record_t *min_idr = NULL;
+
+    for (i = 0; i < term_count; i ++) {
+        ecs_term_t *term = &terms[i];
+        if (ecs_term_match_this(term)) {
+            has_this = true;
+        } else if (!match_vars || !(term->src.flags & EcsIsVariable)) {
+            continue;
+        }
+
+        ecs_oper_kind_t oper = term->oper;
+        if (oper != EcsAnd && oper != EcsNot) {
+            continue;
+        }
+
+        ecs_id_record_t *idr = flecs_query_id_record_get(world, term->id);
+        if (!idr) {
+            if (oper == EcsAnd) {
+                /* Nothing can match a term for an id without tables */
+                return result;
+            }
+            continue;
+        }
+
+        /* Terms that traverse relationships also match tables that are not
+         * in the table cache of the id, so they can't constrain the result */
+        if (!flecs_filter_term_is_self(world, term)) {
+            continue;
+        }
+
+        if (oper == EcsAnd) {
+            /* Tables are moved between the empty and non-empty lists of the 
+             * cache when the world processes pending tables, so use both */
+            int32_t count = flecs_table_cache_count(&idr->cache) + 
+                flecs_table_cache_empty_count(&idr->cache);
+            if (!min_idr || count < min_count) {
+                min_idr = idr;
+                min_count = count;
+            }
+        }
+
+        if (idr_count < ECS_TERM_DESC_CACHE_SIZE) {
+            is_not[idr_count] = oper == EcsNot;
+            idrs[idr_count ++] = idr;
+        }
+    }
+
+    if (!has_this && !match_vars) {
+        /* Filters without This terms yield one result without entities */
+        result.table_count = result.max_table_count = 1;
+        return result;
+    }
+
+    if (!min_idr) {
+        result.table_count = result.max_table_count = 
+            flecs_sparse_count(&world->store.tables);
+        result.entity_count = result.max_entity_count = 
+            flecs_entities_count(world);
+        return result;
+    }
+
+    /* Upper bounds are the tables and entities of the smallest term. The 
+     * first tables are tested against the other terms, and the fraction that
+     * matches is used to scale the upper bounds. */
+    int32_t sample_tables = 0, sample_entities = 0;
+    int32_t match_tables = 0, match_entities = 0;
+
+    ecs_table_cache_iter_t it;
+    if (flecs_table_cache_all_iter(&min_idr->cache, &it)) {
+        const ecs_table_record_t *tr;
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            ecs_table_t *table = tr->hdr.table;
+            int32_t count = ecs_table_count(table);
+            if (!count && !match_empty) {
+                continue;
+            }
+
+            result.max_table_count ++;
+            result.max_entity_count += count;
+
+            if (sample_tables == FLECS_ESTIMATE_SAMPLE_COUNT) {
+                continue;
+            }
+
+            sample_tables ++;
+            sample_entities += count;
+
+            int32_t t;
+            for (t = 0; t < idr_count; t ++) {
+                bool has = idrs[t] == min_idr || 
+                    flecs_id_record_get_table(idrs[t], table) != NULL;
+                if (has == is_not[t]) {
+                    break;
+                }
+            }
+
+            if (t == idr_count) {
+                match_tables ++;
+                match_entities += count;
+            }
+        }
+    }
+
+    if (sample_tables) {
+        result.table_count = (int32_t)((int64_t)result.max_table_count * 
+            match_tables / sample_tables);
+    }
+    if (sample_entities) {
+        result.entity_count = (int32_t)((int64_t)result.max_entity_count * 
+            match_entities / sample_entities);
+    }
+
+    return result;
+}
+
+ecs_estimate_t ecs_filter_estimate(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(filter != NULL, ECS_INVALID_PARAMETER, NULL);
+    return flecs_filter_estimate(world, filter, false);
+error:
+    return (ecs_estimate_t){0};
+}
+
+/* Can the tables of term be found by intersecting sorted table lists */
+static
+ecs_id_record_t* flecs_filter_intersect_idr(
+    const ecs_world_t *world,
+    const ecs_term_t *term)
+{
+    if (term->oper != EcsAnd || !ecs_term_match_this(term)) {
+        return NULL;
+    }
+
+    if (!flecs_filter_term_is_self(world, term)) {
+        return NULL;
+    }
+
+    ecs_id_t id = term->id;
+    if (ecs_id_is_wildcard(id)) {
+        return NULL;
+    }
+
+    if (ECS_IS_PAIR(id)) {
+        /* Union pairs are not stored in tables with their actual id */
+        ecs_id_record_t *idr_r = flecs_id_record_get(world, 
+            ecs_pair(ECS_PAIR_FIRST(id), EcsWildcard));
+        if (idr_r && (idr_r->flags & EcsIdUnion)) {
+            return NULL;
+        }
+    } else if (id & ECS_ID_FLAGS_MASK) {
+        return NULL;
+    }
+
+    return flecs_id_record_get(world, id);
+}
+
+/* If a filter has multiple terms that are matched on $this by id, candidate
+ * tables are found by intersecting the sorted table lists of their id records
+ * instead of testing all tables of the pivot term against the other terms. */
+static
+void flecs_filter_intersect_init(
+    const ecs_world_t *world,
+    ecs_iter_t *it,
+    ecs_stack_t *stack)
+{
+    ecs_filter_iter_t *iter = &it->priv.iter.filter;
+    const ecs_filter_t *filter = iter->filter;
+    int32_t pivot_term = iter->pivot_term;
+    if (pivot_term < 0) {
+        return;
+    }
+
+    ecs_term_t *terms = filter->terms;
+    ecs_id_record_t *pivot_idr = flecs_filter_intersect_idr(
+        world, &terms[pivot_term]);
+    if (!pivot_idr) {
+        return;
+    }
+
+    int32_t i, count = 0, term_count = filter->term_count;
+    for (i = 0; i < term_count; i ++) {
+        if (flecs_filter_intersect_idr(world, &terms[i])) {
+            count ++;
+        }
+    }
+
+    if (count < 2) {
+        return;
+    }
+
+    /* Pivot term goes first, as it has the fewest tables */
+    iter->intersect_idrs = flecs_stack_alloc_n(stack, ecs_id_record_t*, count);
+    iter->intersect_pos = flecs_stack_calloc_n(stack, int32_t, count);
+    iter->intersect_idrs[0] = pivot_idr;
+    iter->intersect_count = 1;
+
+    for (i = 0; i < term_count; i ++) {
+        ecs_id_record_t *idr = flecs_filter_intersect_idr(world, &terms[i]);
+        if (idr && idr != pivot_idr) {
+            iter->intersect_idrs[iter->intersect_count ++] = idr;
+        }
+    }
+}
+
+/* Skip tables that the regular table iterator would also skip */
+static
+bool flecs_filter_intersect_valid(
+    const ecs_filter_t *filter,
+    const ecs_table_t *table)
+{
+    ecs_flags32_t flags = filter->flags;
+    if (!(flags & EcsFilterMatchEmptyTables) && !ecs_table_count(table)) {
+        return false;
+    }
+    if (!(flags & EcsFilterMatchPrefab) && (table->flags & EcsTableIsPrefab)) {
+        return false;
+    }
+    if (!(flags & EcsFilterMatchDisabled) && 
+        (table->flags & EcsTableIsDisabled)) 
+    {
+        return false;
+    }
+    return true;
+}
+
+/* Find next table that is in the sorted table lists of all intersected id 
+ * records. Lists are advanced with galloping search, so that large ranges of
+ * tables that don't match are skipped without testing them. */
+static
+ecs_table_t* flecs_filter_intersect_next(
+    ecs_filter_iter_t *iter)
+{
+    ecs_id_record_t **idrs = iter->intersect_idrs;
+    int32_t *pos = iter->intersect_pos;
+    int32_t i = 0, agree = 0, count = iter->intersect_count;
+    ecs_table_t *candidate = NULL;
+
+    do {
+        const ecs_vec_t *v = &idrs[i]->sorted_tables;
+        int32_t cur = pos[i];
+        if (candidate) {
+            cur = pos[i] = flecs_id_record_sorted_seek(
+                idrs[i], cur, candidate->id);
+        }
+
+        if (cur >= ecs_vec_count(v)) {
+            return NULL;
+        }
+
+        ecs_table_t *table = ecs_vec_get_t(v, ecs_table_t*, cur)[0];
+        if (table == candidate) {
+            agree ++;
+        } else {
+            candidate = table;
+            agree = 1;
+        }
+
+        i = (i + 1) % count;
+    } while (agree < count);
+
+    /* Move first list past the candidate for the next call */
+    pos[0] ++;
+
+    return candidate;
+}
+
 ecs_iter_t flecs_filter_iter_w_flags(
     const ecs_world_t *stage,
     const ecs_filter_t *filter,
@@ -43918,6 +52148,36 @@ ecs_iter_t flecs_filter_iter_w_flags(
 
     flecs_iter_init(stage, &it, flecs_iter_cache_all);
 
+    if (iter->kind == EcsIterEvalTables) {
+        ecs_stage_t *s = flecs_stage_from_world((ecs_world_t**)&stage);
+        flecs_filter_intersect_init(world, &it, &s->allocators.iter_stack);
+
+#ifdef FLECS_META
+        /* If a predicate has an index, iterate the entities in the index. The
+         * iterator falls back to tables if predicates are ignored or if the 
+         * This variable is constrained, which is only known after this. */
+        if (iter->pivot_term != -2 && 
+            ECS_BIT_IS_SET(filter->flags, EcsFilterHasPredicates)) 
+        {
+            int32_t i;
+            for (i = 0; i < filter->term_count; i ++) {
+                ecs_term_t *term = &filter->terms[i];
+                if (!term->predicate.index) {
+                    continue;
+                }
+
+                if (!flecs_member_index_iter_predicate(world, 
+                    term->predicate.index, ecs_get_typeid(world, term->id),
+                    &term->predicate, &iter->index_iter))
+                {
+                    iter->kind = EcsIterEvalIndex;
+                }
+                break;
+            }
+        }
+#endif
+    }
+
     return it;
 error:
     return (ecs_iter_t){ 0 };
@@ -43982,8 +52242,34 @@ bool ecs_filter_next_instanced(
 
     flecs_iter_validate(it);
 
-    ecs_iter_t *chain_it = it->chain_it;
-    ecs_iter_kind_t kind = iter->kind;
+    if (iter->predicate_row < iter->predicate_end) {
+        /* Yield remaining rows of the previous result that pass predicates */
+        int32_t count, offset = flecs_filter_rows_next(world, filter, 
+            it->table, it->ids, it->columns, it->sources, NULL, NULL,
+            &iter->predicate_row, iter->predicate_end, &count);
+        if (offset != -1) {
+            flecs_iter_populate_data(world, it, it->table, offset, count, 
+                it->ptrs, it->sizes);
+            ECS_BIT_SET(it->flags, EcsIterIsValid);
+            return true;
+        }
+    }
+
+    ecs_iter_t *chain_it;
+    ecs_iter_kind_t kind;
+    int32_t row = 0, row_count;
+repeat:
+    chain_it = it->chain_it;
+    kind = iter->kind;
+    row_count = -1; /* Yield all rows of table */
+
+    if (kind == EcsIterEvalIndex) {
+        if (ECS_BIT_IS_SET(it->flags, EcsIterIgnorePredicates) ||
+            (it->variable_count && ecs_iter_var_is_constrained(it, 0)))
+        {
+            iter->kind = kind = EcsIterEvalTables;
+        }
+    }
 
     if (chain_it) {
         ecs_assert(kind == EcsIterEvalChain, ECS_INVALID_PARAMETER, NULL);
@@ -44001,7 +52287,32 @@ bool ecs_filter_next_instanced(
                 true, -1, it->flags);
         } while (!match);
 
+        /* Only yield the rows provided by the chained iterator, which allows 
+         * the chained iterator to select a subset of a table */
+        row = chain_it->offset;
+        row_count = chain_it->count;
         goto yield;
+#ifdef FLECS_META
+    } else if (kind == EcsIterEvalIndex) {
+        do {
+            if (!flecs_member_index_iter_next(world, &iter->index_iter, 
+                &table, &row, &row_count))
+            {
+                goto done;
+            }
+
+            if (!flecs_filter_intersect_valid(filter, table)) {
+                continue;
+            }
+
+            match = flecs_filter_match_table(world, filter, table,
+                it->ids, it->columns, it->sources, it->match_indices, NULL, 
+                true, -1, it->flags);
+        } while (!match);
+
+        it->variables[0].range.table = table;
+        goto yield;
+#endif
     } else if (kind == EcsIterEvalTables || kind == EcsIterEvalCondition) {
         ecs_term_iter_t *term_iter = &iter->term_iter;
         ecs_term_t *term = &term_iter->term;
@@ -44056,6 +52367,22 @@ bool ecs_filter_next_instanced(
                         ecs_assert(term_iter->table == this_table,
                             ECS_INTERNAL_ERROR, NULL);
 
+                    /* If filter has multiple terms that can be intersected, 
+                     * find the next table that has all of their ids */
+                    } else if (iter->intersect_count) {
+                        do {
+                            table = flecs_filter_intersect_next(iter);
+                            if (!table) {
+                                goto done;
+                            }
+                        } while (!flecs_filter_intersect_valid(filter, table));
+
+                        if (!flecs_term_iter_set_table(
+                            world, term_iter, table))
+                        {
+                            ecs_abort(ECS_INTERNAL_ERROR, NULL);
+                        }
+
                     /* If This variable is not constrained, iterate as usual */
                     } else {
                         /* Find new match, starting with the leading term */
@@ -44181,12 +52508,34 @@ error:
     ecs_iter_fini(it);
     return false;
 
-yield:
-    it->offset = 0;
-    flecs_iter_populate_data(world, it, table, 0, 
-        table ? ecs_table_count(table) : 0, it->ptrs, it->sizes);
-    ECS_BIT_SET(it->flags, EcsIterIsValid);
-    return true;    
+yield: {
+        int32_t offset = 0, count = table ? ecs_table_count(table) : 0;
+        if (row_count != -1) {
+            offset = row;
+            count = row_count;
+        }
+
+        if (table && ECS_BIT_IS_SET(filter->flags, EcsFilterHasPredicates) &&
+            !ECS_BIT_IS_SET(it->flags, EcsIterIgnorePredicates)) 
+        {
+            /* Only yield ranges of rows that pass the predicates */
+            iter->predicate_row = offset;
+            iter->predicate_end = offset + count;
+            offset = flecs_filter_rows_next(world, filter, table, 
+                it->ids, it->columns, it->sources, NULL, NULL,
+                &iter->predicate_row, 
+                iter->predicate_end, &count);
+            if (offset == -1) {
+                goto repeat;
+            }
+        }
+
+        it->offset = offset;
+        flecs_iter_populate_data(world, it, table, offset, count, 
+            it->ptrs, it->sizes);
+        ECS_BIT_SET(it->flags, EcsIterIsValid);
+        return true;
+    }
 }
 
 
@@ -44779,6 +53128,12 @@ void flecs_observer_invoke(
 {
     ecs_assert(it->callback != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_table_lock(it->world, table);
+
+#ifdef FLECS_TRACING
+    ecs_stage_t *stage = ecs_poly_is(it->world, ecs_stage_t) 
+        ? (ecs_stage_t*)it->world : &world->stages[0];
+    flecs_trace_begin(stage, EcsTraceObserver, it->system);
+#endif
     if (ecs_should_log_3()) {
         char *path = ecs_get_fullpath(world, it->system);
         ecs_dbg_3("observer: invoke %s", path);
@@ -44830,6 +53185,8 @@ void flecs_observer_invoke(
 
     ecs_log_pop_3();
     ecs_table_unlock(it->world, table);
+
+    flecs_trace_end(stage, EcsTraceObserver, it->system);
 }
 
 static
@@ -46824,19 +55181,47 @@ bool flecs_query_check_match_monitor_term(
     return monitor[term] != cur.dirty_state[cur.column + 1];
 }
 
-/* Check if any term for match has changed */
+/* Check if shared field has changed */
 static
-bool flecs_query_check_match_monitor(
-    ecs_query_t *query,
-    ecs_query_table_match_t *match)
+bool flecs_query_check_shared_monitor(
+    ecs_world_t *world,
+    ecs_query_table_match_t *match,
+    int32_t field,
+    int32_t mon)
 {
-    ecs_assert(match != NULL, ECS_INTERNAL_ERROR, NULL);
+    int32_t column = match->columns[field];
+    if (!column) {
+        /* Not matched */
+        return false;
+    }
 
-    if (flecs_query_get_match_monitor(query, match)) {
-        return true;
+    ecs_assert(column < 0, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t ref_index = -column - 1;
+    ecs_ref_t *ref = ecs_vec_get_t(&match->refs, ecs_ref_t, ref_index);
+    if (ref->id != 0) {
+        ecs_ref_update(world, ref);
+        ecs_table_record_t *tr = ref->tr;
+        ecs_table_t *src_table = tr->hdr.table;
+        column = tr->column;
+        column = ecs_table_type_to_storage_index(src_table, column);
+        int32_t *src_dirty_state = flecs_table_get_dirty_state(
+            world, src_table);
+        if (mon != src_dirty_state[column + 1]) {
+            return true;
+        }
     }
 
-    int32_t *monitor = match->monitor;
+    return false;
+}
+
+/* Check if any term for match has changed since monitor was synchronized */
+static
+bool flecs_query_check_monitor(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match,
+    const int32_t *monitor)
+{
     ecs_table_t *table = match->node.table;
     int32_t *dirty_state = flecs_table_get_dirty_state(query->world, table);
     ecs_assert(dirty_state != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -46848,8 +55233,6 @@ bool flecs_query_check_match_monitor(
     ecs_world_t *world = query->world;
     int32_t i, field_count = query->filter.field_count;
     int32_t *storage_columns = match->storage_columns;
-    int32_t *columns = match->columns;
-    ecs_vec_t *refs = &match->refs;
     for (i = 0; i < field_count; i ++) {
         int32_t mon = monitor[i + 1];
         if (mon == -1) {
@@ -46867,41 +55250,134 @@ bool flecs_query_check_match_monitor(
             continue; /* owned but not a component */
         }
 
-        column = columns[i];
-        if (!column) {
-            /* Not matched */
-            continue;
+        if (flecs_query_check_shared_monitor(world, match, i, mon)) {
+            return true;
         }
+    }
 
-        ecs_assert(column < 0, ECS_INTERNAL_ERROR, NULL);
+    return false;
+}
 
-        int32_t ref_index = -column - 1;
-        ecs_ref_t *ref = ecs_vec_get_t(refs, ecs_ref_t, ref_index);
-        if (ref->id != 0) {
-            ecs_ref_update(world, ref);
-            ecs_table_record_t *tr = ref->tr;
-            ecs_table_t *src_table = tr->hdr.table;
-            column = tr->column;
-            column = ecs_table_type_to_storage_index(src_table, column);
-            int32_t *src_dirty_state = flecs_table_get_dirty_state(
-                world, src_table);
-            if (mon != src_dirty_state[column + 1]) {
-                return true;
+/* Check if any term for match has changed */
+static
+bool flecs_query_check_match_monitor(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match)
+{
+    ecs_assert(match != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (flecs_query_get_match_monitor(query, match)) {
+        return true;
+    }
+
+    return flecs_query_check_monitor(query, match, match->monitor);
+}
+
+/* Store the match monitor before iterating the changed rows of a match. The
+ * match monitor is synchronized after each result, while all results for the
+ * match should be tested against the state from before the first result. */
+static
+void flecs_query_init_changed_monitor(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match)
+{
+    if (!match->changed_monitor) {
+        match->changed_monitor = flecs_balloc(&query->allocators.monitors);
+    }
+
+    /* If the match didn't have a monitor yet, the new monitor has 0 for all
+     * fields, which is lower than any column or row state. */
+    flecs_query_get_match_monitor(query, match);
+    int32_t field_count = query->filter.field_count;
+    ecs_os_memcpy_n(match->changed_monitor, match->monitor, int32_t, 
+        (field_count + 1));
+}
+
+typedef struct {
+    const ecs_world_t *stage;
+    ecs_query_t *query;
+    ecs_query_table_match_t *match;
+} flecs_query_select_ctx_t;
+
+/* Deselect rows for which none of the monitored fields changed */
+static
+bool flecs_query_select_changed(
+    void *ctx,
+    int32_t row,
+    int32_t count,
+    uint8_t *sel)
+{
+    flecs_query_select_ctx_t *select_ctx = ctx;
+    ecs_query_t *query = select_ctx->query;
+    ecs_query_table_match_t *match = select_ctx->match;
+    ecs_table_t *table = match->node.table;
+    const int32_t *monitor = match->changed_monitor;
+    ecs_vec_t *rows = table->dirty_rows;
+    bool monitored = false;
+    flecs_query_counter_add(select_ctx->stage, query, change_check_count, 1);
+
+    if (rows) {
+        uint8_t changed[FLECS_ROW_BLOCK_SIZE] = {0};
+        ecs_assert(count <= FLECS_ROW_BLOCK_SIZE, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(ecs_vec_count(rows) == ecs_table_count(table), 
+            ECS_INTERNAL_ERROR, NULL);
+
+        ecs_world_t *world = query->world;
+        int32_t i, field_count = query->filter.field_count;
+        int32_t column_count = table->storage_count;
+        int32_t *storage_columns = match->storage_columns;
+        const int32_t *states = ECS_ELEM_T(ecs_vec_first(rows), int32_t, 
+            row * column_count);
+
+        for (i = 0; i < field_count; i ++) {
+            int32_t mon = monitor[i + 1];
+            if (mon == -1) {
+                continue;
+            }
+
+            int32_t r, column = storage_columns[i];
+            if (column >= 0) {
+                for (r = 0; r < count; r ++) {
+                    changed[r] |= (uint8_t)(
+                        states[r * column_count + column] > mon);
+                }
+                monitored = true;
+            } else if (column != -1) {
+                if (flecs_query_check_shared_monitor(world, match, i, mon)) {
+                    /* Shared component changed, which changes all rows */
+                    return true;
+                }
+            }
+        }
+
+        if (monitored) {
+            for (i = 0; i < count; i ++) {
+                sel[i] &= changed[i];
             }
+            return true;
         }
     }
 
-    return false;
+    /* If rows aren't tracked, all rows changed if the table changed */
+    if (!flecs_query_check_monitor(query, match, monitor)) {
+        ecs_os_memset(sel, 0, count);
+        return false;
+    }
+
+    return true;
 }
 
 /* Check if any term for matched table has changed */
 static
 bool flecs_query_check_table_monitor(
+    const ecs_world_t *stage,
     ecs_query_t *query,
     ecs_query_table_t *table,
     int32_t term)
 {
     ecs_query_table_node_t *cur, *end = table->last->node.next;
+    flecs_query_counter_add(stage, query, change_check_count, 1);
+    (void)stage;
 
     for (cur = &table->first->node; cur != end; cur = cur->next) {
         ecs_query_table_match_t *match = (ecs_query_table_match_t*)cur;
@@ -46927,7 +55403,9 @@ bool flecs_query_check_query_monitor(
     if (flecs_table_cache_iter(&query->cache, &it)) {
         ecs_query_table_t *qt;
         while ((qt = flecs_table_cache_next(&it, ecs_query_table_t))) {
-            if (flecs_query_check_table_monitor(query, qt, -1)) {
+            if (flecs_query_check_table_monitor(
+                query->world, query, qt, -1)) 
+            {
                 return true;
             }
         }
@@ -47008,6 +55486,10 @@ ecs_query_table_match_t* flecs_query_add_table_match(
     qm->sources = flecs_balloc(&query->allocators.sources);
     qm->sizes = flecs_balloc(&query->allocators.sizes);
 
+    if (table && (query->flags & EcsQueryTrackRows)) {
+        flecs_table_track_rows(query->world, table);
+    }
+
     /* Insert match to iteration list if table is not empty */
     if (!table || ecs_table_count(table) != 0) {
         flecs_query_insert_table_node(query, &qm->node);
@@ -47107,6 +55589,9 @@ void flecs_query_set_table_match(
                         &qm->bitset_columns, flecs_bitset_term_t);
                     bc->column_index = bs_index;
                     bc->bs_column = NULL;
+
+                    /* Fast path iterator doesn't check for disabled fields */
+                    query->flags &= ~EcsQueryIsTrivial;
                 }
             }
         }
@@ -47132,6 +55617,7 @@ void flecs_query_set_table_match(
 
             if (id) {
                 flecs_query_add_ref(world, query, qm, id, src, size);
+                query->flags &= ~EcsQueryIsTrivial;
 
                 /* Use column index to bind term and ref */
                 if (qm->columns[field] != 0) {
@@ -47155,6 +55641,7 @@ void flecs_query_match_tables(
     ECS_BIT_SET(it.flags, EcsIterIsInstanced);
     ECS_BIT_SET(it.flags, EcsIterIsFilter);
     ECS_BIT_SET(it.flags, EcsIterEntityOptional);
+    ECS_BIT_SET(it.flags, EcsIterIgnorePredicates);
 
     while (ecs_filter_next(&it)) {
         if ((table != it.table) || (!it.table && !qt)) {
@@ -47187,8 +55674,11 @@ bool flecs_query_match_table(
         return false;
     }
 
+    world->info.table_match_total ++;
+
     ecs_iter_t it = flecs_filter_iter_w_flags(world, filter, EcsIterMatchVar|
-        EcsIterIsInstanced|EcsIterIsFilter|EcsIterEntityOptional);
+        EcsIterIsInstanced|EcsIterIsFilter|EcsIterEntityOptional|
+        EcsIterIgnorePredicates);
     ecs_iter_set_var_as_table(&it, var_id, table);
 
     while (ecs_filter_next(&it)) {
@@ -47445,6 +55935,7 @@ void flecs_query_build_sorted_tables(
 static
 void flecs_query_sort_tables(
     ecs_world_t *world,
+    const ecs_world_t *stage,
     ecs_query_t *query)
 {
     ecs_order_by_action_t compare = query->order_by;
@@ -47452,6 +55943,14 @@ void flecs_query_sort_tables(
         return;
     }
 
+#ifdef FLECS_QUERY_COUNTERS
+    ecs_time_t t = {0};
+    bool measure_time = ecs_os_has_time();
+    if (measure_time) {
+        ecs_time_measure(&t);
+    }
+#endif
+
     ecs_sort_table_action_t sort = query->sort_table;
     
     ecs_entity_t order_by_component = query->order_by_component;
@@ -47489,13 +55988,15 @@ void flecs_query_sort_tables(
         ecs_table_t *table = qt->hdr.table;
         bool dirty = false;
 
-        if (flecs_query_check_table_monitor(query, qt, 0)) {
+        if (flecs_query_check_table_monitor(stage, query, qt, 0)) {
             dirty = true;
         }
 
         int32_t column = -1;
         if (order_by_component) {
-            if (flecs_query_check_table_monitor(query, qt, order_by_term + 1)) {
+            if (flecs_query_check_table_monitor(
+                stage, query, qt, order_by_term + 1)) 
+            {
                 dirty = true;
             }
 
@@ -47528,6 +56029,13 @@ void flecs_query_sort_tables(
         flecs_query_build_sorted_tables(query);
         query->match_count ++; /* Increase version if tables changed */
     }
+
+#ifdef FLECS_QUERY_COUNTERS
+    if (measure_time) {
+        flecs_query_counter_add(stage, query, sort_time, 
+            (ecs_ftime_t)ecs_time_measure(&t));
+    }
+#endif
 }
 
 static
@@ -47740,6 +56248,9 @@ void flecs_query_table_match_free(
         if (cur->monitor) {
             flecs_bfree(&query->allocators.monitors, cur->monitor);
         }
+        if (cur->changed_monitor) {
+            flecs_bfree(&query->allocators.monitors, cur->changed_monitor);
+        }
         if (cur->refs.array) {
             ecs_allocator_t *a = &query->world->allocator;
             ecs_vec_fini_t(a, &cur->refs, ecs_ref_t);
@@ -47801,12 +56312,17 @@ void flecs_query_rematch_tables(
     ECS_BIT_SET(it.flags, EcsIterIsInstanced);
     ECS_BIT_SET(it.flags, EcsIterIsFilter);
     ECS_BIT_SET(it.flags, EcsIterEntityOptional);
+    ECS_BIT_SET(it.flags, EcsIterIgnorePredicates);
 
     world->info.rematch_count_total ++;
     int32_t rematch_count = ++ query->rematch_count;
 
     ecs_time_t t = {0};
-    if (world->flags & EcsWorldMeasureFrameTime) {
+    bool measure_time = (world->flags & EcsWorldMeasureFrameTime) != 0;
+#ifdef FLECS_QUERY_COUNTERS
+    measure_time |= ecs_os_has_time();
+#endif
+    if (measure_time) {
         ecs_time_measure(&t);
     }
 
@@ -47864,8 +56380,12 @@ void flecs_query_rematch_tables(
         }
     }
 
-    if (world->flags & EcsWorldMeasureFrameTime) {
-        world->info.rematch_time_total += (ecs_ftime_t)ecs_time_measure(&t);
+    if (measure_time) {
+        ecs_ftime_t rematch_time = (ecs_ftime_t)ecs_time_measure(&t);
+        if (world->flags & EcsWorldMeasureFrameTime) {
+            world->info.rematch_time_total += rematch_time;
+        }
+        flecs_query_counter_add(world, query, rematch_time, rematch_time);
     }
 }
 
@@ -47892,6 +56412,399 @@ void flecs_query_remove_subquery(
 
 /* -- Private API -- */
 
+/* Get id that a table must have for a term to match, or 0 if there is no such
+ * id. Tables store records for wildcard pairs, but union relationships are
+ * stored as (Union, Relationship), which can't be matched by relationship. */
+static
+ecs_id_t flecs_query_index_term_id(
+    ecs_world_t *world,
+    const ecs_term_t *term)
+{
+    ecs_id_t id = term->id;
+    if (!id || id == EcsWildcard || id == EcsAny) {
+        return 0;
+    }
+
+    if (ECS_IS_PAIR(id)) {
+        ecs_entity_t first = ECS_PAIR_FIRST(id);
+        ecs_entity_t second = ECS_PAIR_SECOND(id);
+        if (first == EcsWildcard || first == EcsAny || second == EcsAny) {
+            return 0;
+        }
+
+        first = ecs_get_alive(world, first);
+        if (first && ecs_has_id(world, first, EcsUnion)) {
+            return 0;
+        }
+    } else if (id & ECS_ID_FLAGS_MASK) {
+        return 0;
+    }
+
+    return id;
+}
+
+/** A query is trivial if it only has And terms that match components on $this
+ * by id, without predicates or sorting. Results of such a query only need the
+ * table, count and column pointers, which lets the iterator skip the generic
+ * code that deals with sparse columns, bitsets and references. Terms may still
+ * traverse relationships: the flag is cleared when a table is matched that
+ * needs references or bitsets, after which the query uses the regular path. */
+static
+bool flecs_query_is_trivial(
+    ecs_world_t *world,
+    const ecs_query_t *query,
+    const ecs_query_desc_t *desc)
+{
+    const ecs_filter_t *filter = &query->filter;
+    if (!filter->term_count || desc->order_by) {
+        return false;
+    }
+
+    if (!(filter->flags & EcsFilterMatchOnlyThis)) {
+        return false;
+    }
+
+    if (filter->flags & EcsFilterHasPredicates) {
+        return false;
+    }
+
+    if (query->cascade_by) {
+        return false;
+    }
+
+    int32_t i, count = filter->term_count;
+    for (i = 0; i < count; i ++) {
+        ecs_term_t *term = &filter->terms[i];
+        if (term->oper != EcsAnd) {
+            return false;
+        }
+        if (!ecs_term_match_this(term)) {
+            return false;
+        }
+        if (term->src.flags & EcsDown) {
+            return false;
+        }
+        if (flecs_query_index_term_id(world, term) != term->id) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static
+int32_t flecs_query_index_id_table_count(
+    ecs_world_t *world,
+    ecs_id_t id)
+{
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr) {
+        return 0;
+    }
+
+    return flecs_table_cache_count(&idr->cache) + 
+        flecs_table_cache_empty_count(&idr->cache);
+}
+
+static
+void flecs_query_index_register(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_id_t id)
+{
+    ecs_vec_t *queries = ecs_map_ensure(&world->query_index, ecs_vec_t, id);
+    if (!queries->array) {
+        ecs_vec_init_t(&world->allocator, queries, ecs_query_t*, 0);
+    }
+    ecs_vec_append_t(&world->allocator, queries, ecs_query_t*)[0] = query;
+}
+
+/* Remove query from index vector. While the index is being notified, the
+ * query is replaced with NULL so that the notify loop doesn't skip queries, 
+ * and the vector is compacted after notifying. */
+static
+void flecs_query_index_unregister(
+    ecs_world_t *world,
+    ecs_vec_t *queries,
+    ecs_query_t *query)
+{
+    ecs_query_t **array = ecs_vec_first(queries);
+    int32_t i, count = ecs_vec_count(queries);
+    for (i = 0; i < count; i ++) {
+        if (array[i] == query) {
+            if (world->query_index_notifying) {
+                array[i] = NULL;
+                world->query_index_dirty = true;
+            } else {
+                ecs_vec_remove_t(queries, ecs_query_t*, i);
+            }
+            return;
+        }
+    }
+}
+
+/* Add query to index vectors */
+static
+void flecs_query_index_insert(
+    ecs_world_t *world,
+    ecs_query_t *query)
+{
+    if (!query->index_ids[0] && !query->index_ids[1]) {
+        ecs_vec_append_t(&world->allocator, &world->unindexed_queries, 
+            ecs_query_t*)[0] = query;
+    } else {
+        int32_t i;
+        for (i = 0; i < 2; i ++) {
+            if (query->index_ids[i]) {
+                flecs_query_index_register(world, query, query->index_ids[i]);
+            }
+        }
+    }
+}
+
+/* Remove NULL entries & empty vectors from index after notifying */
+static
+void flecs_query_index_compact(
+    ecs_world_t *world)
+{
+    ecs_allocator_t *a = &world->allocator;
+    ecs_vec_t empty;
+    ecs_vec_init_t(a, &empty, ecs_id_t, 0);
+
+    ecs_map_iter_t it = ecs_map_iter(&world->query_index);
+    ecs_vec_t *queries;
+    ecs_map_key_t id;
+    while ((queries = ecs_map_next(&it, ecs_vec_t, &id))) {
+        int32_t i;
+        for (i = ecs_vec_count(queries) - 1; i >= 0; i --) {
+            if (!ecs_vec_get_t(queries, ecs_query_t*, i)[0]) {
+                ecs_vec_remove_t(queries, ecs_query_t*, i);
+            }
+        }
+        if (!ecs_vec_count(queries)) {
+            ecs_vec_append_t(a, &empty, ecs_id_t)[0] = id;
+        }
+    }
+
+    ecs_id_t *ids = ecs_vec_first_t(&empty, ecs_id_t);
+    int32_t i, count = ecs_vec_count(&empty);
+    for (i = 0; i < count; i ++) {
+        queries = ecs_map_get(&world->query_index, ecs_vec_t, ids[i]);
+        ecs_vec_fini_t(a, queries, ecs_query_t*);
+        ecs_map_remove(&world->query_index, ids[i]);
+    }
+    ecs_vec_fini_t(a, &empty, ecs_id_t);
+
+    for (i = ecs_vec_count(&world->unindexed_queries) - 1; i >= 0; i --) {
+        if (!ecs_vec_get_t(&world->unindexed_queries, ecs_query_t*, i)[0]) {
+            ecs_vec_remove_t(&world->unindexed_queries, ecs_query_t*, i);
+        }
+    }
+
+    world->query_index_dirty = false;
+}
+
+/* Add query to the index that is used to find the queries that can match a new
+ * table. Queries are indexed by their most selective term, which is the term
+ * with the id that occurs in the fewest tables. Terms that can be matched by
+ * traversing a relationship are indexed by both the id and (Relationship, *),
+ * which a table must have to inherit the id. Queries without And terms for
+ * $this with a (non-wildcard) id are evaluated for each table. */
+static
+void flecs_query_index_add(
+    ecs_world_t *world,
+    ecs_query_t *query)
+{
+    ecs_filter_t *filter = &query->filter;
+    ecs_term_t *terms = filter->terms;
+    int32_t i, term_count = filter->term_count;
+    int32_t best_count = -1;
+    uint64_t bloom = 0;
+
+    for (i = 0; i < term_count; i ++) {
+        ecs_term_t *term = &terms[i];
+        if (term->oper != EcsAnd || !ecs_term_match_this(term)) {
+            continue;
+        }
+
+        ecs_id_t id = flecs_query_index_term_id(world, term);
+        if (!id) {
+            continue;
+        }
+
+        ecs_flags32_t flags = term->src.flags;
+        ecs_id_t keys[2] = {0};
+        int32_t count = 0;
+        if (flags & EcsSelf) {
+            keys[0] = id;
+            count += flecs_query_index_id_table_count(world, id);
+        }
+
+        if (flags & EcsUp) {
+            ecs_assert(term->src.trav != 0, ECS_INTERNAL_ERROR, NULL);
+            keys[1] = ecs_pair(term->src.trav, EcsWildcard);
+            count += flecs_query_index_id_table_count(world, keys[1]);
+        } else {
+            /* Table must have id, add it to query signature */
+            bloom |= flecs_id_bloom(id);
+        }
+
+        if (!keys[0] && !keys[1]) {
+            continue;
+        }
+
+        if (best_count == -1 || count < best_count) {
+            query->index_ids[0] = keys[0];
+            query->index_ids[1] = keys[1];
+            best_count = count;
+        }
+    }
+
+    query->bloom = bloom;
+
+    if (world->query_index_notifying) {
+        /* Registering the query could reallocate the vectors or the map that
+         * are being iterated. The query already matched existing tables, so
+         * it doesn't need to be notified of the current table. */
+        ecs_vec_append_t(&world->allocator, &world->pending_queries, 
+            ecs_query_t*)[0] = query;
+    } else {
+        flecs_query_index_insert(world, query);
+    }
+}
+
+static
+void flecs_query_index_remove(
+    ecs_world_t *world,
+    ecs_query_t *query)
+{
+    /* Query was created while notifying and isn't registered yet */
+    ecs_query_t **pending = ecs_vec_first_t(
+        &world->pending_queries, ecs_query_t*);
+    int32_t i, count = ecs_vec_count(&world->pending_queries);
+    for (i = 0; i < count; i ++) {
+        if (pending[i] == query) {
+            ecs_vec_remove_t(&world->pending_queries, ecs_query_t*, i);
+            return;
+        }
+    }
+
+    if (!query->index_ids[0] && !query->index_ids[1]) {
+        flecs_query_index_unregister(world, &world->unindexed_queries, query);
+        return;
+    }
+
+    for (i = 0; i < 2; i ++) {
+        ecs_id_t id = query->index_ids[i];
+        if (!id) {
+            continue;
+        }
+
+        ecs_vec_t *queries = ecs_map_get(&world->query_index, ecs_vec_t, id);
+        ecs_assert(queries != NULL, ECS_INTERNAL_ERROR, NULL);
+        flecs_query_index_unregister(world, queries, query);
+        if (!world->query_index_notifying && !ecs_vec_count(queries)) {
+            ecs_vec_fini_t(&world->allocator, queries, ecs_query_t*);
+            ecs_map_remove(&world->query_index, id);
+        }
+    }
+}
+
+static
+void flecs_query_index_notify_queries(
+    ecs_world_t *world,
+    ecs_vec_t *queries,
+    ecs_query_event_t *event,
+    int32_t event_id)
+{
+    uint64_t bloom = event->table->bloom;
+    int32_t i;
+
+    /* Notifying a query can run group callbacks that create or delete queries.
+     * While notifying, created queries are added to pending_queries and 
+     * deleted queries are replaced with NULL, so the vector doesn't move. */
+    for (i = 0; i < ecs_vec_count(queries); i ++) {
+        ecs_query_t *query = ecs_vec_get_t(queries, ecs_query_t*, i)[0];
+        if (!query) {
+            continue; /* Query was deleted while notifying */
+        }
+
+        if ((query->bloom & bloom) != query->bloom) {
+            continue; /* Table is missing an id required by the query */
+        }
+
+        if (query->match_event_id == event_id) {
+            continue; /* Already notified through other index id */
+        }
+
+        query->match_event_id = event_id;
+        ecs_poly_assert(query, ecs_query_t);
+        flecs_query_notify(world, query, event);
+    }
+}
+
+void flecs_query_index_notify(
+    ecs_world_t *world,
+    ecs_query_event_t *event)
+{
+    ecs_table_t *table = event->table;
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    int32_t event_id = ++ world->event_id;
+
+    world->query_index_notifying ++;
+
+    flecs_query_index_notify_queries(world, &world->unindexed_queries, 
+        event, event_id);
+
+    /* Table records include wildcard ids, so iterating them finds queries that
+     * are indexed by a wildcard */
+    if (ecs_map_count(&world->query_index)) {
+        int32_t i, count = table->record_count;
+        for (i = 0; i < count; i ++) {
+            ecs_table_record_t *tr = &table->records[i];
+            ecs_id_record_t *idr = (ecs_id_record_t*)tr->hdr.cache;
+            ecs_vec_t *queries = ecs_map_get(
+                &world->query_index, ecs_vec_t, idr->id);
+            if (queries) {
+                flecs_query_index_notify_queries(
+                    world, queries, event, event_id);
+            }
+        }
+    }
+
+    if (-- world->query_index_notifying) {
+        return;
+    }
+
+    /* Apply changes to index that were made while notifying */
+    if (world->query_index_dirty) {
+        flecs_query_index_compact(world);
+    }
+
+    int32_t i, count = ecs_vec_count(&world->pending_queries);
+    if (count) {
+        ecs_query_t **pending = ecs_vec_first_t(
+            &world->pending_queries, ecs_query_t*);
+        for (i = 0; i < count; i ++) {
+            flecs_query_index_insert(world, pending[i]);
+        }
+        ecs_vec_clear(&world->pending_queries);
+    }
+}
+
+void flecs_query_index_fini(
+    ecs_world_t *world)
+{
+    ecs_map_iter_t it = ecs_map_iter(&world->query_index);
+    ecs_vec_t *queries;
+    while ((queries = ecs_map_next(&it, ecs_vec_t, NULL))) {
+        ecs_vec_fini_t(&world->allocator, queries, ecs_query_t*);
+    }
+    ecs_map_fini(&world->query_index);
+    ecs_vec_fini_t(&world->allocator, &world->unindexed_queries, ecs_query_t*);
+    ecs_vec_fini_t(&world->allocator, &world->pending_queries, ecs_query_t*);
+}
+
 void flecs_query_notify(
     ecs_world_t *world,
     ecs_query_t *query,
@@ -47947,7 +56860,7 @@ void flecs_query_order_by(
     ecs_vector_free(query->table_slices);
     query->table_slices = NULL;
 
-    flecs_query_sort_tables(world, query);  
+    flecs_query_sort_tables(world, world, query);  
 
     if (!query->table_slices) {
         flecs_query_build_sorted_tables(query);
@@ -48108,6 +57021,8 @@ void flecs_query_fini(
         !(query->flags & EcsQueryIsOrphaned))
     {
         flecs_query_remove_subquery(query->parent, query);
+    } else if (!(query->flags & EcsQueryIsSubquery)) {
+        flecs_query_index_remove(world, query);
     }
 
     flecs_query_notify_subqueries(world, query, &(ecs_query_event_t){
@@ -48126,6 +57041,15 @@ void flecs_query_fini(
 
     flecs_query_allocators_fini(query);
 
+#ifdef FLECS_QUERY_COUNTERS
+    /* Remove counters, so a new query at the same address starts at 0 */
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        ecs_map_remove(&world->stages[i].query_counters, 
+            (ecs_map_key_t)(uintptr_t)query);
+    }
+#endif
+
     ecs_poly_free(query, ecs_query_t);
 }
 
@@ -48193,6 +57117,10 @@ ecs_query_t* ecs_query_init(
         goto error;
     }
 
+    if (flecs_query_is_trivial(world, result, desc)) {
+        result->flags |= EcsQueryIsTrivial;
+    }
+
     /* Group before matching so we won't have to move tables around later */
     int32_t cascade_by = result->cascade_by;
     if (cascade_by) {
@@ -48216,6 +57144,19 @@ ecs_query_t* ecs_query_init(
         result->flags |= EcsQueryIsSubquery;
     }
 
+    if (desc->prefetch) {
+        result->flags |= EcsQueryPrefetch;
+    }
+
+    ecs_check(desc->max_batch >= 0, ECS_INVALID_PARAMETER, NULL);
+    result->max_batch = desc->max_batch;
+
+    if (desc->track_rows) {
+        /* Monitors are created when tables are matched, so that iterating the
+         * query establishes what changes the query has seen */
+        result->flags |= EcsQueryTrackRows | EcsQueryHasMonitor;
+    }
+
     /* If the query refers to itself, add the components that were queried for
      * to the query itself. */
     if (entity)  {
@@ -48248,6 +57189,7 @@ ecs_query_t* ecs_query_init(
 
     if (!desc->parent) {
         flecs_query_match_tables(world, result);
+        flecs_query_index_add(world, result);
     } else {
         flecs_query_add_subquery(world, desc->parent, result);
         result->parent = desc->parent;
@@ -48306,7 +57248,7 @@ ecs_iter_t ecs_query_iter(
     flecs_process_pending_tables(world);
 
     /* If query has order_by, apply sort */
-    flecs_query_sort_tables(world, query);
+    flecs_query_sort_tables(world, stage, query);
 
     /* If monitors changed, do query rematching */
     if (!(world->flags & EcsWorldReadonly) && query->flags & EcsQueryHasRefs) {
@@ -48423,6 +57365,90 @@ error:
     return;
 }
 
+/** Weight used to balance groups across workers. Tables are counted in addition
+ * to entities, as each table adds a fixed overhead to iteration. */
+static
+int64_t flecs_query_group_weight(
+    const ecs_query_table_list_t *group)
+{
+    int64_t result = 0;
+    ecs_query_table_node_t *node, *last = group->last->next;
+    for (node = group->first; node != last; node = node->next) {
+        int32_t count = node->count;
+        if (!count && node->table) {
+            count = ecs_table_count(node->table);
+        }
+        result += count + 1;
+    }
+    return result;
+}
+
+void ecs_query_set_group_worker(
+    ecs_iter_t *it,
+    int32_t index,
+    int32_t count)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!(it->flags & EcsIterIsValid), ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index < count, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_query_iter_t *qit = &it->priv.iter.query;
+    ecs_query_t *q = qit->query;
+    ecs_check(q != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(q->group_by != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    /* Groups are stored as contiguous ranges in the list of query nodes. Split
+     * up the list in count ranges of whole groups with roughly equal weight, so
+     * that each worker can iterate its groups as a single range. A group is
+     * assigned to the worker that owns the midpoint of the group's weight. All
+     * workers compute the same ranges, as this only depends on the cache. */
+    ecs_query_table_node_t *node, *last = qit->last;
+    int64_t total = 0;
+    for (node = qit->node; node != last; ) {
+        ecs_query_table_list_t *group = flecs_query_get_group(
+            q, node->group_id);
+        ecs_assert(group != NULL, ECS_INTERNAL_ERROR, NULL);
+        total += flecs_query_group_weight(group);
+        node = group->last->next;
+    }
+
+    ecs_query_table_node_t *first = NULL;
+    int64_t cur = 0;
+    for (node = qit->node; node != last; ) {
+        ecs_query_table_list_t *group = flecs_query_get_group(
+            q, node->group_id);
+        int64_t weight = flecs_query_group_weight(group);
+        int64_t owner = ((cur * 2 + weight) * count) / (total * 2);
+        cur += weight;
+        node = group->last->next;
+
+        if (owner < index) {
+            continue;
+        }
+        if (owner > index) {
+            last = group->first;
+            break;
+        }
+        if (!first) {
+            first = group->first;
+        }
+    }
+
+    if (first) {
+        qit->node = first;
+        qit->last = last;
+    } else {
+        qit->node = NULL;
+        qit->last = NULL;
+    }
+
+error:
+    return;
+}
+
 const ecs_query_group_info_t* ecs_query_get_group_info(
     ecs_query_t *query,
     uint64_t group_id)
@@ -48775,7 +57801,9 @@ done:
 static
 void flecs_query_mark_columns_dirty(
     ecs_query_t *query,
-    ecs_query_table_match_t *qm)
+    ecs_query_table_match_t *qm,
+    int32_t first,
+    int32_t count)
 {
     ecs_table_t *table = qm->node.table;
     if (!table) {
@@ -48787,9 +57815,9 @@ void flecs_query_mark_columns_dirty(
         int32_t *storage_columns = qm->storage_columns;
         ecs_filter_t *filter = &query->filter;
         ecs_term_t *terms = filter->terms;
-        int32_t i, count = filter->term_count;
+        int32_t i, term_count = filter->term_count;
 
-        for (i = 0; i < count; i ++) {
+        for (i = 0; i < term_count; i ++) {
             ecs_term_t *term = &terms[i];
             if (term->inout == EcsIn || term->inout == EcsInOutNone) {
                 /* Don't mark readonly terms dirty */
@@ -48802,7 +57830,8 @@ void flecs_query_mark_columns_dirty(
                 continue;
             }
 
-            dirty_state[column + 1] ++;
+            flecs_table_mark_rows_dirty(query->world, table, column, 
+                first, count);
         }
     }
 }
@@ -48822,7 +57851,8 @@ bool ecs_query_next_table(
     if ((query->flags & EcsQueryHasOutColumns)) {
         ecs_query_table_node_t *prev = iter->prev;
         if (prev && it->count) {
-            flecs_query_mark_columns_dirty(query, prev->match);
+            flecs_query_mark_columns_dirty(query, prev->match, 
+                0, ecs_table_count(prev->table));
         }
     }
 
@@ -48910,6 +57940,257 @@ error:
     return false;
 }
 
+/** Prefetch the first cache lines of the entities and component columns of a
+ * node, so that they are in cache by the time the node is iterated. */
+static
+void flecs_query_prefetch_node(
+    const ecs_query_table_node_t *node,
+    const ecs_query_table_node_t *last,
+    int32_t field_count)
+{
+    if (node == last) {
+        return;
+    }
+
+    ecs_query_table_match_t *match = node->match;
+    ecs_table_t *table = match->node.table;
+    if (!table) {
+        return;
+    }
+
+    int32_t offset = node->offset;
+    flecs_prefetch(ECS_ELEM_T(table->data.entities.array, ecs_entity_t, offset));
+
+    int32_t *storage_columns = match->storage_columns;
+    ecs_size_t *sizes = match->sizes;
+    ecs_vec_t *columns = table->data.columns;
+    int32_t i;
+    for (i = 0; i < field_count; i ++) {
+        int32_t column = storage_columns[i];
+        if (column < 0) {
+            continue;
+        }
+
+        flecs_prefetch(ECS_ELEM(columns[column].array, sizes[i], offset));
+    }
+}
+
+/** Limit result to the maximum batch size of the query. The rows that are left
+ * are returned by flecs_query_next_batch before moving on to the next node. */
+static
+int32_t flecs_query_batch(
+    ecs_iter_t *it,
+    ecs_query_table_node_t *node,
+    int32_t count)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    int32_t max_batch = iter->query->max_batch;
+    if (!max_batch || count <= max_batch) {
+        return count;
+    }
+
+    /* Results with shared fields are already returned one row at a time when
+     * the iterator is not instanced. */
+    if (ecs_vec_count(&node->match->refs) && 
+        !ECS_BIT_IS_SET(it->flags, EcsIterIsInstanced))
+    {
+        return count;
+    }
+
+    iter->batch_node = node;
+    iter->batch_left = count - max_batch;
+    return max_batch;
+}
+
+/** Return next batch of the current result. Only the entity and component
+ * pointers need to be updated, as everything else is the same for all batches
+ * of a result. */
+static
+bool flecs_query_next_batch(
+    ecs_iter_t *it)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    int32_t first = iter->prev_first + iter->prev_count;
+    int32_t count = iter->batch_left;
+    int32_t max_batch = iter->query->max_batch;
+    if (count > max_batch) {
+        count = max_batch;
+    }
+
+    iter->batch_left -= count;
+    iter->prev = iter->batch_node;
+    iter->prev_first = first;
+    iter->prev_count = count;
+
+    /* Repopulate pointers, as iterators that chain the query iterator (like
+     * the worker and page iterators) may have modified them. The batch is 
+     * part of the same table as the previous result, so keep frame offset. */
+    int32_t frame_offset = it->frame_offset;
+    it->instance_count = 0;
+    flecs_iter_populate_data(iter->query->world, it, it->table, first, count,
+        it->ptrs, NULL);
+    it->frame_offset = frame_offset;
+
+    if (!iter->skip_counters) {
+        flecs_query_count_result(iter->query, it);
+    }
+    return true;
+}
+
+/** Fast path for trivial queries. Every node in the list is a full table with
+ * fields that are all stored on $this, so the only things that change between
+ * results are the table, the count and the column pointers. */
+static
+bool flecs_query_next_trivial(
+    ecs_iter_t *it)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    ecs_query_table_node_t *node = iter->node;
+    if (node == iter->last) {
+        ecs_iter_fini(it);
+        return false;
+    }
+
+    ecs_query_table_match_t *match = node->match;
+    ecs_table_t *table = match->node.table;
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(match->bitset_columns == NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(match->sparse_columns == NULL, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t offset = node->offset, count = node->count;
+    if (!count) {
+        count = ecs_table_count(table);
+
+        /* List should never contain empty tables */
+        ecs_assert(count != 0, ECS_INTERNAL_ERROR, NULL);
+    }
+
+    count = flecs_query_batch(it, node, count);
+
+    ecs_table_t *prev_table = it->table;
+    if (prev_table) {
+        it->frame_offset += ecs_table_count(prev_table);
+    }
+
+    it->table = table;
+    it->offset = offset;
+    it->count = count;
+    it->group_id = match->node.group_id;
+    it->entities = ecs_vec_get_t(&table->data.entities, ecs_entity_t, offset);
+    it->ids = match->ids;
+    it->columns = match->columns;
+    it->sizes = match->sizes;
+    it->sources = match->sources;
+    it->references = NULL;
+    it->instance_count = 0;
+
+    void **ptrs = it->ptrs;
+    if (ptrs && !ECS_BIT_IS_SET(it->flags, EcsIterIsFilter)) {
+        int32_t *storage_columns = match->storage_columns;
+        ecs_size_t *sizes = match->sizes;
+        ecs_term_t *terms = it->terms;
+        int32_t i, field_count = it->field_count;
+        for (i = 0; i < field_count; i ++) {
+            /* Trivial queries only have And terms, so fields map to terms */
+            int32_t column = storage_columns[i];
+            if (column < 0 || terms[i].inout == EcsInOutNone) {
+                ptrs[i] = NULL;
+                continue;
+            }
+
+            ptrs[i] = ECS_ELEM(table->data.columns[column].array, 
+                sizes[i], offset);
+        }
+    }
+
+    ECS_BIT_CLEAR(it->flags, EcsIterHasShared);
+
+    if (iter->query->flags & EcsQueryPrefetch) {
+        flecs_query_prefetch_node(node->next, iter->last, it->field_count);
+    }
+
+    if (!iter->skip_counters) {
+        flecs_query_count_result(iter->query, it);
+    }
+
+    iter->node = node->next;
+    iter->prev = node;
+    iter->prev_first = offset;
+    iter->prev_count = count;
+    return true;
+}
+
+#ifdef FLECS_QUERY_COUNTERS
+ecs_query_counters_t* flecs_query_counters(
+    const ecs_world_t *stage,
+    ecs_query_t *query)
+{
+    ecs_stage_t *s;
+    if (ecs_poly_is(stage, ecs_stage_t)) {
+        s = (ecs_stage_t*)stage;
+    } else {
+        s = &((ecs_world_t*)stage)->stages[0];
+    }
+
+    return ecs_map_ensure(&s->query_counters, ecs_query_counters_t, 
+        (ecs_map_key_t)(uintptr_t)query);
+}
+
+void flecs_query_counters_get(
+    const ecs_world_t *world,
+    const ecs_query_t *query,
+    ecs_query_counters_t *out)
+{
+    ecs_os_zeromem(out);
+
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        const ecs_query_counters_t *src = ecs_map_get(
+            &world->stages[i].query_counters, ecs_query_counters_t, 
+            (ecs_map_key_t)(uintptr_t)query);
+        if (src) {
+            out->table_count += src->table_count;
+            out->entity_count += src->entity_count;
+            out->skip_count += src->skip_count;
+            out->change_check_count += src->change_check_count;
+            out->bytes_touched += src->bytes_touched;
+            out->rematch_time += src->rematch_time;
+            out->sort_time += src->sort_time;
+        }
+    }
+}
+
+void flecs_query_count_result(
+    ecs_query_t *query,
+    const ecs_iter_t *it)
+{
+    int32_t count = it->count;
+    ecs_query_counters_t *c = flecs_query_counters(it->world, query);
+    c->table_count ++;
+    c->entity_count += count;
+
+    void **ptrs = it->ptrs;
+    if (!ptrs) {
+        return;
+    }
+
+    const ecs_size_t *sizes = it->sizes;
+    int32_t i, field_count = it->field_count;
+    for (i = 0; i < field_count; i ++) {
+        if (!ptrs[i]) {
+            continue;
+        }
+
+        /* Shared fields only touch a single component value */
+        if (ecs_field_is_self(it, i + 1)) {
+            c->bytes_touched += sizes[i] * count;
+        } else {
+            c->bytes_touched += sizes[i];
+        }
+    }
+}
+#endif
+
 bool ecs_query_next_instanced(
     ecs_iter_t *it)
 {
@@ -48929,12 +58210,14 @@ bool ecs_query_next_instanced(
     query_iter_cursor_t cur;
     ecs_query_table_node_t *node, *next, *prev, *last;
     if ((prev = iter->prev)) {
-        /* Match has been iterated, update monitor for change tracking */
-        if (flags & EcsQueryHasMonitor) {
+        /* Match has been iterated, update monitor for change tracking. If the
+         * result was split up in batches, wait until the last batch. */
+        if ((flags & EcsQueryHasMonitor) && !iter->batch_left) {
             flecs_query_sync_match_monitor(query, prev->match);
         }
         if (flags & EcsQueryHasOutColumns) {
-            flecs_query_mark_columns_dirty(query, prev->match);
+            flecs_query_mark_columns_dirty(query, prev->match, 
+                iter->prev_first, iter->prev_count);
         }
     }
 
@@ -48942,6 +58225,16 @@ bool ecs_query_next_instanced(
 
     flecs_iter_validate(it);
 
+    if (iter->batch_left) {
+        return flecs_query_next_batch(it);
+    }
+
+    if ((flags & EcsQueryIsTrivial) && 
+        !ECS_BIT_IS_SET(it->flags, EcsIterChangedOnly)) 
+    {
+        return flecs_query_next_trivial(it);
+    }
+
     last = iter->last;
     for (node = iter->node; node != last; node = next) {     
         ecs_query_table_match_t *match = node->match;
@@ -48961,7 +58254,15 @@ bool ecs_query_next_instanced(
 
             ecs_vector_t *bitset_columns = match->bitset_columns;
             ecs_vector_t *sparse_columns = match->sparse_columns;
-            if (bitset_columns || sparse_columns) {
+            bool resume = iter->predicate_row < iter->predicate_end;
+            if (resume) {
+                /* Continue with rows of the previous result, which have not
+                 * yet been tested for predicates. If the table has bitset or
+                 * sparse columns, it may have more ranges after this one. */
+                if (bitset_columns || sparse_columns) {
+                    next = node;
+                }
+            } else if (bitset_columns || sparse_columns) {
                 bool found = false;
 
                 do {
@@ -49003,11 +58304,44 @@ bool ecs_query_next_instanced(
                 } while (!found);
 
                 if (!found) {
+                    flecs_query_counter_add(it->world, query, skip_count, 1);
+                    continue;
+                }
+            }
+
+            bool changed_only = ECS_BIT_IS_SET(it->flags, EcsIterChangedOnly);
+            if (changed_only && node != iter->prev) {
+                /* Entering node, remember which changes the query has seen so
+                 * that all ranges of the node are tested against it */
+                flecs_query_init_changed_monitor(query, match);
+            }
+
+            if (changed_only || (filter->flags & EcsFilterHasPredicates)) {
+                flecs_query_select_ctx_t select_ctx = { 
+                    it->world, query, match };
+                if (!resume) {
+                    iter->predicate_row = cur.first;
+                    iter->predicate_end = cur.first + cur.count;
+                }
+
+                cur.first = flecs_filter_rows_next(world, filter, table,
+                    match->ids, match->columns, match->sources, 
+                    changed_only ? flecs_query_select_changed : NULL, 
+                    &select_ctx,
+                    &iter->predicate_row, iter->predicate_end, &cur.count);
+                if (cur.first == -1) {
+                    /* No rows left that pass the predicates or have changed */
+                    flecs_query_counter_add(it->world, query, skip_count, 1);
                     continue;
                 }
+
+                if (iter->predicate_row < iter->predicate_end) {
+                    next = node;
+                }
             }
 
             it->group_id = match->node.group_id;
+            cur.count = flecs_query_batch(it, node, cur.count);
         } else {
             cur.count = 0;
             cur.first = 0;
@@ -49041,8 +58375,18 @@ bool ecs_query_next_instanced(
         flecs_iter_populate_data(world, it, table, cur.first, cur.count,
             it->ptrs, NULL);
 
+        if ((flags & EcsQueryPrefetch) && (next != node)) {
+            flecs_query_prefetch_node(next, last, it->field_count);
+        }
+
+        if (!iter->skip_counters) {
+            flecs_query_count_result(query, it);
+        }
+
         iter->node = next;
         iter->prev = node;
+        iter->prev_first = cur.first;
+        iter->prev_count = cur.count;
         goto yield;
     }
 
@@ -51315,7 +60659,6 @@ error:
     return (ecs_iter_t){ 0 };
 }
 
-static
 void flecs_offset_iter(
     ecs_iter_t *it,
     int32_t offset)
@@ -51521,7 +60864,7 @@ bool ecs_worker_next_instanced(
     it->instance_count = instances_per_worker;
     it->frame_offset += first;
 
-    flecs_offset_iter(it, it->offset + first);
+    flecs_offset_iter(it, first);
     it->count = per_worker;
 
     if (ECS_BIT_IS_SET(it->flags, EcsIterIsInstanced)) {
@@ -52291,6 +61634,17 @@ void flecs_register_union(ecs_iter_t *it) {
     flecs_register_id_flag_for_relation(it, EcsUnion, EcsIdUnion, 0, 0);
 }
 
+static
+void flecs_register_target_index(ecs_iter_t *it) {
+    flecs_register_id_flag_for_relation(it, EcsTargetIndex, EcsIdTargetIndex, 
+        0, 0);
+
+    int i, count = it->count;
+    for (i = 0; i < count; i ++) {
+        flecs_target_index_ensure(it->world, it->entities[i]);
+    }
+}
+
 static
 void flecs_register_slot_of(ecs_iter_t *it) {
     int i, count = it->count;
@@ -52738,6 +62092,7 @@ void flecs_bootstrap(
     flecs_bootstrap_tag(world, EcsAcyclic);
     flecs_bootstrap_tag(world, EcsWith);
     flecs_bootstrap_tag(world, EcsOneOf);
+    flecs_bootstrap_tag(world, EcsTargetIndex);
 
     flecs_bootstrap_tag(world, EcsOnDelete);
     flecs_bootstrap_tag(world, EcsOnDeleteTarget);
@@ -52868,6 +62223,12 @@ void flecs_bootstrap(
         .callback = flecs_register_union
     });
 
+    ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ .id = EcsTargetIndex, .src.flags = EcsSelf }, match_prefab },
+        .events = {EcsOnAdd},
+        .callback = flecs_register_target_index
+    });
+
     /* Entities used as slot are marked as exclusive to ensure a slot can always
      * only point to a single entity. */
     ecs_observer_init(world, &(ecs_observer_desc_t){
@@ -53698,6 +63059,7 @@ ecs_id_record_t* flecs_id_record_new(
     }
 
     ecs_table_cache_init(world, &idr->cache);
+    ecs_vec_init_t(&world->allocator, &idr->sorted_tables, ecs_table_t*, 0);
 
     idr->id = id;
     idr->refcount = 1;
@@ -53917,7 +63279,9 @@ void flecs_id_record_free(
     /* Unregister the id record from the world & free resources */
     ecs_table_cache_fini(&idr->cache);
     flecs_name_index_free(idr->name_index);
+    flecs_target_index_free(world, idr);
     ecs_vec_fini_t(&world->allocator, &idr->reachable.ids, ecs_reachable_elem_t);
+    ecs_vec_fini_t(&world->allocator, &idr->sorted_tables, ecs_table_t*);
 
     ecs_id_t hash = flecs_id_record_hash(id);
     if (hash >= ECS_HI_ID_RECORD_ID) {
@@ -54110,6 +63474,226 @@ ecs_hashmap_t* flecs_id_name_index_get(
     return idr->name_index;
 }
 
+static
+ecs_size_t flecs_target_index_map_size(
+    const ecs_map_t *map)
+{
+    return ecs_map_bucket_count(map) * ECS_SIZEOF(ecs_bucket_t) +
+        ecs_map_count(map) * 
+            (ECS_SIZEOF(ecs_bucket_entry_t) + map->elem_size);
+}
+
+/* Recompute memory used by target index & update world counters */
+static
+void flecs_target_index_update_size(
+    ecs_world_t *world,
+    ecs_target_index_t *ti,
+    ecs_size_t vec_delta)
+{
+    ecs_size_t size = ti->size;
+    ecs_size_t map_size = flecs_target_index_map_size(&ti->sources) +
+        flecs_target_index_map_size(&ti->slots);
+    ecs_size_t prev_map_size = ti->map_size;
+
+    ti->map_size = map_size;
+    ti->size = size + vec_delta + (map_size - prev_map_size);
+    world->info.target_index_memory += ti->size - size;
+}
+
+ecs_target_index_t* flecs_target_index_ensure(
+    ecs_world_t *world,
+    ecs_entity_t rel)
+{
+    ecs_id_record_t *idr = flecs_id_record_ensure(world, 
+        ecs_pair(rel, EcsWildcard));
+    ecs_target_index_t *ti = idr->target_index;
+    if (!ti) {
+        ti = idr->target_index = flecs_calloc_t(
+            &world->allocator, ecs_target_index_t);
+        ecs_map_init(&ti->sources, ecs_vec_t, &world->allocator, 0);
+        ecs_map_init(&ti->slots, int32_t, &world->allocator, 0);
+        flecs_target_index_update_size(world, ti, ECS_SIZEOF(ecs_target_index_t));
+    }
+    return ti;
+}
+
+void flecs_target_index_free(
+    ecs_world_t *world,
+    ecs_id_record_t *idr)
+{
+    ecs_target_index_t *ti = idr->target_index;
+    if (!ti) {
+        return;
+    }
+
+    ecs_map_iter_t it = ecs_map_iter(&ti->sources);
+    ecs_vec_t *v;
+    while ((v = ecs_map_next(&it, ecs_vec_t, NULL))) {
+        ecs_vec_fini_t(&world->allocator, v, ecs_entity_t);
+    }
+
+    ecs_map_fini(&ti->sources);
+    ecs_map_fini(&ti->slots);
+
+    world->info.target_index_count -= ti->count;
+    world->info.target_index_memory -= ti->size;
+
+    flecs_free_t(&world->allocator, ecs_target_index_t, ti);
+    idr->target_index = NULL;
+}
+
+/* Get target index for pair, or NULL if the relationship isn't indexed */
+static
+ecs_target_index_t* flecs_target_index_for_pair(
+    ecs_world_t *world,
+    ecs_id_t id)
+{
+    if (!ECS_IS_PAIR(id)) {
+        return NULL;
+    }
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr || ((idr->flags & (EcsIdTargetIndex|EcsIdUnion)) != 
+        EcsIdTargetIndex)) 
+    {
+        return NULL;
+    }
+
+    ecs_assert(idr->parent != NULL, ECS_INTERNAL_ERROR, NULL);
+    return idr->parent->target_index;
+}
+
+void flecs_target_index_add(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t row,
+    int32_t count,
+    const ecs_type_t *added)
+{
+    ecs_entity_t *entities = ecs_vec_first_t(
+        &table->data.entities, ecs_entity_t);
+    int32_t i, e, id_count = added->count;
+
+    for (i = 0; i < id_count; i ++) {
+        ecs_id_t id = added->array[i];
+        ecs_target_index_t *ti = flecs_target_index_for_pair(world, id);
+        if (!ti) {
+            continue;
+        }
+
+        ecs_entity_t tgt = ECS_PAIR_SECOND(id);
+        ecs_vec_t *sources = ecs_map_get(&ti->sources, ecs_vec_t, tgt);
+        if (!sources) {
+            sources = ecs_map_ensure(&ti->sources, ecs_vec_t, tgt);
+            ecs_vec_init_t(&world->allocator, sources, ecs_entity_t, 0);
+        }
+        ecs_size_t prev_size = ecs_vec_size(sources);
+
+        for (e = 0; e < count; e ++) {
+            ecs_entity_t src = entities[row + e];
+            int32_t *slot = ecs_map_ensure(&ti->slots, int32_t, 
+                ecs_pair(src, tgt));
+            if (slot[0]) {
+                continue; /* Already indexed */
+            }
+
+            /* Slots are stored 1-based so that 0 means "not indexed" */
+            slot[0] = ecs_vec_count(sources) + 1;
+            ecs_vec_append_t(&world->allocator, sources, ecs_entity_t)[0] = src;
+            ti->count ++;
+            world->info.target_index_count ++;
+        }
+
+        flecs_target_index_update_size(world, ti, 
+            (ecs_vec_size(sources) - prev_size) * ECS_SIZEOF(ecs_entity_t));
+    }
+}
+
+void flecs_target_index_remove(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t row,
+    int32_t count,
+    const ecs_type_t *removed)
+{
+    ecs_entity_t *entities = ecs_vec_first_t(
+        &table->data.entities, ecs_entity_t);
+    int32_t i, e, id_count = removed->count;
+
+    for (i = 0; i < id_count; i ++) {
+        ecs_id_t id = removed->array[i];
+        ecs_target_index_t *ti = flecs_target_index_for_pair(world, id);
+        if (!ti) {
+            continue;
+        }
+
+        ecs_entity_t tgt = ECS_PAIR_SECOND(id);
+        ecs_vec_t *sources = ecs_map_get(&ti->sources, ecs_vec_t, tgt);
+        if (!sources) {
+            continue;
+        }
+
+        for (e = 0; e < count; e ++) {
+            ecs_entity_t src = entities[row + e];
+            ecs_map_key_t key = ecs_pair(src, tgt);
+            int32_t *slot = ecs_map_get(&ti->slots, int32_t, key);
+            if (!slot) {
+                continue;
+            }
+
+            /* Move last source into the slot of the removed source */
+            int32_t index = slot[0] - 1;
+            ecs_entity_t *array = ecs_vec_first_t(sources, ecs_entity_t);
+            int32_t last = ecs_vec_count(sources) - 1;
+            ecs_assert(array[index] == src, ECS_INTERNAL_ERROR, NULL);
+            if (index != last) {
+                ecs_entity_t moved = array[last];
+                array[index] = moved;
+                int32_t *moved_slot = ecs_map_get(&ti->slots, int32_t, 
+                    ecs_pair(moved, tgt));
+                ecs_assert(moved_slot != NULL, ECS_INTERNAL_ERROR, NULL);
+                moved_slot[0] = index + 1;
+            }
+
+            ecs_vec_remove_last(sources);
+            ecs_map_remove(&ti->slots, key);
+            ti->count --;
+            world->info.target_index_count --;
+        }
+
+        if (!ecs_vec_count(sources)) {
+            ecs_size_t size = ecs_vec_size(sources);
+            ecs_vec_fini_t(&world->allocator, sources, ecs_entity_t);
+            ecs_map_remove(&ti->sources, tgt);
+            flecs_target_index_update_size(world, ti, 
+                -size * ECS_SIZEOF(ecs_entity_t));
+        } else {
+            flecs_target_index_update_size(world, ti, 0);
+        }
+    }
+}
+
+const ecs_entity_t* flecs_target_index_get(
+    const ecs_target_index_t *ti,
+    ecs_entity_t target,
+    int32_t *count_out)
+{
+    ecs_vec_t *sources = ecs_map_get(&ti->sources, ecs_vec_t, 
+        (uint32_t)target);
+    if (!sources) {
+        if (count_out) {
+            *count_out = 0;
+        }
+        return NULL;
+    }
+
+    if (count_out) {
+        *count_out = ecs_vec_count(sources);
+    }
+
+    return ecs_vec_first_t(sources, ecs_entity_t);
+}
+
 ecs_table_record_t* flecs_table_record_get(
     const ecs_world_t *world,
     const ecs_table_t *table,
@@ -54133,6 +63717,104 @@ const ecs_table_record_t* flecs_id_record_get_table(
     return (ecs_table_record_t*)ecs_table_cache_get(&idr->cache, table);
 }
 
+/* Find index of first table in sorted list with id >= table_id */
+static
+int32_t flecs_id_record_sorted_lower_bound(
+    ecs_table_t **tables,
+    int32_t low,
+    int32_t high,
+    uint64_t table_id)
+{
+    while (low < high) {
+        int32_t mid = low + (high - low) / 2;
+        if (tables[mid]->id < table_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void flecs_id_record_sorted_add(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_table_t *table)
+{
+    if (ecs_id_is_wildcard(idr->id)) {
+        return;
+    }
+
+    ecs_vec_t *v = &idr->sorted_tables;
+    int32_t count = ecs_vec_count(v);
+    ecs_table_t **tables = ecs_vec_first_t(v, ecs_table_t*);
+
+    /* New tables usually have the highest id, so check the end first */
+    int32_t index = count;
+    if (count && tables[count - 1]->id > table->id) {
+        index = flecs_id_record_sorted_lower_bound(
+            tables, 0, count, table->id);
+    }
+
+    ecs_vec_append_t(&world->allocator, v, ecs_table_t*);
+    tables = ecs_vec_first_t(v, ecs_table_t*);
+    if (index < count) {
+        ecs_os_memmove(&tables[index + 1], &tables[index], 
+            ECS_SIZEOF(ecs_table_t*) * (count - index));
+    }
+    tables[index] = table;
+}
+
+void flecs_id_record_sorted_remove(
+    ecs_id_record_t *idr,
+    const ecs_table_t *table)
+{
+    if (ecs_id_is_wildcard(idr->id)) {
+        return;
+    }
+
+    ecs_vec_t *v = &idr->sorted_tables;
+    int32_t count = ecs_vec_count(v);
+    ecs_table_t **tables = ecs_vec_first_t(v, ecs_table_t*);
+    int32_t index = flecs_id_record_sorted_lower_bound(
+        tables, 0, count, table->id);
+    ecs_assert(index < count && tables[index] == table, 
+        ECS_INTERNAL_ERROR, NULL);
+
+    if (index < (count - 1)) {
+        ecs_os_memmove(&tables[index], &tables[index + 1], 
+            ECS_SIZEOF(ecs_table_t*) * (count - index - 1));
+    }
+    ecs_vec_remove_last(v);
+}
+
+int32_t flecs_id_record_sorted_seek(
+    const ecs_id_record_t *idr,
+    int32_t index,
+    uint64_t table_id)
+{
+    const ecs_vec_t *v = &idr->sorted_tables;
+    int32_t count = ecs_vec_count(v);
+    ecs_table_t **tables = ecs_vec_first_t(v, ecs_table_t*);
+    if (index >= count || tables[index]->id >= table_id) {
+        return index;
+    }
+
+    /* Gallop ahead with increasing steps until a larger table id is found,
+     * then binary search the last step */
+    int32_t low = index, step = 1, high = index + 1;
+    while (high < count && tables[high]->id < table_id) {
+        low = high;
+        step *= 2;
+        high = low + step;
+    }
+    if (high > count) {
+        high = count;
+    }
+
+    return flecs_id_record_sorted_lower_bound(tables, low + 1, high, table_id);
+}
+
 void flecs_init_id_records(
     ecs_world_t *world)
 {
@@ -42,6 +42,25 @@
  */
 // #define FLECS_ACCURATE_COUNTERS
 
+/** FLECS_QUERY_COUNTERS
+ * Define to collect profiling counters for cached queries and systems, such as
+ * the number of tables and entities iterated and the time spent sorting and
+ * rematching. Counters are reported by ecs_query_stats_get. Each stage keeps
+ * its own counters, which ecs_query_stats_get adds up, so counters are accurate
+ * for queries iterated by multiple threads. Updating a counter looks up the
+ * query in a map of the stage, which adds overhead to each iterated result.
+ */
+// #define FLECS_QUERY_COUNTERS
+
+/** FLECS_PERF_COUNTERS
+ * Define to collect hardware counters (cycles, instructions, last level cache
+ * misses and branch misses) for systems with perf_event_open. Counters are 
+ * only collected when system time is measured, and are reported by 
+ * ecs_system_stats_get. When counters are not available (e.g. on platforms 
+ * other than Linux, or when permission is denied) they are reported as 0.
+ */
+// #define FLECS_PERF_COUNTERS
+
 /* Make sure provided configuration is valid */
 #if defined(FLECS_DEBUG) && defined(FLECS_NDEBUG)
 #error "invalid configuration: cannot both define FLECS_DEBUG and FLECS_NDEBUG"
@@ -147,6 +166,7 @@
 #define FLECS_OS_API_IMPL   /* Default implementation for OS API */
 #define FLECS_HTTP          /* Tiny HTTP server for connecting to remote UI */
 #define FLECS_REST          /* REST API for querying application data */
+#define FLECS_TRACING       /* Chrome trace export of frames and systems */
 // #define FLECS_JOURNAL    /* Journaling addon (disabled by default) */
 #endif // ifndef FLECS_CUSTOM_BUILD
 
@@ -233,6 +253,7 @@ extern "C" {
 #define EcsIdTag                       (1u << 9)
 #define EcsIdWith                      (1u << 10)
 #define EcsIdUnion                     (1u << 11)
+#define EcsIdTargetIndex               (1u << 12)
 
 #define EcsIdHasOnAdd                  (1u << 15) /* Same values as table flags */
 #define EcsIdHasOnRemove               (1u << 16) 
@@ -265,6 +286,8 @@ extern "C" {
 #define EcsIterNoResults               (1u << 6u)  /* Iterator has no results */
 #define EcsIterIgnoreThis              (1u << 7u)  /* Only evaluate non-this terms */
 #define EcsIterMatchVar           (1u << 8u)
+#define EcsIterIgnorePredicates        (1u << 9u)  /* Don't test term predicates */
+#define EcsIterChangedOnly             (1u << 10u) /* Only return rows that changed */
 
 ////////////////////////////////////////////////////////////////////////////////
 //// Filter flags (used by ecs_filter_t::flags)
@@ -286,6 +309,7 @@ extern "C" {
 #define EcsFilterIsFilter              (1u << 7u)  /* When true, data fields won't be populated */
 #define EcsFilterIsInstanced           (1u << 8u)  /* Is filter instanced (see ecs_filter_desc_t) */
 #define EcsFilterPopulate              (1u << 9u)  /* Populate data, ignore non-matching fields */
+#define EcsFilterHasPredicates         (1u << 10u) /* Does filter have terms with predicates */
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -313,6 +337,7 @@ extern "C" {
 #define EcsTableHasUnSet               (1u << 18u)
 
 #define EcsTableHasObserved            (1u << 20u)
+#define EcsTableHasTargetIndex         (1u << 21u) /* Does table have indexed relationships */
 
 #define EcsTableMarkedForDelete        (1u << 30u)
 
@@ -332,6 +357,9 @@ extern "C" {
 #define EcsQueryIsOrphaned             (1u << 3u)  /* Is subquery orphaned */
 #define EcsQueryHasOutColumns          (1u << 4u)  /* Does query have out columns */
 #define EcsQueryHasMonitor             (1u << 5u)  /* Does query track changes */
+#define EcsQueryTrackRows              (1u << 6u)  /* Does query track changes per row */
+#define EcsQueryIsTrivial              (1u << 7u)  /* Can query use fast path iterator */
+#define EcsQueryPrefetch               (1u << 8u)  /* Prefetch columns of next result */
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2125,6 +2153,15 @@ bool ecs_strbuf_appendstrn(
     const char *str,
     int32_t n);
 
+/* Append n bytes of binary data to buffer. Unlike ecs_strbuf_appendstrn, the
+ * data may contain \0 characters.
+ * Returns false when max is reached, true when there is still space */
+FLECS_API
+bool ecs_strbuf_appendbin(
+    ecs_strbuf_t *buffer,
+    const void *data,
+    int32_t n);
+
 /* Return result string */
 FLECS_API
 char *ecs_strbuf_get(
@@ -3060,6 +3097,56 @@ typedef struct ecs_term_id_t {
     ecs_flags32_t flags;        /* Term flags */
 } ecs_term_id_t;
 
+/** Type of the value that is tested by a term predicate */
+typedef enum ecs_predicate_kind_t {
+    EcsPredicateNone,   /* Term has no predicate */
+    EcsPredicateI8,
+    EcsPredicateI16,
+    EcsPredicateI32,
+    EcsPredicateI64,
+    EcsPredicateU8,
+    EcsPredicateU16,
+    EcsPredicateU32,
+    EcsPredicateU64,
+    EcsPredicateF32,
+    EcsPredicateF64
+} ecs_predicate_kind_t;
+
+/** Operation that is applied by a term predicate */
+typedef enum ecs_predicate_op_t {
+    EcsPredicateEq,       /* value == operand */
+    EcsPredicateNeq,      /* value != operand */
+    EcsPredicateLt,       /* value < operand */
+    EcsPredicateLtEq,     /* value <= operand */
+    EcsPredicateGt,       /* value > operand */
+    EcsPredicateGtEq,     /* value >= operand */
+    EcsPredicateMaskAny,  /* (value & mask) != 0 */
+    EcsPredicateMaskAll,  /* (value & mask) == mask */
+    EcsPredicateMaskNone  /* (value & mask) == 0 */
+} ecs_predicate_op_t;
+
+/** Type that describes a test on a value of the component matched by a term.
+ * When a term has a predicate, filters and queries only return the entities
+ * for which the test passes. Results are split up into ranges of consecutive
+ * matching entities. */
+typedef struct ecs_term_predicate_t {
+    const char *member;         /* Name of the member to test. Requires the meta
+                                 * addon, which is used to populate the offset
+                                 * and kind members. Nested members can be 
+                                 * specified by separating names with a '.' */
+
+    ecs_size_t offset;          /* Offset of value in component */
+    ecs_predicate_kind_t kind;  /* Type of value */
+    ecs_predicate_op_t op;      /* Operation to apply to value */
+    double value;               /* Operand for comparison operations. The operand
+                                 * is converted to the type of the value. */
+    uint64_t mask;              /* Operand for mask operations */
+    ecs_entity_t index;         /* Member index for the tested member (optional,
+                                 * see ecs_member_index_init). Filter iterators
+                                 * use the index to only visit entities that
+                                 * can pass the predicate. */
+} ecs_term_predicate_t;
+
 /** Type that describes a term (single element in a query) */
 struct ecs_term_t {
     ecs_id_t id;                /* Component id to be matched by term. Can be
@@ -3077,6 +3164,8 @@ struct ecs_term_t {
     ecs_id_t id_flags;          /* Id flags of term id */
     char *name;                 /* Name of term */
 
+    ecs_term_predicate_t predicate; /* Test on component value (optional) */
+
     int32_t field_index;        /* Index of field for term in iterator */
     ecs_id_record_t *idr;       /* Cached pointer to internal index */
 
@@ -3318,6 +3407,17 @@ typedef struct ecs_worker_iter_t {
     int32_t count;
 } ecs_worker_iter_t;
 
+/* Member-index-iterator specific data */
+typedef struct ecs_member_index_iter_t {
+    const void *index;            /* Index that is iterated */
+    const ecs_entity_t *entities; /* Entities in current chunk */
+    int32_t cur;                  /* Position in current chunk */
+    int32_t count;                /* Number of entities in current chunk */
+    int32_t chunk;                /* Current chunk */
+    int32_t last_chunk;           /* Last chunk of lookup */
+    int32_t last_count;           /* Number of entities in last chunk */
+} ecs_member_index_iter_t;
+
 /* Convenience struct to iterate table array for id */
 typedef struct ecs_table_cache_iter_t {
     struct ecs_table_cache_hdr_t *cur, *next;
@@ -3354,6 +3454,7 @@ typedef enum ecs_iter_kind_t {
     EcsIterEvalCondition,
     EcsIterEvalTables,
     EcsIterEvalChain,
+    EcsIterEvalIndex,
     EcsIterEvalNone
 } ecs_iter_kind_t;
 
@@ -3364,6 +3465,16 @@ typedef struct ecs_filter_iter_t {
     ecs_term_iter_t term_iter;
     int32_t matches_left;
     int32_t pivot_term;
+    int32_t predicate_row;  /* Next row to test for predicates */
+    int32_t predicate_end;  /* End of rows to test for predicates */
+
+    /* Entities of member index, if a term predicate has an index */
+    ecs_member_index_iter_t index_iter;
+
+    /* Id records of terms for which table lists are intersected */
+    ecs_id_record_t **intersect_idrs;
+    int32_t *intersect_pos; /* Current position in sorted table lists */
+    int32_t intersect_count;
 } ecs_filter_iter_t;
 
 /** Query-iterator specific data */
@@ -3373,7 +3484,14 @@ typedef struct ecs_query_iter_t {
     int32_t sparse_smallest;
     int32_t sparse_first;
     int32_t bitset_first;
+    int32_t predicate_row;
+    int32_t predicate_end;
+    int32_t prev_first;     /* First row of the previous result */
+    int32_t prev_count;     /* Number of rows in the previous result */
     int32_t skip_count;
+    ecs_query_table_node_t *batch_node; /* Node of the current batched result */
+    int32_t batch_left;     /* Rows left in current result after batch */
+    bool skip_counters;     /* Results are counted by a chained iterator */
 } ecs_query_iter_t;
 
 /** Snapshot-iterator specific data */
@@ -3428,6 +3546,7 @@ typedef struct ecs_iter_private_t {
         ecs_snapshot_iter_t snapshot;
         ecs_page_iter_t page;
         ecs_worker_iter_t worker;
+        ecs_member_index_iter_t member_index;
     } iter;                       /* Iterator specific data */
 
     ecs_iter_cache_t cache;       /* Inline arrays to reduce allocations */
@@ -4076,6 +4195,22 @@ typedef struct ecs_query_desc_t {
      * Subqueries can be nested. */
     ecs_query_t *parent;
 
+    /* If set, matched tables keep track of which rows changed for each column.
+     * This makes it possible to only iterate changed rows by setting the
+     * EcsIterChangedOnly flag on a query iterator. */
+    bool track_rows;
+
+    /* If set, the iterator prefetches the entities and component columns of
+     * the next result while the current result is processed. This can improve
+     * performance of queries that match many small tables. */
+    bool prefetch;
+
+    /* If set, results are split up in batches with at most the specified
+     * number of rows. Keeping batches small enough for the component columns
+     * of a batch to fit in the CPU cache can improve performance of systems
+     * that access multiple components of large tables. */
+    int32_t max_batch;
+
     /* Entity associated with query (optional) */
     ecs_entity_t entity;
 } ecs_query_desc_t;
@@ -4204,6 +4339,7 @@ typedef struct ecs_world_info_t {
     int64_t id_delete_total;          /* Total number of times an id was deleted */
     int64_t table_create_total;       /* Total number of times a table was created */
     int64_t table_delete_total;       /* Total number of times a table was deleted */
+    int64_t table_match_total;        /* Total number of times a table was evaluated for a query */
     int64_t pipeline_build_count_total; /* Total number of pipeline builds */
     int64_t systems_ran_frame;        /* Total number of systems ran in last frame */
     int64_t observers_ran_frame;      /* Total number of times observer was invoked */
@@ -4221,6 +4357,9 @@ typedef struct ecs_world_info_t {
     int32_t table_record_count;       /* Total number of table records (entries in table caches) */
     int32_t table_storage_count;      /* Total number of table storages */
 
+    int32_t target_index_count;       /* Number of entries in relationship target indices */
+    int32_t target_index_memory;      /* Memory used by relationship target indices, in bytes */
+
     /* -- Command counts -- */
     struct {
         int64_t add_count;             /* add commands processed */
@@ -4249,6 +4388,14 @@ typedef struct ecs_query_group_info_t {
     void *ctx;            /* Group context, returned by on_group_create */
 } ecs_query_group_info_t;
 
+/** Type that contains cardinality estimates for a filter or rule. */
+typedef struct ecs_estimate_t {
+    int32_t table_count;      /* Estimated number of matching tables */
+    int32_t entity_count;     /* Estimated number of matching entities */
+    int32_t max_table_count;  /* Upper bound for number of matching tables */
+    int32_t max_entity_count; /* Upper bound for number of matching entities */
+} ecs_estimate_t;
+
 /** @} */
 
 /* Only include deprecated definitions if deprecated addon is required */
@@ -4422,6 +4569,11 @@ FLECS_API extern const ecs_entity_t EcsTag;
  * are also marked as exclusive. */
 FLECS_API extern const ecs_entity_t EcsUnion;
 
+/* Can be added to relationship to maintain a reverse index from targets to the
+ * entities that have the relationship with the target. This makes it possible
+ * to find all sources for a (R, target) pair in O(1). */
+FLECS_API extern const ecs_entity_t EcsTargetIndex;
+
 /* Tag to indicate name identifier */
 FLECS_API extern const ecs_entity_t EcsName;
 
@@ -5935,6 +6087,28 @@ ecs_entity_t ecs_get_target_for_id(
     ecs_entity_t rel,
     ecs_id_t id);
 
+/** Get the sources for a relationship target.
+ * This operation returns the entities that have the (rel, target) pair. The
+ * relationship must have the TargetIndex property, which maintains a reverse
+ * index from targets to sources so that the lookup does not have to iterate 
+ * any tables.
+ *
+ * The returned array is owned by the world, and is invalidated by operations
+ * that add or remove (rel, *) pairs.
+ *
+ * @param world The world.
+ * @param rel The relationship (must have the TargetIndex property).
+ * @param target The relationship target.
+ * @param count_out Out parameter for the number of sources.
+ * @return Array with sources, NULL if no entity has the pair.
+ */
+FLECS_API
+const ecs_entity_t* ecs_get_sources(
+    const ecs_world_t *world,
+    ecs_entity_t rel,
+    ecs_entity_t target,
+    int32_t *count_out);
+
 /** Enable or disable an entity.
  * This operation enables or disables an entity by adding or removing the
  * EcsDisabled tag. A disabled entity will not be matched with any systems,
@@ -6618,6 +6792,30 @@ int32_t ecs_filter_pivot_term(
     const ecs_world_t *world,
     const ecs_filter_t *filter);
 
+/** Estimate number of tables and entities matched by filter.
+ * This operation returns an estimate of how many tables and entities a filter
+ * will return, without iterating the filter. The upper bounds are computed
+ * from the tables of the term with the fewest tables. The estimates scale the
+ * upper bounds with the fraction of a small sample of those tables that also
+ * matches the other terms, which makes them exact for small filters.
+ * 
+ * Terms that traverse relationships (other than IsA when the world has no IsA
+ * relationships) and terms that are not matched on This do not constrain the
+ * estimate. If a filter has no terms that match This, it yields a single
+ * result without entities.
+ * 
+ * The cost of the operation is proportional to the number of terms times the
+ * sample size, plus the number of tables of the smallest term.
+ * 
+ * @param world The world.
+ * @param filter The filter.
+ * @return The estimate.
+ */
+FLECS_API
+ecs_estimate_t ecs_filter_estimate(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter);
+
 /** Iterate tables matched by filter.
  * This operation progresses the filter iterator to the next table. The 
  * iterator must have been initialized with `ecs_filter_iter`. This operation 
@@ -6879,6 +7077,30 @@ void ecs_query_set_group(
     ecs_iter_t *it,
     uint64_t group_id);
 
+/** Limit query iterator to the groups assigned to a worker.
+ * This operation divides the groups of a query over count workers, and limits
+ * the results returned by the iterator to the groups for the worker at the
+ * specified index. Groups are never split up across workers, which means that
+ * workers can process the entities in their groups without contention.
+ * 
+ * Groups are assigned such that each worker gets roughly the same number of
+ * entities and tables. Workers iterate a contiguous range of groups in the
+ * query cache, which can be computed without coordination between workers.
+ * 
+ * The query must have a group_by function, and the iterator must be a query
+ * iterator. The operation must be called before the first call to 
+ * ecs_query_next.
+ * 
+ * @param it The query iterator.
+ * @param index The index of the current worker.
+ * @param count The total number of workers.
+ */
+FLECS_API
+void ecs_query_set_group_worker(
+    ecs_iter_t *it,
+    int32_t index,
+    int32_t count);
+
 /** Get context of query group.
  * This operation returns the context of a query group as returned by the 
  * on_group_create callback.
@@ -9068,6 +9290,9 @@ int ecs_value_move_ctor(
 #ifdef FLECS_NO_JOURNAL
 #undef FLECS_JOURNAL
 #endif
+#ifdef FLECS_NO_TRACING
+#undef FLECS_TRACING
+#endif
 
 /* Always included, if disabled functions are replaced with dummy macros */
 /**
@@ -9818,6 +10043,14 @@ int ecs_app_set_frame_action(
  * access to application data for remote applications.
  * 
  * A description of the API can be found in docs/RestApi.md
+ *
+ * By default requests are handled on the main thread by a system that runs at
+ * the end of each frame. When EcsRest::threaded is set, requests are handled 
+ * by a separate thread while the world is in readonly mode, or while the main
+ * thread sleeps to meet the target FPS. This prevents requests from adding to
+ * the frame time. A request that is still being handled when readonly mode 
+ * ends delays the main thread until the request is done. Replies of the REST
+ * thread are sent when complete, and are not streamed in chunks.
  */
 
 #ifdef FLECS_REST
@@ -9857,6 +10090,7 @@ FLECS_API extern const ecs_entity_t ecs_id(EcsRest);
 typedef struct {
     uint16_t port;        /* Port of server (optional, default = 27750) */
     char *ipaddr;         /* Interface address (optional, default = 0.0.0.0) */
+    bool threaded;        /* Handle requests on a separate thread (optional) */
     void *impl;
 } EcsRest;
 
@@ -10419,6 +10653,11 @@ typedef struct ecs_system_desc_t {
     /* If true, system will be ran on multiple threads */
     bool multi_threaded;
 
+    /* If true, system will be ran on multiple threads, where each thread
+     * iterates whole groups of the system query. Requires a query with a
+     * group_by function. */
+    bool multi_threaded_groups;
+
     /* If true, system will have access to actuall world. Cannot be true at the
      * same time as multi_threaded. */
     bool no_readonly;
@@ -10640,6 +10879,26 @@ typedef union ecs_metric_t {
     ecs_counter_t counter;
 } ecs_metric_t;
 
+#define ECS_HISTOGRAM_BUCKET_COUNT (192)
+
+/* Histogram with logarithmic buckets, used to measure latency distributions.
+ * Buckets have a precision of 12.5%, and span from 1 microsecond to ~60 
+ * seconds. Counts are cumulative, the samples for a measurement interval are
+ * the difference between two histograms. */
+typedef struct ecs_histogram_t {
+    uint32_t count[ECS_HISTOGRAM_BUCKET_COUNT];
+} ecs_histogram_t;
+
+/* Latency percentiles (in seconds), computed from a histogram */
+typedef struct ecs_latency_t {
+    ecs_float_t p50[ECS_STAT_WINDOW];
+    ecs_float_t p90[ECS_STAT_WINDOW];
+    ecs_float_t p99[ECS_STAT_WINDOW];
+    ecs_float_t p999[ECS_STAT_WINDOW];
+    ecs_histogram_t start;                     /* Histogram at start of interval */
+    ecs_histogram_t last;                      /* Histogram at last measurement */
+} ecs_latency_t;
+
 typedef struct ecs_world_stats_t {
     int32_t first_;
 
@@ -10659,6 +10918,7 @@ typedef struct ecs_world_stats_t {
         ecs_metric_t type_count;          /* Number of registered types */
         ecs_metric_t create_count;        /* Number of times id has been created */
         ecs_metric_t delete_count;        /* Number of times id has been deleted */
+        ecs_metric_t target_index_count;  /* Number of entries in relationship target indices */
     } ids;
 
     /* Tables */
@@ -10671,6 +10931,7 @@ typedef struct ecs_world_stats_t {
         ecs_metric_t storage_count;        /* Number of table storages */
         ecs_metric_t create_count;         /* Number of times table has been created */
         ecs_metric_t delete_count;         /* Number of times table has been deleted */
+        ecs_metric_t match_count;          /* Number of times table has been evaluated for a query */
     } tables;
 
     /* Queries & events */
@@ -10733,10 +10994,21 @@ typedef struct ecs_world_stats_t {
         ecs_metric_t stack_alloc_count;    /* Page allocations per frame */
         ecs_metric_t stack_free_count;     /* Page frees per frame */
         ecs_metric_t stack_outstanding_alloc_count; /* Difference between allocs & frees */
+
+        /* Index data */
+        ecs_metric_t target_index_memory;  /* Memory used by relationship target indices */
     } memory;
 
     int32_t last_;
 
+    /* Latency percentiles (frame & merge time are measured when frame time is
+     * measured, sync time is measured when system time is measured) */
+    struct {
+        ecs_latency_t frame_time;          /* Time spent processing a frame */
+        ecs_latency_t merge_time;          /* Time spent in a single merge */
+        ecs_latency_t sync_time;           /* Time main thread spent in sync points (includes merge) */
+    } latency;
+
     /** Current position in ringbuffer */
     int32_t t;
 } ecs_world_stats_t;
@@ -10747,6 +11019,15 @@ typedef struct ecs_query_stats_t {
     ecs_metric_t matched_table_count;       /* Matched non-empty tables */    
     ecs_metric_t matched_empty_table_count; /* Matched empty tables */
     ecs_metric_t matched_entity_count;      /* Number of matched entities */
+
+    /* Profiling counters (only collected with FLECS_QUERY_COUNTERS) */
+    ecs_metric_t iterated_table_count;      /* Results yielded by iterators */
+    ecs_metric_t iterated_entity_count;     /* Entities yielded by iterators */
+    ecs_metric_t skipped_table_count;       /* Tables skipped without results */
+    ecs_metric_t change_check_count;        /* Change detection checks */
+    ecs_metric_t bytes_touched;             /* Bytes of component data yielded */
+    ecs_metric_t rematch_time;              /* Time spent rematching tables */
+    ecs_metric_t sort_time;                 /* Time spent sorting tables */
     int32_t last_;
 
     /** Current position in ringbuffer */
@@ -10760,10 +11041,18 @@ typedef struct ecs_system_stats_t {
     ecs_metric_t invoke_count;     /* Number of times system is invoked */
     ecs_metric_t active;           /* Whether system is active (is matched with >0 entities) */
     ecs_metric_t enabled;          /* Whether system is enabled */
+
+    /* Hardware counters (only collected with FLECS_PERF_COUNTERS) */
+    ecs_metric_t cycles;           /* CPU cycles spent in system */
+    ecs_metric_t instructions;     /* Instructions retired by system */
+    ecs_metric_t cache_misses;     /* Last level cache misses */
+    ecs_metric_t branch_misses;    /* Mispredicted branches */
     int32_t last_;
 
     bool task;                     /* Is system a task */
 
+    ecs_latency_t time_latency;    /* Percentiles of time spent per invocation */
+
     ecs_query_stats_t query;
 } ecs_system_stats_t;
 
@@ -11287,6 +11576,10 @@ void FlecsDocImport(
  * enumerations and bitmasks are encoded as strings.
  * 
  * See docs/JsonFormat.md for a description of the JSON format.
+ * 
+ * Values, entities and iterators can also be serialized to CBOR (RFC 8949),
+ * which encodes the same structure as the JSON format in a compact binary
+ * representation.
  */
 
 #ifdef FLECS_JSON
@@ -11491,6 +11784,7 @@ typedef struct ecs_iter_to_json_desc_t {
     bool serialize_colors;        /* Include doc color for entities */
     bool measure_eval_duration;   /* Include evaluation duration */
     bool serialize_type_info;     /* Include type information */
+    int32_t threads;              /* Serialize results on multiple threads (requires OS API threading) */
 } ecs_iter_to_json_desc_t;
 
 #define ECS_ITER_TO_JSON_INIT (ecs_iter_to_json_desc_t){\
@@ -11539,6 +11833,102 @@ int ecs_iter_to_json_buf(
     ecs_strbuf_t *buf_out,
     const ecs_iter_to_json_desc_t *desc);
 
+/** Serialize value into CBOR.
+ * Same as ecs_array_to_json_buf, but serializes to CBOR. If count is >= 1 and
+ * the type only contains members of a single primitive type without padding,
+ * the values are written as a single typed array (RFC 8746) that contains the
+ * raw data in the byte order of the host.
+ * 
+ * The result may contain \0 characters, use ecs_strbuf_written to obtain the
+ * size of the result.
+ * 
+ * @param world The world.
+ * @param type The type of the value to serialize.
+ * @param data The value to serialize.
+ * @param count The number of elements to serialize.
+ * @param buf_out The strbuf to append the CBOR data to.
+ * @return Zero if success, non-zero if failed.
+ */
+FLECS_API
+int ecs_array_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const void *data,
+    int32_t count,
+    ecs_strbuf_t *buf_out);
+
+/** Serialize value into CBOR.
+ * Same as ecs_array_to_cbor_buf, with count = 0.
+ * 
+ * @param world The world.
+ * @param type The type of the value to serialize.
+ * @param data The value to serialize.
+ * @param buf_out The strbuf to append the CBOR data to.
+ * @return Zero if success, non-zero if failed.
+ */
+FLECS_API
+int ecs_ptr_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const void *data,
+    ecs_strbuf_t *buf_out);
+
+/** Deserialize CBOR into value.
+ * This operation parses values serialized with ecs_array_to_cbor_buf. If count
+ * is 0, a single value is parsed. If count is >= 1, the data must contain an
+ * array or typed array with count elements.
+ * 
+ * @param world The world.
+ * @param data The CBOR data.
+ * @param size The size of the CBOR data.
+ * @param type The type of the value to deserialize.
+ * @param data_out Pointer to the memory to write to.
+ * @param count The number of elements to deserialize.
+ * @return Pointer to the byte after the last one read, or NULL if failed.
+ */
+FLECS_API
+const void* ecs_parse_cbor(
+    const ecs_world_t *world,
+    const void *data,
+    ecs_size_t size,
+    ecs_entity_t type,
+    void *data_out,
+    int32_t count);
+
+/** Serialize entity into CBOR.
+ * Same as ecs_entity_to_json_buf, but serializes to CBOR. Type information is
+ * not serialized.
+ * 
+ * @param world The world.
+ * @param entity The entity to serialize.
+ * @param buf_out The strbuf to append the CBOR data to.
+ * @return Zero if success, non-zero if failed.
+ */
+FLECS_API
+int ecs_entity_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_strbuf_t *buf_out,
+    const ecs_entity_to_json_desc_t *desc);
+
+/** Serialize iterator into CBOR.
+ * Same as ecs_iter_to_json_buf, but serializes to CBOR. Component values of
+ * owned fields are written as typed arrays where the layout of the component
+ * allows it, entity ids are always written as a typed array. Type information
+ * is not serialized.
+ * 
+ * @param world The world.
+ * @param iter The iterator to serialize.
+ * @param buf_out The strbuf to append the CBOR data to.
+ * @return Zero if success, non-zero if failed.
+ */
+FLECS_API
+int ecs_iter_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_iter_t *iter,
+    ecs_strbuf_t *buf_out,
+    const ecs_iter_to_json_desc_t *desc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -12064,8 +12454,24 @@ typedef struct ecs_meta_type_op_t {
     ecs_hashmap_t *members; /* string -> member index (structs only) */
 } ecs_meta_type_op_t;
 
+/** Operation of a flattened JSON serializer program. An operation appends a
+ * literal with the punctuation & (escaped) member names that precede a value,
+ * followed by the value. The last operation has kind EcsOpPop, and only 
+ * appends the literal that closes the value. */
+typedef struct ecs_meta_json_op_t {
+    ecs_meta_type_op_kind_t kind; /* Primitive kind, or EcsOpPop for last op */
+    ecs_size_t offset;      /* Offset of value (includes offset of parents) */
+    int32_t literal;        /* Offset of literal in literals string */
+    int32_t literal_len;    /* Length of literal */
+} ecs_meta_json_op_t;
+
 typedef struct EcsMetaTypeSerialized {
     ecs_vector_t* ops;     /* vector<ecs_meta_type_op_t> */
+
+    /* Flattened JSON serializer program, only created for types with members
+     * that are primitives or structs of primitives. */
+    ecs_vector_t* json_ops; /* vector<ecs_meta_json_op_t> */
+    char *json_literals;
 } EcsMetaTypeSerialized;
 
 
@@ -12158,6 +12564,26 @@ FLECS_API
 const char* ecs_meta_get_member(
     const ecs_meta_cursor_t *cursor);
 
+/** Find offset and type of a member.
+ * Nested members can be found by separating member names with a '.', as in
+ * "position.x". Only members that hold a single value (not an inline array or
+ * a struct) can be found.
+ *
+ * @param world The world.
+ * @param type The (struct) type that contains the member.
+ * @param member The name of the member.
+ * @param offset_out Output parameter for the member offset.
+ * @param type_out Output parameter for the member type.
+ * @return Zero if success, non-zero if the member was not found.
+ */
+FLECS_API
+int ecs_meta_member_offset(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const char *member,
+    ecs_size_t *offset_out,
+    ecs_entity_t *type_out);
+
 /** The set functions assign the field with the specified value. If the value
  * does not have the same type as the field, it will be cased to the field type.
  * If no valid conversion is available, the operation will fail. */
@@ -12406,6 +12832,123 @@ ecs_entity_t ecs_quantity_init(
     ecs_world_t *world,
     const ecs_entity_desc_t *desc);
 
+
+/** Member indices */
+
+/** Kind of member index */
+typedef enum ecs_member_index_kind_t {
+    EcsMemberIndexSorted,   /* Sorted index, supports equality & range lookups */
+    EcsMemberIndexHash      /* Hash index, supports equality lookups */
+} ecs_member_index_kind_t;
+
+/** Used with ecs_member_index_init. */
+typedef struct ecs_member_index_desc_t {
+    /* Existing entity to associate with index (optional) */
+    ecs_entity_t entity;
+
+    /* Member to index. Must be a member of a struct that is registered as a
+     * component, and must have a primitive, enum or bitmask type that is not
+     * a string. */
+    ecs_entity_t member;
+
+    /* Index kind */
+    ecs_member_index_kind_t kind;
+} ecs_member_index_desc_t;
+
+/** Create a new member index.
+ * A member index keeps track of the value of a component member for all 
+ * entities that own the component, which allows for finding entities by member
+ * value without iterating tables. The index is updated when the component is
+ * set (ecs_set, ecs_modified) or removed. Values that are written without 
+ * notifying the world (e.g. through ecs_get_mut without ecs_modified) are not
+ * picked up by the index.
+ * 
+ * The index is an entity that can be deleted to free the index.
+ * 
+ * An index can be used in three ways:
+ *  - ecs_member_index_find returns the entities for a range of values
+ *  - ecs_member_index_iter returns an iterator that can be chained with
+ *    ecs_filter_chain_iter
+ *  - the index member of a term predicate (ecs_term_predicate_t) lets filter
+ *    iterators only visit the entities that can pass the predicate. This
+ *    requires a term that matches $this with EcsSelf, and a predicate with an
+ *    Eq, Lt, LtEq, Gt or GtEq operation (Eq for a hash index).
+ * 
+ * Cached queries accept predicates with an index, but test the predicate on
+ * all rows of the matched tables. Rules do not support predicates.
+ * 
+ * @param world The world.
+ * @param desc Index parameters.
+ * @return The index entity, or 0 if the index could not be created.
+ */
+FLECS_API
+ecs_entity_t ecs_member_index_init(
+    ecs_world_t *world,
+    const ecs_member_index_desc_t *desc);
+
+/** Find entities in member index.
+ * This operation returns the entities for which the member value is in the
+ * range [min, max]. The min and max parameters point to values of the member
+ * type. If min or max is NULL, the range is not bounded on that side. A hash
+ * index only supports equality lookups, which require min and max to be equal.
+ * 
+ * Entities in a sorted index are returned in order of member value. The 
+ * returned array is owned by the index, and is invalidated by operations that
+ * modify the index. A sorted index stores entities in chunks, and a result that
+ * spans more than one chunk is copied to a buffer of the index that is reused
+ * by the next lookup. Use ecs_member_index_iter to iterate a large range 
+ * without copying.
+ * 
+ * @param world The world.
+ * @param index The member index.
+ * @param min Lower bound (inclusive), or NULL.
+ * @param max Upper bound (inclusive), or NULL.
+ * @param count_out Out parameter for the number of entities.
+ * @return Array with entities, NULL if no entities were found.
+ */
+FLECS_API
+const ecs_entity_t* ecs_member_index_find(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *min,
+    const void *max,
+    int32_t *count_out);
+
+/** Create iterator for member index lookup.
+ * This returns an iterator for the entities found by ecs_member_index_find. 
+ * Each result contains a range of consecutive rows in a single table, which
+ * allows the iterator to be used as input for ecs_filter_chain_iter to 
+ * constrain the results of a filter to entities that match the lookup:
+ * 
+ *   ecs_iter_t it = ecs_member_index_iter(world, index, &min, &max);
+ *   ecs_iter_t fit = ecs_filter_chain_iter(&it, filter);
+ *   while (ecs_filter_next(&fit)) { }
+ * 
+ * The lookup is performed when the iterator is created. The iterator does not
+ * have fields. The index must not be modified while the iterator is in use.
+ * 
+ * @param world The world.
+ * @param index The member index.
+ * @param min Lower bound (inclusive), or NULL.
+ * @param max Upper bound (inclusive), or NULL.
+ * @return The iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_member_index_iter(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *min,
+    const void *max);
+
+/** Progress member index iterator.
+ * 
+ * @param it The iterator.
+ * @return True if iterator has more results, false if not.
+ */
+FLECS_API
+bool ecs_member_index_next(
+    ecs_iter_t *it);
+
 /* Convenience macros */
 
 #define ecs_primitive(world, ...)\
@@ -12435,6 +12978,9 @@ ecs_entity_t ecs_quantity_init(
 #define ecs_quantity(world, ...)\
     ecs_quantity_init(world, &(ecs_entity_desc_t) __VA_ARGS__ )
 
+#define ecs_member_index(world, ...)\
+    ecs_member_index_init(world, &(ecs_member_index_desc_t) __VA_ARGS__ )
+
 /* Module import */
 FLECS_API
 void FlecsMetaImport(
@@ -13078,6 +13624,19 @@ FLECS_API
 int32_t ecs_rule_var_count(
     const ecs_rule_t *rule);
 
+/** Estimate number of tables and entities evaluated by rule.
+ * This operation is similar to ecs_filter_estimate, except that terms that are
+ * matched on other variables than This also constrain the estimate. The result
+ * is an estimate of the number of tables and entities that the rule has to 
+ * evaluate, which can be used to compare the cost of rules.
+ * 
+ * @param rule The rule.
+ * @return The estimate.
+ */
+FLECS_API
+ecs_estimate_t ecs_rule_estimate(
+    const ecs_rule_t *rule);
+
 /** Find variable index.
  * This operation looks up the index of a variable in the rule. This index can
  * be used in operations like ecs_iter_set_var and ecs_iter_get_var.
@@ -13412,9 +13971,11 @@ char* ecs_parse_term(
  * Flecs application (for example, with a web-based UI) and request/visualize
  * data from the ECS world.
  * 
- * Each server instance creates a single thread used for receiving requests.
- * Receiving requests are enqueued and handled when the application calls
- * ecs_http_server_dequeue. This increases latency of request handling vs.
+ * Each server instance creates a single thread that uses non-blocking sockets
+ * to accept connections, receive requests and send replies (with epoll on 
+ * Linux, and poll on other platforms). A slow client does not hold up other
+ * clients. Received requests are enqueued and handled when the application
+ * calls ecs_http_server_dequeue. This increases latency of request handling vs.
  * responding directly in the receive thread, but is better suited for 
  * retrieving data from ECS applications, as requests can be processed by an ECS
  * system without having to lock the world.
@@ -13437,6 +13998,9 @@ char* ecs_parse_term(
 /* Maximum number of query parameters in request */
 #define ECS_HTTP_QUERY_PARAM_COUNT_MAX (32)
 
+/* Size of reply body at which request handlers should flush a streamed reply */
+#define ECS_HTTP_CHUNK_SIZE (64 * 1024)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -13444,6 +14008,9 @@ extern "C" {
 /** HTTP server */
 typedef struct ecs_http_server_t ecs_http_server_t;
 
+/** Reply that remains open after the request handler returns */
+typedef struct ecs_http_stream_t ecs_http_stream_t;
+
 /** A connection manages communication with the remote host */
 typedef struct {
     uint64_t id;
@@ -13491,10 +14058,11 @@ typedef struct {
     const char* status;         /* default = OK */
     const char* content_type;   /* default = application/json */
     ecs_strbuf_t headers;       /* default = "" */
+    void *stream;               /* Used by ecs_http_reply_flush (internal) */
 } ecs_http_reply_t;
 
 #define ECS_HTTP_REPLY_INIT \
-    (ecs_http_reply_t){200, ECS_STRBUF_INIT, "OK", "application/json", ECS_STRBUF_INIT}
+    (ecs_http_reply_t){200, ECS_STRBUF_INIT, "OK", "application/json", ECS_STRBUF_INIT, NULL}
 
 /** Request callback.
  * Invoked for each valid request. The function should populate the reply and
@@ -13511,7 +14079,8 @@ typedef struct {
     void *ctx;                        /* Passed to callback (optional) */
     uint16_t port;                    /* HTTP port */
     const char *ipaddr;               /* Interface to listen on (optional) */
-    int32_t send_queue_wait_ms;       /* Send queue wait time when empty */
+    int32_t send_queue_wait_ms;       /* Unused, server thread is woken up
+                                       * when replies are enqueued */
 } ecs_http_server_desc_t;
 
 /** Create server. 
@@ -13563,6 +14132,78 @@ FLECS_API
 void ecs_http_server_stop(
     ecs_http_server_t* server);
 
+/** Send part of a reply body.
+ * This operation sends the data that has been appended to the reply body as a
+ * chunk (using chunked transfer encoding), and clears the body. Request
+ * handlers can use this to send large replies without building the entire
+ * reply in memory. After the first flush, the code, status, content type and
+ * headers of the reply can no longer be changed.
+ *
+ * When too much data is queued for the connection, this operation blocks until
+ * queued data has been sent. Replies to HTTP/1.0 requests are not streamed,
+ * and are sent when the request handler returns.
+ *
+ * This operation may only be called from a request handler.
+ *
+ * @param reply The reply.
+ * @return Zero if success, non-zero if the connection was closed.
+ */
+FLECS_API
+int ecs_http_reply_flush(
+    ecs_http_reply_t *reply);
+
+/** Keep reply open after the request handler returns.
+ * The reply is sent with chunked transfer encoding. The code, status, content
+ * type, headers and body of the reply are sent when the request handler 
+ * returns, after which the application can send more data with
+ * ecs_http_stream_send, until the stream is closed with ecs_http_stream_close.
+ * Replies to requests that are pipelined on the same connection are sent after
+ * the stream is closed.
+ *
+ * Streams must be closed before the server is deleted. This operation may only
+ * be called from a request handler.
+ *
+ * @param reply The reply.
+ * @return The stream, or NULL if the request wasn't made with HTTP/1.1.
+ */
+FLECS_API
+ecs_http_stream_t* ecs_http_reply_open_stream(
+    ecs_http_reply_t *reply);
+
+/** Send data to open stream.
+ * This operation sends the data in the buffer as a chunk, and clears the
+ * buffer. The operation does not block. Applications can use 
+ * ecs_http_stream_queued to not send more data to clients that don't keep up.
+ *
+ * @param stream The stream.
+ * @param buf The data to send.
+ * @return Zero if success, non-zero if the connection was closed.
+ */
+FLECS_API
+int ecs_http_stream_send(
+    ecs_http_stream_t *stream,
+    ecs_strbuf_t *buf);
+
+/** Return number of bytes sent to stream that haven't been written yet.
+ *
+ * @param stream The stream.
+ * @return The number of queued bytes.
+ */
+FLECS_API
+int32_t ecs_http_stream_queued(
+    const ecs_http_stream_t *stream);
+
+/** Close stream.
+ * This sends the last chunk of the reply. If the request wasn't kept alive, the
+ * connection is closed when all data has been written. The stream can no 
+ * longer be used after this operation.
+ *
+ * @param stream The stream.
+ */
+FLECS_API
+void ecs_http_stream_close(
+    ecs_http_stream_t *stream);
+
 /** Find header in request. 
  * 
  * @param req The request.
@@ -13593,6 +14234,101 @@ const char* ecs_http_get_param(
 
 #endif // FLECS_HTTP
 
+#endif
+#ifdef FLECS_TRACING
+#ifdef FLECS_NO_TRACING
+#error "FLECS_NO_TRACING failed: TRACING is required by other addons"
+#endif
+/**
+ * @file tracing.h
+ * @brief Tracing addon that records where frame time is spent.
+ *
+ * The tracing addon records begin and end events for frames, pipeline
+ * operations, systems, merges, worker synchronization and observers. Each
+ * thread writes events to its own ring buffer, so recording does not require
+ * locks. Recorded events can be exported to the Chrome trace event format,
+ * which can be loaded in chrome://tracing or https://ui.perfetto.dev.
+ *
+ * When tracing is not started, the overhead of the addon is a single check per
+ * instrumented function.
+ */
+
+#ifdef FLECS_TRACING
+
+#ifndef FLECS_TRACING_H
+#define FLECS_TRACING_H
+
+/* Default number of events per thread (must be a power of 2) */
+#define ECS_TRACING_DEFAULT_EVENT_COUNT (65536)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Kinds of traced events */
+typedef enum ecs_trace_kind_t {
+    EcsTraceFrame,
+    EcsTracePipelineOp,
+    EcsTraceSystem,
+    EcsTraceMerge,
+    EcsTraceWorkerSync,
+    EcsTraceObserver
+} ecs_trace_kind_t;
+
+/** Start recording trace events.
+ * This operation allocates a ring buffer for each stage (thread) in the world,
+ * and starts recording events. When a ring buffer is full, the oldest events
+ * are overwritten. Events recorded before a previous ecs_tracing_stop are
+ * discarded.
+ *
+ * @param world The world.
+ * @param event_count Number of events per thread (0 for default). Rounded up
+ *        to the next power of 2.
+ */
+FLECS_API
+void ecs_tracing_start(
+    ecs_world_t *world,
+    int32_t event_count);
+
+/** Stop recording trace events.
+ * This frees the ring buffers with recorded events.
+ *
+ * @param world The world.
+ */
+FLECS_API
+void ecs_tracing_stop(
+    ecs_world_t *world);
+
+/** Test if world is recording trace events.
+ *
+ * @param world The world.
+ * @return True if tracing is started, false if not.
+ */
+FLECS_API
+bool ecs_tracing_enabled(
+    const ecs_world_t *world);
+
+/** Serialize recorded events to Chrome trace JSON.
+ * This operation must not be called while the world is progressing, as that
+ * would race with the threads that record events.
+ *
+ * The returned string must be freed with ecs_os_free.
+ *
+ * @param world The world.
+ * @return JSON string with the trace events, or NULL if tracing is not started.
+ */
+FLECS_API
+char* ecs_tracing_to_json(
+    const ecs_world_t *world);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
+
 #endif
 #ifdef FLECS_OS_API_IMPL
 #ifdef FLECS_NO_OS_API_IMPL
@@ -13926,6 +14662,7 @@ namespace flecs {
 using world_t = ecs_world_t;
 using world_info_t = ecs_world_info_t;
 using query_group_info_t = ecs_query_group_info_t;
+using estimate_t = ecs_estimate_t;
 using id_t = ecs_id_t;
 using entity_t = ecs_entity_t;
 using type_t = ecs_type_t;
@@ -14021,6 +14758,7 @@ static const flecs::entity_t Acyclic = EcsAcyclic;
 static const flecs::entity_t Symmetric = EcsSymmetric;
 static const flecs::entity_t With = EcsWith;
 static const flecs::entity_t OneOf = EcsOneOf;
+static const flecs::entity_t TargetIndex = EcsTargetIndex;
 
 /* Builtin relationships */
 static const flecs::entity_t IsA = EcsIsA;
@@ -23019,6 +23757,10 @@ struct filter_base {
         return m_filter_ptr->term_count;
     }
 
+    flecs::estimate_t estimate() const {
+        return ecs_filter_estimate(m_world, m_filter_ptr);
+    }
+
     flecs::string str() {
         char *result = ecs_filter_str(m_world, m_filter_ptr);
         return flecs::string(result);
@@ -23330,6 +24072,20 @@ public:
         return *this;
     }
 
+    /** Prefetch component columns of the next result while iterating.
+     */
+    Base& prefetch(bool value = true) {
+        m_desc->prefetch = value;
+        return *this;
+    }
+
+    /** Split up results in batches with at most the specified number of rows.
+     */
+    Base& max_batch(int32_t value) {
+        m_desc->max_batch = value;
+        return *this;
+    }
+
     /** Specify parent query (creates subquery) */
     Base& observable(const query_base& parent);
     
@@ -23919,6 +24675,16 @@ public:
         return *this;
     }
 
+    /** Specify whether system can run on multiple threads, where each thread
+     * iterates whole groups of the system query.
+     *
+     * @param value If true, groups of the system query are divided over threads.
+     */
+    Base& multi_threaded_groups(bool value = true) {
+        m_desc->multi_threaded_groups = value;
+        return *this;
+    }
+
     /** Specify whether system should be ran in staged context.
      *
      * @param value If false system will always run staged.
@@ -24600,6 +25366,10 @@ struct rule_base {
         m_rule = nullptr;
     }
 
+    flecs::estimate_t estimate() const {
+        return ecs_rule_estimate(m_rule);
+    }
+
     flecs::string str() {
         const ecs_filter_t *f = ecs_rule_get_filter(m_rule);
         char *result = ecs_filter_str(m_world, f);
@@ -40,6 +40,25 @@
  */
 // #define FLECS_ACCURATE_COUNTERS
 
+/** FLECS_QUERY_COUNTERS
+ * Define to collect profiling counters for cached queries and systems, such as
+ * the number of tables and entities iterated and the time spent sorting and
+ * rematching. Counters are reported by ecs_query_stats_get. Each stage keeps
+ * its own counters, which ecs_query_stats_get adds up, so counters are accurate
+ * for queries iterated by multiple threads. Updating a counter looks up the
+ * query in a map of the stage, which adds overhead to each iterated result.
+ */
+// #define FLECS_QUERY_COUNTERS
+
+/** FLECS_PERF_COUNTERS
+ * Define to collect hardware counters (cycles, instructions, last level cache
+ * misses and branch misses) for systems with perf_event_open. Counters are 
+ * only collected when system time is measured, and are reported by 
+ * ecs_system_stats_get. When counters are not available (e.g. on platforms 
+ * other than Linux, or when permission is denied) they are reported as 0.
+ */
+// #define FLECS_PERF_COUNTERS
+
 /* Make sure provided configuration is valid */
 #if defined(FLECS_DEBUG) && defined(FLECS_NDEBUG)
 #error "invalid configuration: cannot both define FLECS_DEBUG and FLECS_NDEBUG"
@@ -145,6 +164,7 @@
 #define FLECS_OS_API_IMPL   /* Default implementation for OS API */
 #define FLECS_HTTP          /* Tiny HTTP server for connecting to remote UI */
 #define FLECS_REST          /* REST API for querying application data */
+#define FLECS_TRACING       /* Chrome trace export of frames and systems */
 // #define FLECS_JOURNAL    /* Journaling addon (disabled by default) */
 #endif // ifndef FLECS_CUSTOM_BUILD
 
@@ -501,6 +521,56 @@ typedef struct ecs_term_id_t {
     ecs_flags32_t flags;        /* Term flags */
 } ecs_term_id_t;
 
+/** Type of the value that is tested by a term predicate */
+typedef enum ecs_predicate_kind_t {
+    EcsPredicateNone,   /* Term has no predicate */
+    EcsPredicateI8,
+    EcsPredicateI16,
+    EcsPredicateI32,
+    EcsPredicateI64,
+    EcsPredicateU8,
+    EcsPredicateU16,
+    EcsPredicateU32,
+    EcsPredicateU64,
+    EcsPredicateF32,
+    EcsPredicateF64
+} ecs_predicate_kind_t;
+
+/** Operation that is applied by a term predicate */
+typedef enum ecs_predicate_op_t {
+    EcsPredicateEq,       /* value == operand */
+    EcsPredicateNeq,      /* value != operand */
+    EcsPredicateLt,       /* value < operand */
+    EcsPredicateLtEq,     /* value <= operand */
+    EcsPredicateGt,       /* value > operand */
+    EcsPredicateGtEq,     /* value >= operand */
+    EcsPredicateMaskAny,  /* (value & mask) != 0 */
+    EcsPredicateMaskAll,  /* (value & mask) == mask */
+    EcsPredicateMaskNone  /* (value & mask) == 0 */
+} ecs_predicate_op_t;
+
+/** Type that describes a test on a value of the component matched by a term.
+ * When a term has a predicate, filters and queries only return the entities
+ * for which the test passes. Results are split up into ranges of consecutive
+ * matching entities. */
+typedef struct ecs_term_predicate_t {
+    const char *member;         /* Name of the member to test. Requires the meta
+                                 * addon, which is used to populate the offset
+                                 * and kind members. Nested members can be 
+                                 * specified by separating names with a '.' */
+
+    ecs_size_t offset;          /* Offset of value in component */
+    ecs_predicate_kind_t kind;  /* Type of value */
+    ecs_predicate_op_t op;      /* Operation to apply to value */
+    double value;               /* Operand for comparison operations. The operand
+                                 * is converted to the type of the value. */
+    uint64_t mask;              /* Operand for mask operations */
+    ecs_entity_t index;         /* Member index for the tested member (optional,
+                                 * see ecs_member_index_init). Filter iterators
+                                 * use the index to only visit entities that
+                                 * can pass the predicate. */
+} ecs_term_predicate_t;
+
 /** Type that describes a term (single element in a query) */
 struct ecs_term_t {
     ecs_id_t id;                /* Component id to be matched by term. Can be
@@ -518,6 +588,8 @@ struct ecs_term_t {
     ecs_id_t id_flags;          /* Id flags of term id */
     char *name;                 /* Name of term */
 
+    ecs_term_predicate_t predicate; /* Test on component value (optional) */
+
     int32_t field_index;        /* Index of field for term in iterator */
     ecs_id_record_t *idr;       /* Cached pointer to internal index */
 
@@ -812,6 +884,22 @@ typedef struct ecs_query_desc_t {
      * Subqueries can be nested. */
     ecs_query_t *parent;
 
+    /* If set, matched tables keep track of which rows changed for each column.
+     * This makes it possible to only iterate changed rows by setting the
+     * EcsIterChangedOnly flag on a query iterator. */
+    bool track_rows;
+
+    /* If set, the iterator prefetches the entities and component columns of
+     * the next result while the current result is processed. This can improve
+     * performance of queries that match many small tables. */
+    bool prefetch;
+
+    /* If set, results are split up in batches with at most the specified
+     * number of rows. Keeping batches small enough for the component columns
+     * of a batch to fit in the CPU cache can improve performance of systems
+     * that access multiple components of large tables. */
+    int32_t max_batch;
+
     /* Entity associated with query (optional) */
     ecs_entity_t entity;
 } ecs_query_desc_t;
@@ -940,6 +1028,7 @@ typedef struct ecs_world_info_t {
     int64_t id_delete_total;          /* Total number of times an id was deleted */
     int64_t table_create_total;       /* Total number of times a table was created */
     int64_t table_delete_total;       /* Total number of times a table was deleted */
+    int64_t table_match_total;        /* Total number of times a table was evaluated for a query */
     int64_t pipeline_build_count_total; /* Total number of pipeline builds */
     int64_t systems_ran_frame;        /* Total number of systems ran in last frame */
     int64_t observers_ran_frame;      /* Total number of times observer was invoked */
@@ -957,6 +1046,9 @@ typedef struct ecs_world_info_t {
     int32_t table_record_count;       /* Total number of table records (entries in table caches) */
     int32_t table_storage_count;      /* Total number of table storages */
 
+    int32_t target_index_count;       /* Number of entries in relationship target indices */
+    int32_t target_index_memory;      /* Memory used by relationship target indices, in bytes */
+
     /* -- Command counts -- */
     struct {
         int64_t add_count;             /* add commands processed */
@@ -985,6 +1077,14 @@ typedef struct ecs_query_group_info_t {
     void *ctx;            /* Group context, returned by on_group_create */
 } ecs_query_group_info_t;
 
+/** Type that contains cardinality estimates for a filter or rule. */
+typedef struct ecs_estimate_t {
+    int32_t table_count;      /* Estimated number of matching tables */
+    int32_t entity_count;     /* Estimated number of matching entities */
+    int32_t max_table_count;  /* Upper bound for number of matching tables */
+    int32_t max_entity_count; /* Upper bound for number of matching entities */
+} ecs_estimate_t;
+
 /** @} */
 
 /* Only include deprecated definitions if deprecated addon is required */
@@ -1137,6 +1237,11 @@ FLECS_API extern const ecs_entity_t EcsTag;
  * are also marked as exclusive. */
 FLECS_API extern const ecs_entity_t EcsUnion;
 
+/* Can be added to relationship to maintain a reverse index from targets to the
+ * entities that have the relationship with the target. This makes it possible
+ * to find all sources for a (R, target) pair in O(1). */
+FLECS_API extern const ecs_entity_t EcsTargetIndex;
+
 /* Tag to indicate name identifier */
 FLECS_API extern const ecs_entity_t EcsName;
 
@@ -2650,6 +2755,28 @@ ecs_entity_t ecs_get_target_for_id(
     ecs_entity_t rel,
     ecs_id_t id);
 
+/** Get the sources for a relationship target.
+ * This operation returns the entities that have the (rel, target) pair. The
+ * relationship must have the TargetIndex property, which maintains a reverse
+ * index from targets to sources so that the lookup does not have to iterate 
+ * any tables.
+ *
+ * The returned array is owned by the world, and is invalidated by operations
+ * that add or remove (rel, *) pairs.
+ *
+ * @param world The world.
+ * @param rel The relationship (must have the TargetIndex property).
+ * @param target The relationship target.
+ * @param count_out Out parameter for the number of sources.
+ * @return Array with sources, NULL if no entity has the pair.
+ */
+FLECS_API
+const ecs_entity_t* ecs_get_sources(
+    const ecs_world_t *world,
+    ecs_entity_t rel,
+    ecs_entity_t target,
+    int32_t *count_out);
+
 /** Enable or disable an entity.
  * This operation enables or disables an entity by adding or removing the
  * EcsDisabled tag. A disabled entity will not be matched with any systems,
@@ -3333,6 +3460,30 @@ int32_t ecs_filter_pivot_term(
     const ecs_world_t *world,
     const ecs_filter_t *filter);
 
+/** Estimate number of tables and entities matched by filter.
+ * This operation returns an estimate of how many tables and entities a filter
+ * will return, without iterating the filter. The upper bounds are computed
+ * from the tables of the term with the fewest tables. The estimates scale the
+ * upper bounds with the fraction of a small sample of those tables that also
+ * matches the other terms, which makes them exact for small filters.
+ * 
+ * Terms that traverse relationships (other than IsA when the world has no IsA
+ * relationships) and terms that are not matched on This do not constrain the
+ * estimate. If a filter has no terms that match This, it yields a single
+ * result without entities.
+ * 
+ * The cost of the operation is proportional to the number of terms times the
+ * sample size, plus the number of tables of the smallest term.
+ * 
+ * @param world The world.
+ * @param filter The filter.
+ * @return The estimate.
+ */
+FLECS_API
+ecs_estimate_t ecs_filter_estimate(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter);
+
 /** Iterate tables matched by filter.
  * This operation progresses the filter iterator to the next table. The 
  * iterator must have been initialized with `ecs_filter_iter`. This operation 
@@ -3594,6 +3745,30 @@ void ecs_query_set_group(
     ecs_iter_t *it,
     uint64_t group_id);
 
+/** Limit query iterator to the groups assigned to a worker.
+ * This operation divides the groups of a query over count workers, and limits
+ * the results returned by the iterator to the groups for the worker at the
+ * specified index. Groups are never split up across workers, which means that
+ * workers can process the entities in their groups without contention.
+ * 
+ * Groups are assigned such that each worker gets roughly the same number of
+ * entities and tables. Workers iterate a contiguous range of groups in the
+ * query cache, which can be computed without coordination between workers.
+ * 
+ * The query must have a group_by function, and the iterator must be a query
+ * iterator. The operation must be called before the first call to 
+ * ecs_query_next.
+ * 
+ * @param it The query iterator.
+ * @param index The index of the current worker.
+ * @param count The total number of workers.
+ */
+FLECS_API
+void ecs_query_set_group_worker(
+    ecs_iter_t *it,
+    int32_t index,
+    int32_t count);
+
 /** Get context of query group.
  * This operation returns the context of a query group as returned by the 
  * on_group_create callback.
@@ -7,6 +7,7 @@ namespace flecs {
 using world_t = ecs_world_t;
 using world_info_t = ecs_world_info_t;
 using query_group_info_t = ecs_query_group_info_t;
+using estimate_t = ecs_estimate_t;
 using id_t = ecs_id_t;
 using entity_t = ecs_entity_t;
 using type_t = ecs_type_t;
@@ -102,6 +103,7 @@ static const flecs::entity_t Acyclic = EcsAcyclic;
 static const flecs::entity_t Symmetric = EcsSymmetric;
 static const flecs::entity_t With = EcsWith;
 static const flecs::entity_t OneOf = EcsOneOf;
+static const flecs::entity_t TargetIndex = EcsTargetIndex;
 
 /* Builtin relationships */
 static const flecs::entity_t IsA = EcsIsA;
@@ -108,6 +108,10 @@ struct filter_base {
         return m_filter_ptr->term_count;
     }
 
+    flecs::estimate_t estimate() const {
+        return ecs_filter_estimate(m_world, m_filter_ptr);
+    }
+
     flecs::string str() {
         char *result = ecs_filter_str(m_world, m_filter_ptr);
         return flecs::string(result);
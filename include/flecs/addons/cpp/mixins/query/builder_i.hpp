@@ -134,6 +134,20 @@ public:
         return *this;
     }
 
+    /** Prefetch component columns of the next result while iterating.
+     */
+    Base& prefetch(bool value = true) {
+        m_desc->prefetch = value;
+        return *this;
+    }
+
+    /** Split up results in batches with at most the specified number of rows.
+     */
+    Base& max_batch(int32_t value) {
+        m_desc->max_batch = value;
+        return *this;
+    }
+
     /** Specify parent query (creates subquery) */
     Base& observable(const query_base& parent);
     
@@ -43,6 +43,10 @@ struct rule_base {
         m_rule = nullptr;
     }
 
+    flecs::estimate_t estimate() const {
+        return ecs_rule_estimate(m_rule);
+    }
+
     flecs::string str() {
         const ecs_filter_t *f = ecs_rule_get_filter(m_rule);
         char *result = ecs_filter_str(m_world, f);
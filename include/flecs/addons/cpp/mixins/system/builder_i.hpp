@@ -51,6 +51,16 @@ public:
         return *this;
     }
 
+    /** Specify whether system can run on multiple threads, where each thread
+     * iterates whole groups of the system query.
+     *
+     * @param value If true, groups of the system query are divided over threads.
+     */
+    Base& multi_threaded_groups(bool value = true) {
+        m_desc->multi_threaded_groups = value;
+        return *this;
+    }
+
     /** Specify whether system should be ran in staged context.
      *
      * @param value If false system will always run staged.
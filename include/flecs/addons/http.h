@@ -7,9 +7,11 @@
  * Flecs application (for example, with a web-based UI) and request/visualize
  * data from the ECS world.
  * 
- * Each server instance creates a single thread used for receiving requests.
- * Receiving requests are enqueued and handled when the application calls
- * ecs_http_server_dequeue. This increases latency of request handling vs.
+ * Each server instance creates a single thread that uses non-blocking sockets
+ * to accept connections, receive requests and send replies (with epoll on 
+ * Linux, and poll on other platforms). A slow client does not hold up other
+ * clients. Received requests are enqueued and handled when the application
+ * calls ecs_http_server_dequeue. This increases latency of request handling vs.
  * responding directly in the receive thread, but is better suited for 
  * retrieving data from ECS applications, as requests can be processed by an ECS
  * system without having to lock the world.
@@ -32,6 +34,9 @@
 /* Maximum number of query parameters in request */
 #define ECS_HTTP_QUERY_PARAM_COUNT_MAX (32)
 
+/* Size of reply body at which request handlers should flush a streamed reply */
+#define ECS_HTTP_CHUNK_SIZE (64 * 1024)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -39,6 +44,9 @@ extern "C" {
 /** HTTP server */
 typedef struct ecs_http_server_t ecs_http_server_t;
 
+/** Reply that remains open after the request handler returns */
+typedef struct ecs_http_stream_t ecs_http_stream_t;
+
 /** A connection manages communication with the remote host */
 typedef struct {
     uint64_t id;
@@ -86,10 +94,11 @@ typedef struct {
     const char* status;         /* default = OK */
     const char* content_type;   /* default = application/json */
     ecs_strbuf_t headers;       /* default = "" */
+    void *stream;               /* Used by ecs_http_reply_flush (internal) */
 } ecs_http_reply_t;
 
 #define ECS_HTTP_REPLY_INIT \
-    (ecs_http_reply_t){200, ECS_STRBUF_INIT, "OK", "application/json", ECS_STRBUF_INIT}
+    (ecs_http_reply_t){200, ECS_STRBUF_INIT, "OK", "application/json", ECS_STRBUF_INIT, NULL}
 
 /** Request callback.
  * Invoked for each valid request. The function should populate the reply and
@@ -106,7 +115,8 @@ typedef struct {
     void *ctx;                        /* Passed to callback (optional) */
     uint16_t port;                    /* HTTP port */
     const char *ipaddr;               /* Interface to listen on (optional) */
-    int32_t send_queue_wait_ms;       /* Send queue wait time when empty */
+    int32_t send_queue_wait_ms;       /* Unused, server thread is woken up
+                                       * when replies are enqueued */
 } ecs_http_server_desc_t;
 
 /** Create server. 
@@ -158,6 +168,78 @@ FLECS_API
 void ecs_http_server_stop(
     ecs_http_server_t* server);
 
+/** Send part of a reply body.
+ * This operation sends the data that has been appended to the reply body as a
+ * chunk (using chunked transfer encoding), and clears the body. Request
+ * handlers can use this to send large replies without building the entire
+ * reply in memory. After the first flush, the code, status, content type and
+ * headers of the reply can no longer be changed.
+ *
+ * When too much data is queued for the connection, this operation blocks until
+ * queued data has been sent. Replies to HTTP/1.0 requests are not streamed,
+ * and are sent when the request handler returns.
+ *
+ * This operation may only be called from a request handler.
+ *
+ * @param reply The reply.
+ * @return Zero if success, non-zero if the connection was closed.
+ */
+FLECS_API
+int ecs_http_reply_flush(
+    ecs_http_reply_t *reply);
+
+/** Keep reply open after the request handler returns.
+ * The reply is sent with chunked transfer encoding. The code, status, content
+ * type, headers and body of the reply are sent when the request handler 
+ * returns, after which the application can send more data with
+ * ecs_http_stream_send, until the stream is closed with ecs_http_stream_close.
+ * Replies to requests that are pipelined on the same connection are sent after
+ * the stream is closed.
+ *
+ * Streams must be closed before the server is deleted. This operation may only
+ * be called from a request handler.
+ *
+ * @param reply The reply.
+ * @return The stream, or NULL if the request wasn't made with HTTP/1.1.
+ */
+FLECS_API
+ecs_http_stream_t* ecs_http_reply_open_stream(
+    ecs_http_reply_t *reply);
+
+/** Send data to open stream.
+ * This operation sends the data in the buffer as a chunk, and clears the
+ * buffer. The operation does not block. Applications can use 
+ * ecs_http_stream_queued to not send more data to clients that don't keep up.
+ *
+ * @param stream The stream.
+ * @param buf The data to send.
+ * @return Zero if success, non-zero if the connection was closed.
+ */
+FLECS_API
+int ecs_http_stream_send(
+    ecs_http_stream_t *stream,
+    ecs_strbuf_t *buf);
+
+/** Return number of bytes sent to stream that haven't been written yet.
+ *
+ * @param stream The stream.
+ * @return The number of queued bytes.
+ */
+FLECS_API
+int32_t ecs_http_stream_queued(
+    const ecs_http_stream_t *stream);
+
+/** Close stream.
+ * This sends the last chunk of the reply. If the request wasn't kept alive, the
+ * connection is closed when all data has been written. The stream can no 
+ * longer be used after this operation.
+ *
+ * @param stream The stream.
+ */
+FLECS_API
+void ecs_http_stream_close(
+    ecs_http_stream_t *stream);
+
 /** Find header in request. 
  * 
  * @param req The request.
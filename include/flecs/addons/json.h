@@ -6,6 +6,10 @@
  * enumerations and bitmasks are encoded as strings.
  * 
  * See docs/JsonFormat.md for a description of the JSON format.
+ * 
+ * Values, entities and iterators can also be serialized to CBOR (RFC 8949),
+ * which encodes the same structure as the JSON format in a compact binary
+ * representation.
  */
 
 #ifdef FLECS_JSON
@@ -210,6 +214,7 @@ typedef struct ecs_iter_to_json_desc_t {
     bool serialize_colors;        /* Include doc color for entities */
     bool measure_eval_duration;   /* Include evaluation duration */
     bool serialize_type_info;     /* Include type information */
+    int32_t threads;              /* Serialize results on multiple threads (requires OS API threading) */
 } ecs_iter_to_json_desc_t;
 
 #define ECS_ITER_TO_JSON_INIT (ecs_iter_to_json_desc_t){\
@@ -258,6 +263,102 @@ int ecs_iter_to_json_buf(
     ecs_strbuf_t *buf_out,
     const ecs_iter_to_json_desc_t *desc);
 
+/** Serialize value into CBOR.
+ * Same as ecs_array_to_json_buf, but serializes to CBOR. If count is >= 1 and
+ * the type only contains members of a single primitive type without padding,
+ * the values are written as a single typed array (RFC 8746) that contains the
+ * raw data in the byte order of the host.
+ * 
+ * The result may contain \0 characters, use ecs_strbuf_written to obtain the
+ * size of the result.
+ * 
+ * @param world The world.
+ * @param type The type of the value to serialize.
+ * @param data The value to serialize.
+ * @param count The number of elements to serialize.
+ * @param buf_out The strbuf to append the CBOR data to.
+ * @return Zero if success, non-zero if failed.
+ */
+FLECS_API
+int ecs_array_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const void *data,
+    int32_t count,
+    ecs_strbuf_t *buf_out);
+
+/** Serialize value into CBOR.
+ * Same as ecs_array_to_cbor_buf, with count = 0.
+ * 
+ * @param world The world.
+ * @param type The type of the value to serialize.
+ * @param data The value to serialize.
+ * @param buf_out The strbuf to append the CBOR data to.
+ * @return Zero if success, non-zero if failed.
+ */
+FLECS_API
+int ecs_ptr_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const void *data,
+    ecs_strbuf_t *buf_out);
+
+/** Deserialize CBOR into value.
+ * This operation parses values serialized with ecs_array_to_cbor_buf. If count
+ * is 0, a single value is parsed. If count is >= 1, the data must contain an
+ * array or typed array with count elements.
+ * 
+ * @param world The world.
+ * @param data The CBOR data.
+ * @param size The size of the CBOR data.
+ * @param type The type of the value to deserialize.
+ * @param data_out Pointer to the memory to write to.
+ * @param count The number of elements to deserialize.
+ * @return Pointer to the byte after the last one read, or NULL if failed.
+ */
+FLECS_API
+const void* ecs_parse_cbor(
+    const ecs_world_t *world,
+    const void *data,
+    ecs_size_t size,
+    ecs_entity_t type,
+    void *data_out,
+    int32_t count);
+
+/** Serialize entity into CBOR.
+ * Same as ecs_entity_to_json_buf, but serializes to CBOR. Type information is
+ * not serialized.
+ * 
+ * @param world The world.
+ * @param entity The entity to serialize.
+ * @param buf_out The strbuf to append the CBOR data to.
+ * @return Zero if success, non-zero if failed.
+ */
+FLECS_API
+int ecs_entity_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_strbuf_t *buf_out,
+    const ecs_entity_to_json_desc_t *desc);
+
+/** Serialize iterator into CBOR.
+ * Same as ecs_iter_to_json_buf, but serializes to CBOR. Component values of
+ * owned fields are written as typed arrays where the layout of the component
+ * allows it, entity ids are always written as a typed array. Type information
+ * is not serialized.
+ * 
+ * @param world The world.
+ * @param iter The iterator to serialize.
+ * @param buf_out The strbuf to append the CBOR data to.
+ * @return Zero if success, non-zero if failed.
+ */
+FLECS_API
+int ecs_iter_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_iter_t *iter,
+    ecs_strbuf_t *buf_out,
+    const ecs_iter_to_json_desc_t *desc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -320,8 +320,24 @@ typedef struct ecs_meta_type_op_t {
     ecs_hashmap_t *members; /* string -> member index (structs only) */
 } ecs_meta_type_op_t;
 
+/** Operation of a flattened JSON serializer program. An operation appends a
+ * literal with the punctuation & (escaped) member names that precede a value,
+ * followed by the value. The last operation has kind EcsOpPop, and only 
+ * appends the literal that closes the value. */
+typedef struct ecs_meta_json_op_t {
+    ecs_meta_type_op_kind_t kind; /* Primitive kind, or EcsOpPop for last op */
+    ecs_size_t offset;      /* Offset of value (includes offset of parents) */
+    int32_t literal;        /* Offset of literal in literals string */
+    int32_t literal_len;    /* Length of literal */
+} ecs_meta_json_op_t;
+
 typedef struct EcsMetaTypeSerialized {
     ecs_vector_t* ops;     /* vector<ecs_meta_type_op_t> */
+
+    /* Flattened JSON serializer program, only created for types with members
+     * that are primitives or structs of primitives. */
+    ecs_vector_t* json_ops; /* vector<ecs_meta_json_op_t> */
+    char *json_literals;
 } EcsMetaTypeSerialized;
 
 
@@ -414,6 +430,26 @@ FLECS_API
 const char* ecs_meta_get_member(
     const ecs_meta_cursor_t *cursor);
 
+/** Find offset and type of a member.
+ * Nested members can be found by separating member names with a '.', as in
+ * "position.x". Only members that hold a single value (not an inline array or
+ * a struct) can be found.
+ *
+ * @param world The world.
+ * @param type The (struct) type that contains the member.
+ * @param member The name of the member.
+ * @param offset_out Output parameter for the member offset.
+ * @param type_out Output parameter for the member type.
+ * @return Zero if success, non-zero if the member was not found.
+ */
+FLECS_API
+int ecs_meta_member_offset(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const char *member,
+    ecs_size_t *offset_out,
+    ecs_entity_t *type_out);
+
 /** The set functions assign the field with the specified value. If the value
  * does not have the same type as the field, it will be cased to the field type.
  * If no valid conversion is available, the operation will fail. */
@@ -662,6 +698,123 @@ ecs_entity_t ecs_quantity_init(
     ecs_world_t *world,
     const ecs_entity_desc_t *desc);
 
+
+/** Member indices */
+
+/** Kind of member index */
+typedef enum ecs_member_index_kind_t {
+    EcsMemberIndexSorted,   /* Sorted index, supports equality & range lookups */
+    EcsMemberIndexHash      /* Hash index, supports equality lookups */
+} ecs_member_index_kind_t;
+
+/** Used with ecs_member_index_init. */
+typedef struct ecs_member_index_desc_t {
+    /* Existing entity to associate with index (optional) */
+    ecs_entity_t entity;
+
+    /* Member to index. Must be a member of a struct that is registered as a
+     * component, and must have a primitive, enum or bitmask type that is not
+     * a string. */
+    ecs_entity_t member;
+
+    /* Index kind */
+    ecs_member_index_kind_t kind;
+} ecs_member_index_desc_t;
+
+/** Create a new member index.
+ * A member index keeps track of the value of a component member for all 
+ * entities that own the component, which allows for finding entities by member
+ * value without iterating tables. The index is updated when the component is
+ * set (ecs_set, ecs_modified) or removed. Values that are written without 
+ * notifying the world (e.g. through ecs_get_mut without ecs_modified) are not
+ * picked up by the index.
+ * 
+ * The index is an entity that can be deleted to free the index.
+ * 
+ * An index can be used in three ways:
+ *  - ecs_member_index_find returns the entities for a range of values
+ *  - ecs_member_index_iter returns an iterator that can be chained with
+ *    ecs_filter_chain_iter
+ *  - the index member of a term predicate (ecs_term_predicate_t) lets filter
+ *    iterators only visit the entities that can pass the predicate. This
+ *    requires a term that matches $this with EcsSelf, and a predicate with an
+ *    Eq, Lt, LtEq, Gt or GtEq operation (Eq for a hash index).
+ * 
+ * Cached queries accept predicates with an index, but test the predicate on
+ * all rows of the matched tables. Rules do not support predicates.
+ * 
+ * @param world The world.
+ * @param desc Index parameters.
+ * @return The index entity, or 0 if the index could not be created.
+ */
+FLECS_API
+ecs_entity_t ecs_member_index_init(
+    ecs_world_t *world,
+    const ecs_member_index_desc_t *desc);
+
+/** Find entities in member index.
+ * This operation returns the entities for which the member value is in the
+ * range [min, max]. The min and max parameters point to values of the member
+ * type. If min or max is NULL, the range is not bounded on that side. A hash
+ * index only supports equality lookups, which require min and max to be equal.
+ * 
+ * Entities in a sorted index are returned in order of member value. The 
+ * returned array is owned by the index, and is invalidated by operations that
+ * modify the index. A sorted index stores entities in chunks, and a result that
+ * spans more than one chunk is copied to a buffer of the index that is reused
+ * by the next lookup. Use ecs_member_index_iter to iterate a large range 
+ * without copying.
+ * 
+ * @param world The world.
+ * @param index The member index.
+ * @param min Lower bound (inclusive), or NULL.
+ * @param max Upper bound (inclusive), or NULL.
+ * @param count_out Out parameter for the number of entities.
+ * @return Array with entities, NULL if no entities were found.
+ */
+FLECS_API
+const ecs_entity_t* ecs_member_index_find(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *min,
+    const void *max,
+    int32_t *count_out);
+
+/** Create iterator for member index lookup.
+ * This returns an iterator for the entities found by ecs_member_index_find. 
+ * Each result contains a range of consecutive rows in a single table, which
+ * allows the iterator to be used as input for ecs_filter_chain_iter to 
+ * constrain the results of a filter to entities that match the lookup:
+ * 
+ *   ecs_iter_t it = ecs_member_index_iter(world, index, &min, &max);
+ *   ecs_iter_t fit = ecs_filter_chain_iter(&it, filter);
+ *   while (ecs_filter_next(&fit)) { }
+ * 
+ * The lookup is performed when the iterator is created. The iterator does not
+ * have fields. The index must not be modified while the iterator is in use.
+ * 
+ * @param world The world.
+ * @param index The member index.
+ * @param min Lower bound (inclusive), or NULL.
+ * @param max Upper bound (inclusive), or NULL.
+ * @return The iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_member_index_iter(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *min,
+    const void *max);
+
+/** Progress member index iterator.
+ * 
+ * @param it The iterator.
+ * @return True if iterator has more results, false if not.
+ */
+FLECS_API
+bool ecs_member_index_next(
+    ecs_iter_t *it);
+
 /* Convenience macros */
 
 #define ecs_primitive(world, ...)\
@@ -691,6 +844,9 @@ ecs_entity_t ecs_quantity_init(
 #define ecs_quantity(world, ...)\
     ecs_quantity_init(world, &(ecs_entity_desc_t) __VA_ARGS__ )
 
+#define ecs_member_index(world, ...)\
+    ecs_member_index_init(world, &(ecs_member_index_desc_t) __VA_ARGS__ )
+
 /* Module import */
 FLECS_API
 void FlecsMetaImport(
@@ -6,6 +6,14 @@
  * access to application data for remote applications.
  * 
  * A description of the API can be found in docs/RestApi.md
+ *
+ * By default requests are handled on the main thread by a system that runs at
+ * the end of each frame. When EcsRest::threaded is set, requests are handled 
+ * by a separate thread while the world is in readonly mode, or while the main
+ * thread sleeps to meet the target FPS. This prevents requests from adding to
+ * the frame time. A request that is still being handled when readonly mode 
+ * ends delays the main thread until the request is done. Replies of the REST
+ * thread are sent when complete, and are not streamed in chunks.
  */
 
 #ifdef FLECS_REST
@@ -45,6 +53,7 @@ FLECS_API extern const ecs_entity_t ecs_id(EcsRest);
 typedef struct {
     uint16_t port;        /* Port of server (optional, default = 27750) */
     char *ipaddr;         /* Interface address (optional, default = 0.0.0.0) */
+    bool threaded;        /* Handle requests on a separate thread (optional) */
     void *impl;
 } EcsRest;
 
@@ -102,6 +102,19 @@ FLECS_API
 int32_t ecs_rule_var_count(
     const ecs_rule_t *rule);
 
+/** Estimate number of tables and entities evaluated by rule.
+ * This operation is similar to ecs_filter_estimate, except that terms that are
+ * matched on other variables than This also constrain the estimate. The result
+ * is an estimate of the number of tables and entities that the rule has to 
+ * evaluate, which can be used to compare the cost of rules.
+ * 
+ * @param rule The rule.
+ * @return The estimate.
+ */
+FLECS_API
+ecs_estimate_t ecs_rule_estimate(
+    const ecs_rule_t *rule);
+
 /** Find variable index.
  * This operation looks up the index of a variable in the rule. This index can
  * be used in operations like ecs_iter_set_var and ecs_iter_get_var.
@@ -36,6 +36,26 @@ typedef union ecs_metric_t {
     ecs_counter_t counter;
 } ecs_metric_t;
 
+#define ECS_HISTOGRAM_BUCKET_COUNT (192)
+
+/* Histogram with logarithmic buckets, used to measure latency distributions.
+ * Buckets have a precision of 12.5%, and span from 1 microsecond to ~60 
+ * seconds. Counts are cumulative, the samples for a measurement interval are
+ * the difference between two histograms. */
+typedef struct ecs_histogram_t {
+    uint32_t count[ECS_HISTOGRAM_BUCKET_COUNT];
+} ecs_histogram_t;
+
+/* Latency percentiles (in seconds), computed from a histogram */
+typedef struct ecs_latency_t {
+    ecs_float_t p50[ECS_STAT_WINDOW];
+    ecs_float_t p90[ECS_STAT_WINDOW];
+    ecs_float_t p99[ECS_STAT_WINDOW];
+    ecs_float_t p999[ECS_STAT_WINDOW];
+    ecs_histogram_t start;                     /* Histogram at start of interval */
+    ecs_histogram_t last;                      /* Histogram at last measurement */
+} ecs_latency_t;
+
 typedef struct ecs_world_stats_t {
     int32_t first_;
 
@@ -55,6 +75,7 @@ typedef struct ecs_world_stats_t {
         ecs_metric_t type_count;          /* Number of registered types */
         ecs_metric_t create_count;        /* Number of times id has been created */
         ecs_metric_t delete_count;        /* Number of times id has been deleted */
+        ecs_metric_t target_index_count;  /* Number of entries in relationship target indices */
     } ids;
 
     /* Tables */
@@ -67,6 +88,7 @@ typedef struct ecs_world_stats_t {
         ecs_metric_t storage_count;        /* Number of table storages */
         ecs_metric_t create_count;         /* Number of times table has been created */
         ecs_metric_t delete_count;         /* Number of times table has been deleted */
+        ecs_metric_t match_count;          /* Number of times table has been evaluated for a query */
     } tables;
 
     /* Queries & events */
@@ -129,10 +151,21 @@ typedef struct ecs_world_stats_t {
         ecs_metric_t stack_alloc_count;    /* Page allocations per frame */
         ecs_metric_t stack_free_count;     /* Page frees per frame */
         ecs_metric_t stack_outstanding_alloc_count; /* Difference between allocs & frees */
+
+        /* Index data */
+        ecs_metric_t target_index_memory;  /* Memory used by relationship target indices */
     } memory;
 
     int32_t last_;
 
+    /* Latency percentiles (frame & merge time are measured when frame time is
+     * measured, sync time is measured when system time is measured) */
+    struct {
+        ecs_latency_t frame_time;          /* Time spent processing a frame */
+        ecs_latency_t merge_time;          /* Time spent in a single merge */
+        ecs_latency_t sync_time;           /* Time main thread spent in sync points (includes merge) */
+    } latency;
+
     /** Current position in ringbuffer */
     int32_t t;
 } ecs_world_stats_t;
@@ -143,6 +176,15 @@ typedef struct ecs_query_stats_t {
     ecs_metric_t matched_table_count;       /* Matched non-empty tables */    
     ecs_metric_t matched_empty_table_count; /* Matched empty tables */
     ecs_metric_t matched_entity_count;      /* Number of matched entities */
+
+    /* Profiling counters (only collected with FLECS_QUERY_COUNTERS) */
+    ecs_metric_t iterated_table_count;      /* Results yielded by iterators */
+    ecs_metric_t iterated_entity_count;     /* Entities yielded by iterators */
+    ecs_metric_t skipped_table_count;       /* Tables skipped without results */
+    ecs_metric_t change_check_count;        /* Change detection checks */
+    ecs_metric_t bytes_touched;             /* Bytes of component data yielded */
+    ecs_metric_t rematch_time;              /* Time spent rematching tables */
+    ecs_metric_t sort_time;                 /* Time spent sorting tables */
     int32_t last_;
 
     /** Current position in ringbuffer */
@@ -156,10 +198,18 @@ typedef struct ecs_system_stats_t {
     ecs_metric_t invoke_count;     /* Number of times system is invoked */
     ecs_metric_t active;           /* Whether system is active (is matched with >0 entities) */
     ecs_metric_t enabled;          /* Whether system is enabled */
+
+    /* Hardware counters (only collected with FLECS_PERF_COUNTERS) */
+    ecs_metric_t cycles;           /* CPU cycles spent in system */
+    ecs_metric_t instructions;     /* Instructions retired by system */
+    ecs_metric_t cache_misses;     /* Last level cache misses */
+    ecs_metric_t branch_misses;    /* Mispredicted branches */
     int32_t last_;
 
     bool task;                     /* Is system a task */
 
+    ecs_latency_t time_latency;    /* Percentiles of time spent per invocation */
+
     ecs_query_stats_t query;
 } ecs_system_stats_t;
 
@@ -88,6 +88,11 @@ typedef struct ecs_system_desc_t {
     /* If true, system will be ran on multiple threads */
     bool multi_threaded;
 
+    /* If true, system will be ran on multiple threads, where each thread
+     * iterates whole groups of the system query. Requires a query with a
+     * group_by function. */
+    bool multi_threaded_groups;
+
     /* If true, system will have access to actuall world. Cannot be true at the
      * same time as multi_threaded. */
     bool no_readonly;
@@ -0,0 +1,89 @@
+/**
+ * @file tracing.h
+ * @brief Tracing addon that records where frame time is spent.
+ *
+ * The tracing addon records begin and end events for frames, pipeline
+ * operations, systems, merges, worker synchronization and observers. Each
+ * thread writes events to its own ring buffer, so recording does not require
+ * locks. Recorded events can be exported to the Chrome trace event format,
+ * which can be loaded in chrome://tracing or https://ui.perfetto.dev.
+ *
+ * When tracing is not started, the overhead of the addon is a single check per
+ * instrumented function.
+ */
+
+#ifdef FLECS_TRACING
+
+#ifndef FLECS_TRACING_H
+#define FLECS_TRACING_H
+
+/* Default number of events per thread (must be a power of 2) */
+#define ECS_TRACING_DEFAULT_EVENT_COUNT (65536)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Kinds of traced events */
+typedef enum ecs_trace_kind_t {
+    EcsTraceFrame,
+    EcsTracePipelineOp,
+    EcsTraceSystem,
+    EcsTraceMerge,
+    EcsTraceWorkerSync,
+    EcsTraceObserver
+} ecs_trace_kind_t;
+
+/** Start recording trace events.
+ * This operation allocates a ring buffer for each stage (thread) in the world,
+ * and starts recording events. When a ring buffer is full, the oldest events
+ * are overwritten. Events recorded before a previous ecs_tracing_stop are
+ * discarded.
+ *
+ * @param world The world.
+ * @param event_count Number of events per thread (0 for default). Rounded up
+ *        to the next power of 2.
+ */
+FLECS_API
+void ecs_tracing_start(
+    ecs_world_t *world,
+    int32_t event_count);
+
+/** Stop recording trace events.
+ * This frees the ring buffers with recorded events.
+ *
+ * @param world The world.
+ */
+FLECS_API
+void ecs_tracing_stop(
+    ecs_world_t *world);
+
+/** Test if world is recording trace events.
+ *
+ * @param world The world.
+ * @return True if tracing is started, false if not.
+ */
+FLECS_API
+bool ecs_tracing_enabled(
+    const ecs_world_t *world);
+
+/** Serialize recorded events to Chrome trace JSON.
+ * This operation must not be called while the world is progressing, as that
+ * would race with the threads that record events.
+ *
+ * The returned string must be freed with ecs_os_free.
+ *
+ * @param world The world.
+ * @return JSON string with the trace events, or NULL if tracing is not started.
+ */
+FLECS_API
+char* ecs_tracing_to_json(
+    const ecs_world_t *world);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
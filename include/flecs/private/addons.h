@@ -92,6 +92,9 @@
 #ifdef FLECS_NO_JOURNAL
 #undef FLECS_JOURNAL
 #endif
+#ifdef FLECS_NO_TRACING
+#undef FLECS_TRACING
+#endif
 
 /* Always included, if disabled functions are replaced with dummy macros */
 #include "flecs/addons/journal.h"
@@ -228,6 +231,12 @@
 #endif
 #include "../addons/http.h"
 #endif
+#ifdef FLECS_TRACING
+#ifdef FLECS_NO_TRACING
+#error "FLECS_NO_TRACING failed: TRACING is required by other addons"
+#endif
+#include "../addons/tracing.h"
+#endif
 #ifdef FLECS_OS_API_IMPL
 #ifdef FLECS_NO_OS_API_IMPL
 #error "FLECS_NO_OS_API_IMPL failed: OS_API_IMPL is required by other addons"
@@ -67,6 +67,7 @@ extern "C" {
 #define EcsIdTag                       (1u << 9)
 #define EcsIdWith                      (1u << 10)
 #define EcsIdUnion                     (1u << 11)
+#define EcsIdTargetIndex               (1u << 12)
 
 #define EcsIdHasOnAdd                  (1u << 15) /* Same values as table flags */
 #define EcsIdHasOnRemove               (1u << 16) 
@@ -99,6 +100,8 @@ extern "C" {
 #define EcsIterNoResults               (1u << 6u)  /* Iterator has no results */
 #define EcsIterIgnoreThis              (1u << 7u)  /* Only evaluate non-this terms */
 #define EcsIterMatchVar           (1u << 8u)
+#define EcsIterIgnorePredicates        (1u << 9u)  /* Don't test term predicates */
+#define EcsIterChangedOnly             (1u << 10u) /* Only return rows that changed */
 
 ////////////////////////////////////////////////////////////////////////////////
 //// Filter flags (used by ecs_filter_t::flags)
@@ -120,6 +123,7 @@ extern "C" {
 #define EcsFilterIsFilter              (1u << 7u)  /* When true, data fields won't be populated */
 #define EcsFilterIsInstanced           (1u << 8u)  /* Is filter instanced (see ecs_filter_desc_t) */
 #define EcsFilterPopulate              (1u << 9u)  /* Populate data, ignore non-matching fields */
+#define EcsFilterHasPredicates         (1u << 10u) /* Does filter have terms with predicates */
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -147,6 +151,7 @@ extern "C" {
 #define EcsTableHasUnSet               (1u << 18u)
 
 #define EcsTableHasObserved            (1u << 20u)
+#define EcsTableHasTargetIndex         (1u << 21u) /* Does table have indexed relationships */
 
 #define EcsTableMarkedForDelete        (1u << 30u)
 
@@ -166,6 +171,9 @@ extern "C" {
 #define EcsQueryIsOrphaned             (1u << 3u)  /* Is subquery orphaned */
 #define EcsQueryHasOutColumns          (1u << 4u)  /* Does query have out columns */
 #define EcsQueryHasMonitor             (1u << 5u)  /* Does query track changes */
+#define EcsQueryTrackRows              (1u << 6u)  /* Does query track changes per row */
+#define EcsQueryIsTrivial              (1u << 7u)  /* Can query use fast path iterator */
+#define EcsQueryPrefetch               (1u << 8u)  /* Prefetch columns of next result */
 
 
 ////////////////////////////////////////////////////////////////////////////////
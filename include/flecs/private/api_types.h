@@ -116,6 +116,17 @@ typedef struct ecs_worker_iter_t {
     int32_t count;
 } ecs_worker_iter_t;
 
+/* Member-index-iterator specific data */
+typedef struct ecs_member_index_iter_t {
+    const void *index;            /* Index that is iterated */
+    const ecs_entity_t *entities; /* Entities in current chunk */
+    int32_t cur;                  /* Position in current chunk */
+    int32_t count;                /* Number of entities in current chunk */
+    int32_t chunk;                /* Current chunk */
+    int32_t last_chunk;           /* Last chunk of lookup */
+    int32_t last_count;           /* Number of entities in last chunk */
+} ecs_member_index_iter_t;
+
 /* Convenience struct to iterate table array for id */
 typedef struct ecs_table_cache_iter_t {
     struct ecs_table_cache_hdr_t *cur, *next;
@@ -152,6 +163,7 @@ typedef enum ecs_iter_kind_t {
     EcsIterEvalCondition,
     EcsIterEvalTables,
     EcsIterEvalChain,
+    EcsIterEvalIndex,
     EcsIterEvalNone
 } ecs_iter_kind_t;
 
@@ -162,6 +174,16 @@ typedef struct ecs_filter_iter_t {
     ecs_term_iter_t term_iter;
     int32_t matches_left;
     int32_t pivot_term;
+    int32_t predicate_row;  /* Next row to test for predicates */
+    int32_t predicate_end;  /* End of rows to test for predicates */
+
+    /* Entities of member index, if a term predicate has an index */
+    ecs_member_index_iter_t index_iter;
+
+    /* Id records of terms for which table lists are intersected */
+    ecs_id_record_t **intersect_idrs;
+    int32_t *intersect_pos; /* Current position in sorted table lists */
+    int32_t intersect_count;
 } ecs_filter_iter_t;
 
 /** Query-iterator specific data */
@@ -171,7 +193,14 @@ typedef struct ecs_query_iter_t {
     int32_t sparse_smallest;
     int32_t sparse_first;
     int32_t bitset_first;
+    int32_t predicate_row;
+    int32_t predicate_end;
+    int32_t prev_first;     /* First row of the previous result */
+    int32_t prev_count;     /* Number of rows in the previous result */
     int32_t skip_count;
+    ecs_query_table_node_t *batch_node; /* Node of the current batched result */
+    int32_t batch_left;     /* Rows left in current result after batch */
+    bool skip_counters;     /* Results are counted by a chained iterator */
 } ecs_query_iter_t;
 
 /** Snapshot-iterator specific data */
@@ -226,6 +255,7 @@ typedef struct ecs_iter_private_t {
         ecs_snapshot_iter_t snapshot;
         ecs_page_iter_t page;
         ecs_worker_iter_t worker;
+        ecs_member_index_iter_t member_index;
     } iter;                       /* Iterator specific data */
 
     ecs_iter_cache_t cache;       /* Inline arrays to reduce allocations */
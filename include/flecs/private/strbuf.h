@@ -154,6 +154,15 @@ bool ecs_strbuf_appendstrn(
     const char *str,
     int32_t n);
 
+/* Append n bytes of binary data to buffer. Unlike ecs_strbuf_appendstrn, the
+ * data may contain \0 characters.
+ * Returns false when max is reached, true when there is still space */
+FLECS_API
+bool ecs_strbuf_appendbin(
+    ecs_strbuf_t *buffer,
+    const void *data,
+    int32_t n);
+
 /* Return result string */
 FLECS_API
 char *ecs_strbuf_get(
@@ -58,6 +58,7 @@ void FlecsCoreDocImport(
     ecs_doc_set_brief(world, EcsExclusive, "Exclusive relationship property");
     ecs_doc_set_brief(world, EcsSymmetric, "Symmetric relationship property");
     ecs_doc_set_brief(world, EcsWith, "With relationship property");
+    ecs_doc_set_brief(world, EcsTargetIndex, "TargetIndex relationship property");
     ecs_doc_set_brief(world, EcsOnDelete, "OnDelete relationship cleanup property");
     ecs_doc_set_brief(world, EcsOnDeleteTarget, "OnDeleteTarget relationship cleanup property");
     ecs_doc_set_brief(world, EcsDefaultChildComponent, "Sets default component hint for children of entity");
@@ -81,6 +82,7 @@ void FlecsCoreDocImport(
     ecs_doc_set_link(world, EcsExclusive, URL_ROOT "#exclusive-property");
     ecs_doc_set_link(world, EcsSymmetric, URL_ROOT "#symmetric-property");
     ecs_doc_set_link(world, EcsWith, URL_ROOT "#with-property");
+    ecs_doc_set_link(world, EcsTargetIndex, URL_ROOT "#targetindex-property");
     ecs_doc_set_link(world, EcsOnDelete, URL_ROOT "#cleanup-properties");
     ecs_doc_set_link(world, EcsOnDeleteTarget, URL_ROOT "#cleanup-properties");
     ecs_doc_set_link(world, EcsRemove, URL_ROOT "#cleanup-properties");
@@ -43,6 +43,7 @@
 #include <ws2tcpip.h>
 #include <windows.h>
 typedef SOCKET ecs_http_socket_t;
+typedef WSABUF ecs_http_iovec_t;
 #else
 #include <unistd.h>
 #include <arpa/inet.h>
@@ -51,7 +52,19 @@ typedef SOCKET ecs_http_socket_t;
 #include <netdb.h>
 #include <strings.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/uio.h>
 typedef int ecs_http_socket_t;
+typedef struct iovec ecs_http_iovec_t;
+#endif
+
+/* Use epoll on Linux, poll (WSAPoll on Windows) on other platforms */
+#if defined(ECS_TARGET_LINUX)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#define ECS_HTTP_EPOLL
 #endif
 
 #if !defined(MSG_NOSIGNAL)
@@ -61,11 +74,26 @@ typedef int ecs_http_socket_t;
 /* Max length of request method */
 #define ECS_HTTP_METHOD_LEN_MAX (8) 
 
-/* Timeout (s) before connection purge */
+/* Timeout (s) before purging a connection that didn't send a full request */
 #define ECS_HTTP_CONNECTION_PURGE_TIMEOUT (1.0)
 
-/* Number of dequeues before purging */
-#define ECS_HTTP_CONNECTION_PURGE_RETRY_COUNT (5)
+/* Timeout (s) before closing a kept alive connection without requests */
+#define ECS_HTTP_CONNECTION_KEEP_ALIVE_TIMEOUT (10.0)
+
+/* Max number of requests per connection that are waiting for a reply. When
+ * reached, the server stops reading from the connection until replies are
+ * sent. */
+#define ECS_HTTP_PIPELINE_MAX (32)
+
+/* Max time (ms) the server thread waits for socket events */
+#define ECS_HTTP_POLL_TIMEOUT (100)
+
+/* Max number of socket events handled per poll */
+#define ECS_HTTP_POLL_EVENT_COUNT (256)
+
+/* Poll ids for sockets that aren't connections */
+#define ECS_HTTP_POLL_ID_LISTEN (UINT64_MAX)
+#define ECS_HTTP_POLL_ID_WAKE (UINT64_MAX - 1)
 
 /* Minimum interval between dequeueing requests (ms) */
 #define ECS_HTTP_MIN_DEQUEUE_INTERVAL (100)
@@ -73,32 +101,46 @@ typedef int ecs_http_socket_t;
 /* Minimum interval between printing statistics (ms) */
 #define ECS_HTTP_MIN_STATS_INTERVAL (10 * 1000)
 
-/* Max length of headers in reply */
-#define ECS_HTTP_REPLY_HEADER_SIZE (1024)
-
 /* Receive buffer size */
 #define ECS_HTTP_SEND_RECV_BUFFER_SIZE (16 * 1024)
 
 /* Max length of request (path + query + headers + body) */
 #define ECS_HTTP_REQUEST_LEN_MAX (10 * 1024 * 1024)
 
-/* Total number of outstanding send requests */
-#define ECS_HTTP_SEND_QUEUE_MAX (256)
+/* Max number of buffers written to a socket with a single call */
+#define ECS_HTTP_IOV_MAX (16)
+
+/* Max number of bytes of a streamed reply that can be queued. When reached,
+ * ecs_http_reply_flush blocks until queued data has been sent. */
+#define ECS_HTTP_STREAM_QUEUE_MAX (4 * ECS_HTTP_CHUNK_SIZE)
 
-/* Send request queue */
+/* Timeout (s) before closing a connection that doesn't read replies */
+#define ECS_HTTP_SEND_TIMEOUT (10.0)
+
+/* Socket events a connection is interested in */
+#define ECS_HTTP_EVENT_READ (1)
+#define ECS_HTTP_EVENT_WRITE (2)
+
+/* Reply that is sent to a connection */
 typedef struct ecs_http_send_request_t {
-    ecs_http_socket_t sock;
+    uint64_t conn_id;
+    char *headers;
+    int32_t header_length;
     char *content;
     int32_t content_length;
+    int32_t written;           /* Bytes written (headers + content) */
+    int32_t stream_size;       /* Bytes that count towards stream queue limit */
+    uint64_t stream_id;        /* Open stream reply belongs to (optional) */
+    bool more;                 /* More chunks follow for the same reply */
 } ecs_http_send_request_t;
 
-typedef struct ecs_http_send_queue_t {
-    ecs_http_send_request_t requests[ECS_HTTP_SEND_QUEUE_MAX];
-    int32_t cur;
-    int32_t count;
-    ecs_os_thread_t thread;
-    int32_t wait_ms;
-} ecs_http_send_queue_t;
+/* Socket event returned by poll */
+typedef struct ecs_http_poll_event_t {
+    uint64_t id;               /* Connection id, or ECS_HTTP_POLL_ID_* */
+    bool read;
+    bool write;
+    bool hangup;
+} ecs_http_poll_event_t;
 
 /* HTTP server struct */
 struct ecs_http_server_t {
@@ -112,8 +154,9 @@ struct ecs_http_server_t {
     ecs_http_reply_action_t callback;
     void *ctx;
 
-    ecs_sparse_t *connections; /* sparse<http_connection_t> */
-    ecs_sparse_t *requests; /* sparse<http_request_t> */
+    ecs_sparse_t *connections; /* sparse<http_connection_t> (server thread) */
+    ecs_sparse_t *requests; /* sparse<http_request_t> (protected by lock) */
+    ecs_sparse_t *streams; /* sparse<ecs_http_stream_t> (protected by lock) */
 
     bool initialized;
 
@@ -127,9 +170,30 @@ struct ecs_http_server_t {
     ecs_ftime_t request_time_total; /* total time spent on requests */
     int32_t requests_processed; /* requests processed in last stats interval */
     int32_t requests_processed_total; /* total requests processed */
+    int32_t requests_reused; /* requests on reused connections in last stats interval */
+    int32_t requests_reused_total; /* total requests on reused connections */
     int32_t dequeue_count; /* number of dequeues in last stats interval */ 
 
-    ecs_http_send_queue_t send_queue;
+    /* Replies enqueued by the thread that dequeues requests. The server thread
+     * is woken up with the wake socket (eventfd or pipe) when replies are
+     * enqueued, so it doesn't have to poll the queue. */
+    ecs_vector_t *send_queue; /* vector<ecs_http_send_request_t> (lock) */
+    ecs_vector_t *send_queue_swap; /* used by server thread to swap queue */
+    ecs_http_socket_t wake[2];
+
+    uint64_t request_seq; /* used to handle requests in order of arrival */
+
+    /* Set while a thread handles requests. The server waits for handlers to
+     * return before it is stopped, as they reference requests. (lock) */
+    bool dequeueing;
+    ecs_os_cond_t dequeue_cond;
+
+#ifdef ECS_HTTP_EPOLL
+    int epoll_fd;
+#else
+    ecs_vector_t *poll_fds; /* vector<struct pollfd> */
+    ecs_vector_t *poll_ids; /* vector<uint64_t> */
+#endif
 };
 
 /** Fragment state, used by HTTP request parser */
@@ -166,45 +230,145 @@ typedef struct {
     char *header_buf_ptr;
     char header_buf[32];
     bool parse_content_length;
+    bool http_1_1;
     bool invalid;
 } ecs_http_fragment_t;
 
+/** Connection state */
+typedef enum {
+    HttpConnStateOpen,        /* Receiving requests and sending replies */
+    HttpConnStateClosing,     /* Close after replies for requests are sent */
+    HttpConnStateClosed       /* Socket closed while requests were processed */
+} HttpConnState;
+
 /** Extend public connection type with fragment data */
 typedef struct {
     ecs_http_connection_t pub;
     ecs_http_socket_t sock;
+    HttpConnState state;
+
+    /* Request that is being received */
+    ecs_http_fragment_t frag;
+
+    /* Replies that are being sent, in the order requests were received */
+    ecs_vector_t *replies; /* vector<ecs_http_send_request_t> */
+
+    /* Requests that are enqueued, but haven't been replied to */
+    int32_t pending;
+
+    /* Number of requests received on connection */
+    int32_t request_count;
+
+    /* Socket events connection is registered for */
+    int32_t events;
+    bool write_blocked;
+
+    /* Open stream that is sending a reply to the connection */
+    uint64_t stream_id;
 
-    /* Connection is purged after both timeout expires and connection has
-     * exceeded retry count. This ensures that a connection does not immediately
-     * timeout when a frame takes longer than usual */
-    ecs_ftime_t dequeue_timeout;
-    int32_t dequeue_retries;    
+    /* Replies to requests pipelined after the request that opened the stream,
+     * which are sent after the stream is closed */
+    ecs_vector_t *deferred; /* vector<ecs_http_send_request_t> */
+
+    /* Flow control for streamed replies. The thread that handles a request 
+     * waits until queued chunks for the connection have been sent. (lock) */
+    ecs_os_cond_t stream_cond;
+    int32_t stream_bytes;
+    bool stream_closed;
+
+    /* Connection is purged when it doesn't send a complete request before 
+     * timeout expires, or when it's idle for longer than keep alive timeout */
+    ecs_ftime_t idle_time;
 } ecs_http_connection_impl_t;
 
 typedef struct {
     ecs_http_request_t pub;
     uint64_t conn_id; /* for sanity check */
+    uint64_t seq; /* order in which requests were received */
+    int32_t reuse_count; /* requests previously received on connection */
+    bool keep_alive;
+    bool http_1_1;
     void *res;
 } ecs_http_request_impl_t;
 
+/** Requests that are being handled by ecs_http_server_dequeue */
+typedef struct {
+    ecs_http_server_t *srv;
+    ecs_http_request_impl_t **requests;
+    ecs_http_send_request_t *replies;
+    int32_t handled; /* requests for which reply has been created */
+    int32_t posted; /* replies that have been posted to the send queue */
+} ecs_http_dequeue_t;
+
+/** Reply that is being created by a request handler */
+typedef struct {
+    ecs_http_dequeue_t *dq;
+    ecs_http_request_impl_t *req;
+    ecs_http_stream_t *open; /* Set by ecs_http_reply_open_stream */
+    bool started; /* Set when first chunk is sent by ecs_http_reply_flush */
+} ecs_http_reply_ctx_t;
+
+/** Reply that remains open after the request handler returns */
+struct ecs_http_stream_t {
+    uint64_t id;
+    ecs_http_server_t *srv;
+    uint64_t conn_id;
+    int32_t queued; /* Bytes that haven't been written yet (lock) */
+    bool started; /* Set when first reply is posted (lock) */
+    bool closed; /* Set when connection is closed (lock) */
+    bool closing; /* Closed before first reply was posted (lock) */
+
+    /* Chunks sent before the first reply was posted (lock) */
+    ecs_vector_t *backlog; /* vector<ecs_http_send_request_t> */
+};
+
 static
-ecs_size_t http_send(
-    ecs_http_socket_t sock, 
-    const void *buf, 
-    ecs_size_t size, 
-    int flags)
+void http_iov_set(
+    ecs_http_iovec_t *iov,
+    char *buf,
+    ecs_size_t size)
 {
     ecs_assert(size >= 0, ECS_INTERNAL_ERROR, NULL);
 #ifdef ECS_TARGET_POSIX
-    ssize_t send_bytes = send(sock, buf, flecs_itosize(size), 
-        flags | MSG_NOSIGNAL);
+    iov->iov_base = buf;
+    iov->iov_len = flecs_itosize(size);
+#else
+    iov->buf = buf;
+    iov->len = (ULONG)size;
+#endif
+}
+
+static
+ecs_size_t http_sendv(
+    ecs_http_socket_t sock,
+    ecs_http_iovec_t *iov,
+    int32_t count)
+{
+#ifdef ECS_TARGET_POSIX
+    struct msghdr msg = {0};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = flecs_itosize(count);
+    ssize_t send_bytes = sendmsg(sock, &msg, MSG_NOSIGNAL);
     return flecs_itoi32(send_bytes);
 #else
-    int send_bytes = send(sock, buf, size, flags);
+    DWORD send_bytes = 0;
+    if (WSASend(sock, iov, (DWORD)count, &send_bytes, 0, NULL, NULL)) {
+        return -1;
+    }
     return flecs_itoi32(send_bytes);
 #endif
 }
 
+static
+bool http_would_block(void) {
+#if defined(ECS_TARGET_WINDOWS)
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    /* An interrupted call is retried on the next socket event */
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
 static
 ecs_size_t http_recv(
     ecs_http_socket_t sock,
@@ -221,7 +385,9 @@ ecs_size_t http_recv(
     ret = flecs_itoi32(recv_bytes);
 #endif
     if (ret == -1) {
-        ecs_dbg("recv failed: %s (sock = %d)", ecs_os_strerror(errno), sock);
+        if (!http_would_block()) {
+            ecs_dbg("recv failed: %s (sock = %d)", ecs_os_strerror(errno), sock);
+        }
     } else if (ret == 0) {
         ecs_dbg("recv: received 0 bytes (sock = %d)", sock);
     }
@@ -230,24 +396,22 @@ ecs_size_t http_recv(
 }
 
 static
-void http_sock_set_timeout(
-    ecs_http_socket_t sock,
-    int32_t timeout_ms)
+void http_sock_nonblock(
+    ecs_http_socket_t sock)
 {
-    int r;
-#ifdef ECS_TARGET_POSIX
-    struct timeval tv;
-    tv.tv_sec = timeout_ms * 1000;
-    tv.tv_usec = 0;
-    r = setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof tv);
+#if defined(ECS_TARGET_WINDOWS)
+    u_long v = 1;
+    if (ioctlsocket(sock, FIONBIO, &v)) {
+        ecs_warn("http: failed to make socket non-blocking: %d", 
+            WSAGetLastError());
+    }
 #else
-    DWORD t = (DWORD)timeout_ms;
-    r = setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&t, sizeof t);
-#endif
-    if (r) {
-        ecs_warn("http: failed to set socket timeout: %s", 
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (flags == -1 || fcntl(sock, F_SETFL, flags | O_NONBLOCK)) {
+        ecs_warn("http: failed to make socket non-blocking: %s", 
             ecs_os_strerror(errno));
     }
+#endif
 }
 
 static
@@ -349,19 +513,104 @@ void http_request_free(ecs_http_request_impl_t *req) {
     flecs_sparse_remove(req->pub.conn->server->requests, req->pub.id);
 }
 
+static
+void http_send_request_free(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    ecs_http_send_request_t *r)
+{
+    if (r->stream_size && conn) {
+        /* Unblock thread that is waiting for chunks to be sent. If the chunk
+         * wasn't sent, the connection was closed and streaming can stop. */
+        ecs_os_mutex_lock(srv->lock);
+        conn->stream_bytes -= r->stream_size;
+        if (r->written != (r->header_length + r->content_length)) {
+            conn->stream_closed = true;
+        }
+        ecs_os_cond_signal(conn->stream_cond);
+        ecs_os_mutex_unlock(srv->lock);
+    }
+    r->stream_size = 0;
+
+    if (r->stream_id) {
+        /* Stream is no longer registered after it is closed */
+        ecs_os_mutex_lock(srv->lock);
+        ecs_http_stream_t *stream = flecs_sparse_get(
+            srv->streams, ecs_http_stream_t, r->stream_id);
+        if (stream) {
+            stream->queued -= r->header_length + r->content_length;
+            if (r->written != (r->header_length + r->content_length)) {
+                stream->closed = true;
+            }
+        }
+        ecs_os_mutex_unlock(srv->lock);
+        r->stream_id = 0;
+    }
+
+    ecs_os_free(r->headers);
+    ecs_os_free(r->content);
+    r->headers = NULL;
+    r->content = NULL;
+}
+
+static
+void http_replies_free(ecs_http_connection_impl_t *conn) {
+    int32_t i, count = ecs_vector_count(conn->replies);
+    ecs_http_send_request_t *replies = ecs_vector_first(
+        conn->replies, ecs_http_send_request_t);
+    for (i = 0; i < count; i ++) {
+        http_send_request_free(conn->pub.server, conn, &replies[i]);
+    }
+    ecs_vector_free(conn->replies);
+    conn->replies = NULL;
+
+    /* Deferred replies haven't been counted as replied to yet */
+    count = ecs_vector_count(conn->deferred);
+    replies = ecs_vector_first(conn->deferred, ecs_http_send_request_t);
+    for (i = 0; i < count; i ++) {
+        if (!replies[i].more) {
+            conn->pending --;
+        }
+        http_send_request_free(conn->pub.server, conn, &replies[i]);
+    }
+    ecs_vector_free(conn->deferred);
+    conn->deferred = NULL;
+}
+
 static
 void http_connection_free(ecs_http_connection_impl_t *conn) {
     ecs_assert(conn != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(conn->pub.id != 0, ECS_INTERNAL_ERROR, NULL);
     uint64_t conn_id = conn->pub.id;
 
+    /* Closing the socket also removes it from the poll set */
     if (http_socket_is_valid(conn->sock)) {
         http_close(&conn->sock);
     }
 
+    ecs_strbuf_reset(&conn->frag.buf);
+    http_replies_free(conn);
+    ecs_os_cond_free(conn->stream_cond);
+
     flecs_sparse_remove(conn->pub.server->connections, conn_id);
 }
 
+static
+void http_stream_free(
+    ecs_http_stream_t *stream)
+{
+    ecs_http_server_t *srv = stream->srv;
+    int32_t i, count = ecs_vector_count(stream->backlog);
+    ecs_http_send_request_t *chunks = ecs_vector_first(
+        stream->backlog, ecs_http_send_request_t);
+    for (i = 0; i < count; i ++) {
+        ecs_os_free(chunks[i].headers);
+        ecs_os_free(chunks[i].content);
+    }
+    ecs_vector_free(stream->backlog);
+    flecs_sparse_remove(srv->streams, stream->id);
+}
+
 // https://stackoverflow.com/questions/10156409/convert-hex-string-char-to-int
 static
 char http_hex_2_int(char a, char b){
@@ -431,67 +680,101 @@ void http_header_buf_append(
         frag->header_buf_ptr[0] = ch;
         frag->header_buf_ptr ++;
     } else {
-        frag->header_buf_ptr[0] = '\0';
+        frag->header_buf[ECS_SIZEOF(frag->header_buf) - 1] = '\0';
+    }
+}
+
+
+static
+bool http_header_value_is(
+    const char *value,
+    const char *expect)
+{
+    /* Header values like "keep-alive" and "close" are case insensitive */
+    for (; *value && *expect; value ++, expect ++) {
+        char ch = *value;
+        if (ch >= 'A' && ch <= 'Z') {
+            ch = (char)(ch - 'A' + 'a');
+        }
+        if (ch != *expect) {
+            return false;
+        }
     }
+    return !*value && !*expect;
 }
 
 static
-void http_enqueue_request(
+bool http_enqueue_request(
     ecs_http_connection_impl_t *conn,
-    uint64_t conn_id,
     ecs_http_fragment_t *frag)
 {
     ecs_http_server_t *srv = conn->pub.server;
+    char *res = ecs_strbuf_get(&frag->buf);
+    if (!res) {
+        return false;
+    }
 
     ecs_os_mutex_lock(srv->lock);
-    bool is_alive = conn->pub.id == conn_id;
-
-    if (!is_alive || frag->invalid) { 
-        /* Don't enqueue invalid requests or requests for purged connections */
-        ecs_strbuf_reset(&frag->buf);
-    } else {
-        char *res = ecs_strbuf_get(&frag->buf);
-        if (res) {
-            ecs_http_request_impl_t *req = flecs_sparse_add(
-                srv->requests, ecs_http_request_impl_t);
-            req->pub.id = flecs_sparse_last_id(srv->requests);
-            req->conn_id = conn->pub.id;
-
-            req->pub.conn = (ecs_http_connection_t*)conn;
-            req->pub.method = frag->method;
-            req->pub.path = res + 1;
-            if (frag->body_offset) {
-                req->pub.body = &res[frag->body_offset];
-            }
-            int32_t i, count = frag->header_count;
-            for (i = 0; i < count; i ++) {
-                req->pub.headers[i].key = &res[frag->header_offsets[i]];
-                req->pub.headers[i].value = &res[frag->header_value_offsets[i]];
-            }
-            count = frag->param_count;
-            for (i = 0; i < count; i ++) {
-                req->pub.params[i].key = &res[frag->param_offsets[i]];
-                req->pub.params[i].value = &res[frag->param_value_offsets[i]];
-                http_decode_url_str((char*)req->pub.params[i].value);
-            }
+    ecs_http_request_impl_t *req = flecs_sparse_add(
+        srv->requests, ecs_http_request_impl_t);
+    req->pub.id = flecs_sparse_last_id(srv->requests);
+    req->conn_id = conn->pub.id;
+
+    req->pub.conn = (ecs_http_connection_t*)conn;
+    req->pub.method = frag->method;
+    req->pub.path = res + 1;
+    req->pub.body = NULL;
+    if (frag->body_offset) {
+        req->pub.body = &res[frag->body_offset];
+    }
+    int32_t i, count = frag->header_count;
+    for (i = 0; i < count; i ++) {
+        req->pub.headers[i].key = &res[frag->header_offsets[i]];
+        req->pub.headers[i].value = &res[frag->header_value_offsets[i]];
+    }
+    count = frag->param_count;
+    for (i = 0; i < count; i ++) {
+        req->pub.params[i].key = &res[frag->param_offsets[i]];
+        req->pub.params[i].value = &res[frag->param_value_offsets[i]];
+        http_decode_url_str((char*)req->pub.params[i].value);
+    }
 
-            req->pub.header_count = frag->header_count;
-            req->pub.param_count = frag->param_count;
-            req->res = res;
+    req->pub.header_count = frag->header_count;
+    req->pub.param_count = frag->param_count;
+    req->res = res;
+
+    /* HTTP/1.1 connections are kept alive unless the client closes them */
+    bool keep_alive = frag->http_1_1;
+    const char *connection = ecs_http_get_header(&req->pub, "Connection");
+    if (connection) {
+        if (http_header_value_is(connection, "close")) {
+            keep_alive = false;
+        } else if (http_header_value_is(connection, "keep-alive")) {
+            keep_alive = true;
         }
     }
 
+    req->keep_alive = keep_alive;
+    req->http_1_1 = frag->http_1_1;
+    req->reuse_count = conn->request_count;
+    req->seq = srv->request_seq ++;
     ecs_os_mutex_unlock(srv->lock);
+
+    conn->pending ++;
+    conn->request_count ++;
+
+    return keep_alive;
 }
 
 static
 bool http_parse_request(
     ecs_http_fragment_t *frag,
     const char* req_frag, 
-    ecs_size_t req_frag_len) 
+    ecs_size_t req_frag_len,
+    ecs_size_t *consumed) 
 {
     int32_t i;
-    for (i = 0; i < req_frag_len; i++) {
+    for (i = 0; i < req_frag_len && frag->state != HttpFragStateDone; i++) {
         char c = req_frag[i];
         switch (frag->state) {
         case HttpFragStateBegin:
@@ -530,8 +813,12 @@ bool http_parse_request(
             break;
         case HttpFragStateVersion:
             if (c == '\r') {
+                http_header_buf_append(frag, '\0');
+                frag->http_1_1 = !ecs_os_strcmp(frag->header_buf, "HTTP/1.1");
                 frag->state = HttpFragStateCR;
-            } /* version is not stored */
+            } else {
+                http_header_buf_append(frag, c);
+            }
             break;
         case HttpFragStateHeaderStart:
             if (http_header_writable(frag)) {
@@ -641,6 +928,9 @@ bool http_parse_request(
         }
     }
 
+    /* Remaining data belongs to the next (pipelined) request */
+    *consumed = i;
+
     if (frag->state == HttpFragStateDone) {
         return true;
     } else {
@@ -648,74 +938,6 @@ bool http_parse_request(
     }
 }
 
-static
-ecs_http_send_request_t* http_send_queue_post(
-    ecs_http_server_t *srv)
-{
-    /* This function should only be called while the server is locked. Before 
-     * the lock is released, the returned element should be populated. */
-    ecs_http_send_queue_t *sq = &srv->send_queue;
-    ecs_assert(sq->count <= ECS_HTTP_SEND_QUEUE_MAX, ECS_INTERNAL_ERROR, NULL);
-    if (sq->count == ECS_HTTP_SEND_QUEUE_MAX) {
-        return NULL;
-    }
-
-    /* Don't enqueue new requests if server is shutting down */
-    if (!srv->should_run) {
-        return NULL;
-    }
-
-    /* Return element at end of the queue */
-    return &sq->requests[(sq->cur + sq->count ++) % ECS_HTTP_SEND_QUEUE_MAX];
-}
-
-static
-ecs_http_send_request_t* http_send_queue_get(
-    ecs_http_server_t *srv)
-{
-    ecs_http_send_request_t *result = NULL;
-    ecs_os_mutex_lock(srv->lock);
-    ecs_http_send_queue_t *sq = &srv->send_queue;
-    if (sq->count) {
-        result = &sq->requests[sq->cur];
-        sq->cur = (sq->cur + 1) % ECS_HTTP_SEND_QUEUE_MAX;
-        sq->count --;
-    }
-    return result;
-}
-
-static
-void* http_server_send_queue(void* arg) {
-    ecs_http_server_t *srv = arg;
-    int32_t wait_ms = srv->send_queue.wait_ms;
-
-    /* Run for as long as the server is running or there are messages. When the
-     * server is stopping, no new messages will be enqueued */
-    while (srv->should_run || srv->send_queue.count) {
-        ecs_http_send_request_t* r = http_send_queue_get(srv);
-        if (!r) {
-            ecs_os_mutex_unlock(srv->lock);
-            /* If the queue is empty, wait so we don't run too fast */
-            if (srv->should_run) {
-                ecs_os_sleep(0, wait_ms);
-            }
-        } else {
-            ecs_size_t written = http_send(
-                r->sock, r->content, r->content_length, 0);
-            if (written != r->content_length) {
-                ecs_err("http: failed to write HTTP response body: %s",
-                    ecs_os_strerror(errno));
-            }
-            ecs_os_free(r->content);
-            if (http_socket_is_valid(r->sock)) {
-                http_close(&r->sock);
-            }
-            ecs_os_mutex_unlock(srv->lock);
-        }
-    }
-    return NULL;
-}
-
 static
 void http_append_send_headers(
     ecs_strbuf_t *hdrs,
@@ -723,7 +945,8 @@ void http_append_send_headers(
     const char* status, 
     const char* content_type,  
     ecs_strbuf_t *extra_headers,
-    ecs_size_t content_len) 
+    ecs_size_t content_len,
+    bool keep_alive) 
 {
     ecs_strbuf_appendlit(hdrs, "HTTP/1.1 ");
     ecs_strbuf_appendint(hdrs, code);
@@ -735,9 +958,20 @@ void http_append_send_headers(
     ecs_strbuf_appendstr(hdrs, content_type);
     ecs_strbuf_appendlit(hdrs, "\r\n");
 
-    ecs_strbuf_appendlit(hdrs, "Content-Length: ");
-    ecs_strbuf_append(hdrs, "%d", content_len);
-    ecs_strbuf_appendlit(hdrs, "\r\n");
+    if (content_len >= 0) {
+        ecs_strbuf_appendlit(hdrs, "Content-Length: ");
+        ecs_strbuf_append(hdrs, "%d", content_len);
+        ecs_strbuf_appendlit(hdrs, "\r\n");
+    } else {
+        /* Length of streamed reply is not known in advance */
+        ecs_strbuf_appendlit(hdrs, "Transfer-Encoding: chunked\r\n");
+    }
+
+    if (keep_alive) {
+        ecs_strbuf_appendlit(hdrs, "Connection: keep-alive\r\n");
+    } else {
+        ecs_strbuf_appendlit(hdrs, "Connection: close\r\n");
+    }
 
     ecs_strbuf_appendlit(hdrs, "Server: flecs\r\n");
 
@@ -747,254 +981,804 @@ void http_append_send_headers(
 }
 
 static
-void http_send_reply(
-    ecs_http_connection_impl_t* conn, 
-    ecs_http_reply_t* reply) 
+int http_poll_init(
+    ecs_http_server_t *srv)
 {
-    char hdrs[ECS_HTTP_REPLY_HEADER_SIZE];
-    ecs_strbuf_t hdr_buf = ECS_STRBUF_INIT;
-    hdr_buf.buf = hdrs;
-    hdr_buf.max = ECS_HTTP_REPLY_HEADER_SIZE;
-    hdr_buf.buf = hdrs;
-
-    char *content = ecs_strbuf_get(&reply->body);
-    int32_t content_length = reply->body.length - 1;
-
-    /* Use asynchronous send queue for outgoing data so send operations won't
-     * hold up main thread */
-    ecs_http_send_request_t *req = NULL;
-    if (content_length > 0) {
-        req = http_send_queue_post(conn->pub.server);
-        if (!req) {
-            reply->code = 503; /* queue full, server is busy */
-        }
-    }
+    srv->wake[0] = srv->wake[1] = HTTP_SOCKET_INVALID;
 
-    /* First, send the response HTTP headers */
-    http_append_send_headers(&hdr_buf, reply->code, reply->status, 
-        reply->content_type, &reply->headers, content_length);
+#if defined(ECS_HTTP_EPOLL)
+    srv->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (srv->epoll_fd == -1) {
+        ecs_err("http: failed to create epoll instance: %s", 
+            ecs_os_strerror(errno));
+        return -1;
+    }
 
-    ecs_size_t hdrs_len = ecs_strbuf_written(&hdr_buf);
-    hdrs[hdrs_len] = '\0';
-    ecs_size_t written = http_send(conn->sock, hdrs, hdrs_len, 0);
+    /* Wake up server thread with eventfd when replies are enqueued */
+    srv->wake[0] = srv->wake[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (srv->wake[0] == -1) {
+        ecs_err("http: failed to create eventfd: %s", ecs_os_strerror(errno));
+        return -1;
+    }
 
-    if (written != hdrs_len) {
-        ecs_err("http: failed to write HTTP response headers to '%s:%s': %s",
-            conn->pub.host, conn->pub.port, ecs_os_strerror(errno));
-        return;
+    struct epoll_event ev = { .events = EPOLLIN };
+    ev.data.u64 = ECS_HTTP_POLL_ID_WAKE;
+    if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, srv->wake[0], &ev)) {
+        ecs_err("http: failed to add eventfd to epoll: %s", 
+            ecs_os_strerror(errno));
+        return -1;
+    }
+#elif !defined(ECS_TARGET_WINDOWS)
+    /* Wake up server thread with pipe when replies are enqueued */
+    if (pipe(srv->wake)) {
+        ecs_err("http: failed to create pipe: %s", ecs_os_strerror(errno));
+        srv->wake[0] = srv->wake[1] = HTTP_SOCKET_INVALID;
+        return -1;
     }
+    http_sock_nonblock(srv->wake[0]);
+    http_sock_nonblock(srv->wake[1]);
+#else
+    /* No eventfd or pipe that works with WSAPoll. The server thread picks up
+     * enqueued replies when the poll times out. */
+#endif
 
-    /* Second, enqueue send request for response body */
-    if (req) {
-        req->sock = conn->sock;
-        req->content = content;
-        req->content_length = content_length;
+    return 0;
+}
+
+static
+void http_poll_fini(
+    ecs_http_server_t *srv)
+{
+#if defined(ECS_HTTP_EPOLL)
+    if (srv->epoll_fd != -1) {
+        close(srv->epoll_fd);
+    }
+    if (http_socket_is_valid(srv->wake[0])) {
+        close(srv->wake[0]);
+    }
+#elif !defined(ECS_TARGET_WINDOWS)
+    if (http_socket_is_valid(srv->wake[0])) {
+        close(srv->wake[0]);
+        close(srv->wake[1]);
+    }
+#endif
+#if !defined(ECS_HTTP_EPOLL)
+    ecs_vector_free(srv->poll_fds);
+    ecs_vector_free(srv->poll_ids);
+#endif
+}
 
-        /* Take ownership of values */
-        reply->body.content = NULL;
-        conn->sock = HTTP_SOCKET_INVALID;
+#if defined(ECS_HTTP_EPOLL)
+static
+uint32_t http_epoll_events(
+    int32_t events)
+{
+    uint32_t result = 0;
+    if (events & ECS_HTTP_EVENT_READ) {
+        result |= EPOLLIN;
     }
+    if (events & ECS_HTTP_EVENT_WRITE) {
+        result |= EPOLLOUT;
+    }
+    return result;
 }
+#endif
 
 static
-void http_recv_request(
+void http_poll_add(
     ecs_http_server_t *srv,
-    ecs_http_connection_impl_t *conn, 
-    uint64_t conn_id,
-    ecs_http_socket_t sock)
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
 {
-    ecs_size_t bytes_read;
-    char recv_buf[ECS_HTTP_SEND_RECV_BUFFER_SIZE];
-    ecs_http_fragment_t frag = {0};
+#if defined(ECS_HTTP_EPOLL)
+    struct epoll_event ev = { .events = http_epoll_events(events) };
+    ev.data.u64 = id;
+    if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, sock, &ev)) {
+        ecs_err("http: failed to add socket to epoll: %s", 
+            ecs_os_strerror(errno));
+    }
+#else
+    /* Poll set is rebuilt every iteration */
+    (void)srv;
+    (void)sock;
+    (void)id;
+    (void)events;
+#endif
+}
 
-    while ((bytes_read = http_recv(
-        sock, recv_buf, ECS_SIZEOF(recv_buf), 0)) > 0) 
-    {
-        bool is_alive = conn->pub.id == conn_id;
-        if (!is_alive) {
-            /* Connection has been purged by main thread */
-            return;
-        }
+static
+void http_conn_set_events(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    int32_t events)
+{
+    if (conn->events == events) {
+        return;
+    }
 
-        if (http_parse_request(&frag, recv_buf, bytes_read)) {
-            http_enqueue_request(conn, conn_id, &frag);
-            return;
-        }
+#if defined(ECS_HTTP_EPOLL)
+    struct epoll_event ev = { .events = http_epoll_events(events) };
+    ev.data.u64 = conn->pub.id;
+    if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_MOD, conn->sock, &ev)) {
+        ecs_err("http: failed to modify socket events: %s", 
+            ecs_os_strerror(errno));
     }
+#else
+    (void)srv;
+#endif
 
-    /* Partial request received, cleanup resources */
-    ecs_strbuf_reset(&frag.buf);
+    conn->events = events;
+}
 
-    /* No request was enqueued, flag connection so it'll get purged */
-    ecs_os_mutex_lock(srv->lock);
-    if (conn->pub.id == conn_id) {
-        /* Only flag connection if it was still alive */
-        conn->dequeue_timeout = ECS_HTTP_CONNECTION_PURGE_TIMEOUT;
-        conn->dequeue_retries = ECS_HTTP_CONNECTION_PURGE_RETRY_COUNT;
+#if !defined(ECS_HTTP_EPOLL)
+static
+void http_poll_fd_add(
+    ecs_http_server_t *srv,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    struct pollfd *fd = ecs_vector_add(&srv->poll_fds, struct pollfd);
+    fd->fd = sock;
+    fd->events = 0;
+    fd->revents = 0;
+    if (events & ECS_HTTP_EVENT_READ) {
+        fd->events |= POLLIN;
     }
-    ecs_os_mutex_unlock(srv->lock);
+    if (events & ECS_HTTP_EVENT_WRITE) {
+        fd->events |= POLLOUT;
+    }
+
+    uint64_t *fd_id = ecs_vector_add(&srv->poll_ids, uint64_t);
+    *fd_id = id;
 }
+#endif
 
 static
-void http_init_connection(
-    ecs_http_server_t *srv, 
-    ecs_http_socket_t sock_conn,
-    struct sockaddr_storage *remote_addr, 
-    ecs_size_t remote_addr_len) 
+int32_t http_poll_wait(
+    ecs_http_server_t *srv,
+    ecs_http_poll_event_t *events)
 {
-    http_sock_set_timeout(sock_conn, 100);
-    http_sock_keep_alive(sock_conn);
+    int32_t i, count = 0;
+
+#if defined(ECS_HTTP_EPOLL)
+    struct epoll_event evs[ECS_HTTP_POLL_EVENT_COUNT];
+    int result = epoll_wait(srv->epoll_fd, evs, ECS_HTTP_POLL_EVENT_COUNT, 
+        ECS_HTTP_POLL_TIMEOUT);
+    if (result == -1) {
+        if (errno != EINTR) {
+            ecs_err("http: epoll_wait failed: %s", ecs_os_strerror(errno));
+        }
+        return 0;
+    }
 
-    /* Create new connection */
-    ecs_os_mutex_lock(srv->lock);
-    ecs_http_connection_impl_t *conn = flecs_sparse_add(
-        srv->connections, ecs_http_connection_impl_t);
-    uint64_t conn_id = conn->pub.id = flecs_sparse_last_id(srv->connections);
-    conn->pub.server = srv;
-    conn->sock = sock_conn;
-    ecs_os_mutex_unlock(srv->lock);
+    for (i = 0; i < result; i ++) {
+        ecs_http_poll_event_t *ev = &events[count ++];
+        ev->id = evs[i].data.u64;
+        ev->read = (evs[i].events & EPOLLIN) != 0;
+        ev->write = (evs[i].events & EPOLLOUT) != 0;
+        ev->hangup = (evs[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+    }
+#else
+    ecs_vector_clear(srv->poll_fds);
+    ecs_vector_clear(srv->poll_ids);
 
-    char *remote_host = conn->pub.host;
-    char *remote_port = conn->pub.port;
+    if (http_socket_is_valid(srv->sock)) {
+        http_poll_fd_add(srv, srv->sock, 
+            ECS_HTTP_POLL_ID_LISTEN, ECS_HTTP_EVENT_READ);
+    }
+    if (http_socket_is_valid(srv->wake[0])) {
+        http_poll_fd_add(srv, srv->wake[0], 
+            ECS_HTTP_POLL_ID_WAKE, ECS_HTTP_EVENT_READ);
+    }
 
-    /* Fetch name & port info */
-    if (http_getnameinfo((struct sockaddr*) remote_addr, remote_addr_len,
-        remote_host, ECS_SIZEOF(conn->pub.host),
-        remote_port, ECS_SIZEOF(conn->pub.port),
-            NI_NUMERICHOST | NI_NUMERICSERV))
-    {
-        ecs_os_strcpy(remote_host, "unknown");
-        ecs_os_strcpy(remote_port, "unknown");
+    int32_t conn_count = flecs_sparse_count(srv->connections);
+    for (i = 1; i < conn_count; i ++) {
+        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense(
+            srv->connections, ecs_http_connection_impl_t, i);
+        if (conn->events) {
+            http_poll_fd_add(srv, conn->sock, conn->pub.id, conn->events);
+        }
     }
 
-    ecs_dbg_2("http: connection established from '%s:%s'", 
-        remote_host, remote_port);
+    struct pollfd *fds = ecs_vector_first(srv->poll_fds, struct pollfd);
+    uint64_t *ids = ecs_vector_first(srv->poll_ids, uint64_t);
+    int32_t fd_count = ecs_vector_count(srv->poll_fds);
+#if defined(ECS_TARGET_WINDOWS)
+    int result = WSAPoll(fds, (ULONG)fd_count, ECS_HTTP_POLL_TIMEOUT);
+#else
+    int result = poll(fds, (nfds_t)fd_count, ECS_HTTP_POLL_TIMEOUT);
+#endif
+    if (result == -1) {
+        if (errno != EINTR) {
+            ecs_err("http: poll failed: %s", ecs_os_strerror(errno));
+        }
+        return 0;
+    }
+
+    for (i = 0; i < fd_count && count < ECS_HTTP_POLL_EVENT_COUNT; i ++) {
+        short revents = fds[i].revents;
+        if (!revents) {
+            continue;
+        }
 
-    http_recv_request(srv, conn, conn_id, sock_conn);
+        ecs_http_poll_event_t *ev = &events[count ++];
+        ev->id = ids[i];
+        ev->read = (revents & POLLIN) != 0;
+        ev->write = (revents & POLLOUT) != 0;
+        ev->hangup = (revents & (POLLHUP | POLLERR | POLLNVAL)) != 0;
+    }
+#endif
 
-    ecs_dbg_2("http: request received from '%s:%s'", 
-        remote_host, remote_port);
+    return count;
 }
 
 static
-void http_accept_connections(
-    ecs_http_server_t* srv, 
-    const struct sockaddr* addr, 
-    ecs_size_t addr_len) 
+void http_wake(
+    ecs_http_server_t *srv)
 {
-#ifdef ECS_TARGET_WINDOWS
-    /* If on Windows, test if winsock needs to be initialized */
-    SOCKET testsocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (SOCKET_ERROR == testsocket && WSANOTINITIALISED == WSAGetLastError()) {
-        WSADATA data = { 0 };
-        int result = WSAStartup(MAKEWORD(2, 2), &data);
-        if (result) {
-            ecs_warn("http: WSAStartup failed with GetLastError = %d\n", 
-                GetLastError());
-            return;
-        }
-    } else {
-        http_close(&testsocket);
-    }
+#if defined(ECS_HTTP_EPOLL)
+    uint64_t v = 1;
+    ssize_t r = write(srv->wake[1], &v, sizeof(v));
+    (void)r;
+#elif !defined(ECS_TARGET_WINDOWS)
+    char ch = 0;
+    ssize_t r = write(srv->wake[1], &ch, 1);
+    (void)r;
+#else
+    (void)srv;
 #endif
+}
 
-    /* Resolve name + port (used for logging) */
-    char addr_host[256];
-    char addr_port[20];
+static
+void http_wake_drain(
+    ecs_http_server_t *srv)
+{
+#if defined(ECS_HTTP_EPOLL)
+    uint64_t v;
+    ssize_t r = read(srv->wake[0], &v, sizeof(v));
+    (void)r;
+#elif !defined(ECS_TARGET_WINDOWS)
+    char buf[64];
+    while (read(srv->wake[0], buf, sizeof(buf)) > 0) { }
+#else
+    (void)srv;
+#endif
+}
 
-    ecs_http_socket_t sock = HTTP_SOCKET_INVALID;
-    ecs_assert(srv->sock == HTTP_SOCKET_INVALID, ECS_INTERNAL_ERROR, NULL);
+static
+void http_conn_update_events(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    int32_t events = 0;
+    if (conn->state == HttpConnStateOpen && 
+        conn->pending < ECS_HTTP_PIPELINE_MAX) 
+    {
+        events |= ECS_HTTP_EVENT_READ;
+    }
+    if (conn->write_blocked) {
+        events |= ECS_HTTP_EVENT_WRITE;
+    }
+    http_conn_set_events(srv, conn, events);
+}
 
-    if (http_getnameinfo(
-        addr, addr_len, addr_host, ECS_SIZEOF(addr_host), addr_port, 
-        ECS_SIZEOF(addr_port), NI_NUMERICHOST | NI_NUMERICSERV))
+static
+void http_conn_close(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    (void)srv;
+    ecs_dbg_2("http: closing connection '%s:%s'", 
+        conn->pub.host, conn->pub.port);
+
+    http_replies_free(conn);
+
+    if (conn->pending) {
+        /* Requests that are being processed reference the connection, so it
+         * can't be freed yet. The connection is freed when the last reply for
+         * its requests arrives. */
+        http_close(&conn->sock);
+        ecs_strbuf_reset(&conn->frag.buf);
+        conn->events = 0;
+        conn->write_blocked = false;
+        conn->state = HttpConnStateClosed;
+    } else {
+        http_connection_free(conn);
+    }
+}
+
+static
+void http_conn_recv(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    ecs_size_t bytes_read = 1;
+    char recv_buf[ECS_HTTP_SEND_RECV_BUFFER_SIZE];
+
+    /* Stop reading when too many requests are waiting for a reply. Remaining
+     * requests stay in the socket buffer until replies have been sent. */
+    while (conn->state == HttpConnStateOpen && 
+        conn->pending < ECS_HTTP_PIPELINE_MAX) 
     {
-        ecs_os_strcpy(addr_host, "unknown");
-        ecs_os_strcpy(addr_port, "unknown");
+        bytes_read = http_recv(
+            conn->sock, recv_buf, ECS_SIZEOF(recv_buf), 0);
+        if (bytes_read <= 0) {
+            break;
+        }
+
+        conn->idle_time = 0;
+
+        /* Buffer can contain multiple (pipelined) requests */
+        ecs_size_t offset = 0, consumed;
+        while (offset < bytes_read && conn->state == HttpConnStateOpen) {
+            if (!http_parse_request(&conn->frag, &recv_buf[offset], 
+                bytes_read - offset, &consumed))
+            {
+                break;
+            }
+
+            offset += consumed;
+
+            if (conn->frag.invalid) {
+                /* Don't enqueue invalid requests */
+                http_conn_close(srv, conn);
+                return;
+            }
+
+            ecs_dbg_2("http: request received from '%s:%s'", 
+                conn->pub.host, conn->pub.port);
+
+            if (!http_enqueue_request(conn, &conn->frag)) {
+                /* Don't read new requests if connection isn't kept alive */
+                conn->state = HttpConnStateClosing;
+            }
+
+            conn->frag.state = HttpFragStateBegin;
+        }
     }
 
-    ecs_os_mutex_lock(srv->lock);
-    if (srv->should_run) {
-        ecs_dbg_2("http: initializing connection socket");
+    if (bytes_read == 0) {
+        /* Connection closed by peer. Send replies for requests that were 
+         * already received before closing the socket. */
+        if (conn->pending || ecs_vector_count(conn->replies)) {
+            conn->state = HttpConnStateClosing;
+        } else {
+            http_conn_close(srv, conn);
+            return;
+        }
+    } else if (bytes_read < 0 && !http_would_block()) {
+        http_conn_close(srv, conn);
+        return;
+    }
 
-        sock = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
-        if (!http_socket_is_valid(sock)) {
-            ecs_err("http: unable to create new connection socket: %s", 
-                ecs_os_strerror(errno));
-            ecs_os_mutex_unlock(srv->lock);
-            goto done;
+    http_conn_update_events(srv, conn);
+}
+
+static
+void http_conn_flush(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    ecs_http_iovec_t iov[ECS_HTTP_IOV_MAX];
+    int32_t i, count;
+
+    while ((count = ecs_vector_count(conn->replies))) {
+        ecs_http_send_request_t *replies = ecs_vector_first(
+            conn->replies, ecs_http_send_request_t);
+
+        /* Gather queued replies & chunks so they're sent with a single call */
+        int32_t iov_count = 0;
+        for (i = 0; i < count && iov_count < (ECS_HTTP_IOV_MAX - 1); i ++) {
+            ecs_http_send_request_t *r = &replies[i];
+            ecs_size_t offset = r->written - r->header_length;
+            if (offset < 0) {
+                http_iov_set(&iov[iov_count ++], &r->headers[r->written], 
+                    -offset);
+                offset = 0;
+            }
+            if (offset < r->content_length) {
+                http_iov_set(&iov[iov_count ++], &r->content[offset], 
+                    r->content_length - offset);
+            }
         }
 
-        int reuse = 1;
-        int result = setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, 
-            (char*)&reuse, ECS_SIZEOF(reuse)); 
-        if (result) {
-            ecs_warn("http: failed to setsockopt: %s", ecs_os_strerror(errno));
+        ecs_size_t written = 0;
+        if (iov_count) {
+            written = http_sendv(conn->sock, iov, iov_count);
+            if (written < 0) {
+                if (http_would_block()) {
+                    /* Socket buffer is full, continue when socket is 
+                     * writable */
+                    conn->write_blocked = true;
+                    http_conn_update_events(srv, conn);
+                    return;
+                }
+
+                if (errno == EPIPE || errno == ECONNRESET) {
+                    /* Client closed connection before reply was sent */
+                    ecs_dbg_2("http: connection '%s:%s' closed by client",
+                        conn->pub.host, conn->pub.port);
+                } else {
+                    ecs_err("http: failed to write HTTP response to '%s:%s': %s",
+                        conn->pub.host, conn->pub.port, ecs_os_strerror(errno));
+                }
+                http_conn_close(srv, conn);
+                return;
+            }
+
+            conn->idle_time = 0;
         }
 
-        if (addr->sa_family == AF_INET6) {
-            int ipv6only = 0;
-            if (setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, 
-                (char*)&ipv6only, ECS_SIZEOF(ipv6only)))
-            {
-                ecs_warn("http: failed to setsockopt: %s", 
-                    ecs_os_strerror(errno));
+        /* Replies must be sent in order, remove sent replies from the front of
+         * the queue */
+        int32_t sent = 0;
+        for (i = 0; i < count; i ++) {
+            ecs_http_send_request_t *r = &replies[i];
+            ecs_size_t remaining = 
+                r->header_length + r->content_length - r->written;
+            if (remaining > written) {
+                r->written += written;
+                break;
+            }
+
+            r->written += remaining;
+            written -= remaining;
+
+            if (!r->more) {
+                ecs_dbg_2("http: reply sent to '%s:%s'", 
+                    conn->pub.host, conn->pub.port);
             }
+
+            http_send_request_free(srv, conn, r);
+            sent ++;
         }
 
-        result = http_bind(sock, addr, addr_len);
-        if (result) {
-            ecs_err("http: failed to bind to '%s:%s': %s", 
-                addr_host, addr_port, ecs_os_strerror(errno));
-            ecs_os_mutex_unlock(srv->lock);
-            goto done;
+        if (sent) {
+            ecs_os_memmove(replies, &replies[sent], 
+                ECS_SIZEOF(ecs_http_send_request_t) * (count - sent));
+            ecs_vector_set_count(&conn->replies, ecs_http_send_request_t, 
+                count - sent);
         }
+    }
 
-        srv->sock = sock;
+    conn->write_blocked = false;
 
-        result = listen(srv->sock, SOMAXCONN);
-        if (result) {
-            ecs_warn("http: could not listen for SOMAXCONN (%d) connections: %s", 
-                SOMAXCONN, ecs_os_strerror(errno));
+    if (conn->state == HttpConnStateClosing && !conn->pending) {
+        http_conn_close(srv, conn);
+        return;
+    }
+
+    http_conn_update_events(srv, conn);
+}
+
+static
+void http_conn_event(
+    ecs_http_server_t *srv,
+    const ecs_http_poll_event_t *ev)
+{
+    /* Connection may have been closed by a previous event */
+    ecs_http_connection_impl_t *conn = flecs_sparse_get(
+        srv->connections, ecs_http_connection_impl_t, ev->id);
+    if (!conn || conn->state == HttpConnStateClosed) {
+        return;
+    }
+
+    if (ev->read || ev->hangup) {
+        if (conn->events & ECS_HTTP_EVENT_READ) {
+            http_conn_recv(srv, conn);
+        } else if (ev->hangup) {
+            http_conn_close(srv, conn);
+            return;
         }
+    }
 
-        ecs_trace("http: listening for incoming connections on '%s:%s'",
-            addr_host, addr_port);
-    } else {
-        ecs_dbg_2("http: server shut down while initializing");
+    if (ev->write) {
+        conn = flecs_sparse_get(
+            srv->connections, ecs_http_connection_impl_t, ev->id);
+        if (conn && conn->state != HttpConnStateClosed && conn->write_blocked) {
+            http_conn_flush(srv, conn);
+        }
     }
-    ecs_os_mutex_unlock(srv->lock);
+}
+
+static
+void http_init_connection(
+    ecs_http_server_t *srv, 
+    ecs_http_socket_t sock_conn,
+    struct sockaddr_storage *remote_addr, 
+    ecs_size_t remote_addr_len) 
+{
+    http_sock_nonblock(sock_conn);
+    http_sock_keep_alive(sock_conn);
+
+    /* Create new connection */
+    ecs_http_connection_impl_t *conn = flecs_sparse_add(
+        srv->connections, ecs_http_connection_impl_t);
+    ecs_os_memset_t(conn, 0, ecs_http_connection_impl_t);
+    conn->pub.id = flecs_sparse_last_id(srv->connections);
+    conn->pub.server = srv;
+    conn->sock = sock_conn;
+    conn->state = HttpConnStateOpen;
+    conn->stream_cond = ecs_os_cond_new();
+
+    char *remote_host = conn->pub.host;
+    char *remote_port = conn->pub.port;
+
+    /* Fetch name & port info */
+    if (http_getnameinfo((struct sockaddr*) remote_addr, remote_addr_len,
+        remote_host, ECS_SIZEOF(conn->pub.host),
+        remote_port, ECS_SIZEOF(conn->pub.port),
+            NI_NUMERICHOST | NI_NUMERICSERV))
+    {
+        ecs_os_strcpy(remote_host, "unknown");
+        ecs_os_strcpy(remote_port, "unknown");
+    }
+
+    ecs_dbg_2("http: connection established from '%s:%s'", 
+        remote_host, remote_port);
 
+    http_poll_add(srv, sock_conn, conn->pub.id, ECS_HTTP_EVENT_READ);
+    conn->events = ECS_HTTP_EVENT_READ;
+}
+
+static
+void http_accept_connections(
+    ecs_http_server_t* srv)
+{
     ecs_http_socket_t sock_conn;
     struct sockaddr_storage remote_addr;
     ecs_size_t remote_addr_len;
 
+    /* Accept until there are no more pending connections */
     while (srv->should_run) {
         remote_addr_len = ECS_SIZEOF(remote_addr);
         sock_conn = http_accept(srv->sock, (struct sockaddr*) &remote_addr, 
             &remote_addr_len);
 
-        if (sock_conn == -1) {
-            if (srv->should_run) {
+        if (!http_socket_is_valid(sock_conn)) {
+            if (!http_would_block()) {
                 ecs_dbg("http: connection attempt failed: %s", 
                     ecs_os_strerror(errno));
             }
-            continue;
+            break;
         }
 
         http_init_connection(srv, sock_conn, &remote_addr, remote_addr_len);
     }
+}
+
+/* Add reply to the replies that are sent to a connection. Replies to requests
+ * that were pipelined after a request that opened a stream can't be sent in
+ * between the chunks of the stream, and are deferred until it is closed. */
+static
+void http_conn_add_reply(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    ecs_http_send_request_t *r)
+{
+    if (conn->stream_id && r->stream_id != conn->stream_id) {
+        if (r->stream_size) {
+            /* Don't block the thread that is flushing the reply while it is
+             * deferred, as the stream may be closed by the same thread */
+            ecs_os_mutex_lock(srv->lock);
+            conn->stream_bytes -= r->stream_size;
+            ecs_os_cond_signal(conn->stream_cond);
+            ecs_os_mutex_unlock(srv->lock);
+            r->stream_size = 0;
+        }
+
+        ecs_http_send_request_t *dst = ecs_vector_add(
+            &conn->deferred, ecs_http_send_request_t);
+        *dst = *r;
+        return;
+    }
+
+    if (!r->more) {
+        conn->pending --;
+    }
+
+    ecs_http_send_request_t *dst = ecs_vector_add(
+        &conn->replies, ecs_http_send_request_t);
+    *dst = *r;
+
+    if (r->stream_id) {
+        if (r->more) {
+            conn->stream_id = r->stream_id;
+        } else {
+            /* Last chunk of stream, send deferred replies. A deferred reply
+             * can open a new stream, which defers the replies after it. */
+            ecs_vector_t *deferred = conn->deferred;
+            conn->stream_id = 0;
+            conn->deferred = NULL;
+
+            int32_t i, count = ecs_vector_count(deferred);
+            ecs_http_send_request_t *replies = ecs_vector_first(
+                deferred, ecs_http_send_request_t);
+            for (i = 0; i < count; i ++) {
+                http_conn_add_reply(srv, conn, &replies[i]);
+            }
+            ecs_vector_free(deferred);
+        }
+    }
+}
 
-done:
+static
+void http_process_send_queue(
+    ecs_http_server_t *srv)
+{
+    /* Swap queues so replies can be sent without holding the lock */
     ecs_os_mutex_lock(srv->lock);
-    if (http_socket_is_valid(sock) && errno != EBADF) {
+    ecs_vector_t *queue = srv->send_queue;
+    srv->send_queue = srv->send_queue_swap;
+    srv->send_queue_swap = queue;
+    ecs_os_mutex_unlock(srv->lock);
+
+    int32_t i, count = ecs_vector_count(queue);
+    ecs_http_send_request_t *replies = ecs_vector_first(
+        queue, ecs_http_send_request_t);
+
+    for (i = 0; i < count; i ++) {
+        ecs_http_send_request_t *r = &replies[i];
+        ecs_http_connection_impl_t *conn = flecs_sparse_get(
+            srv->connections, ecs_http_connection_impl_t, r->conn_id);
+        ecs_assert(conn != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(conn->pending > 0, ECS_INTERNAL_ERROR, NULL);
+
+        if (conn->state == HttpConnStateClosed) {
+            /* Connection was closed while request was processed */
+            if (!r->more) {
+                conn->pending --;
+            }
+            http_send_request_free(srv, conn, r);
+            if (!conn->pending) {
+                http_connection_free(conn);
+            }
+            continue;
+        }
+
+        http_conn_add_reply(srv, conn, r);
+
+        if (conn->write_blocked) {
+            /* Reply is sent when socket becomes writable */
+            http_conn_update_events(srv, conn);
+        } else {
+            http_conn_flush(srv, conn);
+        }
+    }
+
+    ecs_vector_clear(queue);
+}
+
+static
+void http_purge_connections(
+    ecs_http_server_t *srv,
+    ecs_ftime_t delta_time)
+{
+    int32_t i, count = flecs_sparse_count(srv->connections);
+    for (i = count - 1; i >= 1; i --) {
+        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense(
+            srv->connections, ecs_http_connection_impl_t, i);
+
+        if (conn->write_blocked) {
+            /* Close connections of clients that don't read replies */
+            conn->idle_time += delta_time;
+            if (conn->idle_time > (ecs_ftime_t)ECS_HTTP_SEND_TIMEOUT) {
+                ecs_dbg("http: send to '%s:%s' timed out (sock = %d)", 
+                    conn->pub.host, conn->pub.port, conn->sock);
+                http_conn_close(srv, conn);
+            }
+            continue;
+        }
+
+        if (conn->state != HttpConnStateOpen || conn->pending || 
+            ecs_vector_count(conn->replies)) 
+        {
+            continue;
+        }
+
+        /* Use a short timeout for connections that haven't sent a complete
+         * request, and a longer timeout for idle kept alive connections */
+        ecs_ftime_t timeout = (ecs_ftime_t)ECS_HTTP_CONNECTION_KEEP_ALIVE_TIMEOUT;
+        if (!conn->request_count || conn->frag.state != HttpFragStateBegin) {
+            timeout = (ecs_ftime_t)ECS_HTTP_CONNECTION_PURGE_TIMEOUT;
+        }
+
+        conn->idle_time += delta_time;
+        if (conn->idle_time > timeout) {
+            ecs_dbg("http: purging connection '%s:%s' (sock = %d)", 
+                conn->pub.host, conn->pub.port, conn->sock);
+            http_conn_close(srv, conn);
+        }
+    }
+}
+
+static
+int http_server_listen(
+    ecs_http_server_t* srv, 
+    const struct sockaddr* addr, 
+    ecs_size_t addr_len) 
+{
+#ifdef ECS_TARGET_WINDOWS
+    /* If on Windows, test if winsock needs to be initialized */
+    SOCKET testsocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (SOCKET_ERROR == testsocket && WSANOTINITIALISED == WSAGetLastError()) {
+        WSADATA data = { 0 };
+        int result = WSAStartup(MAKEWORD(2, 2), &data);
+        if (result) {
+            ecs_warn("http: WSAStartup failed with GetLastError = %d\n", 
+                GetLastError());
+            return -1;
+        }
+    } else {
+        http_close(&testsocket);
+    }
+#endif
+
+    /* Resolve name + port (used for logging) */
+    char addr_host[256];
+    char addr_port[20];
+
+    ecs_http_socket_t sock = HTTP_SOCKET_INVALID;
+    ecs_assert(srv->sock == HTTP_SOCKET_INVALID, ECS_INTERNAL_ERROR, NULL);
+
+    if (http_getnameinfo(
+        addr, addr_len, addr_host, ECS_SIZEOF(addr_host), addr_port, 
+        ECS_SIZEOF(addr_port), NI_NUMERICHOST | NI_NUMERICSERV))
+    {
+        ecs_os_strcpy(addr_host, "unknown");
+        ecs_os_strcpy(addr_port, "unknown");
+    }
+
+    ecs_dbg_2("http: initializing connection socket");
+
+    sock = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
+    if (!http_socket_is_valid(sock)) {
+        ecs_err("http: unable to create new connection socket: %s", 
+            ecs_os_strerror(errno));
+        return -1;
+    }
+
+    int reuse = 1;
+    int result = setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, 
+        (char*)&reuse, ECS_SIZEOF(reuse)); 
+    if (result) {
+        ecs_warn("http: failed to setsockopt: %s", ecs_os_strerror(errno));
+    }
+
+    if (addr->sa_family == AF_INET6) {
+        int ipv6only = 0;
+        if (setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, 
+            (char*)&ipv6only, ECS_SIZEOF(ipv6only)))
+        {
+            ecs_warn("http: failed to setsockopt: %s", 
+                ecs_os_strerror(errno));
+        }
+    }
+
+    result = http_bind(sock, addr, addr_len);
+    if (result) {
+        ecs_err("http: failed to bind to '%s:%s': %s", 
+            addr_host, addr_port, ecs_os_strerror(errno));
         http_close(&sock);
-        srv->sock = sock;
+        return -1;
     }
-    ecs_os_mutex_unlock(srv->lock);
 
-    ecs_trace("http: no longer accepting connections on '%s:%s'",
+    result = listen(sock, SOMAXCONN);
+    if (result) {
+        ecs_warn("http: could not listen for SOMAXCONN (%d) connections: %s", 
+            SOMAXCONN, ecs_os_strerror(errno));
+    }
+
+    http_sock_nonblock(sock);
+    http_poll_add(srv, sock, ECS_HTTP_POLL_ID_LISTEN, ECS_HTTP_EVENT_READ);
+    srv->sock = sock;
+
+    ecs_trace("http: listening for incoming connections on '%s:%s'",
         addr_host, addr_port);
+
+    return 0;
 }
 
 static
@@ -1011,67 +1795,461 @@ void* http_server_thread(void* arg) {
         inet_pton(AF_INET, srv->ipaddr, &(addr.sin_addr));
     }
 
-    http_accept_connections(srv, (struct sockaddr*)&addr, ECS_SIZEOF(addr));
+    if (http_server_listen(srv, (struct sockaddr*)&addr, ECS_SIZEOF(addr))) {
+        return NULL;
+    }
+
+    ecs_http_poll_event_t events[ECS_HTTP_POLL_EVENT_COUNT];
+    ecs_time_t t = {0};
+    ecs_ftime_t purge_time = 0;
+    bool has_time = ecs_os_has_time();
+    if (has_time) {
+        ecs_time_measure(&t);
+    }
+
+    /* Single thread multiplexes accepting connections, receiving requests and
+     * sending replies, so a slow client can't hold up other clients. */
+    while (srv->should_run) {
+        int32_t i, count = http_poll_wait(srv, events);
+        for (i = 0; i < count; i ++) {
+            ecs_http_poll_event_t *ev = &events[i];
+            if (ev->id == ECS_HTTP_POLL_ID_LISTEN) {
+                http_accept_connections(srv);
+            } else if (ev->id == ECS_HTTP_POLL_ID_WAKE) {
+                http_wake_drain(srv);
+            } else {
+                http_conn_event(srv, ev);
+            }
+        }
+
+        http_process_send_queue(srv);
+
+        if (has_time) {
+            purge_time += (ecs_ftime_t)ecs_time_measure(&t);
+            if ((1000 * purge_time) > (ecs_ftime_t)ECS_HTTP_POLL_TIMEOUT) {
+                http_purge_connections(srv, purge_time);
+                purge_time = 0;
+            }
+        }
+    }
+
+    http_close(&srv->sock);
+
+    ecs_trace("http: no longer accepting connections on port %u", srv->port);
+
     return NULL;
 }
 
+/* Post chunks that were sent to stream before its first reply was posted */
 static
-void http_handle_request(
+void http_stream_start(
     ecs_http_server_t *srv,
-    ecs_http_request_impl_t *req)
+    const ecs_http_send_request_t *first)
 {
-    ecs_http_reply_t reply = ECS_HTTP_REPLY_INIT;
+    ecs_http_stream_t *stream = flecs_sparse_get(
+        srv->streams, ecs_http_stream_t, first->stream_id);
+    ecs_assert(stream != NULL, ECS_INTERNAL_ERROR, NULL);
+    stream->queued += first->header_length + first->content_length;
+    stream->started = true;
+
+    int32_t i, count = ecs_vector_count(stream->backlog);
+    ecs_http_send_request_t *chunks = ecs_vector_first(
+        stream->backlog, ecs_http_send_request_t);
+    for (i = 0; i < count; i ++) {
+        ecs_http_send_request_t *r = ecs_vector_add(
+            &srv->send_queue, ecs_http_send_request_t);
+        *r = chunks[i];
+    }
+    ecs_vector_free(stream->backlog);
+    stream->backlog = NULL;
+
+    if (stream->closing) {
+        flecs_sparse_remove(srv->streams, stream->id);
+    }
+}
+
+static
+void http_post_replies(
+    ecs_http_dequeue_t *dq)
+{
+    ecs_http_server_t *srv = dq->srv;
+    int32_t i;
+
+    /* Requests must be freed before replies are posted, as the server thread 
+     * can free the connection of a request after its last reply is sent */
+    ecs_os_mutex_lock(srv->lock);
+    for (i = dq->posted; i < dq->handled; i ++) {
+        http_request_free(dq->requests[i]);
+    }
+    for (i = dq->posted; i < dq->handled; i ++) {
+        ecs_http_send_request_t *r = ecs_vector_add(
+            &srv->send_queue, ecs_http_send_request_t);
+        *r = dq->replies[i];
+        if (r->stream_id) {
+            http_stream_start(srv, r);
+        }
+    }
+    ecs_os_mutex_unlock(srv->lock);
+
+    if (dq->posted != dq->handled) {
+        dq->posted = dq->handled;
+        http_wake(srv);
+    }
+}
+
+static
+char* http_strbuf_take(
+    ecs_strbuf_t *buf,
+    ecs_size_t *length)
+{
+    *length = ecs_strbuf_written(buf);
+    char *result = ecs_strbuf_get(buf);
+
+    /* Reinitialize buffer but keep list state, so that a serializer that is 
+     * writing to the buffer can continue appending */
+    ecs_strbuf_t empty = ECS_STRBUF_INIT;
+    ecs_os_memcpy_n(empty.list_stack, buf->list_stack, ecs_strbuf_list_elem,
+        (buf->list_sp + 1));
+    empty.list_sp = buf->list_sp;
+    *buf = empty;
+
+    return result;
+}
+
+static
+void http_chunk_init(
+    ecs_http_send_request_t *out,
+    ecs_strbuf_t *hdrs,
+    ecs_strbuf_t *body,
+    bool last)
+{
+    ecs_size_t length = ecs_strbuf_written(body);
+    if (length) {
+        ecs_strbuf_append(hdrs, "%x\r\n", length);
+        ecs_strbuf_appendlit(body, "\r\n");
+    }
+    if (last) {
+        ecs_strbuf_appendlit(body, "0\r\n\r\n");
+    }
+
+    out->header_length = ecs_strbuf_written(hdrs);
+    out->headers = ecs_strbuf_get(hdrs);
+    out->content = http_strbuf_take(body, &out->content_length);
+    out->written = 0;
+    out->more = !last;
+}
+
+int ecs_http_reply_flush(
+    ecs_http_reply_t *reply)
+{
+    ecs_check(reply != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_http_reply_ctx_t *stream = reply->stream;
+    if (!stream) {
+        /* Reply wasn't created by the server, body is sent when complete */
+        return 0;
+    }
+
+    ecs_http_request_impl_t *req = stream->req;
+    ecs_http_server_t *srv = stream->dq->srv;
+
+    /* Connection isn't freed while it has requests that are being handled */
     ecs_http_connection_impl_t *conn = 
         (ecs_http_connection_impl_t*)req->pub.conn;
 
+    if (!req->http_1_1) {
+        /* Chunked transfer encoding is not supported by HTTP/1.0 */
+        return 0;
+    }
+
+    if (!ecs_strbuf_written(&reply->body)) {
+        return 0;
+    }
+
+    /* Make sure replies to earlier requests are sent first */
+    http_post_replies(stream->dq);
+
+    ecs_http_send_request_t chunk = { .conn_id = req->conn_id };
+    ecs_strbuf_t hdrs = ECS_STRBUF_INIT;
+    if (!stream->started) {
+        http_append_send_headers(&hdrs, reply->code, reply->status, 
+            reply->content_type, &reply->headers, -1, req->keep_alive);
+        stream->started = true;
+    }
+
+    http_chunk_init(&chunk, &hdrs, &reply->body, false);
+    chunk.stream_size = chunk.header_length + chunk.content_length;
+
+    ecs_os_mutex_lock(srv->lock);
+    ecs_http_send_request_t *r = ecs_vector_add(
+        &srv->send_queue, ecs_http_send_request_t);
+    *r = chunk;
+    conn->stream_bytes += chunk.stream_size;
+    http_wake(srv);
+
+    /* Wait until enough queued data has been sent. Clients that don't read
+     * data are disconnected after ECS_HTTP_SEND_TIMEOUT. Check should_run 
+     * first, as connections are freed when the server is stopped. */
+    while (srv->should_run && !conn->stream_closed &&
+        conn->stream_bytes > ECS_HTTP_STREAM_QUEUE_MAX) 
+    {
+        ecs_os_cond_wait(conn->stream_cond, srv->lock);
+    }
+
+    bool closed = !srv->should_run || conn->stream_closed;
+    ecs_os_mutex_unlock(srv->lock);
+
+    return closed ? -1 : 0;
+error:
+    return -1;
+}
+
+static
+void http_handle_request(
+    ecs_http_dequeue_t *dq,
+    ecs_http_request_impl_t *req,
+    ecs_http_send_request_t *out)
+{
+    ecs_http_server_t *srv = dq->srv;
+    ecs_http_reply_ctx_t ctx = { .dq = dq, .req = req };
+    ecs_http_reply_t reply = ECS_HTTP_REPLY_INIT;
+    reply.stream = &ctx;
+
     if (srv->callback((ecs_http_request_t*)req, &reply, srv->ctx) == false) {
-        reply.code = 404;
-        reply.status = "Resource not found";
+        if (ctx.started || ctx.open) {
+            ecs_err("http: cannot return 404 after reply is flushed");
+        } else {
+            reply.code = 404;
+            reply.status = "Resource not found";
+        }
     }
 
-    http_send_reply(conn, &reply);
-    ecs_dbg_2("http: reply sent to '%s:%s'", conn->pub.host, conn->pub.port);
+    ecs_os_zeromem(out);
+    out->conn_id = req->conn_id;
+
+    ecs_strbuf_t hdrs = ECS_STRBUF_INIT;
+    if (ctx.open) {
+        /* Send headers & body as first chunk of stream */
+        if (!ctx.started) {
+            http_append_send_headers(&hdrs, reply.code, reply.status, 
+                reply.content_type, &reply.headers, -1, req->keep_alive);
+        }
+        http_chunk_init(out, &hdrs, &reply.body, false);
+        out->stream_id = ctx.open->id;
+    } else if (ctx.started) {
+        /* Send remainder of streamed reply as last chunk */
+        http_chunk_init(out, &hdrs, &reply.body, true);
+    } else {
+        ecs_size_t content_length = ecs_strbuf_written(&reply.body);
+        http_append_send_headers(&hdrs, reply.code, reply.status, 
+            reply.content_type, &reply.headers, content_length, 
+                req->keep_alive);
+        out->header_length = ecs_strbuf_written(&hdrs);
+        out->headers = ecs_strbuf_get(&hdrs);
+        out->content = http_strbuf_take(&reply.body, &out->content_length);
+    }
 
     http_reply_free(&reply);
-    http_request_free(req);
-    http_connection_free(conn);
+}
+
+ecs_http_stream_t* ecs_http_reply_open_stream(
+    ecs_http_reply_t *reply)
+{
+    ecs_check(reply != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_http_reply_ctx_t *ctx = reply->stream;
+    ecs_check(ctx != NULL, ECS_INVALID_OPERATION, 
+        "reply must be created by the server");
+
+    if (!ctx->req->http_1_1) {
+        /* Chunked transfer encoding is not supported by HTTP/1.0 */
+        return NULL;
+    }
+
+    if (!ctx->open) {
+        ecs_http_server_t *srv = ctx->dq->srv;
+        ecs_os_mutex_lock(srv->lock);
+        ecs_http_stream_t *stream = flecs_sparse_add(
+            srv->streams, ecs_http_stream_t);
+        ecs_os_zeromem(stream);
+        stream->id = flecs_sparse_last_id(srv->streams);
+        stream->srv = srv;
+        stream->conn_id = ctx->req->conn_id;
+        ecs_os_mutex_unlock(srv->lock);
+        ctx->open = stream;
+    }
+
+    return ctx->open;
+error:
+    return NULL;
+}
+
+int ecs_http_stream_send(
+    ecs_http_stream_t *stream,
+    ecs_strbuf_t *buf)
+{
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(buf != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_http_server_t *srv = stream->srv;
+    ecs_http_send_request_t chunk = { 
+        .conn_id = stream->conn_id, 
+        .stream_id = stream->id 
+    };
+
+    ecs_strbuf_t hdrs = ECS_STRBUF_INIT;
+    if (ecs_strbuf_written(buf)) {
+        http_chunk_init(&chunk, &hdrs, buf, false);
+    }
+
+    ecs_os_mutex_lock(srv->lock);
+    bool closed = stream->closed || !srv->should_run;
+    if (!closed && chunk.content_length) {
+        stream->queued += chunk.header_length + chunk.content_length;
+        if (stream->started) {
+            ecs_http_send_request_t *r = ecs_vector_add(
+                &srv->send_queue, ecs_http_send_request_t);
+            *r = chunk;
+            http_wake(srv);
+        } else {
+            ecs_http_send_request_t *r = ecs_vector_add(
+                &stream->backlog, ecs_http_send_request_t);
+            *r = chunk;
+        }
+    }
+    ecs_os_mutex_unlock(srv->lock);
+
+    if (closed) {
+        ecs_os_free(chunk.headers);
+        ecs_os_free(chunk.content);
+        return -1;
+    }
+
+    return 0;
+error:
+    return -1;
+}
+
+int32_t ecs_http_stream_queued(
+    const ecs_http_stream_t *stream)
+{
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_http_server_t *srv = stream->srv;
+    ecs_os_mutex_lock(srv->lock);
+    int32_t result = stream->queued;
+    ecs_os_mutex_unlock(srv->lock);
+    return result;
+error:
+    return 0;
+}
+
+void ecs_http_stream_close(
+    ecs_http_stream_t *stream)
+{
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_http_server_t *srv = stream->srv;
+    ecs_http_send_request_t chunk = { 
+        .conn_id = stream->conn_id, 
+        .stream_id = stream->id 
+    };
+
+    ecs_strbuf_t hdrs = ECS_STRBUF_INIT;
+    ecs_strbuf_t body = ECS_STRBUF_INIT;
+    http_chunk_init(&chunk, &hdrs, &body, true);
+
+    ecs_os_mutex_lock(srv->lock);
+    bool running = srv->should_run;
+    if (!running) {
+        http_stream_free(stream);
+    } else if (stream->started) {
+        /* Last chunk releases the connection */
+        flecs_sparse_remove(srv->streams, stream->id);
+        ecs_http_send_request_t *r = ecs_vector_add(
+            &srv->send_queue, ecs_http_send_request_t);
+        *r = chunk;
+        http_wake(srv);
+    } else {
+        /* Stream is removed when first reply is posted */
+        ecs_http_send_request_t *r = ecs_vector_add(
+            &stream->backlog, ecs_http_send_request_t);
+        *r = chunk;
+        stream->closing = true;
+    }
+    ecs_os_mutex_unlock(srv->lock);
+
+    if (!running) {
+        ecs_os_free(chunk.content);
+    }
+error:
+    return;
+}
+
+static
+int http_request_compare(
+    const void *ptr1,
+    const void *ptr2)
+{
+    const ecs_http_request_impl_t *r1 = *(ecs_http_request_impl_t*const*)ptr1;
+    const ecs_http_request_impl_t *r2 = *(ecs_http_request_impl_t*const*)ptr2;
+    return (r1->seq > r2->seq) - (r1->seq < r2->seq);
 }
 
 static
 int32_t http_dequeue_requests(
-    ecs_http_server_t *srv,
-    ecs_ftime_t delta_time)
+    ecs_http_server_t *srv)
 {
+    /* Copy out request pointers, so the server thread isn't blocked while
+     * request handlers run. Requests are not freed until replies are posted,
+     * and the connection of a request is kept alive until it gets a reply. */
     ecs_os_mutex_lock(srv->lock);
-
-    int32_t i, request_count = flecs_sparse_count(srv->requests);
-    for (i = request_count - 1; i >= 1; i --) {
-        ecs_http_request_impl_t *req = flecs_sparse_get_dense(
-            srv->requests, ecs_http_request_impl_t, i);
-        http_handle_request(srv, req);
+    int32_t i, request_count = flecs_sparse_count(srv->requests) - 1;
+    if (request_count <= 0) {
+        ecs_os_mutex_unlock(srv->lock);
+        return 0;
     }
 
-    int32_t connections_count = flecs_sparse_count(srv->connections);
-    for (i = connections_count - 1; i >= 1; i --) {
-        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense(
-            srv->connections, ecs_http_connection_impl_t, i);
+    ecs_http_request_impl_t **requests = ecs_os_malloc_n(
+        ecs_http_request_impl_t*, request_count);
+    for (i = 0; i < request_count; i ++) {
+        requests[i] = flecs_sparse_get_dense(
+            srv->requests, ecs_http_request_impl_t, i + 1);
+    }
+    srv->dequeueing = true;
+    ecs_os_mutex_unlock(srv->lock);
 
-        conn->dequeue_timeout += delta_time;
-        conn->dequeue_retries ++;
-        
-        if ((conn->dequeue_timeout > 
-            (ecs_ftime_t)ECS_HTTP_CONNECTION_PURGE_TIMEOUT) &&
-             (conn->dequeue_retries > ECS_HTTP_CONNECTION_PURGE_RETRY_COUNT)) 
-        {
-            ecs_dbg("http: purging connection '%s:%s' (sock = %d)", 
-                conn->pub.host, conn->pub.port, conn->sock);
-            http_connection_free(conn);
+    /* Handle requests in order of arrival, so that replies for pipelined 
+     * requests are enqueued in the same order as the requests */
+    ecs_qsort_t(requests, request_count, ecs_http_request_impl_t*, 
+        http_request_compare);
+
+    ecs_http_dequeue_t dq = {
+        .srv = srv,
+        .requests = requests,
+        .replies = ecs_os_malloc_n(ecs_http_send_request_t, request_count)
+    };
+
+    for (i = 0; i < request_count; i ++) {
+        if (requests[i]->reuse_count) {
+            srv->requests_reused ++;
+            srv->requests_reused_total ++;
         }
+
+        http_handle_request(&dq, requests[i], &dq.replies[i]);
+        dq.handled ++;
     }
 
+    http_post_replies(&dq);
+
+    ecs_os_mutex_lock(srv->lock);
+    srv->dequeueing = false;
+    ecs_os_cond_broadcast(srv->dequeue_cond);
     ecs_os_mutex_unlock(srv->lock);
 
-    return request_count - 1;
+    ecs_os_free(requests);
+    ecs_os_free(dq.replies);
+
+    return request_count;
 }
 
 const char* ecs_http_get_header(
@@ -1106,6 +2284,7 @@ ecs_http_server_t* ecs_http_server_init(
 
     ecs_http_server_t* srv = ecs_os_calloc_t(ecs_http_server_t);
     srv->lock = ecs_os_mutex_new();
+    srv->dequeue_cond = ecs_os_cond_new();
     srv->sock = HTTP_SOCKET_INVALID;
 
     srv->should_run = false;
@@ -1115,17 +2294,15 @@ ecs_http_server_t* ecs_http_server_init(
     srv->ctx = desc->ctx;
     srv->port = desc->port;
     srv->ipaddr = desc->ipaddr;
-    srv->send_queue.wait_ms = desc->send_queue_wait_ms;
-    if (!srv->send_queue.wait_ms) {
-        srv->send_queue.wait_ms = 100 * 1000 * 1000;
-    }
 
     srv->connections = flecs_sparse_new(NULL, NULL, ecs_http_connection_impl_t);
     srv->requests = flecs_sparse_new(NULL, NULL, ecs_http_request_impl_t);
+    srv->streams = flecs_sparse_new(NULL, NULL, ecs_http_stream_t);
 
     /* Start at id 1 */
     flecs_sparse_new_id(srv->connections);
     flecs_sparse_new_id(srv->requests);
+    flecs_sparse_new_id(srv->streams);
 
 #ifndef ECS_TARGET_WINDOWS
     /* Ignore pipe signal. SIGPIPE can occur when a message is sent to a client
@@ -1133,6 +2310,11 @@ ecs_http_server_t* ecs_http_server_init(
     signal(SIGPIPE, SIG_IGN);
 #endif
 
+    if (http_poll_init(srv)) {
+        ecs_http_server_fini(srv);
+        return NULL;
+    }
+
     return srv;
 error:
     return NULL;
@@ -1144,9 +2326,21 @@ void ecs_http_server_fini(
     if (srv->should_run) {
         ecs_http_server_stop(srv);
     }
+    http_poll_fini(srv);
+    ecs_os_cond_free(srv->dequeue_cond);
     ecs_os_mutex_free(srv->lock);
     flecs_sparse_free(srv->connections);
     flecs_sparse_free(srv->requests);
+
+    /* Free streams that weren't closed by the application */
+    int32_t i, count = flecs_sparse_count(srv->streams);
+    for (i = count - 1; i >= 1; i --) {
+        http_stream_free(flecs_sparse_get_dense(
+            srv->streams, ecs_http_stream_t, i));
+    }
+    flecs_sparse_free(srv->streams);
+    ecs_vector_free(srv->send_queue);
+    ecs_vector_free(srv->send_queue_swap);
     ecs_os_free(srv);
 }
 
@@ -1167,11 +2361,6 @@ int ecs_http_server_start(
         goto error;
     }
 
-    srv->send_queue.thread = ecs_os_thread_new(http_server_send_queue, srv);
-    if (!srv->send_queue.thread) {
-        goto error;
-    }
-
     return 0;
 error:
     return -1;
@@ -1189,17 +2378,28 @@ void ecs_http_server_stop(
 
     ecs_os_mutex_lock(srv->lock);
     srv->should_run = false;
-    if (http_socket_is_valid(srv->sock)) {
-        http_close(&srv->sock);
-    }
     ecs_os_mutex_unlock(srv->lock);
 
+    http_wake(srv);
     ecs_os_thread_join(srv->thread);
-    ecs_os_thread_join(srv->send_queue.thread);
-    ecs_trace("http: server threads shut down");
+    ecs_trace("http: server thread shut down");
+
+    /* Wake up handlers that wait for chunks to be sent, as the server thread
+     * no longer sends them, and wait until handlers have returned. */
+    int i, count = flecs_sparse_count(srv->connections);
+    ecs_os_mutex_lock(srv->lock);
+    for (i = 1; i < count; i ++) {
+        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense(
+            srv->connections, ecs_http_connection_impl_t, i);
+        ecs_os_cond_broadcast(conn->stream_cond);
+    }
+    while (srv->dequeueing) {
+        ecs_os_cond_wait(srv->dequeue_cond, srv->lock);
+    }
+    ecs_os_mutex_unlock(srv->lock);
 
     /* Cleanup all outstanding requests */
-    int i, count = flecs_sparse_count(srv->requests);
+    count = flecs_sparse_count(srv->requests);
     for (i = count - 1; i >= 1; i --) {
         http_request_free(flecs_sparse_get_dense(
             srv->requests, ecs_http_request_impl_t, i));
@@ -1212,6 +2412,15 @@ void ecs_http_server_stop(
             srv->connections, ecs_http_connection_impl_t, i));
     }
 
+    /* Free replies that weren't sent */
+    count = ecs_vector_count(srv->send_queue);
+    ecs_http_send_request_t *replies = ecs_vector_first(
+        srv->send_queue, ecs_http_send_request_t);
+    for (i = 0; i < count; i ++) {
+        http_send_request_free(srv, NULL, &replies[i]);
+    }
+    ecs_vector_clear(srv->send_queue);
+
     ecs_assert(flecs_sparse_count(srv->connections) == 1, 
         ECS_INTERNAL_ERROR, NULL);
     ecs_assert(flecs_sparse_count(srv->requests) == 1,
@@ -1240,7 +2449,7 @@ void ecs_http_server_dequeue(
 
         ecs_time_t t = {0};
         ecs_time_measure(&t);
-        int32_t request_count = http_dequeue_requests(srv, srv->dequeue_timeout);
+        int32_t request_count = http_dequeue_requests(srv);
         srv->requests_processed += request_count;
         srv->requests_processed_total += request_count;
         ecs_ftime_t time_spent = (ecs_ftime_t)ecs_time_measure(&t);
@@ -1253,10 +2462,13 @@ void ecs_http_server_dequeue(
         (ecs_ftime_t)ECS_HTTP_MIN_STATS_INTERVAL) 
     {
         srv->stats_timeout = 0;
-        ecs_dbg("http: processed %d requests in %.3fs (avg %.3fs / dequeue)",
-            srv->requests_processed, (double)srv->request_time, 
+        ecs_dbg("http: processed %d requests (%d on reused connections) in "
+            "%.3fs (avg %.3fs / dequeue)",
+            srv->requests_processed, srv->requests_reused,
+            (double)srv->request_time, 
             (double)(srv->request_time / (ecs_ftime_t)srv->dequeue_count));
         srv->requests_processed = 0;
+        srv->requests_reused = 0;
         srv->request_time = 0;
         srv->dequeue_count = 0;
     }
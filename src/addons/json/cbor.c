@@ -0,0 +1,403 @@
+/**
+ * @file addons/json/cbor.c
+ * @brief CBOR (RFC 8949) encoding utilities.
+ *
+ * The binary serializer writes the same data model as the JSON serializer, so
+ * that clients can decode a reply into the same structure regardless of the
+ * format. Multi-byte values in item headers are big endian as required by the
+ * specification, typed arrays (RFC 8746) use the byte order of the host.
+ */
+
+#include "json.h"
+
+#ifdef FLECS_JSON
+
+static
+void flecs_cbor_byte(
+    ecs_strbuf_t *buf,
+    uint8_t value)
+{
+    ecs_strbuf_appendch(buf, (char)value);
+}
+
+void flecs_cbor_head(
+    ecs_strbuf_t *buf,
+    uint8_t major,
+    uint64_t value)
+{
+    uint8_t bytes[9];
+    int32_t count;
+    major = (uint8_t)(major << 5);
+
+    if (value < FLECS_CBOR_UINT8) {
+        bytes[0] = (uint8_t)(major | value);
+        count = 0;
+    } else if (value <= UINT8_MAX) {
+        bytes[0] = (uint8_t)(major | FLECS_CBOR_UINT8);
+        count = 1;
+    } else if (value <= UINT16_MAX) {
+        bytes[0] = (uint8_t)(major | FLECS_CBOR_UINT16);
+        count = 2;
+    } else if (value <= UINT32_MAX) {
+        bytes[0] = (uint8_t)(major | FLECS_CBOR_UINT32);
+        count = 4;
+    } else {
+        bytes[0] = (uint8_t)(major | FLECS_CBOR_UINT64);
+        count = 8;
+    }
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        bytes[count - i] = (uint8_t)(value >> (i * 8));
+    }
+
+    ecs_strbuf_appendbin(buf, bytes, count + 1);
+}
+
+void flecs_cbor_uint(
+    ecs_strbuf_t *buf,
+    uint64_t value)
+{
+    flecs_cbor_head(buf, EcsCborUint, value);
+}
+
+void flecs_cbor_int(
+    ecs_strbuf_t *buf,
+    int64_t value)
+{
+    if (value >= 0) {
+        flecs_cbor_head(buf, EcsCborUint, (uint64_t)value);
+    } else {
+        /* Negative integers are encoded as -1 - value */
+        flecs_cbor_head(buf, EcsCborNegInt, (uint64_t)(-1 - value));
+    }
+}
+
+void flecs_cbor_float32(
+    ecs_strbuf_t *buf,
+    float value)
+{
+    uint32_t bits;
+    ecs_os_memcpy(&bits, &value, 4);
+
+    uint8_t bytes[5] = { FLECS_CBOR_FLOAT32,
+        (uint8_t)(bits >> 24), (uint8_t)(bits >> 16),
+        (uint8_t)(bits >> 8), (uint8_t)bits };
+    ecs_strbuf_appendbin(buf, bytes, 5);
+}
+
+void flecs_cbor_float64(
+    ecs_strbuf_t *buf,
+    double value)
+{
+    uint64_t bits;
+    ecs_os_memcpy(&bits, &value, 8);
+
+    uint8_t bytes[9];
+    bytes[0] = FLECS_CBOR_FLOAT64;
+    int32_t i;
+    for (i = 0; i < 8; i ++) {
+        bytes[8 - i] = (uint8_t)(bits >> (i * 8));
+    }
+    ecs_strbuf_appendbin(buf, bytes, 9);
+}
+
+void flecs_cbor_bool(
+    ecs_strbuf_t *buf,
+    bool value)
+{
+    flecs_cbor_byte(buf, value ? FLECS_CBOR_TRUE : FLECS_CBOR_FALSE);
+}
+
+void flecs_cbor_null(
+    ecs_strbuf_t *buf)
+{
+    flecs_cbor_byte(buf, FLECS_CBOR_NULL);
+}
+
+void flecs_cbor_array(
+    ecs_strbuf_t *buf,
+    int32_t count)
+{
+    flecs_cbor_head(buf, EcsCborArray, flecs_uto(uint64_t, count));
+}
+
+void flecs_cbor_array_push(
+    ecs_strbuf_t *buf)
+{
+    flecs_cbor_byte(buf, (EcsCborArray << 5) | FLECS_CBOR_INDEFINITE);
+}
+
+void flecs_cbor_array_pop(
+    ecs_strbuf_t *buf)
+{
+    flecs_cbor_byte(buf, FLECS_CBOR_BREAK);
+}
+
+void flecs_cbor_object_push(
+    ecs_strbuf_t *buf)
+{
+    flecs_cbor_byte(buf, (EcsCborMap << 5) | FLECS_CBOR_INDEFINITE);
+}
+
+void flecs_cbor_object_pop(
+    ecs_strbuf_t *buf)
+{
+    flecs_cbor_byte(buf, FLECS_CBOR_BREAK);
+}
+
+void flecs_cbor_stringn(
+    ecs_strbuf_t *buf,
+    const char *value,
+    int32_t len)
+{
+    flecs_cbor_head(buf, EcsCborText, flecs_uto(uint64_t, len));
+    ecs_strbuf_appendbin(buf, value, len);
+}
+
+void flecs_cbor_string(
+    ecs_strbuf_t *buf,
+    const char *value)
+{
+    if (value) {
+        flecs_cbor_stringn(buf, value, ecs_os_strlen(value));
+    } else {
+        flecs_cbor_null(buf);
+    }
+}
+
+void flecs_cbor_strbuf(
+    ecs_strbuf_t *buf,
+    ecs_strbuf_t *str)
+{
+    int32_t len = ecs_strbuf_written(str);
+    if (len <= ECS_STRBUF_ELEMENT_SIZE) {
+        /* Don't allocate for strings that fit in the first element */
+        flecs_cbor_stringn(buf, ecs_strbuf_get_small(str), len);
+        ecs_strbuf_reset(str);
+    } else {
+        char *value = ecs_strbuf_get(str);
+        flecs_cbor_stringn(buf, value, len);
+        ecs_os_free(value);
+    }
+}
+
+void flecs_cbor_path(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_entity_t e)
+{
+    ecs_strbuf_t str = ECS_STRBUF_INIT;
+    ecs_get_path_w_sep_buf(world, 0, e, ".", "", &str);
+    flecs_cbor_strbuf(buf, &str);
+}
+
+void flecs_cbor_label(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_entity_t e)
+{
+    const char *lbl = NULL;
+#ifdef FLECS_DOC
+    lbl = ecs_doc_get_name(world, e);
+#else
+    lbl = ecs_get_name(world, e);
+#endif
+
+    if (lbl) {
+        flecs_cbor_string(buf, lbl);
+    } else {
+        flecs_cbor_uint(buf, 0);
+    }
+}
+
+void flecs_cbor_color(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_entity_t e)
+{
+    (void)world;
+    (void)e;
+
+    const char *color = NULL;
+#ifdef FLECS_DOC
+    color = ecs_doc_get_color(world, e);
+#endif
+
+    if (color) {
+        flecs_cbor_string(buf, color);
+    } else {
+        flecs_cbor_uint(buf, 0);
+    }
+}
+
+void flecs_cbor_id(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_id_t id)
+{
+    ecs_strbuf_t str = ECS_STRBUF_INIT;
+    ecs_id_str_buf(world, id, &str);
+    flecs_cbor_strbuf(buf, &str);
+}
+
+void flecs_cbor_typed_array(
+    ecs_strbuf_t *buf,
+    uint64_t tag,
+    const void *data,
+    ecs_size_t size)
+{
+    flecs_cbor_head(buf, EcsCborTag, tag);
+    flecs_cbor_head(buf, EcsCborBytes, flecs_uto(uint64_t, size));
+    ecs_strbuf_appendbin(buf, data, size);
+}
+
+static
+bool flecs_cbor_little_endian(void) {
+    uint16_t value = 1;
+    return ((uint8_t*)&value)[0] == 1;
+}
+
+uint64_t flecs_cbor_typed_array_tag(
+    ecs_meta_type_op_kind_t kind)
+{
+    /* Typed array tags are encoded as 0b010_f_s_e_ll, where f is set for
+     * floating point types, s for signed integers, e for little endian and
+     * ll is the size class of the element. */
+    uint64_t tag;
+    switch(kind) {
+    case EcsOpByte:
+    case EcsOpU8:  return 64; /* Endianness does not apply to 8 bit types */
+    case EcsOpI8:  return 72;
+    case EcsOpU16: tag = 65; break;
+    case EcsOpU32: tag = 66; break;
+    case EcsOpU64: tag = 67; break;
+    case EcsOpI16: tag = 73; break;
+    case EcsOpI32: tag = 74; break;
+    case EcsOpI64: tag = 75; break;
+    case EcsOpF32: tag = 81; break;
+    case EcsOpF64: tag = 82; break;
+    default:
+        return 0;
+    }
+
+    if (flecs_cbor_little_endian()) {
+        tag |= 4;
+    }
+
+    return tag;
+}
+
+uint64_t flecs_cbor_packed_tag(
+    const ecs_meta_type_op_t *ops,
+    int32_t op_count,
+    ecs_size_t size)
+{
+    ecs_meta_type_op_kind_t kind = EcsOpPush;
+    ecs_size_t packed_size = 0;
+
+    int32_t i;
+    for (i = 0; i < op_count; i ++) {
+        const ecs_meta_type_op_t *op = &ops[i];
+        if (op->kind == EcsOpPush || op->kind == EcsOpPop) {
+            if (op->count > 1) {
+                /* Inline array of structs */
+                return 0;
+            }
+            continue;
+        }
+
+        if (kind == EcsOpPush) {
+            kind = op->kind;
+        } else if (kind != op->kind) {
+            return 0;
+        }
+
+        packed_size += op->size * op->count;
+    }
+
+    if (packed_size != size) {
+        /* Type has padding, or contains non-trivial members */
+        return 0;
+    }
+
+    return flecs_cbor_typed_array_tag(kind);
+}
+
+int flecs_cbor_read_head(
+    const uint8_t **ptr_ref,
+    const uint8_t *end,
+    ecs_cbor_major_t *major_out,
+    uint64_t *value_out,
+    bool *indefinite_out)
+{
+    const uint8_t *ptr = *ptr_ref;
+    if (ptr >= end) {
+        return -1;
+    }
+
+    uint8_t initial = *ptr ++;
+    uint8_t info = initial & 31;
+    *major_out = (ecs_cbor_major_t)(initial >> 5);
+    *indefinite_out = false;
+
+    int32_t count = 0;
+    if (info < FLECS_CBOR_UINT8) {
+        *value_out = info;
+    } else if (info == FLECS_CBOR_UINT8) {
+        count = 1;
+    } else if (info == FLECS_CBOR_UINT16) {
+        count = 2;
+    } else if (info == FLECS_CBOR_UINT32) {
+        count = 4;
+    } else if (info == FLECS_CBOR_UINT64) {
+        count = 8;
+    } else if (info == FLECS_CBOR_INDEFINITE) {
+        *indefinite_out = true;
+        *value_out = 0;
+    } else {
+        return -1;
+    }
+
+    if (count) {
+        if ((end - ptr) < count) {
+            return -1;
+        }
+
+        uint64_t value = 0;
+        int32_t i;
+        for (i = 0; i < count; i ++) {
+            value = (value << 8) | ptr[i];
+        }
+        ptr += count;
+        *value_out = value;
+    }
+
+    *ptr_ref = ptr;
+    return 0;
+}
+
+bool flecs_cbor_is_break(
+    const uint8_t *ptr,
+    const uint8_t *end)
+{
+    return ptr < end && ptr[0] == FLECS_CBOR_BREAK;
+}
+
+double flecs_cbor_to_float(
+    uint8_t initial,
+    uint64_t value)
+{
+    if (initial == FLECS_CBOR_FLOAT32) {
+        uint32_t bits = (uint32_t)value;
+        float result;
+        ecs_os_memcpy(&result, &bits, 4);
+        return (double)result;
+    } else {
+        double result;
+        ecs_os_memcpy(&result, &value, 8);
+        return result;
+    }
+}
+
+#endif
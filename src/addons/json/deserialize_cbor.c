@@ -0,0 +1,362 @@
+/**
+ * @file addons/json/deserialize_cbor.c
+ * @brief Deserialize CBOR into values.
+ */
+
+#include "json.h"
+
+#ifdef FLECS_JSON
+
+static
+const uint8_t* flecs_cbor_parse_value(
+    ecs_meta_cursor_t *cur,
+    const uint8_t *ptr,
+    const uint8_t *end);
+
+/* Text strings aren't terminated, copy to buffer before passing to cursor */
+static
+const uint8_t* flecs_cbor_parse_text(
+    const uint8_t *ptr,
+    const uint8_t *end,
+    uint64_t len,
+    char *token,
+    char **str_out)
+{
+    if ((uint64_t)(end - ptr) < len) {
+        return NULL;
+    }
+
+    char *str = token;
+    if (len >= ECS_MAX_TOKEN_SIZE) {
+        str = ecs_os_malloc(flecs_uto(ecs_size_t, len + 1));
+    }
+
+    ecs_os_memcpy(str, ptr, flecs_uto(ecs_size_t, len));
+    str[len] = '\0';
+    *str_out = str;
+
+    return ptr + len;
+}
+
+static
+const uint8_t* flecs_cbor_parse_elements(
+    ecs_meta_cursor_t *cur,
+    const uint8_t *ptr,
+    const uint8_t *end,
+    uint64_t count,
+    bool indefinite)
+{
+    if (ecs_meta_push(cur) != 0) {
+        return NULL;
+    }
+
+    if (!ecs_meta_is_collection(cur)) {
+        ecs_err("cbor: unexpected array for non-collection type");
+        return NULL;
+    }
+
+    uint64_t i;
+    for (i = 0; indefinite || i < count; i ++) {
+        if (indefinite && flecs_cbor_is_break(ptr, end)) {
+            ptr ++;
+            break;
+        }
+
+        if (i && ecs_meta_next(cur) != 0) {
+            return NULL;
+        }
+
+        if (!(ptr = flecs_cbor_parse_value(cur, ptr, end))) {
+            return NULL;
+        }
+    }
+
+    if (ecs_meta_pop(cur) != 0) {
+        return NULL;
+    }
+
+    return ptr;
+}
+
+static
+const uint8_t* flecs_cbor_parse_members(
+    ecs_meta_cursor_t *cur,
+    const uint8_t *ptr,
+    const uint8_t *end,
+    uint64_t count,
+    bool indefinite)
+{
+    if (ecs_meta_push(cur) != 0) {
+        return NULL;
+    }
+
+    if (ecs_meta_is_collection(cur)) {
+        ecs_err("cbor: unexpected map for collection type");
+        return NULL;
+    }
+
+    uint64_t i;
+    for (i = 0; indefinite || i < count; i ++) {
+        if (indefinite && flecs_cbor_is_break(ptr, end)) {
+            ptr ++;
+            break;
+        }
+
+        ecs_cbor_major_t major;
+        uint64_t len;
+        bool key_indefinite;
+        if (flecs_cbor_read_head(&ptr, end, &major, &len, &key_indefinite)) {
+            return NULL;
+        }
+
+        if (major != EcsCborText || key_indefinite) {
+            ecs_err("cbor: expected text string for member name");
+            return NULL;
+        }
+
+        char token[ECS_MAX_TOKEN_SIZE], *name;
+        if (!(ptr = flecs_cbor_parse_text(ptr, end, len, token, &name))) {
+            return NULL;
+        }
+
+        int result = ecs_meta_member(cur, name);
+        if (name != token) {
+            ecs_os_free(name);
+        }
+
+        if (result != 0) {
+            return NULL;
+        }
+
+        if (!(ptr = flecs_cbor_parse_value(cur, ptr, end))) {
+            return NULL;
+        }
+    }
+
+    if (ecs_meta_pop(cur) != 0) {
+        return NULL;
+    }
+
+    return ptr;
+}
+
+static
+const uint8_t* flecs_cbor_parse_value(
+    ecs_meta_cursor_t *cur,
+    const uint8_t *ptr,
+    const uint8_t *end)
+{
+    ecs_cbor_major_t major;
+    uint64_t value;
+    bool indefinite;
+
+    if (ptr >= end) {
+        ecs_err("cbor: unexpected end of data");
+        return NULL;
+    }
+
+    uint8_t initial = ptr[0];
+    if (flecs_cbor_read_head(&ptr, end, &major, &value, &indefinite)) {
+        ecs_err("cbor: invalid item header");
+        return NULL;
+    }
+
+    int result = 0;
+    switch(major) {
+    case EcsCborUint:
+        result = ecs_meta_set_uint(cur, value);
+        break;
+    case EcsCborNegInt:
+        result = ecs_meta_set_int(cur, -1 - (int64_t)value);
+        break;
+    case EcsCborText: {
+        if (indefinite) {
+            ecs_err("cbor: indefinite length strings are not supported");
+            return NULL;
+        }
+
+        char token[ECS_MAX_TOKEN_SIZE], *str;
+        if (!(ptr = flecs_cbor_parse_text(ptr, end, value, token, &str))) {
+            return NULL;
+        }
+
+        result = ecs_meta_set_string(cur, str);
+        if (str != token) {
+            ecs_os_free(str);
+        }
+        break;
+    }
+    case EcsCborArray:
+        return flecs_cbor_parse_elements(cur, ptr, end, value, indefinite);
+    case EcsCborMap:
+        return flecs_cbor_parse_members(cur, ptr, end, value, indefinite);
+    case EcsCborSimple:
+        if (initial == FLECS_CBOR_FALSE) {
+            result = ecs_meta_set_bool(cur, false);
+        } else if (initial == FLECS_CBOR_TRUE) {
+            result = ecs_meta_set_bool(cur, true);
+        } else if (initial == FLECS_CBOR_NULL) {
+            result = ecs_meta_set_null(cur);
+        } else if (initial == FLECS_CBOR_FLOAT32 ||
+            initial == FLECS_CBOR_FLOAT64)
+        {
+            result = ecs_meta_set_float(cur,
+                flecs_cbor_to_float(initial, value));
+        } else {
+            ecs_err("cbor: unsupported simple value %u", initial);
+            return NULL;
+        }
+        break;
+    case EcsCborBytes:
+    case EcsCborTag:
+    default:
+        ecs_err("cbor: unexpected item of major type %d", major);
+        return NULL;
+    }
+
+    if (result != 0) {
+        return NULL;
+    }
+
+    return ptr;
+}
+
+/* Copy typed array into values, swap bytes if data has different endianness */
+static
+const uint8_t* flecs_cbor_parse_typed_array(
+    const ecs_world_t *world,
+    const uint8_t *ptr,
+    const uint8_t *end,
+    ecs_entity_t type,
+    uint64_t tag,
+    void *data_out,
+    int32_t count)
+{
+    const EcsComponent *comp = ecs_get(world, type, EcsComponent);
+    const EcsMetaTypeSerialized *ser = ecs_get(
+        world, type, EcsMetaTypeSerialized);
+    ecs_assert(comp != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(ser != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    uint64_t type_tag = flecs_cbor_packed_tag(
+        ecs_vector_first(ser->ops, ecs_meta_type_op_t),
+        ecs_vector_count(ser->ops), comp->size);
+
+    /* Endianness bit is the only one that's allowed to differ */
+    if (!type_tag || (type_tag | 4) != (tag | 4)) {
+        char *path = ecs_get_fullpath(world, type);
+        ecs_err("cbor: typed array %u does not match type '%s'",
+            (uint32_t)tag, path);
+        ecs_os_free(path);
+        return NULL;
+    }
+
+    ecs_cbor_major_t major;
+    uint64_t len;
+    bool indefinite;
+    if (flecs_cbor_read_head(&ptr, end, &major, &len, &indefinite)) {
+        return NULL;
+    }
+
+    ecs_size_t size = comp->size * count;
+    if (major != EcsCborBytes || indefinite || len != (uint64_t)size ||
+        (uint64_t)(end - ptr) < len)
+    {
+        ecs_err("cbor: invalid size for typed array");
+        return NULL;
+    }
+
+    ecs_os_memcpy(data_out, ptr, size);
+
+    if (type_tag != tag) {
+        int32_t elem_size = 1 << (tag & 3);
+        if (tag & 16) {
+            elem_size *= 2; /* Float sizes start at 16 bits */
+        }
+
+        uint8_t *bytes = data_out;
+        int32_t i, j;
+        for (i = 0; i < size; i += elem_size) {
+            for (j = 0; j < elem_size / 2; j ++) {
+                uint8_t tmp = bytes[i + j];
+                bytes[i + j] = bytes[i + elem_size - j - 1];
+                bytes[i + elem_size - j - 1] = tmp;
+            }
+        }
+    }
+
+    return ptr + len;
+}
+
+const void* ecs_parse_cbor(
+    const ecs_world_t *world,
+    const void *data,
+    ecs_size_t size,
+    ecs_entity_t type,
+    void *data_out,
+    int32_t count)
+{
+    const uint8_t *ptr = data;
+    const uint8_t *end = ptr + size;
+
+    if (!count) {
+        ecs_meta_cursor_t cur = ecs_meta_cursor(world, type, data_out);
+        if (cur.valid == false) {
+            return NULL;
+        }
+        return flecs_cbor_parse_value(&cur, ptr, end);
+    }
+
+    const EcsComponent *comp = ecs_get(world, type, EcsComponent);
+    if (!comp) {
+        return NULL;
+    }
+
+    ecs_cbor_major_t major;
+    uint64_t value;
+    bool indefinite;
+    if (flecs_cbor_read_head(&ptr, end, &major, &value, &indefinite)) {
+        ecs_err("cbor: invalid item header");
+        return NULL;
+    }
+
+    if (major == EcsCborTag) {
+        return flecs_cbor_parse_typed_array(
+            world, ptr, end, type, value, data_out, count);
+    }
+
+    if (major != EcsCborArray) {
+        ecs_err("cbor: expected array or typed array");
+        return NULL;
+    }
+
+    if (!indefinite && value != (uint64_t)count) {
+        ecs_err("cbor: array does not have %d elements", count);
+        return NULL;
+    }
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_meta_cursor_t cur = ecs_meta_cursor(
+            world, type, ECS_ELEM(data_out, comp->size, i));
+        if (cur.valid == false) {
+            return NULL;
+        }
+
+        if (!(ptr = flecs_cbor_parse_value(&cur, ptr, end))) {
+            return NULL;
+        }
+    }
+
+    if (indefinite) {
+        if (!flecs_cbor_is_break(ptr, end)) {
+            ecs_err("cbor: array does not have %d elements", count);
+            return NULL;
+        }
+        ptr ++;
+    }
+
+    return ptr;
+}
+
+#endif
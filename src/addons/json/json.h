@@ -2,6 +2,12 @@
 
 #ifdef FLECS_JSON
 
+/* Size of local buffer used by serializer programs */
+#define FLECS_JSON_PROGRAM_BUFFER_SIZE (256)
+
+/* Max number of characters written for a single value by serializer programs */
+#define FLECS_JSON_MAX_VALUE_SIZE (64)
+
 void flecs_json_next(
     ecs_strbuf_t *buf);
 
@@ -70,4 +76,158 @@ void flecs_json_id(
 ecs_primitive_kind_t flecs_json_op_to_primitive_kind(
     ecs_meta_type_op_kind_t kind);
 
+bool flecs_json_skip_variable(
+    const char *name);
+
+bool flecs_json_skip_id(
+    const ecs_world_t *world,
+    ecs_id_t id,
+    const ecs_entity_to_json_desc_t *desc,
+    ecs_entity_t ent,
+    ecs_entity_t inst,
+    ecs_entity_t *pred_out,
+    ecs_entity_t *obj_out,
+    ecs_entity_t *role_out,
+    bool *hidden_out);
+
+/* CBOR major types */
+typedef enum ecs_cbor_major_t {
+    EcsCborUint = 0,
+    EcsCborNegInt = 1,
+    EcsCborBytes = 2,
+    EcsCborText = 3,
+    EcsCborArray = 4,
+    EcsCborMap = 5,
+    EcsCborTag = 6,
+    EcsCborSimple = 7
+} ecs_cbor_major_t;
+
+/* Additional information values of the initial byte */
+#define FLECS_CBOR_UINT8 (24)
+#define FLECS_CBOR_UINT16 (25)
+#define FLECS_CBOR_UINT32 (26)
+#define FLECS_CBOR_UINT64 (27)
+#define FLECS_CBOR_INDEFINITE (31)
+
+/* Simple values & floats (major type 7) */
+#define FLECS_CBOR_FALSE (0xf4)
+#define FLECS_CBOR_TRUE (0xf5)
+#define FLECS_CBOR_NULL (0xf6)
+#define FLECS_CBOR_FLOAT32 (0xfa)
+#define FLECS_CBOR_FLOAT64 (0xfb)
+#define FLECS_CBOR_BREAK (0xff)
+
+void flecs_cbor_head(
+    ecs_strbuf_t *buf,
+    uint8_t major,
+    uint64_t value);
+
+void flecs_cbor_uint(
+    ecs_strbuf_t *buf,
+    uint64_t value);
+
+void flecs_cbor_int(
+    ecs_strbuf_t *buf,
+    int64_t value);
+
+void flecs_cbor_float32(
+    ecs_strbuf_t *buf,
+    float value);
+
+void flecs_cbor_float64(
+    ecs_strbuf_t *buf,
+    double value);
+
+void flecs_cbor_bool(
+    ecs_strbuf_t *buf,
+    bool value);
+
+void flecs_cbor_null(
+    ecs_strbuf_t *buf);
+
+void flecs_cbor_array(
+    ecs_strbuf_t *buf,
+    int32_t count);
+
+void flecs_cbor_array_push(
+    ecs_strbuf_t *buf);
+
+void flecs_cbor_array_pop(
+    ecs_strbuf_t *buf);
+
+void flecs_cbor_object_push(
+    ecs_strbuf_t *buf);
+
+void flecs_cbor_object_pop(
+    ecs_strbuf_t *buf);
+
+void flecs_cbor_string(
+    ecs_strbuf_t *buf,
+    const char *value);
+
+void flecs_cbor_stringn(
+    ecs_strbuf_t *buf,
+    const char *value,
+    int32_t len);
+
+#define flecs_cbor_stringl(buf, value)\
+    flecs_cbor_stringn(buf, value, sizeof(value) - 1)
+
+/* Append contents of str as text string, resets str */
+void flecs_cbor_strbuf(
+    ecs_strbuf_t *buf,
+    ecs_strbuf_t *str);
+
+void flecs_cbor_path(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_entity_t e);
+
+void flecs_cbor_label(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_entity_t e);
+
+void flecs_cbor_color(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_entity_t e);
+
+void flecs_cbor_id(
+    ecs_strbuf_t *buf,
+    const ecs_world_t *world,
+    ecs_id_t id);
+
+void flecs_cbor_typed_array(
+    ecs_strbuf_t *buf,
+    uint64_t tag,
+    const void *data,
+    ecs_size_t size);
+
+/* Returns typed array tag for primitive kind, or 0 if kind can't be packed */
+uint64_t flecs_cbor_typed_array_tag(
+    ecs_meta_type_op_kind_t kind);
+
+/* Returns typed array tag for a type if values of the type can be written as a
+ * single typed array, or 0 if the type can't be packed. */
+uint64_t flecs_cbor_packed_tag(
+    const ecs_meta_type_op_t *ops,
+    int32_t op_count,
+    ecs_size_t size);
+
+int flecs_cbor_read_head(
+    const uint8_t **ptr,
+    const uint8_t *end,
+    ecs_cbor_major_t *major_out,
+    uint64_t *value_out,
+    bool *indefinite_out);
+
+bool flecs_cbor_is_break(
+    const uint8_t *ptr,
+    const uint8_t *end);
+
+double flecs_cbor_to_float(
+    uint8_t initial,
+    uint64_t value);
+
 #endif
@@ -6,7 +6,7 @@
 static
 int json_ser_type(
     const ecs_world_t *world,
-    ecs_vector_t *ser, 
+    const EcsMetaTypeSerialized *ser,
     const void *base, 
     ecs_strbuf_t *str);
 
@@ -145,6 +145,23 @@ int json_ser_type_elements(
     const EcsComponent *comp = ecs_get(world, type, EcsComponent);
     ecs_assert(comp != NULL, ECS_INTERNAL_ERROR, NULL);
 
+    if (ser->json_ops) {
+        flecs_json_array_push(str);
+
+        const void *ptr = base;
+        int32_t i;
+        for (i = 0; i < elem_count; i ++) {
+            ecs_strbuf_list_next(str);
+            if (json_ser_type(world, ser, ptr, str)) {
+                return -1;
+            }
+            ptr = ECS_OFFSET(ptr, comp->size);
+        }
+
+        flecs_json_array_pop(str);
+        return 0;
+    }
+
     ecs_meta_type_op_t *ops = ecs_vector_first(ser->ops, ecs_meta_type_op_t);
     int32_t op_count = ecs_vector_count(ser->ops);
 
@@ -317,16 +334,129 @@ error:
     return -1;
 }
 
+/* Run the flattened serializer program of a type. Values are formatted into a
+ * local buffer after the literal that precedes them, so that most values only
+ * require a single append to the output buffer. */
+static
+int json_ser_program(
+    const ecs_world_t *world,
+    const EcsMetaTypeSerialized *ser,
+    const void *base, 
+    ecs_strbuf_t *str) 
+{
+    ecs_meta_json_op_t *ops = ecs_vector_first(
+        ser->json_ops, ecs_meta_json_op_t);
+    int32_t i, count = ecs_vector_count(ser->json_ops);
+    const char *literals = ser->json_literals;
+    char buf[FLECS_JSON_PROGRAM_BUFFER_SIZE];
+    int32_t len = 0;
+
+    for (i = 0; i < count; i ++) {
+        ecs_meta_json_op_t *op = &ops[i];
+        const char *literal = &literals[op->literal];
+        int32_t literal_len = op->literal_len;
+
+        /* Make sure literal & largest formatted value fit in buffer */
+        if ((len + literal_len + FLECS_JSON_MAX_VALUE_SIZE) > ECS_SIZEOF(buf)) {
+            ecs_strbuf_appendstrn(str, buf, len);
+            len = 0;
+            if ((literal_len + FLECS_JSON_MAX_VALUE_SIZE) > ECS_SIZEOF(buf)) {
+                ecs_strbuf_appendstrn(str, literal, literal_len);
+                literal_len = 0;
+            }
+        }
+
+        ecs_os_memcpy(&buf[len], literal, literal_len);
+        len += literal_len;
+
+        const void *ptr = ECS_OFFSET(base, op->offset);
+        char *cur = &buf[len];
+
+        switch(op->kind) {
+        case EcsOpPop:
+            /* Last op, only contains trailing literal */
+            break;
+        case EcsOpBool:
+            if (*(bool*)ptr) {
+                ecs_os_memcpy(cur, "true", 4);
+                cur += 4;
+            } else {
+                ecs_os_memcpy(cur, "false", 5);
+                cur += 5;
+            }
+            break;
+        case EcsOpByte:
+        case EcsOpU8:
+            cur = flecs_itoa(cur, flecs_uto(int64_t, *(uint8_t*)ptr));
+            break;
+        case EcsOpU16:
+            cur = flecs_itoa(cur, flecs_uto(int64_t, *(uint16_t*)ptr));
+            break;
+        case EcsOpU32:
+            cur = flecs_itoa(cur, flecs_uto(int64_t, *(uint32_t*)ptr));
+            break;
+        case EcsOpI8:
+            cur = flecs_itoa(cur, flecs_ito(int64_t, *(int8_t*)ptr));
+            break;
+        case EcsOpI16:
+            cur = flecs_itoa(cur, flecs_ito(int64_t, *(int16_t*)ptr));
+            break;
+        case EcsOpI32:
+            cur = flecs_itoa(cur, flecs_ito(int64_t, *(int32_t*)ptr));
+            break;
+        case EcsOpI64:
+            cur = flecs_itoa(cur, *(int64_t*)ptr);
+            break;
+        case EcsOpIPtr:
+            cur = flecs_itoa(cur, flecs_ito(int64_t, *(intptr_t*)ptr));
+            break;
+        case EcsOpF32:
+            cur = flecs_ftoa(cur, (ecs_f64_t)*(ecs_f32_t*)ptr, 10, '"');
+            break;
+        case EcsOpF64:
+            cur = flecs_ftoa(cur, *(ecs_f64_t*)ptr, 10, '"');
+            break;
+        case EcsOpU64:
+            if (*(uint64_t*)ptr <= INT64_MAX) {
+                cur = flecs_itoa(cur, (int64_t)*(uint64_t*)ptr);
+                break;
+            }
+            /* fall through */
+        default: {
+            /* Values that require escaping or lookups use the regular
+             * serializer, which appends directly to the output buffer */
+            ecs_strbuf_appendstrn(str, buf, len);
+            cur = buf;
+            ecs_meta_type_op_t value_op = { .kind = op->kind };
+            if (json_ser_type_op(world, &value_op, ptr, str)) {
+                return -1;
+            }
+            break;
+        }
+        }
+
+        len = (int32_t)(cur - buf);
+    }
+
+    ecs_strbuf_appendstrn(str, buf, len);
+
+    return 0;
+}
+
 /* Iterate over the type ops of a type */
 static
 int json_ser_type(
     const ecs_world_t *world,
-    ecs_vector_t *v_ops,
+    const EcsMetaTypeSerialized *ser,
     const void *base, 
     ecs_strbuf_t *str) 
 {
-    ecs_meta_type_op_t *ops = ecs_vector_first(v_ops, ecs_meta_type_op_t);
-    int32_t count = ecs_vector_count(v_ops);
+    if (ser->json_ops) {
+        return json_ser_program(world, ser, base, str);
+    }
+
+    ecs_meta_type_op_t *ops = ecs_vector_first(ser->ops, ecs_meta_type_op_t);
+    int32_t count = ecs_vector_count(ser->ops);
     return json_ser_type_ops(world, ops, count, base, str, 0);
 }
 
@@ -346,7 +476,7 @@ int array_to_json_buf_w_type_data(
 
         do {
             ecs_strbuf_list_next(buf);
-            if (json_ser_type(world, ser->ops, ptr, buf)) {
+            if (json_ser_type(world, ser, ptr, buf)) {
                 return -1;
             }
 
@@ -355,7 +485,7 @@ int array_to_json_buf_w_type_data(
 
         flecs_json_array_pop(buf);
     } else {
-        if (json_ser_type(world, ser->ops, ptr, buf)) {
+        if (json_ser_type(world, ser, ptr, buf)) {
             return -1;
         }
     }
@@ -423,8 +553,7 @@ char* ecs_ptr_to_json(
     return ecs_array_to_json(world, type, ptr, 0);
 }
 
-static
-bool skip_id(
+bool flecs_json_skip_id(
     const ecs_world_t *world,
     ecs_id_t id,
     const ecs_entity_to_json_desc_t *desc,
@@ -513,7 +642,7 @@ int flecs_json_append_type_labels(
     int32_t i;
     for (i = 0; i < count; i ++) {
         ecs_entity_t pred = 0, obj = 0, role = 0;
-        if (skip_id(world, ids[i], desc, ent, inst, &pred, &obj, &role, 0)) {
+        if (flecs_json_skip_id(world, ids[i], desc, ent, inst, &pred, &obj, &role, 0)) {
             continue;
         }
 
@@ -570,7 +699,7 @@ int flecs_json_append_type_values(
         bool hidden;
         ecs_entity_t pred = 0, obj = 0, role = 0;
         ecs_id_t id = ids[i];
-        if (skip_id(world, id, desc, ent, inst, &pred, &obj, &role, 
+        if (flecs_json_skip_id(world, id, desc, ent, inst, &pred, &obj, &role, 
             &hidden)) 
         {
             continue;
@@ -587,7 +716,7 @@ int flecs_json_append_type_values(
                     ecs_assert(ptr != NULL, ECS_INTERNAL_ERROR, NULL);
 
                     flecs_json_next(buf);
-                    if (json_ser_type(world, ser->ops, ptr, buf) != 0) {
+                    if (json_ser_type(world, ser, ptr, buf) != 0) {
                         /* Entity contains invalid value */
                         return -1;
                     }
@@ -633,7 +762,7 @@ int flecs_json_append_type_info(
         bool hidden;
         ecs_entity_t pred = 0, obj = 0, role = 0;
         ecs_id_t id = ids[i];
-        if (skip_id(world, id, desc, ent, inst, &pred, &obj, &role, 
+        if (flecs_json_skip_id(world, id, desc, ent, inst, &pred, &obj, &role, 
             &hidden)) 
         {
             continue;
@@ -689,7 +818,7 @@ int flecs_json_append_type_hidden(
         bool hidden;
         ecs_entity_t pred = 0, obj = 0, role = 0;
         ecs_id_t id = ids[i];
-        if (skip_id(world, id, desc, ent, inst, &pred, &obj, &role, 
+        if (flecs_json_skip_id(world, id, desc, ent, inst, &pred, &obj, &role, 
             &hidden)) 
         {
             continue;
@@ -727,7 +856,7 @@ int flecs_json_append_type(
 
     for (i = 0; i < count; i ++) {
         ecs_entity_t pred = 0, obj = 0, role = 0;
-        if (skip_id(world, ids[i], desc, ent, inst, &pred, &obj, &role, 0)) {
+        if (flecs_json_skip_id(world, ids[i], desc, ent, inst, &pred, &obj, &role, 0)) {
             continue;
         }
 
@@ -933,7 +1062,6 @@ char* ecs_entity_to_json(
     return ecs_strbuf_get(&buf);
 }
 
-static
 bool flecs_json_skip_variable(
     const char *name)
 {
@@ -1417,6 +1545,179 @@ void flecs_json_serialize_iter_result(
     flecs_json_object_pop(buf);
 }
 
+/* Copy of an iterator result that stays valid after the iterator advances */
+typedef struct ecs_json_iter_result_t {
+    ecs_iter_t it;
+    int32_t weight;
+} ecs_json_iter_result_t;
+
+/* Contiguous range of results serialized by a single thread */
+typedef struct ecs_json_iter_job_t {
+    const ecs_world_t *world;
+    const ecs_iter_to_json_desc_t *desc;
+    ecs_json_iter_result_t **results;
+    int32_t start;
+    int32_t end;
+    ecs_strbuf_t buf;
+} ecs_json_iter_job_t;
+
+static
+ecs_size_t flecs_json_iter_array_size(
+    ecs_size_t elem_size,
+    int32_t count)
+{
+    return (elem_size * count + 7) & ~7;
+}
+
+#define flecs_json_copy_array(dst, ptr, src, count)\
+    if (src) {\
+        ecs_os_memcpy(ptr, src, ECS_SIZEOF(*(src)) * (count));\
+        (dst) = (void*)(ptr);\
+        (ptr) = ECS_OFFSET(ptr,\
+            flecs_json_iter_array_size(ECS_SIZEOF(*(src)), count));\
+    }
+
+/* Copy the arrays of the current result that the iterator may overwrite when
+ * it moves to the next result. Component data and names point to storage that
+ * isn't modified while serializing, and are not copied. */
+static
+ecs_json_iter_result_t* flecs_json_iter_result_copy(
+    const ecs_iter_t *it)
+{
+    int32_t field_count = it->field_count;
+    int32_t count = it->entities ? it->count : 0;
+    int32_t var_count = it->variables ? it->variable_count : 0;
+
+    ecs_size_t size = 
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_json_iter_result_t), 1) +
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_id_t), field_count) +
+        flecs_json_iter_array_size(ECS_SIZEOF(int32_t), field_count) +
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_entity_t), field_count) +
+        flecs_json_iter_array_size(ECS_SIZEOF(void*), field_count) +
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_ref_t), field_count) +
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_entity_t), count) +
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_var_t), var_count);
+
+    ecs_json_iter_result_t *result = ecs_os_malloc(size);
+    result->it = *it;
+    result->weight = it->count + 1;
+
+    ecs_iter_t *dst = &result->it;
+    void *ptr = ECS_OFFSET(result, 
+        flecs_json_iter_array_size(ECS_SIZEOF(ecs_json_iter_result_t), 1));
+    flecs_json_copy_array(dst->ids, ptr, it->ids, field_count);
+    flecs_json_copy_array(dst->columns, ptr, it->columns, field_count);
+    flecs_json_copy_array(dst->sources, ptr, it->sources, field_count);
+    flecs_json_copy_array(dst->ptrs, ptr, it->ptrs, field_count);
+    flecs_json_copy_array(dst->references, ptr, it->references, field_count);
+    flecs_json_copy_array(dst->entities, ptr, it->entities, count);
+    flecs_json_copy_array(dst->variables, ptr, it->variables, var_count);
+
+    return result;
+}
+
+static
+void* flecs_json_iter_job(
+    void *arg)
+{
+    ecs_json_iter_job_t *job = arg;
+
+    /* Start a list, so that results are separated like in the output */
+    ecs_strbuf_list_push(&job->buf, "", ", ");
+
+    int32_t i;
+    for (i = job->start; i < job->end; i ++) {
+        flecs_json_serialize_iter_result(
+            job->world, &job->results[i]->it, &job->buf, job->desc);
+    }
+
+    ecs_strbuf_list_pop(&job->buf, "");
+    return NULL;
+}
+
+/* Collect results from the iterator, then serialize ranges of results with
+ * roughly the same number of entities on separate threads. Each thread writes
+ * to its own buffer, which are concatenated in order. */
+static
+void flecs_json_serialize_iter_results_parallel(
+    const ecs_world_t *world,
+    ecs_iter_t *it,
+    ecs_strbuf_t *buf,
+    const ecs_iter_to_json_desc_t *desc)
+{
+    ecs_vector_t *results = NULL;
+    int64_t total = 0;
+
+    ecs_iter_next_action_t next = it->next;
+    while (next(it)) {
+        ecs_json_iter_result_t **elem = ecs_vector_add(
+            &results, ecs_json_iter_result_t*);
+        *elem = flecs_json_iter_result_copy(it);
+        total += (*elem)->weight;
+    }
+
+    int32_t i, result_count = ecs_vector_count(results);
+    ecs_json_iter_result_t **ptrs = ecs_vector_first(
+        results, ecs_json_iter_result_t*);
+
+    int32_t job_count = desc->threads;
+    if (job_count > result_count) {
+        job_count = result_count;
+    }
+    if (!job_count) {
+        ecs_vector_free(results);
+        return;
+    }
+
+    ecs_json_iter_job_t *jobs = ecs_os_calloc_n(ecs_json_iter_job_t, 
+        job_count);
+    ecs_os_thread_t *threads = ecs_os_calloc_n(ecs_os_thread_t, job_count);
+
+    int32_t job = 0;
+    int64_t weight = 0;
+    for (i = 0; i < job_count; i ++) {
+        jobs[i].world = world;
+        jobs[i].desc = desc;
+        jobs[i].results = ptrs;
+    }
+
+    for (i = 0; i < result_count; i ++) {
+        weight += ptrs[i]->weight;
+        jobs[job].end = i + 1;
+        if (job < (job_count - 1) && 
+            weight >= total * (job + 1) / job_count) 
+        {
+            job ++;
+            jobs[job].start = i + 1;
+            jobs[job].end = i + 1;
+        }
+    }
+
+    /* Last job runs on the calling thread */
+    for (i = 0; i < (job_count - 1); i ++) {
+        threads[i] = ecs_os_thread_new(flecs_json_iter_job, &jobs[i]);
+    }
+    flecs_json_iter_job(&jobs[job_count - 1]);
+
+    for (i = 0; i < job_count; i ++) {
+        if (i < (job_count - 1)) {
+            ecs_os_thread_join(threads[i]);
+        }
+        if (ecs_strbuf_written(&jobs[i].buf)) {
+            ecs_strbuf_list_next(buf);
+            ecs_strbuf_mergebuff(buf, &jobs[i].buf);
+        }
+    }
+
+    for (i = 0; i < result_count; i ++) {
+        ecs_os_free(ptrs[i]);
+    }
+
+    ecs_os_free(threads);
+    ecs_os_free(jobs);
+    ecs_vector_free(results);
+}
+
 int ecs_iter_to_json_buf(
     const ecs_world_t *world,
     ecs_iter_t *it,
@@ -1450,9 +1751,13 @@ int ecs_iter_to_json_buf(
     /* Use instancing for improved performance */
     ECS_BIT_SET(it->flags, EcsIterIsInstanced);
 
-    ecs_iter_next_action_t next = it->next;
-    while (next(it)) {
-        flecs_json_serialize_iter_result(world, it, buf, desc);
+    if (desc && desc->threads > 1 && ecs_os_has_threading()) {
+        flecs_json_serialize_iter_results_parallel(world, it, buf, desc);
+    } else {
+        ecs_iter_next_action_t next = it->next;
+        while (next(it)) {
+            flecs_json_serialize_iter_result(world, it, buf, desc);
+        }
     }
 
     flecs_json_array_pop(buf);
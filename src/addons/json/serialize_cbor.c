@@ -0,0 +1,1041 @@
+/**
+ * @file addons/json/serialize_cbor.c
+ * @brief Serialize values, entities and iterators to CBOR.
+ *
+ * The output has the same structure as the JSON serializer. Columns of types
+ * that consist of a single primitive type without padding are written as a
+ * typed array, which lets a serializer copy the component data as is.
+ */
+
+#include "json.h"
+
+#ifdef FLECS_JSON
+
+static
+int flecs_cbor_ser_type_ops(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *ops,
+    int32_t op_count,
+    const void *base,
+    ecs_strbuf_t *buf,
+    int32_t in_array);
+
+/* Serialize enumeration */
+static
+int flecs_cbor_ser_enum(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *op,
+    const void *base,
+    ecs_strbuf_t *buf)
+{
+    const EcsEnum *enum_type = ecs_get(world, op->type, EcsEnum);
+    ecs_check(enum_type != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    int32_t value = *(int32_t*)base;
+    ecs_enum_constant_t *constant = ecs_map_get(
+        enum_type->constants, ecs_enum_constant_t, value);
+    if (!constant) {
+        goto error;
+    }
+
+    flecs_cbor_string(buf, ecs_get_name(world, constant->constant));
+    return 0;
+error:
+    return -1;
+}
+
+/* Serialize bitmask */
+static
+int flecs_cbor_ser_bitmask(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *op,
+    const void *ptr,
+    ecs_strbuf_t *buf)
+{
+    const EcsBitmask *bitmask_type = ecs_get(world, op->type, EcsBitmask);
+    ecs_check(bitmask_type != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    uint32_t value = *(uint32_t*)ptr;
+    if (!value) {
+        flecs_cbor_uint(buf, 0);
+        return 0;
+    }
+
+    ecs_strbuf_t str = ECS_STRBUF_INIT;
+    ecs_map_key_t key;
+    ecs_bitmask_constant_t *constant;
+    ecs_map_iter_t it = ecs_map_iter(bitmask_type->constants);
+    while ((constant = ecs_map_next(&it, ecs_bitmask_constant_t, &key))) {
+        if ((value & key) == key) {
+            if (ecs_strbuf_written(&str)) {
+                ecs_strbuf_appendch(&str, '|');
+            }
+            ecs_strbuf_appendstr(&str, ecs_get_name(world, constant->constant));
+            value -= (uint32_t)key;
+        }
+    }
+
+    if (value != 0) {
+        /* All bits must have been matched by a constant */
+        ecs_strbuf_reset(&str);
+        goto error;
+    }
+
+    flecs_cbor_strbuf(buf, &str);
+    return 0;
+error:
+    return -1;
+}
+
+/* Serialize elements of a contiguous array */
+static
+int flecs_cbor_ser_elements(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *ops,
+    int32_t op_count,
+    const void *base,
+    int32_t elem_count,
+    int32_t elem_size,
+    ecs_strbuf_t *buf)
+{
+    flecs_cbor_array(buf, elem_count);
+
+    const void *ptr = base;
+
+    int i;
+    for (i = 0; i < elem_count; i ++) {
+        if (flecs_cbor_ser_type_ops(world, ops, op_count, ptr, buf, 1)) {
+            return -1;
+        }
+        ptr = ECS_OFFSET(ptr, elem_size);
+    }
+
+    return 0;
+}
+
+static
+int flecs_cbor_ser_type_elements(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const void *base,
+    int32_t elem_count,
+    ecs_strbuf_t *buf)
+{
+    const EcsMetaTypeSerialized *ser = ecs_get(
+        world, type, EcsMetaTypeSerialized);
+    ecs_assert(ser != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    const EcsComponent *comp = ecs_get(world, type, EcsComponent);
+    ecs_assert(comp != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_meta_type_op_t *ops = ecs_vector_first(ser->ops, ecs_meta_type_op_t);
+    int32_t op_count = ecs_vector_count(ser->ops);
+
+    return flecs_cbor_ser_elements(
+        world, ops, op_count, base, elem_count, comp->size, buf);
+}
+
+/* Serialize array */
+static
+int flecs_cbor_ser_array(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *op,
+    const void *ptr,
+    ecs_strbuf_t *buf)
+{
+    const EcsArray *a = ecs_get(world, op->type, EcsArray);
+    ecs_assert(a != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    return flecs_cbor_ser_type_elements(
+        world, a->type, ptr, a->count, buf);
+}
+
+/* Serialize vector */
+static
+int flecs_cbor_ser_vector(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *op,
+    const void *base,
+    ecs_strbuf_t *buf)
+{
+    ecs_vector_t *value = *(ecs_vector_t**)base;
+    if (!value) {
+        flecs_cbor_null(buf);
+        return 0;
+    }
+
+    const EcsVector *v = ecs_get(world, op->type, EcsVector);
+    ecs_assert(v != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    const EcsComponent *comp = ecs_get(world, v->type, EcsComponent);
+    ecs_assert(comp != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t count = ecs_vector_count(value);
+    void *array = ecs_vector_first_t(value, comp->size, comp->alignment);
+
+    /* Serialize contiguous buffer of vector */
+    return flecs_cbor_ser_type_elements(world, v->type, array, count, buf);
+}
+
+/* Forward serialization to the different type kinds */
+static
+int flecs_cbor_ser_type_op(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *op,
+    const void *base,
+    ecs_strbuf_t *buf)
+{
+    const void *ptr = ECS_OFFSET(base, op->offset);
+
+    switch(op->kind) {
+    case EcsOpPush:
+    case EcsOpPop:
+        /* Should not be parsed as single op */
+        ecs_throw(ECS_INVALID_PARAMETER, NULL);
+        break;
+    case EcsOpEnum:
+        return flecs_cbor_ser_enum(world, op, ptr, buf);
+    case EcsOpBitmask:
+        return flecs_cbor_ser_bitmask(world, op, ptr, buf);
+    case EcsOpArray:
+        return flecs_cbor_ser_array(world, op, ptr, buf);
+    case EcsOpVector:
+        return flecs_cbor_ser_vector(world, op, ptr, buf);
+    case EcsOpBool:
+        flecs_cbor_bool(buf, *(const ecs_bool_t*)ptr);
+        break;
+    case EcsOpChar:
+        flecs_cbor_int(buf, *(const ecs_char_t*)ptr);
+        break;
+    case EcsOpByte:
+        flecs_cbor_uint(buf, *(const ecs_byte_t*)ptr);
+        break;
+    case EcsOpU8:
+        flecs_cbor_uint(buf, *(const ecs_u8_t*)ptr);
+        break;
+    case EcsOpU16:
+        flecs_cbor_uint(buf, *(const ecs_u16_t*)ptr);
+        break;
+    case EcsOpU32:
+        flecs_cbor_uint(buf, *(const ecs_u32_t*)ptr);
+        break;
+    case EcsOpU64:
+        flecs_cbor_uint(buf, *(const ecs_u64_t*)ptr);
+        break;
+    case EcsOpUPtr:
+        flecs_cbor_uint(buf, *(const ecs_uptr_t*)ptr);
+        break;
+    case EcsOpI8:
+        flecs_cbor_int(buf, *(const ecs_i8_t*)ptr);
+        break;
+    case EcsOpI16:
+        flecs_cbor_int(buf, *(const ecs_i16_t*)ptr);
+        break;
+    case EcsOpI32:
+        flecs_cbor_int(buf, *(const ecs_i32_t*)ptr);
+        break;
+    case EcsOpI64:
+        flecs_cbor_int(buf, *(const ecs_i64_t*)ptr);
+        break;
+    case EcsOpIPtr:
+        flecs_cbor_int(buf, *(const ecs_iptr_t*)ptr);
+        break;
+    case EcsOpF32:
+        flecs_cbor_float32(buf, *(const ecs_f32_t*)ptr);
+        break;
+    case EcsOpF64:
+        flecs_cbor_float64(buf, *(const ecs_f64_t*)ptr);
+        break;
+    case EcsOpString:
+        flecs_cbor_string(buf, *(const char**)ptr);
+        break;
+    case EcsOpEntity: {
+        ecs_entity_t e = *(const ecs_entity_t*)ptr;
+        if (!e) {
+            flecs_cbor_uint(buf, 0);
+        } else {
+            flecs_cbor_path(buf, world, e);
+        }
+        break;
+    }
+    default:
+        ecs_throw(ECS_INTERNAL_ERROR, NULL);
+        break;
+    }
+
+    return 0;
+error:
+    return -1;
+}
+
+/* Iterate over a slice of the type ops array */
+static
+int flecs_cbor_ser_type_ops(
+    const ecs_world_t *world,
+    ecs_meta_type_op_t *ops,
+    int32_t op_count,
+    const void *base,
+    ecs_strbuf_t *buf,
+    int32_t in_array)
+{
+    for (int i = 0; i < op_count; i ++) {
+        ecs_meta_type_op_t *op = &ops[i];
+
+        if (in_array <= 0) {
+            if (op->name) {
+                flecs_cbor_string(buf, op->name);
+            }
+
+            int32_t elem_count = op->count;
+            if (elem_count > 1) {
+                /* Serialize inline array */
+                if (flecs_cbor_ser_elements(world, op, op->op_count, base,
+                    elem_count, op->size, buf))
+                {
+                    return -1;
+                }
+
+                i += op->op_count - 1;
+                continue;
+            }
+        }
+
+        switch(op->kind) {
+        case EcsOpPush:
+            flecs_cbor_object_push(buf);
+            in_array --;
+            break;
+        case EcsOpPop:
+            flecs_cbor_object_pop(buf);
+            in_array ++;
+            break;
+        default:
+            if (flecs_cbor_ser_type_op(world, op, base, buf)) {
+                goto error;
+            }
+            break;
+        }
+    }
+
+    return 0;
+error:
+    return -1;
+}
+
+/* Serialize value, or column of values. Columns are written as a typed array
+ * if the layout of the type allows for it. */
+static
+int flecs_cbor_ser_values(
+    const ecs_world_t *world,
+    const void *ptr,
+    int32_t count,
+    ecs_strbuf_t *buf,
+    const EcsComponent *comp,
+    const EcsMetaTypeSerialized *ser)
+{
+    ecs_meta_type_op_t *ops = ecs_vector_first(ser->ops, ecs_meta_type_op_t);
+    int32_t op_count = ecs_vector_count(ser->ops);
+
+    if (!count) {
+        return flecs_cbor_ser_type_ops(world, ops, op_count, ptr, buf, 0);
+    }
+
+    ecs_size_t size = comp->size;
+    uint64_t tag = flecs_cbor_packed_tag(ops, op_count, size);
+    if (tag) {
+        flecs_cbor_typed_array(buf, tag, ptr, size * count);
+        return 0;
+    }
+
+    flecs_cbor_array(buf, count);
+    do {
+        if (flecs_cbor_ser_type_ops(world, ops, op_count, ptr, buf, 0)) {
+            return -1;
+        }
+
+        ptr = ECS_OFFSET(ptr, size);
+    } while (-- count);
+
+    return 0;
+}
+
+int ecs_array_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const void *ptr,
+    int32_t count,
+    ecs_strbuf_t *buf)
+{
+    const EcsComponent *comp = ecs_get(world, type, EcsComponent);
+    if (!comp) {
+        char *path = ecs_get_fullpath(world, type);
+        ecs_err("cannot serialize to CBOR, '%s' is not a component", path);
+        ecs_os_free(path);
+        return -1;
+    }
+
+    const EcsMetaTypeSerialized *ser = ecs_get(
+        world, type, EcsMetaTypeSerialized);
+    if (!ser) {
+        char *path = ecs_get_fullpath(world, type);
+        ecs_err("cannot serialize to CBOR, '%s' has no reflection data", path);
+        ecs_os_free(path);
+        return -1;
+    }
+
+    return flecs_cbor_ser_values(world, ptr, count, buf, comp, ser);
+}
+
+int ecs_ptr_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const void *ptr,
+    ecs_strbuf_t *buf)
+{
+    return ecs_array_to_cbor_buf(world, type, ptr, 0, buf);
+}
+
+static
+bool flecs_cbor_union_target(
+    const ecs_world_t *world,
+    ecs_entity_t ent,
+    ecs_entity_t *pred,
+    ecs_entity_t *obj)
+{
+    if (*obj && (*pred == EcsUnion)) {
+        *pred = *obj;
+        *obj = ecs_get_target(world, ent, *pred, 0);
+        if (!ecs_is_alive(world, *obj)) {
+            /* Union relationships aren't automatically cleaned up, so they
+             * can contain invalid entity ids. */
+            return false;
+        }
+    }
+    return true;
+}
+
+static
+void flecs_cbor_append_type_labels(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    const ecs_id_t *ids,
+    int32_t count,
+    ecs_entity_t ent,
+    ecs_entity_t inst,
+    const ecs_entity_to_json_desc_t *desc)
+{
+    flecs_cbor_stringl(buf, "id_labels");
+    flecs_cbor_array_push(buf);
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t pred = 0, obj = 0, role = 0;
+        if (flecs_json_skip_id(world, ids[i], desc, ent, inst, &pred, &obj,
+            &role, 0))
+        {
+            continue;
+        }
+
+        if (!flecs_cbor_union_target(world, ent, &pred, &obj)) {
+            continue;
+        }
+
+        flecs_cbor_array(buf, 1 + (obj != 0));
+        flecs_cbor_label(buf, world, pred);
+        if (obj) {
+            flecs_cbor_label(buf, world, obj);
+        }
+    }
+
+    flecs_cbor_array_pop(buf);
+}
+
+static
+int flecs_cbor_append_type_values(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    const ecs_id_t *ids,
+    int32_t count,
+    ecs_entity_t ent,
+    ecs_entity_t inst,
+    const ecs_entity_to_json_desc_t *desc)
+{
+    flecs_cbor_stringl(buf, "values");
+    flecs_cbor_array_push(buf);
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        bool hidden;
+        ecs_entity_t pred = 0, obj = 0, role = 0;
+        ecs_id_t id = ids[i];
+        if (flecs_json_skip_id(world, id, desc, ent, inst, &pred, &obj, &role,
+            &hidden))
+        {
+            continue;
+        }
+
+        if (hidden) {
+            if (desc->serialize_hidden) {
+                flecs_cbor_uint(buf, 0);
+            }
+            continue;
+        }
+
+        const EcsComponent *comp = NULL;
+        const EcsMetaTypeSerialized *ser = NULL;
+        ecs_entity_t typeid = ecs_get_typeid(world, id);
+        if (typeid) {
+            comp = ecs_get(world, typeid, EcsComponent);
+            ser = ecs_get(world, typeid, EcsMetaTypeSerialized);
+        }
+
+        if (comp && ser) {
+            const void *ptr = ecs_get_id(world, ent, id);
+            ecs_assert(ptr != NULL, ECS_INTERNAL_ERROR, NULL);
+            if (flecs_cbor_ser_values(world, ptr, 0, buf, comp, ser)) {
+                /* Entity contains invalid value */
+                return -1;
+            }
+        } else {
+            flecs_cbor_uint(buf, 0);
+        }
+    }
+
+    flecs_cbor_array_pop(buf);
+    return 0;
+}
+
+static
+void flecs_cbor_append_type_hidden(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    const ecs_id_t *ids,
+    int32_t count,
+    ecs_entity_t ent,
+    ecs_entity_t inst,
+    const ecs_entity_to_json_desc_t *desc)
+{
+    flecs_cbor_stringl(buf, "hidden");
+    flecs_cbor_array_push(buf);
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        bool hidden;
+        ecs_entity_t pred = 0, obj = 0, role = 0;
+        if (flecs_json_skip_id(world, ids[i], desc, ent, inst, &pred, &obj,
+            &role, &hidden))
+        {
+            continue;
+        }
+
+        flecs_cbor_bool(buf, hidden);
+    }
+
+    flecs_cbor_array_pop(buf);
+}
+
+static
+int flecs_cbor_append_type(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    ecs_entity_t ent,
+    ecs_entity_t inst,
+    const ecs_entity_to_json_desc_t *desc)
+{
+    const ecs_id_t *ids = NULL;
+    int32_t i, count = 0;
+
+    const ecs_type_t *type = ecs_get_type(world, ent);
+    if (type) {
+        ids = type->array;
+        count = type->count;
+    }
+
+    flecs_cbor_stringl(buf, "ids");
+    flecs_cbor_array_push(buf);
+
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t pred = 0, obj = 0, role = 0;
+        if (flecs_json_skip_id(world, ids[i], desc, ent, inst, &pred, &obj,
+            &role, 0))
+        {
+            continue;
+        }
+
+        if (!flecs_cbor_union_target(world, ent, &pred, &obj)) {
+            continue;
+        }
+
+        flecs_cbor_array(buf, 1 + ((obj || role) != 0) + (role != 0));
+        flecs_cbor_path(buf, world, pred);
+        if (obj || role) {
+            if (obj) {
+                flecs_cbor_path(buf, world, obj);
+            } else {
+                flecs_cbor_uint(buf, 0);
+            }
+            if (role) {
+                flecs_cbor_string(buf, ecs_id_flag_str(role));
+            }
+        }
+    }
+
+    flecs_cbor_array_pop(buf);
+
+#ifdef FLECS_DOC
+    if (desc->serialize_id_labels) {
+        flecs_cbor_append_type_labels(world, buf, ids, count, ent, inst, desc);
+    }
+#endif
+
+    if (desc->serialize_values) {
+        if (flecs_cbor_append_type_values(
+            world, buf, ids, count, ent, inst, desc))
+        {
+            return -1;
+        }
+    }
+
+    if (desc->serialize_hidden && ent != inst) {
+        flecs_cbor_append_type_hidden(world, buf, ids, count, ent, inst, desc);
+    }
+
+    return 0;
+}
+
+static
+int flecs_cbor_append_base(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    ecs_entity_t ent,
+    ecs_entity_t inst,
+    const ecs_entity_to_json_desc_t *desc)
+{
+    const ecs_type_t *type = ecs_get_type(world, ent);
+    ecs_id_t *ids = NULL;
+    int32_t i, count = 0;
+    if (type) {
+        ids = type->array;
+        count = type->count;
+    }
+
+    for (i = 0; i < count; i ++) {
+        ecs_id_t id = ids[i];
+        if (ECS_HAS_RELATION(id, EcsIsA)) {
+            if (flecs_cbor_append_base(
+                world, buf, ecs_pair_second(world, id), inst, desc))
+            {
+                return -1;
+            }
+        }
+    }
+
+    flecs_cbor_object_push(buf);
+    flecs_cbor_stringl(buf, "path");
+    flecs_cbor_path(buf, world, ent);
+
+    if (flecs_cbor_append_type(world, buf, ent, inst, desc)) {
+        return -1;
+    }
+
+    flecs_cbor_object_pop(buf);
+
+    return 0;
+}
+
+int ecs_entity_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_strbuf_t *buf,
+    const ecs_entity_to_json_desc_t *desc)
+{
+    if (!entity || !ecs_is_valid(world, entity)) {
+        return -1;
+    }
+
+    ecs_entity_to_json_desc_t default_desc = ECS_ENTITY_TO_JSON_INIT;
+    if (!desc) {
+        desc = &default_desc;
+    }
+
+    flecs_cbor_object_push(buf);
+
+    if (desc->serialize_path) {
+        flecs_cbor_stringl(buf, "path");
+        ecs_strbuf_t path = ECS_STRBUF_INIT;
+        ecs_get_path_w_sep_buf(world, 0, entity, ".", NULL, &path);
+        flecs_cbor_strbuf(buf, &path);
+    }
+
+#ifdef FLECS_DOC
+    if (desc->serialize_label) {
+        flecs_cbor_stringl(buf, "label");
+        const char *doc_name = ecs_doc_get_name(world, entity);
+        if (doc_name) {
+            flecs_cbor_string(buf, doc_name);
+        } else {
+            char num_buf[20];
+            ecs_os_sprintf(num_buf, "%u", (uint32_t)entity);
+            flecs_cbor_string(buf, num_buf);
+        }
+    }
+
+    if (desc->serialize_brief) {
+        const char *doc_brief = ecs_doc_get_brief(world, entity);
+        if (doc_brief) {
+            flecs_cbor_stringl(buf, "brief");
+            flecs_cbor_string(buf, doc_brief);
+        }
+    }
+
+    if (desc->serialize_link) {
+        const char *doc_link = ecs_doc_get_link(world, entity);
+        if (doc_link) {
+            flecs_cbor_stringl(buf, "link");
+            flecs_cbor_string(buf, doc_link);
+        }
+    }
+
+    if (desc->serialize_color) {
+        const char *doc_color = ecs_doc_get_color(world, entity);
+        if (doc_color) {
+            flecs_cbor_stringl(buf, "color");
+            flecs_cbor_string(buf, doc_color);
+        }
+    }
+#endif
+
+    const ecs_type_t *type = ecs_get_type(world, entity);
+    ecs_id_t *ids = NULL;
+    int32_t i, count = 0;
+    if (type) {
+        ids = type->array;
+        count = type->count;
+    }
+
+    if (desc->serialize_base) {
+        if (ecs_has_pair(world, entity, EcsIsA, EcsWildcard)) {
+            flecs_cbor_stringl(buf, "is_a");
+            flecs_cbor_array_push(buf);
+
+            for (i = 0; i < count; i ++) {
+                ecs_id_t id = ids[i];
+                if (ECS_HAS_RELATION(id, EcsIsA)) {
+                    if (flecs_cbor_append_base(
+                        world, buf, ecs_pair_second(world, id), entity, desc))
+                    {
+                        return -1;
+                    }
+                }
+            }
+
+            flecs_cbor_array_pop(buf);
+        }
+    }
+
+    if (flecs_cbor_append_type(world, buf, entity, entity, desc)) {
+        return -1;
+    }
+
+    flecs_cbor_object_pop(buf);
+
+    return 0;
+}
+
+static
+void flecs_cbor_serialize_iter_variables(
+    ecs_iter_t *it,
+    ecs_strbuf_t *buf)
+{
+    char **variable_names = it->variable_names;
+    int32_t var_count = it->variable_count;
+    int32_t actual_count = 0;
+
+    for (int i = 0; i < var_count; i ++) {
+        const char *var_name = variable_names[i];
+        if (flecs_json_skip_variable(var_name)) continue;
+
+        if (!actual_count) {
+            flecs_cbor_stringl(buf, "vars");
+            flecs_cbor_array_push(buf);
+            actual_count ++;
+        }
+
+        flecs_cbor_string(buf, var_name);
+    }
+
+    if (actual_count) {
+        flecs_cbor_array_pop(buf);
+    }
+}
+
+static
+void flecs_cbor_serialize_iter_result_variables(
+    const ecs_world_t *world,
+    const ecs_iter_t *it,
+    ecs_strbuf_t *buf,
+    const char *member,
+    int32_t member_len,
+    char kind)
+{
+    char **variable_names = it->variable_names;
+    ecs_var_t *variables = it->variables;
+    int32_t var_count = it->variable_count;
+    int32_t actual_count = 0;
+
+    for (int i = 0; i < var_count; i ++) {
+        const char *var_name = variable_names[i];
+        if (flecs_json_skip_variable(var_name)) continue;
+
+        if (!actual_count) {
+            flecs_cbor_stringn(buf, member, member_len);
+            flecs_cbor_array_push(buf);
+            actual_count ++;
+        }
+
+        ecs_entity_t e = variables[i].entity;
+        if (kind == 'p') {
+            flecs_cbor_path(buf, world, e);
+        } else if (kind == 'l') {
+            flecs_cbor_label(buf, world, e);
+        } else {
+            flecs_cbor_uint(buf, e);
+        }
+    }
+
+    if (actual_count) {
+        flecs_cbor_array_pop(buf);
+    }
+}
+
+static
+void flecs_cbor_serialize_iter_result_entities(
+    const ecs_world_t *world,
+    const ecs_iter_t *it,
+    ecs_strbuf_t *buf,
+    const char *member,
+    int32_t member_len,
+    char kind)
+{
+    int32_t i, count = it->count;
+    if (!count) {
+        return;
+    }
+
+    flecs_cbor_stringn(buf, member, member_len);
+
+    ecs_entity_t *entities = it->entities;
+    if (kind == 'i') {
+        /* Entity ids have the same layout as an array of uint64 */
+        flecs_cbor_typed_array(buf, flecs_cbor_typed_array_tag(EcsOpU64),
+            entities, ECS_SIZEOF(ecs_entity_t) * count);
+        return;
+    }
+
+    flecs_cbor_array(buf, count);
+    for (i = 0; i < count; i ++) {
+        if (kind == 'p') {
+            flecs_cbor_path(buf, world, entities[i]);
+        } else if (kind == 'l') {
+            flecs_cbor_label(buf, world, entities[i]);
+        } else {
+            flecs_cbor_color(buf, world, entities[i]);
+        }
+    }
+}
+
+static
+void flecs_cbor_serialize_iter_result_values(
+    const ecs_world_t *world,
+    const ecs_iter_t *it,
+    ecs_strbuf_t *buf)
+{
+    flecs_cbor_stringl(buf, "values");
+
+    int32_t i, field_count = it->field_count;
+    flecs_cbor_array(buf, field_count);
+
+    for (i = 0; i < field_count; i ++) {
+        const void *ptr = NULL;
+        if (it->ptrs) {
+            ptr = it->ptrs[i];
+        }
+
+        bool is_set = ecs_field_is_set(it, i + 1);
+        if (!ptr && is_set) {
+            /* No data in column */
+            flecs_cbor_uint(buf, 0);
+            continue;
+        }
+
+        if (ecs_field_is_writeonly(it, i + 1)) {
+            flecs_cbor_uint(buf, 0);
+            continue;
+        }
+
+        const EcsComponent *comp = NULL;
+        const EcsMetaTypeSerialized *ser = NULL;
+        ecs_entity_t type = ecs_get_typeid(world, it->ids[i]);
+        if (type) {
+            comp = ecs_get(world, type, EcsComponent);
+            ser = ecs_get(world, type, EcsMetaTypeSerialized);
+        }
+
+        if (!comp || !ser) {
+            flecs_cbor_uint(buf, 0);
+            continue;
+        }
+
+        /* If term is not set, append empty array. This indicates that the term
+         * could have had data but doesn't */
+        if (!is_set) {
+            ecs_assert(ptr == NULL, ECS_INTERNAL_ERROR, NULL);
+            flecs_cbor_array(buf, 0);
+            continue;
+        }
+
+        if (ecs_field_is_self(it, i + 1)) {
+            flecs_cbor_ser_values(world, ptr, it->count, buf, comp, ser);
+        } else {
+            flecs_cbor_ser_values(world, ptr, 0, buf, comp, ser);
+        }
+    }
+}
+
+static
+void flecs_cbor_serialize_iter_result(
+    const ecs_world_t *world,
+    const ecs_iter_t *it,
+    ecs_strbuf_t *buf,
+    const ecs_iter_to_json_desc_t *desc)
+{
+    int32_t i, field_count = it->field_count;
+
+    flecs_cbor_object_push(buf);
+
+    if (desc->serialize_ids) {
+        flecs_cbor_stringl(buf, "ids");
+        flecs_cbor_array(buf, field_count);
+        for (i = 0; i < field_count; i ++) {
+            flecs_cbor_id(buf, world, ecs_field_id(it, i + 1));
+        }
+
+        flecs_cbor_stringl(buf, "sources");
+        flecs_cbor_array(buf, field_count);
+        for (i = 0; i < field_count; i ++) {
+            ecs_entity_t subj = it->sources[i];
+            if (subj) {
+                flecs_cbor_path(buf, world, subj);
+            } else {
+                flecs_cbor_uint(buf, 0);
+            }
+        }
+    }
+
+    if (desc->serialize_variables) {
+        flecs_cbor_serialize_iter_result_variables(
+            world, it, buf, "vars", 4, 'p');
+    }
+
+    if (desc->serialize_variable_labels) {
+        flecs_cbor_serialize_iter_result_variables(
+            world, it, buf, "var_labels", 10, 'l');
+    }
+
+    if (desc->serialize_variable_ids) {
+        flecs_cbor_serialize_iter_result_variables(
+            world, it, buf, "var_ids", 7, 'i');
+    }
+
+    if (desc->serialize_is_set) {
+        flecs_cbor_stringl(buf, "is_set");
+        flecs_cbor_array(buf, field_count);
+        for (i = 0; i < field_count; i ++) {
+            flecs_cbor_bool(buf, ecs_field_is_set(it, i + 1));
+        }
+    }
+
+    if (desc->serialize_entities) {
+        flecs_cbor_serialize_iter_result_entities(
+            world, it, buf, "entities", 8, 'p');
+    }
+
+    if (desc->serialize_entity_labels) {
+        flecs_cbor_serialize_iter_result_entities(
+            world, it, buf, "entity_labels", 13, 'l');
+    }
+
+    if (desc->serialize_entity_ids) {
+        flecs_cbor_serialize_iter_result_entities(
+            world, it, buf, "entity_ids", 10, 'i');
+    }
+
+    if (desc->serialize_colors) {
+        flecs_cbor_serialize_iter_result_entities(
+            world, it, buf, "colors", 6, 'c');
+    }
+
+    if (desc->serialize_values) {
+        flecs_cbor_serialize_iter_result_values(world, it, buf);
+    }
+
+    flecs_cbor_object_pop(buf);
+}
+
+int ecs_iter_to_cbor_buf(
+    const ecs_world_t *world,
+    ecs_iter_t *it,
+    ecs_strbuf_t *buf,
+    const ecs_iter_to_json_desc_t *desc)
+{
+    ecs_iter_to_json_desc_t default_desc = ECS_ITER_TO_JSON_INIT;
+    if (!desc) {
+        desc = &default_desc;
+    }
+
+    ecs_time_t duration = {0};
+    if (desc->measure_eval_duration) {
+        ecs_time_measure(&duration);
+    }
+
+    flecs_cbor_object_push(buf);
+
+    /* Serialize component ids of the terms (usually provided by query) */
+    int32_t i, field_count = it->field_count;
+    if (desc->serialize_term_ids && field_count) {
+        flecs_cbor_stringl(buf, "ids");
+        flecs_cbor_array(buf, field_count);
+        for (i = 0; i < field_count; i ++) {
+            flecs_cbor_id(buf, world, it->terms[i].id);
+        }
+    }
+
+    /* Serialize variable names, if iterator has any */
+    flecs_cbor_serialize_iter_variables(it, buf);
+
+    /* Serialize results */
+    flecs_cbor_stringl(buf, "results");
+    flecs_cbor_array_push(buf);
+
+    /* Use instancing for improved performance */
+    ECS_BIT_SET(it->flags, EcsIterIsInstanced);
+
+    ecs_iter_next_action_t next = it->next;
+    while (next(it)) {
+        flecs_cbor_serialize_iter_result(world, it, buf, desc);
+    }
+
+    flecs_cbor_array_pop(buf);
+
+    if (desc->measure_eval_duration) {
+        double dt = ecs_time_measure(&duration);
+        flecs_cbor_stringl(buf, "eval_duration");
+        flecs_cbor_float64(buf, dt);
+    }
+
+    flecs_cbor_object_pop(buf);
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,933 @@
+/**
+ * @file addons/meta/index.c
+ * @brief Secondary indices on component members.
+ *
+ * A member index maps the value of a struct member to the entities that have
+ * that value. Values are converted to unsigned 64 bit keys that preserve the
+ * ordering of the original type, which allows all scalar types to share the
+ * same index implementation.
+ *
+ * A sorted index stores (key, entity) pairs in a list of chunks. Pairs are
+ * ordered by (key, entity) within and across chunks, so that the result of a
+ * range lookup is a run of consecutive chunk slices. An insert or remove only
+ * moves elements inside a single chunk, and chunks are split when they are
+ * full and merged when they become sparse. A hash index stores an entity array
+ * per key. Both index kinds keep a map from entity to its current key, so that
+ * the old value can be removed when a component is set or removed.
+ *
+ * The index is stored as the context of an observer that listens for OnSet and
+ * UnSet events on the component, so that deleting the index entity also
+ * cleans up the index.
+ */
+
+#include "meta.h"
+
+#ifdef FLECS_META
+
+#define ECS_MEMBER_INDEX_SIGN (1ull << 63)
+
+/* Max number of elements in a chunk of a sorted index */
+#define FLECS_MEMBER_INDEX_CHUNK_SIZE (256)
+
+/* Chunks with fewer elements are merged with their neighbour */
+#define FLECS_MEMBER_INDEX_CHUNK_MIN (FLECS_MEMBER_INDEX_CHUNK_SIZE / 4)
+
+typedef struct ecs_member_index_chunk_t {
+    int32_t count;
+    uint64_t keys[FLECS_MEMBER_INDEX_CHUNK_SIZE];
+    ecs_entity_t entities[FLECS_MEMBER_INDEX_CHUNK_SIZE];
+} ecs_member_index_chunk_t;
+
+typedef struct ecs_member_index_elem_t {
+    uint64_t key;               /* Current key of entity */
+    int32_t slot;               /* Position of entity in bucket (hash only) */
+} ecs_member_index_elem_t;
+
+typedef struct ecs_member_index_t {
+    ecs_world_t *world;
+    ecs_entity_t component;
+    ecs_entity_t member;
+    ecs_member_index_kind_t kind;
+    ecs_primitive_kind_t type_kind;
+    ecs_size_t offset;
+
+    ecs_map_t elems;            /* map<entity, ecs_member_index_elem_t> */
+    ecs_map_t buckets;          /* map<key, ecs_vec_t<ecs_entity_t>> (hash) */
+    ecs_vec_t chunks;           /* vec<ecs_member_index_chunk_t*> (sorted) */
+    ecs_vec_t result;           /* vec<ecs_entity_t>, for multi-chunk lookups */
+} ecs_member_index_t;
+
+static
+uint64_t flecs_member_index_signed_key(
+    int64_t value)
+{
+    return (uint64_t)value ^ ECS_MEMBER_INDEX_SIGN;
+}
+
+static
+uint64_t flecs_member_index_float_key(
+    double value)
+{
+    if (value == 0) {
+        value = 0; /* Make sure -0 and 0 map to the same key */
+    }
+
+    uint64_t bits;
+    ecs_os_memcpy(&bits, &value, ECS_SIZEOF(double));
+    if (bits & ECS_MEMBER_INDEX_SIGN) {
+        return ~bits;
+    } else {
+        return bits | ECS_MEMBER_INDEX_SIGN;
+    }
+}
+
+/* Convert value to key with the same ordering as the value */
+static
+uint64_t flecs_member_index_key(
+    ecs_primitive_kind_t kind,
+    const void *ptr)
+{
+    switch(kind) {
+    case EcsBool:  return *(const bool*)ptr;
+    case EcsChar:  return flecs_member_index_signed_key(*(const char*)ptr);
+    case EcsByte:  return *(const ecs_byte_t*)ptr;
+    case EcsU8:    return *(const uint8_t*)ptr;
+    case EcsU16:   return *(const uint16_t*)ptr;
+    case EcsU32:   return *(const uint32_t*)ptr;
+    case EcsU64:   return *(const uint64_t*)ptr;
+    case EcsUPtr:  return *(const uintptr_t*)ptr;
+    case EcsI8:    return flecs_member_index_signed_key(*(const int8_t*)ptr);
+    case EcsI16:   return flecs_member_index_signed_key(*(const int16_t*)ptr);
+    case EcsI32:   return flecs_member_index_signed_key(*(const int32_t*)ptr);
+    case EcsI64:   return flecs_member_index_signed_key(*(const int64_t*)ptr);
+    case EcsIPtr:  return flecs_member_index_signed_key(*(const intptr_t*)ptr);
+    case EcsF32:   return flecs_member_index_float_key(*(const float*)ptr);
+    case EcsF64:   return flecs_member_index_float_key(*(const double*)ptr);
+    case EcsEntity: return *(const ecs_entity_t*)ptr;
+    case EcsString:
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+static
+bool flecs_member_index_before(
+    uint64_t key_1,
+    ecs_entity_t e_1,
+    uint64_t key_2,
+    ecs_entity_t e_2)
+{
+    return key_1 < key_2 || (key_1 == key_2 && e_1 < e_2);
+}
+
+/* Find first element in sorted index that is not ordered before (key, e). If
+ * all elements are ordered before (key, e), this returns the end of the last
+ * chunk, or chunk 0 if the index is empty. */
+static
+int32_t flecs_member_index_lower_bound(
+    const ecs_member_index_t *index,
+    uint64_t key,
+    ecs_entity_t e,
+    int32_t *chunk_out)
+{
+    ecs_member_index_chunk_t **chunks = ecs_vec_first_t(
+        &index->chunks, ecs_member_index_chunk_t*);
+    int32_t lo = 0, hi = ecs_vec_count(&index->chunks);
+    if (!hi) {
+        *chunk_out = 0;
+        return 0;
+    }
+
+    /* Find first chunk with a last element that's not ordered before (key, e) */
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        ecs_member_index_chunk_t *chunk = chunks[mid];
+        int32_t last = chunk->count - 1;
+        if (flecs_member_index_before(
+            chunk->keys[last], chunk->entities[last], key, e)) 
+        {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo == ecs_vec_count(&index->chunks)) {
+        *chunk_out = lo - 1;
+        return chunks[lo - 1]->count;
+    }
+
+    ecs_member_index_chunk_t *chunk = chunks[lo];
+    *chunk_out = lo;
+
+    hi = chunk->count;
+    lo = 0;
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        if (flecs_member_index_before(
+            chunk->keys[mid], chunk->entities[mid], key, e)) 
+        {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static
+ecs_member_index_chunk_t* flecs_member_index_chunk_new(
+    ecs_member_index_t *index,
+    int32_t at)
+{
+    ecs_allocator_t *a = &index->world->allocator;
+    ecs_member_index_chunk_t *chunk = flecs_alloc_t(
+        a, ecs_member_index_chunk_t);
+    chunk->count = 0;
+
+    int32_t count = ecs_vec_count(&index->chunks);
+    ecs_vec_append_t(a, &index->chunks, ecs_member_index_chunk_t*);
+    ecs_member_index_chunk_t **chunks = ecs_vec_first_t(
+        &index->chunks, ecs_member_index_chunk_t*);
+    if (at != count) {
+        ecs_os_memmove(&chunks[at + 1], &chunks[at], 
+            ECS_SIZEOF(ecs_member_index_chunk_t*) * (count - at));
+    }
+    chunks[at] = chunk;
+
+    return chunk;
+}
+
+static
+void flecs_member_index_chunk_free(
+    ecs_member_index_t *index,
+    int32_t at)
+{
+    ecs_member_index_chunk_t **chunks = ecs_vec_first_t(
+        &index->chunks, ecs_member_index_chunk_t*);
+    int32_t count = ecs_vec_count(&index->chunks);
+    flecs_free_t(&index->world->allocator, ecs_member_index_chunk_t, 
+        chunks[at]);
+    ecs_os_memmove(&chunks[at], &chunks[at + 1],
+        ECS_SIZEOF(ecs_member_index_chunk_t*) * (count - at - 1));
+    ecs_vec_remove_last(&index->chunks);
+}
+
+/* Move elements [row, count) of chunk to the start of dst */
+static
+void flecs_member_index_chunk_move(
+    ecs_member_index_chunk_t *dst,
+    ecs_member_index_chunk_t *src,
+    int32_t row)
+{
+    int32_t move = src->count - row;
+    ecs_os_memcpy(&dst->keys[dst->count], &src->keys[row], 
+        ECS_SIZEOF(uint64_t) * move);
+    ecs_os_memcpy(&dst->entities[dst->count], &src->entities[row], 
+        ECS_SIZEOF(ecs_entity_t) * move);
+    dst->count += move;
+    src->count = row;
+}
+
+static
+void flecs_member_index_sorted_insert(
+    ecs_member_index_t *index,
+    ecs_entity_t e,
+    uint64_t key)
+{
+    int32_t cur;
+    int32_t row = flecs_member_index_lower_bound(index, key, e, &cur);
+    ecs_member_index_chunk_t *chunk;
+
+    if (!ecs_vec_count(&index->chunks)) {
+        chunk = flecs_member_index_chunk_new(index, 0);
+    } else {
+        chunk = ecs_vec_get_t(&index->chunks, 
+            ecs_member_index_chunk_t*, cur)[0];
+        if (chunk->count == FLECS_MEMBER_INDEX_CHUNK_SIZE) {
+            /* Split chunk, move upper half to new chunk */
+            ecs_member_index_chunk_t *next = 
+                flecs_member_index_chunk_new(index, cur + 1);
+            int32_t half = FLECS_MEMBER_INDEX_CHUNK_SIZE / 2;
+            flecs_member_index_chunk_move(next, chunk, half);
+            if (row > half) {
+                chunk = next;
+                row -= half;
+            }
+        }
+    }
+
+    int32_t count = chunk->count;
+    if (row != count) {
+        ecs_os_memmove(&chunk->keys[row + 1], &chunk->keys[row],
+            ECS_SIZEOF(uint64_t) * (count - row));
+        ecs_os_memmove(&chunk->entities[row + 1], &chunk->entities[row],
+            ECS_SIZEOF(ecs_entity_t) * (count - row));
+    }
+    chunk->keys[row] = key;
+    chunk->entities[row] = e;
+    chunk->count ++;
+}
+
+static
+void flecs_member_index_sorted_remove(
+    ecs_member_index_t *index,
+    ecs_entity_t e,
+    uint64_t key)
+{
+    int32_t cur;
+    int32_t row = flecs_member_index_lower_bound(index, key, e, &cur);
+    ecs_member_index_chunk_t **chunks = ecs_vec_first_t(
+        &index->chunks, ecs_member_index_chunk_t*);
+    ecs_member_index_chunk_t *chunk = chunks[cur];
+    int32_t count = chunk->count;
+    ecs_assert(row < count, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(chunk->entities[row] == e, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_os_memmove(&chunk->keys[row], &chunk->keys[row + 1],
+        ECS_SIZEOF(uint64_t) * (count - row - 1));
+    ecs_os_memmove(&chunk->entities[row], &chunk->entities[row + 1],
+        ECS_SIZEOF(ecs_entity_t) * (count - row - 1));
+    count = -- chunk->count;
+
+    if (!count) {
+        flecs_member_index_chunk_free(index, cur);
+    } else if (count < FLECS_MEMBER_INDEX_CHUNK_MIN) {
+        /* Merge sparse chunk with a neighbour if the result fits */
+        int32_t chunk_count = ecs_vec_count(&index->chunks);
+        if ((cur + 1) < chunk_count && 
+            (count + chunks[cur + 1]->count) <= FLECS_MEMBER_INDEX_CHUNK_SIZE)
+        {
+            flecs_member_index_chunk_move(chunk, chunks[cur + 1], 0);
+            flecs_member_index_chunk_free(index, cur + 1);
+        } else if (cur && 
+            (count + chunks[cur - 1]->count) <= FLECS_MEMBER_INDEX_CHUNK_SIZE)
+        {
+            flecs_member_index_chunk_move(chunks[cur - 1], chunk, 0);
+            flecs_member_index_chunk_free(index, cur);
+        }
+    }
+}
+
+static
+void flecs_member_index_insert(
+    ecs_member_index_t *index,
+    ecs_entity_t e,
+    uint64_t key)
+{
+    ecs_allocator_t *a = &index->world->allocator;
+    ecs_member_index_elem_t *elem = ecs_map_ensure(
+        &index->elems, ecs_member_index_elem_t, e);
+    elem->key = key;
+
+    if (index->kind == EcsMemberIndexSorted) {
+        flecs_member_index_sorted_insert(index, e, key);
+    } else {
+        ecs_vec_t *bucket = ecs_map_get(&index->buckets, ecs_vec_t, key);
+        if (!bucket) {
+            bucket = ecs_map_ensure(&index->buckets, ecs_vec_t, key);
+            ecs_vec_init_t(a, bucket, ecs_entity_t, 0);
+        }
+        elem->slot = ecs_vec_count(bucket);
+        ecs_vec_append_t(a, bucket, ecs_entity_t)[0] = e;
+    }
+}
+
+static
+void flecs_member_index_remove(
+    ecs_member_index_t *index,
+    ecs_entity_t e)
+{
+    ecs_member_index_elem_t *elem = ecs_map_get(
+        &index->elems, ecs_member_index_elem_t, e);
+    if (!elem) {
+        return;
+    }
+
+    uint64_t key = elem->key;
+
+    if (index->kind == EcsMemberIndexSorted) {
+        flecs_member_index_sorted_remove(index, e, key);
+    } else {
+        ecs_vec_t *bucket = ecs_map_get(&index->buckets, ecs_vec_t, key);
+        ecs_assert(bucket != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        int32_t slot = elem->slot;
+        ecs_entity_t *entities = ecs_vec_first_t(bucket, ecs_entity_t);
+        int32_t last = ecs_vec_count(bucket) - 1;
+        ecs_assert(entities[slot] == e, ECS_INTERNAL_ERROR, NULL);
+        if (slot != last) {
+            ecs_entity_t moved = entities[last];
+            entities[slot] = moved;
+            ecs_member_index_elem_t *moved_elem = ecs_map_get(
+                &index->elems, ecs_member_index_elem_t, moved);
+            ecs_assert(moved_elem != NULL, ECS_INTERNAL_ERROR, NULL);
+            moved_elem->slot = slot;
+        }
+        ecs_vec_remove_last(bucket);
+
+        if (!ecs_vec_count(bucket)) {
+            ecs_vec_fini_t(&index->world->allocator, bucket, ecs_entity_t);
+            ecs_map_remove(&index->buckets, key);
+        }
+    }
+
+    ecs_map_remove(&index->elems, e);
+}
+
+static
+void flecs_member_index_set(
+    ecs_member_index_t *index,
+    ecs_entity_t e,
+    const void *ptr)
+{
+    uint64_t key = flecs_member_index_key(index->type_kind,
+        ECS_OFFSET(ptr, index->offset));
+
+    ecs_member_index_elem_t *elem = ecs_map_get(
+        &index->elems, ecs_member_index_elem_t, e);
+    if (elem) {
+        if (elem->key == key) {
+            return; /* Value didn't change */
+        }
+        flecs_member_index_remove(index, e);
+    }
+
+    flecs_member_index_insert(index, e, key);
+}
+
+static
+void flecs_member_index_free(
+    void *ctx)
+{
+    ecs_member_index_t *index = ctx;
+    ecs_allocator_t *a = &index->world->allocator;
+
+    ecs_map_iter_t it = ecs_map_iter(&index->buckets);
+    ecs_vec_t *bucket;
+    while ((bucket = ecs_map_next(&it, ecs_vec_t, NULL))) {
+        ecs_vec_fini_t(a, bucket, ecs_entity_t);
+    }
+
+    ecs_member_index_chunk_t **chunks = ecs_vec_first_t(
+        &index->chunks, ecs_member_index_chunk_t*);
+    int32_t i, count = ecs_vec_count(&index->chunks);
+    for (i = 0; i < count; i ++) {
+        flecs_free_t(a, ecs_member_index_chunk_t, chunks[i]);
+    }
+
+    ecs_map_fini(&index->buckets);
+    ecs_map_fini(&index->elems);
+    ecs_vec_fini_t(a, &index->chunks, ecs_member_index_chunk_t*);
+    ecs_vec_fini_t(a, &index->result, ecs_entity_t);
+    ecs_os_free(index);
+}
+
+static
+void flecs_member_index_observer(
+    ecs_iter_t *it)
+{
+    ecs_member_index_t *index = it->ctx;
+    int32_t i, count = it->count;
+
+    if (it->event == EcsOnSet) {
+        ecs_size_t size = flecs_uto(ecs_size_t, ecs_field_size(it, 1));
+        void *ptr = ecs_field_w_size(it, flecs_ito(size_t, size), 1);
+        for (i = 0; i < count; i ++) {
+            flecs_member_index_set(index, it->entities[i],
+                ECS_ELEM(ptr, size, i));
+        }
+    } else {
+        for (i = 0; i < count; i ++) {
+            flecs_member_index_remove(index, it->entities[i]);
+        }
+    }
+}
+
+/* Resolve type kind of member, returns 0 if type cannot be indexed */
+static
+ecs_primitive_kind_t flecs_member_index_type_kind(
+    const ecs_world_t *world,
+    ecs_entity_t type)
+{
+    const EcsPrimitive *p = ecs_get(world, type, EcsPrimitive);
+    if (p) {
+        if (p->kind == EcsString) {
+            return 0;
+        }
+        return p->kind;
+    }
+
+    if (ecs_has(world, type, EcsEnum)) {
+        return EcsI32;
+    }
+
+    if (ecs_has(world, type, EcsBitmask)) {
+        return EcsU32;
+    }
+
+    return 0;
+}
+
+ecs_entity_t ecs_member_index_init(
+    ecs_world_t *world,
+    const ecs_member_index_desc_t *desc)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->member != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_entity_t member = desc->member;
+    const EcsMember *m = ecs_get(world, member, EcsMember);
+    if (!m) {
+        char *path = ecs_get_fullpath(world, member);
+        ecs_err("cannot create index for '%s': entity is not a member", path);
+        ecs_os_free(path);
+        return 0;
+    }
+
+    ecs_entity_t component = ecs_get_target(world, member, EcsChildOf, 0);
+    const EcsStruct *st = ecs_get(world, component, EcsStruct);
+    ecs_check(st != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_member_t *members = ecs_vector_first(st->members, ecs_member_t);
+    int32_t i, count = ecs_vector_count(st->members);
+    for (i = 0; i < count; i ++) {
+        if (members[i].member == member) {
+            break;
+        }
+    }
+    ecs_check(i != count, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_primitive_kind_t kind = flecs_member_index_type_kind(world, m->type);
+    if (!kind || members[i].count > 1) {
+        char *path = ecs_get_fullpath(world, member);
+        ecs_err("cannot create index for '%s': member is not a scalar", path);
+        ecs_os_free(path);
+        return 0;
+    }
+
+    world = (ecs_world_t*)ecs_get_world(world);
+
+    ecs_member_index_t *index = ecs_os_calloc_t(ecs_member_index_t);
+    index->world = world;
+    index->component = component;
+    index->member = member;
+    index->kind = desc->kind;
+    index->type_kind = kind;
+    index->offset = members[i].offset;
+    ecs_map_init(&index->elems, ecs_member_index_elem_t,
+        &world->allocator, 0);
+    ecs_map_init(&index->buckets, ecs_vec_t, &world->allocator, 0);
+    ecs_vec_init_t(&world->allocator, &index->chunks, 
+        ecs_member_index_chunk_t*, 0);
+    ecs_vec_init_t(&world->allocator, &index->result, ecs_entity_t, 0);
+
+    /* Populate index with values of existing entities */
+    ecs_iter_t it = ecs_term_iter(world, &(ecs_term_t){
+        .id = component,
+        .src.flags = EcsSelf
+    });
+    while (ecs_term_next(&it)) {
+        ecs_size_t size = flecs_uto(ecs_size_t, ecs_field_size(&it, 1));
+        void *ptr = ecs_field_w_size(&it, flecs_ito(size_t, size), 1);
+        for (i = 0; i < it.count; i ++) {
+            flecs_member_index_set(index, it.entities[i],
+                ECS_ELEM(ptr, size, i));
+        }
+    }
+
+    ecs_entity_t result = ecs_observer_init(world, &(ecs_observer_desc_t){
+        .entity = desc->entity,
+        .filter.terms = {{ .id = component, .src.flags = EcsSelf }},
+        .events = { EcsOnSet, EcsUnSet },
+        .callback = flecs_member_index_observer,
+        .ctx = index,
+        .ctx_free = flecs_member_index_free
+    });
+
+    if (!result) {
+        flecs_member_index_free(index);
+    }
+
+    return result;
+error:
+    return 0;
+}
+
+static
+ecs_member_index_t* flecs_member_index_get(
+    const ecs_world_t *world,
+    ecs_entity_t index)
+{
+    const EcsPoly *poly = ecs_poly_bind_get(world, index, ecs_observer_t);
+    if (!poly) {
+        return NULL;
+    }
+
+    ecs_observer_t *observer = poly->poly;
+    if (!observer || observer->callback != flecs_member_index_observer) {
+        return NULL;
+    }
+
+    return observer->ctx;
+}
+
+/* Move iterator to next chunk of lookup */
+static
+bool flecs_member_index_iter_chunk(
+    ecs_member_index_iter_t *iter)
+{
+    if (iter->chunk >= iter->last_chunk) {
+        return false;
+    }
+
+    const ecs_member_index_t *index = iter->index;
+    ecs_member_index_chunk_t *chunk = ecs_vec_get_t(&index->chunks, 
+        ecs_member_index_chunk_t*, ++ iter->chunk)[0];
+    iter->entities = chunk->entities;
+    iter->cur = 0;
+    if (iter->chunk == iter->last_chunk) {
+        iter->count = iter->last_count;
+    } else {
+        iter->count = chunk->count;
+    }
+
+    return true;
+}
+
+/* Find the chunk slices of a sorted index with keys in [min, max] */
+static
+void flecs_member_index_range(
+    const ecs_member_index_t *index,
+    const uint64_t *min,
+    const uint64_t *max,
+    ecs_member_index_iter_t *iter)
+{
+    int32_t chunk_count = ecs_vec_count(&index->chunks);
+    if (!chunk_count) {
+        return;
+    }
+
+    ecs_member_index_chunk_t **chunks = ecs_vec_first_t(
+        &index->chunks, ecs_member_index_chunk_t*);
+    int32_t lo_chunk = 0, lo = 0;
+    int32_t hi_chunk = chunk_count - 1, hi = chunks[hi_chunk]->count;
+
+    if (min) {
+        lo = flecs_member_index_lower_bound(index, min[0], 0, &lo_chunk);
+    }
+    if (max && max[0] != UINT64_MAX) {
+        hi = flecs_member_index_lower_bound(index, max[0] + 1, 0, &hi_chunk);
+    }
+
+    if (hi_chunk < lo_chunk || (hi_chunk == lo_chunk && hi <= lo)) {
+        return;
+    }
+
+    iter->entities = &chunks[lo_chunk]->entities[lo];
+    iter->chunk = lo_chunk;
+    iter->last_chunk = hi_chunk;
+    iter->last_count = hi;
+    if (lo_chunk == hi_chunk) {
+        iter->count = hi - lo;
+    } else {
+        iter->count = chunks[lo_chunk]->count - lo;
+    }
+}
+
+/* Initialize iterator for entities with a value in [min, max] */
+static
+int flecs_member_index_lookup(
+    const ecs_member_index_t *index,
+    const void *min,
+    const void *max,
+    ecs_member_index_iter_t *iter)
+{
+    ecs_primitive_kind_t kind = index->type_kind;
+    *iter = (ecs_member_index_iter_t){ .index = index };
+
+    if (index->kind == EcsMemberIndexHash) {
+        ecs_check(min != NULL && max != NULL, ECS_INVALID_PARAMETER,
+            "hash index only supports equality lookups");
+        uint64_t key = flecs_member_index_key(kind, min);
+        ecs_check(key == flecs_member_index_key(kind, max),
+            ECS_INVALID_PARAMETER, "hash index only supports equality lookups");
+
+        ecs_vec_t *bucket = ecs_map_get(&index->buckets, ecs_vec_t, key);
+        if (bucket) {
+            iter->entities = ecs_vec_first_t(bucket, ecs_entity_t);
+            iter->count = ecs_vec_count(bucket);
+        }
+        return 0;
+    }
+
+    uint64_t min_key, max_key;
+    if (min) {
+        min_key = flecs_member_index_key(kind, min);
+    }
+    if (max) {
+        max_key = flecs_member_index_key(kind, max);
+    }
+
+    flecs_member_index_range(index, min ? &min_key : NULL, 
+        max ? &max_key : NULL, iter);
+
+    return 0;
+error:
+    return -1;
+}
+
+const ecs_entity_t* ecs_member_index_find(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *min,
+    const void *max,
+    int32_t *count_out)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count_out != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    *count_out = 0;
+
+    ecs_member_index_t *ptr = flecs_member_index_get(world, index);
+    ecs_check(ptr != NULL, ECS_INVALID_PARAMETER, "entity is not an index");
+
+    ecs_member_index_iter_t iter;
+    if (flecs_member_index_lookup(ptr, min, max, &iter)) {
+        return NULL;
+    }
+
+    if (iter.chunk == iter.last_chunk) {
+        /* Result is stored in a single chunk or bucket */
+        *count_out = iter.count;
+        return iter.count ? iter.entities : NULL;
+    }
+
+    /* Result spans multiple chunks, copy to result buffer */
+    ecs_allocator_t *a = &ptr->world->allocator;
+    ecs_vec_clear(&ptr->result);
+    do {
+        ecs_entity_t *dst = ecs_vec_grow_t(a, &ptr->result, ecs_entity_t, 
+            iter.count);
+        ecs_os_memcpy_n(dst, iter.entities, ecs_entity_t, iter.count);
+    } while (flecs_member_index_iter_chunk(&iter));
+
+    *count_out = ecs_vec_count(&ptr->result);
+    return ecs_vec_first_t(&ptr->result, ecs_entity_t);
+error:
+    return NULL;
+}
+
+ecs_iter_t ecs_member_index_iter(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *min,
+    const void *max)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_member_index_t *ptr = flecs_member_index_get(world, index);
+    ecs_check(ptr != NULL, ECS_INVALID_PARAMETER, "entity is not an index");
+
+    const ecs_world_t *real_world = ecs_get_world(world);
+
+    ecs_iter_t it = {
+        .world = (ecs_world_t*)world,
+        .real_world = (ecs_world_t*)real_world,
+        .next = ecs_member_index_next
+    };
+
+    if (flecs_member_index_lookup(ptr, min, max, 
+        &it.priv.iter.member_index)) 
+    {
+        goto error;
+    }
+
+    return it;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+bool flecs_member_index_iter_next(
+    const ecs_world_t *world,
+    ecs_member_index_iter_t *iter,
+    ecs_table_t **table_out,
+    int32_t *row_out,
+    int32_t *count_out)
+{
+    do {
+        const ecs_entity_t *entities = iter->entities;
+        int32_t i = iter->cur, count = iter->count;
+
+        for (; i < count; i ++) {
+            ecs_record_t *r = flecs_entities_get(world, entities[i]);
+            if (!r || !r->table) {
+                continue;
+            }
+
+            /* Combine entities that are stored in consecutive rows of the 
+             * same table into a single result */
+            ecs_table_t *table = r->table;
+            int32_t row = ECS_RECORD_TO_ROW(r->row), run = 1;
+            for (i ++; i < count; i ++, run ++) {
+                ecs_record_t *next = flecs_entities_get(world, entities[i]);
+                if (!next || next->table != table ||
+                    ECS_RECORD_TO_ROW(next->row) != (row + run))
+                {
+                    break;
+                }
+            }
+
+            iter->cur = i;
+            *table_out = table;
+            *row_out = row;
+            *count_out = run;
+            return true;
+        }
+
+        iter->cur = count;
+    } while (flecs_member_index_iter_chunk(iter));
+
+    return false;
+}
+
+bool ecs_member_index_next(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_member_index_next, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_table_t *table;
+    int32_t row, count;
+    if (flecs_member_index_iter_next(it->real_world, 
+        &it->priv.iter.member_index, &table, &row, &count)) 
+    {
+        flecs_iter_populate_data(it->real_world, it, table, row, count, 
+            NULL, NULL);
+        ECS_BIT_SET(it->flags, EcsIterIsValid);
+        return true;
+    }
+
+    ECS_BIT_CLEAR(it->flags, EcsIterIsValid);
+error:
+    return false;
+}
+
+/* Type of predicate that tests values of the indexed member */
+static
+ecs_predicate_kind_t flecs_member_index_predicate_kind(
+    ecs_primitive_kind_t kind)
+{
+    switch(kind) {
+    case EcsBool:   return EcsPredicateU8;
+    case EcsChar:   return EcsPredicateI8;
+    case EcsByte:   return EcsPredicateU8;
+    case EcsU8:     return EcsPredicateU8;
+    case EcsU16:    return EcsPredicateU16;
+    case EcsU32:    return EcsPredicateU32;
+    case EcsU64:    return EcsPredicateU64;
+    case EcsI8:     return EcsPredicateI8;
+    case EcsI16:    return EcsPredicateI16;
+    case EcsI32:    return EcsPredicateI32;
+    case EcsI64:    return EcsPredicateI64;
+    case EcsF32:    return EcsPredicateF32;
+    case EcsF64:    return EcsPredicateF64;
+    case EcsEntity: return EcsPredicateU64;
+    case EcsUPtr:   
+        return ECS_SIZEOF(uintptr_t) == 8 ? EcsPredicateU64 : EcsPredicateU32;
+    case EcsIPtr:   
+        return ECS_SIZEOF(intptr_t) == 8 ? EcsPredicateI64 : EcsPredicateI32;
+    case EcsString:
+    default:
+        return EcsPredicateNone;
+    }
+}
+
+/* Convert predicate operand to value of the indexed member */
+static
+void flecs_member_index_predicate_value(
+    const ecs_member_index_t *index,
+    const ecs_term_predicate_t *pred,
+    void *out)
+{
+    double v = pred->value;
+    if (index->type_kind == EcsBool) {
+        *(bool*)out = v != 0;
+        return;
+    }
+
+    switch(pred->kind) {
+    case EcsPredicateI8:  *(int8_t*)out = (int8_t)v; break;
+    case EcsPredicateI16: *(int16_t*)out = (int16_t)v; break;
+    case EcsPredicateI32: *(int32_t*)out = (int32_t)v; break;
+    case EcsPredicateI64: *(int64_t*)out = (int64_t)v; break;
+    case EcsPredicateU8:  *(uint8_t*)out = (uint8_t)v; break;
+    case EcsPredicateU16: *(uint16_t*)out = (uint16_t)v; break;
+    case EcsPredicateU32: *(uint32_t*)out = (uint32_t)v; break;
+    case EcsPredicateU64: *(uint64_t*)out = (uint64_t)v; break;
+    case EcsPredicateF32: *(float*)out = (float)v; break;
+    case EcsPredicateF64: *(double*)out = v; break;
+    case EcsPredicateNone:
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+int flecs_member_index_iter_predicate(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    ecs_entity_t component,
+    const ecs_term_predicate_t *pred,
+    ecs_member_index_iter_t *iter)
+{
+    ecs_member_index_t *ptr = flecs_member_index_get(world, index);
+    if (!ptr || ptr->component != component || ptr->offset != pred->offset) {
+        return -1;
+    }
+
+    if (flecs_member_index_predicate_kind(ptr->type_kind) != pred->kind) {
+        return -1;
+    }
+
+    bool has_min = false, has_max = false;
+    switch(pred->op) {
+    case EcsPredicateEq:
+        has_min = has_max = true;
+        break;
+    case EcsPredicateLt:
+    case EcsPredicateLtEq:
+        has_max = true;
+        break;
+    case EcsPredicateGt:
+    case EcsPredicateGtEq:
+        has_min = true;
+        break;
+    case EcsPredicateNeq:
+    case EcsPredicateMaskAny:
+    case EcsPredicateMaskAll:
+    case EcsPredicateMaskNone:
+    default:
+        return -1;
+    }
+
+    if (ptr->kind == EcsMemberIndexHash && !(has_min && has_max)) {
+        return -1;
+    }
+
+    if (!iter) {
+        return 0;
+    }
+
+    /* The range includes the operand, so that exclusive comparisons return a
+     * superset of the result. Rows are still tested with the predicate. */
+    uint64_t value = 0;
+    flecs_member_index_predicate_value(ptr, pred, &value);
+    return flecs_member_index_lookup(ptr, has_min ? &value : NULL, 
+        has_max ? &value : NULL, iter);
+}
+
+#endif
@@ -37,12 +37,16 @@ void ecs_meta_dtor_serialized(
     }
 
     ecs_vector_free(ptr->ops); 
+    ecs_vector_free(ptr->json_ops);
+    ecs_os_free(ptr->json_literals);
 }
 
 static ECS_COPY(EcsMetaTypeSerialized, dst, src, {
     ecs_meta_dtor_serialized(dst);
 
     dst->ops = ecs_vector_copy(src->ops, ecs_meta_type_op_t);
+    dst->json_ops = ecs_vector_copy(src->json_ops, ecs_meta_json_op_t);
+    dst->json_literals = ecs_os_strdup(src->json_literals);
 
     int32_t o, count = ecs_vector_count(src->ops);
     ecs_meta_type_op_t *ops = ecs_vector_first(src->ops, ecs_meta_type_op_t);
@@ -58,7 +62,11 @@ static ECS_COPY(EcsMetaTypeSerialized, dst, src, {
 static ECS_MOVE(EcsMetaTypeSerialized, dst, src, {
     ecs_meta_dtor_serialized(dst);
     dst->ops = src->ops;
+    dst->json_ops = src->json_ops;
+    dst->json_literals = src->json_literals;
     src->ops = NULL;
+    src->json_ops = NULL;
+    src->json_literals = NULL;
 })
 
 static ECS_DTOR(EcsMetaTypeSerialized, ptr, { 
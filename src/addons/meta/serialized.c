@@ -275,6 +275,95 @@ ecs_vector_t* serialize_component(
     return ops;
 }
 
+#ifdef FLECS_JSON
+
+static
+void serialize_json_op_add(
+    ecs_vector_t **program,
+    ecs_strbuf_t *literals,
+    int32_t *literal,
+    ecs_meta_type_op_kind_t kind,
+    ecs_size_t offset)
+{
+    int32_t written = ecs_strbuf_written(literals);
+    ecs_meta_json_op_t *op = ecs_vector_add(program, ecs_meta_json_op_t);
+    op->kind = kind;
+    op->offset = offset;
+    op->literal = literal[0];
+    op->literal_len = written - literal[0];
+    literal[0] = written;
+}
+
+/* Flatten type ops into a program that alternates between literals and values.
+ * Literals are computed the same way as the JSON serializer computes member
+ * names & separators, so that the program produces the same output. */
+static
+void serialize_json_program(
+    ecs_vector_t *ops,
+    EcsMetaTypeSerialized *ptr)
+{
+    ecs_meta_type_op_t *op_ptr = ecs_vector_first(ops, ecs_meta_type_op_t);
+    int32_t i, count = ecs_vector_count(ops);
+    int32_t members[ECS_META_MAX_SCOPE_DEPTH] = {0};
+    int32_t sp = 0, literal = 0;
+
+    ecs_vector_t *program = NULL;
+    ecs_strbuf_t literals = ECS_STRBUF_INIT;
+
+    for (i = 0; i < count; i ++) {
+        ecs_meta_type_op_t *op = &op_ptr[i];
+        if (op->count > 1) {
+            goto unsupported; /* Inline array */
+        }
+
+        if (op->name) {
+            if (members[sp] ++) {
+                ecs_strbuf_appendlit(&literals, ", ");
+            }
+            ecs_strbuf_appendch(&literals, '"');
+            char *name = ecs_astresc('"', op->name);
+            ecs_strbuf_appendstr(&literals, name);
+            ecs_os_free(name);
+            ecs_strbuf_appendlit(&literals, "\":");
+        }
+
+        switch(op->kind) {
+        case EcsOpPush:
+            if (++ sp >= ECS_META_MAX_SCOPE_DEPTH) {
+                goto unsupported;
+            }
+            members[sp] = 0;
+            ecs_strbuf_appendch(&literals, '{');
+            break;
+        case EcsOpPop:
+            sp --;
+            ecs_strbuf_appendch(&literals, '}');
+            break;
+        default:
+            if (op->kind < EcsOpPrimitive) {
+                goto unsupported; /* Enum, bitmask, array or vector */
+            }
+            serialize_json_op_add(
+                &program, &literals, &literal, op->kind, op->offset);
+            break;
+        }
+    }
+
+    serialize_json_op_add(&program, &literals, &literal, EcsOpPop, 0);
+
+    ptr->json_ops = program;
+    ptr->json_literals = ecs_strbuf_get(&literals);
+    if (!ptr->json_literals) {
+        ptr->json_literals = ecs_os_strdup("");
+    }
+    return;
+unsupported:
+    ecs_vector_free(program);
+    ecs_strbuf_reset(&literals);
+}
+
+#endif
+
 void ecs_meta_type_serialized_init(
     ecs_iter_t *it)
 {
@@ -293,7 +382,74 @@ void ecs_meta_type_serialized_init(
         }
 
         ptr->ops = ops;
+        ptr->json_ops = NULL;
+        ptr->json_literals = NULL;
+#ifdef FLECS_JSON
+        serialize_json_program(ops, ptr);
+#endif
     }
 }
 
+int ecs_meta_member_offset(
+    const ecs_world_t *world,
+    ecs_entity_t type,
+    const char *member,
+    ecs_size_t *offset_out,
+    ecs_entity_t *type_out)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(member != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    const EcsMetaTypeSerialized *ser = ecs_get(
+        world, type, EcsMetaTypeSerialized);
+    if (!ser) {
+        return -1;
+    }
+
+    ecs_meta_type_op_t *push_op = ecs_vector_first(
+        ser->ops, ecs_meta_type_op_t);
+    const char *name = member;
+    char token[ECS_MAX_TOKEN_SIZE];
+
+    do {
+        if (!push_op || push_op->kind != EcsOpPush || !push_op->members) {
+            return -1;
+        }
+
+        const char *sep = strchr(name, '.');
+        ecs_size_t len = sep ? (ecs_size_t)(sep - name) : ecs_os_strlen(name);
+        if (!len || len >= ECS_MAX_TOKEN_SIZE) {
+            return -1;
+        }
+
+        ecs_os_memcpy(token, name, len);
+        token[len] = '\0';
+
+        /* Member indices are relative to the operation after the push */
+        const uint64_t *cur_ptr = flecs_name_index_find_ptr(
+            push_op->members, token, 0, 0);
+        if (!cur_ptr) {
+            return -1;
+        }
+
+        ecs_meta_type_op_t *op = &push_op[1 + cur_ptr[0]];
+        if (!sep) {
+            if (op->count > 1 || op->kind <= EcsOpScope) {
+                /* Only members that hold a single value can be resolved */
+                return -1;
+            }
+
+            /* Operation offsets are relative to the serialized type */
+            *offset_out = op->offset;
+            *type_out = op->type;
+            return 0;
+        }
+
+        push_op = op;
+        name = sep + 1;
+    } while (true);
+error:
+    return -1;
+}
+
 #endif
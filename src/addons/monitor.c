@@ -84,7 +84,7 @@ void MonitorStats(ecs_iter_t *it) {
             if (kind == ecs_id(EcsWorldStats)) {
                 ecs_world_stats_repeat_last(stats);
             } else if (kind == ecs_id(EcsPipelineStats)) {
-                ecs_world_stats_repeat_last(stats);
+                ecs_pipeline_stats_repeat_last(stats);
             }
         }
         hdr->reduce_count = 0;
@@ -583,6 +583,7 @@ void ecs_run_pipeline(
     int32_t stage_count = ecs_get_stage_count(world);
 
     ecs_worker_begin(stage->thread_ctx);
+    flecs_trace_begin(stage, EcsTracePipelineOp, pipeline);
 
     ecs_time_t st = {0};
     bool measure_time = false;
@@ -639,7 +640,11 @@ void ecs_run_pipeline(
                  * current position (system). If there are a lot of systems
                  * in the pipeline this can be an expensive operation, but
                  * should happen infrequently. */
+                flecs_trace_end(stage, EcsTracePipelineOp, pipeline);
+                flecs_trace_begin(stage, EcsTraceWorkerSync, 0);
                 bool rebuild = ecs_worker_sync(world, pq);
+                flecs_trace_end(stage, EcsTraceWorkerSync, 0);
+                flecs_trace_begin(stage, EcsTracePipelineOp, pipeline);
                 pq = (EcsPipeline*)ecs_get(world, pipeline, EcsPipeline);
                 if (rebuild) {
                     i = pq->cur_i;
@@ -652,7 +657,8 @@ void ecs_run_pipeline(
 
                 if (measure_time) {
                     /* Reset timer after merge */
-                    ecs_time_measure(&st);
+                    flecs_histogram_record(&world->sync_time_hist,
+                        (ecs_ftime_t)ecs_time_measure(&st));
                 }
             }
         }
@@ -663,7 +669,15 @@ done:
         world->info.system_time_total += (ecs_ftime_t)ecs_time_measure(&st);
     }
 
+    flecs_trace_end(stage, EcsTracePipelineOp, pipeline);
+    flecs_trace_begin(stage, EcsTraceWorkerSync, 0);
     ecs_worker_end(stage->thread_ctx);
+    flecs_trace_end(stage, EcsTraceWorkerSync, 0);
+
+    if (measure_time) {
+        flecs_histogram_record(&world->sync_time_hist,
+            (ecs_ftime_t)ecs_time_measure(&st));
+    }
 }
 
 bool ecs_progress(
@@ -2,13 +2,101 @@
 
 #ifdef FLECS_REST
 
+/* Interval (ns) at which the REST thread checks for requests */
+#define ECS_REST_POLL_INTERVAL (1000 * 1000)
+
+/* Max number of rows serialized per iterator result. Large tables are split up
+ * so that a streamed reply can be flushed before it exceeds the chunk size. */
+#define ECS_REST_STREAM_ROW_COUNT (256)
+
+/* Max number of compiled rules cached by the query endpoint */
+#define ECS_REST_RULE_CACHE_SIZE (32)
+
+/* Default & minimum interval (ms) between updates sent to a subscriber */
+#define ECS_REST_SUBSCRIPTION_INTERVAL (100)
+#define ECS_REST_SUBSCRIPTION_INTERVAL_MIN (10)
+
+/* Time (s) after which an idle subscription sends a comment, so that closed
+ * connections are detected */
+#define ECS_REST_SUBSCRIPTION_KEEP_ALIVE (5.0)
+
+/* Compiled rule for a query expression, with the last reply for the rule */
+typedef struct {
+    char *expr;
+    ecs_rule_t *rule;
+    int64_t last_used;
+
+    /* Value of id_delete_total when the ids of the rule were last checked */
+    int64_t id_delete_total;
+
+    /* Last reply, valid while params & state of matched tables are the same */
+    char *body;
+    ecs_size_t body_size;
+    uint64_t params_hash;
+    uint64_t state;
+} ecs_rest_cached_rule_t;
+
+/* Paths of entities that no longer match a subscription (observer ctx) */
+typedef struct {
+    ecs_strbuf_t paths;
+    int32_t count;
+} ecs_rest_removed_t;
+
+/* Query that sends changed results to a client as server-sent events */
+typedef struct {
+    char *expr;
+    ecs_iter_to_json_desc_t desc;
+    ecs_http_stream_t *stream;
+    ecs_ftime_t interval;
+    ecs_ftime_t elapsed; /* Time since last update */
+    ecs_ftime_t idle; /* Time since data was last sent */
+
+    /* Created on main thread when subscription is first updated */
+    ecs_query_t *query;
+    ecs_entity_t observer;
+    ecs_rest_removed_t *removed; /* Owned by observer */
+} ecs_rest_subscription_t;
+
 typedef struct {
     ecs_world_t *world;
     ecs_entity_t entity;
     ecs_http_server_t *srv;
     int32_t rc;
+
+    /* Subscriptions are added by the thread that handles requests, and are
+     * updated on the main thread */
+    ecs_os_mutex_t sub_lock;
+    ecs_vector_t *subs_new; /* vector<ecs_rest_subscription_t*> (sub_lock) */
+    ecs_vector_t *subs; /* vector<ecs_rest_subscription_t*> */
+
+    /* Query endpoint caches */
+    ecs_rest_cached_rule_t rules[ECS_REST_RULE_CACHE_SIZE];
+    int32_t rule_count;
+    int64_t rule_use_count;
+    uint64_t etag_seed;  /* Prevents ETag reuse by different server instances */
+
+    /* Tables matched by queries that don't track changes yet. Change tracking
+     * is enabled on the main thread (sub_lock) */
+    ecs_vector_t *tables_untracked; /* vector<uint64_t> */
+
+    /* Used when requests are handled on a separate thread */
+    ecs_world_t *stage;
+    ecs_os_thread_t thread;
+    ecs_reader_t reader;
 } ecs_rest_ctx_t;
 
+static
+void flecs_rest_thread_fini(
+    ecs_rest_ctx_t *impl);
+
+static
+void flecs_rest_rule_cache_fini(
+    ecs_rest_ctx_t *impl);
+
+static
+void flecs_rest_subscriptions_fini(
+    ecs_rest_ctx_t *impl);
+
 static ECS_COPY(EcsRest, dst, src, {
     ecs_rest_ctx_t *impl = src->impl;
     if (impl) {
@@ -17,6 +105,7 @@ static ECS_COPY(EcsRest, dst, src, {
 
     ecs_os_strset(&dst->ipaddr, src->ipaddr);
     dst->port = src->port;
+    dst->threaded = src->threaded;
     dst->impl = impl;
 })
 
@@ -31,7 +120,12 @@ static ECS_DTOR(EcsRest, ptr, {
     if (impl) {
         impl->rc --;
         if (!impl->rc) {
+            flecs_rest_thread_fini(impl);
+            flecs_rest_rule_cache_fini(impl);
+            flecs_rest_subscriptions_fini(impl);
+            ecs_vector_free(impl->tables_untracked);
             ecs_http_server_fini(impl->srv);
+            ecs_os_mutex_free(impl->sub_lock);
             ecs_os_free(impl);
         }
     }
@@ -63,13 +157,25 @@ char* flecs_rest_get_captured_log(void) {
 
 static
 void flecs_reply_verror(
-    ecs_http_reply_t *reply,
+    ecs_strbuf_t *buf,
     const char *fmt,
     va_list args)
 {
-    ecs_strbuf_appendlit(&reply->body, "{\"error\":\"");
-    ecs_strbuf_vappend(&reply->body, fmt, args);
-    ecs_strbuf_appendlit(&reply->body, "\"}");
+    ecs_strbuf_appendlit(buf, "{\"error\":\"");
+    ecs_strbuf_vappend(buf, fmt, args);
+    ecs_strbuf_appendlit(buf, "\"}");
+}
+
+static
+void flecs_reply_error_buf(
+    ecs_strbuf_t *buf,
+    const char *fmt,
+    ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    flecs_reply_verror(buf, fmt, args);
+    va_end(args);
 }
 
 static
@@ -80,7 +186,7 @@ void flecs_reply_error(
 {
     va_list args;
     va_start(args, fmt);
-    flecs_reply_verror(reply, fmt, args);
+    flecs_reply_verror(&reply->body, fmt, args);
     va_end(args);
 }
 
@@ -162,6 +268,20 @@ void flecs_rest_parse_json_ser_iter_params(
     flecs_rest_bool_param(req, "type_info", &desc->serialize_type_info);
 }
 
+/* Clients can request CBOR instead of JSON with the Accept header */
+static
+bool flecs_rest_accept_cbor(
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    const char *accept = ecs_http_get_header(req, "Accept");
+    if (accept && strstr(accept, "application/cbor")) {
+        reply->content_type = "application/cbor";
+        return true;
+    }
+    return false;
+}
+
 static
 bool flecs_rest_reply_entity(
     ecs_world_t *world,
@@ -183,12 +303,316 @@ bool flecs_rest_reply_entity(
     ecs_entity_to_json_desc_t desc = ECS_ENTITY_TO_JSON_INIT;
     flecs_rest_parse_json_ser_entity_params(&desc, req);
 
-    ecs_entity_to_json_buf(world, e, &reply->body, &desc);
+    ecs_strbuf_appendlit(&reply->headers, "Vary: Accept\r\n");
+    if (flecs_rest_accept_cbor(req, reply)) {
+        ecs_entity_to_cbor_buf(world, e, &reply->body, &desc);
+    } else {
+        ecs_entity_to_json_buf(world, e, &reply->body, &desc);
+    }
+    return true;
+}
+
+typedef struct {
+    ecs_http_reply_t *reply;
+    int32_t remaining; /* Rows left to serialize for current result */
+    bool buffered; /* Don't flush, send reply when it is complete */
+    bool flushed;
+    bool aborted;
+} ecs_rest_stream_t;
+
+/* Iterator that flushes the reply each time the serialized body exceeds the
+ * chunk size, so that large query results are sent in chunks. */
+static
+bool flecs_rest_iter_next(
+    ecs_iter_t *it)
+{
+    ecs_rest_stream_t *stream = it->ctx;
+    ecs_http_reply_t *reply = stream->reply;
+
+    if (!stream->buffered && 
+        ecs_strbuf_written(&reply->body) >= ECS_HTTP_CHUNK_SIZE) 
+    {
+        stream->flushed = true;
+        if (ecs_http_reply_flush(reply)) {
+            /* Connection was closed, stop serializing */
+            stream->aborted = true;
+            return false;
+        }
+    }
+
+    int32_t count;
+    if (stream->remaining) {
+        /* Serialize next rows of current result */
+        count = it->count;
+        it->offset += count;
+        flecs_offset_iter(it, count);
+        count = stream->remaining;
+    } else {
+        ecs_iter_t *chain_it = it->chain_it;
+        if (!ecs_iter_next(chain_it)) {
+            return false;
+        }
+
+        /* Copy everything up to the private iterator data */
+        ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+        it->ctx = stream;
+        ECS_BIT_SET(it->flags, EcsIterIsInstanced);
+        count = it->count;
+    }
+
+    if (count > ECS_REST_STREAM_ROW_COUNT && it->table) {
+        stream->remaining = count - ECS_REST_STREAM_ROW_COUNT;
+        count = ECS_REST_STREAM_ROW_COUNT;
+    } else {
+        stream->remaining = 0;
+    }
+
+    it->count = count;
     return true;
 }
 
+static
+void flecs_rest_cached_rule_fini(
+    ecs_rest_cached_rule_t *cr)
+{
+    ecs_rule_fini(cr->rule);
+    ecs_os_free(cr->expr);
+    ecs_os_free(cr->body);
+}
+
+static
+void flecs_rest_rule_cache_fini(
+    ecs_rest_ctx_t *impl)
+{
+    int32_t i;
+    for (i = 0; i < impl->rule_count; i ++) {
+        flecs_rest_cached_rule_fini(&impl->rules[i]);
+    }
+    impl->rule_count = 0;
+}
+
+static
+bool flecs_rest_term_id_alive(
+    const ecs_world_t *world,
+    const ecs_term_id_t *term_id)
+{
+    if (!term_id->id || (term_id->flags & EcsIsVariable)) {
+        return true;
+    }
+    return ecs_is_alive(world, term_id->id);
+}
+
+/* Rules store the ids of resolved entities. Check if they're still alive. */
+static
+bool flecs_rest_rule_ids_alive(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule)
+{
+    const ecs_filter_t *filter = ecs_rule_get_filter(rule);
+    int32_t i;
+    for (i = 0; i < filter->term_count; i ++) {
+        const ecs_term_t *term = &filter->terms[i];
+        if (!flecs_rest_term_id_alive(world, &term->src) ||
+            !flecs_rest_term_id_alive(world, &term->first) ||
+            !flecs_rest_term_id_alive(world, &term->second))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Find compiled rule for expression, or compile and add it to the cache. When
+ * the cache is full, the least recently used rule is evicted. */
+static
+ecs_rest_cached_rule_t* flecs_rest_get_rule(
+    ecs_rest_ctx_t *impl,
+    ecs_world_t *world,
+    const char *expr)
+{
+    int64_t id_delete_total = impl->world->info.id_delete_total;
+    ecs_rest_cached_rule_t *cr = NULL;
+    int32_t i;
+    for (i = 0; i < impl->rule_count; i ++) {
+        if (!ecs_os_strcmp(impl->rules[i].expr, expr)) {
+            cr = &impl->rules[i];
+            break;
+        }
+    }
+
+    /* Evict rule if one of its ids was deleted since it was last used */
+    if (cr && cr->id_delete_total != id_delete_total) {
+        if (flecs_rest_rule_ids_alive(impl->world, cr->rule)) {
+            cr->id_delete_total = id_delete_total;
+        } else {
+            flecs_rest_cached_rule_fini(cr);
+            impl->rules[i] = impl->rules[-- impl->rule_count];
+            cr = NULL;
+        }
+    }
+
+    if (!cr) {
+        ecs_rule_t *rule = ecs_rule_init(world, &(ecs_filter_desc_t){
+            .expr = expr
+        });
+        if (!rule) {
+            return NULL;
+        }
+
+        if (impl->rule_count < ECS_REST_RULE_CACHE_SIZE) {
+            cr = &impl->rules[impl->rule_count ++];
+        } else {
+            cr = &impl->rules[0];
+            for (i = 1; i < impl->rule_count; i ++) {
+                if (impl->rules[i].last_used < cr->last_used) {
+                    cr = &impl->rules[i];
+                }
+            }
+            flecs_rest_cached_rule_fini(cr);
+        }
+
+        ecs_os_zeromem(cr);
+        cr->expr = ecs_os_strdup(expr);
+        cr->rule = rule;
+        cr->id_delete_total = id_delete_total;
+    }
+
+    cr->last_used = ++ impl->rule_use_count;
+    return cr;
+}
+
+/* Hash of request parameters, so that replies for requests with different 
+ * serializer parameters, offset, limit or format get a different ETag. */
+static
+uint64_t flecs_rest_params_hash(
+    ecs_rest_ctx_t *impl,
+    const ecs_http_request_t* req,
+    bool cbor)
+{
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_strbuf_append(&buf, "%llx", (unsigned long long)impl->etag_seed);
+    if (cbor) {
+        ecs_strbuf_appendlit(&buf, "&cbor");
+    }
+
+    int32_t i;
+    for (i = 0; i < req->param_count; i ++) {
+        ecs_strbuf_appendch(&buf, '&');
+        ecs_strbuf_appendstr(&buf, req->params[i].key);
+        ecs_strbuf_appendch(&buf, '=');
+        ecs_strbuf_appendstr(&buf, req->params[i].value);
+    }
+
+    ecs_size_t len = ecs_strbuf_written(&buf);
+    char *str = ecs_strbuf_get(&buf);
+    uint64_t result = flecs_hash(str, len);
+    ecs_os_free(str);
+    return result;
+}
+
+/* Append change counters of table to the rule state. Returns false if the table
+ * doesn't track changes yet, in which case it is added to the list of tables
+ * for which the main thread enables change tracking. */
+static
+bool flecs_rest_table_state(
+    ecs_rest_ctx_t *impl,
+    ecs_strbuf_t *buf,
+    const ecs_table_t *table)
+{
+    if (!table) {
+        return true;
+    }
+
+    int32_t *dirty_state = table->dirty_state;
+    if (!dirty_state) {
+        ecs_os_mutex_lock(impl->sub_lock);
+        uint64_t *elem = ecs_vector_add(&impl->tables_untracked, uint64_t);
+        *elem = table->id;
+        ecs_os_mutex_unlock(impl->sub_lock);
+        return false;
+    }
+
+    ecs_strbuf_appendbin(buf, &table->id, ECS_SIZEOF(uint64_t));
+    ecs_strbuf_appendbin(buf, dirty_state, 
+        (table->storage_count + 1) * ECS_SIZEOF(int32_t));
+    return true;
+}
+
+/* Hash of the change counters of the tables matched by a rule. Tables change
+ * when entities are added or removed, and when components are written by a
+ * query or set with ecs_set/ecs_modified. Returns false if the state can't be 
+ * determined because a table doesn't track changes yet. */
+static
+bool flecs_rest_rule_state(
+    ecs_rest_ctx_t *impl,
+    ecs_world_t *world,
+    const ecs_rule_t *rule,
+    uint64_t *state_out)
+{
+    ecs_world_t *real_world = impl->world;
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+
+    /* Tables are recycled, so include counters for created & deleted tables */
+    ecs_strbuf_appendbin(&buf, &real_world->info.table_create_total, 
+        ECS_SIZEOF(int64_t));
+    ecs_strbuf_appendbin(&buf, &real_world->info.table_delete_total, 
+        ECS_SIZEOF(int64_t));
+
+    bool tracked = true;
+    ecs_iter_t it = ecs_rule_iter(world, rule);
+    while (ecs_rule_next(&it)) {
+        if (!flecs_rest_table_state(impl, &buf, it.table)) {
+            tracked = false;
+        }
+
+        /* Fields can be matched on other entities than the result entities */
+        int32_t i;
+        for (i = 0; i < it.field_count; i ++) {
+            ecs_entity_t src = it.sources[i];
+            if (src && !flecs_rest_table_state(
+                impl, &buf, ecs_get_table(real_world, src))) 
+            {
+                tracked = false;
+            }
+        }
+    }
+
+    ecs_size_t len = ecs_strbuf_written(&buf);
+    char *str = ecs_strbuf_get(&buf);
+    *state_out = flecs_hash(str, len);
+    ecs_os_free(str);
+    return tracked;
+}
+
+/* Enable change tracking for tables matched by queries. Runs on the main 
+ * thread, as it allocates from the world. */
+static
+void flecs_rest_track_tables(
+    ecs_rest_ctx_t *impl)
+{
+    ecs_world_t *world = impl->world;
+
+    ecs_os_mutex_lock(impl->sub_lock);
+    ecs_vector_t *tables = impl->tables_untracked;
+    impl->tables_untracked = NULL;
+    ecs_os_mutex_unlock(impl->sub_lock);
+
+    int32_t i, count = ecs_vector_count(tables);
+    uint64_t *ids = ecs_vector_first(tables, uint64_t);
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *table = flecs_sparse_get(
+            &world->store.tables, ecs_table_t, ids[i]);
+        if (table) {
+            flecs_table_get_dirty_state(world, table);
+        }
+    }
+
+    ecs_vector_free(tables);
+}
+
 static
 bool flecs_rest_reply_query(
+    ecs_rest_ctx_t *impl,
     ecs_world_t *world,
     const ecs_http_request_t* req,
     ecs_http_reply_t *reply)
@@ -205,10 +629,8 @@ bool flecs_rest_reply_query(
     ecs_os_api_log_t prev_log_ = ecs_os_api.log_;
     ecs_os_api.log_ = flecs_rest_capture_log;
 
-    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
-        .expr = q
-    });
-    if (!r) {
+    ecs_rest_cached_rule_t *cr = flecs_rest_get_rule(impl, world, q);
+    if (!cr) {
         char *err = flecs_rest_get_captured_log();
         char *escaped_err = ecs_astresc('"', err);
         flecs_reply_error(reply, escaped_err);
@@ -216,23 +638,410 @@ bool flecs_rest_reply_query(
         ecs_os_free(escaped_err);
         ecs_os_free(err);
     } else {
-        ecs_iter_to_json_desc_t desc = ECS_ITER_TO_JSON_INIT;
-        flecs_rest_parse_json_ser_iter_params(&desc, req);
+        bool cbor = flecs_rest_accept_cbor(req, reply);
+        ecs_strbuf_appendlit(&reply->headers, "Vary: Accept\r\n");
+
+        /* The reply can be reused while the matched tables haven't changed.
+         * Replies for tables that don't track changes yet are not cached. */
+        uint64_t params_hash = flecs_rest_params_hash(impl, req, cbor);
+        uint64_t state = 0;
+        bool tracked = flecs_rest_rule_state(impl, world, cr->rule, &state);
+        char etag[64] = {0};
+        if (tracked) {
+            ecs_os_sprintf(etag, "\"%llx-%llx\"", 
+                (unsigned long long)params_hash, 
+                (unsigned long long)state);
+            ecs_strbuf_append(&reply->headers, "ETag: %s\r\n", etag);
+        }
+
+        const char *if_none_match = ecs_http_get_header(req, "If-None-Match");
+        if (tracked && if_none_match && !ecs_os_strcmp(if_none_match, etag)) {
+            reply->code = 304;
+            reply->status = "Not Modified";
+        } else if (tracked && cr->body && cr->params_hash == params_hash && 
+            cr->state == state) 
+        {
+            ecs_strbuf_appendbin(&reply->body, cr->body, cr->body_size);
+        } else {
+            ecs_rule_t *r = cr->rule;
+            ecs_iter_to_json_desc_t desc = ECS_ITER_TO_JSON_INIT;
+            flecs_rest_parse_json_ser_iter_params(&desc, req);
+
+            int32_t offset = 0;
+            int32_t limit = 1000;
+
+            flecs_rest_int_param(req, "offset", &offset);
+            flecs_rest_int_param(req, "limit", &limit);
+
+            ecs_iter_t it = ecs_rule_iter(world, r);
+            ecs_iter_t pit = ecs_page_iter(&it, offset, limit);
+            ECS_BIT_SET(pit.flags, EcsIterIsInstanced);
+
+            /* A flush blocks while the client hasn't read earlier chunks. The
+             * REST thread can't block while reading the world, as that would
+             * also block the main thread, so its replies are sent when done */
+            ecs_rest_stream_t stream = { 
+                .reply = reply, 
+                .buffered = impl->thread != 0
+            };
+            ecs_iter_t sit = pit;
+            sit.next = flecs_rest_iter_next;
+            sit.fini = NULL;
+            sit.chain_it = &pit;
+            sit.ctx = &stream;
+
+            /* Iterator is created for the stage, but the serializer reads
+             * component metadata which isn't allowed on async stages */
+            if (cbor) {
+                ecs_iter_to_cbor_buf(impl->world, &sit, &reply->body, &desc);
+            } else {
+                ecs_iter_to_json_buf(impl->world, &sit, &reply->body, &desc);
+            }
+            if (stream.aborted) {
+                /* Cleanup resources of iterator that wasn't depleted */
+                ecs_iter_fini(&it);
+            } else if (tracked && !stream.flushed) {
+                /* Only cache replies that weren't streamed, as the body of a
+                 * streamed reply is no longer available */
+                ecs_size_t body_size = ecs_strbuf_written(&reply->body);
+                char *body = ecs_strbuf_get(&reply->body);
+                ecs_strbuf_appendbin(&reply->body, body, body_size);
+                ecs_os_free(cr->body);
+                cr->body = body;
+                cr->body_size = body_size;
+                cr->params_hash = params_hash;
+                cr->state = state;
+            }
+        }
+    }
+
+    ecs_os_api.log_ = prev_log_;
+    ecs_log_enable_colors(prev_color);
+
+    return true;
+}
+
+static
+void flecs_rest_removed_free(
+    void *ptr)
+{
+    ecs_rest_removed_t *removed = ptr;
+    ecs_strbuf_reset(&removed->paths);
+    ecs_os_free(removed);
+}
+
+/* Collect entities that no longer match the subscription query */
+static
+void flecs_rest_subscription_on_remove(
+    ecs_iter_t *it)
+{
+    ecs_rest_removed_t *removed = it->ctx;
+    int32_t i;
+    for (i = 0; i < it->count; i ++) {
+        if (removed->count ++) {
+            ecs_strbuf_appendch(&removed->paths, ',');
+        }
+        ecs_strbuf_appendch(&removed->paths, '"');
+        ecs_get_path_w_sep_buf(it->real_world, 0, it->entities[i], ".", "", 
+            &removed->paths);
+        ecs_strbuf_appendch(&removed->paths, '"');
+    }
+}
+
+/* Create query & observer for subscription */
+static
+int flecs_rest_subscription_init(
+    ecs_world_t *world,
+    ecs_rest_subscription_t *sub)
+{
+    ecs_filter_t *f = ecs_filter_init(world, &(ecs_filter_desc_t){
+        .expr = sub->expr
+    });
+    if (!f) {
+        return -1;
+    }
+
+    /* Subscriptions only read data, so they shouldn't mark results as changed
+     * when they are iterated */
+    int32_t i;
+    for (i = 0; i < f->term_count; i ++) {
+        ecs_term_t *term = &f->terms[i];
+        if (term->inout == EcsInOutDefault || term->inout == EcsInOut) {
+            term->inout = EcsIn;
+        }
+    }
+
+    sub->query = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms_buffer = f->terms,
+        .filter.terms_buffer_count = f->term_count,
+        .track_rows = true
+    });
+
+    if (sub->query) {
+        /* Removed entities are reported when a queried for component is 
+         * removed, or when the entity is deleted */
+        sub->removed = ecs_os_calloc_t(ecs_rest_removed_t);
+        sub->observer = ecs_observer_init(world, &(ecs_observer_desc_t){
+            .filter.terms_buffer = f->terms,
+            .filter.terms_buffer_count = f->term_count,
+            .events = { EcsOnRemove },
+            .callback = flecs_rest_subscription_on_remove,
+            .ctx = sub->removed,
+            .ctx_free = flecs_rest_removed_free
+        });
+        if (!sub->observer) {
+            flecs_rest_removed_free(sub->removed);
+            sub->removed = NULL;
+        }
+    }
+
+    ecs_filter_fini(f);
+
+    return sub->query ? 0 : -1;
+}
+
+static
+void flecs_rest_subscription_fini(
+    ecs_world_t *world,
+    ecs_rest_subscription_t *sub)
+{
+    /* Queries & observers are cleaned up by the world when it is deleted */
+    if (!(world->flags & EcsWorldFini)) {
+        if (sub->query) {
+            ecs_query_fini(sub->query);
+        }
+        if (sub->observer) {
+            ecs_delete(world, sub->observer);
+        }
+    }
+
+    ecs_http_stream_close(sub->stream);
+    ecs_os_free(sub->expr);
+    ecs_os_free(sub);
+}
+
+static
+void flecs_rest_subscriptions_fini(
+    ecs_rest_ctx_t *impl)
+{
+    int32_t i, count = ecs_vector_count(impl->subs_new);
+    ecs_rest_subscription_t **subs = ecs_vector_first(
+        impl->subs_new, ecs_rest_subscription_t*);
+    for (i = 0; i < count; i ++) {
+        flecs_rest_subscription_fini(impl->world, subs[i]);
+    }
+
+    count = ecs_vector_count(impl->subs);
+    subs = ecs_vector_first(impl->subs, ecs_rest_subscription_t*);
+    for (i = 0; i < count; i ++) {
+        flecs_rest_subscription_fini(impl->world, subs[i]);
+    }
+
+    ecs_vector_free(impl->subs_new);
+    ecs_vector_free(impl->subs);
+    impl->subs_new = NULL;
+    impl->subs = NULL;
+}
+
+/* Iterator that counts the number of results, so that updates without changed
+ * rows aren't sent */
+static
+bool flecs_rest_subscription_next(
+    ecs_iter_t *it)
+{
+    int32_t *result_count = it->ctx;
+    ecs_iter_t *chain_it = it->chain_it;
+    if (!ecs_iter_next(chain_it)) {
+        return false;
+    }
+
+    /* Copy everything up to the private iterator data */
+    ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+    it->ctx = result_count;
+    ECS_BIT_SET(it->flags, EcsIterIsInstanced);
+    result_count[0] ++;
+    return true;
+}
+
+/* Write event with rows that changed since the last update */
+static
+void flecs_rest_subscription_update(
+    ecs_world_t *world,
+    ecs_rest_subscription_t *sub,
+    ecs_strbuf_t *buf)
+{
+    ecs_strbuf_t changed = ECS_STRBUF_INIT;
+    int32_t result_count = 0;
+
+    if (ecs_query_changed(sub->query, NULL)) {
+        ecs_iter_t qit = ecs_query_iter(world, sub->query);
+        ECS_BIT_SET(qit.flags, EcsIterIsInstanced);
+        ECS_BIT_SET(qit.flags, EcsIterChangedOnly);
+
+        ecs_iter_t it = qit;
+        it.next = flecs_rest_subscription_next;
+        it.fini = NULL;
+        it.chain_it = &qit;
+        it.ctx = &result_count;
+        ecs_iter_to_json_buf(world, &it, &changed, &sub->desc);
+    }
+
+    ecs_rest_removed_t *removed = sub->removed;
+    if (!result_count && (!removed || !removed->count)) {
+        ecs_strbuf_reset(&changed);
+        return;
+    }
+
+    ecs_strbuf_appendlit(buf, "event: update\ndata: {\"removed\":[");
+    if (removed && removed->count) {
+        ecs_strbuf_mergebuff(buf, &removed->paths);
+        removed->count = 0;
+    }
+    ecs_strbuf_appendlit(buf, "], \"changed\":");
+    if (result_count) {
+        ecs_strbuf_mergebuff(buf, &changed);
+    } else {
+        ecs_strbuf_reset(&changed);
+        ecs_strbuf_appendlit(buf, "{\"results\":[]}");
+    }
+    ecs_strbuf_appendlit(buf, "}\n\n");
+}
+
+/* Send changes to subscribers. Runs on the main thread, as subscriptions 
+ * create queries. */
+static
+void flecs_rest_subscriptions_progress(
+    ecs_rest_ctx_t *impl,
+    ecs_ftime_t delta_time)
+{
+    ecs_world_t *world = impl->world;
+
+    ecs_os_mutex_lock(impl->sub_lock);
+    int32_t i, count = ecs_vector_count(impl->subs_new);
+    ecs_rest_subscription_t **subs = ecs_vector_first(
+        impl->subs_new, ecs_rest_subscription_t*);
+    for (i = 0; i < count; i ++) {
+        ecs_rest_subscription_t **elem = ecs_vector_add(
+            &impl->subs, ecs_rest_subscription_t*);
+        *elem = subs[i];
+    }
+    ecs_vector_clear(impl->subs_new);
+    ecs_os_mutex_unlock(impl->sub_lock);
+
+    count = ecs_vector_count(impl->subs);
+    if (!count) {
+        return;
+    }
+
+    bool prev_color = ecs_log_enable_colors(false);
+    ecs_os_api_log_t prev_log_ = ecs_os_api.log_;
+    ecs_os_api.log_ = flecs_rest_capture_log;
 
-        int32_t offset = 0;
-        int32_t limit = 1000;
+    subs = ecs_vector_first(impl->subs, ecs_rest_subscription_t*);
+    for (i = count - 1; i >= 0; i --) {
+        ecs_rest_subscription_t *sub = subs[i];
+        ecs_strbuf_t buf = ECS_STRBUF_INIT;
+
+        if (!sub->query) {
+            if (flecs_rest_subscription_init(world, sub)) {
+                char *err = flecs_rest_get_captured_log();
+                char *escaped_err = ecs_astresc('"', err);
+                ecs_strbuf_appendlit(&buf, "event: error\ndata: ");
+                flecs_reply_error_buf(&buf, "%s", escaped_err);
+                ecs_strbuf_appendlit(&buf, "\n\n");
+                ecs_http_stream_send(sub->stream, &buf);
+                ecs_os_free(escaped_err);
+                ecs_os_free(err);
+                goto remove;
+            }
+
+            /* Send current results immediately */
+            sub->elapsed = sub->interval;
+        }
 
-        flecs_rest_int_param(req, "offset", &offset);
-        flecs_rest_int_param(req, "limit", &limit);
+        sub->elapsed += delta_time;
+        sub->idle += delta_time;
+        if (sub->elapsed < sub->interval) {
+            continue;
+        }
+
+        /* Don't send updates to clients that haven't received the previous 
+         * update. Changes are sent with the next update. */
+        if (ecs_http_stream_queued(sub->stream)) {
+            continue;
+        }
+
+        sub->elapsed = 0;
+        flecs_rest_subscription_update(world, sub, &buf);
+        if (!ecs_strbuf_written(&buf) && 
+            sub->idle > (ecs_ftime_t)ECS_REST_SUBSCRIPTION_KEEP_ALIVE) 
+        {
+            ecs_strbuf_appendlit(&buf, ": keep-alive\n\n");
+        }
+
+        if (ecs_strbuf_written(&buf)) {
+            sub->idle = 0;
+            if (ecs_http_stream_send(sub->stream, &buf)) {
+                /* Connection was closed */
+                goto remove;
+            }
+        }
 
-        ecs_iter_t it = ecs_rule_iter(world, r);
-        ecs_iter_t pit = ecs_page_iter(&it, offset, limit);
-        ecs_iter_to_json_buf(world, &pit, &reply->body, &desc);
-        ecs_rule_fini(r);
+        continue;
+remove:
+        ecs_strbuf_reset(&buf);
+        flecs_rest_subscription_fini(world, sub);
+        ecs_vector_remove(impl->subs, ecs_rest_subscription_t*, i);
+        subs = ecs_vector_first(impl->subs, ecs_rest_subscription_t*);
     }
 
     ecs_os_api.log_ = prev_log_;
     ecs_log_enable_colors(prev_color);
+}
+
+static
+bool flecs_rest_reply_subscribe(
+    ecs_rest_ctx_t *impl,
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    const char *q = ecs_http_get_param(req, "q");
+    if (!q) {
+        ecs_strbuf_appendlit(&reply->body, "Missing parameter 'q'");
+        reply->code = 400; /* bad request */
+        return true;
+    }
+
+    ecs_http_stream_t *stream = ecs_http_reply_open_stream(reply);
+    if (!stream) {
+        flecs_reply_error(reply, "subscriptions require HTTP/1.1");
+        reply->code = 400; /* bad request */
+        return true;
+    }
+
+    ecs_dbg_2("rest: subscribe to query '%s'", q);
+
+    reply->content_type = "text/event-stream";
+    ecs_strbuf_appendlit(&reply->headers, "Cache-Control: no-cache\r\n");
+
+    int32_t interval = ECS_REST_SUBSCRIPTION_INTERVAL;
+    flecs_rest_int_param(req, "interval", &interval);
+    if (interval < ECS_REST_SUBSCRIPTION_INTERVAL_MIN) {
+        interval = ECS_REST_SUBSCRIPTION_INTERVAL_MIN;
+    }
+
+    ecs_rest_subscription_t *sub = ecs_os_calloc_t(ecs_rest_subscription_t);
+    sub->expr = ecs_os_strdup(q);
+    sub->desc = ECS_ITER_TO_JSON_INIT;
+    flecs_rest_parse_json_ser_iter_params(&sub->desc, req);
+    sub->stream = stream;
+    sub->interval = (ecs_ftime_t)interval / (ecs_ftime_t)1000.0;
+
+    ecs_os_mutex_lock(impl->sub_lock);
+    ecs_rest_subscription_t **elem = ecs_vector_add(
+        &impl->subs_new, ecs_rest_subscription_t*);
+    *elem = sub;
+    ecs_os_mutex_unlock(impl->sub_lock);
 
     return true;
 }
@@ -306,6 +1115,35 @@ void flecs_rest_counter_append(
     flecs_rest_gauge_append(reply, m, field, field_len, t, brief, brief_len);
 }
 
+static
+void flecs_rest_latency_append(
+    ecs_strbuf_t *reply,
+    const ecs_latency_t *l,
+    const char *field,
+    int32_t field_len,
+    int32_t t,
+    const char *brief,
+    int32_t brief_len)
+{
+    ecs_strbuf_list_appendch(reply, '"');
+    ecs_strbuf_appendstrn(reply, field, field_len);
+    ecs_strbuf_appendlit(reply, "\":");
+    ecs_strbuf_list_push(reply, "{", ",");
+
+    flecs_rest_array_append(reply, "p50", l->p50, t);
+    flecs_rest_array_append(reply, "p90", l->p90, t);
+    flecs_rest_array_append(reply, "p99", l->p99, t);
+    flecs_rest_array_append(reply, "p999", l->p999, t);
+
+    if (brief) {
+        ecs_strbuf_list_appendlit(reply, "\"brief\":\"");
+        ecs_strbuf_appendstrn(reply, brief, brief_len);
+        ecs_strbuf_appendch(reply, '"');
+    }
+
+    ecs_strbuf_list_pop(reply, "}");
+}
+
 #define ECS_GAUGE_APPEND_T(reply, s, field, t, brief)\
     flecs_rest_gauge_append(reply, &(s)->field, #field, sizeof(#field) - 1, t, brief, sizeof(brief) - 1)
 
@@ -318,6 +1156,12 @@ void flecs_rest_counter_append(
 #define ECS_COUNTER_APPEND(reply, s, field, brief)\
     ECS_COUNTER_APPEND_T(reply, s, field, (s)->t, brief)
 
+#define ECS_LATENCY_APPEND_T(reply, s, field, t, brief)\
+    flecs_rest_latency_append(reply, &(s)->field, #field, sizeof(#field) - 1, t, brief, sizeof(brief) - 1)
+
+#define ECS_LATENCY_APPEND(reply, s, field, brief)\
+    ECS_LATENCY_APPEND_T(reply, s, field, (s)->t, brief)
+
 static
 void flecs_world_stats_to_json(
     ecs_strbuf_t *reply,
@@ -335,6 +1179,9 @@ void flecs_world_stats_to_json(
     ECS_COUNTER_APPEND(reply, stats, performance.emit_time, "Time spent on notifying observers in frame");
     ECS_COUNTER_APPEND(reply, stats, performance.merge_time, "Time spent on merging commands in frame");
     ECS_COUNTER_APPEND(reply, stats, performance.rematch_time, "Time spent on revalidating query caches in frame");
+    ECS_LATENCY_APPEND(reply, stats, latency.frame_time, "Percentiles of time spent in frame");
+    ECS_LATENCY_APPEND(reply, stats, latency.merge_time, "Percentiles of time spent in merge");
+    ECS_LATENCY_APPEND(reply, stats, latency.sync_time, "Percentiles of time spent in sync points");
 
     ECS_COUNTER_APPEND(reply, stats, commands.add_count, "Add commands executed");
     ECS_COUNTER_APPEND(reply, stats, commands.remove_count, "Remove commands executed");
@@ -363,6 +1210,7 @@ void flecs_world_stats_to_json(
     ECS_GAUGE_APPEND(reply, stats, tables.storage_count, "Component storages for all tables");
     ECS_COUNTER_APPEND(reply, stats, tables.create_count, "Number of new tables created");
     ECS_COUNTER_APPEND(reply, stats, tables.delete_count, "Number of tables deleted");
+    ECS_COUNTER_APPEND(reply, stats, tables.match_count, "Number of table/query match evaluations");
 
     ECS_GAUGE_APPEND(reply, stats, ids.count, "Component, tag and pair ids in use");
     ECS_GAUGE_APPEND(reply, stats, ids.tag_count, "Tag ids in use");
@@ -372,6 +1220,7 @@ void flecs_world_stats_to_json(
     ECS_GAUGE_APPEND(reply, stats, ids.type_count, "Registered component types");
     ECS_COUNTER_APPEND(reply, stats, ids.create_count, "Number of new component, tag and pair ids created");
     ECS_COUNTER_APPEND(reply, stats, ids.delete_count, "Number of component, pair and tag ids deleted");
+    ECS_GAUGE_APPEND(reply, stats, ids.target_index_count, "Entries in relationship target indices");
 
     ECS_GAUGE_APPEND(reply, stats, queries.query_count, "Queries in the world");
     ECS_GAUGE_APPEND(reply, stats, queries.observer_count, "Observers in the world");
@@ -387,6 +1236,7 @@ void flecs_world_stats_to_json(
     ECS_COUNTER_APPEND(reply, stats, memory.stack_alloc_count, "Pages allocated by stack allocators");
     ECS_COUNTER_APPEND(reply, stats, memory.stack_free_count, "Pages freed by stack allocators");
     ECS_GAUGE_APPEND(reply, stats, memory.stack_outstanding_alloc_count, "Outstanding page allocations");
+    ECS_GAUGE_APPEND(reply, stats, memory.target_index_memory, "Memory used by relationship target indices");
     ecs_strbuf_list_pop(reply, "}");
 }
 
@@ -405,9 +1255,25 @@ void flecs_system_stats_to_json(
     if (!stats->task) {
         ECS_GAUGE_APPEND(reply, &stats->query, matched_table_count, "");
         ECS_GAUGE_APPEND(reply, &stats->query, matched_entity_count, "");
+#ifdef FLECS_QUERY_COUNTERS
+        ECS_COUNTER_APPEND(reply, &stats->query, iterated_table_count, "");
+        ECS_COUNTER_APPEND(reply, &stats->query, iterated_entity_count, "");
+        ECS_COUNTER_APPEND(reply, &stats->query, skipped_table_count, "");
+        ECS_COUNTER_APPEND(reply, &stats->query, change_check_count, "");
+        ECS_COUNTER_APPEND(reply, &stats->query, bytes_touched, "");
+        ECS_COUNTER_APPEND(reply, &stats->query, rematch_time, "");
+        ECS_COUNTER_APPEND(reply, &stats->query, sort_time, "");
+#endif
     }
 
     ECS_COUNTER_APPEND_T(reply, stats, time_spent, stats->query.t, "");
+    ECS_LATENCY_APPEND_T(reply, stats, time_latency, stats->query.t, "");
+#ifdef FLECS_PERF_COUNTERS
+    ECS_COUNTER_APPEND_T(reply, stats, cycles, stats->query.t, "");
+    ECS_COUNTER_APPEND_T(reply, stats, instructions, stats->query.t, "");
+    ECS_COUNTER_APPEND_T(reply, stats, cache_misses, stats->query.t, "");
+    ECS_COUNTER_APPEND_T(reply, stats, branch_misses, stats->query.t, "");
+#endif
     ecs_strbuf_list_pop(reply, "}");
 }
 
@@ -482,6 +1348,366 @@ bool flecs_rest_reply_stats(
 
     return true;
 }
+
+/* Metric names are derived from the stats field, so "entities.count" becomes
+ * "flecs_entities_count". */
+static
+void flecs_rest_metric_name(
+    ecs_strbuf_t *reply,
+    const char *field,
+    int32_t field_len)
+{
+    char name[64];
+    ecs_assert(field_len < 64, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t i;
+    for (i = 0; i < field_len; i ++) {
+        char ch = field[i];
+        name[i] = ch == '.' ? '_' : ch;
+    }
+
+    ecs_strbuf_appendlit(reply, "flecs_");
+    ecs_strbuf_appendstrn(reply, name, field_len);
+}
+
+static
+void flecs_rest_metric_family(
+    ecs_strbuf_t *reply,
+    const char *field,
+    int32_t field_len,
+    const char *type,
+    const char *brief,
+    int32_t brief_len)
+{
+    ecs_strbuf_appendlit(reply, "# TYPE ");
+    flecs_rest_metric_name(reply, field, field_len);
+    ecs_strbuf_appendch(reply, ' ');
+    ecs_strbuf_appendstr(reply, type);
+    ecs_strbuf_appendch(reply, '\n');
+
+    if (brief_len) {
+        ecs_strbuf_appendlit(reply, "# HELP ");
+        flecs_rest_metric_name(reply, field, field_len);
+        ecs_strbuf_appendch(reply, ' ');
+        ecs_strbuf_appendstrn(reply, brief, brief_len);
+        ecs_strbuf_appendch(reply, '\n');
+    }
+}
+
+static
+void flecs_rest_metric_value(
+    ecs_strbuf_t *reply,
+    ecs_float_t value)
+{
+    ecs_strbuf_appendch(reply, ' ');
+    ecs_strbuf_appendflt(reply, (double)value, 0);
+    ecs_strbuf_appendch(reply, '\n');
+}
+
+static
+void flecs_rest_gauge_metric(
+    ecs_strbuf_t *reply,
+    const ecs_metric_t *m,
+    const char *field,
+    int32_t field_len,
+    int32_t t,
+    const char *brief,
+    int32_t brief_len)
+{
+    flecs_rest_metric_family(reply, field, field_len, "gauge", 
+        brief, brief_len);
+    flecs_rest_metric_name(reply, field, field_len);
+    flecs_rest_metric_value(reply, m->gauge.avg[t]);
+}
+
+/* Counters hold the running total, the rate is left to the scraper */
+static
+void flecs_rest_counter_metric(
+    ecs_strbuf_t *reply,
+    const ecs_metric_t *m,
+    const char *field,
+    int32_t field_len,
+    int32_t t,
+    const char *brief,
+    int32_t brief_len)
+{
+    flecs_rest_metric_family(reply, field, field_len, "counter", 
+        brief, brief_len);
+    flecs_rest_metric_name(reply, field, field_len);
+    ecs_strbuf_appendlit(reply, "_total");
+    flecs_rest_metric_value(reply, m->counter.value[t]);
+}
+
+static
+void flecs_rest_latency_quantile(
+    ecs_strbuf_t *reply,
+    const char *field,
+    int32_t field_len,
+    const char *quantile,
+    ecs_float_t value)
+{
+    flecs_rest_metric_name(reply, field, field_len);
+    ecs_strbuf_appendlit(reply, "{quantile=\"");
+    ecs_strbuf_appendstr(reply, quantile);
+    ecs_strbuf_appendlit(reply, "\"}");
+    flecs_rest_metric_value(reply, value);
+}
+
+static
+void flecs_rest_latency_metric(
+    ecs_strbuf_t *reply,
+    const ecs_latency_t *l,
+    const char *field,
+    int32_t field_len,
+    int32_t t,
+    const char *brief,
+    int32_t brief_len)
+{
+    flecs_rest_metric_family(reply, field, field_len, "summary", 
+        brief, brief_len);
+    flecs_rest_latency_quantile(reply, field, field_len, "0.5", l->p50[t]);
+    flecs_rest_latency_quantile(reply, field, field_len, "0.9", l->p90[t]);
+    flecs_rest_latency_quantile(reply, field, field_len, "0.99", l->p99[t]);
+    flecs_rest_latency_quantile(reply, field, field_len, "0.999", l->p999[t]);
+}
+
+#define ECS_GAUGE_METRIC(reply, s, field, brief)\
+    flecs_rest_gauge_metric(reply, &(s)->field, #field, sizeof(#field) - 1, (s)->t, brief, sizeof(brief) - 1)
+
+#define ECS_COUNTER_METRIC(reply, s, field, brief)\
+    flecs_rest_counter_metric(reply, &(s)->field, #field, sizeof(#field) - 1, (s)->t, brief, sizeof(brief) - 1)
+
+#define ECS_LATENCY_METRIC(reply, s, field, brief)\
+    flecs_rest_latency_metric(reply, &(s)->field, #field, sizeof(#field) - 1, (s)->t, brief, sizeof(brief) - 1)
+
+static
+void flecs_world_stats_to_metrics(
+    ecs_strbuf_t *reply,
+    const ecs_world_stats_t *stats)
+{
+    ECS_GAUGE_METRIC(reply, stats, entities.count, "Alive entity ids in the world");
+    ECS_GAUGE_METRIC(reply, stats, entities.not_alive_count, "Not alive entity ids in the world");
+
+    ECS_GAUGE_METRIC(reply, stats, performance.fps, "Frames per second");
+    ECS_COUNTER_METRIC(reply, stats, performance.frame_time, "Time spent in frame");
+    ECS_COUNTER_METRIC(reply, stats, performance.system_time, "Time spent on running systems in frame");
+    ECS_COUNTER_METRIC(reply, stats, performance.emit_time, "Time spent on notifying observers in frame");
+    ECS_COUNTER_METRIC(reply, stats, performance.merge_time, "Time spent on merging commands in frame");
+    ECS_COUNTER_METRIC(reply, stats, performance.rematch_time, "Time spent on revalidating query caches in frame");
+    ECS_LATENCY_METRIC(reply, stats, latency.frame_time, "Percentiles of time spent in frame");
+    ECS_LATENCY_METRIC(reply, stats, latency.merge_time, "Percentiles of time spent in merge");
+    ECS_LATENCY_METRIC(reply, stats, latency.sync_time, "Percentiles of time spent in sync points");
+
+    ECS_COUNTER_METRIC(reply, stats, commands.add_count, "Add commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.remove_count, "Remove commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.delete_count, "Delete commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.clear_count, "Clear commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.set_count, "Set commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.get_mut_count, "Get_mut commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.modified_count, "Modified commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.other_count, "Misc commands executed");
+    ECS_COUNTER_METRIC(reply, stats, commands.discard_count, "Commands for already deleted entities");
+    ECS_COUNTER_METRIC(reply, stats, commands.batched_entity_count, "Entities with batched commands");
+    ECS_COUNTER_METRIC(reply, stats, commands.batched_count, "Number of commands batched");
+
+    ECS_COUNTER_METRIC(reply, stats, frame.frame_count, "Frames processed");
+    ECS_COUNTER_METRIC(reply, stats, frame.merge_count, "Number of merges (sync points)");
+    ECS_COUNTER_METRIC(reply, stats, frame.pipeline_build_count, "Pipeline rebuilds (happen when systems become active/enabled)");
+    ECS_COUNTER_METRIC(reply, stats, frame.systems_ran, "Systems ran");
+    ECS_COUNTER_METRIC(reply, stats, frame.observers_ran, "Number of times an observer was invoked");
+    ECS_COUNTER_METRIC(reply, stats, frame.event_emit_count, "Events emitted");
+    ECS_COUNTER_METRIC(reply, stats, frame.rematch_count, "Number of query cache revalidations");
+
+    ECS_GAUGE_METRIC(reply, stats, tables.count, "Tables in the world (including empty)");
+    ECS_GAUGE_METRIC(reply, stats, tables.empty_count, "Empty tables in the world");
+    ECS_GAUGE_METRIC(reply, stats, tables.tag_only_count, "Tables with only tags");
+    ECS_GAUGE_METRIC(reply, stats, tables.trivial_only_count, "Tables with only trivial types (no hooks)");
+    ECS_GAUGE_METRIC(reply, stats, tables.record_count, "Table records registered with search indices");
+    ECS_GAUGE_METRIC(reply, stats, tables.storage_count, "Component storages for all tables");
+    ECS_COUNTER_METRIC(reply, stats, tables.create_count, "Number of new tables created");
+    ECS_COUNTER_METRIC(reply, stats, tables.delete_count, "Number of tables deleted");
+    ECS_COUNTER_METRIC(reply, stats, tables.match_count, "Number of table/query match evaluations");
+
+    ECS_GAUGE_METRIC(reply, stats, ids.count, "Component, tag and pair ids in use");
+    ECS_GAUGE_METRIC(reply, stats, ids.tag_count, "Tag ids in use");
+    ECS_GAUGE_METRIC(reply, stats, ids.component_count, "Component ids in use");
+    ECS_GAUGE_METRIC(reply, stats, ids.pair_count, "Pair ids in use");
+    ECS_GAUGE_METRIC(reply, stats, ids.wildcard_count, "Wildcard ids in use");
+    ECS_GAUGE_METRIC(reply, stats, ids.type_count, "Registered component types");
+    ECS_COUNTER_METRIC(reply, stats, ids.create_count, "Number of new component, tag and pair ids created");
+    ECS_COUNTER_METRIC(reply, stats, ids.delete_count, "Number of component, pair and tag ids deleted");
+    ECS_GAUGE_METRIC(reply, stats, ids.target_index_count, "Entries in relationship target indices");
+
+    ECS_GAUGE_METRIC(reply, stats, queries.query_count, "Queries in the world");
+    ECS_GAUGE_METRIC(reply, stats, queries.observer_count, "Observers in the world");
+    ECS_GAUGE_METRIC(reply, stats, queries.system_count, "Systems in the world");
+
+    ECS_COUNTER_METRIC(reply, stats, memory.alloc_count, "Allocations by OS API");
+    ECS_COUNTER_METRIC(reply, stats, memory.realloc_count, "Reallocs by OS API");
+    ECS_COUNTER_METRIC(reply, stats, memory.free_count, "Frees by OS API");
+    ECS_GAUGE_METRIC(reply, stats, memory.outstanding_alloc_count, "Outstanding allocations by OS API");
+    ECS_COUNTER_METRIC(reply, stats, memory.block_alloc_count, "Blocks allocated by block allocators");
+    ECS_COUNTER_METRIC(reply, stats, memory.block_free_count, "Blocks freed by block allocators");
+    ECS_GAUGE_METRIC(reply, stats, memory.block_outstanding_alloc_count, "Outstanding block allocations");
+    ECS_COUNTER_METRIC(reply, stats, memory.stack_alloc_count, "Pages allocated by stack allocators");
+    ECS_COUNTER_METRIC(reply, stats, memory.stack_free_count, "Pages freed by stack allocators");
+    ECS_GAUGE_METRIC(reply, stats, memory.stack_outstanding_alloc_count, "Outstanding page allocations");
+    ECS_GAUGE_METRIC(reply, stats, memory.target_index_memory, "Memory used by relationship target indices");
+}
+
+/* Label values may not contain unescaped quotes, backslashes or newlines */
+static
+void flecs_rest_metric_system_label(
+    ecs_world_t *world,
+    ecs_strbuf_t *reply,
+    ecs_entity_t system)
+{
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_get_path_w_sep_buf(world, 0, system, ".", NULL, &buf);
+
+    /* Don't allocate for paths that fit in the first element */
+    int32_t i, len = ecs_strbuf_written(&buf);
+    char *path;
+    if (len <= ECS_STRBUF_ELEMENT_SIZE) {
+        path = ecs_strbuf_get_small(&buf);
+    } else {
+        path = ecs_strbuf_get(&buf);
+    }
+
+    ecs_strbuf_appendlit(reply, "{system=\"");
+    for (i = 0; i < len; i ++) {
+        char ch = path[i];
+        if (ch == '"' || ch == '\\') {
+            ecs_strbuf_appendch(reply, '\\');
+            ecs_strbuf_appendch(reply, ch);
+        } else if (ch == '\n') {
+            ecs_strbuf_appendlit(reply, "\\n");
+        } else {
+            ecs_strbuf_appendch(reply, ch);
+        }
+    }
+    ecs_strbuf_appendlit(reply, "\"}");
+
+    if (len <= ECS_STRBUF_ELEMENT_SIZE) {
+        ecs_strbuf_reset(&buf);
+    } else {
+        ecs_os_free(path);
+    }
+}
+
+typedef enum ecs_rest_system_metric_t {
+    EcsRestSystemTimeSpent,
+    EcsRestSystemInvokeCount,
+    EcsRestSystemMatchedTableCount,
+    EcsRestSystemMatchedEntityCount
+} ecs_rest_system_metric_t;
+
+/* All samples of a metric family must be contiguous, so systems are visited
+ * once for each family. */
+static
+void flecs_pipeline_stats_to_metrics(
+    ecs_world_t *world,
+    ecs_strbuf_t *reply,
+    const ecs_pipeline_stats_t *stats,
+    ecs_rest_system_metric_t kind,
+    const char *name,
+    const char *type,
+    const char *brief)
+{
+    bool counter = !ecs_os_strcmp(type, "counter");
+    flecs_rest_metric_family(reply, name, ecs_os_strlen(name), type, 
+        brief, ecs_os_strlen(brief));
+
+    int32_t i, count = ecs_vector_count(stats->systems);
+    ecs_entity_t *ids = ecs_vector_first(stats->systems, ecs_entity_t);
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t id = ids[i];
+        if (!id) {
+            continue; /* Sync point */
+        }
+
+        const ecs_system_stats_t *sys_stats = ecs_map_get(
+            &stats->system_stats, ecs_system_stats_t, id);
+        int32_t t = sys_stats->query.t;
+        ecs_float_t value;
+        switch(kind) {
+        case EcsRestSystemTimeSpent:
+            value = sys_stats->time_spent.counter.value[t];
+            break;
+        case EcsRestSystemInvokeCount:
+            value = sys_stats->invoke_count.counter.value[t];
+            break;
+        case EcsRestSystemMatchedTableCount:
+            if (sys_stats->task) {
+                continue;
+            }
+            value = sys_stats->query.matched_table_count.gauge.avg[t];
+            break;
+        case EcsRestSystemMatchedEntityCount:
+            if (sys_stats->task) {
+                continue;
+            }
+            value = sys_stats->query.matched_entity_count.gauge.avg[t];
+            break;
+        default:
+            continue;
+        }
+
+        flecs_rest_metric_name(reply, name, ecs_os_strlen(name));
+        if (counter) {
+            ecs_strbuf_appendlit(reply, "_total");
+        }
+        flecs_rest_metric_system_label(world, reply, id);
+        flecs_rest_metric_value(reply, value);
+    }
+}
+
+static
+bool flecs_rest_reply_metrics(
+    ecs_world_t *world,
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    (void)req;
+
+    /* Stats are read from the world when replying from the REST thread */
+    world = (ecs_world_t*)ecs_get_world(world);
+
+    const EcsWorldStats *world_stats = ecs_get_pair(world, EcsWorld, 
+        EcsWorldStats, EcsPeriod1s);
+    const EcsPipelineStats *pipeline_stats = ecs_get_pair(world, EcsWorld, 
+        EcsPipelineStats, EcsPeriod1s);
+    if (!world_stats) {
+        flecs_reply_error(reply, "monitor module is not imported");
+        reply->code = 404;
+        return false;
+    }
+
+    reply->content_type = 
+        "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+    ecs_strbuf_t *buf = &reply->body;
+    flecs_world_stats_to_metrics(buf, &world_stats->stats);
+
+    if (pipeline_stats) {
+        const ecs_pipeline_stats_t *stats = &pipeline_stats->stats;
+        flecs_pipeline_stats_to_metrics(world, buf, stats,
+            EcsRestSystemTimeSpent, "system.time_spent", "counter",
+            "Time spent processing a system");
+        flecs_pipeline_stats_to_metrics(world, buf, stats,
+            EcsRestSystemInvokeCount, "system.invoke_count", "counter",
+            "Number of times a system was invoked");
+        flecs_pipeline_stats_to_metrics(world, buf, stats,
+            EcsRestSystemMatchedTableCount, "system.matched_table_count", 
+            "gauge", "Tables matched by a system");
+        flecs_pipeline_stats_to_metrics(world, buf, stats,
+            EcsRestSystemMatchedEntityCount, "system.matched_entity_count", 
+            "gauge", "Entities matched by a system");
+    }
+
+    ecs_strbuf_appendlit(buf, "# EOF\n");
+    return true;
+}
 #else
 static
 bool flecs_rest_reply_stats(
@@ -494,6 +1720,18 @@ bool flecs_rest_reply_stats(
     (void)reply;
     return false;
 }
+
+static
+bool flecs_rest_reply_metrics(
+    ecs_world_t *world,
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    (void)world;
+    (void)req;
+    (void)reply;
+    return false;
+}
 #endif
 
 static
@@ -586,7 +1824,7 @@ bool flecs_rest_reply(
     void *ctx)
 {
     ecs_rest_ctx_t *impl = ctx;
-    ecs_world_t *world = impl->world;
+    ecs_world_t *world = impl->stage ? impl->stage : impl->world;
 
     if (req->path == NULL) {
         ecs_dbg("rest: bad request (missing path)");
@@ -604,12 +1842,20 @@ bool flecs_rest_reply(
         
         /* Query endpoint */
         } else if (!ecs_os_strcmp(req->path, "query")) {
-            return flecs_rest_reply_query(world, req, reply);
+            return flecs_rest_reply_query(impl, world, req, reply);
+
+        /* Subscription endpoint */
+        } else if (!ecs_os_strcmp(req->path, "subscribe")) {
+            return flecs_rest_reply_subscribe(impl, req, reply);
 
         /* Stats endpoint */
         } else if (!ecs_os_strncmp(req->path, "stats/", 6)) {
             return flecs_rest_reply_stats(world, req, reply);
 
+        /* Metrics endpoint */
+        } else if (!ecs_os_strcmp(req->path, "metrics")) {
+            return flecs_rest_reply_metrics(world, req, reply);
+
         /* Tables endpoint */
         } else if (!ecs_os_strncmp(req->path, "tables", 6)) {
             return flecs_rest_reply_tables(world, req, reply);
@@ -622,6 +1868,63 @@ bool flecs_rest_reply(
     return false;
 }
 
+static
+void* flecs_rest_thread(
+    void *arg)
+{
+    ecs_rest_ctx_t *impl = arg;
+    ecs_world_t *world = impl->world;
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+
+    /* Handle requests while the world can be read. Don't hold on to the world
+     * between polls, so the main thread doesn't wait for the REST thread. */
+    while (flecs_reader_begin(world, &impl->reader)) {
+        ecs_ftime_t delta_time = (ecs_ftime_t)ecs_time_measure(&t);
+        ecs_http_server_dequeue(impl->srv, delta_time);
+        flecs_reader_end(world);
+        ecs_os_sleep(0, ECS_REST_POLL_INTERVAL);
+    }
+
+    return NULL;
+}
+
+static
+void flecs_rest_thread_init(
+    ecs_rest_ctx_t *impl)
+{
+    ecs_world_t *world = impl->world;
+    if (!ecs_os_has_threading()) {
+        ecs_warn("rest: threading not available, handling requests on "
+            "main thread");
+        return;
+    }
+
+    /* Requests are handled on an async stage, so iterators don't use the 
+     * allocators of the main thread */
+    impl->stage = ecs_async_stage_new(world);
+    impl->reader = (ecs_reader_t){0};
+    flecs_reader_register(world);
+    impl->thread = ecs_os_thread_new(flecs_rest_thread, impl);
+}
+
+static
+void flecs_rest_thread_fini(
+    ecs_rest_ctx_t *impl)
+{
+    if (!impl->thread) {
+        return;
+    }
+
+    ecs_world_t *world = impl->world;
+    flecs_reader_stop(world, &impl->reader);
+    ecs_os_thread_join(impl->thread);
+    flecs_reader_unregister(world);
+    ecs_async_stage_free(impl->stage);
+    impl->thread = 0;
+    impl->stage = NULL;
+}
+
 static
 void flecs_on_set_rest(ecs_iter_t *it)
 {
@@ -633,7 +1936,7 @@ void flecs_on_set_rest(ecs_iter_t *it)
             rest[i].port = ECS_REST_DEFAULT_PORT;
         }
 
-        ecs_rest_ctx_t *srv_ctx = ecs_os_malloc_t(ecs_rest_ctx_t);
+        ecs_rest_ctx_t *srv_ctx = ecs_os_calloc_t(ecs_rest_ctx_t);
         ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
             .ipaddr = rest[i].ipaddr,
             .port = rest[i].port,
@@ -649,10 +1952,21 @@ void flecs_on_set_rest(ecs_iter_t *it)
             continue;
         }
 
-        srv_ctx->world = it->world;
+        srv_ctx->world = (ecs_world_t*)ecs_get_world(it->world);
         srv_ctx->entity = it->entities[i];
         srv_ctx->srv = srv;
         srv_ctx->rc = 1;
+        srv_ctx->stage = NULL;
+        srv_ctx->thread = 0;
+        srv_ctx->sub_lock = ecs_os_mutex_new();
+        srv_ctx->etag_seed = (uintptr_t)srv_ctx;
+        if (ecs_os_has_time()) {
+            srv_ctx->etag_seed ^= ecs_os_now();
+        }
+
+        if (rest[i].threaded) {
+            flecs_rest_thread_init(srv_ctx);
+        }
 
         rest[i].impl = srv_ctx;
 
@@ -673,12 +1987,26 @@ void DequeueRest(ecs_iter_t *it) {
     int32_t i;
     for(i = 0; i < it->count; i ++) {
         ecs_rest_ctx_t *ctx = rest[i].impl;
-        if (ctx) {
+        if (ctx && !ctx->thread) {
             ecs_http_server_dequeue(ctx->srv, it->delta_time);
         }
     } 
 }
 
+static
+void UpdateRestSubscriptions(ecs_iter_t *it) {
+    EcsRest *rest = ecs_field(it, EcsRest, 1);
+
+    int32_t i;
+    for(i = 0; i < it->count; i ++) {
+        ecs_rest_ctx_t *ctx = rest[i].impl;
+        if (ctx) {
+            flecs_rest_subscriptions_progress(ctx, it->delta_time);
+            flecs_rest_track_tables(ctx);
+        }
+    } 
+}
+
 void FlecsRestImport(
     ecs_world_t *world)
 {
@@ -697,6 +2025,15 @@ void FlecsRestImport(
     });
 
     ECS_SYSTEM(world, DequeueRest, EcsPostFrame, EcsRest);
+
+    /* Subscriptions create queries and tables are enabled for change tracking,
+     * which requires access to the world */
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, {.name = "UpdateRestSubscriptions", .add = { ecs_dependson(EcsPostFrame) }}),
+        .query.filter.terms = {{ .id = ecs_id(EcsRest) }},
+        .callback = UpdateRestSubscriptions,
+        .no_readonly = true
+    });
 }
 
 #endif
@@ -2609,7 +2609,9 @@ ecs_rule_t* ecs_rule_init(
         goto error;
     }
 
-    result->world = world;
+    /* Rules may be created for a stage, but entity lookups during evaluation
+     * require the actual world */
+    result->world = (ecs_world_t*)ecs_get_world(world);
 
     /* Rule has no terms */
     if (!result->filter.term_count) {
@@ -2617,6 +2619,12 @@ ecs_rule_t* ecs_rule_init(
         goto error;
     }
 
+    /* Rules don't evaluate term predicates or member indices */
+    if (ECS_BIT_IS_SET(result->filter.flags, EcsFilterHasPredicates)) {
+        rule_error(result, "rules do not support term predicates");
+        goto error;
+    }
+
     ecs_term_t *terms = result->filter.terms;
     int32_t i, term_count = result->filter.term_count;
 
@@ -2702,6 +2710,13 @@ const ecs_filter_t* ecs_rule_get_filter(
     return &rule->filter; 
 }
 
+ecs_estimate_t ecs_rule_estimate(
+    const ecs_rule_t *rule)
+{
+    ecs_poly_assert(rule, ecs_rule_t);
+    return flecs_filter_estimate(rule->world, &rule->filter, true);
+}
+
 /* Quick convenience function to get a variable from an id */
 static
 ecs_rule_var_t* get_variable(
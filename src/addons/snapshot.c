@@ -166,6 +166,29 @@ ecs_snapshot_t* ecs_snapshot_take_w_iter(
     return result;
 }
 
+/* Add or remove table entities to/from relationship target indices */
+static
+void flecs_snapshot_index_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    bool add)
+{
+    if (!(table->flags & EcsTableHasTargetIndex)) {
+        return;
+    }
+
+    int32_t count = ecs_table_count(table);
+    if (!count) {
+        return;
+    }
+
+    if (add) {
+        flecs_target_index_add(world, table, 0, count, &table->type);
+    } else {
+        flecs_target_index_remove(world, table, 0, count, &table->type);
+    }
+}
+
 /* Restoring an unfiltered snapshot restores the world to the exact state it was
  * when the snapshot was taken. */
 static
@@ -183,6 +206,16 @@ void restore_unfiltered(
     int32_t i, count = (int32_t)flecs_sparse_last_id(&world->store.tables);
     int32_t snapshot_count = ecs_vector_count(snapshot->tables);
 
+    /* Replacing table data doesn't emit events, so remove entities from the
+     * relationship target indices before any table data is restored */
+    for (i = 0; i <= count; i ++) {
+        ecs_table_t *world_table = flecs_sparse_get(
+            &world->store.tables, ecs_table_t, (uint32_t)i);
+        if (world_table) {
+            flecs_snapshot_index_table(world, world_table, false);
+        }
+    }
+
     for (i = 0; i <= count; i ++) {
         ecs_table_t *world_table = flecs_sparse_get(
             &world->store.tables, ecs_table_t, (uint32_t)i);
@@ -208,6 +241,7 @@ void restore_unfiltered(
 
             if (snapshot_table->data) {
                 flecs_table_replace_data(world, table, snapshot_table->data);
+                flecs_snapshot_index_table(world, table, true);
             }
         
         /* If the world table still exists, replace its data */
@@ -218,6 +252,7 @@ void restore_unfiltered(
             if (snapshot_table->data) {
                 flecs_table_replace_data(
                     world, world_table, snapshot_table->data);
+                flecs_snapshot_index_table(world, world_table, true);
             } else {
                 flecs_table_clear_data(
                     world, world_table, &world_table->data);
@@ -296,6 +331,10 @@ void restore_filtered(
             ecs_entity_t e = entities[i];
             ecs_record_t *r = flecs_entities_get(world, e);
             if (r && r->table) {
+                if (r->table->flags & EcsTableHasTargetIndex) {
+                    flecs_target_index_remove(world, r->table, 
+                        ECS_RECORD_TO_ROW(r->row), 1, &r->table->type);
+                }
                 flecs_table_delete(world, r->table, 
                     ECS_RECORD_TO_ROW(r->row), true);
             } else {
@@ -310,6 +349,11 @@ void restore_filtered(
 
         flecs_table_merge(world, table, table, &table->data, snapshot_table->data);
 
+        if (new_count && (table->flags & EcsTableHasTargetIndex)) {
+            flecs_target_index_add(world, table, old_count, new_count, 
+                &table->type);
+        }
+
         /* Run OnSet systems for merged entities */
         if (new_count) {
             flecs_notify_on_set(
@@ -238,6 +238,170 @@ void flecs_stats_copy_last(
     }
 }
 
+#define FLECS_HISTOGRAM_SUB_BITS (3)
+#define FLECS_HISTOGRAM_SUB_COUNT (1 << FLECS_HISTOGRAM_SUB_BITS)
+
+static
+int32_t flecs_histogram_bucket(
+    uint64_t value)
+{
+    if (value < FLECS_HISTOGRAM_SUB_COUNT) {
+        return (int32_t)value;
+    }
+
+    int32_t msb = 0;
+    uint64_t v = value;
+    while (v >>= 1) {
+        msb ++;
+    }
+
+    /* Each power of 2 is split up in SUB_COUNT linear buckets */
+    int32_t shift = msb - FLECS_HISTOGRAM_SUB_BITS;
+    int32_t bucket = (shift + 1) * FLECS_HISTOGRAM_SUB_COUNT + 
+        (int32_t)((value >> shift) & (FLECS_HISTOGRAM_SUB_COUNT - 1));
+    if (bucket >= ECS_HISTOGRAM_BUCKET_COUNT) {
+        bucket = ECS_HISTOGRAM_BUCKET_COUNT - 1;
+    }
+
+    return bucket;
+}
+
+static
+ecs_float_t flecs_histogram_bucket_value(
+    int32_t bucket)
+{
+    /* Return middle of bucket range, in seconds */
+    if (bucket < FLECS_HISTOGRAM_SUB_COUNT) {
+        return ((ecs_float_t)bucket + (ecs_float_t)0.5) / (ecs_float_t)1e6;
+    }
+
+    int32_t shift = bucket / FLECS_HISTOGRAM_SUB_COUNT - 1;
+    int32_t sub = bucket % FLECS_HISTOGRAM_SUB_COUNT;
+    uint64_t lower = (uint64_t)(FLECS_HISTOGRAM_SUB_COUNT + sub) << shift;
+    uint64_t width = (uint64_t)1 << shift;
+    return ((ecs_float_t)lower + (ecs_float_t)width / 2) / (ecs_float_t)1e6;
+}
+
+void flecs_histogram_record(
+    ecs_histogram_t *hist,
+    ecs_ftime_t value)
+{
+    if (value < 0) {
+        value = 0;
+    }
+
+    /* Bucket values are in microseconds */
+    uint64_t us = (uint64_t)((double)value * 1e6);
+    hist->count[flecs_histogram_bucket(us)] ++;
+}
+
+/* Compute percentiles for samples recorded between start and cur */
+static
+void flecs_histogram_percentiles(
+    const ecs_histogram_t *cur,
+    const ecs_histogram_t *start,
+    ecs_latency_t *l,
+    int32_t t)
+{
+    static const double p[] = { 0.5, 0.9, 0.99, 0.999 };
+    ecs_float_t *dst[] = { &l->p50[t], &l->p90[t], &l->p99[t], &l->p999[t] };
+    uint32_t total = 0, rank[4], seen = 0;
+    int32_t i, r = 0;
+
+    for (i = 0; i < ECS_HISTOGRAM_BUCKET_COUNT; i ++) {
+        /* Unsigned arithmetic, so difference is valid after overflow */
+        total += cur->count[i] - start->count[i];
+    }
+
+    for (i = 0; i < 4; i ++) {
+        double frank = p[i] * (double)total;
+        rank[i] = (uint32_t)frank;
+        if ((double)rank[i] < frank) {
+            rank[i] ++;
+        }
+        *dst[i] = 0;
+    }
+
+    if (!total) {
+        return;
+    }
+
+    for (i = 0; i < ECS_HISTOGRAM_BUCKET_COUNT && r < 4; i ++) {
+        seen += cur->count[i] - start->count[i];
+        while (r < 4 && seen >= rank[r]) {
+            *dst[r] = flecs_histogram_bucket_value(i);
+            r ++;
+        }
+    }
+}
+
+static
+void flecs_latency_record(
+    ecs_latency_t *l,
+    int32_t t,
+    const ecs_histogram_t *cur)
+{
+    flecs_histogram_percentiles(cur, &l->last, l, t);
+    l->start = l->last;
+    l->last = *cur;
+}
+
+static
+void flecs_latency_reduce(
+    ecs_latency_t *dst,
+    const ecs_latency_t *src,
+    int32_t t_dst)
+{
+    /* The last histogram of src includes all samples up to now, so samples for
+     * the reduced interval are the ones recorded since the last reduction. */
+    flecs_latency_record(dst, t_dst, &src->last);
+}
+
+static
+void flecs_latency_reduce_last(
+    ecs_latency_t *dst,
+    const ecs_latency_t *src,
+    int32_t t_dst,
+    int32_t t_src)
+{
+    /* Combine the last two measurements by computing the percentiles from the
+     * start of the previous measurement */
+    int32_t t_dst_next = t_next(t_dst);
+    dst->start = src->start;
+    flecs_histogram_percentiles(&dst->last, &dst->start, dst, t_dst);
+
+    /* Restore old value */
+    dst->p50[t_dst_next] = src->p50[t_src];
+    dst->p90[t_dst_next] = src->p90[t_src];
+    dst->p99[t_dst_next] = src->p99[t_src];
+    dst->p999[t_dst_next] = src->p999[t_src];
+}
+
+static
+void flecs_latency_copy(
+    ecs_latency_t *dst,
+    const ecs_latency_t *src,
+    int32_t t_dst,
+    int32_t t_src)
+{
+    dst->p50[t_dst] = src->p50[t_src];
+    dst->p90[t_dst] = src->p90[t_src];
+    dst->p99[t_dst] = src->p99[t_src];
+    dst->p999[t_dst] = src->p999[t_src];
+}
+
+static
+void flecs_latency_copy_last(
+    ecs_latency_t *dst,
+    const ecs_latency_t *src,
+    int32_t t_dst,
+    int32_t t_src)
+{
+    flecs_latency_copy(dst, src, t_dst, t_src);
+    dst->start = src->start;
+    dst->last = src->last;
+}
+
 void ecs_world_stats_get(
     const ecs_world_t *world,
     ecs_world_stats_t *s)
@@ -284,6 +448,7 @@ void ecs_world_stats_get(
     ECS_GAUGE_RECORD(&s->ids.type_count, t, ecs_sparse_count(world->type_info));
     ECS_COUNTER_RECORD(&s->ids.create_count, t, world->info.id_create_total);
     ECS_COUNTER_RECORD(&s->ids.delete_count, t, world->info.id_delete_total);
+    ECS_GAUGE_RECORD(&s->ids.target_index_count, t, world->info.target_index_count);
 
     ECS_GAUGE_RECORD(&s->queries.query_count, t, ecs_count_id(world, EcsQuery));
     ECS_GAUGE_RECORD(&s->queries.observer_count, t, ecs_count_id(world, EcsObserver));
@@ -291,6 +456,7 @@ void ecs_world_stats_get(
 
     ECS_COUNTER_RECORD(&s->tables.create_count, t, world->info.table_create_total);
     ECS_COUNTER_RECORD(&s->tables.delete_count, t, world->info.table_delete_total);
+    ECS_COUNTER_RECORD(&s->tables.match_count, t, world->info.table_match_total);
     ECS_GAUGE_RECORD(&s->tables.count, t, world->info.table_count);
     ECS_GAUGE_RECORD(&s->tables.empty_count, t, world->info.empty_table_count);
     ECS_GAUGE_RECORD(&s->tables.tag_only_count, t, world->info.tag_table_count);
@@ -327,6 +493,12 @@ void ecs_world_stats_get(
     ECS_COUNTER_RECORD(&s->memory.stack_free_count, t, ecs_stack_allocator_free_count);
     ECS_GAUGE_RECORD(&s->memory.stack_outstanding_alloc_count, t, outstanding_allocs);
 
+    ECS_GAUGE_RECORD(&s->memory.target_index_memory, t, world->info.target_index_memory);
+
+    flecs_latency_record(&s->latency.frame_time, t, &world->frame_time_hist);
+    flecs_latency_record(&s->latency.merge_time, t, &world->merge_time_hist);
+    flecs_latency_record(&s->latency.sync_time, t, &world->sync_time_hist);
+
 error:
     return;
 }
@@ -337,6 +509,12 @@ void ecs_world_stats_reduce(
 {
     flecs_stats_reduce(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst), 
         ECS_METRIC_FIRST(src), (dst->t = t_next(dst->t)), src->t);
+    flecs_latency_reduce(&dst->latency.frame_time, 
+        &src->latency.frame_time, dst->t);
+    flecs_latency_reduce(&dst->latency.merge_time, 
+        &src->latency.merge_time, dst->t);
+    flecs_latency_reduce(&dst->latency.sync_time, 
+        &src->latency.sync_time, dst->t);
 }
 
 void ecs_world_stats_reduce_last(
@@ -346,6 +524,12 @@ void ecs_world_stats_reduce_last(
 {
     flecs_stats_reduce_last(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst), 
         ECS_METRIC_FIRST(src), (dst->t = t_prev(dst->t)), src->t, count);
+    flecs_latency_reduce_last(&dst->latency.frame_time, 
+        &src->latency.frame_time, dst->t, src->t);
+    flecs_latency_reduce_last(&dst->latency.merge_time, 
+        &src->latency.merge_time, dst->t, src->t);
+    flecs_latency_reduce_last(&dst->latency.sync_time, 
+        &src->latency.sync_time, dst->t, src->t);
 }
 
 void ecs_world_stats_repeat_last(
@@ -353,6 +537,13 @@ void ecs_world_stats_repeat_last(
 {
     flecs_stats_repeat_last(ECS_METRIC_FIRST(stats), ECS_METRIC_LAST(stats),
         (stats->t = t_next(stats->t)));
+    int32_t prev = t_prev(stats->t);
+    flecs_latency_copy(&stats->latency.frame_time, 
+        &stats->latency.frame_time, stats->t, prev);
+    flecs_latency_copy(&stats->latency.merge_time, 
+        &stats->latency.merge_time, stats->t, prev);
+    flecs_latency_copy(&stats->latency.sync_time, 
+        &stats->latency.sync_time, stats->t, prev);
 }
 
 void ecs_world_stats_copy_last(
@@ -361,6 +552,12 @@ void ecs_world_stats_copy_last(
 {
     flecs_stats_copy_last(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst),
         ECS_METRIC_FIRST(src), dst->t, t_next(src->t));
+    flecs_latency_copy_last(&dst->latency.frame_time, 
+        &src->latency.frame_time, dst->t, t_next(src->t));
+    flecs_latency_copy_last(&dst->latency.merge_time, 
+        &src->latency.merge_time, dst->t, t_next(src->t));
+    flecs_latency_copy_last(&dst->latency.sync_time, 
+        &src->latency.sync_time, dst->t, t_next(src->t));
 }
 
 void ecs_query_stats_get(
@@ -388,6 +585,18 @@ void ecs_query_stats_get(
         ECS_GAUGE_RECORD(&s->matched_empty_table_count, t, 0);
     }
 
+#ifdef FLECS_QUERY_COUNTERS
+    ecs_query_counters_t c;
+    flecs_query_counters_get(ecs_get_world(world), query, &c);
+    ECS_COUNTER_RECORD(&s->iterated_table_count, t, c.table_count);
+    ECS_COUNTER_RECORD(&s->iterated_entity_count, t, c.entity_count);
+    ECS_COUNTER_RECORD(&s->skipped_table_count, t, c.skip_count);
+    ECS_COUNTER_RECORD(&s->change_check_count, t, c.change_check_count);
+    ECS_COUNTER_RECORD(&s->bytes_touched, t, c.bytes_touched);
+    ECS_COUNTER_RECORD(&s->rematch_time, t, c.rematch_time);
+    ECS_COUNTER_RECORD(&s->sort_time, t, c.sort_time);
+#endif
+
 error:
     return;
 }
@@ -449,6 +658,16 @@ bool ecs_system_stats_get(
     ECS_COUNTER_RECORD(&s->invoke_count, t, ptr->invoke_count);
     ECS_GAUGE_RECORD(&s->active, t, !ecs_has_id(world, system, EcsEmpty));
     ECS_GAUGE_RECORD(&s->enabled, t, !ecs_has_id(world, system, EcsDisabled));
+    flecs_latency_record(&s->time_latency, t, &ptr->time_hist);
+
+#ifdef FLECS_PERF_COUNTERS
+    ecs_perf_counters_t perf;
+    flecs_perf_get(world, system, &perf);
+    ECS_COUNTER_RECORD(&s->cycles, t, perf.cycles);
+    ECS_COUNTER_RECORD(&s->instructions, t, perf.instructions);
+    ECS_COUNTER_RECORD(&s->cache_misses, t, perf.cache_misses);
+    ECS_COUNTER_RECORD(&s->branch_misses, t, perf.branch_misses);
+#endif
 
     s->task = !(ptr->query->filter.flags & EcsFilterMatchThis);
 
@@ -465,6 +684,8 @@ void ecs_system_stats_reduce(
     dst->task = src->task;
     flecs_stats_reduce(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst), 
         ECS_METRIC_FIRST(src), dst->query.t, src->query.t);
+    flecs_latency_reduce(&dst->time_latency, &src->time_latency, 
+        dst->query.t);
 }
 
 void ecs_system_stats_reduce_last(
@@ -476,6 +697,8 @@ void ecs_system_stats_reduce_last(
     dst->task = src->task;
     flecs_stats_reduce_last(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst), 
         ECS_METRIC_FIRST(src), dst->query.t, src->query.t, count);
+    flecs_latency_reduce_last(&dst->time_latency, &src->time_latency, 
+        dst->query.t, src->query.t);
 }
 
 void ecs_system_stats_repeat_last(
@@ -484,6 +707,8 @@ void ecs_system_stats_repeat_last(
     ecs_query_stats_repeat_last(&stats->query);
     flecs_stats_repeat_last(ECS_METRIC_FIRST(stats), ECS_METRIC_LAST(stats),
         (stats->query.t));
+    flecs_latency_copy(&stats->time_latency, &stats->time_latency,
+        stats->query.t, t_prev(stats->query.t));
 }
 
 void ecs_system_stats_copy_last(
@@ -494,6 +719,8 @@ void ecs_system_stats_copy_last(
     dst->task = src->task;
     flecs_stats_copy_last(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst),
         ECS_METRIC_FIRST(src), dst->query.t, t_next(src->query.t));
+    flecs_latency_copy_last(&dst->time_latency, &src->time_latency,
+        dst->query.t, t_next(src->query.t));
 }
 
 #endif
@@ -715,6 +942,7 @@ void ecs_world_stats_log(
     flecs_gauge_print("type count", t, &s->ids.type_count);
     flecs_counter_print("id create count", t, &s->ids.create_count);
     flecs_counter_print("id delete count", t, &s->ids.delete_count);
+    flecs_gauge_print("target index count", t, &s->ids.target_index_count);
     ecs_trace("");
     flecs_gauge_print("alive entity count", t, &s->entities.count);
     flecs_gauge_print("not alive entity count", t, &s->entities.not_alive_count);
@@ -731,6 +959,7 @@ void ecs_world_stats_log(
     flecs_gauge_print("table cache record count", t, &s->tables.record_count);
     flecs_counter_print("table create count", t, &s->tables.create_count);
     flecs_counter_print("table delete count", t, &s->tables.delete_count);
+    flecs_counter_print("table match count", t, &s->tables.match_count);
     ecs_trace("");
     flecs_counter_print("add commands", t, &s->commands.add_count);
     flecs_counter_print("remove commands", t, &s->commands.remove_count);
@@ -76,6 +76,13 @@ ecs_entity_t ecs_run_intern(
         stage = &world->stages[0];
     }
 
+    flecs_trace_begin(stage, EcsTraceSystem, system);
+
+#ifdef FLECS_PERF_COUNTERS
+    ecs_perf_counters_t perf_begin;
+    bool measure_perf = measure_time && flecs_perf_read(stage, &perf_begin);
+#endif
+
     /* Prepare the query iterator */
     ecs_iter_t pit, wit, qit = ecs_query_iter(thread_ctx, system_data->query);
     ecs_iter_t *it = &qit;
@@ -88,8 +95,12 @@ ecs_entity_t ecs_run_intern(
     }
 
     if (stage_count > 1 && system_data->multi_threaded) {
-        wit = ecs_worker_iter(it, stage_index, stage_count);
-        it = &wit;
+        if (system_data->multi_threaded_groups) {
+            ecs_query_set_group_worker(&qit, stage_index, stage_count);
+        } else {
+            wit = ecs_worker_iter(it, stage_index, stage_count);
+            it = &wit;
+        }
     }
 
     qit.system = system;
@@ -112,7 +123,11 @@ ecs_entity_t ecs_run_intern(
                 action(&qit);
             }
         } else {
+            /* The query iterator of each worker visits all tables, so count 
+             * the results the system actually processes. */
+            qit.priv.iter.query.skip_counters = true;
             while (ecs_iter_next(it)) {
+                flecs_query_count_result(system_data->query, it);
                 action(it);
             }
         }
@@ -121,13 +136,30 @@ ecs_entity_t ecs_run_intern(
     }
 
     if (measure_time) {
-        system_data->time_spent += (float)ecs_time_measure(&time_start);
+        ecs_ftime_t time_spent = (ecs_ftime_t)ecs_time_measure(&time_start);
+        system_data->time_spent += (float)time_spent;
+
+        /* Only record latency on the main thread, so that each sample is an 
+         * invocation and not a slice of a multi threaded invocation. Workers
+         * run in parallel, so the slice of the main thread approximates the
+         * duration of the invocation. */
+        if (!stage_index) {
+            flecs_histogram_record(&system_data->time_hist, time_spent);
+        }
     }
 
+#ifdef FLECS_PERF_COUNTERS
+    if (measure_perf) {
+        flecs_perf_record(stage, system, &perf_begin);
+    }
+#endif
+
     system_data->invoke_count ++;
 
     flecs_defer_end(world, stage);
 
+    flecs_trace_end(stage, EcsTraceSystem, system);
+
     return it->interrupted_by;
 }
 
@@ -277,6 +309,13 @@ ecs_entity_t ecs_system_init(
         system->multi_threaded = desc->multi_threaded;
         system->no_readonly = desc->no_readonly;
 
+        if (desc->multi_threaded_groups) {
+            ecs_assert(query->group_by != NULL, ECS_INVALID_PARAMETER, 
+                "multi_threaded_groups requires group_by");
+            system->multi_threaded = true;
+            system->multi_threaded_groups = true;
+        }
+
         if (desc->interval != 0 || desc->rate != 0 || desc->tick_source != 0) {
 #ifdef FLECS_TIMER
             if (desc->interval != 0) {
@@ -320,6 +359,12 @@ ecs_entity_t ecs_system_init(
         if (desc->multi_threaded) {
             system->multi_threaded = desc->multi_threaded;
         }
+        if (desc->multi_threaded_groups) {
+            ecs_check(system->query->group_by != NULL, ECS_INVALID_PARAMETER,
+                "multi_threaded_groups requires group_by");
+            system->multi_threaded = true;
+            system->multi_threaded_groups = true;
+        }
         if (desc->no_readonly) {
             system->no_readonly = desc->no_readonly;
         }
@@ -22,10 +22,14 @@ typedef struct ecs_system_t {
     
     /* Schedule parameters */
     bool multi_threaded;
+    bool multi_threaded_groups;
     bool no_readonly;
 
     int64_t invoke_count;           /* Number of times system is invoked */
     float time_spent;               /* Time spent on running system */
+#ifdef FLECS_STATS
+    ecs_histogram_t time_hist;      /* Time spent per invocation */
+#endif
     ecs_ftime_t time_passed;        /* Time passed since last invocation */
     int64_t last_frame;             /* Last frame for which the system was considered */
 
@@ -0,0 +1,221 @@
+/**
+ * @file addons/tracing.c
+ * @brief Tracing addon.
+ */
+
+#include "../private_api.h"
+
+#ifdef FLECS_TRACING
+
+static
+const char* flecs_trace_kind_str(
+    int32_t kind)
+{
+    switch(kind) {
+    case EcsTraceFrame: return "frame";
+    case EcsTracePipelineOp: return "pipeline";
+    case EcsTraceSystem: return "system";
+    case EcsTraceMerge: return "merge";
+    case EcsTraceWorkerSync: return "sync";
+    case EcsTraceObserver: return "observer";
+    default: return "unknown";
+    }
+}
+
+void flecs_trace_stage_init(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    int32_t size = world->trace_size;
+    if (!size) {
+        stage->trace = NULL;
+        return;
+    }
+
+    ecs_trace_buffer_t *trace = ecs_os_calloc_t(ecs_trace_buffer_t);
+    trace->events = ecs_os_malloc_n(ecs_trace_event_t, size);
+    trace->size = size;
+    trace->head = 0;
+    stage->trace = trace;
+}
+
+void flecs_trace_stage_fini(
+    ecs_stage_t *stage)
+{
+    ecs_trace_buffer_t *trace = stage->trace;
+    if (trace) {
+        ecs_os_free(trace->events);
+        ecs_os_free(trace);
+        stage->trace = NULL;
+    }
+}
+
+void flecs_trace_record(
+    ecs_stage_t *stage,
+    ecs_trace_kind_t kind,
+    ecs_entity_t entity,
+    bool begin)
+{
+    ecs_trace_buffer_t *trace = stage->trace;
+    ecs_trace_event_t *ev = &trace->events[
+        trace->head & (uint64_t)(trace->size - 1)];
+    ev->time = ecs_os_now();
+    ev->entity = entity;
+    ev->kind = kind;
+    ev->begin = begin;
+    trace->head ++;
+}
+
+void ecs_tracing_start(
+    ecs_world_t *world,
+    int32_t event_count)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(event_count >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_os_has_time(), ECS_MISSING_OS_API, "now");
+    ecs_check(!(world->flags & EcsWorldReadonly), ECS_INVALID_OPERATION, NULL);
+
+    if (!event_count) {
+        event_count = ECS_TRACING_DEFAULT_EVENT_COUNT;
+    }
+
+    /* Round up to power of 2, so ring buffer index can be computed with mask */
+    int32_t size = 1;
+    while (size < event_count) {
+        size <<= 1;
+    }
+
+    ecs_tracing_stop(world);
+
+    world->trace_size = size;
+    world->trace_start = ecs_os_now();
+
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        flecs_trace_stage_init(world, &world->stages[i]);
+    }
+error:
+    return;
+}
+
+void ecs_tracing_stop(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(!(world->flags & EcsWorldReadonly), ECS_INVALID_OPERATION, NULL);
+
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        flecs_trace_stage_fini(&world->stages[i]);
+    }
+
+    world->trace_size = 0;
+error:
+    return;
+}
+
+bool ecs_tracing_enabled(
+    const ecs_world_t *world)
+{
+    world = ecs_get_world(world);
+    return world->trace_size != 0;
+}
+
+static
+void flecs_trace_name_to_json(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    const ecs_trace_event_t *ev)
+{
+    ecs_strbuf_appendch(buf, '"');
+
+    if (ev->entity && ecs_is_alive(world, ev->entity)) {
+        char *path = ecs_get_fullpath(world, ev->entity);
+        const char *ptr;
+        for (ptr = path; *ptr; ptr ++) {
+            char ch = *ptr;
+            if (ch == '"' || ch == '\\') {
+                ecs_strbuf_appendch(buf, '\\');
+            }
+            ecs_strbuf_appendch(buf, ch);
+        }
+        ecs_os_free(path);
+    } else if (ev->entity) {
+        ecs_strbuf_append(buf, "#%u", (uint32_t)ev->entity);
+    } else {
+        ecs_strbuf_appendstr(buf, flecs_trace_kind_str(ev->kind));
+    }
+
+    ecs_strbuf_appendch(buf, '"');
+}
+
+static
+void flecs_trace_stage_to_json(
+    const ecs_world_t *world,
+    ecs_strbuf_t *buf,
+    const ecs_stage_t *stage)
+{
+    const ecs_trace_buffer_t *trace = stage->trace;
+    uint64_t mask = (uint64_t)(trace->size - 1);
+    uint64_t i = 0, head = trace->head;
+    if (head > (uint64_t)trace->size) {
+        i = head - (uint64_t)trace->size;
+    }
+
+    ecs_strbuf_list_next(buf);
+    ecs_strbuf_append(buf,
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,"
+        "\"args\":{\"name\":\"%s %d\"}}", stage->id,
+            stage->id ? "worker" : "main", stage->id);
+
+    /* When the ring buffer wrapped around, the first events may end scopes
+     * for which the begin event was overwritten. Don't emit those. */
+    int32_t depth = 0;
+    for (; i < head; i ++) {
+        const ecs_trace_event_t *ev = &trace->events[i & mask];
+        if (ev->begin) {
+            depth ++;
+        } else if (!depth) {
+            continue;
+        } else {
+            depth --;
+        }
+
+        uint64_t time = ev->time - world->trace_start;
+        ecs_strbuf_list_next(buf);
+        ecs_strbuf_appendlit(buf, "{\"name\":");
+        flecs_trace_name_to_json(world, buf, ev);
+        ecs_strbuf_append(buf,
+            ",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":0,"
+            "\"tid\":%d}", flecs_trace_kind_str(ev->kind), 
+                ev->begin ? 'B' : 'E', (unsigned long long)(time / 1000), 
+                (uint32_t)(time % 1000), stage->id);
+    }
+}
+
+char* ecs_tracing_to_json(
+    const ecs_world_t *world)
+{
+    world = ecs_get_world(world);
+    if (!world->trace_size) {
+        return NULL;
+    }
+
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_strbuf_appendlit(&buf, "{\"traceEvents\":");
+    ecs_strbuf_list_push(&buf, "[", ",");
+
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        const ecs_stage_t *stage = &world->stages[i];
+        if (stage->trace) {
+            flecs_trace_stage_to_json(world, &buf, stage);
+        }
+    }
+
+    ecs_strbuf_list_pop(&buf, "]");
+    ecs_strbuf_appendlit(&buf, ",\"displayTimeUnit\":\"ms\"}");
+    return ecs_strbuf_get(&buf);
+}
+
+#endif
@@ -323,6 +323,17 @@ void flecs_register_union(ecs_iter_t *it) {
     flecs_register_id_flag_for_relation(it, EcsUnion, EcsIdUnion, 0, 0);
 }
 
+static
+void flecs_register_target_index(ecs_iter_t *it) {
+    flecs_register_id_flag_for_relation(it, EcsTargetIndex, EcsIdTargetIndex, 
+        0, 0);
+
+    int i, count = it->count;
+    for (i = 0; i < count; i ++) {
+        flecs_target_index_ensure(it->world, it->entities[i]);
+    }
+}
+
 static
 void flecs_register_slot_of(ecs_iter_t *it) {
     int i, count = it->count;
@@ -770,6 +781,7 @@ void flecs_bootstrap(
     flecs_bootstrap_tag(world, EcsAcyclic);
     flecs_bootstrap_tag(world, EcsWith);
     flecs_bootstrap_tag(world, EcsOneOf);
+    flecs_bootstrap_tag(world, EcsTargetIndex);
 
     flecs_bootstrap_tag(world, EcsOnDelete);
     flecs_bootstrap_tag(world, EcsOnDeleteTarget);
@@ -900,6 +912,12 @@ void flecs_bootstrap(
         .callback = flecs_register_union
     });
 
+    ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ .id = EcsTargetIndex, .src.flags = EcsSelf }, match_prefab },
+        .events = {EcsOnAdd},
+        .callback = flecs_register_target_index
+    });
+
     /* Entities used as slot are marked as exclusive to ensure a slot can always
      * only point to a single entity. */
     ecs_observer_init(world, &(ecs_observer_desc_t){
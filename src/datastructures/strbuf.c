@@ -27,8 +27,7 @@ static const double rounders[MAX_PRECISION + 1] =
 	0.00000000005		// 10
 };
 
-static
-char* flecs_strbuf_itoa(
+char* flecs_itoa(
     char *buf,
     int64_t v)
 {
@@ -39,19 +38,21 @@ char* flecs_strbuf_itoa(
 	if (!v) {
 		*ptr++ = '0';
     } else {
+        /* Negate as unsigned, so that INT64_MIN doesn't overflow */
+        uint64_t uv = (uint64_t)v;
         if (v < 0) {
             ptr[0] = '-';
             ptr ++;
-            v *= -1;
+            uv = 0 - uv;
         }
 
 		char *p = ptr;
-		while (v) {
-            int64_t vdiv = v / 10;
-            int64_t vmod = v - (vdiv * 10);
+		while (uv) {
+            uint64_t vdiv = uv / 10;
+            uint64_t vmod = uv - (vdiv * 10);
 			p[0] = (char)('0' + vmod);
             p ++;
-			v = vdiv;
+			uv = vdiv;
 		}
 
 		p1 = p;
@@ -67,35 +68,38 @@ char* flecs_strbuf_itoa(
 }
 
 static
-int flecs_strbuf_ftoa(
-    ecs_strbuf_t *out, 
+char* flecs_ftoa_special(
+    char *ptr,
+    const char *value,
+    char nan_delim)
+{
+    if (nan_delim) {
+        *ptr++ = nan_delim;
+    }
+    ecs_os_memcpy(ptr, value, 3);
+    ptr += 3;
+    if (nan_delim) {
+        *ptr++ = nan_delim;
+    }
+    return ptr;
+}
+
+char* flecs_ftoa(
+    char *buf,
     double f, 
     int precision,
     char nan_delim)
 {
-    char buf[64];
 	char * ptr = buf;
 	char c;
 	int64_t intPart;
     int64_t exp = 0;
 
     if (isnan(f)) {
-        if (nan_delim) {
-            ecs_strbuf_appendch(out, nan_delim);
-            ecs_strbuf_appendlit(out, "NaN");
-            return ecs_strbuf_appendch(out, nan_delim);
-        } else {
-            return ecs_strbuf_appendlit(out, "NaN");
-        }
+        return flecs_ftoa_special(buf, "NaN", nan_delim);
     }
     if (isinf(f)) {
-        if (nan_delim) {
-            ecs_strbuf_appendch(out, nan_delim);
-            ecs_strbuf_appendlit(out, "Inf");
-            return ecs_strbuf_appendch(out, nan_delim);
-        } else {
-            return ecs_strbuf_appendlit(out, "Inf");
-        }
+        return flecs_ftoa_special(buf, "Inf", nan_delim);
     }
 
 	if (precision > MAX_PRECISION) {
@@ -130,7 +134,7 @@ int flecs_strbuf_ftoa(
 	intPart = (int64_t)f;
 	f -= (double)intPart;
 
-    ptr = flecs_strbuf_itoa(ptr, intPart);
+    ptr = flecs_itoa(ptr, intPart);
 
 	if (precision) {
 		*ptr++ = '.';
@@ -192,7 +196,7 @@ int flecs_strbuf_ftoa(
 
 
         ptr[0] = 'e';
-        ptr = flecs_strbuf_itoa(ptr + 1, exp);
+        ptr = flecs_itoa(ptr + 1, exp);
 
         if (nan_delim) {
             ptr[0] = nan_delim;
@@ -202,6 +206,18 @@ int flecs_strbuf_ftoa(
         ptr[0] = '\0';
     }
     
+    return ptr;
+}
+
+static
+int flecs_strbuf_ftoa(
+    ecs_strbuf_t *out, 
+    double f, 
+    int precision,
+    char nan_delim)
+{
+    char buf[64];
+    char *ptr = flecs_ftoa(buf, f, precision, nan_delim);
     return ecs_strbuf_appendstrn(out, buf, (int32_t)(ptr - buf));
 }
 
@@ -491,6 +507,51 @@ bool ecs_strbuf_appendstrn(
     return flecs_strbuf_appendstr(b, str, len);
 }
 
+bool ecs_strbuf_appendbin(
+    ecs_strbuf_t *b,
+    const void* data,
+    int32_t n)
+{
+    ecs_assert(b != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(data != NULL || !n, ECS_INVALID_PARAMETER, NULL);
+    flecs_strbuf_init(b);
+
+    int32_t memLeftInElement = flecs_strbuf_memLeftInCurrentElement(b);
+    int32_t memLeft = flecs_strbuf_memLeft(b);
+    if (memLeft <= 0) {
+        return false;
+    }
+
+    /* Never write more than what the buffer can store */
+    if (n > memLeft) {
+        n = memLeft;
+    }
+
+    /* Same as flecs_strbuf_appendstr, but data can contain \0 characters */
+    const char *ptr = data;
+    if (n <= memLeftInElement) {
+        ecs_os_memcpy(flecs_strbuf_ptr(b), ptr, n);
+        b->current->pos += n;
+    } else {
+        ecs_os_memcpy(flecs_strbuf_ptr(b), ptr, memLeftInElement);
+        b->current->pos += memLeftInElement;
+        ptr += memLeftInElement;
+        n -= memLeftInElement;
+
+        if (n < ECS_STRBUF_ELEMENT_SIZE) {
+            flecs_strbuf_grow(b);
+            ecs_os_memcpy(flecs_strbuf_ptr(b), ptr, n);
+            b->current->pos += n;
+        } else {
+            char *remainder = ecs_os_malloc(n);
+            ecs_os_memcpy(remainder, ptr, n);
+            flecs_strbuf_grow_str(b, remainder, remainder, n);
+        }
+    }
+
+    return flecs_strbuf_memLeft(b) > 0;
+}
+
 bool ecs_strbuf_appendch(
     ecs_strbuf_t *b,
     char ch)
@@ -505,7 +566,7 @@ bool ecs_strbuf_appendint(
 {
     ecs_assert(b != NULL, ECS_INVALID_PARAMETER, NULL); 
     char numbuf[32];
-    char *ptr = flecs_strbuf_itoa(numbuf, v);
+    char *ptr = flecs_itoa(numbuf, v);
     return ecs_strbuf_appendstrn(b, numbuf, flecs_ito(int32_t, ptr - numbuf));
 }
 
@@ -557,16 +618,30 @@ bool ecs_strbuf_mergebuff(
     if (src_buffer->elementCount) {
         if (src_buffer->buf) {
             return ecs_strbuf_appendstrn(
-                dst_buffer, src_buffer->buf, src_buffer->length);
+                dst_buffer, src_buffer->buf, src_buffer->current->pos);
         } else {
             ecs_strbuf_element *e = (ecs_strbuf_element*)&src_buffer->firstElement;
 
             /* Copy first element as it is inlined in the src buffer */
             ecs_strbuf_appendstrn(dst_buffer, e->buf, e->pos);
 
-            while ((e = e->next)) {
-                dst_buffer->current->next = ecs_os_malloc(sizeof(ecs_strbuf_element));
-                *dst_buffer->current->next = *e;
+            if (e->next) {
+                if (dst_buffer->buf) {
+                    /* Can't link elements into application buffer */
+                    while ((e = e->next)) {
+                        ecs_strbuf_appendstrn(dst_buffer, e->buf, e->pos);
+                    }
+                    ecs_strbuf_reset(src_buffer);
+                    return true;
+                }
+
+                /* Move remaining elements to the destination buffer */
+                flecs_strbuf_init(dst_buffer);
+                dst_buffer->size += dst_buffer->current->pos + 
+                    src_buffer->size - e->pos;
+                dst_buffer->current->next = e->next;
+                dst_buffer->current = src_buffer->current;
+                dst_buffer->elementCount += src_buffer->elementCount - 1;
             }
         }
 
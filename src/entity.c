@@ -520,6 +520,10 @@ void flecs_notify_on_add(
             flecs_set_union(world, table, row, count, added);
         }
 
+        if (table_flags & EcsTableHasTargetIndex) {
+            flecs_target_index_add(world, table, row, count, added);
+        }
+
         if (table_flags & (EcsTableHasOnAdd|EcsTableHasIsA|EcsTableHasObserved)) {
             flecs_emit(world, world, &(ecs_event_desc_t){
                 .event = EcsOnAdd,
@@ -559,6 +563,10 @@ void flecs_notify_on_remove(
             .observable = world
         });
     }
+
+    if (removed->count && (table->flags & EcsTableHasTargetIndex)) {
+        flecs_target_index_remove(world, table, row, count, removed);
+    }
 }
 
 static
@@ -2848,7 +2856,7 @@ void flecs_modified_id_if(
     ecs_type_t ids = { .array = &id, .count = 1 };
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
-    flecs_table_mark_dirty(world, table, id);
+    flecs_table_mark_dirty(world, table, id, ECS_RECORD_TO_ROW(r->row));
     flecs_defer_end(world, stage);
 error:
     return;
@@ -2880,7 +2888,7 @@ void ecs_modified_id(
     ecs_type_t ids = { .array = &id, .count = 1 };
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
-    flecs_table_mark_dirty(world, table, id);
+    flecs_table_mark_dirty(world, table, id, ECS_RECORD_TO_ROW(r->row));
     flecs_defer_end(world, stage);
 error:
     return;
@@ -2917,7 +2925,7 @@ void flecs_copy_ptr_w_id(
         ecs_os_memset(dst.ptr, 0, size);
     }
 
-    flecs_table_mark_dirty(world, r->table, id);
+    flecs_table_mark_dirty(world, r->table, id, ECS_RECORD_TO_ROW(r->row));
 
     ecs_table_t *table = r->table;
     if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
@@ -2965,7 +2973,7 @@ void flecs_move_ptr_w_id(
         ecs_os_memcpy(dst.ptr, ptr, flecs_utosize(size));
     }
 
-    flecs_table_mark_dirty(world, r->table, id);
+    flecs_table_mark_dirty(world, r->table, id, ECS_RECORD_TO_ROW(r->row));
 
     if (cmd_kind == EcsOpSet) {
         ecs_table_t *table = r->table;
@@ -3220,6 +3228,31 @@ ecs_entity_t ecs_get_target_for_id(
     }
 }
 
+const ecs_entity_t* ecs_get_sources(
+    const ecs_world_t *world,
+    ecs_entity_t rel,
+    ecs_entity_t target,
+    int32_t *count_out)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(rel != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(target != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count_out != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    world = ecs_get_world(world);
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, 
+        ecs_pair(rel, EcsWildcard));
+    if (!idr || !idr->target_index) {
+        *count_out = 0;
+        return NULL;
+    }
+
+    return flecs_target_index_get(idr->target_index, target, count_out);
+error:
+    return NULL;
+}
+
 static
 const char* flecs_get_identifier(
     const ecs_world_t *world,
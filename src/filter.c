@@ -636,6 +636,158 @@ int flecs_term_finalize(
     return 0;
 }
 
+#ifdef FLECS_META
+static
+ecs_predicate_kind_t flecs_predicate_kind_from_type(
+    const ecs_world_t *world,
+    ecs_entity_t type)
+{
+    const EcsPrimitive *p = ecs_get(world, type, EcsPrimitive);
+    if (p) {
+        switch(p->kind) {
+        case EcsBool:   return EcsPredicateU8;
+        case EcsChar:   return EcsPredicateI8;
+        case EcsByte:   return EcsPredicateU8;
+        case EcsU8:     return EcsPredicateU8;
+        case EcsU16:    return EcsPredicateU16;
+        case EcsU32:    return EcsPredicateU32;
+        case EcsU64:    return EcsPredicateU64;
+        case EcsI8:     return EcsPredicateI8;
+        case EcsI16:    return EcsPredicateI16;
+        case EcsI32:    return EcsPredicateI32;
+        case EcsI64:    return EcsPredicateI64;
+        case EcsF32:    return EcsPredicateF32;
+        case EcsF64:    return EcsPredicateF64;
+        case EcsEntity: return EcsPredicateU64;
+        case EcsUPtr:   
+            return ECS_SIZEOF(uintptr_t) == 8 ? 
+                EcsPredicateU64 : EcsPredicateU32;
+        case EcsIPtr:   
+            return ECS_SIZEOF(intptr_t) == 8 ? 
+                EcsPredicateI64 : EcsPredicateI32;
+        default:
+            return EcsPredicateNone;
+        }
+    }
+
+    if (ecs_has(world, type, EcsEnum)) {
+        return EcsPredicateI32;
+    }
+
+    if (ecs_has(world, type, EcsBitmask)) {
+        return EcsPredicateU32;
+    }
+
+    return EcsPredicateNone;
+}
+#endif
+
+static
+int flecs_term_finalize_predicate(
+    const ecs_world_t *world,
+    ecs_term_t *term,
+    ecs_filter_finalize_ctx_t *ctx)
+{
+    ecs_term_predicate_t *pred = &term->predicate;
+    if (!pred->member && !pred->kind) {
+        return 0;
+    }
+
+    ecs_entity_t type = ecs_get_typeid(world, term->id);
+    const ecs_type_info_t *ti = type ? ecs_get_type_info(world, type) : NULL;
+    if (!ti) {
+        flecs_filter_error(ctx, "predicate requires a component");
+        return -1;
+    }
+
+    if (pred->member) {
+#ifdef FLECS_META
+        ecs_entity_t member_type = 0;
+        if (ecs_meta_member_offset(world, type, pred->member, &pred->offset, 
+            &member_type))
+        {
+            flecs_filter_error(ctx, "unknown member '%s' for predicate", 
+                pred->member);
+            return -1;
+        }
+
+        pred->kind = flecs_predicate_kind_from_type(world, member_type);
+        if (!pred->kind) {
+            flecs_filter_error(ctx, "member '%s' cannot be used in predicate",
+                pred->member);
+            return -1;
+        }
+
+        /* Member is resolved, don't hold on to the (not owned) name */
+        pred->member = NULL;
+#else
+        flecs_filter_error(ctx, "predicates with member require FLECS_META");
+        return -1;
+#endif
+    }
+
+    if (term->oper != EcsAnd) {
+        flecs_filter_error(ctx, "predicate requires a term with And operator");
+        return -1;
+    }
+
+    if (ecs_term_match_0(term)) {
+        flecs_filter_error(ctx, "predicate requires a term with a source");
+        return -1;
+    }
+
+    if (pred->kind < EcsPredicateI8 || pred->kind > EcsPredicateF64) {
+        flecs_filter_error(ctx, "invalid predicate kind");
+        return -1;
+    }
+
+    if (pred->op < EcsPredicateEq || pred->op > EcsPredicateMaskNone) {
+        flecs_filter_error(ctx, "invalid predicate operation");
+        return -1;
+    }
+
+    if (pred->op >= EcsPredicateMaskAny && pred->kind >= EcsPredicateF32) {
+        flecs_filter_error(ctx, "mask predicate requires an integer value");
+        return -1;
+    }
+
+    static const ecs_size_t kind_size[] = {
+        [EcsPredicateI8] = 1, [EcsPredicateI16] = 2, 
+        [EcsPredicateI32] = 4, [EcsPredicateI64] = 8,
+        [EcsPredicateU8] = 1, [EcsPredicateU16] = 2, 
+        [EcsPredicateU32] = 4, [EcsPredicateU64] = 8,
+        [EcsPredicateF32] = 4, [EcsPredicateF64] = 8
+    };
+
+    if (pred->offset < 0 || (pred->offset + kind_size[pred->kind]) > ti->size) {
+        flecs_filter_error(ctx, "predicate value is out of component bounds");
+        return -1;
+    }
+
+    if (pred->index) {
+#ifdef FLECS_META
+        if (!ecs_term_match_this(term) || (term->src.flags & EcsUp)) {
+            flecs_filter_error(ctx, 
+                "predicate with index requires a term that matches $this "
+                "with self");
+            return -1;
+        }
+
+        if (flecs_member_index_iter_predicate(
+            world, pred->index, type, pred, NULL)) 
+        {
+            flecs_filter_error(ctx, "index cannot be used for predicate");
+            return -1;
+        }
+#else
+        flecs_filter_error(ctx, "predicates with index require FLECS_META");
+        return -1;
+#endif
+    }
+
+    return 0;
+}
+
 ecs_id_t flecs_to_public_id(
     ecs_id_t id)
 {
@@ -651,10 +803,14 @@ ecs_id_t flecs_from_public_id(
     ecs_id_t id)
 {
     if (ECS_HAS_ID_FLAG(id, PAIR)) {
+        /* Don't create the id record, so this can be used by threads that
+         * only read the world */
         ecs_entity_t first = ECS_PAIR_FIRST(id);
-        ecs_id_record_t *idr = flecs_id_record_ensure(world, 
+        ecs_id_record_t *idr = flecs_id_record_get(world, 
             ecs_pair(first, EcsWildcard));
-        if (idr->flags & EcsIdUnion) {
+        bool is_union = idr ? (idr->flags & EcsIdUnion) != 0 :
+            ecs_has_id(world, first, EcsUnion);
+        if (is_union) {
             return ecs_pair(EcsUnion, first);
         }
     }
@@ -896,6 +1052,10 @@ int ecs_filter_finalize(
             return -1;
         }
 
+        if (flecs_term_finalize_predicate(world, term, &ctx)) {
+            return -1;
+        }
+
         is_or = term->oper == EcsOr;
         field_count += !(is_or && prev_or);
         term->field_index = field_count - 1;
@@ -921,6 +1081,10 @@ int ecs_filter_finalize(
             ECS_BIT_CLEAR(f->flags, EcsFilterMatchOnlyThis);
         }
 
+        if (term->predicate.kind) {
+            ECS_BIT_SET(f->flags, EcsFilterHasPredicates);
+        }
+
         if (term->id == EcsPrefab) {
             ECS_BIT_SET(f->flags, EcsFilterMatchPrefab);
         }
@@ -1719,6 +1883,176 @@ bool flecs_filter_match_table(
     return !is_or || or_result;
 }
 
+/* Predicates are evaluated in blocks of rows. The compare loops don't branch
+ * and write to a selection buffer, which lets compilers vectorize them. */
+#define FLECS_PREDICATE_TEST(T, expr)\
+    for (i = 0; i < count; i ++) {\
+        T v = *(const T*)ECS_ELEM(ptr, stride, i);\
+        sel[i] &= (uint8_t)(expr);\
+    }
+
+#define FLECS_PREDICATE_CMP(T)\
+    case EcsPredicateEq:   { FLECS_PREDICATE_TEST(T, v == c) } break;\
+    case EcsPredicateNeq:  { FLECS_PREDICATE_TEST(T, v != c) } break;\
+    case EcsPredicateLt:   { FLECS_PREDICATE_TEST(T, v < c) } break;\
+    case EcsPredicateLtEq: { FLECS_PREDICATE_TEST(T, v <= c) } break;\
+    case EcsPredicateGt:   { FLECS_PREDICATE_TEST(T, v > c) } break;\
+    case EcsPredicateGtEq: { FLECS_PREDICATE_TEST(T, v >= c) } break;
+
+#define FLECS_PREDICATE_INT(T) {\
+        T c = (T)pred->value, m = (T)pred->mask;\
+        switch(pred->op) {\
+        FLECS_PREDICATE_CMP(T)\
+        case EcsPredicateMaskAny:  { FLECS_PREDICATE_TEST(T, (v & m) != 0) } break;\
+        case EcsPredicateMaskAll:  { FLECS_PREDICATE_TEST(T, (v & m) == m) } break;\
+        case EcsPredicateMaskNone: { FLECS_PREDICATE_TEST(T, (v & m) == 0) } break;\
+        }\
+    }
+
+#define FLECS_PREDICATE_FLOAT(T) {\
+        T c = (T)pred->value;\
+        switch(pred->op) {\
+        FLECS_PREDICATE_CMP(T)\
+        default: ecs_abort(ECS_INTERNAL_ERROR, NULL);\
+        }\
+    }
+
+static
+void flecs_predicate_eval(
+    const ecs_term_predicate_t *pred,
+    const void *ptr,
+    ecs_size_t stride,
+    int32_t count,
+    uint8_t *sel)
+{
+    int32_t i;
+    switch(pred->kind) {
+    case EcsPredicateI8:  FLECS_PREDICATE_INT(int8_t)   break;
+    case EcsPredicateI16: FLECS_PREDICATE_INT(int16_t)  break;
+    case EcsPredicateI32: FLECS_PREDICATE_INT(int32_t)  break;
+    case EcsPredicateI64: FLECS_PREDICATE_INT(int64_t)  break;
+    case EcsPredicateU8:  FLECS_PREDICATE_INT(uint8_t)  break;
+    case EcsPredicateU16: FLECS_PREDICATE_INT(uint16_t) break;
+    case EcsPredicateU32: FLECS_PREDICATE_INT(uint32_t) break;
+    case EcsPredicateU64: FLECS_PREDICATE_INT(uint64_t) break;
+    case EcsPredicateF32: FLECS_PREDICATE_FLOAT(float)  break;
+    case EcsPredicateF64: FLECS_PREDICATE_FLOAT(double) break;
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+/* Evaluate predicates for a block of rows. Returns false if the predicate of a
+ * shared component fails, in which case none of the rows match. */
+static
+bool flecs_filter_predicate_block(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_table_t *table,
+    const ecs_id_t *ids,
+    const int32_t *columns,
+    const ecs_entity_t *sources,
+    int32_t row,
+    int32_t count,
+    uint8_t *sel)
+{
+    ecs_term_t *terms = filter->terms;
+    int32_t t, term_count = filter->term_count;
+
+    ecs_os_memset(sel, 1, count);
+
+    for (t = 0; t < term_count; t ++) {
+        ecs_term_t *term = &terms[t];
+        if (!term->predicate.kind) {
+            continue;
+        }
+
+        int32_t field = term->field_index;
+        int32_t column = columns[field];
+        ecs_entity_t src = sources[field];
+        const void *ptr;
+        ecs_size_t stride;
+
+        if (column > 0 && !src) {
+            int32_t storage_column = ecs_table_type_to_storage_index(
+                table, column - 1);
+            ecs_assert(storage_column != -1, ECS_INTERNAL_ERROR, NULL);
+            stride = table->type_info[storage_column]->size;
+            ptr = ECS_ELEM(ecs_vec_first(
+                &table->data.columns[storage_column]), stride, row);
+        } else {
+            /* Shared component, value is the same for all rows */
+            ptr = src ? ecs_get_id(world, src, ids[field]) : NULL;
+            if (!ptr) {
+                return false;
+            }
+            stride = 0;
+        }
+
+        flecs_predicate_eval(&term->predicate, 
+            ECS_OFFSET(ptr, term->predicate.offset), stride, count, sel);
+    }
+
+    return true;
+}
+
+int32_t flecs_filter_rows_next(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_table_t *table,
+    const ecs_id_t *ids,
+    const int32_t *columns,
+    const ecs_entity_t *sources,
+    flecs_row_select_action_t select,
+    void *select_ctx,
+    int32_t *row,
+    int32_t end,
+    int32_t *count_out)
+{
+    uint8_t sel[FLECS_ROW_BLOCK_SIZE];
+    int32_t cur = *row, first = -1;
+
+    while (cur < end) {
+        int32_t i = 0, count = ECS_MIN(end - cur, FLECS_ROW_BLOCK_SIZE);
+        if (!flecs_filter_predicate_block(world, filter, table, ids, columns, 
+            sources, cur, count, sel))
+        {
+            break;
+        }
+
+        if (select && !select(select_ctx, cur, count, sel)) {
+            break;
+        }
+
+        if (first == -1) {
+            /* Find start of range */
+            for (; i < count && !sel[i]; i ++) { }
+            if (i == count) {
+                cur += count;
+                continue;
+            }
+            first = cur + i;
+        }
+
+        /* Find end of range, which may continue into the next block */
+        for (; i < count && sel[i]; i ++) { }
+        if (i != count) {
+            *row = cur + i;
+            *count_out = cur + i - first;
+            return first;
+        }
+
+        cur += count;
+    }
+
+    *row = end;
+    if (first != -1) {
+        *count_out = end - first;
+    }
+    
+    return first;
+}
+
 static
 void term_iter_init_no_data(
     ecs_term_iter_t *iter)
@@ -2186,6 +2520,318 @@ error:
     return -2;
 }
 
+/* Does term only match tables that are in the table cache of its id */
+static
+bool flecs_filter_term_is_self(
+    const ecs_world_t *world,
+    const ecs_term_t *term)
+{
+    ecs_flags32_t trav_flags = term->src.flags & EcsTraverseFlags;
+    if (trav_flags != EcsSelf) {
+        /* Up(IsA) is equivalent to Self when there are no IsA relationships */
+        if (trav_flags != (EcsSelf|EcsUp) || term->src.trav != EcsIsA) {
+            return false;
+        }
+        const ecs_id_record_t *idr_isa = world->idr_isa_wildcard;
+        if (idr_isa && (flecs_table_cache_count(&idr_isa->cache) || 
+            flecs_table_cache_empty_count(&idr_isa->cache)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Max number of tables of the smallest term that are tested against the other
+ * terms when estimating the cardinality of a filter. */
+#define FLECS_ESTIMATE_SAMPLE_COUNT (32)
+
+ecs_estimate_t flecs_filter_estimate(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter,
+    bool match_vars)
+{
+    ecs_estimate_t result = {0};
+    world = ecs_get_world(world);
+
+    ecs_term_t *terms = filter->terms;
+    int32_t i, term_count = filter->term_count;
+    bool match_empty = (filter->flags & EcsFilterMatchEmptyTables) != 0;
+    bool has_this = false;
+
+    /* Id records of terms that are tested against the sampled tables */
+    ecs_id_record_t *idrs[ECS_TERM_DESC_CACHE_SIZE];
+    bool is_not[ECS_TERM_DESC_CACHE_SIZE];
+    int32_t idr_count = 0, min_count = 0;
+    ecs_id_record_t *min_idr = NULL;
+
+    for (i = 0; i < term_count; i ++) {
+        ecs_term_t *term = &terms[i];
+        if (ecs_term_match_this(term)) {
+            has_this = true;
+        } else if (!match_vars || !(term->src.flags & EcsIsVariable)) {
+            continue;
+        }
+
+        ecs_oper_kind_t oper = term->oper;
+        if (oper != EcsAnd && oper != EcsNot) {
+            continue;
+        }
+
+        ecs_id_record_t *idr = flecs_query_id_record_get(world, term->id);
+        if (!idr) {
+            if (oper == EcsAnd) {
+                /* Nothing can match a term for an id without tables */
+                return result;
+            }
+            continue;
+        }
+
+        /* Terms that traverse relationships also match tables that are not
+         * in the table cache of the id, so they can't constrain the result */
+        if (!flecs_filter_term_is_self(world, term)) {
+            continue;
+        }
+
+        if (oper == EcsAnd) {
+            /* Tables are moved between the empty and non-empty lists of the 
+             * cache when the world processes pending tables, so use both */
+            int32_t count = flecs_table_cache_count(&idr->cache) + 
+                flecs_table_cache_empty_count(&idr->cache);
+            if (!min_idr || count < min_count) {
+                min_idr = idr;
+                min_count = count;
+            }
+        }
+
+        if (idr_count < ECS_TERM_DESC_CACHE_SIZE) {
+            is_not[idr_count] = oper == EcsNot;
+            idrs[idr_count ++] = idr;
+        }
+    }
+
+    if (!has_this && !match_vars) {
+        /* Filters without This terms yield one result without entities */
+        result.table_count = result.max_table_count = 1;
+        return result;
+    }
+
+    if (!min_idr) {
+        result.table_count = result.max_table_count = 
+            flecs_sparse_count(&world->store.tables);
+        result.entity_count = result.max_entity_count = 
+            flecs_entities_count(world);
+        return result;
+    }
+
+    /* Upper bounds are the tables and entities of the smallest term. The 
+     * first tables are tested against the other terms, and the fraction that
+     * matches is used to scale the upper bounds. */
+    int32_t sample_tables = 0, sample_entities = 0;
+    int32_t match_tables = 0, match_entities = 0;
+
+    ecs_table_cache_iter_t it;
+    if (flecs_table_cache_all_iter(&min_idr->cache, &it)) {
+        const ecs_table_record_t *tr;
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            ecs_table_t *table = tr->hdr.table;
+            int32_t count = ecs_table_count(table);
+            if (!count && !match_empty) {
+                continue;
+            }
+
+            result.max_table_count ++;
+            result.max_entity_count += count;
+
+            if (sample_tables == FLECS_ESTIMATE_SAMPLE_COUNT) {
+                continue;
+            }
+
+            sample_tables ++;
+            sample_entities += count;
+
+            int32_t t;
+            for (t = 0; t < idr_count; t ++) {
+                bool has = idrs[t] == min_idr || 
+                    flecs_id_record_get_table(idrs[t], table) != NULL;
+                if (has == is_not[t]) {
+                    break;
+                }
+            }
+
+            if (t == idr_count) {
+                match_tables ++;
+                match_entities += count;
+            }
+        }
+    }
+
+    if (sample_tables) {
+        result.table_count = (int32_t)((int64_t)result.max_table_count * 
+            match_tables / sample_tables);
+    }
+    if (sample_entities) {
+        result.entity_count = (int32_t)((int64_t)result.max_entity_count * 
+            match_entities / sample_entities);
+    }
+
+    return result;
+}
+
+ecs_estimate_t ecs_filter_estimate(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(filter != NULL, ECS_INVALID_PARAMETER, NULL);
+    return flecs_filter_estimate(world, filter, false);
+error:
+    return (ecs_estimate_t){0};
+}
+
+/* Can the tables of term be found by intersecting sorted table lists */
+static
+ecs_id_record_t* flecs_filter_intersect_idr(
+    const ecs_world_t *world,
+    const ecs_term_t *term)
+{
+    if (term->oper != EcsAnd || !ecs_term_match_this(term)) {
+        return NULL;
+    }
+
+    if (!flecs_filter_term_is_self(world, term)) {
+        return NULL;
+    }
+
+    ecs_id_t id = term->id;
+    if (ecs_id_is_wildcard(id)) {
+        return NULL;
+    }
+
+    if (ECS_IS_PAIR(id)) {
+        /* Union pairs are not stored in tables with their actual id */
+        ecs_id_record_t *idr_r = flecs_id_record_get(world, 
+            ecs_pair(ECS_PAIR_FIRST(id), EcsWildcard));
+        if (idr_r && (idr_r->flags & EcsIdUnion)) {
+            return NULL;
+        }
+    } else if (id & ECS_ID_FLAGS_MASK) {
+        return NULL;
+    }
+
+    return flecs_id_record_get(world, id);
+}
+
+/* If a filter has multiple terms that are matched on $this by id, candidate
+ * tables are found by intersecting the sorted table lists of their id records
+ * instead of testing all tables of the pivot term against the other terms. */
+static
+void flecs_filter_intersect_init(
+    const ecs_world_t *world,
+    ecs_iter_t *it,
+    ecs_stack_t *stack)
+{
+    ecs_filter_iter_t *iter = &it->priv.iter.filter;
+    const ecs_filter_t *filter = iter->filter;
+    int32_t pivot_term = iter->pivot_term;
+    if (pivot_term < 0) {
+        return;
+    }
+
+    ecs_term_t *terms = filter->terms;
+    ecs_id_record_t *pivot_idr = flecs_filter_intersect_idr(
+        world, &terms[pivot_term]);
+    if (!pivot_idr) {
+        return;
+    }
+
+    int32_t i, count = 0, term_count = filter->term_count;
+    for (i = 0; i < term_count; i ++) {
+        if (flecs_filter_intersect_idr(world, &terms[i])) {
+            count ++;
+        }
+    }
+
+    if (count < 2) {
+        return;
+    }
+
+    /* Pivot term goes first, as it has the fewest tables */
+    iter->intersect_idrs = flecs_stack_alloc_n(stack, ecs_id_record_t*, count);
+    iter->intersect_pos = flecs_stack_calloc_n(stack, int32_t, count);
+    iter->intersect_idrs[0] = pivot_idr;
+    iter->intersect_count = 1;
+
+    for (i = 0; i < term_count; i ++) {
+        ecs_id_record_t *idr = flecs_filter_intersect_idr(world, &terms[i]);
+        if (idr && idr != pivot_idr) {
+            iter->intersect_idrs[iter->intersect_count ++] = idr;
+        }
+    }
+}
+
+/* Skip tables that the regular table iterator would also skip */
+static
+bool flecs_filter_intersect_valid(
+    const ecs_filter_t *filter,
+    const ecs_table_t *table)
+{
+    ecs_flags32_t flags = filter->flags;
+    if (!(flags & EcsFilterMatchEmptyTables) && !ecs_table_count(table)) {
+        return false;
+    }
+    if (!(flags & EcsFilterMatchPrefab) && (table->flags & EcsTableIsPrefab)) {
+        return false;
+    }
+    if (!(flags & EcsFilterMatchDisabled) && 
+        (table->flags & EcsTableIsDisabled)) 
+    {
+        return false;
+    }
+    return true;
+}
+
+/* Find next table that is in the sorted table lists of all intersected id 
+ * records. Lists are advanced with galloping search, so that large ranges of
+ * tables that don't match are skipped without testing them. */
+static
+ecs_table_t* flecs_filter_intersect_next(
+    ecs_filter_iter_t *iter)
+{
+    ecs_id_record_t **idrs = iter->intersect_idrs;
+    int32_t *pos = iter->intersect_pos;
+    int32_t i = 0, agree = 0, count = iter->intersect_count;
+    ecs_table_t *candidate = NULL;
+
+    do {
+        const ecs_vec_t *v = &idrs[i]->sorted_tables;
+        int32_t cur = pos[i];
+        if (candidate) {
+            cur = pos[i] = flecs_id_record_sorted_seek(
+                idrs[i], cur, candidate->id);
+        }
+
+        if (cur >= ecs_vec_count(v)) {
+            return NULL;
+        }
+
+        ecs_table_t *table = ecs_vec_get_t(v, ecs_table_t*, cur)[0];
+        if (table == candidate) {
+            agree ++;
+        } else {
+            candidate = table;
+            agree = 1;
+        }
+
+        i = (i + 1) % count;
+    } while (agree < count);
+
+    /* Move first list past the candidate for the next call */
+    pos[0] ++;
+
+    return candidate;
+}
+
 ecs_iter_t flecs_filter_iter_w_flags(
     const ecs_world_t *stage,
     const ecs_filter_t *filter,
@@ -2260,6 +2906,36 @@ ecs_iter_t flecs_filter_iter_w_flags(
 
     flecs_iter_init(stage, &it, flecs_iter_cache_all);
 
+    if (iter->kind == EcsIterEvalTables) {
+        ecs_stage_t *s = flecs_stage_from_world((ecs_world_t**)&stage);
+        flecs_filter_intersect_init(world, &it, &s->allocators.iter_stack);
+
+#ifdef FLECS_META
+        /* If a predicate has an index, iterate the entities in the index. The
+         * iterator falls back to tables if predicates are ignored or if the 
+         * This variable is constrained, which is only known after this. */
+        if (iter->pivot_term != -2 && 
+            ECS_BIT_IS_SET(filter->flags, EcsFilterHasPredicates)) 
+        {
+            int32_t i;
+            for (i = 0; i < filter->term_count; i ++) {
+                ecs_term_t *term = &filter->terms[i];
+                if (!term->predicate.index) {
+                    continue;
+                }
+
+                if (!flecs_member_index_iter_predicate(world, 
+                    term->predicate.index, ecs_get_typeid(world, term->id),
+                    &term->predicate, &iter->index_iter))
+                {
+                    iter->kind = EcsIterEvalIndex;
+                }
+                break;
+            }
+        }
+#endif
+    }
+
     return it;
 error:
     return (ecs_iter_t){ 0 };
@@ -2324,8 +3000,34 @@ bool ecs_filter_next_instanced(
 
     flecs_iter_validate(it);
 
-    ecs_iter_t *chain_it = it->chain_it;
-    ecs_iter_kind_t kind = iter->kind;
+    if (iter->predicate_row < iter->predicate_end) {
+        /* Yield remaining rows of the previous result that pass predicates */
+        int32_t count, offset = flecs_filter_rows_next(world, filter, 
+            it->table, it->ids, it->columns, it->sources, NULL, NULL,
+            &iter->predicate_row, iter->predicate_end, &count);
+        if (offset != -1) {
+            flecs_iter_populate_data(world, it, it->table, offset, count, 
+                it->ptrs, it->sizes);
+            ECS_BIT_SET(it->flags, EcsIterIsValid);
+            return true;
+        }
+    }
+
+    ecs_iter_t *chain_it;
+    ecs_iter_kind_t kind;
+    int32_t row = 0, row_count;
+repeat:
+    chain_it = it->chain_it;
+    kind = iter->kind;
+    row_count = -1; /* Yield all rows of table */
+
+    if (kind == EcsIterEvalIndex) {
+        if (ECS_BIT_IS_SET(it->flags, EcsIterIgnorePredicates) ||
+            (it->variable_count && ecs_iter_var_is_constrained(it, 0)))
+        {
+            iter->kind = kind = EcsIterEvalTables;
+        }
+    }
 
     if (chain_it) {
         ecs_assert(kind == EcsIterEvalChain, ECS_INVALID_PARAMETER, NULL);
@@ -2343,7 +3045,32 @@ bool ecs_filter_next_instanced(
                 true, -1, it->flags);
         } while (!match);
 
+        /* Only yield the rows provided by the chained iterator, which allows 
+         * the chained iterator to select a subset of a table */
+        row = chain_it->offset;
+        row_count = chain_it->count;
         goto yield;
+#ifdef FLECS_META
+    } else if (kind == EcsIterEvalIndex) {
+        do {
+            if (!flecs_member_index_iter_next(world, &iter->index_iter, 
+                &table, &row, &row_count))
+            {
+                goto done;
+            }
+
+            if (!flecs_filter_intersect_valid(filter, table)) {
+                continue;
+            }
+
+            match = flecs_filter_match_table(world, filter, table,
+                it->ids, it->columns, it->sources, it->match_indices, NULL, 
+                true, -1, it->flags);
+        } while (!match);
+
+        it->variables[0].range.table = table;
+        goto yield;
+#endif
     } else if (kind == EcsIterEvalTables || kind == EcsIterEvalCondition) {
         ecs_term_iter_t *term_iter = &iter->term_iter;
         ecs_term_t *term = &term_iter->term;
@@ -2398,6 +3125,22 @@ bool ecs_filter_next_instanced(
                         ecs_assert(term_iter->table == this_table,
                             ECS_INTERNAL_ERROR, NULL);
 
+                    /* If filter has multiple terms that can be intersected, 
+                     * find the next table that has all of their ids */
+                    } else if (iter->intersect_count) {
+                        do {
+                            table = flecs_filter_intersect_next(iter);
+                            if (!table) {
+                                goto done;
+                            }
+                        } while (!flecs_filter_intersect_valid(filter, table));
+
+                        if (!flecs_term_iter_set_table(
+                            world, term_iter, table))
+                        {
+                            ecs_abort(ECS_INTERNAL_ERROR, NULL);
+                        }
+
                     /* If This variable is not constrained, iterate as usual */
                     } else {
                         /* Find new match, starting with the leading term */
@@ -2523,10 +3266,32 @@ error:
     ecs_iter_fini(it);
     return false;
 
-yield:
-    it->offset = 0;
-    flecs_iter_populate_data(world, it, table, 0, 
-        table ? ecs_table_count(table) : 0, it->ptrs, it->sizes);
-    ECS_BIT_SET(it->flags, EcsIterIsValid);
-    return true;    
+yield: {
+        int32_t offset = 0, count = table ? ecs_table_count(table) : 0;
+        if (row_count != -1) {
+            offset = row;
+            count = row_count;
+        }
+
+        if (table && ECS_BIT_IS_SET(filter->flags, EcsFilterHasPredicates) &&
+            !ECS_BIT_IS_SET(it->flags, EcsIterIgnorePredicates)) 
+        {
+            /* Only yield ranges of rows that pass the predicates */
+            iter->predicate_row = offset;
+            iter->predicate_end = offset + count;
+            offset = flecs_filter_rows_next(world, filter, table, 
+                it->ids, it->columns, it->sources, NULL, NULL,
+                &iter->predicate_row, 
+                iter->predicate_end, &count);
+            if (offset == -1) {
+                goto repeat;
+            }
+        }
+
+        it->offset = offset;
+        flecs_iter_populate_data(world, it, table, offset, count, 
+            it->ptrs, it->sizes);
+        ECS_BIT_SET(it->flags, EcsIterIsValid);
+        return true;
+    }
 }
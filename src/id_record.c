@@ -133,6 +133,7 @@ ecs_id_record_t* flecs_id_record_new(
     }
 
     ecs_table_cache_init(world, &idr->cache);
+    ecs_vec_init_t(&world->allocator, &idr->sorted_tables, ecs_table_t*, 0);
 
     idr->id = id;
     idr->refcount = 1;
@@ -352,7 +353,9 @@ void flecs_id_record_free(
     /* Unregister the id record from the world & free resources */
     ecs_table_cache_fini(&idr->cache);
     flecs_name_index_free(idr->name_index);
+    flecs_target_index_free(world, idr);
     ecs_vec_fini_t(&world->allocator, &idr->reachable.ids, ecs_reachable_elem_t);
+    ecs_vec_fini_t(&world->allocator, &idr->sorted_tables, ecs_table_t*);
 
     ecs_id_t hash = flecs_id_record_hash(id);
     if (hash >= ECS_HI_ID_RECORD_ID) {
@@ -545,6 +548,226 @@ ecs_hashmap_t* flecs_id_name_index_get(
     return idr->name_index;
 }
 
+static
+ecs_size_t flecs_target_index_map_size(
+    const ecs_map_t *map)
+{
+    return ecs_map_bucket_count(map) * ECS_SIZEOF(ecs_bucket_t) +
+        ecs_map_count(map) * 
+            (ECS_SIZEOF(ecs_bucket_entry_t) + map->elem_size);
+}
+
+/* Recompute memory used by target index & update world counters */
+static
+void flecs_target_index_update_size(
+    ecs_world_t *world,
+    ecs_target_index_t *ti,
+    ecs_size_t vec_delta)
+{
+    ecs_size_t size = ti->size;
+    ecs_size_t map_size = flecs_target_index_map_size(&ti->sources) +
+        flecs_target_index_map_size(&ti->slots);
+    ecs_size_t prev_map_size = ti->map_size;
+
+    ti->map_size = map_size;
+    ti->size = size + vec_delta + (map_size - prev_map_size);
+    world->info.target_index_memory += ti->size - size;
+}
+
+ecs_target_index_t* flecs_target_index_ensure(
+    ecs_world_t *world,
+    ecs_entity_t rel)
+{
+    ecs_id_record_t *idr = flecs_id_record_ensure(world, 
+        ecs_pair(rel, EcsWildcard));
+    ecs_target_index_t *ti = idr->target_index;
+    if (!ti) {
+        ti = idr->target_index = flecs_calloc_t(
+            &world->allocator, ecs_target_index_t);
+        ecs_map_init(&ti->sources, ecs_vec_t, &world->allocator, 0);
+        ecs_map_init(&ti->slots, int32_t, &world->allocator, 0);
+        flecs_target_index_update_size(world, ti, ECS_SIZEOF(ecs_target_index_t));
+    }
+    return ti;
+}
+
+void flecs_target_index_free(
+    ecs_world_t *world,
+    ecs_id_record_t *idr)
+{
+    ecs_target_index_t *ti = idr->target_index;
+    if (!ti) {
+        return;
+    }
+
+    ecs_map_iter_t it = ecs_map_iter(&ti->sources);
+    ecs_vec_t *v;
+    while ((v = ecs_map_next(&it, ecs_vec_t, NULL))) {
+        ecs_vec_fini_t(&world->allocator, v, ecs_entity_t);
+    }
+
+    ecs_map_fini(&ti->sources);
+    ecs_map_fini(&ti->slots);
+
+    world->info.target_index_count -= ti->count;
+    world->info.target_index_memory -= ti->size;
+
+    flecs_free_t(&world->allocator, ecs_target_index_t, ti);
+    idr->target_index = NULL;
+}
+
+/* Get target index for pair, or NULL if the relationship isn't indexed */
+static
+ecs_target_index_t* flecs_target_index_for_pair(
+    ecs_world_t *world,
+    ecs_id_t id)
+{
+    if (!ECS_IS_PAIR(id)) {
+        return NULL;
+    }
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr || ((idr->flags & (EcsIdTargetIndex|EcsIdUnion)) != 
+        EcsIdTargetIndex)) 
+    {
+        return NULL;
+    }
+
+    ecs_assert(idr->parent != NULL, ECS_INTERNAL_ERROR, NULL);
+    return idr->parent->target_index;
+}
+
+void flecs_target_index_add(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t row,
+    int32_t count,
+    const ecs_type_t *added)
+{
+    ecs_entity_t *entities = ecs_vec_first_t(
+        &table->data.entities, ecs_entity_t);
+    int32_t i, e, id_count = added->count;
+
+    for (i = 0; i < id_count; i ++) {
+        ecs_id_t id = added->array[i];
+        ecs_target_index_t *ti = flecs_target_index_for_pair(world, id);
+        if (!ti) {
+            continue;
+        }
+
+        ecs_entity_t tgt = ECS_PAIR_SECOND(id);
+        ecs_vec_t *sources = ecs_map_get(&ti->sources, ecs_vec_t, tgt);
+        if (!sources) {
+            sources = ecs_map_ensure(&ti->sources, ecs_vec_t, tgt);
+            ecs_vec_init_t(&world->allocator, sources, ecs_entity_t, 0);
+        }
+        ecs_size_t prev_size = ecs_vec_size(sources);
+
+        for (e = 0; e < count; e ++) {
+            ecs_entity_t src = entities[row + e];
+            int32_t *slot = ecs_map_ensure(&ti->slots, int32_t, 
+                ecs_pair(src, tgt));
+            if (slot[0]) {
+                continue; /* Already indexed */
+            }
+
+            /* Slots are stored 1-based so that 0 means "not indexed" */
+            slot[0] = ecs_vec_count(sources) + 1;
+            ecs_vec_append_t(&world->allocator, sources, ecs_entity_t)[0] = src;
+            ti->count ++;
+            world->info.target_index_count ++;
+        }
+
+        flecs_target_index_update_size(world, ti, 
+            (ecs_vec_size(sources) - prev_size) * ECS_SIZEOF(ecs_entity_t));
+    }
+}
+
+void flecs_target_index_remove(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t row,
+    int32_t count,
+    const ecs_type_t *removed)
+{
+    ecs_entity_t *entities = ecs_vec_first_t(
+        &table->data.entities, ecs_entity_t);
+    int32_t i, e, id_count = removed->count;
+
+    for (i = 0; i < id_count; i ++) {
+        ecs_id_t id = removed->array[i];
+        ecs_target_index_t *ti = flecs_target_index_for_pair(world, id);
+        if (!ti) {
+            continue;
+        }
+
+        ecs_entity_t tgt = ECS_PAIR_SECOND(id);
+        ecs_vec_t *sources = ecs_map_get(&ti->sources, ecs_vec_t, tgt);
+        if (!sources) {
+            continue;
+        }
+
+        for (e = 0; e < count; e ++) {
+            ecs_entity_t src = entities[row + e];
+            ecs_map_key_t key = ecs_pair(src, tgt);
+            int32_t *slot = ecs_map_get(&ti->slots, int32_t, key);
+            if (!slot) {
+                continue;
+            }
+
+            /* Move last source into the slot of the removed source */
+            int32_t index = slot[0] - 1;
+            ecs_entity_t *array = ecs_vec_first_t(sources, ecs_entity_t);
+            int32_t last = ecs_vec_count(sources) - 1;
+            ecs_assert(array[index] == src, ECS_INTERNAL_ERROR, NULL);
+            if (index != last) {
+                ecs_entity_t moved = array[last];
+                array[index] = moved;
+                int32_t *moved_slot = ecs_map_get(&ti->slots, int32_t, 
+                    ecs_pair(moved, tgt));
+                ecs_assert(moved_slot != NULL, ECS_INTERNAL_ERROR, NULL);
+                moved_slot[0] = index + 1;
+            }
+
+            ecs_vec_remove_last(sources);
+            ecs_map_remove(&ti->slots, key);
+            ti->count --;
+            world->info.target_index_count --;
+        }
+
+        if (!ecs_vec_count(sources)) {
+            ecs_size_t size = ecs_vec_size(sources);
+            ecs_vec_fini_t(&world->allocator, sources, ecs_entity_t);
+            ecs_map_remove(&ti->sources, tgt);
+            flecs_target_index_update_size(world, ti, 
+                -size * ECS_SIZEOF(ecs_entity_t));
+        } else {
+            flecs_target_index_update_size(world, ti, 0);
+        }
+    }
+}
+
+const ecs_entity_t* flecs_target_index_get(
+    const ecs_target_index_t *ti,
+    ecs_entity_t target,
+    int32_t *count_out)
+{
+    ecs_vec_t *sources = ecs_map_get(&ti->sources, ecs_vec_t, 
+        (uint32_t)target);
+    if (!sources) {
+        if (count_out) {
+            *count_out = 0;
+        }
+        return NULL;
+    }
+
+    if (count_out) {
+        *count_out = ecs_vec_count(sources);
+    }
+
+    return ecs_vec_first_t(sources, ecs_entity_t);
+}
+
 ecs_table_record_t* flecs_table_record_get(
     const ecs_world_t *world,
     const ecs_table_t *table,
@@ -568,6 +791,104 @@ const ecs_table_record_t* flecs_id_record_get_table(
     return (ecs_table_record_t*)ecs_table_cache_get(&idr->cache, table);
 }
 
+/* Find index of first table in sorted list with id >= table_id */
+static
+int32_t flecs_id_record_sorted_lower_bound(
+    ecs_table_t **tables,
+    int32_t low,
+    int32_t high,
+    uint64_t table_id)
+{
+    while (low < high) {
+        int32_t mid = low + (high - low) / 2;
+        if (tables[mid]->id < table_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void flecs_id_record_sorted_add(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_table_t *table)
+{
+    if (ecs_id_is_wildcard(idr->id)) {
+        return;
+    }
+
+    ecs_vec_t *v = &idr->sorted_tables;
+    int32_t count = ecs_vec_count(v);
+    ecs_table_t **tables = ecs_vec_first_t(v, ecs_table_t*);
+
+    /* New tables usually have the highest id, so check the end first */
+    int32_t index = count;
+    if (count && tables[count - 1]->id > table->id) {
+        index = flecs_id_record_sorted_lower_bound(
+            tables, 0, count, table->id);
+    }
+
+    ecs_vec_append_t(&world->allocator, v, ecs_table_t*);
+    tables = ecs_vec_first_t(v, ecs_table_t*);
+    if (index < count) {
+        ecs_os_memmove(&tables[index + 1], &tables[index], 
+            ECS_SIZEOF(ecs_table_t*) * (count - index));
+    }
+    tables[index] = table;
+}
+
+void flecs_id_record_sorted_remove(
+    ecs_id_record_t *idr,
+    const ecs_table_t *table)
+{
+    if (ecs_id_is_wildcard(idr->id)) {
+        return;
+    }
+
+    ecs_vec_t *v = &idr->sorted_tables;
+    int32_t count = ecs_vec_count(v);
+    ecs_table_t **tables = ecs_vec_first_t(v, ecs_table_t*);
+    int32_t index = flecs_id_record_sorted_lower_bound(
+        tables, 0, count, table->id);
+    ecs_assert(index < count && tables[index] == table, 
+        ECS_INTERNAL_ERROR, NULL);
+
+    if (index < (count - 1)) {
+        ecs_os_memmove(&tables[index], &tables[index + 1], 
+            ECS_SIZEOF(ecs_table_t*) * (count - index - 1));
+    }
+    ecs_vec_remove_last(v);
+}
+
+int32_t flecs_id_record_sorted_seek(
+    const ecs_id_record_t *idr,
+    int32_t index,
+    uint64_t table_id)
+{
+    const ecs_vec_t *v = &idr->sorted_tables;
+    int32_t count = ecs_vec_count(v);
+    ecs_table_t **tables = ecs_vec_first_t(v, ecs_table_t*);
+    if (index >= count || tables[index]->id >= table_id) {
+        return index;
+    }
+
+    /* Gallop ahead with increasing steps until a larger table id is found,
+     * then binary search the last step */
+    int32_t low = index, step = 1, high = index + 1;
+    while (high < count && tables[high]->id < table_id) {
+        low = high;
+        step *= 2;
+        high = low + step;
+    }
+    if (high > count) {
+        high = count;
+    }
+
+    return flecs_id_record_sorted_lower_bound(tables, low + 1, high, table_id);
+}
+
 void flecs_init_id_records(
     ecs_world_t *world)
 {
@@ -34,6 +34,17 @@ typedef struct ecs_reachable_cache_t {
     ecs_vec_t ids; /* vec<reachable_elem_t> */
 } ecs_reachable_cache_t;
 
+/* Reverse index for relationships with the TargetIndex property. The index
+ * keeps track of which entities (sources) have a pair with a target, and at
+ * which slot a source is stored for a target, so it can be removed in O(1). */
+typedef struct ecs_target_index_t {
+    ecs_map_t sources;    /* map<target, ecs_vec_t<ecs_entity_t>> */
+    ecs_map_t slots;      /* map<pair(source, target), int32_t> */
+    int32_t count;        /* Number of (source, target) pairs in index */
+    ecs_size_t size;      /* Memory used by index, in bytes */
+    ecs_size_t map_size;  /* Memory used by index maps, in bytes */
+} ecs_target_index_t;
+
 /* Payload for id index which contains all datastructures for an id. */
 struct ecs_id_record_t {
     /* Cache with all tables that contain the id. Must be first member. */
@@ -51,6 +62,13 @@ struct ecs_id_record_t {
     /* Name lookup index (currently only used for ChildOf pairs) */
     ecs_hashmap_t *name_index;
 
+    /* Target index (only set for (R, *) records with TargetIndex property) */
+    ecs_target_index_t *target_index;
+
+    /* Tables with id sorted by table id, used to intersect the tables of
+     * multiple ids. Not populated for wildcard ids. */
+    ecs_vec_t sorted_tables; /* vec<ecs_table_t*> */
+
     /* Cached pointer to type info for id, if id contains data. */
     const ecs_type_info_t *type_info;
 
@@ -115,6 +133,38 @@ ecs_hashmap_t* flecs_id_name_index_get(
     const ecs_world_t *world,
     ecs_id_t id);
 
+/* Ensure (R, *) id record has target index */
+ecs_target_index_t* flecs_target_index_ensure(
+    ecs_world_t *world,
+    ecs_entity_t rel);
+
+/* Free target index of (R, *) id record */
+void flecs_target_index_free(
+    ecs_world_t *world,
+    ecs_id_record_t *idr);
+
+/* Add entities in table to target indices for added ids */
+void flecs_target_index_add(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t row,
+    int32_t count,
+    const ecs_type_t *added);
+
+/* Remove entities in table from target indices for removed ids */
+void flecs_target_index_remove(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t row,
+    int32_t count,
+    const ecs_type_t *removed);
+
+/* Get sources for target from target index */
+const ecs_entity_t* flecs_target_index_get(
+    const ecs_target_index_t *ti,
+    ecs_entity_t target,
+    int32_t *count_out);
+
 /* Find table record for id */
 ecs_table_record_t* flecs_table_record_get(
     const ecs_world_t *world,
@@ -126,6 +176,25 @@ const ecs_table_record_t* flecs_id_record_get_table(
     const ecs_id_record_t *idr,
     const ecs_table_t *table);
 
+/* Add table to sorted table list of id record */
+void flecs_id_record_sorted_add(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_table_t *table);
+
+/* Remove table from sorted table list of id record */
+void flecs_id_record_sorted_remove(
+    ecs_id_record_t *idr,
+    const ecs_table_t *table);
+
+/* Find index of first table in sorted table list with id >= table_id, starting
+ * from index. Uses galloping search, which is efficient when subsequent calls
+ * search for increasing table ids. */
+int32_t flecs_id_record_sorted_seek(
+    const ecs_id_record_t *idr,
+    int32_t index,
+    uint64_t table_id);
+
 /* Bootstrap cached id records */
 void flecs_init_id_records(
     ecs_world_t *world);
@@ -927,7 +927,6 @@ error:
     return (ecs_iter_t){ 0 };
 }
 
-static
 void flecs_offset_iter(
     ecs_iter_t *it,
     int32_t offset)
@@ -1133,7 +1132,7 @@ bool ecs_worker_next_instanced(
     it->instance_count = instances_per_worker;
     it->frame_offset += first;
 
-    flecs_offset_iter(it, it->offset + first);
+    flecs_offset_iter(it, first);
     it->count = per_worker;
 
     if (ECS_BIT_IS_SET(it->flags, EcsIterIsInstanced)) {
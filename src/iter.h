@@ -30,4 +30,8 @@ bool flecs_iter_next_instanced(
     ecs_iter_t *it,
     bool result);
 
+void flecs_offset_iter(
+    ecs_iter_t *it,
+    int32_t offset);
+
 #endif
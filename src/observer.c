@@ -251,6 +251,12 @@ void flecs_observer_invoke(
 {
     ecs_assert(it->callback != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_table_lock(it->world, table);
+
+#ifdef FLECS_TRACING
+    ecs_stage_t *stage = ecs_poly_is(it->world, ecs_stage_t) 
+        ? (ecs_stage_t*)it->world : &world->stages[0];
+    flecs_trace_begin(stage, EcsTraceObserver, it->system);
+#endif
     if (ecs_should_log_3()) {
         char *path = ecs_get_fullpath(world, it->system);
         ecs_dbg_3("observer: invoke %s", path);
@@ -302,6 +308,8 @@ void flecs_observer_invoke(
 
     ecs_log_pop_3();
     ecs_table_unlock(it->world, table);
+
+    flecs_trace_end(stage, EcsTraceObserver, it->system);
 }
 
 static
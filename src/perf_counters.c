@@ -0,0 +1,235 @@
+/**
+ * @file perf_counters.c
+ * @brief Hardware counters for systems (only with FLECS_PERF_COUNTERS).
+ *
+ * Counters are read with perf_event_open, which is only available on Linux.
+ * Each stage opens its own counters from the thread that runs the stage, and
+ * stores the counters per system. This means that counting doesn't require
+ * synchronization between worker threads. When counters can't be opened (for
+ * example because the platform is not Linux, the CPU doesn't expose hardware
+ * events or permission is denied) all counters are reported as 0.
+ */
+
+/* syscall is not declared when only _POSIX_C_SOURCE is defined */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "private_api.h"
+
+#ifdef FLECS_PERF_COUNTERS
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+static const uint64_t flecs_perf_config[] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static
+int32_t flecs_perf_open(
+    uint64_t config,
+    int32_t group_fd)
+{
+    struct perf_event_attr attr;
+    ecs_os_memset_t(&attr, 0, struct perf_event_attr);
+    attr.size = sizeof(struct perf_event_attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    /* pid = 0, cpu = -1: count events for calling thread on any CPU */
+    return (int32_t)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static
+void flecs_perf_stage_open(
+    ecs_stage_t *stage)
+{
+    ecs_stage_perf_t *perf = &stage->perf;
+    int32_t i, leader = -1, err = 0;
+
+    for (i = 0; i < FLECS_PERF_COUNTER_COUNT; i ++) {
+        int32_t fd = flecs_perf_open(flecs_perf_config[i], leader);
+        if (fd == -1) {
+            if (!err) {
+                err = errno;
+            }
+            continue;
+        }
+
+        /* First counter that opens successfully becomes the group leader, so
+         * that all counters can be read with a single system call. */
+        if (leader == -1) {
+            leader = fd;
+        }
+
+        perf->fd[i] = fd;
+        perf->slot[i] = perf->slot_count ++;
+    }
+
+    if (err) {
+        ecs_warn("perf counters: not all counters are available for "
+            "stage %d (%s)", stage->id, strerror(err));
+    }
+}
+
+static
+void flecs_perf_stage_close(
+    ecs_stage_t *stage)
+{
+    int32_t i;
+    for (i = 0; i < FLECS_PERF_COUNTER_COUNT; i ++) {
+        if (stage->perf.fd[i] != -1) {
+            close(stage->perf.fd[i]);
+        }
+    }
+}
+
+static
+bool flecs_perf_stage_read(
+    ecs_stage_t *stage,
+    uint64_t *values)
+{
+    ecs_stage_perf_t *perf = &stage->perf;
+    if (!perf->slot_count) {
+        return false;
+    }
+
+    int32_t i, leader = -1;
+    for (i = 0; i < FLECS_PERF_COUNTER_COUNT; i ++) {
+        if (perf->slot[i] == 0) {
+            leader = perf->fd[i];
+            break;
+        }
+    }
+
+    /* Layout of group read is { nr, values[nr] } */
+    uint64_t buf[1 + FLECS_PERF_COUNTER_COUNT];
+    ssize_t size = (ssize_t)(ECS_SIZEOF(uint64_t) * (1 + perf->slot_count));
+    if (read(leader, buf, (size_t)size) != size) {
+        return false;
+    }
+
+    for (i = 0; i < FLECS_PERF_COUNTER_COUNT; i ++) {
+        int32_t slot = perf->slot[i];
+        values[i] = slot != -1 ? buf[1 + slot] : 0;
+    }
+
+    return true;
+}
+
+#else
+
+static
+void flecs_perf_stage_open(
+    ecs_stage_t *stage)
+{
+    ecs_warn("perf counters: not supported on this platform (stage %d)",
+        stage->id);
+}
+
+static
+void flecs_perf_stage_close(
+    ecs_stage_t *stage)
+{
+    (void)stage;
+}
+
+static
+bool flecs_perf_stage_read(
+    ecs_stage_t *stage,
+    uint64_t *values)
+{
+    (void)stage;
+    (void)values;
+    return false;
+}
+
+#endif
+
+void flecs_perf_stage_init(
+    ecs_stage_t *stage)
+{
+    ecs_stage_perf_t *perf = &stage->perf;
+    int32_t i;
+    for (i = 0; i < FLECS_PERF_COUNTER_COUNT; i ++) {
+        perf->fd[i] = -1;
+        perf->slot[i] = -1;
+    }
+    perf->slot_count = 0;
+    perf->initialized = false;
+    ecs_map_init(&perf->systems, ecs_perf_counters_t, &stage->allocator, 0);
+}
+
+void flecs_perf_stage_fini(
+    ecs_stage_t *stage)
+{
+    if (stage->perf.initialized) {
+        flecs_perf_stage_close(stage);
+    }
+    ecs_map_fini(&stage->perf.systems);
+}
+
+bool flecs_perf_read(
+    ecs_stage_t *stage,
+    ecs_perf_counters_t *out)
+{
+    /* Counters must be opened by the thread that reads them, which is why they
+     * are opened on first use instead of when the stage is created. */
+    if (!stage->perf.initialized) {
+        flecs_perf_stage_open(stage);
+        stage->perf.initialized = true;
+    }
+
+    return flecs_perf_stage_read(stage, (uint64_t*)out);
+}
+
+void flecs_perf_record(
+    ecs_stage_t *stage,
+    ecs_entity_t system,
+    const ecs_perf_counters_t *begin)
+{
+    ecs_perf_counters_t end;
+    if (!flecs_perf_stage_read(stage, (uint64_t*)&end)) {
+        return;
+    }
+
+    ecs_perf_counters_t *dst = ecs_map_ensure(
+        &stage->perf.systems, ecs_perf_counters_t, system);
+    dst->cycles += end.cycles - begin->cycles;
+    dst->instructions += end.instructions - begin->instructions;
+    dst->cache_misses += end.cache_misses - begin->cache_misses;
+    dst->branch_misses += end.branch_misses - begin->branch_misses;
+}
+
+void flecs_perf_get(
+    const ecs_world_t *world,
+    ecs_entity_t system,
+    ecs_perf_counters_t *out)
+{
+    ecs_os_zeromem(out);
+
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        const ecs_perf_counters_t *src = ecs_map_get(
+            &world->stages[i].perf.systems, ecs_perf_counters_t, system);
+        if (src) {
+            out->cycles += src->cycles;
+            out->instructions += src->instructions;
+            out->cache_misses += src->cache_misses;
+            out->branch_misses += src->branch_misses;
+        }
+    }
+}
+
+#endif
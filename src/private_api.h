@@ -119,16 +119,180 @@ bool flecs_filter_match_table(
     int32_t skip_term,
     ecs_flags32_t iter_flags);
 
+/* Number of rows for which predicates are evaluated at a time */
+#define FLECS_ROW_BLOCK_SIZE (64)
+
+/* Callback that can further restrict the rows selected by filter predicates.
+ * Returns false if no rows in this or later blocks can match. */
+typedef bool (*flecs_row_select_action_t)(
+    void *ctx,
+    int32_t row,
+    int32_t count,
+    uint8_t *sel);
+
+/* Find next range of rows in [row, end) for which filter predicates and the
+ * optional select callback pass. Returns the first row of the range, or -1 if
+ * no rows are left. */
+int32_t flecs_filter_rows_next(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_table_t *table,
+    const ecs_id_t *ids,
+    const int32_t *columns,
+    const ecs_entity_t *sources,
+    flecs_row_select_action_t select,
+    void *select_ctx,
+    int32_t *row,
+    int32_t end,
+    int32_t *count_out);
+
 ecs_iter_t flecs_filter_iter_w_flags(
     const ecs_world_t *stage,
     const ecs_filter_t *filter,
     ecs_flags32_t flags);
 
+#ifdef FLECS_META
+/* Initialize iterator for the entities in a member index that can pass the
+ * term predicate. If iter is NULL, this only tests if the index can be used
+ * for the predicate. Returns -1 if the index can't be used. */
+int flecs_member_index_iter_predicate(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    ecs_entity_t component,
+    const ecs_term_predicate_t *pred,
+    ecs_member_index_iter_t *iter);
+
+/* Find next range of consecutive rows in a table for member index iterator */
+bool flecs_member_index_iter_next(
+    const ecs_world_t *world,
+    ecs_member_index_iter_t *iter,
+    ecs_table_t **table_out,
+    int32_t *row_out,
+    int32_t *count_out);
+#endif
+
+#ifdef FLECS_TRACING
+/* Allocate/free trace buffer for stage (called on stage init/fini) */
+void flecs_trace_stage_init(
+    ecs_world_t *world,
+    ecs_stage_t *stage);
+
+void flecs_trace_stage_fini(
+    ecs_stage_t *stage);
+
+/* Record trace event in buffer of stage */
+void flecs_trace_record(
+    ecs_stage_t *stage,
+    ecs_trace_kind_t kind,
+    ecs_entity_t entity,
+    bool begin);
+
+#define flecs_trace_begin(stage, kind, entity)\
+    ((stage)->trace ? flecs_trace_record(stage, kind, entity, true) : (void)0)
+
+#define flecs_trace_end(stage, kind, entity)\
+    ((stage)->trace ? flecs_trace_record(stage, kind, entity, false) : (void)0)
+#else
+#define flecs_trace_stage_init(world, stage)
+#define flecs_trace_stage_fini(stage)
+#define flecs_trace_begin(stage, kind, entity)
+#define flecs_trace_end(stage, kind, entity)
+#endif
+
+#ifdef FLECS_STATS
+/* Add sample (in seconds) to latency histogram */
+void flecs_histogram_record(
+    ecs_histogram_t *hist,
+    ecs_ftime_t value);
+#else
+#define flecs_histogram_record(hist, value)
+#endif
+
+#ifdef FLECS_PERF_COUNTERS
+/* Initialize/free hardware counters of stage (called on stage init/fini) */
+void flecs_perf_stage_init(
+    ecs_stage_t *stage);
+
+void flecs_perf_stage_fini(
+    ecs_stage_t *stage);
+
+/* Read current counter values for the thread of the stage. Returns false if
+ * counters are not available. */
+bool flecs_perf_read(
+    ecs_stage_t *stage,
+    ecs_perf_counters_t *out);
+
+/* Add difference between current counters and begin to counters of system */
+void flecs_perf_record(
+    ecs_stage_t *stage,
+    ecs_entity_t system,
+    const ecs_perf_counters_t *begin);
+
+/* Get sum of hardware counters for system across all stages */
+void flecs_perf_get(
+    const ecs_world_t *world,
+    ecs_entity_t system,
+    ecs_perf_counters_t *out);
+#else
+#define flecs_perf_stage_init(stage)
+#define flecs_perf_stage_fini(stage)
+#endif
+
+#ifdef FLECS_QUERY_COUNTERS
+/* Get profiling counters of query for stage (or world, for stage 0) */
+ecs_query_counters_t* flecs_query_counters(
+    const ecs_world_t *stage,
+    ecs_query_t *query);
+
+/* Sum profiling counters of query across stages */
+void flecs_query_counters_get(
+    const ecs_world_t *world,
+    const ecs_query_t *query,
+    ecs_query_counters_t *out);
+
+/* Add result of iterator to the profiling counters of query */
+void flecs_query_count_result(
+    ecs_query_t *query,
+    const ecs_iter_t *it);
+
+#define flecs_query_counter_add(stage, query, counter, value)\
+    (flecs_query_counters(stage, query)->counter += (value))
+#else
+#define flecs_query_count_result(query, it)
+#define flecs_query_counter_add(stage, query, counter, value)
+#endif
+
+/* Estimate cardinality of filter. When match_vars is true, terms matched on
+ * variables other than This also constrain the estimate (used by rules). */
+ecs_estimate_t flecs_filter_estimate(
+    const ecs_world_t *world,
+    const ecs_filter_t *filter,
+    bool match_vars);
+
+/* Hint the CPU to load memory that will be accessed soon into the cache */
+#if defined(ECS_TARGET_GNU) || defined(ECS_TARGET_CLANG)
+#define flecs_prefetch(ptr) __builtin_prefetch(ptr)
+#elif defined(ECS_TARGET_MSVC) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define flecs_prefetch(ptr) _mm_prefetch((const char*)(ptr), _MM_HINT_T0)
+#else
+#define flecs_prefetch(ptr) ((void)(ptr))
+#endif
+
 void flecs_query_notify(
     ecs_world_t *world,
     ecs_query_t *query,
     ecs_query_event_t *event);
 
+/* Notify queries that can match the event table */
+void flecs_query_index_notify(
+    ecs_world_t *world,
+    ecs_query_event_t *event);
+
+/* Free resources of query index */
+void flecs_query_index_fini(
+    ecs_world_t *world);
+
 ecs_id_t flecs_to_public_id(
     ecs_id_t id);
 
@@ -233,11 +397,19 @@ int flecs_entity_compare_qsort(
     const void *e1,
     const void *e2);
 
-/* Convert floating point to string */
-char * ecs_ftoa(
+/* Convert integer to string, returns pointer to end of string. The buffer must
+ * be able to hold at least 21 characters. */
+char* flecs_itoa(
+    char *buf,
+    int64_t v);
+
+/* Convert floating point to string, returns pointer to end of string. The
+ * buffer must be able to hold at least 64 characters. */
+char* flecs_ftoa(
+    char *buf,
     double f, 
-    char * buf, 
-    int precision);
+    int precision,
+    char nan_delim);
 
 uint64_t flecs_string_hash(
     const void *ptr);
@@ -183,6 +183,8 @@ struct ecs_table_t {
     ecs_type_info_t **type_info;     /* Cached type info */
 
     int32_t *dirty_state;            /* Keep track of changes in columns */
+    ecs_vec_t *dirty_rows;           /* Per row dirty state of columns */
+    uint64_t bloom;                  /* Signature of ids (and wildcards) */
 
     int16_t sw_count;
     int16_t sw_offset;
@@ -264,6 +266,7 @@ struct ecs_query_table_match_t {
     ecs_query_table_match_t *next_match;
 
     int32_t *monitor;         /* Used to monitor table for changes */
+    int32_t *changed_monitor; /* Monitor before iterating changed rows */
 };
 
 /** A single table can occur multiple times in the cache when a term matches
@@ -305,6 +308,19 @@ typedef struct ecs_query_allocators_t {
     ecs_block_allocator_t monitors;
 } ecs_query_allocators_t;
 
+/* Profiling counters for query (only collected with FLECS_QUERY_COUNTERS). 
+ * Counters are stored per stage, so that threads iterating the same query
+ * don't write to the same counters. */
+typedef struct ecs_query_counters_t {
+    int64_t table_count;        /* Number of results yielded */
+    int64_t entity_count;       /* Number of entities yielded */
+    int64_t skip_count;         /* Tables skipped without yielding a result */
+    int64_t change_check_count; /* Number of change detection checks */
+    int64_t bytes_touched;      /* Bytes of component data yielded */
+    ecs_ftime_t rematch_time;   /* Time spent rematching tables */
+    ecs_ftime_t sort_time;      /* Time spent sorting tables */
+} ecs_query_counters_t;
+
 /** Query that is automatically matched against tables */
 struct ecs_query_t {
     ecs_header_t hdr;
@@ -343,10 +359,16 @@ struct ecs_query_t {
     ecs_flags32_t flags;
 
     int32_t cascade_by;         /* Identify cascade column */
+    int32_t max_batch;          /* Maximum number of rows per result */
     int32_t match_count;        /* How often have tables been (un)matched */
     int32_t prev_match_count;   /* Track if sorting is needed */
     int32_t rematch_count;      /* Track which tables were added during rematch */
 
+    /* Table matching index */
+    ecs_id_t index_ids[2];      /* Ids under which query is indexed */
+    uint64_t bloom;             /* Signature of ids matched tables must have */
+    int32_t match_event_id;     /* Last table event query was notified for */
+
     /* Mixins */
     ecs_world_t *world;
     ecs_iterable_t iterable;
@@ -453,6 +475,47 @@ typedef struct ecs_cmd_entry_t {
  * threads. Stage pointers can be passed to the world argument of API 
  * operations, which causes the operation to be ran on the stage instead of the
  * world. */
+#ifdef FLECS_TRACING
+/* Event recorded by the tracing addon */
+typedef struct ecs_trace_event_t {
+    uint64_t time;               /* Timestamp in nanoseconds */
+    ecs_entity_t entity;         /* System, observer or pipeline (optional) */
+    int32_t kind;                /* ecs_trace_kind_t */
+    bool begin;                  /* Begin or end of event */
+} ecs_trace_event_t;
+
+/* Ring buffer with trace events. Only the thread of the stage writes to it, so
+ * recording an event doesn't require synchronization. */
+typedef struct ecs_trace_buffer_t {
+    ecs_trace_event_t *events;
+    int32_t size;                /* Number of events (power of 2) */
+    uint64_t head;               /* Total number of recorded events */
+} ecs_trace_buffer_t;
+#endif
+
+#ifdef FLECS_PERF_COUNTERS
+/* Hardware counters collected for a system */
+typedef struct ecs_perf_counters_t {
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t cache_misses;       /* Last level cache misses */
+    uint64_t branch_misses;
+} ecs_perf_counters_t;
+
+#define FLECS_PERF_COUNTER_COUNT\
+    ((int32_t)(sizeof(ecs_perf_counters_t) / sizeof(uint64_t)))
+
+/* Hardware counters of a stage. Counters are opened by the thread that runs
+ * the stage, and only count events for that thread. */
+typedef struct ecs_stage_perf_t {
+    int32_t fd[FLECS_PERF_COUNTER_COUNT];   /* Descriptors (-1 if unavailable) */
+    int32_t slot[FLECS_PERF_COUNTER_COUNT]; /* Index in group read (or -1) */
+    int32_t slot_count;          /* Number of counters in group */
+    bool initialized;            /* Whether counters have been opened */
+    ecs_map_t systems;           /* map<system, ecs_perf_counters_t> */
+} ecs_stage_perf_t;
+#endif
+
 struct ecs_stage_t {
     ecs_header_t hdr;
 
@@ -487,6 +550,18 @@ struct ecs_stage_t {
     /* Thread specific allocators */
     ecs_stage_allocators_t allocators;
     ecs_allocator_t allocator;
+
+#ifdef FLECS_TRACING
+    ecs_trace_buffer_t *trace;   /* Trace events (NULL if not tracing) */
+#endif
+
+#ifdef FLECS_PERF_COUNTERS
+    ecs_stage_perf_t perf;       /* Hardware counters for systems */
+#endif
+
+#ifdef FLECS_QUERY_COUNTERS
+    ecs_map_t query_counters;    /* map<ecs_query_t*, ecs_query_counters_t> */
+#endif
 };
 
 /* Component monitor */
@@ -528,6 +603,11 @@ typedef struct ecs_store_t {
     ecs_vector_t *marked_ids;    /* vector<ecs_marked_ids_t> */
 } ecs_store_t;
 
+/* Thread that reads the world while it is in a reader window */
+typedef struct ecs_reader_t {
+    bool stop;                   /* Set when the reader should stop */
+} ecs_reader_t;
+
 /* fini actions */
 typedef struct ecs_action_elem_t {
     ecs_fini_action_t action;
@@ -572,6 +652,13 @@ struct ecs_world_t {
     /* Used to track when cache needs to be updated */
     ecs_monitor_set_t monitors;    /* map<id, ecs_monitor_t> */
 
+    /* -- Query matching -- */
+    ecs_map_t query_index;         /* map<id, ecs_vec_t<ecs_query_t*>> */
+    ecs_vec_t unindexed_queries;   /* Queries evaluated for each new table */
+    ecs_vec_t pending_queries;     /* Queries created while notifying index */
+    int32_t query_index_notifying; /* Is query index being notified */
+    bool query_index_dirty;        /* Index has queries removed while notifying */
+
     /* -- Systems -- */
     ecs_entity_t pipeline;             /* Current pipeline */
 
@@ -590,6 +677,13 @@ struct ecs_world_t {
     int32_t workers_running;     /* Number of threads running */
     int32_t workers_waiting;     /* Number of workers waiting on sync */
 
+    /* -- Readers -- */
+    ecs_os_mutex_t reader_mutex; /* Mutex for reader state */
+    ecs_os_cond_t reader_cond;   /* Signal that reader window changed */
+    int32_t reader_count;        /* Number of registered readers */
+    int32_t readers_active;      /* Number of readers accessing the world */
+    bool reader_window_open;     /* Readers may access the world */
+
     /* -- Time management -- */
     ecs_time_t world_start_time; /* Timestamp of simulation start */
     ecs_time_t frame_start_time; /* Timestamp of frame start */
@@ -598,6 +692,13 @@ struct ecs_world_t {
     /* -- Metrics -- */
     ecs_world_info_t info;
 
+#ifdef FLECS_STATS
+    /* -- Latency histograms -- */
+    ecs_histogram_t frame_time_hist;
+    ecs_histogram_t merge_time_hist;
+    ecs_histogram_t sync_time_hist;
+#endif
+
     /* -- World flags -- */
     ecs_flags32_t flags;
 
@@ -607,6 +708,11 @@ struct ecs_world_t {
 
     void *context;               /* Application context */
     ecs_vector_t *fini_actions;  /* Callbacks to execute when world exits */
+
+#ifdef FLECS_TRACING
+    int32_t trace_size;          /* Events per stage (0 if not tracing) */
+    uint64_t trace_start;        /* Timestamp when tracing started */
+#endif
 };
 
 #endif
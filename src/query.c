@@ -560,19 +560,47 @@ bool flecs_query_check_match_monitor_term(
     return monitor[term] != cur.dirty_state[cur.column + 1];
 }
 
-/* Check if any term for match has changed */
+/* Check if shared field has changed */
 static
-bool flecs_query_check_match_monitor(
-    ecs_query_t *query,
-    ecs_query_table_match_t *match)
+bool flecs_query_check_shared_monitor(
+    ecs_world_t *world,
+    ecs_query_table_match_t *match,
+    int32_t field,
+    int32_t mon)
 {
-    ecs_assert(match != NULL, ECS_INTERNAL_ERROR, NULL);
+    int32_t column = match->columns[field];
+    if (!column) {
+        /* Not matched */
+        return false;
+    }
 
-    if (flecs_query_get_match_monitor(query, match)) {
-        return true;
+    ecs_assert(column < 0, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t ref_index = -column - 1;
+    ecs_ref_t *ref = ecs_vec_get_t(&match->refs, ecs_ref_t, ref_index);
+    if (ref->id != 0) {
+        ecs_ref_update(world, ref);
+        ecs_table_record_t *tr = ref->tr;
+        ecs_table_t *src_table = tr->hdr.table;
+        column = tr->column;
+        column = ecs_table_type_to_storage_index(src_table, column);
+        int32_t *src_dirty_state = flecs_table_get_dirty_state(
+            world, src_table);
+        if (mon != src_dirty_state[column + 1]) {
+            return true;
+        }
     }
 
-    int32_t *monitor = match->monitor;
+    return false;
+}
+
+/* Check if any term for match has changed since monitor was synchronized */
+static
+bool flecs_query_check_monitor(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match,
+    const int32_t *monitor)
+{
     ecs_table_t *table = match->node.table;
     int32_t *dirty_state = flecs_table_get_dirty_state(query->world, table);
     ecs_assert(dirty_state != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -584,8 +612,6 @@ bool flecs_query_check_match_monitor(
     ecs_world_t *world = query->world;
     int32_t i, field_count = query->filter.field_count;
     int32_t *storage_columns = match->storage_columns;
-    int32_t *columns = match->columns;
-    ecs_vec_t *refs = &match->refs;
     for (i = 0; i < field_count; i ++) {
         int32_t mon = monitor[i + 1];
         if (mon == -1) {
@@ -603,41 +629,134 @@ bool flecs_query_check_match_monitor(
             continue; /* owned but not a component */
         }
 
-        column = columns[i];
-        if (!column) {
-            /* Not matched */
-            continue;
+        if (flecs_query_check_shared_monitor(world, match, i, mon)) {
+            return true;
         }
+    }
 
-        ecs_assert(column < 0, ECS_INTERNAL_ERROR, NULL);
+    return false;
+}
 
-        int32_t ref_index = -column - 1;
-        ecs_ref_t *ref = ecs_vec_get_t(refs, ecs_ref_t, ref_index);
-        if (ref->id != 0) {
-            ecs_ref_update(world, ref);
-            ecs_table_record_t *tr = ref->tr;
-            ecs_table_t *src_table = tr->hdr.table;
-            column = tr->column;
-            column = ecs_table_type_to_storage_index(src_table, column);
-            int32_t *src_dirty_state = flecs_table_get_dirty_state(
-                world, src_table);
-            if (mon != src_dirty_state[column + 1]) {
-                return true;
+/* Check if any term for match has changed */
+static
+bool flecs_query_check_match_monitor(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match)
+{
+    ecs_assert(match != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (flecs_query_get_match_monitor(query, match)) {
+        return true;
+    }
+
+    return flecs_query_check_monitor(query, match, match->monitor);
+}
+
+/* Store the match monitor before iterating the changed rows of a match. The
+ * match monitor is synchronized after each result, while all results for the
+ * match should be tested against the state from before the first result. */
+static
+void flecs_query_init_changed_monitor(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match)
+{
+    if (!match->changed_monitor) {
+        match->changed_monitor = flecs_balloc(&query->allocators.monitors);
+    }
+
+    /* If the match didn't have a monitor yet, the new monitor has 0 for all
+     * fields, which is lower than any column or row state. */
+    flecs_query_get_match_monitor(query, match);
+    int32_t field_count = query->filter.field_count;
+    ecs_os_memcpy_n(match->changed_monitor, match->monitor, int32_t, 
+        (field_count + 1));
+}
+
+typedef struct {
+    const ecs_world_t *stage;
+    ecs_query_t *query;
+    ecs_query_table_match_t *match;
+} flecs_query_select_ctx_t;
+
+/* Deselect rows for which none of the monitored fields changed */
+static
+bool flecs_query_select_changed(
+    void *ctx,
+    int32_t row,
+    int32_t count,
+    uint8_t *sel)
+{
+    flecs_query_select_ctx_t *select_ctx = ctx;
+    ecs_query_t *query = select_ctx->query;
+    ecs_query_table_match_t *match = select_ctx->match;
+    ecs_table_t *table = match->node.table;
+    const int32_t *monitor = match->changed_monitor;
+    ecs_vec_t *rows = table->dirty_rows;
+    bool monitored = false;
+    flecs_query_counter_add(select_ctx->stage, query, change_check_count, 1);
+
+    if (rows) {
+        uint8_t changed[FLECS_ROW_BLOCK_SIZE] = {0};
+        ecs_assert(count <= FLECS_ROW_BLOCK_SIZE, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(ecs_vec_count(rows) == ecs_table_count(table), 
+            ECS_INTERNAL_ERROR, NULL);
+
+        ecs_world_t *world = query->world;
+        int32_t i, field_count = query->filter.field_count;
+        int32_t column_count = table->storage_count;
+        int32_t *storage_columns = match->storage_columns;
+        const int32_t *states = ECS_ELEM_T(ecs_vec_first(rows), int32_t, 
+            row * column_count);
+
+        for (i = 0; i < field_count; i ++) {
+            int32_t mon = monitor[i + 1];
+            if (mon == -1) {
+                continue;
+            }
+
+            int32_t r, column = storage_columns[i];
+            if (column >= 0) {
+                for (r = 0; r < count; r ++) {
+                    changed[r] |= (uint8_t)(
+                        states[r * column_count + column] > mon);
+                }
+                monitored = true;
+            } else if (column != -1) {
+                if (flecs_query_check_shared_monitor(world, match, i, mon)) {
+                    /* Shared component changed, which changes all rows */
+                    return true;
+                }
             }
         }
+
+        if (monitored) {
+            for (i = 0; i < count; i ++) {
+                sel[i] &= changed[i];
+            }
+            return true;
+        }
     }
 
-    return false;
+    /* If rows aren't tracked, all rows changed if the table changed */
+    if (!flecs_query_check_monitor(query, match, monitor)) {
+        ecs_os_memset(sel, 0, count);
+        return false;
+    }
+
+    return true;
 }
 
 /* Check if any term for matched table has changed */
 static
 bool flecs_query_check_table_monitor(
+    const ecs_world_t *stage,
     ecs_query_t *query,
     ecs_query_table_t *table,
     int32_t term)
 {
     ecs_query_table_node_t *cur, *end = table->last->node.next;
+    flecs_query_counter_add(stage, query, change_check_count, 1);
+    (void)stage;
 
     for (cur = &table->first->node; cur != end; cur = cur->next) {
         ecs_query_table_match_t *match = (ecs_query_table_match_t*)cur;
@@ -663,7 +782,9 @@ bool flecs_query_check_query_monitor(
     if (flecs_table_cache_iter(&query->cache, &it)) {
         ecs_query_table_t *qt;
         while ((qt = flecs_table_cache_next(&it, ecs_query_table_t))) {
-            if (flecs_query_check_table_monitor(query, qt, -1)) {
+            if (flecs_query_check_table_monitor(
+                query->world, query, qt, -1)) 
+            {
                 return true;
             }
         }
@@ -744,6 +865,10 @@ ecs_query_table_match_t* flecs_query_add_table_match(
     qm->sources = flecs_balloc(&query->allocators.sources);
     qm->sizes = flecs_balloc(&query->allocators.sizes);
 
+    if (table && (query->flags & EcsQueryTrackRows)) {
+        flecs_table_track_rows(query->world, table);
+    }
+
     /* Insert match to iteration list if table is not empty */
     if (!table || ecs_table_count(table) != 0) {
         flecs_query_insert_table_node(query, &qm->node);
@@ -843,6 +968,9 @@ void flecs_query_set_table_match(
                         &qm->bitset_columns, flecs_bitset_term_t);
                     bc->column_index = bs_index;
                     bc->bs_column = NULL;
+
+                    /* Fast path iterator doesn't check for disabled fields */
+                    query->flags &= ~EcsQueryIsTrivial;
                 }
             }
         }
@@ -868,6 +996,7 @@ void flecs_query_set_table_match(
 
             if (id) {
                 flecs_query_add_ref(world, query, qm, id, src, size);
+                query->flags &= ~EcsQueryIsTrivial;
 
                 /* Use column index to bind term and ref */
                 if (qm->columns[field] != 0) {
@@ -891,6 +1020,7 @@ void flecs_query_match_tables(
     ECS_BIT_SET(it.flags, EcsIterIsInstanced);
     ECS_BIT_SET(it.flags, EcsIterIsFilter);
     ECS_BIT_SET(it.flags, EcsIterEntityOptional);
+    ECS_BIT_SET(it.flags, EcsIterIgnorePredicates);
 
     while (ecs_filter_next(&it)) {
         if ((table != it.table) || (!it.table && !qt)) {
@@ -923,8 +1053,11 @@ bool flecs_query_match_table(
         return false;
     }
 
+    world->info.table_match_total ++;
+
     ecs_iter_t it = flecs_filter_iter_w_flags(world, filter, EcsIterMatchVar|
-        EcsIterIsInstanced|EcsIterIsFilter|EcsIterEntityOptional);
+        EcsIterIsInstanced|EcsIterIsFilter|EcsIterEntityOptional|
+        EcsIterIgnorePredicates);
     ecs_iter_set_var_as_table(&it, var_id, table);
 
     while (ecs_filter_next(&it)) {
@@ -1181,6 +1314,7 @@ void flecs_query_build_sorted_tables(
 static
 void flecs_query_sort_tables(
     ecs_world_t *world,
+    const ecs_world_t *stage,
     ecs_query_t *query)
 {
     ecs_order_by_action_t compare = query->order_by;
@@ -1188,6 +1322,14 @@ void flecs_query_sort_tables(
         return;
     }
 
+#ifdef FLECS_QUERY_COUNTERS
+    ecs_time_t t = {0};
+    bool measure_time = ecs_os_has_time();
+    if (measure_time) {
+        ecs_time_measure(&t);
+    }
+#endif
+
     ecs_sort_table_action_t sort = query->sort_table;
     
     ecs_entity_t order_by_component = query->order_by_component;
@@ -1225,13 +1367,15 @@ void flecs_query_sort_tables(
         ecs_table_t *table = qt->hdr.table;
         bool dirty = false;
 
-        if (flecs_query_check_table_monitor(query, qt, 0)) {
+        if (flecs_query_check_table_monitor(stage, query, qt, 0)) {
             dirty = true;
         }
 
         int32_t column = -1;
         if (order_by_component) {
-            if (flecs_query_check_table_monitor(query, qt, order_by_term + 1)) {
+            if (flecs_query_check_table_monitor(
+                stage, query, qt, order_by_term + 1)) 
+            {
                 dirty = true;
             }
 
@@ -1264,6 +1408,13 @@ void flecs_query_sort_tables(
         flecs_query_build_sorted_tables(query);
         query->match_count ++; /* Increase version if tables changed */
     }
+
+#ifdef FLECS_QUERY_COUNTERS
+    if (measure_time) {
+        flecs_query_counter_add(stage, query, sort_time, 
+            (ecs_ftime_t)ecs_time_measure(&t));
+    }
+#endif
 }
 
 static
@@ -1476,6 +1627,9 @@ void flecs_query_table_match_free(
         if (cur->monitor) {
             flecs_bfree(&query->allocators.monitors, cur->monitor);
         }
+        if (cur->changed_monitor) {
+            flecs_bfree(&query->allocators.monitors, cur->changed_monitor);
+        }
         if (cur->refs.array) {
             ecs_allocator_t *a = &query->world->allocator;
             ecs_vec_fini_t(a, &cur->refs, ecs_ref_t);
@@ -1537,12 +1691,17 @@ void flecs_query_rematch_tables(
     ECS_BIT_SET(it.flags, EcsIterIsInstanced);
     ECS_BIT_SET(it.flags, EcsIterIsFilter);
     ECS_BIT_SET(it.flags, EcsIterEntityOptional);
+    ECS_BIT_SET(it.flags, EcsIterIgnorePredicates);
 
     world->info.rematch_count_total ++;
     int32_t rematch_count = ++ query->rematch_count;
 
     ecs_time_t t = {0};
-    if (world->flags & EcsWorldMeasureFrameTime) {
+    bool measure_time = (world->flags & EcsWorldMeasureFrameTime) != 0;
+#ifdef FLECS_QUERY_COUNTERS
+    measure_time |= ecs_os_has_time();
+#endif
+    if (measure_time) {
         ecs_time_measure(&t);
     }
 
@@ -1600,8 +1759,12 @@ void flecs_query_rematch_tables(
         }
     }
 
-    if (world->flags & EcsWorldMeasureFrameTime) {
-        world->info.rematch_time_total += (ecs_ftime_t)ecs_time_measure(&t);
+    if (measure_time) {
+        ecs_ftime_t rematch_time = (ecs_ftime_t)ecs_time_measure(&t);
+        if (world->flags & EcsWorldMeasureFrameTime) {
+            world->info.rematch_time_total += rematch_time;
+        }
+        flecs_query_counter_add(world, query, rematch_time, rematch_time);
     }
 }
 
@@ -1628,6 +1791,399 @@ void flecs_query_remove_subquery(
 
 /* -- Private API -- */
 
+/* Get id that a table must have for a term to match, or 0 if there is no such
+ * id. Tables store records for wildcard pairs, but union relationships are
+ * stored as (Union, Relationship), which can't be matched by relationship. */
+static
+ecs_id_t flecs_query_index_term_id(
+    ecs_world_t *world,
+    const ecs_term_t *term)
+{
+    ecs_id_t id = term->id;
+    if (!id || id == EcsWildcard || id == EcsAny) {
+        return 0;
+    }
+
+    if (ECS_IS_PAIR(id)) {
+        ecs_entity_t first = ECS_PAIR_FIRST(id);
+        ecs_entity_t second = ECS_PAIR_SECOND(id);
+        if (first == EcsWildcard || first == EcsAny || second == EcsAny) {
+            return 0;
+        }
+
+        first = ecs_get_alive(world, first);
+        if (first && ecs_has_id(world, first, EcsUnion)) {
+            return 0;
+        }
+    } else if (id & ECS_ID_FLAGS_MASK) {
+        return 0;
+    }
+
+    return id;
+}
+
+/** A query is trivial if it only has And terms that match components on $this
+ * by id, without predicates or sorting. Results of such a query only need the
+ * table, count and column pointers, which lets the iterator skip the generic
+ * code that deals with sparse columns, bitsets and references. Terms may still
+ * traverse relationships: the flag is cleared when a table is matched that
+ * needs references or bitsets, after which the query uses the regular path. */
+static
+bool flecs_query_is_trivial(
+    ecs_world_t *world,
+    const ecs_query_t *query,
+    const ecs_query_desc_t *desc)
+{
+    const ecs_filter_t *filter = &query->filter;
+    if (!filter->term_count || desc->order_by) {
+        return false;
+    }
+
+    if (!(filter->flags & EcsFilterMatchOnlyThis)) {
+        return false;
+    }
+
+    if (filter->flags & EcsFilterHasPredicates) {
+        return false;
+    }
+
+    if (query->cascade_by) {
+        return false;
+    }
+
+    int32_t i, count = filter->term_count;
+    for (i = 0; i < count; i ++) {
+        ecs_term_t *term = &filter->terms[i];
+        if (term->oper != EcsAnd) {
+            return false;
+        }
+        if (!ecs_term_match_this(term)) {
+            return false;
+        }
+        if (term->src.flags & EcsDown) {
+            return false;
+        }
+        if (flecs_query_index_term_id(world, term) != term->id) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static
+int32_t flecs_query_index_id_table_count(
+    ecs_world_t *world,
+    ecs_id_t id)
+{
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr) {
+        return 0;
+    }
+
+    return flecs_table_cache_count(&idr->cache) + 
+        flecs_table_cache_empty_count(&idr->cache);
+}
+
+static
+void flecs_query_index_register(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_id_t id)
+{
+    ecs_vec_t *queries = ecs_map_ensure(&world->query_index, ecs_vec_t, id);
+    if (!queries->array) {
+        ecs_vec_init_t(&world->allocator, queries, ecs_query_t*, 0);
+    }
+    ecs_vec_append_t(&world->allocator, queries, ecs_query_t*)[0] = query;
+}
+
+/* Remove query from index vector. While the index is being notified, the
+ * query is replaced with NULL so that the notify loop doesn't skip queries, 
+ * and the vector is compacted after notifying. */
+static
+void flecs_query_index_unregister(
+    ecs_world_t *world,
+    ecs_vec_t *queries,
+    ecs_query_t *query)
+{
+    ecs_query_t **array = ecs_vec_first(queries);
+    int32_t i, count = ecs_vec_count(queries);
+    for (i = 0; i < count; i ++) {
+        if (array[i] == query) {
+            if (world->query_index_notifying) {
+                array[i] = NULL;
+                world->query_index_dirty = true;
+            } else {
+                ecs_vec_remove_t(queries, ecs_query_t*, i);
+            }
+            return;
+        }
+    }
+}
+
+/* Add query to index vectors */
+static
+void flecs_query_index_insert(
+    ecs_world_t *world,
+    ecs_query_t *query)
+{
+    if (!query->index_ids[0] && !query->index_ids[1]) {
+        ecs_vec_append_t(&world->allocator, &world->unindexed_queries, 
+            ecs_query_t*)[0] = query;
+    } else {
+        int32_t i;
+        for (i = 0; i < 2; i ++) {
+            if (query->index_ids[i]) {
+                flecs_query_index_register(world, query, query->index_ids[i]);
+            }
+        }
+    }
+}
+
+/* Remove NULL entries & empty vectors from index after notifying */
+static
+void flecs_query_index_compact(
+    ecs_world_t *world)
+{
+    ecs_allocator_t *a = &world->allocator;
+    ecs_vec_t empty;
+    ecs_vec_init_t(a, &empty, ecs_id_t, 0);
+
+    ecs_map_iter_t it = ecs_map_iter(&world->query_index);
+    ecs_vec_t *queries;
+    ecs_map_key_t id;
+    while ((queries = ecs_map_next(&it, ecs_vec_t, &id))) {
+        int32_t i;
+        for (i = ecs_vec_count(queries) - 1; i >= 0; i --) {
+            if (!ecs_vec_get_t(queries, ecs_query_t*, i)[0]) {
+                ecs_vec_remove_t(queries, ecs_query_t*, i);
+            }
+        }
+        if (!ecs_vec_count(queries)) {
+            ecs_vec_append_t(a, &empty, ecs_id_t)[0] = id;
+        }
+    }
+
+    ecs_id_t *ids = ecs_vec_first_t(&empty, ecs_id_t);
+    int32_t i, count = ecs_vec_count(&empty);
+    for (i = 0; i < count; i ++) {
+        queries = ecs_map_get(&world->query_index, ecs_vec_t, ids[i]);
+        ecs_vec_fini_t(a, queries, ecs_query_t*);
+        ecs_map_remove(&world->query_index, ids[i]);
+    }
+    ecs_vec_fini_t(a, &empty, ecs_id_t);
+
+    for (i = ecs_vec_count(&world->unindexed_queries) - 1; i >= 0; i --) {
+        if (!ecs_vec_get_t(&world->unindexed_queries, ecs_query_t*, i)[0]) {
+            ecs_vec_remove_t(&world->unindexed_queries, ecs_query_t*, i);
+        }
+    }
+
+    world->query_index_dirty = false;
+}
+
+/* Add query to the index that is used to find the queries that can match a new
+ * table. Queries are indexed by their most selective term, which is the term
+ * with the id that occurs in the fewest tables. Terms that can be matched by
+ * traversing a relationship are indexed by both the id and (Relationship, *),
+ * which a table must have to inherit the id. Queries without And terms for
+ * $this with a (non-wildcard) id are evaluated for each table. */
+static
+void flecs_query_index_add(
+    ecs_world_t *world,
+    ecs_query_t *query)
+{
+    ecs_filter_t *filter = &query->filter;
+    ecs_term_t *terms = filter->terms;
+    int32_t i, term_count = filter->term_count;
+    int32_t best_count = -1;
+    uint64_t bloom = 0;
+
+    for (i = 0; i < term_count; i ++) {
+        ecs_term_t *term = &terms[i];
+        if (term->oper != EcsAnd || !ecs_term_match_this(term)) {
+            continue;
+        }
+
+        ecs_id_t id = flecs_query_index_term_id(world, term);
+        if (!id) {
+            continue;
+        }
+
+        ecs_flags32_t flags = term->src.flags;
+        ecs_id_t keys[2] = {0};
+        int32_t count = 0;
+        if (flags & EcsSelf) {
+            keys[0] = id;
+            count += flecs_query_index_id_table_count(world, id);
+        }
+
+        if (flags & EcsUp) {
+            ecs_assert(term->src.trav != 0, ECS_INTERNAL_ERROR, NULL);
+            keys[1] = ecs_pair(term->src.trav, EcsWildcard);
+            count += flecs_query_index_id_table_count(world, keys[1]);
+        } else {
+            /* Table must have id, add it to query signature */
+            bloom |= flecs_id_bloom(id);
+        }
+
+        if (!keys[0] && !keys[1]) {
+            continue;
+        }
+
+        if (best_count == -1 || count < best_count) {
+            query->index_ids[0] = keys[0];
+            query->index_ids[1] = keys[1];
+            best_count = count;
+        }
+    }
+
+    query->bloom = bloom;
+
+    if (world->query_index_notifying) {
+        /* Registering the query could reallocate the vectors or the map that
+         * are being iterated. The query already matched existing tables, so
+         * it doesn't need to be notified of the current table. */
+        ecs_vec_append_t(&world->allocator, &world->pending_queries, 
+            ecs_query_t*)[0] = query;
+    } else {
+        flecs_query_index_insert(world, query);
+    }
+}
+
+static
+void flecs_query_index_remove(
+    ecs_world_t *world,
+    ecs_query_t *query)
+{
+    /* Query was created while notifying and isn't registered yet */
+    ecs_query_t **pending = ecs_vec_first_t(
+        &world->pending_queries, ecs_query_t*);
+    int32_t i, count = ecs_vec_count(&world->pending_queries);
+    for (i = 0; i < count; i ++) {
+        if (pending[i] == query) {
+            ecs_vec_remove_t(&world->pending_queries, ecs_query_t*, i);
+            return;
+        }
+    }
+
+    if (!query->index_ids[0] && !query->index_ids[1]) {
+        flecs_query_index_unregister(world, &world->unindexed_queries, query);
+        return;
+    }
+
+    for (i = 0; i < 2; i ++) {
+        ecs_id_t id = query->index_ids[i];
+        if (!id) {
+            continue;
+        }
+
+        ecs_vec_t *queries = ecs_map_get(&world->query_index, ecs_vec_t, id);
+        ecs_assert(queries != NULL, ECS_INTERNAL_ERROR, NULL);
+        flecs_query_index_unregister(world, queries, query);
+        if (!world->query_index_notifying && !ecs_vec_count(queries)) {
+            ecs_vec_fini_t(&world->allocator, queries, ecs_query_t*);
+            ecs_map_remove(&world->query_index, id);
+        }
+    }
+}
+
+static
+void flecs_query_index_notify_queries(
+    ecs_world_t *world,
+    ecs_vec_t *queries,
+    ecs_query_event_t *event,
+    int32_t event_id)
+{
+    uint64_t bloom = event->table->bloom;
+    int32_t i;
+
+    /* Notifying a query can run group callbacks that create or delete queries.
+     * While notifying, created queries are added to pending_queries and 
+     * deleted queries are replaced with NULL, so the vector doesn't move. */
+    for (i = 0; i < ecs_vec_count(queries); i ++) {
+        ecs_query_t *query = ecs_vec_get_t(queries, ecs_query_t*, i)[0];
+        if (!query) {
+            continue; /* Query was deleted while notifying */
+        }
+
+        if ((query->bloom & bloom) != query->bloom) {
+            continue; /* Table is missing an id required by the query */
+        }
+
+        if (query->match_event_id == event_id) {
+            continue; /* Already notified through other index id */
+        }
+
+        query->match_event_id = event_id;
+        ecs_poly_assert(query, ecs_query_t);
+        flecs_query_notify(world, query, event);
+    }
+}
+
+void flecs_query_index_notify(
+    ecs_world_t *world,
+    ecs_query_event_t *event)
+{
+    ecs_table_t *table = event->table;
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    int32_t event_id = ++ world->event_id;
+
+    world->query_index_notifying ++;
+
+    flecs_query_index_notify_queries(world, &world->unindexed_queries, 
+        event, event_id);
+
+    /* Table records include wildcard ids, so iterating them finds queries that
+     * are indexed by a wildcard */
+    if (ecs_map_count(&world->query_index)) {
+        int32_t i, count = table->record_count;
+        for (i = 0; i < count; i ++) {
+            ecs_table_record_t *tr = &table->records[i];
+            ecs_id_record_t *idr = (ecs_id_record_t*)tr->hdr.cache;
+            ecs_vec_t *queries = ecs_map_get(
+                &world->query_index, ecs_vec_t, idr->id);
+            if (queries) {
+                flecs_query_index_notify_queries(
+                    world, queries, event, event_id);
+            }
+        }
+    }
+
+    if (-- world->query_index_notifying) {
+        return;
+    }
+
+    /* Apply changes to index that were made while notifying */
+    if (world->query_index_dirty) {
+        flecs_query_index_compact(world);
+    }
+
+    int32_t i, count = ecs_vec_count(&world->pending_queries);
+    if (count) {
+        ecs_query_t **pending = ecs_vec_first_t(
+            &world->pending_queries, ecs_query_t*);
+        for (i = 0; i < count; i ++) {
+            flecs_query_index_insert(world, pending[i]);
+        }
+        ecs_vec_clear(&world->pending_queries);
+    }
+}
+
+void flecs_query_index_fini(
+    ecs_world_t *world)
+{
+    ecs_map_iter_t it = ecs_map_iter(&world->query_index);
+    ecs_vec_t *queries;
+    while ((queries = ecs_map_next(&it, ecs_vec_t, NULL))) {
+        ecs_vec_fini_t(&world->allocator, queries, ecs_query_t*);
+    }
+    ecs_map_fini(&world->query_index);
+    ecs_vec_fini_t(&world->allocator, &world->unindexed_queries, ecs_query_t*);
+    ecs_vec_fini_t(&world->allocator, &world->pending_queries, ecs_query_t*);
+}
+
 void flecs_query_notify(
     ecs_world_t *world,
     ecs_query_t *query,
@@ -1683,7 +2239,7 @@ void flecs_query_order_by(
     ecs_vector_free(query->table_slices);
     query->table_slices = NULL;
 
-    flecs_query_sort_tables(world, query);  
+    flecs_query_sort_tables(world, world, query);  
 
     if (!query->table_slices) {
         flecs_query_build_sorted_tables(query);
@@ -1844,6 +2400,8 @@ void flecs_query_fini(
         !(query->flags & EcsQueryIsOrphaned))
     {
         flecs_query_remove_subquery(query->parent, query);
+    } else if (!(query->flags & EcsQueryIsSubquery)) {
+        flecs_query_index_remove(world, query);
     }
 
     flecs_query_notify_subqueries(world, query, &(ecs_query_event_t){
@@ -1862,6 +2420,15 @@ void flecs_query_fini(
 
     flecs_query_allocators_fini(query);
 
+#ifdef FLECS_QUERY_COUNTERS
+    /* Remove counters, so a new query at the same address starts at 0 */
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        ecs_map_remove(&world->stages[i].query_counters, 
+            (ecs_map_key_t)(uintptr_t)query);
+    }
+#endif
+
     ecs_poly_free(query, ecs_query_t);
 }
 
@@ -1929,6 +2496,10 @@ ecs_query_t* ecs_query_init(
         goto error;
     }
 
+    if (flecs_query_is_trivial(world, result, desc)) {
+        result->flags |= EcsQueryIsTrivial;
+    }
+
     /* Group before matching so we won't have to move tables around later */
     int32_t cascade_by = result->cascade_by;
     if (cascade_by) {
@@ -1952,6 +2523,19 @@ ecs_query_t* ecs_query_init(
         result->flags |= EcsQueryIsSubquery;
     }
 
+    if (desc->prefetch) {
+        result->flags |= EcsQueryPrefetch;
+    }
+
+    ecs_check(desc->max_batch >= 0, ECS_INVALID_PARAMETER, NULL);
+    result->max_batch = desc->max_batch;
+
+    if (desc->track_rows) {
+        /* Monitors are created when tables are matched, so that iterating the
+         * query establishes what changes the query has seen */
+        result->flags |= EcsQueryTrackRows | EcsQueryHasMonitor;
+    }
+
     /* If the query refers to itself, add the components that were queried for
      * to the query itself. */
     if (entity)  {
@@ -1984,6 +2568,7 @@ ecs_query_t* ecs_query_init(
 
     if (!desc->parent) {
         flecs_query_match_tables(world, result);
+        flecs_query_index_add(world, result);
     } else {
         flecs_query_add_subquery(world, desc->parent, result);
         result->parent = desc->parent;
@@ -2042,7 +2627,7 @@ ecs_iter_t ecs_query_iter(
     flecs_process_pending_tables(world);
 
     /* If query has order_by, apply sort */
-    flecs_query_sort_tables(world, query);
+    flecs_query_sort_tables(world, stage, query);
 
     /* If monitors changed, do query rematching */
     if (!(world->flags & EcsWorldReadonly) && query->flags & EcsQueryHasRefs) {
@@ -2159,6 +2744,90 @@ error:
     return;
 }
 
+/** Weight used to balance groups across workers. Tables are counted in addition
+ * to entities, as each table adds a fixed overhead to iteration. */
+static
+int64_t flecs_query_group_weight(
+    const ecs_query_table_list_t *group)
+{
+    int64_t result = 0;
+    ecs_query_table_node_t *node, *last = group->last->next;
+    for (node = group->first; node != last; node = node->next) {
+        int32_t count = node->count;
+        if (!count && node->table) {
+            count = ecs_table_count(node->table);
+        }
+        result += count + 1;
+    }
+    return result;
+}
+
+void ecs_query_set_group_worker(
+    ecs_iter_t *it,
+    int32_t index,
+    int32_t count)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!(it->flags & EcsIterIsValid), ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index < count, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_query_iter_t *qit = &it->priv.iter.query;
+    ecs_query_t *q = qit->query;
+    ecs_check(q != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(q->group_by != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    /* Groups are stored as contiguous ranges in the list of query nodes. Split
+     * up the list in count ranges of whole groups with roughly equal weight, so
+     * that each worker can iterate its groups as a single range. A group is
+     * assigned to the worker that owns the midpoint of the group's weight. All
+     * workers compute the same ranges, as this only depends on the cache. */
+    ecs_query_table_node_t *node, *last = qit->last;
+    int64_t total = 0;
+    for (node = qit->node; node != last; ) {
+        ecs_query_table_list_t *group = flecs_query_get_group(
+            q, node->group_id);
+        ecs_assert(group != NULL, ECS_INTERNAL_ERROR, NULL);
+        total += flecs_query_group_weight(group);
+        node = group->last->next;
+    }
+
+    ecs_query_table_node_t *first = NULL;
+    int64_t cur = 0;
+    for (node = qit->node; node != last; ) {
+        ecs_query_table_list_t *group = flecs_query_get_group(
+            q, node->group_id);
+        int64_t weight = flecs_query_group_weight(group);
+        int64_t owner = ((cur * 2 + weight) * count) / (total * 2);
+        cur += weight;
+        node = group->last->next;
+
+        if (owner < index) {
+            continue;
+        }
+        if (owner > index) {
+            last = group->first;
+            break;
+        }
+        if (!first) {
+            first = group->first;
+        }
+    }
+
+    if (first) {
+        qit->node = first;
+        qit->last = last;
+    } else {
+        qit->node = NULL;
+        qit->last = NULL;
+    }
+
+error:
+    return;
+}
+
 const ecs_query_group_info_t* ecs_query_get_group_info(
     ecs_query_t *query,
     uint64_t group_id)
@@ -2511,7 +3180,9 @@ done:
 static
 void flecs_query_mark_columns_dirty(
     ecs_query_t *query,
-    ecs_query_table_match_t *qm)
+    ecs_query_table_match_t *qm,
+    int32_t first,
+    int32_t count)
 {
     ecs_table_t *table = qm->node.table;
     if (!table) {
@@ -2523,9 +3194,9 @@ void flecs_query_mark_columns_dirty(
         int32_t *storage_columns = qm->storage_columns;
         ecs_filter_t *filter = &query->filter;
         ecs_term_t *terms = filter->terms;
-        int32_t i, count = filter->term_count;
+        int32_t i, term_count = filter->term_count;
 
-        for (i = 0; i < count; i ++) {
+        for (i = 0; i < term_count; i ++) {
             ecs_term_t *term = &terms[i];
             if (term->inout == EcsIn || term->inout == EcsInOutNone) {
                 /* Don't mark readonly terms dirty */
@@ -2538,7 +3209,8 @@ void flecs_query_mark_columns_dirty(
                 continue;
             }
 
-            dirty_state[column + 1] ++;
+            flecs_table_mark_rows_dirty(query->world, table, column, 
+                first, count);
         }
     }
 }
@@ -2558,7 +3230,8 @@ bool ecs_query_next_table(
     if ((query->flags & EcsQueryHasOutColumns)) {
         ecs_query_table_node_t *prev = iter->prev;
         if (prev && it->count) {
-            flecs_query_mark_columns_dirty(query, prev->match);
+            flecs_query_mark_columns_dirty(query, prev->match, 
+                0, ecs_table_count(prev->table));
         }
     }
 
@@ -2646,6 +3319,257 @@ error:
     return false;
 }
 
+/** Prefetch the first cache lines of the entities and component columns of a
+ * node, so that they are in cache by the time the node is iterated. */
+static
+void flecs_query_prefetch_node(
+    const ecs_query_table_node_t *node,
+    const ecs_query_table_node_t *last,
+    int32_t field_count)
+{
+    if (node == last) {
+        return;
+    }
+
+    ecs_query_table_match_t *match = node->match;
+    ecs_table_t *table = match->node.table;
+    if (!table) {
+        return;
+    }
+
+    int32_t offset = node->offset;
+    flecs_prefetch(ECS_ELEM_T(table->data.entities.array, ecs_entity_t, offset));
+
+    int32_t *storage_columns = match->storage_columns;
+    ecs_size_t *sizes = match->sizes;
+    ecs_vec_t *columns = table->data.columns;
+    int32_t i;
+    for (i = 0; i < field_count; i ++) {
+        int32_t column = storage_columns[i];
+        if (column < 0) {
+            continue;
+        }
+
+        flecs_prefetch(ECS_ELEM(columns[column].array, sizes[i], offset));
+    }
+}
+
+/** Limit result to the maximum batch size of the query. The rows that are left
+ * are returned by flecs_query_next_batch before moving on to the next node. */
+static
+int32_t flecs_query_batch(
+    ecs_iter_t *it,
+    ecs_query_table_node_t *node,
+    int32_t count)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    int32_t max_batch = iter->query->max_batch;
+    if (!max_batch || count <= max_batch) {
+        return count;
+    }
+
+    /* Results with shared fields are already returned one row at a time when
+     * the iterator is not instanced. */
+    if (ecs_vec_count(&node->match->refs) && 
+        !ECS_BIT_IS_SET(it->flags, EcsIterIsInstanced))
+    {
+        return count;
+    }
+
+    iter->batch_node = node;
+    iter->batch_left = count - max_batch;
+    return max_batch;
+}
+
+/** Return next batch of the current result. Only the entity and component
+ * pointers need to be updated, as everything else is the same for all batches
+ * of a result. */
+static
+bool flecs_query_next_batch(
+    ecs_iter_t *it)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    int32_t first = iter->prev_first + iter->prev_count;
+    int32_t count = iter->batch_left;
+    int32_t max_batch = iter->query->max_batch;
+    if (count > max_batch) {
+        count = max_batch;
+    }
+
+    iter->batch_left -= count;
+    iter->prev = iter->batch_node;
+    iter->prev_first = first;
+    iter->prev_count = count;
+
+    /* Repopulate pointers, as iterators that chain the query iterator (like
+     * the worker and page iterators) may have modified them. The batch is 
+     * part of the same table as the previous result, so keep frame offset. */
+    int32_t frame_offset = it->frame_offset;
+    it->instance_count = 0;
+    flecs_iter_populate_data(iter->query->world, it, it->table, first, count,
+        it->ptrs, NULL);
+    it->frame_offset = frame_offset;
+
+    if (!iter->skip_counters) {
+        flecs_query_count_result(iter->query, it);
+    }
+    return true;
+}
+
+/** Fast path for trivial queries. Every node in the list is a full table with
+ * fields that are all stored on $this, so the only things that change between
+ * results are the table, the count and the column pointers. */
+static
+bool flecs_query_next_trivial(
+    ecs_iter_t *it)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    ecs_query_table_node_t *node = iter->node;
+    if (node == iter->last) {
+        ecs_iter_fini(it);
+        return false;
+    }
+
+    ecs_query_table_match_t *match = node->match;
+    ecs_table_t *table = match->node.table;
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(match->bitset_columns == NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(match->sparse_columns == NULL, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t offset = node->offset, count = node->count;
+    if (!count) {
+        count = ecs_table_count(table);
+
+        /* List should never contain empty tables */
+        ecs_assert(count != 0, ECS_INTERNAL_ERROR, NULL);
+    }
+
+    count = flecs_query_batch(it, node, count);
+
+    ecs_table_t *prev_table = it->table;
+    if (prev_table) {
+        it->frame_offset += ecs_table_count(prev_table);
+    }
+
+    it->table = table;
+    it->offset = offset;
+    it->count = count;
+    it->group_id = match->node.group_id;
+    it->entities = ecs_vec_get_t(&table->data.entities, ecs_entity_t, offset);
+    it->ids = match->ids;
+    it->columns = match->columns;
+    it->sizes = match->sizes;
+    it->sources = match->sources;
+    it->references = NULL;
+    it->instance_count = 0;
+
+    void **ptrs = it->ptrs;
+    if (ptrs && !ECS_BIT_IS_SET(it->flags, EcsIterIsFilter)) {
+        int32_t *storage_columns = match->storage_columns;
+        ecs_size_t *sizes = match->sizes;
+        ecs_term_t *terms = it->terms;
+        int32_t i, field_count = it->field_count;
+        for (i = 0; i < field_count; i ++) {
+            /* Trivial queries only have And terms, so fields map to terms */
+            int32_t column = storage_columns[i];
+            if (column < 0 || terms[i].inout == EcsInOutNone) {
+                ptrs[i] = NULL;
+                continue;
+            }
+
+            ptrs[i] = ECS_ELEM(table->data.columns[column].array, 
+                sizes[i], offset);
+        }
+    }
+
+    ECS_BIT_CLEAR(it->flags, EcsIterHasShared);
+
+    if (iter->query->flags & EcsQueryPrefetch) {
+        flecs_query_prefetch_node(node->next, iter->last, it->field_count);
+    }
+
+    if (!iter->skip_counters) {
+        flecs_query_count_result(iter->query, it);
+    }
+
+    iter->node = node->next;
+    iter->prev = node;
+    iter->prev_first = offset;
+    iter->prev_count = count;
+    return true;
+}
+
+#ifdef FLECS_QUERY_COUNTERS
+ecs_query_counters_t* flecs_query_counters(
+    const ecs_world_t *stage,
+    ecs_query_t *query)
+{
+    ecs_stage_t *s;
+    if (ecs_poly_is(stage, ecs_stage_t)) {
+        s = (ecs_stage_t*)stage;
+    } else {
+        s = &((ecs_world_t*)stage)->stages[0];
+    }
+
+    return ecs_map_ensure(&s->query_counters, ecs_query_counters_t, 
+        (ecs_map_key_t)(uintptr_t)query);
+}
+
+void flecs_query_counters_get(
+    const ecs_world_t *world,
+    const ecs_query_t *query,
+    ecs_query_counters_t *out)
+{
+    ecs_os_zeromem(out);
+
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        const ecs_query_counters_t *src = ecs_map_get(
+            &world->stages[i].query_counters, ecs_query_counters_t, 
+            (ecs_map_key_t)(uintptr_t)query);
+        if (src) {
+            out->table_count += src->table_count;
+            out->entity_count += src->entity_count;
+            out->skip_count += src->skip_count;
+            out->change_check_count += src->change_check_count;
+            out->bytes_touched += src->bytes_touched;
+            out->rematch_time += src->rematch_time;
+            out->sort_time += src->sort_time;
+        }
+    }
+}
+
+void flecs_query_count_result(
+    ecs_query_t *query,
+    const ecs_iter_t *it)
+{
+    int32_t count = it->count;
+    ecs_query_counters_t *c = flecs_query_counters(it->world, query);
+    c->table_count ++;
+    c->entity_count += count;
+
+    void **ptrs = it->ptrs;
+    if (!ptrs) {
+        return;
+    }
+
+    const ecs_size_t *sizes = it->sizes;
+    int32_t i, field_count = it->field_count;
+    for (i = 0; i < field_count; i ++) {
+        if (!ptrs[i]) {
+            continue;
+        }
+
+        /* Shared fields only touch a single component value */
+        if (ecs_field_is_self(it, i + 1)) {
+            c->bytes_touched += sizes[i] * count;
+        } else {
+            c->bytes_touched += sizes[i];
+        }
+    }
+}
+#endif
+
 bool ecs_query_next_instanced(
     ecs_iter_t *it)
 {
@@ -2665,12 +3589,14 @@ bool ecs_query_next_instanced(
     query_iter_cursor_t cur;
     ecs_query_table_node_t *node, *next, *prev, *last;
     if ((prev = iter->prev)) {
-        /* Match has been iterated, update monitor for change tracking */
-        if (flags & EcsQueryHasMonitor) {
+        /* Match has been iterated, update monitor for change tracking. If the
+         * result was split up in batches, wait until the last batch. */
+        if ((flags & EcsQueryHasMonitor) && !iter->batch_left) {
             flecs_query_sync_match_monitor(query, prev->match);
         }
         if (flags & EcsQueryHasOutColumns) {
-            flecs_query_mark_columns_dirty(query, prev->match);
+            flecs_query_mark_columns_dirty(query, prev->match, 
+                iter->prev_first, iter->prev_count);
         }
     }
 
@@ -2678,6 +3604,16 @@ bool ecs_query_next_instanced(
 
     flecs_iter_validate(it);
 
+    if (iter->batch_left) {
+        return flecs_query_next_batch(it);
+    }
+
+    if ((flags & EcsQueryIsTrivial) && 
+        !ECS_BIT_IS_SET(it->flags, EcsIterChangedOnly)) 
+    {
+        return flecs_query_next_trivial(it);
+    }
+
     last = iter->last;
     for (node = iter->node; node != last; node = next) {     
         ecs_query_table_match_t *match = node->match;
@@ -2697,7 +3633,15 @@ bool ecs_query_next_instanced(
 
             ecs_vector_t *bitset_columns = match->bitset_columns;
             ecs_vector_t *sparse_columns = match->sparse_columns;
-            if (bitset_columns || sparse_columns) {
+            bool resume = iter->predicate_row < iter->predicate_end;
+            if (resume) {
+                /* Continue with rows of the previous result, which have not
+                 * yet been tested for predicates. If the table has bitset or
+                 * sparse columns, it may have more ranges after this one. */
+                if (bitset_columns || sparse_columns) {
+                    next = node;
+                }
+            } else if (bitset_columns || sparse_columns) {
                 bool found = false;
 
                 do {
@@ -2739,11 +3683,44 @@ bool ecs_query_next_instanced(
                 } while (!found);
 
                 if (!found) {
+                    flecs_query_counter_add(it->world, query, skip_count, 1);
                     continue;
                 }
             }
 
+            bool changed_only = ECS_BIT_IS_SET(it->flags, EcsIterChangedOnly);
+            if (changed_only && node != iter->prev) {
+                /* Entering node, remember which changes the query has seen so
+                 * that all ranges of the node are tested against it */
+                flecs_query_init_changed_monitor(query, match);
+            }
+
+            if (changed_only || (filter->flags & EcsFilterHasPredicates)) {
+                flecs_query_select_ctx_t select_ctx = { 
+                    it->world, query, match };
+                if (!resume) {
+                    iter->predicate_row = cur.first;
+                    iter->predicate_end = cur.first + cur.count;
+                }
+
+                cur.first = flecs_filter_rows_next(world, filter, table,
+                    match->ids, match->columns, match->sources, 
+                    changed_only ? flecs_query_select_changed : NULL, 
+                    &select_ctx,
+                    &iter->predicate_row, iter->predicate_end, &cur.count);
+                if (cur.first == -1) {
+                    /* No rows left that pass the predicates or have changed */
+                    flecs_query_counter_add(it->world, query, skip_count, 1);
+                    continue;
+                }
+
+                if (iter->predicate_row < iter->predicate_end) {
+                    next = node;
+                }
+            }
+
             it->group_id = match->node.group_id;
+            cur.count = flecs_query_batch(it, node, cur.count);
         } else {
             cur.count = 0;
             cur.first = 0;
@@ -2777,8 +3754,18 @@ bool ecs_query_next_instanced(
         flecs_iter_populate_data(world, it, table, cur.first, cur.count,
             it->ptrs, NULL);
 
+        if ((flags & EcsQueryPrefetch) && (next != node)) {
+            flecs_query_prefetch_node(next, last, it->field_count);
+        }
+
+        if (!iter->skip_counters) {
+            flecs_query_count_result(query, it);
+        }
+
         iter->node = next;
         iter->prev = node;
+        iter->prev_first = cur.first;
+        iter->prev_count = cur.count;
         goto yield;
     }
 
@@ -73,6 +73,8 @@ void flecs_stages_merge(
         ecs_os_get_time(&t_start);
     }
 
+    flecs_trace_begin(stage, EcsTraceMerge, 0);
+
     ecs_dbg_3("#[magenta]merge");
     ecs_log_push_3();
 
@@ -101,7 +103,9 @@ void flecs_stages_merge(
     flecs_eval_component_monitors(world);
 
     if (measure_frame_time) {
-        world->info.merge_time_total += (float)ecs_time_measure(&t_start);
+        ecs_ftime_t merge_time = (ecs_ftime_t)ecs_time_measure(&t_start);
+        world->info.merge_time_total += merge_time;
+        flecs_histogram_record(&world->merge_time_hist, merge_time);
     }
 
     world->info.merge_count_total ++; 
@@ -112,6 +116,8 @@ void flecs_stages_merge(
     }
     
     ecs_log_pop_3();
+
+    flecs_trace_end(stage, EcsTraceMerge, 0);
 }
 
 static
@@ -485,6 +491,14 @@ void flecs_stage_init(
     ecs_vec_init_t(&stage->allocator, &stage->commands, ecs_cmd_t, 0);
     flecs_sparse_init(&stage->cmd_entries, &stage->allocator,
         &stage->allocators.cmd_entry_chunk, ecs_cmd_entry_t);
+
+    flecs_trace_stage_init(world, stage);
+    flecs_perf_stage_init(stage);
+
+#ifdef FLECS_QUERY_COUNTERS
+    ecs_map_init(&stage->query_counters, ecs_query_counters_t, 
+        &stage->allocator, 0);
+#endif
 }
 
 void flecs_stage_fini(
@@ -500,6 +514,11 @@ void flecs_stage_fini(
 
     ecs_poly_fini(stage, ecs_stage_t);
 
+    flecs_trace_stage_fini(stage);
+    flecs_perf_stage_fini(stage);
+#ifdef FLECS_QUERY_COUNTERS
+    ecs_map_fini(&stage->query_counters);
+#endif
     flecs_sparse_fini(&stage->cmd_entries);
 
     ecs_vec_fini_t(&stage->allocator, &stage->commands, ecs_cmd_t);
@@ -616,6 +635,106 @@ error:
     return NULL;
 }
 
+void flecs_reader_register(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(ecs_os_has_threading(), ECS_MISSING_OS_API, "threading");
+
+    if (!world->reader_count) {
+        world->reader_mutex = ecs_os_mutex_new();
+        world->reader_cond = ecs_os_cond_new();
+    }
+    world->reader_count ++;
+error:
+    return;
+}
+
+void flecs_reader_unregister(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_assert(world->reader_count > 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(world->readers_active == 0, ECS_INTERNAL_ERROR, NULL);
+
+    if (!(-- world->reader_count)) {
+        ecs_os_cond_free(world->reader_cond);
+        ecs_os_mutex_free(world->reader_mutex);
+        world->reader_window_open = false;
+    }
+}
+
+bool flecs_reader_begin(
+    ecs_world_t *world,
+    ecs_reader_t *reader)
+{
+    ecs_os_mutex_lock(world->reader_mutex);
+
+    while (!reader->stop && !world->reader_window_open) {
+        ecs_os_cond_wait(world->reader_cond, world->reader_mutex);
+    }
+
+    bool result = !reader->stop;
+    if (result) {
+        world->readers_active ++;
+    }
+
+    ecs_os_mutex_unlock(world->reader_mutex);
+    return result;
+}
+
+void flecs_reader_end(
+    ecs_world_t *world)
+{
+    ecs_os_mutex_lock(world->reader_mutex);
+    ecs_assert(world->readers_active > 0, ECS_INTERNAL_ERROR, NULL);
+    if (!(-- world->readers_active)) {
+        ecs_os_cond_broadcast(world->reader_cond);
+    }
+    ecs_os_mutex_unlock(world->reader_mutex);
+}
+
+void flecs_reader_stop(
+    ecs_world_t *world,
+    ecs_reader_t *reader)
+{
+    ecs_os_mutex_lock(world->reader_mutex);
+    reader->stop = true;
+    ecs_os_cond_broadcast(world->reader_cond);
+    ecs_os_mutex_unlock(world->reader_mutex);
+}
+
+void flecs_reader_window_begin(
+    ecs_world_t *world)
+{
+    if (!world->reader_count) {
+        return;
+    }
+
+    ecs_os_mutex_lock(world->reader_mutex);
+    if (!world->reader_window_open) {
+        world->reader_window_open = true;
+        ecs_os_cond_broadcast(world->reader_cond);
+    }
+    ecs_os_mutex_unlock(world->reader_mutex);
+}
+
+void flecs_reader_window_end(
+    ecs_world_t *world)
+{
+    if (!world->reader_count) {
+        return;
+    }
+
+    /* Readers can't be interrupted, wait until active readers are done */
+    ecs_os_mutex_lock(world->reader_mutex);
+    world->reader_window_open = false;
+    while (world->readers_active) {
+        ecs_os_cond_wait(world->reader_cond, world->reader_mutex);
+    }
+    ecs_os_mutex_unlock(world->reader_mutex);
+}
+
 bool ecs_readonly_begin(
     ecs_world_t *world)
 {
@@ -649,6 +768,9 @@ bool ecs_readonly_begin(
         ECS_BIT_SET(world->flags, EcsWorldMultiThreaded);
     }
 
+    /* Structural changes are deferred, so readers can access the world */
+    flecs_reader_window_begin(world);
+
     return is_readonly;
 }
 
@@ -658,6 +780,8 @@ void ecs_readonly_end(
     ecs_poly_assert(world, ecs_world_t);
     ecs_check(world->flags & EcsWorldReadonly, ECS_INVALID_OPERATION, NULL);
 
+    flecs_reader_window_end(world);
+
     /* After this it is safe again to mutate the world directly */
     ECS_BIT_CLEAR(world->flags, EcsWorldReadonly);
     ECS_BIT_CLEAR(world->flags, EcsWorldMultiThreaded);
@@ -103,4 +103,36 @@ bool flecs_defer_purge(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+/* Register thread that reads the world during reader windows */
+void flecs_reader_register(
+    ecs_world_t *world);
+
+/* Unregister reader. The reader thread must have been joined. */
+void flecs_reader_unregister(
+    ecs_world_t *world);
+
+/* Wait until a reader window is open. Returns false when the reader should
+ * stop. A successful call must be followed up with flecs_reader_end. */
+bool flecs_reader_begin(
+    ecs_world_t *world,
+    ecs_reader_t *reader);
+
+/* Stop accessing the world */
+void flecs_reader_end(
+    ecs_world_t *world);
+
+/* Signal reader that it should stop */
+void flecs_reader_stop(
+    ecs_world_t *world,
+    ecs_reader_t *reader);
+
+/* Allow readers to access the world. Called when the world enters readonly
+ * mode, or while the main thread is idle. */
+void flecs_reader_window_begin(
+    ecs_world_t *world);
+
+/* Disallow readers from accessing the world, waits for active readers */
+void flecs_reader_window_end(
+    ecs_world_t *world);
+
 #endif
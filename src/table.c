@@ -400,6 +400,13 @@ void flecs_table_append_to_records(
     ecs_assert(tr->hdr.cache != NULL, ECS_INTERNAL_ERROR, NULL);
 }
 
+uint64_t flecs_id_bloom(
+    ecs_id_t id)
+{
+    /* Fibonacci hashing, use the upper 6 bits to select one of 64 bits */
+    return 1ull << ((id * 0x9E3779B97F4A7C15ull) >> 58);
+}
+
 void flecs_table_init(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -615,8 +622,19 @@ void flecs_table_init(
         /* Claim id record so it stays alive as long as the table exists */
         flecs_id_record_claim(world, idr);
 
+        /* Add table to list used for intersecting tables of ids */
+        flecs_id_record_sorted_add(world, idr, table);
+
+        /* Add id to signature used to quickly reject queries */
+        table->bloom |= flecs_id_bloom(idr->id);
+
         /* Initialize event flags */
         table->flags |= idr->flags & EcsIdEventMask;
+
+        /* Initialize relationship index flags */
+        if (idr->flags & EcsIdTargetIndex) {
+            table->flags |= EcsTableHasTargetIndex;
+        }
     }
 
     world->store.records = records;
@@ -643,6 +661,7 @@ void flecs_table_records_unregister(
         (void)id;
 
         ecs_table_cache_remove(cache, table, &tr->hdr);
+        flecs_id_record_sorted_remove((ecs_id_record_t*)cache, table);
         flecs_id_record_release(world, (ecs_id_record_t*)cache);
     }
 
@@ -906,6 +925,123 @@ void flecs_dtor_all_components(
     }
 }
 
+/* Add row dirty state for new rows. New rows are marked as changed for all
+ * columns by incrementing the column dirty state. */
+static
+void flecs_table_dirty_rows_add(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count)
+{
+    ecs_vec_t *rows = table->dirty_rows;
+    if (!rows || !count) {
+        return;
+    }
+
+    int32_t c, column_count = table->storage_count;
+    int32_t *dirty_state = table->dirty_state;
+    for (c = 0; c < column_count; c ++) {
+        dirty_state[c + 1] ++;
+    }
+
+    ecs_size_t size = column_count * ECS_SIZEOF(int32_t);
+    int32_t i, *states = ecs_vec_grow(&world->allocator, rows, size, count);
+    for (i = 0; i < count; i ++) {
+        ecs_os_memcpy(&states[i * column_count], &dirty_state[1], size);
+    }
+}
+
+/* Make sure that the row dirty state has an element for each row in table */
+static
+void flecs_table_dirty_rows_sync(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_vec_t *rows = table->dirty_rows;
+    if (!rows) {
+        return;
+    }
+
+    int32_t count = table->data.entities.count;
+    int32_t row_count = ecs_vec_count(rows);
+    if (row_count < count) {
+        flecs_table_dirty_rows_add(world, table, count - row_count);
+    } else if (row_count > count) {
+        ecs_vec_set_count(&world->allocator, rows, 
+            table->storage_count * ECS_SIZEOF(int32_t), count);
+    }
+}
+
+static
+void flecs_table_dirty_rows_fini(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_vec_t *rows = table->dirty_rows;
+    if (rows) {
+        ecs_vec_fini(&world->allocator, rows, 
+            table->storage_count * ECS_SIZEOF(int32_t));
+        flecs_free_t(&world->allocator, ecs_vec_t, rows);
+        table->dirty_rows = NULL;
+    }
+}
+
+void flecs_table_track_rows(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    if (table->dirty_rows || !table->storage_count) {
+        return;
+    }
+
+    /* Existing rows get the current column state, which means that they are
+     * only reported as changed to queries that haven't seen the columns yet */
+    int32_t i, count = ecs_table_count(table);
+    int32_t column_count = table->storage_count;
+    ecs_size_t size = column_count * ECS_SIZEOF(int32_t);
+    int32_t *dirty_state = flecs_table_get_dirty_state(world, table);
+    ecs_vec_t *rows = table->dirty_rows = flecs_alloc_t(
+        &world->allocator, ecs_vec_t);
+    ecs_vec_init(&world->allocator, rows, size, count);
+    if (!count) {
+        return;
+    }
+
+    int32_t *states = ecs_vec_grow(&world->allocator, rows, size, count);
+    for (i = 0; i < count; i ++) {
+        ecs_os_memcpy(&states[i * column_count], &dirty_state[1], size);
+    }
+}
+
+void flecs_table_mark_rows_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t row,
+    int32_t count)
+{
+    ecs_assert(column >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(column < table->storage_count, ECS_INTERNAL_ERROR, NULL);
+    (void)world;
+
+    int32_t *dirty_state = table->dirty_state;
+    if (!dirty_state) {
+        return;
+    }
+
+    int32_t state = ++ dirty_state[column + 1];
+    ecs_vec_t *rows = table->dirty_rows;
+    if (rows) {
+        ecs_assert(row + count <= ecs_vec_count(rows), 
+            ECS_INTERNAL_ERROR, NULL);
+        int32_t i, column_count = table->storage_count;
+        int32_t *states = ecs_vec_first(rows);
+        for (i = row; i < row + count; i ++) {
+            states[i * column_count + column] = state;
+        }
+    }
+}
+
 static
 void flecs_table_fini_data(
     ecs_world_t *world,
@@ -973,6 +1109,10 @@ void flecs_table_fini_data(
     ecs_vec_fini_t(&world->allocator, &data->entities, ecs_entity_t);
     ecs_vec_fini_t(&world->allocator, &data->records, ecs_record_t*);
 
+    if (data == &table->data) {
+        flecs_table_dirty_rows_sync(world, table);
+    }
+
     if (deactivate && count) {
         flecs_table_set_empty(world, table);
     }
@@ -1071,6 +1211,7 @@ void flecs_table_free(
         flecs_hashmap_remove(&world->store.table_map, &ids, ecs_table_t*);
     }
 
+    flecs_table_dirty_rows_fini(world, table);
     flecs_wfree_n(world, int32_t, table->storage_count + 1, table->dirty_state);
     flecs_wfree_n(world, int32_t, table->storage_count + table->type.count, 
         table->storage_map);
@@ -1180,7 +1321,8 @@ void flecs_table_mark_table_dirty(
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
-    ecs_entity_t component)
+    ecs_entity_t component,
+    int32_t row)
 {
     ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
     ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -1188,7 +1330,7 @@ void flecs_table_mark_dirty(
     if (table->dirty_state) {
         int32_t index = ecs_search(world, table->storage_table, component, 0);
         ecs_assert(index != -1, ECS_INTERNAL_ERROR, NULL);
-        table->dirty_state[index + 1] ++;
+        flecs_table_mark_rows_dirty(world, table, index, row, 1);
     }
 }
 
@@ -1469,6 +1611,9 @@ int32_t flecs_table_grow_data(
 
     /* If the table is monitored indicate that there has been a change */
     flecs_table_mark_table_dirty(world, table, 0);
+    if (data == &table->data) {
+        flecs_table_dirty_rows_add(world, table, to_add);
+    }
 
     if (!(world->flags & EcsWorldReadonly) && !cur_count) {
         flecs_table_set_empty(world, table);
@@ -1528,6 +1673,7 @@ int32_t flecs_table_append(
  
     /* If the table is monitored indicate that there has been a change */
     flecs_table_mark_table_dirty(world, table, 0);
+    flecs_table_dirty_rows_add(world, table, 1);
     ecs_assert(count >= 0, ECS_INTERNAL_ERROR, NULL);
 
     ecs_type_info_t **type_info = table->type_info;
@@ -1667,7 +1813,11 @@ void flecs_table_delete(
     }     
 
     /* If the table is monitored indicate that there has been a change */
-    flecs_table_mark_table_dirty(world, table, 0);    
+    flecs_table_mark_table_dirty(world, table, 0);
+    if (table->dirty_rows) {
+        ecs_vec_remove(table->dirty_rows, 
+            table->storage_count * ECS_SIZEOF(int32_t), index);
+    }
 
     /* If table is empty, deactivate it */
     if (!count) {
@@ -2021,6 +2171,29 @@ void flecs_table_swap_bitset_columns(
     }
 }
 
+static
+void flecs_table_swap_dirty_rows(
+    ecs_table_t *table,
+    int32_t row_1,
+    int32_t row_2)
+{
+    ecs_vec_t *rows = table->dirty_rows;
+    if (!rows) {
+        return;
+    }
+
+    int32_t c, column_count = table->storage_count;
+    int32_t *states_1 = ecs_vec_get(rows, 
+        column_count * ECS_SIZEOF(int32_t), row_1);
+    int32_t *states_2 = ecs_vec_get(rows, 
+        column_count * ECS_SIZEOF(int32_t), row_2);
+    for (c = 0; c < column_count; c ++) {
+        int32_t tmp = states_1[c];
+        states_1[c] = states_2[c];
+        states_2[c] = tmp;
+    }
+}
+
 void flecs_table_swap(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -2067,6 +2240,7 @@ void flecs_table_swap(
 
     flecs_table_swap_switch_columns(table, &table->data, row_1, row_2);
     flecs_table_swap_bitset_columns(table, &table->data, row_1, row_2);  
+    flecs_table_swap_dirty_rows(table, row_1, row_2);
 
     ecs_vec_t *columns = table->data.columns;
     if (!columns) {
@@ -2315,6 +2489,18 @@ void flecs_table_merge(
             src_data, dst_data);
     }
 
+    if (move_data) {
+        /* Moved data replaces the rows of the table */
+        if (dst_table->dirty_rows) {
+            ecs_vec_clear(dst_table->dirty_rows);
+        }
+    }
+
+    flecs_table_dirty_rows_sync(world, dst_table);
+    if (src_table != dst_table) {
+        flecs_table_dirty_rows_sync(world, src_table);
+    }
+
     if (src_count) {
         if (!dst_count) {
             flecs_table_set_empty(world, dst_table);
@@ -2350,6 +2536,12 @@ void flecs_table_replace_data(
         flecs_table_init_data(world, table);
     }
 
+    /* Replaced rows are reported as changed */
+    if (table->dirty_rows) {
+        ecs_vec_clear(table->dirty_rows);
+        flecs_table_dirty_rows_sync(world, table);
+    }
+
     int32_t count = ecs_table_count(table);
 
     if (!prev_count && count) {
@@ -168,7 +168,25 @@ ecs_table_t *flecs_table_traverse_remove(
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
-    ecs_entity_t component);
+    ecs_entity_t component,
+    int32_t row);
+
+/* Mark range of rows dirty for storage column */
+void flecs_table_mark_rows_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t row,
+    int32_t count);
+
+/* Get signature bit for id */
+uint64_t flecs_id_bloom(
+    ecs_id_t id);
+
+/* Enable tracking which rows changed for each column */
+void flecs_table_track_rows(
+    ecs_world_t *world,
+    ecs_table_t *table);
 
 void flecs_table_notify(
     ecs_world_t *world,
@@ -72,6 +72,9 @@ const ecs_entity_t EcsChildOf =               ECS_HI_COMPONENT_ID + 25;
 const ecs_entity_t EcsIsA =                   ECS_HI_COMPONENT_ID + 26;
 const ecs_entity_t EcsDependsOn =             ECS_HI_COMPONENT_ID + 27;
 
+/* Relationship indexing */
+const ecs_entity_t EcsTargetIndex =           ECS_HI_COMPONENT_ID + 28;
+
 /* Identifier tags */
 const ecs_entity_t EcsName =                  ECS_HI_COMPONENT_ID + 30;
 const ecs_entity_t EcsSymbol =                ECS_HI_COMPONENT_ID + 31;
@@ -644,6 +647,9 @@ void flecs_log_addons(void) {
     #ifdef FLECS_JOURNAL
         ecs_trace("FLECS_JOURNAL");
     #endif
+    #ifdef FLECS_TRACING
+        ecs_trace("FLECS_TRACING");
+    #endif
     #ifdef FLECS_APP
         ecs_trace("FLECS_APP");
     #endif
@@ -715,6 +721,11 @@ ecs_world_t *ecs_mini(void) {
         &world->allocator, &world->allocators.sparse_chunk, 
         ecs_type_info_t);
     ecs_map_init_w_params(&world->id_index_hi, &world->allocators.ptr);
+    ecs_map_init(&world->query_index, ecs_vec_t, &world->allocator, 0);
+    ecs_vec_init_t(&world->allocator, &world->unindexed_queries, 
+        ecs_query_t*, 0);
+    ecs_vec_init_t(&world->allocator, &world->pending_queries, 
+        ecs_query_t*, 0);
     flecs_sparse_init(&world->id_index_lo, NULL, 
         &world->allocators.id_record_chunk, ecs_id_record_t);
     flecs_observable_init(&world->observable);
@@ -1208,6 +1219,7 @@ int ecs_fini(
     /* This will destroy all entities and components. After this point no more
      * user code is executed. */
     flecs_fini_store(world);
+    flecs_query_index_fini(world);
 
     /* Purge deferred operations from the queue. This discards operations but
      * makes sure that any resources in the queue are freed */
@@ -1519,6 +1531,11 @@ ecs_ftime_t flecs_insert_sleep(
      * should take. */
     ecs_ftime_t sleep_time = sleep / (ecs_ftime_t)4.0;
 
+    /* World isn't modified while sleeping, so readers can access it. Process
+     * table events first, so that readers don't have to. */
+    flecs_process_pending_tables(world);
+    flecs_reader_window_begin(world);
+
     do {
         /* Only call sleep when sleep_time is not 0. On some platforms, even
          * a sleep with a timeout of 0 can cause stutter. */
@@ -1531,6 +1548,8 @@ ecs_ftime_t flecs_insert_sleep(
     } while ((target_delta_time - delta_time) > 
         (sleep_time / (ecs_ftime_t)2.0));
 
+    flecs_reader_window_end(world);
+
     *stop = now;
     return delta_time;
 }
@@ -1579,7 +1598,9 @@ void flecs_stop_measure_frame(
 
     if (world->flags & EcsWorldMeasureFrameTime) {
         ecs_time_t t = world->frame_start_time;
-        world->info.frame_time_total += (ecs_ftime_t)ecs_time_measure(&t);
+        ecs_ftime_t frame_time = (ecs_ftime_t)ecs_time_measure(&t);
+        world->info.frame_time_total += frame_time;
+        flecs_histogram_record(&world->frame_time_hist, frame_time);
     }
 }
 
@@ -1592,6 +1613,8 @@ ecs_ftime_t ecs_frame_begin(
     ecs_check(user_delta_time != 0 || ecs_os_has_time(), 
         ECS_MISSING_OS_API, "get_time");
 
+    flecs_trace_begin(&world->stages[0], EcsTraceFrame, 0);
+
     /* Start measuring total frame time */
     ecs_ftime_t delta_time = flecs_start_measure_frame(world, user_delta_time);
     if (user_delta_time == 0) {
@@ -1626,6 +1649,8 @@ void ecs_frame_end(
     }
 
     flecs_stop_measure_frame(world);
+
+    flecs_trace_end(&world->stages[0], EcsTraceFrame, 0);
 error:
     return;
 }
@@ -1643,6 +1668,14 @@ void flecs_notify_queries(
 {
     ecs_poly_assert(world, ecs_world_t); 
 
+    if (event->kind == EcsQueryTableMatch || 
+        event->kind == EcsQueryTableUnmatch) 
+    {
+        /* Only notify queries that can match the table */
+        flecs_query_index_notify(world, event);
+        return;
+    }
+
     ecs_id_record_t *idr = flecs_id_record_get(world, 
         ecs_pair(ecs_id(EcsPoly), EcsQuery));
     if (!idr) {
@@ -1,5 +1,13 @@
 #include <addons.h>
 
+#ifdef ECS_TARGET_POSIX
+#include <unistd.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#endif
+
 static bool OnRequest(
     const ecs_http_request_t* request, 
     ecs_http_reply_t *reply,
@@ -8,6 +16,265 @@ static bool OnRequest(
     return true;
 }
 
+static bool OnEcho(
+    const ecs_http_request_t* request, 
+    ecs_http_reply_t *reply,
+    void *ctx)
+{
+    ecs_strbuf_appendstr(&reply->body, request->path);
+    return true;
+}
+
+static bool OnHello(
+    const ecs_http_request_t* request, 
+    ecs_http_reply_t *reply,
+    void *ctx)
+{
+    ecs_strbuf_appendlit(&reply->body, "Hello");
+    return true;
+}
+
+static bool OnChunked(
+    const ecs_http_request_t* request, 
+    ecs_http_reply_t *reply,
+    void *ctx)
+{
+    ecs_strbuf_appendlit(&reply->body, "Hello");
+    test_int(ecs_http_reply_flush(reply), 0);
+    ecs_strbuf_appendlit(&reply->body, " ");
+    test_int(ecs_http_reply_flush(reply), 0);
+    ecs_strbuf_appendlit(&reply->body, "World");
+    return true;
+}
+
+#define STREAM_CHUNK_COUNT (16)
+#define STREAM_CHUNK_COUNT_MAX (1024)
+
+static int stream_flush_result;
+static int stream_flush_count;
+
+static bool OnStream(
+    const ecs_http_request_t* request, 
+    ecs_http_reply_t *reply,
+    void *ctx)
+{
+    int32_t i, count = ctx ? STREAM_CHUNK_COUNT_MAX : STREAM_CHUNK_COUNT;
+    char *chunk = ecs_os_malloc(ECS_HTTP_CHUNK_SIZE + 1);
+    ecs_os_memset(chunk, 'x', ECS_HTTP_CHUNK_SIZE);
+    chunk[ECS_HTTP_CHUNK_SIZE] = '\0';
+
+    stream_flush_result = 0;
+    stream_flush_count = 0;
+    for (i = 0; i < count; i ++) {
+        ecs_strbuf_appendstrn(&reply->body, chunk, ECS_HTTP_CHUNK_SIZE);
+        stream_flush_result = ecs_http_reply_flush(reply);
+        stream_flush_count ++;
+        if (stream_flush_result) {
+            break;
+        }
+    }
+
+    ecs_os_free(chunk);
+    return true;
+}
+
+static bool OnOpenStream(
+    const ecs_http_request_t* request, 
+    ecs_http_reply_t *reply,
+    void *ctx)
+{
+    if (ecs_os_strcmp(request->path, "hello")) {
+        /* Only open stream for /hello */
+        ecs_strbuf_appendstr(&reply->body, request->path);
+        return true;
+    }
+
+    ecs_http_stream_t **stream = ctx;
+    *stream = ecs_http_reply_open_stream(reply);
+    test_assert(*stream != NULL);
+
+    /* Data sent before the handler returns is sent after the body */
+    ecs_strbuf_appendlit(&reply->body, "Hello");
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_strbuf_appendlit(&buf, " ");
+    test_int(ecs_http_stream_send(*stream, &buf), 0);
+    return true;
+}
+
+#ifdef ECS_TARGET_POSIX
+#define CLIENT_REQUEST "GET /hello HTTP/1.1\r\nHost: localhost\r\n\r\n"
+#define CLIENT_REPLY_MAX (4096)
+
+typedef struct {
+    int sock;
+    char reply[CLIENT_REPLY_MAX];
+    int reply_len;
+    int expect;    /* number of replies to wait for (default = 1) */
+    bool closed;   /* connection closed by server */
+} http_client_t;
+
+/* Returns number of complete replies in buffer */
+static
+int client_reply_count(
+    const http_client_t *client)
+{
+    int count = 0;
+    const char *ptr = client->reply;
+    const char *end = &client->reply[client->reply_len];
+
+    while (ptr < end) {
+        const char *body = strstr(ptr, "\r\n\r\n");
+        if (!body) {
+            break;
+        }
+        body += 4;
+
+        const char *chunked = strstr(ptr, "Transfer-Encoding: chunked");
+        if (chunked && chunked < body) {
+            /* Skip chunks until the terminating empty chunk */
+            ptr = body;
+            long size;
+            do {
+                const char *data = strstr(ptr, "\r\n");
+                if (!data) {
+                    return count;
+                }
+                size = strtol(ptr, NULL, 16);
+                ptr = data + 2 + size + 2;
+                if (ptr > end) {
+                    return count;
+                }
+            } while (size);
+        } else {
+            const char *len = strstr(ptr, "Content-Length: ");
+            if (!len || len > body) {
+                break;
+            }
+            ptr = body + atoi(len + 16);
+            if (ptr > end) {
+                break;
+            }
+        }
+        count ++;
+    }
+
+    return count;
+}
+
+static
+int client_connect(
+    uint16_t port)
+{
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    /* Server starts listening asynchronously, retry until it accepts */
+    for (int i = 0; i < 1000; i ++) {
+        int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        test_assert(sock >= 0);
+        if (!connect(sock, (struct sockaddr*)&addr, sizeof(addr))) {
+            return sock;
+        }
+        close(sock);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+
+    return -1;
+}
+
+static
+void client_send(
+    http_client_t *client,
+    const char *msg)
+{
+    ssize_t len = (ssize_t)strlen(msg);
+    test_assert(send(client->sock, msg, (size_t)len, 0) == len);
+}
+
+/* Read available data without blocking, returns true when replies are 
+ * complete or when the server closed the connection */
+static
+bool client_poll(
+    http_client_t *client)
+{
+    int expect = client->expect ? client->expect : 1;
+    while (!client->closed && client_reply_count(client) < expect) {
+        ssize_t r = recv(client->sock, &client->reply[client->reply_len], 
+            (size_t)(CLIENT_REPLY_MAX - 1 - client->reply_len), MSG_DONTWAIT);
+        if (r > 0) {
+            client->reply_len += (int)r;
+            client->reply[client->reply_len] = '\0';
+        } else if (r == 0) {
+            client->closed = true;
+        } else {
+            test_assert(errno == EAGAIN || errno == EWOULDBLOCK);
+            break;
+        }
+    }
+    return client->closed || client_reply_count(client) >= expect;
+}
+
+/* Test if server closed the connection without blocking */
+static
+bool client_closed(
+    http_client_t *client)
+{
+    char ch;
+    ssize_t r = recv(client->sock, &ch, 1, MSG_DONTWAIT);
+    if (r == 0) {
+        return true;
+    }
+    test_assert(r == -1 && (errno == EAGAIN || errno == EWOULDBLOCK));
+    return false;
+}
+
+/* Reset reply buffer for the next request */
+static
+void client_reset(
+    http_client_t *client)
+{
+    client->reply_len = 0;
+    client->reply[0] = '\0';
+    client->expect = 0;
+}
+
+static
+void client_test_reply(
+    http_client_t *client)
+{
+    test_int(client_reply_count(client), 1);
+    test_assert(!strncmp(client->reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(client->reply, "Content-Length: 5\r\n") != NULL);
+    test_str(&client->reply[client->reply_len - 5], "Hello");
+}
+
+/* Process requests until all clients received a reply, or timeout expires */
+static
+bool client_wait(
+    ecs_http_server_t *srv,
+    http_client_t *clients,
+    int count)
+{
+    for (int t = 0; t < 10000; t ++) {
+        ecs_http_server_dequeue(srv, 1.0);
+
+        int done = 0;
+        for (int i = 0; i < count; i ++) {
+            done += client_poll(&clients[i]);
+        }
+
+        if (done == count) {
+            return true;
+        }
+
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+    return false;
+}
+#endif
+
 void Http_teardown() {
     ecs_set_os_api_impl();
 
@@ -68,3 +335,747 @@ void Http_stop_start() {
     
     ecs_http_server_fini(srv);
 }
+
+void Http_http_request() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27754,
+        .callback = OnHello
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t client = { .sock = client_connect(27754) };
+    test_assert(client.sock >= 0);
+    client_send(&client, CLIENT_REQUEST);
+
+    test_bool(client_wait(srv, &client, 1), true);
+    client_test_reply(&client);
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_slow_client_doesnt_block() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27755,
+        .callback = OnHello
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    /* Client that only sends part of its request */
+    http_client_t slow = { .sock = client_connect(27755) };
+    test_assert(slow.sock >= 0);
+    client_send(&slow, "GET /hello HTTP/1.1\r\n");
+
+    http_client_t client = { .sock = client_connect(27755) };
+    test_assert(client.sock >= 0);
+    client_send(&client, CLIENT_REQUEST);
+
+    test_bool(client_wait(srv, &client, 1), true);
+    client_test_reply(&client);
+    test_bool(client_poll(&slow), false);
+
+    /* Slow client can still complete its request */
+    client_send(&slow, "\r\n");
+    test_bool(client_wait(srv, &slow, 1), true);
+    client_test_reply(&slow);
+
+    close(client.sock);
+    close(slow.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_concurrent_1k_connections() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    const int count = 1000;
+
+    /* Make sure there are enough file descriptors for client & server */
+    struct rlimit rl;
+    test_int(getrlimit(RLIMIT_NOFILE, &rl), 0);
+    if (rl.rlim_cur < (rlim_t)(count * 2 + 64)) {
+        rl.rlim_cur = (rlim_t)(count * 2 + 64);
+        test_assert(rl.rlim_max == RLIM_INFINITY || rl.rlim_cur <= rl.rlim_max);
+        test_int(setrlimit(RLIMIT_NOFILE, &rl), 0);
+    }
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27756,
+        .callback = OnHello
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t *clients = ecs_os_calloc_n(http_client_t, count);
+    for (int i = 0; i < count; i ++) {
+        clients[i].sock = client_connect(27756);
+        test_assert(clients[i].sock >= 0);
+        client_send(&clients[i], CLIENT_REQUEST);
+    }
+
+    test_bool(client_wait(srv, clients, count), true);
+
+    for (int i = 0; i < count; i ++) {
+        client_test_reply(&clients[i]);
+        close(clients[i].sock);
+    }
+
+    ecs_os_free(clients);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_keep_alive() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27757,
+        .callback = OnHello
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t client = { .sock = client_connect(27757) };
+    test_assert(client.sock >= 0);
+
+    for (int i = 0; i < 3; i ++) {
+        client_send(&client, CLIENT_REQUEST);
+        test_bool(client_wait(srv, &client, 1), true);
+        client_test_reply(&client);
+        test_assert(strstr(client.reply, "Connection: keep-alive\r\n") != NULL);
+        test_bool(client.closed, false);
+        client_reset(&client);
+    }
+
+    test_bool(client_closed(&client), false);
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_keep_alive_close() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27758,
+        .callback = OnHello
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t client = { .sock = client_connect(27758) };
+    test_assert(client.sock >= 0);
+    client_send(&client, 
+        "GET /hello HTTP/1.1\r\nConnection: close\r\n\r\n");
+
+    /* Wait until server closes connection */
+    client.expect = 2;
+    test_bool(client_wait(srv, &client, 1), true);
+    test_bool(client.closed, true);
+    client_test_reply(&client);
+    test_assert(strstr(client.reply, "Connection: close\r\n") != NULL);
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_http_1_0_close() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27759,
+        .callback = OnHello
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t client = { .sock = client_connect(27759) };
+    test_assert(client.sock >= 0);
+    client_send(&client, "GET /hello HTTP/1.0\r\n\r\n");
+
+    client.expect = 2;
+    test_bool(client_wait(srv, &client, 1), true);
+    test_bool(client.closed, true);
+    client_test_reply(&client);
+    test_assert(strstr(client.reply, "Connection: close\r\n") != NULL);
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_pipelined_requests() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27760,
+        .callback = OnEcho
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t client = { .sock = client_connect(27760) };
+    test_assert(client.sock >= 0);
+
+    /* Send all requests in a single write */
+    client_send(&client, 
+        "GET /a HTTP/1.1\r\n\r\n"
+        "GET /bb HTTP/1.1\r\n\r\n"
+        "GET /ccc HTTP/1.1\r\n\r\n");
+
+    client.expect = 3;
+    test_bool(client_wait(srv, &client, 1), true);
+    test_int(client_reply_count(&client), 3);
+    test_bool(client.closed, false);
+
+    /* Replies must be in the same order as requests */
+    const char *a = strstr(client.reply, "\r\n\r\na");
+    const char *b = strstr(client.reply, "\r\n\r\nbb");
+    const char *c = strstr(client.reply, "\r\n\r\nccc");
+    test_assert(a != NULL);
+    test_assert(b != NULL);
+    test_assert(c != NULL);
+    test_assert(a < b);
+    test_assert(b < c);
+
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_pipelined_requests_split() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27761,
+        .callback = OnEcho
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t client = { .sock = client_connect(27761) };
+    test_assert(client.sock >= 0);
+
+    /* Second request is split across writes */
+    client_send(&client, "GET /a HTTP/1.1\r\n\r\nGET /b");
+    client.expect = 1;
+    test_bool(client_wait(srv, &client, 1), true);
+    test_int(client_reply_count(&client), 1);
+
+    client_send(&client, "b HTTP/1.1\r\n\r\n");
+    client.expect = 2;
+    test_bool(client_wait(srv, &client, 1), true);
+    test_int(client_reply_count(&client), 2);
+    test_assert(strstr(client.reply, "\r\n\r\nbb") != NULL);
+
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_chunked_reply() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27762,
+        .callback = OnChunked
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t client = { .sock = client_connect(27762) };
+    test_assert(client.sock >= 0);
+    client_send(&client, CLIENT_REQUEST);
+
+    test_bool(client_wait(srv, &client, 1), true);
+    test_int(client_reply_count(&client), 1);
+    test_assert(!strncmp(client.reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(client.reply, "Transfer-Encoding: chunked\r\n") != NULL);
+    test_assert(strstr(client.reply, "Content-Length") == NULL);
+
+    const char *body = strstr(client.reply, "\r\n\r\n");
+    test_assert(body != NULL);
+    test_str(body + 4, "5\r\nHello\r\n1\r\n \r\n5\r\nWorld\r\n0\r\n\r\n");
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_chunked_reply_keep_alive() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27763,
+        .callback = OnChunked
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t client = { .sock = client_connect(27763) };
+    test_assert(client.sock >= 0);
+
+    /* Chunks of pipelined replies must not interleave */
+    client_send(&client, CLIENT_REQUEST CLIENT_REQUEST);
+    client.expect = 2;
+    test_bool(client_wait(srv, &client, 1), true);
+    test_int(client_reply_count(&client), 2);
+    test_bool(client.closed, false);
+
+    const char *second = strstr(client.reply, "0\r\n\r\nHTTP/1.1 200 OK");
+    test_assert(second != NULL);
+    test_str(&client.reply[client.reply_len - 12], "World\r\n0\r\n\r\n");
+
+    client_reset(&client);
+    client_send(&client, CLIENT_REQUEST);
+    test_bool(client_wait(srv, &client, 1), true);
+    test_int(client_reply_count(&client), 1);
+    test_bool(client_closed(&client), false);
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_chunked_reply_http_1_0() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27764,
+        .callback = OnChunked
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t client = { .sock = client_connect(27764) };
+    test_assert(client.sock >= 0);
+    client_send(&client, "GET /hello HTTP/1.0\r\n\r\n");
+
+    /* HTTP/1.0 doesn't support chunked encoding, reply is sent at once */
+    client.expect = 2;
+    test_bool(client_wait(srv, &client, 1), true);
+    test_bool(client.closed, true);
+    test_int(client_reply_count(&client), 1);
+    test_assert(strstr(client.reply, "Transfer-Encoding") == NULL);
+    test_assert(strstr(client.reply, "Content-Length: 11\r\n") != NULL);
+    test_str(&client.reply[client.reply_len - 11], "Hello World");
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+#ifdef ECS_TARGET_POSIX
+typedef struct {
+    int sock;
+    int64_t received;
+    char tail[6];
+} stream_client_t;
+
+/* Read reply on a separate thread, as ecs_http_reply_flush blocks the thread
+ * that handles requests when the client doesn't read */
+static
+void* stream_client_read(
+    void *arg)
+{
+    stream_client_t *client = arg;
+    char buf[4096];
+
+    while (true) {
+        ssize_t r = recv(client->sock, buf, sizeof(buf), 0);
+        if (r <= 0) {
+            break;
+        }
+
+        client->received += r;
+        if (r >= 5) {
+            memcpy(client->tail, &buf[r - 5], 5);
+        } else {
+            memmove(client->tail, &client->tail[r], (size_t)(5 - r));
+            memcpy(&client->tail[5 - r], buf, (size_t)r);
+        }
+
+        if (!strcmp(client->tail, "0\r\n\r\n")) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static
+void* stream_client_close(
+    void *arg)
+{
+    int sock = *(int*)arg;
+    char ch;
+    test_assert(recv(sock, &ch, 1, 0) == 1);
+    close(sock);
+    return NULL;
+}
+#endif
+
+void Http_chunked_reply_large() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27765,
+        .callback = OnStream
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    stream_client_t client = { .sock = client_connect(27765) };
+    test_assert(client.sock >= 0);
+    test_assert(send(client.sock, CLIENT_REQUEST, 
+        strlen(CLIENT_REQUEST), 0) == strlen(CLIENT_REQUEST));
+
+    ecs_os_thread_t thr = ecs_os_thread_new(stream_client_read, &client);
+
+    for (int t = 0; t < 10000 && !stream_flush_count; t ++) {
+        ecs_http_server_dequeue(srv, 1.0);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+
+    ecs_os_thread_join(thr);
+
+    test_int(stream_flush_count, STREAM_CHUNK_COUNT);
+    test_int(stream_flush_result, 0);
+    test_assert(client.received > 
+        (int64_t)STREAM_CHUNK_COUNT * ECS_HTTP_CHUNK_SIZE);
+    test_str(client.tail, "0\r\n\r\n");
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_chunked_reply_client_close() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    static int stream_forever;
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27766,
+        .callback = OnStream,
+        .ctx = &stream_forever /* stream until the connection is closed */
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    int sock = client_connect(27766);
+    test_assert(sock >= 0);
+    test_assert(send(sock, CLIENT_REQUEST, 
+        strlen(CLIENT_REQUEST), 0) == strlen(CLIENT_REQUEST));
+
+    /* Close connection after the server started streaming */
+    ecs_os_thread_t thr = ecs_os_thread_new(stream_client_close, &sock);
+
+    for (int t = 0; t < 10000 && !stream_flush_result; t ++) {
+        ecs_http_server_dequeue(srv, 1.0);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+
+    ecs_os_thread_join(thr);
+
+    test_int(stream_flush_result, -1);
+    test_assert(stream_flush_count < STREAM_CHUNK_COUNT_MAX);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+#ifdef ECS_TARGET_POSIX
+static
+void* stream_server_dequeue(
+    void *arg)
+{
+    ecs_http_server_t *srv = arg;
+    for (int t = 0; t < 10000 && !stream_flush_result; t ++) {
+        ecs_http_server_dequeue(srv, 1.0);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+    return NULL;
+}
+#endif
+
+void Http_chunked_reply_server_stop() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    static int stream_forever;
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27778,
+        .callback = OnStream,
+        .ctx = &stream_forever /* stream until the connection is closed */
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    /* Client doesn't read, so the handler blocks once socket buffers fill */
+    int sock = client_connect(27778);
+    test_assert(sock >= 0);
+    test_assert(send(sock, CLIENT_REQUEST, 
+        strlen(CLIENT_REQUEST), 0) == strlen(CLIENT_REQUEST));
+
+    stream_flush_count = 0;
+    stream_flush_result = 0;
+    ecs_os_thread_t thr = ecs_os_thread_new(stream_server_dequeue, srv);
+
+    int prev_count = -1;
+    for (int t = 0; t < 10000; t ++) {
+        ecs_os_sleep(0, 10 * 1000 * 1000);
+        if (stream_flush_count && stream_flush_count == prev_count) {
+            break;
+        }
+        prev_count = stream_flush_count;
+    }
+    test_assert(stream_flush_count > 0);
+    test_int(stream_flush_result, 0);
+
+    /* Stopping the server unblocks the handler */
+    ecs_http_server_stop(srv);
+    ecs_os_thread_join(thr);
+
+    test_int(stream_flush_result, -1);
+    test_assert(stream_flush_count < STREAM_CHUNK_COUNT_MAX);
+    close(sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_open_stream() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_stream_t *stream = NULL;
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27773,
+        .callback = OnOpenStream,
+        .ctx = &stream
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t client = { .sock = client_connect(27773) };
+    test_assert(client.sock >= 0);
+    client_send(&client, CLIENT_REQUEST);
+
+    for (int t = 0; t < 10000 && !stream; t ++) {
+        ecs_http_server_dequeue(srv, 1.0);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+    test_assert(stream != NULL);
+
+    /* Stream remains open after request handler returned */
+    test_bool(client_wait(srv, &client, 1), false);
+    test_assert(!strncmp(client.reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(client.reply, "Transfer-Encoding: chunked\r\n") != NULL);
+    test_assert(strstr(client.reply, "Connection: keep-alive\r\n") != NULL);
+
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_strbuf_appendlit(&buf, "World");
+    test_int(ecs_http_stream_send(stream, &buf), 0);
+    test_int(ecs_strbuf_written(&buf), 0);
+    ecs_http_stream_close(stream);
+
+    test_bool(client_wait(srv, &client, 1), true);
+    test_int(client_reply_count(&client), 1);
+    const char *body = strstr(client.reply, "\r\n\r\n");
+    test_assert(body != NULL);
+    test_str(body + 4, "5\r\nHello\r\n1\r\n \r\n5\r\nWorld\r\n0\r\n\r\n");
+
+    /* Connection is kept alive after stream is closed */
+    client_reset(&client);
+    client_send(&client, "GET /a HTTP/1.1\r\n\r\n");
+    test_bool(client_wait(srv, &client, 1), true);
+    test_int(client_reply_count(&client), 1);
+    test_bool(client.closed, false);
+    test_str(&client.reply[client.reply_len - 1], "a");
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_open_stream_connection_close() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_stream_t *stream = NULL;
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27779,
+        .callback = OnOpenStream,
+        .ctx = &stream
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t client = { .sock = client_connect(27779) };
+    test_assert(client.sock >= 0);
+    client_send(&client, 
+        "GET /hello HTTP/1.1\r\nConnection: close\r\n\r\n");
+
+    for (int t = 0; t < 10000 && !stream; t ++) {
+        ecs_http_server_dequeue(srv, 1.0);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+    test_assert(stream != NULL);
+
+    test_bool(client_wait(srv, &client, 1), false);
+    test_assert(strstr(client.reply, "Connection: close\r\n") != NULL);
+    ecs_http_stream_close(stream);
+
+    test_bool(client_wait(srv, &client, 1), true);
+    test_int(client_reply_count(&client), 1);
+
+    /* Connection is closed after stream is closed */
+    bool closed = client.closed;
+    for (int t = 0; t < 10000 && !closed; t ++) {
+        closed = client_closed(&client);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+    test_bool(closed, true);
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_open_stream_pipelined() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_stream_t *stream = NULL;
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27780,
+        .callback = OnOpenStream,
+        .ctx = &stream
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    /* Second request is pipelined after the request that opens the stream */
+    http_client_t client = { .sock = client_connect(27780) };
+    test_assert(client.sock >= 0);
+    client_send(&client, 
+        "GET /hello HTTP/1.1\r\n\r\n"
+        "GET /a HTTP/1.1\r\n\r\n");
+
+    for (int t = 0; t < 10000 && !stream; t ++) {
+        ecs_http_server_dequeue(srv, 1.0);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+    test_assert(stream != NULL);
+
+    /* Reply to second request is sent after the stream is closed */
+    client.expect = 2;
+    test_bool(client_wait(srv, &client, 1), false);
+    test_int(client_reply_count(&client), 0);
+    test_assert(strstr(client.reply, "\r\n\r\na") == NULL);
+
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_strbuf_appendlit(&buf, "World");
+    test_int(ecs_http_stream_send(stream, &buf), 0);
+    ecs_http_stream_close(stream);
+
+    test_bool(client_wait(srv, &client, 1), true);
+    test_int(client_reply_count(&client), 2);
+    test_bool(client.closed, false);
+
+    const char *end = strstr(client.reply, "5\r\nWorld\r\n0\r\n\r\n");
+    const char *a = strstr(client.reply, "\r\n\r\na");
+    test_assert(end != NULL);
+    test_assert(a != NULL);
+    test_assert(end < a);
+    close(client.sock);
+
+    ecs_http_server_fini(srv);
+#endif
+}
+
+void Http_open_stream_client_close() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_http_stream_t *stream = NULL;
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = 27774,
+        .callback = OnOpenStream,
+        .ctx = &stream
+    });
+
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+
+    http_client_t client = { .sock = client_connect(27774) };
+    test_assert(client.sock >= 0);
+    client_send(&client, CLIENT_REQUEST);
+
+    for (int t = 0; t < 10000 && !stream; t ++) {
+        ecs_http_server_dequeue(srv, 1.0);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+    test_assert(stream != NULL);
+    close(client.sock);
+
+    /* Sending fails once the server detects the connection was closed */
+    int result = 0;
+    for (int t = 0; t < 10000 && !result; t ++) {
+        ecs_strbuf_t buf = ECS_STRBUF_INIT;
+        ecs_strbuf_appendlit(&buf, "data");
+        result = ecs_http_stream_send(stream, &buf);
+        ecs_strbuf_reset(&buf);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+    test_int(result, -1);
+    ecs_http_stream_close(stream);
+
+    ecs_http_server_fini(srv);
+#endif
+}
@@ -1127,3 +1127,81 @@ void MultiThread_multithread_w_monitor_addon() {
     /* Make sure monitor could be run in multithreaded mode */
     test_assert(true);
 }
+
+static
+uint64_t group_by_tgt(
+    ecs_world_t *world, 
+    ecs_table_t *table, 
+    ecs_id_t id, 
+    void *ctx) 
+{
+    ecs_id_t match;
+    if (ecs_search(world, table, ecs_pair(id, EcsWildcard), &match) != -1) {
+        return ECS_PAIR_SECOND(match);
+    }
+    return 0;
+}
+
+typedef struct {
+    int32_t stage[4];
+    int32_t count[4];
+} GroupWorkerCtx;
+
+static
+void ProgressGroups(ecs_iter_t *it) {
+    GroupWorkerCtx *ctx = it->ctx;
+    Position *p = ecs_field(it, Position, 1);
+    int32_t group = (int32_t)p[0].y;
+    int32_t stage = ecs_get_stage_id(it->world);
+
+    for (int i = 0; i < it->count; i ++) {
+        p[i].x ++;
+    }
+
+    /* Groups are only iterated by a single stage */
+    test_assert(ctx->stage[group] == -1 || ctx->stage[group] == stage);
+    ctx->stage[group] = stage;
+    ctx->count[group] += it->count;
+}
+
+void MultiThread_2_thread_multi_threaded_groups() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG(world, Cell);
+
+    ecs_entity_t cells[4];
+    for (int i = 0; i < 4; i ++) {
+        cells[i] = ecs_new_id(world);
+        for (int j = 0; j < 5; j ++) {
+            ecs_entity_t e = ecs_set(world, 0, Position, {0, i});
+            ecs_add_pair(world, e, Cell, cells[i]);
+        }
+    }
+
+    GroupWorkerCtx ctx = {{-1, -1, -1, -1}};
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, {.add = {ecs_dependson(EcsOnUpdate)}}),
+        .query.filter.terms = {
+            { ecs_id(Position) }, { ecs_pair(Cell, EcsWildcard) }
+        },
+        .query.group_by = group_by_tgt,
+        .query.group_by_id = Cell,
+        .callback = ProgressGroups,
+        .ctx = &ctx,
+        .multi_threaded_groups = true
+    });
+
+    ecs_set_threads(world, 2);
+    ecs_progress(world, 0);
+
+    for (int i = 0; i < 4; i ++) {
+        test_int(ctx.count[i], 5);
+    }
+
+    test_int(ctx.stage[0], ctx.stage[1]);
+    test_int(ctx.stage[2], ctx.stage[3]);
+    test_assert(ctx.stage[0] != ctx.stage[2]);
+
+    ecs_fini(world);
+}
@@ -9,3 +9,858 @@ void Rest_teardown() {
 
     test_assert(true); // Ensure teardown was successful
 }
+
+#ifdef ECS_TARGET_POSIX
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+typedef struct {
+    int sock;
+    ecs_strbuf_t reply;
+    bool done;
+} rest_client_t;
+
+static
+int rest_client_connect_w_rcvbuf(
+    uint16_t port,
+    int rcvbuf);
+
+static
+int rest_client_connect(
+    uint16_t port)
+{
+    return rest_client_connect_w_rcvbuf(port, 0);
+}
+
+/* Connect with receive buffer size, so that the server can only send a small 
+ * amount of data before the client reads it */
+static
+int rest_client_connect_w_rcvbuf(
+    uint16_t port,
+    int rcvbuf)
+{
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    /* Server starts listening asynchronously, retry until it accepts */
+    for (int i = 0; i < 1000; i ++) {
+        int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        test_assert(sock >= 0);
+        if (rcvbuf) {
+            setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        }
+        if (!connect(sock, (struct sockaddr*)&addr, sizeof(addr))) {
+            return sock;
+        }
+        close(sock);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+
+    return -1;
+}
+
+/* Returns true if data was received within timeout */
+static
+bool rest_client_recv(
+    int sock,
+    char *buf,
+    int size,
+    int timeout_ms)
+{
+    for (int t = 0; t < timeout_ms; t ++) {
+        ssize_t r = recv(sock, buf, (size_t)(size - 1), MSG_DONTWAIT);
+        if (r > 0) {
+            buf[r] = '\0';
+            return true;
+        }
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+    return false;
+}
+
+static
+void* rest_client_read(
+    void *arg)
+{
+    rest_client_t *client = arg;
+    char buf[4096];
+
+    while (true) {
+        ssize_t r = recv(client->sock, buf, sizeof(buf) - 1, 0);
+        if (r <= 0) {
+            break;
+        }
+        buf[r] = '\0';
+
+        ecs_strbuf_appendstrn(&client->reply, buf, (int32_t)r);
+
+        int32_t len = ecs_strbuf_written(&client->reply);
+        if (len >= 5) {
+            char *str = ecs_strbuf_get(&client->reply);
+            bool done = !strcmp(&str[len - 5], "0\r\n\r\n");
+            ecs_strbuf_appendstrn(&client->reply, str, len);
+            ecs_os_free(str);
+            if (done) {
+                break;
+            }
+        }
+    }
+
+    ecs_os_ainc((int32_t*)&client->done);
+    return NULL;
+}
+
+/* Concatenate data of chunks in reply */
+static
+char* rest_dechunk(
+    const char *reply)
+{
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    const char *ptr = strstr(reply, "\r\n\r\n");
+    test_assert(ptr != NULL);
+    ptr += 4;
+
+    long size;
+    do {
+        char *data;
+        size = strtol(ptr, &data, 16);
+        test_assert(!strncmp(data, "\r\n", 2));
+        ecs_strbuf_appendstrn(&buf, data + 2, (int32_t)size);
+        ptr = data + 2 + size;
+        test_assert(!strncmp(ptr, "\r\n", 2));
+        ptr += 2;
+    } while (size);
+
+    return ecs_strbuf_get(&buf);
+}
+#endif
+
+void Rest_query_chunked() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    for (int i = 0; i < 20000; i ++) {
+        ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_singleton_set(world, EcsRest, {27767});
+    ecs_progress(world, 0);
+
+    rest_client_t client = { 
+        .sock = rest_client_connect(27767),
+        .reply = ECS_STRBUF_INIT 
+    };
+    test_assert(client.sock >= 0);
+
+    const char *request = 
+        "GET /query?q=Position&limit=100000 HTTP/1.1\r\n\r\n";
+    test_assert(send(client.sock, request, strlen(request), 0) == 
+        (ssize_t)strlen(request));
+
+    ecs_os_thread_t thr = ecs_os_thread_new(rest_client_read, &client);
+    for (int t = 0; t < 10000 && !client.done; t ++) {
+        ecs_progress(world, 0);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+    ecs_os_thread_join(thr);
+    close(client.sock);
+
+    char *reply = ecs_strbuf_get(&client.reply);
+    test_assert(reply != NULL);
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "Transfer-Encoding: chunked\r\n") != NULL);
+
+    /* Large tables are split up in multiple results */
+    char *json = rest_dechunk(reply);
+    test_assert(strlen(json) > ECS_HTTP_CHUNK_SIZE);
+    const char *head = "{\"ids\":[\"Position\"], \"results\":[";
+    test_assert(!strncmp(json, head, strlen(head)));
+    test_str(&json[strlen(json) - 3], "}]}");
+
+    int result_count = 0, entity_count = 0;
+    const char *ptr = json;
+    while ((ptr = strstr(ptr, "\"entities\":["))) {
+        result_count ++;
+        entity_count ++;
+        for (ptr += 12; *ptr != ']'; ptr ++) {
+            entity_count += *ptr == ',';
+        }
+    }
+    test_int(result_count, (20000 + 255) / 256);
+    test_int(entity_count, 20000);
+
+    ecs_os_free(json);
+    ecs_os_free(reply);
+
+    ecs_fini(world);
+#endif
+}
+
+void Rest_threaded_readonly() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_set_name(world, e, "e");
+
+    ecs_singleton_set(world, EcsRest, { .port = 27768, .threaded = true });
+
+    int sock = rest_client_connect(27768);
+    test_assert(sock >= 0);
+
+    const char *request = "GET /entity/e HTTP/1.1\r\n\r\n";
+    test_assert(send(sock, request, strlen(request), 0) == 
+        (ssize_t)strlen(request));
+
+    /* Requests aren't handled outside of readonly mode */
+    char reply[4096];
+    test_bool(rest_client_recv(sock, reply, sizeof(reply), 50), false);
+
+    /* Request is handled on REST thread while main thread is readonly */
+    ecs_readonly_begin(world);
+    test_bool(rest_client_recv(sock, reply, sizeof(reply), 10000), true);
+    ecs_readonly_end(world);
+
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "\"path\":\"e\"") != NULL);
+
+    /* Requests are handled while progressing */
+    test_assert(send(sock, request, strlen(request), 0) == 
+        (ssize_t)strlen(request));
+    bool received = false;
+    for (int t = 0; t < 10000 && !received; t ++) {
+        ecs_progress(world, 0);
+        received = rest_client_recv(sock, reply, sizeof(reply), 1);
+    }
+    test_bool(received, true);
+    test_assert(strstr(reply, "\"path\":\"e\"") != NULL);
+
+    close(sock);
+
+    ecs_fini(world);
+#endif
+}
+
+#ifdef ECS_TARGET_POSIX
+/* Send request & wait for reply, while REST thread can read the world */
+static
+void rest_client_get(
+    int sock,
+    const char *request,
+    char *reply,
+    int size)
+{
+    test_assert(send(sock, request, strlen(request), 0) == 
+        (ssize_t)strlen(request));
+    test_bool(rest_client_recv(sock, reply, size, 10000), true);
+}
+
+static
+char* rest_reply_etag(
+    const char *reply)
+{
+    const char *etag = strstr(reply, "ETag: ");
+    test_assert(etag != NULL);
+    etag += 6;
+    const char *end = strstr(etag, "\r\n");
+    test_assert(end != NULL);
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_strbuf_appendstrn(&buf, etag, (int32_t)(end - etag));
+    return ecs_strbuf_get(&buf);
+}
+#endif
+
+void Rest_query_etag() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_set_name(world, e, "e");
+
+    ecs_singleton_set(world, EcsRest, { .port = 27769, .threaded = true });
+
+    int sock = rest_client_connect(27769);
+    test_assert(sock >= 0);
+
+    char reply[4096], body[4096], request[512];
+
+    /* Matched tables don't track changes yet, reply has no ETag */
+    ecs_readonly_begin(world);
+    rest_client_get(sock, "GET /query?q=Position HTTP/1.1\r\n\r\n", 
+        reply, sizeof(reply));
+    ecs_readonly_end(world);
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "ETag: ") == NULL);
+
+    /* Change tracking is enabled at the end of the frame */
+    ecs_progress(world, 0);
+
+    ecs_readonly_begin(world);
+    rest_client_get(sock, "GET /query?q=Position HTTP/1.1\r\n\r\n", 
+        reply, sizeof(reply));
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "\"entities\":[\"e\"]") != NULL);
+    char *etag = rest_reply_etag(reply);
+    ecs_os_strcpy(body, strstr(reply, "\r\n\r\n"));
+
+    /* World didn't change, reply isn't sent again */
+    ecs_os_sprintf(request, 
+        "GET /query?q=Position HTTP/1.1\r\nIf-None-Match: %s\r\n\r\n", etag);
+    rest_client_get(sock, request, reply, sizeof(reply));
+    test_assert(!strncmp(reply, "HTTP/1.1 304 Not Modified\r\n", 27));
+
+    /* Cached reply is the same as the original reply */
+    rest_client_get(sock, "GET /query?q=Position HTTP/1.1\r\n\r\n", 
+        reply, sizeof(reply));
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    char *etag_cached = rest_reply_etag(reply);
+    test_str(etag_cached, etag);
+    test_str(strstr(reply, "\r\n\r\n"), body);
+    ecs_os_free(etag_cached);
+
+    /* Different parameters produce a different ETag */
+    rest_client_get(sock, 
+        "GET /query?q=Position&entities=false HTTP/1.1\r\n\r\n", 
+        reply, sizeof(reply));
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    char *etag_params = rest_reply_etag(reply);
+    test_assert(strcmp(etag_params, etag) != 0);
+    test_assert(strstr(reply, "\"entities\"") == NULL);
+    ecs_os_free(etag_params);
+    ecs_readonly_end(world);
+
+    /* Progressing the world doesn't change the ETag if the data is the same */
+    ecs_progress(world, 0);
+    ecs_progress(world, 0);
+
+    ecs_readonly_begin(world);
+    rest_client_get(sock, request, reply, sizeof(reply));
+    test_assert(!strncmp(reply, "HTTP/1.1 304 Not Modified\r\n", 27));
+    ecs_readonly_end(world);
+
+    /* World changed, reply is sent again */
+    ecs_set(world, e, Position, {30, 40});
+
+    ecs_readonly_begin(world);
+    rest_client_get(sock, request, reply, sizeof(reply));
+    ecs_readonly_end(world);
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    char *etag_changed = rest_reply_etag(reply);
+    test_assert(strcmp(etag_changed, etag) != 0);
+    ecs_os_free(etag_changed);
+
+    ecs_os_free(etag);
+    close(sock);
+
+    ecs_fini(world);
+#endif
+}
+
+void Rest_query_rule_cache() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Foo);
+    ECS_TAG(world, Bar);
+    ecs_entity_t e = ecs_new(world, Foo);
+    ecs_add(world, e, Bar);
+    ecs_set_name(world, e, "e");
+
+    ecs_singleton_set(world, EcsRest, { .port = 27770, .threaded = true });
+
+    int sock = rest_client_connect(27770);
+    test_assert(sock >= 0);
+
+    char reply[4096], request[512];
+
+    ecs_readonly_begin(world);
+    rest_client_get(sock, "GET /query?q=Foo,Bar HTTP/1.1\r\n\r\n", 
+        reply, sizeof(reply));
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "\"entities\":[\"e\"]") != NULL);
+
+    /* Evaluate more distinct expressions than can be cached */
+    for (int i = 0; i < 40; i ++) {
+        ecs_strbuf_t buf = ECS_STRBUF_INIT;
+        ecs_strbuf_appendlit(&buf, "GET /query?q=Foo");
+        for (int s = 0; s < i; s ++) {
+            ecs_strbuf_appendlit(&buf, "%20");
+        }
+        ecs_strbuf_appendlit(&buf, " HTTP/1.1\r\n\r\n");
+        char *str = ecs_strbuf_get(&buf);
+        rest_client_get(sock, str, reply, sizeof(reply));
+        ecs_os_free(str);
+        test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+        test_assert(strstr(reply, "\"entities\":[\"e\"]") != NULL);
+    }
+    ecs_readonly_end(world);
+
+    /* Rules that use deleted ids are no longer valid */
+    ecs_delete(world, Bar);
+
+    ecs_readonly_begin(world);
+    ecs_os_strcpy(request, "GET /query?q=Foo,Bar HTTP/1.1\r\n\r\n");
+    rest_client_get(sock, request, reply, sizeof(reply));
+    test_assert(!strncmp(reply, "HTTP/1.1 400 ", 13));
+    rest_client_get(sock, "GET /query?q=Foo HTTP/1.1\r\n\r\n", 
+        reply, sizeof(reply));
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "\"entities\":[\"e\"]") != NULL);
+    ecs_readonly_end(world);
+
+    close(sock);
+
+    ecs_fini(world);
+#endif
+}
+
+#ifdef ECS_TARGET_POSIX
+/* Progress world until received data contains expected string. Returns the
+ * data received so far, starting from the expected string. */
+static
+char* rest_client_wait_for(
+    ecs_world_t *world,
+    int sock,
+    ecs_strbuf_t *received,
+    const char *expect)
+{
+    char buf[4096];
+    for (int t = 0; t < 10000; t ++) {
+        ecs_progress(world, 0);
+
+        ssize_t r = recv(sock, buf, sizeof(buf) - 1, MSG_DONTWAIT);
+        if (r > 0) {
+            buf[r] = '\0';
+            ecs_strbuf_appendstrn(received, buf, (int32_t)r);
+        }
+
+        char *str = ecs_strbuf_get(received);
+        if (str) {
+            char *ptr = strstr(str, expect);
+            if (ptr) {
+                /* Keep data after expected string for next call */
+                ecs_strbuf_appendstr(received, ptr + strlen(expect));
+                char *result = ecs_os_strdup(ptr);
+                ecs_os_free(str);
+                return result;
+            }
+            ecs_strbuf_appendstr(received, str);
+            ecs_os_free(str);
+        }
+
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+
+    return NULL;
+}
+#endif
+
+void Rest_subscribe() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_set_name(world, e1, "e1");
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_set_name(world, e2, "e2");
+
+    ecs_singleton_set(world, EcsRest, {27771});
+    ecs_progress(world, 0);
+
+    int sock = rest_client_connect(27771);
+    test_assert(sock >= 0);
+
+    const char *request = 
+        "GET /subscribe?q=Position&interval=10 HTTP/1.1\r\n\r\n";
+    test_assert(send(sock, request, strlen(request), 0) == 
+        (ssize_t)strlen(request));
+
+    ecs_strbuf_t received = ECS_STRBUF_INIT;
+    char *reply = rest_client_wait_for(world, sock, &received, "HTTP/1.1");
+    test_assert(reply != NULL);
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "Content-Type: text/event-stream\r\n") != NULL);
+    test_assert(strstr(reply, "Transfer-Encoding: chunked\r\n") != NULL);
+    ecs_os_free(reply);
+
+    /* First update contains all results */
+    char *event = rest_client_wait_for(world, sock, &received, "event: update");
+    test_assert(event != NULL);
+    test_assert(strstr(event, "\"removed\":[]") != NULL);
+    test_assert(strstr(event, "\"e1\"") != NULL);
+    test_assert(strstr(event, "\"e2\"") != NULL);
+    ecs_os_free(event);
+    ecs_strbuf_reset(&received);
+
+    /* Only changed entities are sent */
+    ecs_set(world, e2, Position, {50, 60});
+    event = rest_client_wait_for(world, sock, &received, "event: update");
+    test_assert(event != NULL);
+    test_assert(strstr(event, "\"e1\"") == NULL);
+    test_assert(strstr(event, "\"e2\"") != NULL);
+    ecs_os_free(event);
+    ecs_strbuf_reset(&received);
+
+    /* Entities that no longer match are sent as removed */
+    ecs_delete(world, e1);
+    event = rest_client_wait_for(world, sock, &received, "event: update");
+    test_assert(event != NULL);
+    test_assert(strstr(event, "\"removed\":[\"e1\"]") != NULL);
+    test_assert(strstr(event, "\"e2\"") == NULL);
+    ecs_os_free(event);
+    ecs_strbuf_reset(&received);
+
+    close(sock);
+
+    /* Subscription is cleaned up after connection is closed */
+    for (int i = 0; i < 100; i ++) {
+        ecs_set(world, e2, Position, {i, i});
+        ecs_progress(world, 0);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+
+    ecs_fini(world);
+#endif
+}
+
+void Rest_subscribe_invalid_query() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_singleton_set(world, EcsRest, {27772});
+    ecs_progress(world, 0);
+
+    int sock = rest_client_connect(27772);
+    test_assert(sock >= 0);
+
+    const char *request = "GET /subscribe?q=Foo HTTP/1.1\r\n\r\n";
+    test_assert(send(sock, request, strlen(request), 0) == 
+        (ssize_t)strlen(request));
+
+    ecs_strbuf_t received = ECS_STRBUF_INIT;
+    char *event = rest_client_wait_for(world, sock, &received, "event: error");
+    test_assert(event != NULL);
+    test_assert(strstr(event, "unresolved identifier 'Foo'") != NULL);
+    ecs_os_free(event);
+
+    /* Stream is closed after the error */
+    char *end = rest_client_wait_for(world, sock, &received, "0\r\n\r\n");
+    test_assert(end != NULL);
+    ecs_os_free(end);
+    ecs_strbuf_reset(&received);
+
+    close(sock);
+
+    ecs_fini(world);
+#endif
+}
+
+void Rest_query_cbor() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_set_name(world, e, "e");
+
+    ecs_singleton_set(world, EcsRest, { .port = 27775, .threaded = true });
+
+    int sock = rest_client_connect(27775);
+    test_assert(sock >= 0);
+
+    char reply[4096];
+
+    /* Enable change tracking for matched table, so replies have an ETag */
+    ecs_readonly_begin(world);
+    rest_client_get(sock, "GET /query?q=Position HTTP/1.1\r\n\r\n", 
+        reply, sizeof(reply));
+    ecs_readonly_end(world);
+    ecs_progress(world, 0);
+
+    ecs_readonly_begin(world);
+    rest_client_get(sock, "GET /query?q=Position HTTP/1.1\r\n\r\n", 
+        reply, sizeof(reply));
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "Content-Type: application/json\r\n") != NULL);
+    char *etag_json = rest_reply_etag(reply);
+
+    rest_client_get(sock, "GET /query?q=Position HTTP/1.1\r\n"
+        "Accept: application/cbor\r\n\r\n", reply, sizeof(reply));
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "Content-Type: application/cbor\r\n") != NULL);
+    test_assert(strstr(reply, "Vary: Accept\r\n") != NULL);
+
+    /* Formats have a different ETag */
+    char *etag_cbor = rest_reply_etag(reply);
+    test_assert(strcmp(etag_json, etag_cbor) != 0);
+
+    /* Body starts with map that has the "ids" member */
+    const char *body = strstr(reply, "\r\n\r\n") + 4;
+    test_int((uint8_t)body[0], 0xbf);
+    test_assert(!strncmp(&body[1], "\x63" "ids", 4));
+
+    rest_client_get(sock, "GET /entity/e HTTP/1.1\r\n"
+        "Accept: application/cbor\r\n\r\n", reply, sizeof(reply));
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "Content-Type: application/cbor\r\n") != NULL);
+    body = strstr(reply, "\r\n\r\n") + 4;
+    test_int((uint8_t)body[0], 0xbf);
+    test_assert(!strncmp(&body[1], "\x64" "path" "\x61" "e", 7));
+    ecs_readonly_end(world);
+
+    ecs_os_free(etag_json);
+    ecs_os_free(etag_cbor);
+    close(sock);
+
+    ecs_fini(world);
+#endif
+}
+
+#ifdef ECS_TARGET_POSIX
+static
+void RestMetricsSystem(ecs_iter_t *it) { }
+#endif
+
+void Rest_metrics() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_IMPORT(world, FlecsMonitor);
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, RestMetricsSystem, EcsOnUpdate, Position);
+    ecs_set(world, 0, Position, {10, 20});
+
+    ecs_progress(world, 0);
+    ecs_progress(world, 0);
+
+    ecs_singleton_set(world, EcsRest, { .port = 27776, .threaded = true });
+
+    int sock = rest_client_connect(27776);
+    test_assert(sock >= 0);
+
+    const char *request = "GET /metrics HTTP/1.1\r\n\r\n";
+    test_assert(send(sock, request, strlen(request), 0) == 
+        (ssize_t)strlen(request));
+
+    /* Read until the end of the exposition */
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    char *reply = NULL;
+    ecs_readonly_begin(world);
+    for (int t = 0; t < 10000; t ++) {
+        char data[4096];
+        if (rest_client_recv(sock, data, sizeof(data), 1)) {
+            ecs_strbuf_appendstr(&buf, data);
+            ecs_os_free(reply);
+            reply = ecs_strbuf_get(&buf);
+            ecs_strbuf_appendstr(&buf, reply);
+            if (strstr(reply, "# EOF\n")) {
+                break;
+            }
+        }
+    }
+    ecs_readonly_end(world);
+    ecs_strbuf_reset(&buf);
+    close(sock);
+
+    test_assert(reply != NULL);
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "Content-Type: application/openmetrics-text; "
+        "version=1.0.0; charset=utf-8\r\n") != NULL);
+
+    const char *body = strstr(reply, "\r\n\r\n") + 4;
+    const char *head = 
+        "# TYPE flecs_entities_count gauge\n"
+        "# HELP flecs_entities_count Alive entity ids in the world\n"
+        "flecs_entities_count ";
+    test_assert(!strncmp(body, head, strlen(head)));
+    test_assert(strstr(body, 
+        "# TYPE flecs_frame_frame_count counter\n") != NULL);
+    test_assert(strstr(body, "\nflecs_frame_frame_count_total ") != NULL);
+    test_assert(strstr(body, 
+        "\nflecs_latency_frame_time{quantile=\"0.99\"} ") != NULL);
+    test_assert(strstr(body, 
+        "\nflecs_system_invoke_count_total{system=\"RestMetricsSystem\"} ") 
+            != NULL);
+    test_assert(strstr(body, 
+        "\nflecs_system_matched_entity_count{system=\"RestMetricsSystem\"} 1\n") 
+            != NULL);
+    test_str(&body[strlen(body) - 6], "# EOF\n");
+
+    ecs_os_free(reply);
+    ecs_fini(world);
+#endif
+}
+
+void Rest_threaded_query_slow_client() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    for (int i = 0; i < 50000; i ++) {
+        ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_singleton_set(world, EcsRest, { .port = 27781, .threaded = true });
+
+    int sock = rest_client_connect_w_rcvbuf(27781, 4096);
+    test_assert(sock >= 0);
+
+    const char *request = 
+        "GET /query?q=Position&limit=100000 HTTP/1.1\r\n\r\n";
+    test_assert(send(sock, request, strlen(request), 0) == 
+        (ssize_t)strlen(request));
+
+    /* Client doesn't read the reply while the REST thread reads the world */
+    ecs_readonly_begin(world);
+    ecs_os_sleep(0, 500 * 1000 * 1000);
+
+    /* Main thread doesn't wait for the client to read the reply */
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+    ecs_readonly_end(world);
+    test_assert(ecs_time_measure(&t) < 2.0);
+
+    /* Reply is sent in one piece after the request is handled */
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    char *reply = NULL;
+    const char *body = NULL;
+    long content_length = -1;
+    for (int i = 0; i < 10000; i ++) {
+        char data[4096];
+        if (!rest_client_recv(sock, data, sizeof(data), 1)) {
+            continue;
+        }
+
+        ecs_strbuf_appendstr(&buf, data);
+        ecs_os_free(reply);
+        reply = ecs_strbuf_get(&buf);
+        ecs_strbuf_appendstr(&buf, reply);
+
+        if (!body && (body = strstr(reply, "\r\n\r\n"))) {
+            const char *cl = strstr(reply, "Content-Length: ");
+            test_assert(cl != NULL);
+            content_length = strtol(cl + 16, NULL, 10);
+        }
+        if (body) {
+            body = strstr(reply, "\r\n\r\n") + 4;
+            if ((long)strlen(body) >= content_length) {
+                break;
+            }
+        }
+    }
+    ecs_strbuf_reset(&buf);
+    close(sock);
+
+    test_assert(reply != NULL);
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "Transfer-Encoding: chunked\r\n") == NULL);
+    test_assert(body != NULL);
+    test_int((long)strlen(body), content_length);
+    test_assert(content_length > ECS_HTTP_CHUNK_SIZE);
+    test_str(&body[strlen(body) - 3], "}]}");
+
+    ecs_os_free(reply);
+    ecs_fini(world);
+#endif
+}
+
+#ifdef ECS_TARGET_POSIX
+static
+void RestReadPosition(ecs_iter_t *it) { }
+
+static
+void RestWritePosition(ecs_iter_t *it) {
+    Position *p = ecs_field(it, Position, 1);
+    for (int i = 0; i < it->count; i ++) {
+        p[i].x ++;
+    }
+}
+#endif
+
+void Rest_query_etag_system_write() {
+#ifdef ECS_TARGET_POSIX
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, RestReadPosition, EcsOnUpdate, [in] Position);
+    ECS_SYSTEM(world, RestWritePosition, EcsOnUpdate, Position);
+    ecs_enable(world, RestWritePosition, false);
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_set_name(world, e, "e");
+
+    ecs_singleton_set(world, EcsRest, { .port = 27782, .threaded = true });
+
+    int sock = rest_client_connect(27782);
+    test_assert(sock >= 0);
+
+    char reply[4096], request[512];
+
+    /* Enable change tracking for matched table */
+    ecs_readonly_begin(world);
+    rest_client_get(sock, "GET /query?q=Position HTTP/1.1\r\n\r\n", 
+        reply, sizeof(reply));
+    ecs_readonly_end(world);
+    ecs_progress(world, 0);
+
+    ecs_readonly_begin(world);
+    rest_client_get(sock, "GET /query?q=Position HTTP/1.1\r\n\r\n", 
+        reply, sizeof(reply));
+    ecs_readonly_end(world);
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    char *etag = rest_reply_etag(reply);
+    ecs_os_sprintf(request, 
+        "GET /query?q=Position HTTP/1.1\r\nIf-None-Match: %s\r\n\r\n", etag);
+
+    /* System that only reads the component doesn't change the ETag */
+    ecs_progress(world, 0);
+    ecs_readonly_begin(world);
+    rest_client_get(sock, request, reply, sizeof(reply));
+    ecs_readonly_end(world);
+    test_assert(!strncmp(reply, "HTTP/1.1 304 Not Modified\r\n", 27));
+
+    /* System that writes the component changes the ETag */
+    ecs_enable(world, RestWritePosition, true);
+    ecs_progress(world, 0);
+    ecs_readonly_begin(world);
+    rest_client_get(sock, request, reply, sizeof(reply));
+    ecs_readonly_end(world);
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    char *etag_changed = rest_reply_etag(reply);
+    test_assert(strcmp(etag_changed, etag) != 0);
+    ecs_os_free(etag_changed);
+
+    ecs_os_free(etag);
+    close(sock);
+
+    ecs_fini(world);
+#endif
+}
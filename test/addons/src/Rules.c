@@ -6785,3 +6785,58 @@ void Rules_rule_w_short_notation() {
 
     ecs_fini(world);
 }
+
+void Rules_rule_estimate() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_new(world, TagA);
+    ecs_entity_t e = ecs_new(world, TagA);
+    ecs_add(world, e, TagB);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "TagA, TagB"
+    });
+    test_assert(r != NULL);
+
+    ecs_estimate_t est = ecs_rule_estimate(r);
+    test_int(est.max_table_count, 1);
+    test_int(est.max_entity_count, 1);
+    test_int(est.table_count, 1);
+    test_int(est.entity_count, 1);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_rule_estimate_w_var() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Likes);
+    ECS_TAG(world, TagA);
+
+    ecs_entity_t e1 = ecs_new(world, TagA);
+    ecs_entity_t e2 = ecs_new(world, TagA);
+    ecs_add_pair(world, e2, Likes, e1);
+    ecs_add_pair(world, ecs_new_id(world), Likes, e1);
+    ecs_add_pair(world, ecs_new_id(world), Likes, e2);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Likes($X, $Y)"
+    });
+    test_assert(r != NULL);
+
+    /* Terms on other variables constrain the estimate of a rule */
+    ecs_estimate_t est = ecs_rule_estimate(r);
+    test_int(est.max_table_count, 3);
+    test_int(est.max_entity_count, 3);
+    test_int(est.table_count, 3);
+    test_int(est.entity_count, 3);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
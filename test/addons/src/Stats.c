@@ -294,3 +294,346 @@ void Stats_get_not_alive_entity_count() {
 
     ecs_fini(world);
 }
+
+void Stats_get_query_stats_counters() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_set(world, e2, Velocity, {3, 4});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {50, 60});
+    ecs_set(world, e3, Velocity, {5, 6});
+    ecs_add_id(world, e3, ecs_new_id(world));
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position) }, { ecs_id(Velocity) }}
+    });
+
+    ecs_query_stats_t stats = {0};
+    ecs_query_stats_get(world, q, &stats);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) { }
+
+    ecs_query_stats_get(world, q, &stats);
+    test_int(stats.t, 2);
+
+#ifdef FLECS_QUERY_COUNTERS
+    test_int(stats.iterated_table_count.counter.value[2], 2);
+    test_int(stats.iterated_entity_count.counter.value[2], 3);
+    test_int(stats.bytes_touched.counter.value[2], 
+        3 * (ECS_SIZEOF(Position) + ECS_SIZEOF(Velocity)));
+    test_int(stats.skipped_table_count.counter.value[2], 0);
+#else
+    test_int(stats.iterated_table_count.counter.value[2], 0);
+    test_int(stats.iterated_entity_count.counter.value[2], 0);
+    test_int(stats.bytes_touched.counter.value[2], 0);
+#endif
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+static void CountSys(ecs_iter_t *it) { }
+
+void Stats_get_system_stats_counters_multi_threaded() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    for (int i = 0; i < 10; i ++) {
+        ecs_set(world, 0, Position, {i, i});
+    }
+
+    ecs_entity_t sys = ecs_system(world, {
+        .entity = ecs_entity(world, {.add = {ecs_dependson(EcsOnUpdate)}}),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .callback = CountSys,
+        .multi_threaded = true
+    });
+    test_assert(sys != 0);
+
+    ecs_set_threads(world, 2);
+
+    ecs_system_stats_t stats = {0};
+    test_bool(ecs_system_stats_get(world, sys, &stats), true);
+
+    ecs_progress(world, 0);
+
+    test_bool(ecs_system_stats_get(world, sys, &stats), true);
+    test_int(stats.query.t, 2);
+
+    /* Entities are only counted once, though each worker visits all tables */
+#ifdef FLECS_QUERY_COUNTERS
+    test_int(stats.query.iterated_entity_count.counter.value[2], 10);
+#else
+    test_int(stats.query.iterated_entity_count.counter.value[2], 0);
+#endif
+
+    ecs_fini(world);
+}
+
+static int64_t work_sys_sum = 0;
+
+static void WorkSys(ecs_iter_t *it) {
+    Position *p = ecs_field(it, Position, 1);
+    for (int r = 0; r < 1000; r ++) {
+        for (int i = 0; i < it->count; i ++) {
+            work_sys_sum += (int64_t)p[i].x + r;
+        }
+    }
+}
+
+void Stats_get_system_stats_perf_counters() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    for (int i = 0; i < 10; i ++) {
+        ecs_set(world, 0, Position, {i, i});
+    }
+
+    ecs_entity_t sys = ecs_system(world, {
+        .entity = ecs_entity(world, {.add = {ecs_dependson(EcsOnUpdate)}}),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .callback = WorkSys,
+        .multi_threaded = true
+    });
+    test_assert(sys != 0);
+
+    ecs_set_threads(world, 2);
+    ecs_measure_system_time(world, true);
+
+    ecs_system_stats_t stats = {0};
+    test_bool(ecs_system_stats_get(world, sys, &stats), true);
+
+    ecs_progress(world, 0);
+    ecs_progress(world, 0);
+    test_assert(work_sys_sum != 0);
+
+    test_bool(ecs_system_stats_get(world, sys, &stats), true);
+    test_int(stats.query.t, 2);
+
+    /* Hardware counters may not be available (e.g. when running in a VM or
+     * when permission is denied), in which case they are reported as 0. */
+#ifdef FLECS_PERF_COUNTERS
+    if (stats.cycles.counter.value[2] != 0 || 
+        stats.instructions.counter.value[2] != 0 ||
+        stats.cache_misses.counter.value[2] != 0 ||
+        stats.branch_misses.counter.value[2] != 0) 
+    {
+        test_assert(stats.instructions.counter.value[2] > 0);
+    }
+#else
+    test_int(stats.cycles.counter.value[2], 0);
+    test_int(stats.instructions.counter.value[2], 0);
+    test_int(stats.cache_misses.counter.value[2], 0);
+    test_int(stats.branch_misses.counter.value[2], 0);
+#endif
+
+    ecs_fini(world);
+}
+
+void Stats_get_system_stats_perf_counters_stages() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    for (int i = 0; i < 10; i ++) {
+        ecs_set(world, 0, Position, {i, i});
+    }
+
+    ecs_entity_t sys = ecs_system(world, {
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .callback = WorkSys,
+        .multi_threaded = true
+    });
+    test_assert(sys != 0);
+
+    ecs_set_stage_count(world, 2);
+    ecs_measure_system_time(world, true);
+
+    ecs_system_stats_t stats = {0};
+    test_bool(ecs_system_stats_get(world, sys, &stats), true);
+
+    /* Run both halves of the system, each on its own stage */
+    ecs_readonly_begin(world);
+    ecs_run_worker(ecs_get_stage(world, 0), sys, 0, 2, 0, NULL);
+    ecs_readonly_end(world);
+    test_bool(ecs_system_stats_get(world, sys, &stats), true);
+
+    ecs_readonly_begin(world);
+    ecs_run_worker(ecs_get_stage(world, 1), sys, 1, 2, 0, NULL);
+    ecs_readonly_end(world);
+    test_bool(ecs_system_stats_get(world, sys, &stats), true);
+    test_int(stats.query.t, 3);
+
+    /* Counters of the system are the sum of the counters of all stages */
+#ifdef FLECS_PERF_COUNTERS
+    if (stats.instructions.counter.value[2] != 0) {
+        test_assert(stats.instructions.counter.value[3] > 
+            stats.instructions.counter.value[2]);
+    } else {
+        test_int(stats.cycles.counter.value[3], 0);
+        test_int(stats.instructions.counter.value[3], 0);
+        test_int(stats.cache_misses.counter.value[3], 0);
+        test_int(stats.branch_misses.counter.value[3], 0);
+    }
+#else
+    test_int(stats.cycles.counter.value[3], 0);
+    test_int(stats.instructions.counter.value[3], 0);
+#endif
+
+    ecs_fini(world);
+}
+
+void Stats_get_world_stats_latency() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_measure_frame_time(world, true);
+    ecs_measure_system_time(world, true);
+
+    ecs_world_stats_t stats = {0};
+    ecs_world_stats_get(world, &stats);
+    test_flt(stats.latency.frame_time.p50[1], 0);
+
+    for (int i = 0; i < 10; i ++) {
+        ecs_progress(world, 0);
+    }
+
+    ecs_world_stats_get(world, &stats);
+    test_int(stats.t, 2);
+
+    const ecs_latency_t *l = &stats.latency.frame_time;
+    test_assert(l->p50[2] > 0);
+    test_assert(l->p50[2] <= l->p90[2]);
+    test_assert(l->p90[2] <= l->p99[2]);
+    test_assert(l->p99[2] <= l->p999[2]);
+    test_assert(stats.latency.merge_time.p50[2] > 0);
+    test_assert(stats.latency.sync_time.p50[2] > 0);
+
+    /* No frames since last measurement */
+    ecs_world_stats_get(world, &stats);
+    test_flt(stats.latency.frame_time.p50[3], 0);
+    test_flt(stats.latency.frame_time.p999[3], 0);
+
+    ecs_fini(world);
+}
+
+static int slow_sys_invoked = 0;
+
+static void SlowSys(ecs_iter_t *it) {
+    /* 1 out of 100 invocations is slow */
+    if (!(++ slow_sys_invoked % 100)) {
+        ecs_sleepf(0.01);
+    }
+}
+
+void Stats_get_system_stats_latency() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t sys = ecs_system(world, {
+        .entity = ecs_entity(world, {.add = {ecs_dependson(EcsOnUpdate)}}),
+        .callback = SlowSys
+    });
+    test_assert(sys != 0);
+
+    ecs_measure_system_time(world, true);
+
+    ecs_system_stats_t stats = {0};
+    test_bool(ecs_system_stats_get(world, sys, &stats), true);
+
+    for (int i = 0; i < 100; i ++) {
+        ecs_progress(world, 0);
+    }
+
+    test_bool(ecs_system_stats_get(world, sys, &stats), true);
+    test_int(stats.query.t, 2);
+    test_int(slow_sys_invoked, 100);
+
+    const ecs_latency_t *l = &stats.time_latency;
+    test_assert(l->p50[2] > 0);
+    test_assert(l->p50[2] < 0.005);
+    test_assert(l->p90[2] < 0.005);
+    test_assert(l->p99[2] < 0.005);
+    test_assert(l->p999[2] >= 0.008);
+
+    ecs_fini(world);
+}
+
+void Stats_reduce_world_stats_latency() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_measure_frame_time(world, true);
+
+    ecs_world_stats_t *src = ecs_os_calloc_t(ecs_world_stats_t);
+    ecs_world_stats_t *dst = ecs_os_calloc_t(ecs_world_stats_t);
+
+    for (int i = 0; i < 5; i ++) {
+        ecs_progress(world, 0);
+        ecs_world_stats_get(world, src);
+    }
+
+    /* Reduced measurement includes all frames of source */
+    ecs_world_stats_reduce(dst, src);
+    test_int(dst->t, 1);
+    test_assert(dst->latency.frame_time.p50[1] > 0);
+    test_assert(dst->latency.frame_time.p999[1] >= 
+        dst->latency.frame_time.p50[1]);
+
+    /* No new frames, reduced measurement has no samples */
+    ecs_world_stats_reduce(dst, src);
+    test_int(dst->t, 2);
+    test_flt(dst->latency.frame_time.p50[2], 0);
+
+    ecs_os_free(src);
+    ecs_os_free(dst);
+
+    ecs_fini(world);
+}
+
+void Stats_get_system_stats_latency_multi_threaded() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    for (int i = 0; i < 10; i ++) {
+        ecs_set(world, 0, Position, {i, i});
+    }
+
+    ecs_entity_t sys = ecs_system(world, {
+        .entity = ecs_entity(world, {.add = {ecs_dependson(EcsOnUpdate)}}),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .callback = CountSys,
+        .multi_threaded = true
+    });
+    test_assert(sys != 0);
+
+    ecs_set_threads(world, 2);
+    ecs_measure_system_time(world, true);
+
+    ecs_system_stats_t stats = {0};
+    test_bool(ecs_system_stats_get(world, sys, &stats), true);
+
+    for (int i = 0; i < 10; i ++) {
+        ecs_progress(world, 0);
+    }
+
+    test_bool(ecs_system_stats_get(world, sys, &stats), true);
+    test_int(stats.query.t, 2);
+
+    /* Each invocation is recorded once, not once per worker */
+    const ecs_latency_t *l = &stats.time_latency;
+    uint32_t i, samples = 0;
+    for (i = 0; i < ECS_HISTOGRAM_BUCKET_COUNT; i ++) {
+        samples += l->last.count[i] - l->start.count[i];
+    }
+    test_int(samples, 10);
+
+    ecs_fini(world);
+}
@@ -0,0 +1,196 @@
+#include <addons.h>
+
+static
+int count_str(
+    const char *str,
+    const char *sub)
+{
+    int count = 0;
+    const char *ptr = str;
+    while ((ptr = strstr(ptr, sub))) {
+        count ++;
+        ptr += strlen(sub);
+    }
+    return count;
+}
+
+static void Dummy(ecs_iter_t *it) { }
+
+static int on_set_invoked = 0;
+
+static void OnSet(ecs_iter_t *it) {
+    on_set_invoked ++;
+}
+
+void Tracing_not_started() {
+    ecs_world_t *world = ecs_init();
+
+    test_bool(ecs_tracing_enabled(world), false);
+    test_assert(ecs_tracing_to_json(world) == NULL);
+
+    ecs_progress(world, 0);
+
+    test_assert(ecs_tracing_to_json(world) == NULL);
+
+    ecs_fini(world);
+}
+
+void Tracing_start_stop() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_tracing_start(world, 0);
+    test_bool(ecs_tracing_enabled(world), true);
+
+    char *json = ecs_tracing_to_json(world);
+    test_assert(json != NULL);
+    test_str(json, "{\"traceEvents\":[{\"name\":\"thread_name\",\"ph\":\"M\","
+        "\"pid\":0,\"tid\":0,\"args\":{\"name\":\"main 0\"}}],"
+        "\"displayTimeUnit\":\"ms\"}");
+    ecs_os_free(json);
+
+    ecs_tracing_stop(world);
+    test_bool(ecs_tracing_enabled(world), false);
+    test_assert(ecs_tracing_to_json(world) == NULL);
+
+    ecs_fini(world);
+}
+
+void Tracing_trace_frame() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_tracing_start(world, 0);
+
+    ecs_progress(world, 0);
+    ecs_progress(world, 0);
+
+    char *json = ecs_tracing_to_json(world);
+    test_assert(json != NULL);
+    test_int(count_str(json, "\"cat\":\"frame\",\"ph\":\"B\""), 2);
+    test_int(count_str(json, "\"cat\":\"frame\",\"ph\":\"E\""), 2);
+    ecs_os_free(json);
+
+    ecs_fini(world);
+}
+
+void Tracing_trace_system() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Dummy, EcsOnUpdate, Position);
+
+    ecs_new(world, Position);
+
+    ecs_tracing_start(world, 0);
+
+    ecs_progress(world, 0);
+
+    char *json = ecs_tracing_to_json(world);
+    test_assert(json != NULL);
+    test_int(count_str(json,
+        "{\"name\":\"Dummy\",\"cat\":\"system\",\"ph\":\"B\""), 1);
+    test_int(count_str(json,
+        "{\"name\":\"Dummy\",\"cat\":\"system\",\"ph\":\"E\""), 1);
+    test_assert(count_str(json, "\"cat\":\"pipeline\",\"ph\":\"B\"") >= 1);
+    ecs_os_free(json);
+
+    ecs_fini(world);
+}
+
+void Tracing_trace_observer() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_OBSERVER(world, OnSet, EcsOnSet, Position);
+
+    ecs_tracing_start(world, 0);
+
+    ecs_set(world, 0, Position, {10, 20});
+    test_int(on_set_invoked, 1);
+
+    char *json = ecs_tracing_to_json(world);
+    test_assert(json != NULL);
+    test_int(count_str(json,
+        "{\"name\":\"OnSet\",\"cat\":\"observer\",\"ph\":\"B\""), 1);
+    test_int(count_str(json,
+        "{\"name\":\"OnSet\",\"cat\":\"observer\",\"ph\":\"E\""), 1);
+    ecs_os_free(json);
+
+    ecs_fini(world);
+}
+
+void Tracing_trace_merge() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_tracing_start(world, 0);
+
+    ecs_progress(world, 0);
+
+    char *json = ecs_tracing_to_json(world);
+    test_assert(json != NULL);
+    test_assert(count_str(json, "\"cat\":\"merge\",\"ph\":\"B\"") >= 1);
+    test_int(count_str(json, "\"cat\":\"merge\",\"ph\":\"B\""),
+        count_str(json, "\"cat\":\"merge\",\"ph\":\"E\""));
+    ecs_os_free(json);
+
+    ecs_fini(world);
+}
+
+void Tracing_trace_multi_threaded() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, {
+            .name = "Dummy",
+            .add = {ecs_dependson(EcsOnUpdate)}
+        }),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .callback = Dummy,
+        .multi_threaded = true
+    });
+
+    ecs_new(world, Position);
+
+    ecs_set_threads(world, 2);
+    ecs_tracing_start(world, 0);
+
+    ecs_progress(world, 0);
+
+    char *json = ecs_tracing_to_json(world);
+    test_assert(json != NULL);
+    test_assert(strstr(json, "\"args\":{\"name\":\"worker 1\"}") != NULL);
+    test_int(count_str(json,
+        "{\"name\":\"Dummy\",\"cat\":\"system\",\"ph\":\"B\""), 2);
+    test_int(count_str(json,
+        "\"cat\":\"system\",\"ph\":\"B\",\"ts\":"),
+        count_str(json, "\"cat\":\"system\",\"ph\":\"E\",\"ts\":"));
+    test_assert(count_str(json, "\"cat\":\"sync\",\"ph\":\"B\"") >= 2);
+    ecs_os_free(json);
+
+    ecs_fini(world);
+}
+
+void Tracing_trace_wrap_around() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_tracing_start(world, 5); /* Rounded up to 8 */
+
+    for (int i = 0; i < 10; i ++) {
+        ecs_progress(world, 0);
+    }
+
+    char *json = ecs_tracing_to_json(world);
+    test_assert(json != NULL);
+
+    /* Only the last events are stored, and no end event is emitted without a
+     * corresponding begin event */
+    int begin = count_str(json, "\"ph\":\"B\"");
+    int end = count_str(json, "\"ph\":\"E\"");
+    test_assert(begin + end <= 8);
+    test_assert(begin >= end);
+    test_assert(begin != 0);
+    ecs_os_free(json);
+
+    ecs_fini(world);
+}
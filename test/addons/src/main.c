@@ -628,6 +628,8 @@ void Rules_table_subj_as_obj_in_not(void);
 void Rules_invalid_variable_only(void);
 void Rules_page_iter(void);
 void Rules_rule_w_short_notation(void);
+void Rules_rule_estimate(void);
+void Rules_rule_estimate_w_var(void);
 
 // Testsuite 'TransitiveRules'
 void TransitiveRules_trans_X_X(void);
@@ -793,6 +795,14 @@ void Stats_get_pipeline_stats_after_progress_2_systems(void);
 void Stats_get_pipeline_stats_after_progress_2_systems_one_merge(void);
 void Stats_get_entity_count(void);
 void Stats_get_not_alive_entity_count(void);
+void Stats_get_query_stats_counters(void);
+void Stats_get_system_stats_counters_multi_threaded(void);
+void Stats_get_system_stats_perf_counters(void);
+void Stats_get_world_stats_latency(void);
+void Stats_get_system_stats_latency(void);
+void Stats_reduce_world_stats_latency(void);
+void Stats_get_system_stats_latency_multi_threaded(void);
+void Stats_get_system_stats_perf_counters_stages(void);
 
 // Testsuite 'Run'
 void Run_setup(void);
@@ -862,6 +872,7 @@ void MultiThread_fini_after_set_threads(void);
 void MultiThread_2_threads_single_threaded_system(void);
 void MultiThread_no_staging_w_multithread(void);
 void MultiThread_multithread_w_monitor_addon(void);
+void MultiThread_2_thread_multi_threaded_groups(void);
 
 // Testsuite 'MultiThreadStaging'
 void MultiThreadStaging_setup(void);
@@ -943,9 +954,47 @@ void Http_teardown(void);
 void Http_teardown_started(void);
 void Http_teardown_stopped(void);
 void Http_stop_start(void);
+void Http_http_request(void);
+void Http_slow_client_doesnt_block(void);
+void Http_concurrent_1k_connections(void);
+void Http_keep_alive(void);
+void Http_keep_alive_close(void);
+void Http_http_1_0_close(void);
+void Http_pipelined_requests(void);
+void Http_pipelined_requests_split(void);
+void Http_chunked_reply(void);
+void Http_chunked_reply_keep_alive(void);
+void Http_chunked_reply_http_1_0(void);
+void Http_chunked_reply_large(void);
+void Http_chunked_reply_client_close(void);
+void Http_open_stream(void);
+void Http_open_stream_client_close(void);
+void Http_chunked_reply_server_stop(void);
+void Http_open_stream_connection_close(void);
+void Http_open_stream_pipelined(void);
 
 // Testsuite 'Rest'
 void Rest_teardown(void);
+void Rest_query_chunked(void);
+void Rest_threaded_readonly(void);
+void Rest_query_etag(void);
+void Rest_query_rule_cache(void);
+void Rest_subscribe(void);
+void Rest_subscribe_invalid_query(void);
+void Rest_query_cbor(void);
+void Rest_metrics(void);
+void Rest_threaded_query_slow_client(void);
+void Rest_query_etag_system_write(void);
+
+// Testsuite 'Tracing'
+void Tracing_not_started(void);
+void Tracing_start_stop(void);
+void Tracing_trace_frame(void);
+void Tracing_trace_system(void);
+void Tracing_trace_observer(void);
+void Tracing_trace_merge(void);
+void Tracing_trace_multi_threaded(void);
+void Tracing_trace_wrap_around(void);
 
 bake_test_case Parser_testcases[] = {
     {
@@ -3394,6 +3443,14 @@ bake_test_case Rules_testcases[] = {
     {
         "rule_w_short_notation",
         Rules_rule_w_short_notation
+    },
+    {
+        "rule_estimate",
+        Rules_rule_estimate
+    },
+    {
+        "rule_estimate_w_var",
+        Rules_rule_estimate_w_var
     }
 };
 
@@ -3991,6 +4048,38 @@ bake_test_case Stats_testcases[] = {
     {
         "get_not_alive_entity_count",
         Stats_get_not_alive_entity_count
+    },
+    {
+        "get_query_stats_counters",
+        Stats_get_query_stats_counters
+    },
+    {
+        "get_system_stats_counters_multi_threaded",
+        Stats_get_system_stats_counters_multi_threaded
+    },
+    {
+        "get_system_stats_perf_counters",
+        Stats_get_system_stats_perf_counters
+    },
+    {
+        "get_world_stats_latency",
+        Stats_get_world_stats_latency
+    },
+    {
+        "get_system_stats_latency",
+        Stats_get_system_stats_latency
+    },
+    {
+        "reduce_world_stats_latency",
+        Stats_reduce_world_stats_latency
+    },
+    {
+        "get_system_stats_latency_multi_threaded",
+        Stats_get_system_stats_latency_multi_threaded
+    },
+    {
+        "get_system_stats_perf_counters_stages",
+        Stats_get_system_stats_perf_counters_stages
     }
 };
 
@@ -4249,6 +4338,10 @@ bake_test_case MultiThread_testcases[] = {
     {
         "multithread_w_monitor_addon",
         MultiThread_multithread_w_monitor_addon
+    },
+    {
+        "2_thread_multi_threaded_groups",
+        MultiThread_2_thread_multi_threaded_groups
     }
 };
 
@@ -4540,6 +4633,78 @@ bake_test_case Http_testcases[] = {
     {
         "stop_start",
         Http_stop_start
+    },
+    {
+        "http_request",
+        Http_http_request
+    },
+    {
+        "slow_client_doesnt_block",
+        Http_slow_client_doesnt_block
+    },
+    {
+        "concurrent_1k_connections",
+        Http_concurrent_1k_connections
+    },
+    {
+        "keep_alive",
+        Http_keep_alive
+    },
+    {
+        "keep_alive_close",
+        Http_keep_alive_close
+    },
+    {
+        "http_1_0_close",
+        Http_http_1_0_close
+    },
+    {
+        "pipelined_requests",
+        Http_pipelined_requests
+    },
+    {
+        "pipelined_requests_split",
+        Http_pipelined_requests_split
+    },
+    {
+        "chunked_reply",
+        Http_chunked_reply
+    },
+    {
+        "chunked_reply_keep_alive",
+        Http_chunked_reply_keep_alive
+    },
+    {
+        "chunked_reply_http_1_0",
+        Http_chunked_reply_http_1_0
+    },
+    {
+        "chunked_reply_large",
+        Http_chunked_reply_large
+    },
+    {
+        "chunked_reply_client_close",
+        Http_chunked_reply_client_close
+    },
+    {
+        "open_stream",
+        Http_open_stream
+    },
+    {
+        "open_stream_client_close",
+        Http_open_stream_client_close
+    },
+    {
+        "chunked_reply_server_stop",
+        Http_chunked_reply_server_stop
+    },
+    {
+        "open_stream_connection_close",
+        Http_open_stream_connection_close
+    },
+    {
+        "open_stream_pipelined",
+        Http_open_stream_pipelined
     }
 };
 
@@ -4547,6 +4712,81 @@ bake_test_case Rest_testcases[] = {
     {
         "teardown",
         Rest_teardown
+    },
+    {
+        "query_chunked",
+        Rest_query_chunked
+    },
+    {
+        "threaded_readonly",
+        Rest_threaded_readonly
+    },
+    {
+        "query_etag",
+        Rest_query_etag
+    },
+    {
+        "query_rule_cache",
+        Rest_query_rule_cache
+    },
+    {
+        "subscribe",
+        Rest_subscribe
+    },
+    {
+        "subscribe_invalid_query",
+        Rest_subscribe_invalid_query
+    },
+    {
+        "query_cbor",
+        Rest_query_cbor
+    },
+    {
+        "metrics",
+        Rest_metrics
+    },
+    {
+        "threaded_query_slow_client",
+        Rest_threaded_query_slow_client
+    },
+    {
+        "query_etag_system_write",
+        Rest_query_etag_system_write
+    }
+};
+
+bake_test_case Tracing_testcases[] = {
+    {
+        "not_started",
+        Tracing_not_started
+    },
+    {
+        "start_stop",
+        Tracing_start_stop
+    },
+    {
+        "trace_frame",
+        Tracing_trace_frame
+    },
+    {
+        "trace_system",
+        Tracing_trace_system
+    },
+    {
+        "trace_observer",
+        Tracing_trace_observer
+    },
+    {
+        "trace_merge",
+        Tracing_trace_merge
+    },
+    {
+        "trace_multi_threaded",
+        Tracing_trace_multi_threaded
+    },
+    {
+        "trace_wrap_around",
+        Tracing_trace_wrap_around
     }
 };
 
@@ -4590,7 +4830,7 @@ static bake_test_suite suites[] = {
         "Rules",
         NULL,
         NULL,
-        168,
+        170,
         Rules_testcases
     },
     {
@@ -4667,7 +4907,7 @@ static bake_test_suite suites[] = {
         "Stats",
         NULL,
         NULL,
-        10,
+        18,
         Stats_testcases
     },
     {
@@ -4681,7 +4921,7 @@ static bake_test_suite suites[] = {
         "MultiThread",
         MultiThread_setup,
         NULL,
-        42,
+        43,
         MultiThread_testcases
     },
     {
@@ -4716,18 +4956,25 @@ static bake_test_suite suites[] = {
         "Http",
         NULL,
         NULL,
-        4,
+        22,
         Http_testcases
     },
     {
         "Rest",
         NULL,
         NULL,
-        1,
+        11,
         Rest_testcases
+    },
+    {
+        "Tracing",
+        NULL,
+        NULL,
+        8,
+        Tracing_testcases
     }
 };
 
 int main(int argc, char *argv[]) {
-    return bake_test_run("addons", argc, argv, suites, 25);
+    return bake_test_run("addons", argc, argv, suites, 26);
 }
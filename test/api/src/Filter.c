@@ -10097,3 +10097,753 @@ void Filter_filter_w_short_notation() {
 
     ecs_fini(world);
 }
+
+void Filter_filter_w_predicate_f32() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, 0, Position, {-10, 20});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {30, 40});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {50, 60});
+    ecs_set(world, 0, Position, {0, 70});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position), .predicate = {
+            .offset = offsetof(Position, x),
+            .kind = EcsPredicateF32,
+            .op = EcsPredicateGt,
+            .value = 0
+        }}}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    Position *p = ecs_field(&it, Position, 1);
+    test_int(p[0].x, 10);
+
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e3);
+    test_uint(it.entities[1], e4);
+    p = ecs_field(&it, Position, 1);
+    test_int(p[0].x, 30);
+    test_int(p[1].x, 50);
+
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+typedef struct Flags {
+    uint32_t value;
+} Flags;
+
+void Filter_filter_w_predicate_mask() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Flags);
+
+    ecs_set(world, 0, Flags, {0x1});
+    ecs_entity_t e2 = ecs_set(world, 0, Flags, {0x2});
+    ecs_entity_t e3 = ecs_set(world, 0, Flags, {0x6});
+    ecs_set(world, 0, Flags, {0x8});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Flags), .predicate = {
+            .kind = EcsPredicateU32,
+            .op = EcsPredicateMaskAny,
+            .mask = 0x2
+        }}}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e2);
+    test_uint(it.entities[1], e3);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_w_predicate_mask_none() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Flags);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Flags, {0x1});
+    ecs_set(world, 0, Flags, {0x2});
+    ecs_set(world, 0, Flags, {0x6});
+    ecs_entity_t e4 = ecs_set(world, 0, Flags, {0x8});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Flags), .predicate = {
+            .kind = EcsPredicateU32,
+            .op = EcsPredicateMaskNone,
+            .mask = 0x6
+        }}}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e4);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_w_predicate_no_match() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, 0, Position, {20, 30});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {30, 40});
+    ecs_add(world, e3, Tag);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position), .predicate = {
+            .kind = EcsPredicateF32,
+            .op = EcsPredicateLt,
+            .value = 10
+        }}}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_w_predicate_2_terms() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, e1, Velocity, {1, 1});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {20, 30});
+    ecs_set(world, e2, Velocity, {2, 2});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {-30, 40});
+    ecs_set(world, e3, Velocity, {1, 1});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {40, 50});
+    ecs_set(world, e4, Velocity, {1, 1});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Position), .predicate = {
+                .kind = EcsPredicateF32,
+                .op = EcsPredicateGtEq,
+                .value = 10
+            }},
+            { ecs_id(Velocity), .predicate = {
+                .offset = offsetof(Velocity, y),
+                .kind = EcsPredicateF32,
+                .op = EcsPredicateEq,
+                .value = 1
+            }}
+        }
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e4);
+    Velocity *v = ecs_field(&it, Velocity, 2);
+    test_int(v[0].y, 1);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_w_predicate_shared() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t base_1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t base_2 = ecs_set(world, 0, Position, {-10, 20});
+    ecs_add_id(world, base_1, EcsPrefab);
+    ecs_add_id(world, base_2, EcsPrefab);
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, EcsIsA, base_1);
+    ecs_entity_t e2 = ecs_new_w_pair(world, EcsIsA, base_1);
+    ecs_new_w_pair(world, EcsIsA, base_2);
+    ecs_new_w_pair(world, EcsIsA, base_2);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .instanced = true,
+        .terms = {{ ecs_id(Position), .predicate = {
+            .kind = EcsPredicateF32,
+            .op = EcsPredicateGt,
+            .value = 0
+        }}}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e1);
+    test_uint(it.entities[1], e2);
+    test_uint(ecs_field_src(&it, 1), base_1);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_w_predicate_range_across_blocks() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    int i;
+    ecs_entity_t entities[200];
+    for (i = 0; i < 200; i ++) {
+        entities[i] = ecs_set(world, 0, Position, {(float)i, 0});
+    }
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position), .predicate = {
+            .kind = EcsPredicateF32,
+            .op = EcsPredicateNeq,
+            .value = 150
+        }}}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 150);
+    test_uint(it.entities[0], entities[0]);
+    test_uint(it.entities[149], entities[149]);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 49);
+    test_uint(it.entities[0], entities[151]);
+    test_uint(it.entities[48], entities[199]);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_w_predicate_mask_float() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position), .predicate = {
+            .kind = EcsPredicateF32,
+            .op = EcsPredicateMaskAny,
+            .mask = 1
+        }}}
+    });
+    test_assert(f == NULL);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_w_predicate_out_of_bounds() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position), .predicate = {
+            .offset = offsetof(Position, y),
+            .kind = EcsPredicateF64,
+            .op = EcsPredicateGt
+        }}}
+    });
+    test_assert(f == NULL);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_w_predicate_tag() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Tag);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ Tag, .predicate = {
+            .kind = EcsPredicateI32,
+            .op = EcsPredicateGt
+        }}}
+    });
+    test_assert(f == NULL);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_w_predicate_not() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ Tag }, { ecs_id(Position), .oper = EcsNot, .predicate = {
+            .kind = EcsPredicateF32,
+            .op = EcsPredicateGt
+        }}}
+    });
+    test_assert(f == NULL);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_intersect_n_tables() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, TagA);
+
+    /* Create many tables with Position and only a few with Velocity, so that
+     * the intersection has to skip ranges of tables */
+    ecs_entity_t e_1 = 0, e_2 = 0;
+    for (int i = 0; i < 100; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {i, i});
+        ecs_add_id(world, e, ecs_new_id(world));
+        if (i == 10) {
+            ecs_set(world, e, Velocity, {1, 2});
+            e_1 = e;
+        }
+        if (i == 90) {
+            ecs_set(world, e, Velocity, {3, 4});
+            e_2 = e;
+        }
+    }
+
+    ecs_entity_t e_3 = ecs_set(world, 0, Velocity, {5, 6});
+    ecs_add(world, e_3, TagA);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position) }, { ecs_id(Velocity) }}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e_1);
+    Position *p = ecs_field(&it, Position, 1);
+    Velocity *v = ecs_field(&it, Velocity, 2);
+    test_int(p->x, 10);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e_2);
+    p = ecs_field(&it, Position, 1);
+    v = ecs_field(&it, Velocity, 2);
+    test_int(p->x, 90);
+    test_int(v->x, 3);
+    test_int(v->y, 4);
+
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_intersect_w_deleted_table() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+    ECS_TAG(world, TagD);
+
+    ecs_entity_t e_1 = ecs_new_w_id(world, TagA);
+    ecs_add(world, e_1, TagB);
+    ecs_entity_t e_2 = ecs_new_w_id(world, TagA);
+    ecs_add(world, e_2, TagB);
+    ecs_add(world, e_2, TagC);
+    ecs_entity_t e_3 = ecs_new_w_id(world, TagA);
+    ecs_add(world, e_3, TagB);
+    ecs_add(world, e_3, TagD);
+
+    /* Deleting the tag deletes its entities and the tables with TagC */
+    ecs_add_pair(world, TagC, EcsOnDelete, EcsDelete);
+    ecs_delete(world, TagC);
+    test_assert(!ecs_is_alive(world, e_2));
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ TagA }, { TagB }}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e_1);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e_3);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_intersect_skip_prefab_disabled() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e_1 = ecs_new_w_id(world, TagA);
+    ecs_add(world, e_1, TagB);
+    ecs_entity_t e_2 = ecs_new_w_id(world, TagA);
+    ecs_add(world, e_2, TagB);
+    ecs_add_id(world, e_2, EcsPrefab);
+    ecs_entity_t e_3 = ecs_new_w_id(world, TagA);
+    ecs_add(world, e_3, TagB);
+    ecs_add_id(world, e_3, EcsDisabled);
+
+    /* Empty table with TagA, TagB */
+    ecs_entity_t e_4 = ecs_new_w_id(world, TagA);
+    ecs_add(world, e_4, TagB);
+    ecs_add_id(world, e_4, ecs_new_id(world));
+    ecs_remove_id(world, e_4, TagA);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ TagA }, { TagB }}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e_1);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_intersect_w_isa() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    /* Inherited ids are not in the table lists, so intersection is not used
+     * when there are IsA relationships */
+    ecs_entity_t base = ecs_new_w_id(world, TagB);
+    ecs_entity_t e_1 = ecs_new_w_id(world, TagA);
+    ecs_add(world, e_1, TagB);
+    ecs_entity_t e_2 = ecs_new_w_pair(world, EcsIsA, base);
+    ecs_add(world, e_2, TagA);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ TagA }, { TagB }}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e_1);
+    test_uint(ecs_field_src(&it, 2), 0);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e_2);
+    test_uint(ecs_field_src(&it, 2), base);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_estimate_2_terms() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+
+    ecs_new(world, TagA);
+    ecs_new(world, TagA);
+
+    ecs_entity_t e = ecs_new(world, TagA);
+    ecs_add(world, e, TagB);
+    e = ecs_new(world, TagA);
+    ecs_add(world, e, TagB);
+    e = ecs_new(world, TagA);
+    ecs_add(world, e, TagB);
+    ecs_add(world, e, TagC);
+
+    e = ecs_new(world, TagB);
+    ecs_add(world, e, TagC);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ TagA }, { TagB }}
+    });
+    test_assert(f != NULL);
+
+    ecs_estimate_t est = ecs_filter_estimate(world, f);
+    test_int(est.max_table_count, 3);
+    test_int(est.max_entity_count, 5);
+    test_int(est.table_count, 2);
+    test_int(est.entity_count, 3);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_estimate_not() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_new(world, TagA);
+    ecs_new(world, TagA);
+    ecs_entity_t e = ecs_new(world, TagA);
+    ecs_add(world, e, TagB);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ TagA }, { TagB, .oper = EcsNot }}
+    });
+    test_assert(f != NULL);
+
+    ecs_estimate_t est = ecs_filter_estimate(world, f);
+    test_int(est.max_table_count, 2);
+    test_int(est.max_entity_count, 3);
+    test_int(est.table_count, 1);
+    test_int(est.entity_count, 2);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_estimate_no_match() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_new(world, TagA);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ TagA }, { TagB }}
+    });
+    test_assert(f != NULL);
+
+    ecs_estimate_t est = ecs_filter_estimate(world, f);
+    test_int(est.max_table_count, 0);
+    test_int(est.max_entity_count, 0);
+    test_int(est.table_count, 0);
+    test_int(est.entity_count, 0);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_estimate_no_this() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+
+    ecs_entity_t e = ecs_new(world, TagA);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ TagA, .src.id = e }}
+    });
+    test_assert(f != NULL);
+
+    ecs_estimate_t est = ecs_filter_estimate(world, f);
+    test_int(est.max_table_count, 1);
+    test_int(est.max_entity_count, 0);
+    test_int(est.table_count, 1);
+    test_int(est.entity_count, 0);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_estimate_w_up() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t parent = ecs_new(world, TagB);
+    ecs_entity_t e = ecs_new(world, TagA);
+    ecs_add_pair(world, e, EcsChildOf, parent);
+    ecs_new(world, TagA);
+
+    /* Term with up traversal doesn't constrain estimate */
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ TagA }, { TagB, .src.flags = EcsParent }}
+    });
+    test_assert(f != NULL);
+
+    ecs_estimate_t est = ecs_filter_estimate(world, f);
+    test_int(est.max_table_count, 2);
+    test_int(est.max_entity_count, 2);
+    test_int(est.table_count, 2);
+    test_int(est.entity_count, 2);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_chain_iter_whole_tables() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {50, 60});
+    ecs_add(world, e_1, TagA);
+    ecs_add(world, e_2, TagA);
+    ecs_add(world, e_3, TagA);
+    ecs_entity_t e_4 = ecs_set(world, 0, Position, {70, 80});
+    ecs_add(world, e_4, TagB);
+
+    ecs_filter_t f = ECS_FILTER_INIT;
+    test_assert(NULL != ecs_filter_init(world, &(ecs_filter_desc_t){
+        .storage = &f,
+        .terms = {{ ecs_id(Position) }}
+    }));
+
+    /* Chaining an iterator that returns whole tables must return whole 
+     * tables, starting at the first row */
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position) }}
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t child_it = ecs_query_iter(world, q);
+    ecs_iter_t it = ecs_filter_chain_iter(&child_it, &f);
+
+    test_assert(ecs_filter_next(&it));
+    test_int(it.offset, 0);
+    test_int(it.count, 3);
+    test_assert(it.table == ecs_get_table(world, e_1));
+    test_int(it.entities[0], e_1);
+    test_int(it.entities[1], e_2);
+    test_int(it.entities[2], e_3);
+    Position *p = ecs_field(&it, Position, 1);
+    test_int(p[0].x, 10);
+    test_int(p[1].x, 30);
+    test_int(p[2].x, 50);
+
+    test_assert(ecs_filter_next(&it));
+    test_int(it.offset, 0);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e_4);
+    p = ecs_field(&it, Position, 1);
+    test_int(p[0].x, 70);
+
+    test_assert(!ecs_filter_next(&it));
+
+    ecs_query_fini(q);
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_chain_iter_row_range() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, TagA);
+
+    ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {50, 60});
+
+    ecs_filter_t f = ECS_FILTER_INIT;
+    test_assert(NULL != ecs_filter_init(world, &(ecs_filter_desc_t){
+        .storage = &f,
+        .terms = {{ ecs_id(Position) }}
+    }));
+
+    /* Chaining an iterator that returns a subset of a table only returns the
+     * rows of the subset */
+    ecs_filter_t *pf = ecs_filter(world, {
+        .terms = {{ ecs_id(Position), .predicate = {
+            .offset = offsetof(Position, x), .kind = EcsPredicateF32,
+            .op = EcsPredicateGt, .value = 20
+        }}}
+    });
+    test_assert(pf != NULL);
+
+    ecs_iter_t child_it = ecs_filter_iter(world, pf);
+    ecs_iter_t it = ecs_filter_chain_iter(&child_it, &f);
+
+    test_assert(ecs_filter_next(&it));
+    test_int(it.offset, 1);
+    test_int(it.count, 2);
+    test_int(it.entities[0], e_2);
+    test_int(it.entities[1], e_3);
+    Position *p = ecs_field(&it, Position, 1);
+    test_int(p[0].x, 30);
+    test_int(p[1].x, 50);
+
+    test_assert(!ecs_filter_next(&it));
+
+    ecs_filter_fini(pf);
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
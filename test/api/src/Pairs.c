@@ -2771,3 +2771,242 @@ void Pairs_oneof_other_rel_parent_constraint_violated() {
     ecs_add_pair(world, e, Rel, ObjC);
 }
 
+
+void Pairs_target_index_add() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, Rel, TargetIndex);
+    ECS_TAG(world, Tgt);
+
+    ecs_entity_t e = ecs_new_id(world);
+    ecs_add_pair(world, e, Rel, Tgt);
+
+    int32_t count;
+    const ecs_entity_t *sources = ecs_get_sources(world, Rel, Tgt, &count);
+    test_assert(sources != NULL);
+    test_int(count, 1);
+    test_uint(sources[0], e);
+
+    ecs_fini(world);
+}
+
+void Pairs_target_index_remove() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, Rel, TargetIndex);
+    ECS_TAG(world, Tgt);
+
+    ecs_entity_t e = ecs_new_id(world);
+    ecs_add_pair(world, e, Rel, Tgt);
+
+    int32_t count;
+    test_assert(ecs_get_sources(world, Rel, Tgt, &count) != NULL);
+    test_int(count, 1);
+
+    ecs_remove_pair(world, e, Rel, Tgt);
+    test_assert(ecs_get_sources(world, Rel, Tgt, &count) == NULL);
+    test_int(count, 0);
+
+    ecs_fini(world);
+}
+
+void Pairs_target_index_multiple_sources() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, Rel, TargetIndex);
+    ECS_TAG(world, TgtA);
+    ECS_TAG(world, TgtB);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, Rel, TgtA);
+    ecs_entity_t e2 = ecs_new_w_pair(world, Rel, TgtA);
+    ecs_entity_t e3 = ecs_new_w_pair(world, Rel, TgtA);
+    ecs_add_pair(world, e3, Rel, TgtB);
+    ecs_add(world, e1, Foo);
+
+    int32_t count;
+    const ecs_entity_t *sources = ecs_get_sources(world, Rel, TgtA, &count);
+    test_int(count, 3);
+    test_uint(sources[0], e1);
+    test_uint(sources[1], e2);
+    test_uint(sources[2], e3);
+
+    sources = ecs_get_sources(world, Rel, TgtB, &count);
+    test_int(count, 1);
+    test_uint(sources[0], e3);
+
+    ecs_remove_pair(world, e1, Rel, TgtA);
+    sources = ecs_get_sources(world, Rel, TgtA, &count);
+    test_int(count, 2);
+    test_uint(sources[0], e3);
+    test_uint(sources[1], e2);
+
+    ecs_fini(world);
+}
+
+void Pairs_target_index_exclusive_replace() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, Rel, TargetIndex, Exclusive);
+    ECS_TAG(world, TgtA);
+    ECS_TAG(world, TgtB);
+
+    ecs_entity_t e = ecs_new_w_pair(world, Rel, TgtA);
+    ecs_add_pair(world, e, Rel, TgtB);
+
+    int32_t count;
+    test_assert(ecs_get_sources(world, Rel, TgtA, &count) == NULL);
+    test_int(count, 0);
+
+    const ecs_entity_t *sources = ecs_get_sources(world, Rel, TgtB, &count);
+    test_int(count, 1);
+    test_uint(sources[0], e);
+
+    ecs_fini(world);
+}
+
+void Pairs_target_index_delete_source() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, Rel, TargetIndex);
+    ECS_TAG(world, Tgt);
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, Rel, Tgt);
+    ecs_entity_t e2 = ecs_new_w_pair(world, Rel, Tgt);
+
+    ecs_delete(world, e1);
+
+    int32_t count;
+    const ecs_entity_t *sources = ecs_get_sources(world, Rel, Tgt, &count);
+    test_int(count, 1);
+    test_uint(sources[0], e2);
+
+    ecs_fini(world);
+}
+
+void Pairs_target_index_delete_target() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, Rel, TargetIndex);
+
+    ecs_entity_t tgt = ecs_new_id(world);
+    ecs_entity_t e1 = ecs_new_w_pair(world, Rel, tgt);
+    ecs_entity_t e2 = ecs_new_w_pair(world, Rel, tgt);
+
+    ecs_delete(world, tgt);
+    test_assert(!ecs_has_pair(world, e1, Rel, tgt));
+    test_assert(!ecs_has_pair(world, e2, Rel, tgt));
+
+    int32_t count;
+    test_assert(ecs_get_sources(world, Rel, tgt, &count) == NULL);
+    test_int(count, 0);
+
+    ecs_fini(world);
+}
+
+void Pairs_target_index_bulk_new() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, Rel, TargetIndex);
+    ECS_TAG(world, Tgt);
+
+    const ecs_entity_t *ids = ecs_bulk_new_w_id(
+        world, ecs_pair(Rel, Tgt), 10);
+    test_assert(ids != NULL);
+
+    int32_t count;
+    const ecs_entity_t *sources = ecs_get_sources(world, Rel, Tgt, &count);
+    test_int(count, 10);
+
+    int i;
+    for (i = 0; i < count; i ++) {
+        test_uint(sources[i], ids[i]);
+    }
+
+    ecs_fini(world);
+}
+
+void Pairs_target_index_no_index() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Rel);
+    ECS_TAG(world, Tgt);
+
+    ecs_new_w_pair(world, Rel, Tgt);
+
+    int32_t count = -1;
+    test_assert(ecs_get_sources(world, Rel, Tgt, &count) == NULL);
+    test_int(count, 0);
+
+    ecs_fini(world);
+}
+
+void Pairs_target_index_world_info() {
+    ecs_world_t *world = ecs_mini();
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    test_int(info->target_index_count, 0);
+    test_int(info->target_index_memory, 0);
+
+    ECS_ENTITY(world, Rel, TargetIndex);
+    ECS_TAG(world, Tgt);
+    test_int(info->target_index_count, 0);
+    test_assert(info->target_index_memory != 0);
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, Rel, Tgt);
+    ecs_new_w_pair(world, Rel, Tgt);
+    test_int(info->target_index_count, 2);
+
+    ecs_delete(world, e1);
+    test_int(info->target_index_count, 1);
+
+    ecs_delete(world, Rel);
+    test_int(info->target_index_count, 0);
+    test_int(info->target_index_memory, 0);
+
+    ecs_fini(world);
+}
+
+void Pairs_target_index_snapshot_restore() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, Rel, TargetIndex);
+    ECS_TAG(world, TgtA);
+    ECS_TAG(world, TgtB);
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, Rel, TgtA);
+    ecs_entity_t e2 = ecs_new_w_pair(world, Rel, TgtA);
+
+    ecs_snapshot_t *s = ecs_snapshot_take(world);
+
+    ecs_remove_pair(world, e1, Rel, TgtA);
+    ecs_add_pair(world, e2, Rel, TgtB);
+    ecs_new_w_pair(world, Rel, TgtB);
+
+    ecs_snapshot_restore(world, s);
+
+    int32_t count;
+    const ecs_entity_t *sources = ecs_get_sources(world, Rel, TgtA, &count);
+    test_int(count, 2);
+    test_uint(sources[0], e1);
+    test_uint(sources[1], e2);
+
+    test_assert(ecs_get_sources(world, Rel, TgtB, &count) == NULL);
+    test_int(count, 0);
+
+    ecs_fini(world);
+}
+
+void Pairs_target_index_add_to_used_relationship() {
+    install_test_abort();
+
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Rel);
+    ECS_TAG(world, Tgt);
+
+    ecs_new_w_pair(world, Rel, Tgt);
+
+    test_expect_abort();
+    ecs_add_id(world, Rel, EcsTargetIndex);
+}
@@ -8159,3 +8159,1166 @@ void Query_query_next_table_w_populate_skip_last() {
 
     ecs_fini(world);
 }
+
+void Query_query_w_predicate() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, 0, Position, {-10, 20});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {30, 40});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {50, 60});
+    ecs_set(world, 0, Position, {0, 70});
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position), .predicate = {
+            .kind = EcsPredicateF32,
+            .op = EcsPredicateGt,
+            .value = 0
+        }}}
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    Position *p = ecs_field(&it, Position, 1);
+    test_int(p[0].x, 10);
+
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e3);
+    test_uint(it.entities[1], e4);
+    p = ecs_field(&it, Position, 1);
+    test_int(p[0].x, 30);
+    test_int(p[1].x, 50);
+
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Query_query_w_predicate_2_tables() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_set(world, 0, Position, {-10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {-30, 40});
+    ecs_add(world, e3, Tag);
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {50, 60});
+    ecs_add(world, e4, Tag);
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {-50, 60});
+    ecs_add(world, e5, Tag);
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position), .predicate = {
+            .kind = EcsPredicateF32,
+            .op = EcsPredicateGtEq,
+            .value = 0
+        }}}
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e4);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Query_query_w_predicate_after_set() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {-10, 20});
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position), .predicate = {
+            .kind = EcsPredicateF32,
+            .op = EcsPredicateGt,
+            .value = 0
+        }}}
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_set(world, e1, Position, {-10, 20});
+    ecs_set(world, e2, Position, {10, 20});
+
+    it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Query_query_w_predicate_w_toggle() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {20, 20});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {-30, 20});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {40, 20});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {50, 20});
+    ecs_entity_t e6 = ecs_set(world, 0, Position, {60, 20});
+
+    ecs_enable_component(world, e1, Position, true);
+    ecs_enable_component(world, e2, Position, true);
+    ecs_enable_component(world, e3, Position, true);
+    ecs_enable_component(world, e4, Position, true);
+    ecs_enable_component(world, e5, Position, false);
+    ecs_enable_component(world, e6, Position, true);
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position), .predicate = {
+            .kind = EcsPredicateF32,
+            .op = EcsPredicateGt,
+            .value = 0
+        }}}
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e1);
+    test_uint(it.entities[1], e2);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e4);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e6);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Query_query_changed_rows() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {20, 20});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {30, 20});
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .track_rows = true
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    it.flags |= EcsIterChangedOnly;
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 3);
+    test_uint(it.entities[0], e1);
+    test_uint(it.entities[1], e2);
+    test_uint(it.entities[2], e3);
+    test_bool(false, ecs_query_next(&it));
+
+    it = ecs_query_iter(world, q);
+    it.flags |= EcsIterChangedOnly;
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_set(world, e2, Position, {25, 20});
+
+    it = ecs_query_iter(world, q);
+    it.flags |= EcsIterChangedOnly;
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    Position *p = ecs_field(&it, Position, 1);
+    test_int(p[0].x, 25);
+    test_bool(false, ecs_query_next(&it));
+
+    it = ecs_query_iter(world, q);
+    it.flags |= EcsIterChangedOnly;
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Query_query_changed_rows_2_ranges() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, 0, Position, {20, 20});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {30, 20});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {40, 20});
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .track_rows = true
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) { }
+
+    ecs_set(world, e1, Position, {15, 20});
+    ecs_set(world, e3, Position, {35, 20});
+    ecs_set(world, e4, Position, {45, 20});
+
+    it = ecs_query_iter(world, q);
+    it.flags |= EcsIterChangedOnly;
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e3);
+    test_uint(it.entities[1], e4);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Query_query_changed_rows_after_new() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, 0, Position, {20, 20});
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .track_rows = true
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) { }
+
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {30, 20});
+
+    it = ecs_query_iter(world, q);
+    it.flags |= EcsIterChangedOnly;
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e3);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Query_query_changed_rows_after_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {20, 20});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {30, 20});
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .track_rows = true
+    });
+    test_assert(q != NULL);
+
+    ecs_set(world, e2, Position, {25, 20});
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) { }
+
+    ecs_set(world, e3, Position, {35, 20});
+    ecs_delete(world, e1);
+
+    /* e3 is moved to the row of e1 and should still be reported */
+    it = ecs_query_iter(world, q);
+    it.flags |= EcsIterChangedOnly;
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e3);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Query_query_changed_rows_after_modified() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {20, 20});
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .track_rows = true
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) { }
+
+    Position *p = ecs_get_mut(world, e2, Position);
+    p->x = 30;
+    ecs_modified(world, e2, Position);
+
+    it = ecs_query_iter(world, q);
+    it.flags |= EcsIterChangedOnly;
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Query_query_changed_rows_w_out_term() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {20, 20});
+    ecs_set(world, 0, Position, {30, 20});
+    ecs_add(world, e2, Velocity);
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {40, 20});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {50, 20});
+    ecs_add(world, e4, Velocity);
+    ecs_add(world, e5, Velocity);
+
+    ecs_query_t *r = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .track_rows = true
+    });
+    test_assert(r != NULL);
+
+    ecs_query_t *w = ecs_query(world, {
+        .filter.terms = {
+            { ecs_id(Position), .inout = EcsOut },
+            { ecs_id(Velocity), .inout = EcsIn }
+        },
+        .track_rows = true
+    });
+    test_assert(w != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, w);
+    while (ecs_query_next(&it)) { }
+    it = ecs_query_iter(world, r);
+    while (ecs_query_next(&it)) { }
+
+    ecs_set(world, e5, Velocity, {1, 1});
+
+    /* Writer only iterates e5, so only e5 is marked dirty for Position */
+    it = ecs_query_iter(world, w);
+    it.flags |= EcsIterChangedOnly;
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e5);
+    test_bool(false, ecs_query_next(&it));
+
+    it = ecs_query_iter(world, r);
+    it.flags |= EcsIterChangedOnly;
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e5);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(r);
+    ecs_query_fini(w);
+
+    ecs_fini(world);
+}
+
+void Query_query_changed_rows_no_tracking() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {20, 20});
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }}
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    it.flags |= EcsIterChangedOnly;
+    while (ecs_query_next(&it)) { }
+
+    it = ecs_query_iter(world, q);
+    it.flags |= EcsIterChangedOnly;
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_set(world, e2, Position, {25, 20});
+
+    /* Without row tracking all rows of a changed table are returned */
+    it = ecs_query_iter(world, q);
+    it.flags |= EcsIterChangedOnly;
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e1);
+    test_uint(it.entities[1], e2);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Query_query_match_count_new_table() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+
+    ecs_query_t *q_a = ecs_query_new(world, "TagA(self)");
+    ecs_query_t *q_b = ecs_query_new(world, "TagB(self)");
+    ecs_query_t *q_c = ecs_query_new(world, "TagC(self)");
+    test_assert(q_a != NULL);
+    test_assert(q_b != NULL);
+    test_assert(q_c != NULL);
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t match_count = info->table_match_total;
+
+    /* Only the query for TagA is evaluated for the new table */
+    ecs_entity_t e = ecs_new(world, TagA);
+    test_int(info->table_match_total - match_count, 1);
+
+    ecs_iter_t it = ecs_query_iter(world, q_a);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e);
+    test_bool(false, ecs_query_next(&it));
+
+    it = ecs_query_iter(world, q_b);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_query_match_new_table_2_terms() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_query_t *q = ecs_query_new(world, "TagA(self), TagB(self)");
+    test_assert(q != NULL);
+
+    ecs_new(world, TagA);
+    ecs_new(world, TagB);
+    ecs_entity_t e = ecs_new(world, TagA);
+    ecs_add(world, e, TagB);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_query_match_new_table_inherited() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    test_assert(q != NULL);
+
+    ecs_entity_t base = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e = ecs_new_w_pair(world, EcsIsA, base);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], base);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e);
+    test_uint(it.sources[0], base);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_query_match_new_table_wildcard() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Rel);
+    ECS_TAG(world, TgtA);
+    ECS_TAG(world, TgtB);
+
+    ecs_query_t *q = ecs_query_new(world, "(Rel, *)");
+    test_assert(q != NULL);
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, Rel, TgtA);
+    ecs_entity_t e2 = ecs_new_w_pair(world, Rel, TgtB);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_query_match_new_table_not_indexed() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_query_t *q = ecs_query_new(world, "TagA || TagB");
+    test_assert(q != NULL);
+
+    ecs_entity_t e1 = ecs_new(world, TagA);
+    ecs_entity_t e2 = ecs_new(world, TagB);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    /* Make sure query is no longer notified */
+    ecs_entity_t e3 = ecs_new(world, TagA);
+    ecs_add(world, e3, TagB);
+
+    ecs_fini(world);
+}
+
+void Query_query_trivial_2_tables() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_set(world, e2, Velocity, {3, 4});
+    ecs_add(world, e2, Tag);
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {50, 60});
+    ecs_set(world, e3, Velocity, {5, 6});
+    ecs_add(world, e3, Tag);
+
+    ecs_query_t *q = ecs_query_new(world, "Position, Velocity");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_uint(ecs_field_id(&it, 1), ecs_id(Position));
+    test_uint(ecs_field_id(&it, 2), ecs_id(Velocity));
+    test_uint(ecs_field_src(&it, 1), 0);
+    test_bool(ecs_field_is_self(&it, 1), true);
+    Position *p = ecs_field(&it, Position, 1);
+    Velocity *v = ecs_field(&it, Velocity, 2);
+    test_int(p[0].x, 10); test_int(p[0].y, 20);
+    test_int(v[0].x, 1); test_int(v[0].y, 2);
+
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_int(it.frame_offset, 1);
+    test_uint(it.entities[0], e2);
+    test_uint(it.entities[1], e3);
+    p = ecs_field(&it, Position, 1);
+    v = ecs_field(&it, Velocity, 2);
+    test_int(p[0].x, 30); test_int(p[0].y, 40);
+    test_int(p[1].x, 50); test_int(p[1].y, 60);
+    test_int(v[0].x, 3); test_int(v[0].y, 4);
+    test_int(v[1].x, 5); test_int(v[1].y, 6);
+
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_query_trivial_w_tag() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_add(world, e1, Tag);
+
+    ecs_query_t *q = ecs_query_new(world, "Tag, Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_assert(ecs_field_w_size(&it, 0, 1) == NULL);
+    test_int(ecs_field_size(&it, 1), 0);
+    test_int(ecs_field_size(&it, 2), ECS_SIZEOF(Position));
+    Position *p = ecs_field(&it, Position, 2);
+    test_int(p[0].x, 10); test_int(p[0].y, 20);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_query_trivial_inherited_after_match() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(false, ecs_query_next(&it));
+
+    /* Matching a table that inherits the component requires a reference, which
+     * switches the query to the regular iterator */
+    ecs_entity_t base = ecs_set(world, 0, Position, {30, 40});
+    ecs_add(world, base, Tag);
+    ecs_entity_t e2 = ecs_new_w_pair(world, EcsIsA, base);
+
+    it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(ecs_field_is_self(&it, 1), true);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], base);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_uint(ecs_field_src(&it, 1), base);
+    Position *p = ecs_field(&it, Position, 1);
+    test_int(p[0].x, 30); test_int(p[0].y, 40);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_query_trivial_toggle_after_match() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_bool(false, ecs_query_next(&it));
+
+    /* Disabled components are stored in a bitset which the regular iterator
+     * tests for each result */
+    ecs_enable_component(world, e1, Position, false);
+    ecs_enable_component(world, e2, Position, true);
+
+    it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    Position *p = ecs_field(&it, Position, 1);
+    test_int(p[0].x, 30); test_int(p[0].y, 40);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_query_trivial_changed() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_query_t *q_read = ecs_query_new(world, "[in] Position");
+    ecs_query_t *q_write = ecs_query_new(world, "[out] Position");
+    test_assert(q_read != NULL);
+    test_assert(q_write != NULL);
+
+    test_bool(true, ecs_query_changed(q_read, NULL));
+    ecs_iter_t it = ecs_query_iter(world, q_read);
+    while (ecs_query_next(&it)) { }
+    test_bool(false, ecs_query_changed(q_read, NULL));
+
+    it = ecs_query_iter(world, q_write);
+    test_bool(true, ecs_query_next(&it));
+    test_uint(it.entities[0], e1);
+    test_bool(false, ecs_query_next(&it));
+
+    test_bool(true, ecs_query_changed(q_read, NULL));
+    it = ecs_query_iter(world, q_read);
+    while (ecs_query_next(&it)) { }
+    test_bool(false, ecs_query_changed(q_read, NULL));
+
+    ecs_fini(world);
+}
+
+void Query_query_prefetch() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_set(world, e2, Velocity, {3, 4});
+    ecs_add(world, e2, TagA);
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {50, 60});
+    ecs_set(world, e3, Velocity, {5, 6});
+    ecs_add(world, e3, TagB);
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.expr = "Position, Velocity",
+        .prefetch = true
+    });
+    test_assert(q != NULL);
+
+    ecs_entity_t expect[] = {e1, e2, e3};
+    int32_t count = 0;
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_field(&it, Position, 1);
+        Velocity *v = ecs_field(&it, Velocity, 2);
+        test_int(it.count, 1);
+        test_assert(count < 3);
+        test_uint(it.entities[0], expect[count]);
+        test_int(p[0].x, 10 + count * 20);
+        test_int(v[0].x, 1 + count * 2);
+        count ++;
+    }
+    test_int(count, 3);
+
+    ecs_fini(world);
+}
+
+void Query_query_prefetch_w_optional() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_set(world, e2, Velocity, {3, 4});
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.expr = "Position, ?Velocity",
+        .prefetch = true
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(ecs_field_is_set(&it, 2), false);
+    Position *p = ecs_field(&it, Position, 1);
+    test_int(p[0].x, 10);
+
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_bool(ecs_field_is_set(&it, 2), true);
+    p = ecs_field(&it, Position, 1);
+    Velocity *v = ecs_field(&it, Velocity, 2);
+    test_int(p[0].x, 30);
+    test_int(v[0].x, 3);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_query_max_batch() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[10];
+    for (int i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.expr = "Position",
+        .max_batch = 4
+    });
+    test_assert(q != NULL);
+
+    int32_t counts[] = {4, 4, 2};
+    int32_t i, r = 0, row = 0;
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        test_assert(r < 3);
+        test_int(it.count, counts[r]);
+        test_int(it.offset, row);
+        Position *p = ecs_field(&it, Position, 1);
+        for (i = 0; i < it.count; i ++) {
+            test_uint(it.entities[i], e[row + i]);
+            test_int(p[i].x, row + i);
+            test_int(p[i].y, (row + i) * 2);
+        }
+        row += it.count;
+        r ++;
+    }
+    test_int(r, 3);
+    test_int(row, 10);
+
+    ecs_fini(world);
+}
+
+void Query_query_max_batch_2_tables() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    for (int i = 0; i < 3; i ++) {
+        ecs_set(world, 0, Position, {i, 0});
+    }
+    for (int i = 0; i < 5; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {i, 0});
+        ecs_add(world, e, Tag);
+    }
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.expr = "Position, ?Tag",
+        .max_batch = 2
+    });
+    test_assert(q != NULL);
+
+    int32_t counts[] = {2, 1, 2, 2, 1};
+    int32_t i, r = 0;
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        test_assert(r < 5);
+        test_int(it.count, counts[r]);
+        test_bool(ecs_field_is_set(&it, 2), r >= 2);
+        Position *p = ecs_field(&it, Position, 1);
+        for (i = 0; i < it.count; i ++) {
+            test_int(p[i].x, it.offset + i);
+        }
+        r ++;
+    }
+    test_int(r, 5);
+
+    ecs_fini(world);
+}
+
+void Query_query_max_batch_w_page_iter() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[10];
+    for (int i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+    }
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.expr = "Position",
+        .max_batch = 4
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t qit = ecs_query_iter(world, q);
+    ecs_iter_t it = ecs_page_iter(&qit, 3, 6);
+
+    int32_t i, row = 3;
+    while (ecs_page_next(&it)) {
+        Position *p = ecs_field(&it, Position, 1);
+        for (i = 0; i < it.count; i ++) {
+            test_assert(row < 9);
+            test_uint(it.entities[i], e[row]);
+            test_int(p[i].x, row);
+            row ++;
+        }
+    }
+    test_int(row, 9);
+
+    ecs_fini(world);
+}
+
+void Query_query_max_batch_w_worker_iter() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    for (int i = 0; i < 10; i ++) {
+        ecs_set(world, 0, Position, {0, 0});
+    }
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.expr = "Position",
+        .max_batch = 4
+    });
+    test_assert(q != NULL);
+
+    int32_t w, i, total = 0;
+    for (w = 0; w < 2; w ++) {
+        ecs_iter_t qit = ecs_query_iter(world, q);
+        ecs_iter_t it = ecs_worker_iter(&qit, w, 2);
+        while (ecs_worker_next(&it)) {
+            test_assert(it.count <= 2);
+            Position *p = ecs_field(&it, Position, 1);
+            for (i = 0; i < it.count; i ++) {
+                p[i].x ++;
+                total ++;
+            }
+        }
+    }
+    test_int(total, 10);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_field(&it, Position, 1);
+        for (i = 0; i < it.count; i ++) {
+            test_int(p[i].x, 1);
+        }
+    }
+
+    ecs_fini(world);
+}
+
+void Query_query_max_batch_changed() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    for (int i = 0; i < 10; i ++) {
+        ecs_set(world, 0, Position, {0, 0});
+    }
+
+    ecs_query_t *q_read = ecs_query(world, {
+        .filter.expr = "[in] Position",
+        .max_batch = 4
+    });
+    ecs_query_t *q_write = ecs_query(world, {
+        .filter.expr = "[out] Position",
+        .max_batch = 4
+    });
+    test_assert(q_read != NULL);
+    test_assert(q_write != NULL);
+
+    test_bool(true, ecs_query_changed(q_read, NULL));
+    ecs_iter_t it = ecs_query_iter(world, q_read);
+    while (ecs_query_next(&it)) { 
+        test_bool(true, ecs_query_changed(NULL, &it));
+    }
+    test_bool(false, ecs_query_changed(q_read, NULL));
+
+    it = ecs_query_iter(world, q_write);
+    while (ecs_query_next(&it)) { }
+
+    test_bool(true, ecs_query_changed(q_read, NULL));
+    it = ecs_query_iter(world, q_read);
+    while (ecs_query_next(&it)) { 
+        test_bool(true, ecs_query_changed(NULL, &it));
+    }
+    test_bool(false, ecs_query_changed(q_read, NULL));
+
+    ecs_fini(world);
+}
+
+void Query_group_worker_2_workers() {
+    ecs_world_t* world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Rel);
+    ECS_TAG(world, TgtA);
+    ECS_TAG(world, TgtB);
+    ECS_TAG(world, TgtC);
+    ECS_TAG(world, TgtD);
+
+    ecs_entity_t tgts[] = {TgtA, TgtB, TgtC, TgtD};
+    for (int i = 0; i < 4; i ++) {
+        for (int j = 0; j < 3; j ++) {
+            ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+            ecs_add_pair(world, e, Rel, tgts[i]);
+        }
+    }
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position) }, { ecs_pair(Rel, EcsWildcard) }},
+        .group_by = group_by_rel,
+        .group_by_id = Rel
+    });
+
+    int32_t w, worker_of[4] = {-1, -1, -1, -1}, total = 0;
+    for (w = 0; w < 2; w ++) {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        ecs_query_set_group_worker(&it, w, 2);
+        int32_t count = 0;
+        while (ecs_query_next(&it)) {
+            int32_t g;
+            for (g = 0; g < 4; g ++) {
+                if (tgts[g] == it.group_id) {
+                    break;
+                }
+            }
+            test_assert(g < 4);
+            test_int(worker_of[g], -1);
+            worker_of[g] = w;
+            count += it.count;
+        }
+        test_int(count, 6);
+        total += count;
+    }
+    test_int(total, 12);
+    test_int(worker_of[0], 0);
+    test_int(worker_of[1], 0);
+    test_int(worker_of[2], 1);
+    test_int(worker_of[3], 1);
+
+    ecs_fini(world);
+}
+
+void Query_group_worker_unbalanced() {
+    ecs_world_t* world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Rel);
+    ECS_TAG(world, TgtA);
+    ECS_TAG(world, TgtB);
+    ECS_TAG(world, TgtC);
+    ECS_TAG(world, TgtD);
+
+    ecs_entity_t tgts[] = {TgtA, TgtB, TgtC, TgtD};
+    int32_t counts[] = {20, 2, 3, 4};
+    for (int i = 0; i < 4; i ++) {
+        for (int j = 0; j < counts[i]; j ++) {
+            ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+            ecs_add_pair(world, e, Rel, tgts[i]);
+        }
+    }
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position) }, { ecs_pair(Rel, EcsWildcard) }},
+        .group_by = group_by_rel,
+        .group_by_id = Rel
+    });
+
+    /* The large group is assigned to the first worker by itself */
+    ecs_iter_t it = ecs_query_iter(world, q);
+    ecs_query_set_group_worker(&it, 0, 2);
+    test_bool(true, ecs_query_next(&it));
+    test_uint(it.group_id, TgtA);
+    test_int(it.count, 20);
+    test_bool(false, ecs_query_next(&it));
+
+    it = ecs_query_iter(world, q);
+    ecs_query_set_group_worker(&it, 1, 2);
+    test_bool(true, ecs_query_next(&it));
+    test_uint(it.group_id, TgtB);
+    test_int(it.count, 2);
+    test_bool(true, ecs_query_next(&it));
+    test_uint(it.group_id, TgtC);
+    test_int(it.count, 3);
+    test_bool(true, ecs_query_next(&it));
+    test_uint(it.group_id, TgtD);
+    test_int(it.count, 4);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_group_worker_more_workers_than_groups() {
+    ecs_world_t* world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Rel);
+    ECS_TAG(world, TgtA);
+
+    for (int j = 0; j < 3; j ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+        ecs_add_pair(world, e, Rel, TgtA);
+    }
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position) }, { ecs_pair(Rel, EcsWildcard) }},
+        .group_by = group_by_rel,
+        .group_by_id = Rel
+    });
+
+    int32_t w, results = 0;
+    for (w = 0; w < 4; w ++) {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        ecs_query_set_group_worker(&it, w, 4);
+        while (ecs_query_next(&it)) {
+            test_uint(it.group_id, TgtA);
+            test_int(it.count, 3);
+            results ++;
+        }
+    }
+    test_int(results, 1);
+
+    ecs_fini(world);
+}
@@ -1140,6 +1140,28 @@ void Filter_flag_match_only_this(void);
 void Filter_flag_match_only_this_w_ref(void);
 void Filter_filter_w_alloc(void);
 void Filter_filter_w_short_notation(void);
+void Filter_filter_w_predicate_f32(void);
+void Filter_filter_w_predicate_mask(void);
+void Filter_filter_w_predicate_mask_none(void);
+void Filter_filter_w_predicate_no_match(void);
+void Filter_filter_w_predicate_2_terms(void);
+void Filter_filter_w_predicate_shared(void);
+void Filter_filter_w_predicate_range_across_blocks(void);
+void Filter_filter_w_predicate_mask_float(void);
+void Filter_filter_w_predicate_out_of_bounds(void);
+void Filter_filter_w_predicate_tag(void);
+void Filter_filter_w_predicate_not(void);
+void Filter_filter_intersect_n_tables(void);
+void Filter_filter_intersect_w_deleted_table(void);
+void Filter_filter_intersect_skip_prefab_disabled(void);
+void Filter_filter_intersect_w_isa(void);
+void Filter_filter_estimate_2_terms(void);
+void Filter_filter_estimate_not(void);
+void Filter_filter_estimate_no_match(void);
+void Filter_filter_estimate_no_this(void);
+void Filter_filter_estimate_w_up(void);
+void Filter_chain_iter_whole_tables(void);
+void Filter_chain_iter_row_range(void);
 
 // Testsuite 'FilterStr'
 void FilterStr_one_term(void);
@@ -1362,6 +1384,37 @@ void Query_query_next_table_w_populate_first_changed(void);
 void Query_query_next_table_w_populate_last_changed(void);
 void Query_query_next_table_w_populate_skip_first(void);
 void Query_query_next_table_w_populate_skip_last(void);
+void Query_query_w_predicate(void);
+void Query_query_w_predicate_2_tables(void);
+void Query_query_w_predicate_after_set(void);
+void Query_query_w_predicate_w_toggle(void);
+void Query_query_changed_rows(void);
+void Query_query_changed_rows_2_ranges(void);
+void Query_query_changed_rows_after_new(void);
+void Query_query_changed_rows_after_delete(void);
+void Query_query_changed_rows_after_modified(void);
+void Query_query_changed_rows_w_out_term(void);
+void Query_query_changed_rows_no_tracking(void);
+void Query_query_match_count_new_table(void);
+void Query_query_match_new_table_2_terms(void);
+void Query_query_match_new_table_inherited(void);
+void Query_query_match_new_table_wildcard(void);
+void Query_query_match_new_table_not_indexed(void);
+void Query_query_trivial_2_tables(void);
+void Query_query_trivial_w_tag(void);
+void Query_query_trivial_inherited_after_match(void);
+void Query_query_trivial_toggle_after_match(void);
+void Query_query_trivial_changed(void);
+void Query_query_prefetch(void);
+void Query_query_prefetch_w_optional(void);
+void Query_query_max_batch(void);
+void Query_query_max_batch_2_tables(void);
+void Query_query_max_batch_w_page_iter(void);
+void Query_query_max_batch_w_worker_iter(void);
+void Query_query_max_batch_changed(void);
+void Query_group_worker_2_workers(void);
+void Query_group_worker_unbalanced(void);
+void Query_group_worker_more_workers_than_groups(void);
 
 // Testsuite 'Iter'
 void Iter_page_iter_0_0(void);
@@ -1498,6 +1551,17 @@ void Pairs_oneof_other(void);
 void Pairs_oneof_self_constraint_violated(void);
 void Pairs_oneof_other_constraint_violated(void);
 void Pairs_oneof_other_rel_parent_constraint_violated(void);
+void Pairs_target_index_add(void);
+void Pairs_target_index_remove(void);
+void Pairs_target_index_multiple_sources(void);
+void Pairs_target_index_exclusive_replace(void);
+void Pairs_target_index_delete_source(void);
+void Pairs_target_index_delete_target(void);
+void Pairs_target_index_bulk_new(void);
+void Pairs_target_index_no_index(void);
+void Pairs_target_index_world_info(void);
+void Pairs_target_index_snapshot_restore(void);
+void Pairs_target_index_add_to_used_relationship(void);
 
 // Testsuite 'Trigger'
 void Trigger_on_add_trigger_before_table(void);
@@ -6626,6 +6690,94 @@ bake_test_case Filter_testcases[] = {
     {
         "filter_w_short_notation",
         Filter_filter_w_short_notation
+    },
+    {
+        "filter_w_predicate_f32",
+        Filter_filter_w_predicate_f32
+    },
+    {
+        "filter_w_predicate_mask",
+        Filter_filter_w_predicate_mask
+    },
+    {
+        "filter_w_predicate_mask_none",
+        Filter_filter_w_predicate_mask_none
+    },
+    {
+        "filter_w_predicate_no_match",
+        Filter_filter_w_predicate_no_match
+    },
+    {
+        "filter_w_predicate_2_terms",
+        Filter_filter_w_predicate_2_terms
+    },
+    {
+        "filter_w_predicate_shared",
+        Filter_filter_w_predicate_shared
+    },
+    {
+        "filter_w_predicate_range_across_blocks",
+        Filter_filter_w_predicate_range_across_blocks
+    },
+    {
+        "filter_w_predicate_mask_float",
+        Filter_filter_w_predicate_mask_float
+    },
+    {
+        "filter_w_predicate_out_of_bounds",
+        Filter_filter_w_predicate_out_of_bounds
+    },
+    {
+        "filter_w_predicate_tag",
+        Filter_filter_w_predicate_tag
+    },
+    {
+        "filter_w_predicate_not",
+        Filter_filter_w_predicate_not
+    },
+    {
+        "filter_intersect_n_tables",
+        Filter_filter_intersect_n_tables
+    },
+    {
+        "filter_intersect_w_deleted_table",
+        Filter_filter_intersect_w_deleted_table
+    },
+    {
+        "filter_intersect_skip_prefab_disabled",
+        Filter_filter_intersect_skip_prefab_disabled
+    },
+    {
+        "filter_intersect_w_isa",
+        Filter_filter_intersect_w_isa
+    },
+    {
+        "filter_estimate_2_terms",
+        Filter_filter_estimate_2_terms
+    },
+    {
+        "filter_estimate_not",
+        Filter_filter_estimate_not
+    },
+    {
+        "filter_estimate_no_match",
+        Filter_filter_estimate_no_match
+    },
+    {
+        "filter_estimate_no_this",
+        Filter_filter_estimate_no_this
+    },
+    {
+        "filter_estimate_w_up",
+        Filter_filter_estimate_w_up
+    },
+    {
+        "chain_iter_whole_tables",
+        Filter_chain_iter_whole_tables
+    },
+    {
+        "chain_iter_row_range",
+        Filter_chain_iter_row_range
     }
 };
 
@@ -7504,6 +7656,130 @@ bake_test_case Query_testcases[] = {
     {
         "query_next_table_w_populate_skip_last",
         Query_query_next_table_w_populate_skip_last
+    },
+    {
+        "query_w_predicate",
+        Query_query_w_predicate
+    },
+    {
+        "query_w_predicate_2_tables",
+        Query_query_w_predicate_2_tables
+    },
+    {
+        "query_w_predicate_after_set",
+        Query_query_w_predicate_after_set
+    },
+    {
+        "query_w_predicate_w_toggle",
+        Query_query_w_predicate_w_toggle
+    },
+    {
+        "query_changed_rows",
+        Query_query_changed_rows
+    },
+    {
+        "query_changed_rows_2_ranges",
+        Query_query_changed_rows_2_ranges
+    },
+    {
+        "query_changed_rows_after_new",
+        Query_query_changed_rows_after_new
+    },
+    {
+        "query_changed_rows_after_delete",
+        Query_query_changed_rows_after_delete
+    },
+    {
+        "query_changed_rows_after_modified",
+        Query_query_changed_rows_after_modified
+    },
+    {
+        "query_changed_rows_w_out_term",
+        Query_query_changed_rows_w_out_term
+    },
+    {
+        "query_changed_rows_no_tracking",
+        Query_query_changed_rows_no_tracking
+    },
+    {
+        "query_match_count_new_table",
+        Query_query_match_count_new_table
+    },
+    {
+        "query_match_new_table_2_terms",
+        Query_query_match_new_table_2_terms
+    },
+    {
+        "query_match_new_table_inherited",
+        Query_query_match_new_table_inherited
+    },
+    {
+        "query_match_new_table_wildcard",
+        Query_query_match_new_table_wildcard
+    },
+    {
+        "query_match_new_table_not_indexed",
+        Query_query_match_new_table_not_indexed
+    },
+    {
+        "query_trivial_2_tables",
+        Query_query_trivial_2_tables
+    },
+    {
+        "query_trivial_w_tag",
+        Query_query_trivial_w_tag
+    },
+    {
+        "query_trivial_inherited_after_match",
+        Query_query_trivial_inherited_after_match
+    },
+    {
+        "query_trivial_toggle_after_match",
+        Query_query_trivial_toggle_after_match
+    },
+    {
+        "query_trivial_changed",
+        Query_query_trivial_changed
+    },
+    {
+        "query_prefetch",
+        Query_query_prefetch
+    },
+    {
+        "query_prefetch_w_optional",
+        Query_query_prefetch_w_optional
+    },
+    {
+        "query_max_batch",
+        Query_query_max_batch
+    },
+    {
+        "query_max_batch_2_tables",
+        Query_query_max_batch_2_tables
+    },
+    {
+        "query_max_batch_w_page_iter",
+        Query_query_max_batch_w_page_iter
+    },
+    {
+        "query_max_batch_w_worker_iter",
+        Query_query_max_batch_w_worker_iter
+    },
+    {
+        "query_max_batch_changed",
+        Query_query_max_batch_changed
+    },
+    {
+        "group_worker_2_workers",
+        Query_group_worker_2_workers
+    },
+    {
+        "group_worker_unbalanced",
+        Query_group_worker_unbalanced
+    },
+    {
+        "group_worker_more_workers_than_groups",
+        Query_group_worker_more_workers_than_groups
     }
 };
 
@@ -8038,6 +8314,50 @@ bake_test_case Pairs_testcases[] = {
     {
         "oneof_other_rel_parent_constraint_violated",
         Pairs_oneof_other_rel_parent_constraint_violated
+    },
+    {
+        "target_index_add",
+        Pairs_target_index_add
+    },
+    {
+        "target_index_remove",
+        Pairs_target_index_remove
+    },
+    {
+        "target_index_multiple_sources",
+        Pairs_target_index_multiple_sources
+    },
+    {
+        "target_index_exclusive_replace",
+        Pairs_target_index_exclusive_replace
+    },
+    {
+        "target_index_delete_source",
+        Pairs_target_index_delete_source
+    },
+    {
+        "target_index_delete_target",
+        Pairs_target_index_delete_target
+    },
+    {
+        "target_index_bulk_new",
+        Pairs_target_index_bulk_new
+    },
+    {
+        "target_index_no_index",
+        Pairs_target_index_no_index
+    },
+    {
+        "target_index_world_info",
+        Pairs_target_index_world_info
+    },
+    {
+        "target_index_snapshot_restore",
+        Pairs_target_index_snapshot_restore
+    },
+    {
+        "target_index_add_to_used_relationship",
+        Pairs_target_index_add_to_used_relationship
     }
 };
 
@@ -11155,7 +11475,7 @@ static bake_test_suite suites[] = {
         "Filter",
         NULL,
         NULL,
-        245,
+        267,
         Filter_testcases
     },
     {
@@ -11169,7 +11489,7 @@ static bake_test_suite suites[] = {
         "Query",
         NULL,
         NULL,
-        199,
+        230,
         Query_testcases
     },
     {
@@ -11183,7 +11503,7 @@ static bake_test_suite suites[] = {
         "Pairs",
         NULL,
         NULL,
-        100,
+        111,
         Pairs_testcases
     },
     {
@@ -304,3 +304,33 @@ void Strbuf_append_inf_delim() {
         ecs_os_free(str);
     }
 }
+
+void Strbuf_merge_large() {
+    ecs_strbuf_t b1 = ECS_STRBUF_INIT;
+    ecs_strbuf_t b2 = ECS_STRBUF_INIT;
+    ecs_strbuf_t expect = ECS_STRBUF_INIT;
+
+    for (int i = 0; i < 1000; i ++) {
+        ecs_strbuf_append(&b1, "%d,", i);
+        ecs_strbuf_append(&expect, "%d,", i);
+    }
+    for (int i = 1000; i < 2000; i ++) {
+        ecs_strbuf_append(&b2, "%d,", i);
+        ecs_strbuf_append(&expect, "%d,", i);
+    }
+
+    ecs_strbuf_mergebuff(&b1, &b2);
+    ecs_strbuf_appendstr(&b1, "end");
+    ecs_strbuf_appendstr(&expect, "end");
+
+    test_int(ecs_strbuf_written(&b1), ecs_strbuf_written(&expect));
+
+    char *str = ecs_strbuf_get(&b1);
+    char *expect_str = ecs_strbuf_get(&expect);
+    test_str(str, expect_str);
+    ecs_os_free(str);
+    ecs_os_free(expect_str);
+
+    str = ecs_strbuf_get(&b2);
+    test_assert(str == NULL);
+}
@@ -112,6 +112,7 @@ void Strbuf_append_nan(void);
 void Strbuf_append_inf(void);
 void Strbuf_append_nan_delim(void);
 void Strbuf_append_inf_delim(void);
+void Strbuf_merge_large(void);
 
 bake_test_case Vector_testcases[] = {
     {
@@ -494,6 +495,10 @@ bake_test_case Strbuf_testcases[] = {
     {
         "append_inf_delim",
         Strbuf_append_inf_delim
+    },
+    {
+        "merge_large",
+        Strbuf_merge_large
     }
 };
 
@@ -523,7 +528,7 @@ static bake_test_suite suites[] = {
         "Strbuf",
         Strbuf_setup,
         NULL,
-        23,
+        24,
         Strbuf_testcases
     }
 };
@@ -0,0 +1,913 @@
+#include <meta.h>
+
+typedef struct Health {
+    int32_t value;
+} Health;
+
+typedef struct Speed {
+    float value;
+} Speed;
+
+static
+ecs_entity_t health_index(
+    ecs_world_t *world,
+    ecs_entity_t health,
+    ecs_member_index_kind_t kind)
+{
+    ecs_entity_t t = ecs_struct(world, {
+        .entity = health,
+        .members = {
+            {"value", ecs_id(ecs_i32_t)}
+        }
+    });
+    test_assert(t == health);
+
+    ecs_entity_t m = ecs_lookup_child(world, t, "value");
+    test_assert(m != 0);
+
+    ecs_entity_t index = ecs_member_index(world, {
+        .member = m,
+        .kind = kind
+    });
+    test_assert(index != 0);
+
+    return index;
+}
+
+static
+bool has_entity(
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_entity_t e)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        if (entities[i] == e) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MemberIndex_sorted_find_eq() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {20});
+    ecs_entity_t e3 = ecs_set(world, 0, Health, {10});
+
+    int32_t v = 10, count;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, &v, &v, &count);
+    test_int(count, 2);
+    test_assert(has_entity(result, count, e1));
+    test_assert(has_entity(result, count, e3));
+
+    v = 20;
+    result = ecs_member_index_find(world, index, &v, &v, &count);
+    test_int(count, 1);
+    test_uint(result[0], e2);
+
+    v = 30;
+    result = ecs_member_index_find(world, index, &v, &v, &count);
+    test_int(count, 0);
+    test_assert(result == NULL);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_sorted_find_range() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {5});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {15});
+    ecs_entity_t e3 = ecs_set(world, 0, Health, {25});
+    ecs_entity_t e4 = ecs_set(world, 0, Health, {10});
+
+    int32_t min = 5, max = 15, count;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, &min, &max, &count);
+    test_int(count, 3);
+    test_uint(result[0], e1);
+    test_uint(result[1], e4);
+    test_uint(result[2], e2);
+
+    min = 11; max = 100;
+    result = ecs_member_index_find(world, index, &min, &max, &count);
+    test_int(count, 2);
+    test_uint(result[0], e2);
+    test_uint(result[1], e3);
+
+    min = 16; max = 24;
+    result = ecs_member_index_find(world, index, &min, &max, &count);
+    test_int(count, 0);
+    test_assert(result == NULL);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_sorted_find_unbounded() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {5});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {15});
+    ecs_entity_t e3 = ecs_set(world, 0, Health, {25});
+
+    int32_t v = 10, count;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, NULL, &v, &count);
+    test_int(count, 1);
+    test_uint(result[0], e1);
+
+    result = ecs_member_index_find(world, index, &v, NULL, &count);
+    test_int(count, 2);
+    test_uint(result[0], e2);
+    test_uint(result[1], e3);
+
+    result = ecs_member_index_find(world, index, NULL, NULL, &count);
+    test_int(count, 3);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_sorted_find_negative() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {-10});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {0});
+    ecs_entity_t e3 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e4 = ecs_set(world, 0, Health, {-20});
+
+    int32_t min = -15, max = 5, count;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, &min, &max, &count);
+    test_int(count, 2);
+    test_uint(result[0], e1);
+    test_uint(result[1], e2);
+
+    result = ecs_member_index_find(world, index, NULL, NULL, &count);
+    test_int(count, 4);
+    test_uint(result[0], e4);
+    test_uint(result[1], e1);
+    test_uint(result[2], e2);
+    test_uint(result[3], e3);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_sorted_find_float() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Speed);
+
+    ecs_struct(world, {
+        .entity = ecs_id(Speed),
+        .members = {
+            {"value", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    ecs_entity_t index = ecs_member_index(world, {
+        .member = ecs_lookup_child(world, ecs_id(Speed), "value")
+    });
+    test_assert(index != 0);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Speed, {-1.5f});
+    ecs_entity_t e2 = ecs_set(world, 0, Speed, {0.25f});
+    ecs_entity_t e3 = ecs_set(world, 0, Speed, {-0.5f});
+    ecs_entity_t e4 = ecs_set(world, 0, Speed, {3.0f});
+
+    float min = -1.0f, max = 1.0f;
+    int32_t count;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, &min, &max, &count);
+    test_int(count, 2);
+    test_uint(result[0], e3);
+    test_uint(result[1], e2);
+
+    result = ecs_member_index_find(world, index, NULL, NULL, &count);
+    test_int(count, 4);
+    test_uint(result[0], e1);
+    test_uint(result[1], e3);
+    test_uint(result[2], e2);
+    test_uint(result[3], e4);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_sorted_update_value() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_entity_t e = ecs_set(world, 0, Health, {10});
+
+    int32_t v = 10, count;
+    test_assert(ecs_member_index_find(world, index, &v, &v, &count) != NULL);
+    test_int(count, 1);
+
+    ecs_set(world, e, Health, {20});
+    test_assert(ecs_member_index_find(world, index, &v, &v, &count) == NULL);
+    test_int(count, 0);
+
+    v = 20;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, &v, &v, &count);
+    test_int(count, 1);
+    test_uint(result[0], e);
+
+    Health *h = ecs_get_mut(world, e, Health);
+    h->value = 30;
+    ecs_modified(world, e, Health);
+
+    test_assert(ecs_member_index_find(world, index, &v, &v, &count) == NULL);
+    v = 30;
+    result = ecs_member_index_find(world, index, &v, &v, &count);
+    test_int(count, 1);
+    test_uint(result[0], e);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_sorted_remove_component() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {10});
+
+    ecs_remove(world, e1, Health);
+
+    int32_t v = 10, count;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, &v, &v, &count);
+    test_int(count, 1);
+    test_uint(result[0], e2);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_sorted_delete_entity() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {20});
+
+    ecs_delete(world, e1);
+
+    int32_t count;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, NULL, NULL, &count);
+    test_int(count, 1);
+    test_uint(result[0], e2);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_hash_find_eq() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexHash);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {20});
+    ecs_entity_t e3 = ecs_set(world, 0, Health, {10});
+
+    int32_t v = 10, count;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, &v, &v, &count);
+    test_int(count, 2);
+    test_assert(has_entity(result, count, e1));
+    test_assert(has_entity(result, count, e3));
+
+    v = 20;
+    result = ecs_member_index_find(world, index, &v, &v, &count);
+    test_int(count, 1);
+    test_uint(result[0], e2);
+
+    v = 30;
+    result = ecs_member_index_find(world, index, &v, &v, &count);
+    test_int(count, 0);
+    test_assert(result == NULL);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_hash_update_value() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexHash);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e3 = ecs_set(world, 0, Health, {10});
+
+    ecs_set(world, e1, Health, {20});
+
+    int32_t v = 10, count;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, &v, &v, &count);
+    test_int(count, 2);
+    test_assert(has_entity(result, count, e2));
+    test_assert(has_entity(result, count, e3));
+
+    v = 20;
+    result = ecs_member_index_find(world, index, &v, &v, &count);
+    test_int(count, 1);
+    test_uint(result[0], e1);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_hash_delete_entity() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexHash);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {10});
+
+    ecs_delete(world, e1);
+
+    int32_t v = 10, count;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, &v, &v, &count);
+    test_int(count, 1);
+    test_uint(result[0], e2);
+
+    ecs_delete(world, e2);
+    test_assert(ecs_member_index_find(world, index, &v, &v, &count) == NULL);
+    test_int(count, 0);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_populate_existing() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {20});
+
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    int32_t count;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, NULL, NULL, &count);
+    test_int(count, 2);
+    test_uint(result[0], e1);
+    test_uint(result[1], e2);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_delete_index() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_entity_t e = ecs_set(world, 0, Health, {10});
+    ecs_delete(world, index);
+
+    /* Index no longer receives events */
+    ecs_set(world, e, Health, {20});
+    test_int(ecs_get(world, e, Health)->value, 20);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_index_non_member() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+
+    ecs_log_set_level(-4);
+    ecs_entity_t index = ecs_member_index(world, {
+        .member = ecs_id(Health)
+    });
+    test_assert(index == 0);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_index_string_member() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct(world, {
+        .members = {
+            {"value", ecs_id(ecs_string_t)}
+        }
+    });
+
+    ecs_log_set_level(-4);
+    ecs_entity_t index = ecs_member_index(world, {
+        .member = ecs_lookup_child(world, t, "value")
+    });
+    test_assert(index == 0);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_iter() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ECS_TAG(world, Tag);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {11});
+    ecs_entity_t e3 = ecs_set(world, 0, Health, {12});
+    ecs_set(world, 0, Health, {13});
+    ecs_add(world, e3, Tag);
+
+    int32_t min = 10, max = 12;
+    ecs_iter_t it = ecs_member_index_iter(world, index, &min, &max);
+
+    test_bool(ecs_member_index_next(&it), true);
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e1);
+    test_uint(it.entities[1], e2);
+    test_assert(it.table == ecs_get_table(world, e1));
+
+    test_bool(ecs_member_index_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e3);
+    test_assert(it.table == ecs_get_table(world, e3));
+
+    test_bool(ecs_member_index_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_iter_chain_filter() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ECS_TAG(world, Tag);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {5});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {6});
+    ecs_entity_t e3 = ecs_set(world, 0, Health, {7});
+    ecs_entity_t e4 = ecs_set(world, 0, Health, {50});
+    ecs_add(world, e1, Tag);
+    ecs_add(world, e3, Tag);
+    ecs_add(world, e4, Tag);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Health) }, { Tag }}
+    });
+    test_assert(f != NULL);
+
+    int32_t max = 10;
+    ecs_iter_t it = ecs_member_index_iter(world, index, NULL, &max);
+    ecs_iter_t fit = ecs_filter_chain_iter(&it, f);
+
+    test_bool(ecs_filter_next(&fit), true);
+    test_int(fit.count, 1);
+    test_uint(fit.entities[0], e1);
+    Health *h = ecs_field(&fit, Health, 1);
+    test_int(h[0].value, 5);
+
+    test_bool(ecs_filter_next(&fit), true);
+    test_int(fit.count, 1);
+    test_uint(fit.entities[0], e3);
+    h = ecs_field(&fit, Health, 1);
+    test_int(h[0].value, 7);
+
+    test_bool(ecs_filter_next(&fit), false);
+    test_assert(e2 != 0);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_sorted_many() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    /* Enough entities to require multiple chunks */
+    int32_t i, count = 2000;
+    ecs_entity_t *entities = ecs_os_malloc_n(ecs_entity_t, count);
+    for (i = 0; i < count; i ++) {
+        entities[i] = ecs_set(world, 0, Health, {(i * 7919) % 1000});
+    }
+
+    /* Change values of some entities, delete others */
+    for (i = 0; i < count; i += 3) {
+        ecs_set(world, entities[i], Health, {(i * 31) % 1000});
+    }
+    for (i = 1; i < count; i += 5) {
+        ecs_delete(world, entities[i]);
+        entities[i] = 0;
+    }
+
+    int32_t min = 100, max = 899, result_count;
+    const ecs_entity_t *result = ecs_member_index_find(
+        world, index, &min, &max, &result_count);
+
+    int32_t expect = 0;
+    for (i = 0; i < count; i ++) {
+        if (entities[i]) {
+            const Health *h = ecs_get(world, entities[i], Health);
+            if (h->value >= min && h->value <= max) {
+                expect ++;
+                test_assert(has_entity(result, result_count, entities[i]));
+            }
+        }
+    }
+    test_int(result_count, expect);
+
+    /* Result must be ordered by value */
+    int32_t prev = min;
+    for (i = 0; i < result_count; i ++) {
+        const Health *h = ecs_get(world, result[i], Health);
+        test_assert(h->value >= prev);
+        test_assert(h->value <= max);
+        prev = h->value;
+    }
+
+    /* Iterator must return the same entities */
+    int32_t iter_count = 0;
+    ecs_iter_t it = ecs_member_index_iter(world, index, &min, &max);
+    while (ecs_member_index_next(&it)) {
+        for (int32_t j = 0; j < it.count; j ++) {
+            test_uint(it.entities[j], result[iter_count + j]);
+        }
+        iter_count += it.count;
+    }
+    test_int(iter_count, expect);
+
+    /* Remove all entities, index must be empty */
+    for (i = 0; i < count; i ++) {
+        if (entities[i]) {
+            ecs_remove(world, entities[i], Health);
+        }
+    }
+    test_assert(ecs_member_index_find(
+        world, index, NULL, NULL, &result_count) == NULL);
+    test_int(result_count, 0);
+
+    ecs_os_free(entities);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_filter_w_index() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ECS_TAG(world, Tag);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {5});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e3 = ecs_set(world, 0, Health, {7});
+    ecs_entity_t e4 = ecs_set(world, 0, Health, {3});
+    ecs_add(world, e1, Tag);
+    ecs_add(world, e2, Tag);
+    ecs_add(world, e3, Tag);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Health), .src.flags = EcsSelf, .predicate = {
+                .member = "value", .op = EcsPredicateLt, .value = 10,
+                .index = index
+            }}, 
+            { Tag }
+        }
+    });
+    test_assert(f != NULL);
+
+    /* Entities are returned in order of value */
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    Health *h = ecs_field(&it, Health, 1);
+    test_int(h[0].value, 5);
+
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e3);
+    h = ecs_field(&it, Health, 1);
+    test_int(h[0].value, 7);
+
+    test_bool(ecs_filter_next(&it), false);
+    test_assert(e4 != 0);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_filter_w_hash_index() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexHash);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {5});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e3 = ecs_set(world, 0, Health, {5});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Health), .src.flags = EcsSelf, .predicate = {
+                .member = "value", .op = EcsPredicateEq, .value = 5,
+                .index = index
+            }}
+        }
+    });
+    test_assert(f != NULL);
+
+    /* Consecutive rows are returned as a single result */
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e3);
+    test_bool(ecs_filter_next(&it), false);
+    test_assert(e2 != 0);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_filter_w_index_many() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    int32_t i, count = 1000;
+    for (i = 0; i < count; i ++) {
+        ecs_set(world, 0, Health, {i});
+    }
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Health), .src.flags = EcsSelf, .predicate = {
+                .member = "value", .op = EcsPredicateGtEq, .value = 990,
+                .index = index
+            }}
+        }
+    });
+    test_assert(f != NULL);
+
+    /* Entities with consecutive values are stored in consecutive rows, so the
+     * index yields a single range of rows */
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 10);
+    test_int(it.offset, 990);
+    Health *h = ecs_field(&it, Health, 1);
+    for (i = 0; i < it.count; i ++) {
+        test_int(h[i].value, 990 + i);
+    }
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_filter_w_index_exclusive() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_set(world, 0, Health, {9});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {10});
+    ecs_entity_t e3 = ecs_set(world, 0, Health, {11});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Health), .src.flags = EcsSelf, .predicate = {
+                .member = "value", .op = EcsPredicateGt, .value = 9,
+                .index = index
+            }}
+        }
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e2);
+    test_uint(it.entities[1], e3);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_filter_w_index_w_this_var() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ECS_TAG(world, Tag);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_set(world, 0, Health, {5});
+    ecs_entity_t e2 = ecs_set(world, 0, Health, {6});
+    ecs_entity_t e3 = ecs_set(world, 0, Health, {7});
+    ecs_add(world, e2, Tag);
+    ecs_add(world, e3, Tag);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Health), .src.flags = EcsSelf, .predicate = {
+                .member = "value", .op = EcsPredicateLt, .value = 7,
+                .index = index
+            }}
+        }
+    });
+    test_assert(f != NULL);
+
+    /* Constraining This falls back to table iteration */
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    ecs_iter_set_var_as_table(&it, 0, ecs_get_table(world, e2));
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_query_w_index() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Health, {5});
+    ecs_set(world, 0, Health, {10});
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {
+            { ecs_id(Health), .src.flags = EcsSelf, .predicate = {
+                .member = "value", .op = EcsPredicateLt, .value = 10,
+                .index = index
+            }}
+        }
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_filter_w_index_invalid_op() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Health), .src.flags = EcsSelf, .predicate = {
+                .member = "value", .op = EcsPredicateNeq, .value = 10,
+                .index = index
+            }}
+        }
+    });
+    test_assert(f == NULL);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_filter_w_hash_index_range() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexHash);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Health), .src.flags = EcsSelf, .predicate = {
+                .member = "value", .op = EcsPredicateLt, .value = 10,
+                .index = index
+            }}
+        }
+    });
+    test_assert(f == NULL);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_filter_w_index_other_component() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ECS_COMPONENT(world, Speed);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_struct(world, {
+        .entity = ecs_id(Speed),
+        .members = {
+            {"value", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Speed), .src.flags = EcsSelf, .predicate = {
+                .member = "value", .op = EcsPredicateLt, .value = 10,
+                .index = index
+            }}
+        }
+    });
+    test_assert(f == NULL);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_filter_w_index_up() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    ecs_entity_t index = health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Health), .predicate = {
+                .member = "value", .op = EcsPredicateLt, .value = 10,
+                .index = index
+            }}
+        }
+    });
+    test_assert(f == NULL);
+
+    ecs_fini(world);
+}
+
+void MemberIndex_rule_w_predicate() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Health);
+    health_index(world, ecs_id(Health), EcsMemberIndexSorted);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .terms = {
+            { ecs_id(Health), .predicate = {
+                .member = "value", .op = EcsPredicateLt, .value = 10
+            }}
+        }
+    });
+    test_assert(r == NULL);
+
+    ecs_fini(world);
+}
@@ -0,0 +1,315 @@
+#include <meta.h>
+
+typedef struct Point {
+    float x;
+    float y;
+} Point;
+
+typedef struct Line {
+    Point start;
+    Point stop;
+} Line;
+
+typedef struct Style {
+    int32_t color;
+    uint32_t toppings;
+    char *name;
+} Style;
+
+static
+void register_point(
+    ecs_world_t *world,
+    ecs_entity_t point)
+{
+    ecs_entity_t t = ecs_struct(world, {
+        .entity = point,
+        .members = {
+            {"x", ecs_id(ecs_f32_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+    test_assert(t == point);
+}
+
+static
+void register_style(
+    ecs_world_t *world,
+    ecs_entity_t style)
+{
+    ecs_entity_t color = ecs_enum(world, {
+        .constants = {{"Red"}, {"Green"}, {"Blue"}}
+    });
+    test_assert(color != 0);
+
+    ecs_entity_t toppings = ecs_bitmask(world, {
+        .constants = {{"Lettuce"}, {"Bacon"}, {"Tomato"}}
+    });
+    test_assert(toppings != 0);
+
+    ecs_entity_t t = ecs_struct(world, {
+        .entity = style,
+        .members = {
+            {"color", color},
+            {"toppings", toppings},
+            {"name", ecs_id(ecs_string_t)}
+        }
+    });
+    test_assert(t == style);
+}
+
+void Predicate_member_offset() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Point);
+    ECS_COMPONENT(world, Line);
+
+    register_point(world, ecs_id(Point));
+    ecs_struct(world, {
+        .entity = ecs_id(Line),
+        .members = {
+            {"start", ecs_id(Point)},
+            {"stop", ecs_id(Point)}
+        }
+    });
+
+    ecs_size_t offset = -1;
+    ecs_entity_t type = 0;
+    test_int(0, ecs_meta_member_offset(world, ecs_id(Point), "y", 
+        &offset, &type));
+    test_int(offset, offsetof(Point, y));
+    test_uint(type, ecs_id(ecs_f32_t));
+
+    test_int(0, ecs_meta_member_offset(world, ecs_id(Line), "stop.x", 
+        &offset, &type));
+    test_int(offset, offsetof(Line, stop.x));
+    test_uint(type, ecs_id(ecs_f32_t));
+
+    test_int(0, ecs_meta_member_offset(world, ecs_id(Line), "stop.y", 
+        &offset, &type));
+    test_int(offset, offsetof(Line, stop.y));
+
+    test_assert(0 != ecs_meta_member_offset(world, ecs_id(Line), "stop", 
+        &offset, &type));
+    test_assert(0 != ecs_meta_member_offset(world, ecs_id(Line), "stop.z", 
+        &offset, &type));
+    test_assert(0 != ecs_meta_member_offset(world, ecs_id(Line), "stop.x.y", 
+        &offset, &type));
+    test_assert(0 != ecs_meta_member_offset(world, ecs_id(Line), "", 
+        &offset, &type));
+
+    ecs_fini(world);
+}
+
+void Predicate_filter_member() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Point);
+    register_point(world, ecs_id(Point));
+
+    ecs_set(world, 0, Point, {10, -20});
+    ecs_entity_t e2 = ecs_set(world, 0, Point, {20, 30});
+    ecs_entity_t e3 = ecs_set(world, 0, Point, {30, 40});
+    ecs_set(world, 0, Point, {40, -50});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Point), .predicate = {
+            .member = "y",
+            .op = EcsPredicateGt,
+            .value = 0
+        }}}
+    });
+    test_assert(f != NULL);
+    test_int(f->terms[0].predicate.kind, EcsPredicateF32);
+    test_int(f->terms[0].predicate.offset, offsetof(Point, y));
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e2);
+    test_uint(it.entities[1], e3);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Predicate_filter_nested_member() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Point);
+    ECS_COMPONENT(world, Line);
+
+    register_point(world, ecs_id(Point));
+    ecs_struct(world, {
+        .entity = ecs_id(Line),
+        .members = {
+            {"start", ecs_id(Point)},
+            {"stop", ecs_id(Point)}
+        }
+    });
+
+    ecs_entity_t e1 = ecs_set(world, 0, Line, {{0, 0}, {10, 20}});
+    ecs_set(world, 0, Line, {{0, 0}, {30, 40}});
+    ecs_entity_t e3 = ecs_set(world, 0, Line, {{0, 0}, {10, 60}});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Line), .predicate = {
+            .member = "stop.x",
+            .op = EcsPredicateEq,
+            .value = 10
+        }}}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e3);
+    Line *l = ecs_field(&it, Line, 1);
+    test_int(l[0].stop.y, 60);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Predicate_filter_enum_member() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Style);
+    register_style(world, ecs_id(Style));
+
+    ecs_set(world, 0, Style, {0, 0, NULL});
+    ecs_entity_t e2 = ecs_set(world, 0, Style, {1, 0, NULL});
+    ecs_set(world, 0, Style, {2, 0, NULL});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Style), .predicate = {
+            .member = "color",
+            .op = EcsPredicateEq,
+            .value = 1
+        }}}
+    });
+    test_assert(f != NULL);
+    test_int(f->terms[0].predicate.kind, EcsPredicateI32);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Predicate_filter_bitmask_member() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Style);
+    register_style(world, ecs_id(Style));
+
+    ecs_entity_t e1 = ecs_set(world, 0, Style, {0, 1 | 4, NULL});
+    ecs_set(world, 0, Style, {0, 1, NULL});
+    ecs_entity_t e3 = ecs_set(world, 0, Style, {0, 1 | 2 | 4, NULL});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Style), .predicate = {
+            .member = "toppings",
+            .op = EcsPredicateMaskAll,
+            .mask = 1 | 4
+        }}}
+    });
+    test_assert(f != NULL);
+    test_int(f->terms[0].predicate.kind, EcsPredicateU32);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e3);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Predicate_filter_unknown_member() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Point);
+    register_point(world, ecs_id(Point));
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Point), .predicate = {
+            .member = "z",
+            .op = EcsPredicateGt
+        }}}
+    });
+    test_assert(f == NULL);
+
+    ecs_fini(world);
+}
+
+void Predicate_filter_string_member() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Style);
+    register_style(world, ecs_id(Style));
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Style), .predicate = {
+            .member = "name",
+            .op = EcsPredicateEq
+        }}}
+    });
+    test_assert(f == NULL);
+
+    ecs_fini(world);
+}
+
+void Predicate_query_member() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Point);
+    register_point(world, ecs_id(Point));
+
+    ecs_entity_t e1 = ecs_set(world, 0, Point, {10, -20});
+    ecs_set(world, 0, Point, {20, 30});
+    ecs_entity_t e3 = ecs_set(world, 0, Point, {30, -40});
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Point), .predicate = {
+            .member = "y",
+            .op = EcsPredicateLtEq,
+            .value = 0
+        }}}
+    });
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e3);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
@@ -0,0 +1,586 @@
+#include <meta.h>
+
+/* Convert CBOR to a JSON-like string so that tests can compare the structure */
+static
+const uint8_t* cbor_to_str(
+    const uint8_t *ptr,
+    ecs_strbuf_t *buf)
+{
+    uint8_t initial = *ptr ++;
+    uint8_t major = initial >> 5, info = initial & 31;
+    uint64_t value = info;
+    if (info >= 24 && info <= 27) {
+        int32_t i, count = 1 << (info - 24);
+        for (i = 0, value = 0; i < count; i ++) {
+            value = (value << 8) | *ptr ++;
+        }
+    }
+
+    bool indefinite = info == 31;
+    uint64_t i;
+    switch(major) {
+    case 0:
+        ecs_strbuf_append(buf, "%u", (uint32_t)value);
+        break;
+    case 1:
+        ecs_strbuf_append(buf, "-%u", (uint32_t)value + 1);
+        break;
+    case 2:
+        ecs_strbuf_append(buf, "h(%u)", (uint32_t)value);
+        ptr += value;
+        break;
+    case 3:
+        ecs_strbuf_appendch(buf, '"');
+        ecs_strbuf_appendstrn(buf, (const char*)ptr, (int32_t)value);
+        ecs_strbuf_appendch(buf, '"');
+        ptr += value;
+        break;
+    case 4:
+    case 5:
+        ecs_strbuf_appendch(buf, major == 4 ? '[' : '{');
+        for (i = 0; indefinite || i < value; i ++) {
+            if (indefinite && ptr[0] == 0xff) {
+                ptr ++;
+                break;
+            }
+            if (i) {
+                ecs_strbuf_appendlit(buf, ", ");
+            }
+            ptr = cbor_to_str(ptr, buf);
+            if (major == 5) {
+                ecs_strbuf_appendch(buf, ':');
+                ptr = cbor_to_str(ptr, buf);
+            }
+        }
+        ecs_strbuf_appendch(buf, major == 4 ? ']' : '}');
+        break;
+    case 6:
+        ecs_strbuf_append(buf, "%u", (uint32_t)value);
+        ptr = cbor_to_str(ptr, buf);
+        break;
+    case 7:
+        if (initial == 0xf4) {
+            ecs_strbuf_appendlit(buf, "false");
+        } else if (initial == 0xf5) {
+            ecs_strbuf_appendlit(buf, "true");
+        } else if (initial == 0xf6) {
+            ecs_strbuf_appendlit(buf, "null");
+        } else if (initial == 0xfa) {
+            uint32_t bits = (uint32_t)value;
+            float f;
+            memcpy(&f, &bits, 4);
+            ecs_strbuf_append(buf, "%gf", (double)f);
+        } else if (initial == 0xfb) {
+            double d;
+            memcpy(&d, &value, 8);
+            ecs_strbuf_append(buf, "%g", d);
+        }
+        break;
+    }
+
+    return ptr;
+}
+
+static
+char* cbor_str(
+    ecs_strbuf_t *cbor)
+{
+    char *data = ecs_strbuf_get(cbor);
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    cbor_to_str((const uint8_t*)data, &buf);
+    ecs_os_free(data);
+    return ecs_strbuf_get(&buf);
+}
+
+void SerializeToCbor_struct_int() {
+    typedef struct {
+        ecs_i32_t x;
+        ecs_i32_t y;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"y", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    T value = {500, -500};
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    test_int(ecs_ptr_to_cbor_buf(world, t, &value, &buf), 0);
+    test_int(ecs_strbuf_written(&buf), 12);
+
+    char *data = ecs_strbuf_get(&buf);
+    const uint8_t expect[] = {
+        0xbf, 0x61, 'x', 0x19, 0x01, 0xf4, 0x61, 'y', 0x39, 0x01, 0xf3, 0xff };
+    test_assert(!memcmp(data, expect, sizeof(expect)));
+
+    T result = {0};
+    test_assert(ecs_parse_cbor(world, data, 12, t, &result, 0) ==
+        (void*)&data[12]);
+    test_int(result.x, 500);
+    test_int(result.y, -500);
+    ecs_os_free(data);
+
+    ecs_fini(world);
+}
+
+void SerializeToCbor_struct_mixed() {
+    typedef struct {
+        ecs_bool_t a;
+        ecs_f64_t b;
+        ecs_string_t c;
+        ecs_entity_t d;
+        ecs_u64_t e;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"a", ecs_id(ecs_bool_t)},
+            {"b", ecs_id(ecs_f64_t)},
+            {"c", ecs_id(ecs_string_t)},
+            {"d", ecs_id(ecs_entity_t)},
+            {"e", ecs_id(ecs_u64_t)}
+        }
+    });
+
+    ecs_entity_t parent = ecs_new_entity(world, "Parent");
+    ecs_entity_t child = ecs_new_entity(world, "Parent.Child");
+
+    T value = {true, 10.5, "Hello World", child, UINT64_MAX};
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    test_int(ecs_ptr_to_cbor_buf(world, t, &value, &buf), 0);
+    ecs_size_t size = ecs_strbuf_written(&buf);
+
+    char *data = ecs_strbuf_get(&buf);
+    T result = {0};
+    test_assert(ecs_parse_cbor(world, data, size, t, &result, 0) != NULL);
+    test_bool(result.a, true);
+    test_flt(result.b, 10.5);
+    test_str(result.c, "Hello World");
+    test_uint(result.d, child);
+    test_uint(result.e, UINT64_MAX);
+    ecs_os_free(result.c);
+    ecs_os_free(data);
+
+    test_assert(parent != 0);
+
+    ecs_fini(world);
+}
+
+void SerializeToCbor_struct_enum_bitmask() {
+    typedef enum {
+        Red, Green, Blue
+    } Color;
+
+    typedef struct {
+        Color color;
+        uint32_t flags;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t color = ecs_enum_init(world, &(ecs_enum_desc_t){
+        .constants = {
+            {"Red"}, {"Green"}, {"Blue"}
+        }
+    });
+
+    ecs_entity_t flags = ecs_bitmask_init(world, &(ecs_bitmask_desc_t){
+        .constants = {
+            {"Bacon", 1}, {"Lettuce", 2}, {"Tomato", 4}
+        }
+    });
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"color", color},
+            {"flags", flags}
+        }
+    });
+
+    T value = {Blue, 1 | 4};
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    test_int(ecs_ptr_to_cbor_buf(world, t, &value, &buf), 0);
+    ecs_size_t size = ecs_strbuf_written(&buf);
+    char *data = ecs_strbuf_get(&buf);
+
+    T result = {0};
+    test_assert(ecs_parse_cbor(world, data, size, t, &result, 0) != NULL);
+    test_int(result.color, Blue);
+    test_uint(result.flags, 1 | 4);
+    ecs_os_free(data);
+
+    ecs_fini(world);
+}
+
+void SerializeToCbor_struct_nested() {
+    typedef struct {
+        Position start;
+        Position stop;
+        ecs_i32_t v[3];
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t pos = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "Position"}),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"y", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"start", pos},
+            {"stop", pos},
+            {"v", ecs_id(ecs_i32_t), 3}
+        }
+    });
+
+    T value = {{10, 20}, {30, 40}, {1, 2, 3}};
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    test_int(ecs_ptr_to_cbor_buf(world, t, &value, &buf), 0);
+    ecs_size_t size = ecs_strbuf_written(&buf);
+    char *data = ecs_strbuf_get(&buf);
+
+    T result = {{0}};
+    test_assert(ecs_parse_cbor(world, data, size, t, &result, 0) != NULL);
+    test_flt(result.start.x, 10);
+    test_flt(result.start.y, 20);
+    test_flt(result.stop.x, 30);
+    test_flt(result.stop.y, 40);
+    test_int(result.v[0], 1);
+    test_int(result.v[1], 2);
+    test_int(result.v[2], 3);
+
+    ecs_strbuf_appendbin(&buf, data, size);
+    char *str = cbor_str(&buf);
+    test_str(str, "{\"start\":{\"x\":10, \"y\":20}, "
+        "\"stop\":{\"x\":30, \"y\":40}, \"v\":[1, 2, 3]}");
+    ecs_os_free(str);
+    ecs_os_free(data);
+
+    ecs_fini(world);
+}
+
+void SerializeToCbor_array_packed() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t pos = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "Position"}),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"y", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    Position value[] = {{10, 20}, {30, 40}, {50, 60}};
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    test_int(ecs_array_to_cbor_buf(world, pos, value, 3, &buf), 0);
+
+    /* Tag, byte string header & data */
+    test_int(ecs_strbuf_written(&buf), 2 + 2 + 24);
+    char *data = ecs_strbuf_get(&buf);
+    test_int((uint8_t)data[0], 0xd8);
+    test_assert((uint8_t)data[1] == 74 || (uint8_t)data[1] == 78);
+    test_int((uint8_t)data[2], 0x58);
+    test_int((uint8_t)data[3], 24);
+    test_assert(!memcmp(&data[4], value, 24));
+
+    Position result[3] = {{0}};
+    test_assert(ecs_parse_cbor(world, data, 28, pos, result, 3) ==
+        (void*)&data[28]);
+    test_assert(!memcmp(result, value, 24));
+    ecs_os_free(data);
+
+    ecs_fini(world);
+}
+
+void SerializeToCbor_array_not_packed() {
+    typedef struct {
+        ecs_i32_t x;
+        ecs_f32_t y;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    T value[] = {{10, 20}, {30, 40}};
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    test_int(ecs_array_to_cbor_buf(world, t, value, 2, &buf), 0);
+    ecs_size_t size = ecs_strbuf_written(&buf);
+    char *data = ecs_strbuf_get(&buf);
+
+    T result[2] = {{0}};
+    test_assert(ecs_parse_cbor(world, data, size, t, result, 2) != NULL);
+    test_int(result[0].x, 10);
+    test_flt(result[0].y, 20);
+    test_int(result[1].x, 30);
+    test_flt(result[1].y, 40);
+
+    ecs_strbuf_appendbin(&buf, data, size);
+    char *str = cbor_str(&buf);
+    test_str(str, "[{\"x\":10, \"y\":20f}, {\"x\":30, \"y\":40f}]");
+    ecs_os_free(str);
+    ecs_os_free(data);
+
+    ecs_fini(world);
+}
+
+void SerializeToCbor_array_padding_not_packed() {
+    typedef struct {
+        ecs_i8_t x;
+        ecs_i32_t y;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_i8_t)},
+            {"y", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    ecs_entity_t u = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "U"}),
+        .members = {
+            {"x", ecs_id(ecs_i8_t)},
+            {"y", ecs_id(ecs_i8_t)}
+        }
+    });
+
+    T value[] = {{1, 2}};
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    test_int(ecs_array_to_cbor_buf(world, t, value, 1, &buf), 0);
+    char *str = cbor_str(&buf);
+    test_str(str, "[{\"x\":1, \"y\":2}]");
+    ecs_os_free(str);
+
+    /* Same kind without padding is packed */
+    ecs_i8_t packed[] = {1, -2, 3, -4};
+    test_int(ecs_array_to_cbor_buf(world, u, packed, 2, &buf), 0);
+    str = cbor_str(&buf);
+    test_str(str, "72h(4)");
+    ecs_os_free(str);
+
+    ecs_fini(world);
+}
+
+void SerializeToCbor_parse_swapped_endianness() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_u16_t)},
+            {"y", ecs_id(ecs_u16_t)}
+        }
+    });
+
+    /* Typed array with uint16 elements in the byte order of the other
+     * endianness */
+    uint16_t one = 1;
+    bool little = ((uint8_t*)&one)[0] == 1;
+    uint8_t data[] = {
+        0xd8, little ? 65 : 69, 0x44, 0x01, 0x02, 0x03, 0x04 };
+
+    uint16_t result[2] = {0};
+    test_assert(ecs_parse_cbor(world, data, 7, t, result, 1) != NULL);
+    if (little) {
+        test_uint(result[0], 0x0102);
+        test_uint(result[1], 0x0304);
+    } else {
+        test_uint(result[0], 0x0201);
+        test_uint(result[1], 0x0403);
+    }
+
+    ecs_fini(world);
+}
+
+void SerializeToCbor_parse_invalid() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t pos = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "Position"}),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"y", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    Position value = {10, 20};
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    test_int(ecs_ptr_to_cbor_buf(world, pos, &value, &buf), 0);
+    ecs_size_t size = ecs_strbuf_written(&buf);
+    char *data = ecs_strbuf_get(&buf);
+
+    ecs_log_set_level(-4);
+
+    /* Truncated data */
+    Position result;
+    test_assert(ecs_parse_cbor(world, data, size - 3, pos, &result, 0) == NULL);
+
+    /* Unknown member */
+    data[2] = 'z';
+    test_assert(ecs_parse_cbor(world, data, size, pos, &result, 0) == NULL);
+    ecs_os_free(data);
+
+    /* Element count mismatch */
+    Position values[2] = {{1, 2}, {3, 4}};
+    test_int(ecs_array_to_cbor_buf(world, pos, values, 2, &buf), 0);
+    size = ecs_strbuf_written(&buf);
+    data = ecs_strbuf_get(&buf);
+    test_assert(ecs_parse_cbor(world, data, size, pos, values, 1) == NULL);
+    ecs_os_free(data);
+
+    ecs_fini(world);
+}
+
+void SerializeToCbor_serialize_entity() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ECS_COMPONENT(world, Position);
+
+    ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_id(Position),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"y", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    ecs_entity_t base = ecs_new_entity(world, "Base");
+    ecs_add(world, base, TagA);
+
+    ecs_entity_t e = ecs_new_entity(world, "Parent.Foo");
+    ecs_add_pair(world, e, EcsIsA, base);
+    ecs_set(world, e, Position, {10, 20});
+
+    ecs_entity_to_json_desc_t desc = ECS_ENTITY_TO_JSON_INIT;
+    desc.serialize_values = true;
+
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    test_int(ecs_entity_to_cbor_buf(world, e, &buf, &desc), 0);
+    char *str = cbor_str(&buf);
+    test_str(str, "{"
+        "\"path\":\"Parent.Foo\", "
+        "\"is_a\":[{\"path\":\"Base\", \"ids\":[[\"TagA\"]], \"values\":[0]}], "
+        "\"ids\":[[\"Position\"]], "
+        "\"values\":[{\"x\":10, \"y\":20}]"
+        "}");
+    ecs_os_free(str);
+
+    ecs_fini(world);
+}
+
+void SerializeToCbor_serialize_iterator() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ECS_COMPONENT(world, Position);
+
+    ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_id(Position),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"y", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    ecs_entity_t e1 = ecs_set_name(world, 0, "Foo");
+    ecs_entity_t e2 = ecs_set_name(world, 0, "Bar");
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e2, Position, {30, 40});
+    ecs_add(world, e1, TagA);
+    ecs_add(world, e2, TagA);
+
+    ecs_query_t *q = ecs_query_new(world, "Position, ?TagA");
+    ecs_iter_t it = ecs_query_iter(world, q);
+
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    test_int(ecs_iter_to_cbor_buf(world, &it, &buf, NULL), 0);
+    char *str = cbor_str(&buf);
+
+    /* Position column is written as int32 typed array in host byte order */
+    uint16_t one = 1;
+    bool little = ((uint8_t*)&one)[0] == 1;
+    char *expect = ecs_asprintf("{"
+        "\"ids\":[\"Position\", \"TagA\"], "
+        "\"results\":[{"
+            "\"ids\":[\"Position\", \"TagA\"], "
+            "\"sources\":[0, 0], "
+            "\"is_set\":[true, true], "
+            "\"entities\":[\"Foo\", \"Bar\"], "
+            "\"values\":[%dh(16), 0]"
+        "}]"
+    "}", little ? 78 : 74);
+    test_str(str, expect);
+    ecs_os_free(expect);
+    ecs_os_free(str);
+
+    ecs_fini(world);
+}
+
+void SerializeToCbor_serialize_iterator_entity_ids() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+
+    ecs_entity_t e1 = ecs_new(world, TagA);
+    ecs_entity_t e2 = ecs_new(world, TagA);
+
+    ecs_query_t *q = ecs_query_new(world, "TagA");
+    ecs_iter_t it = ecs_query_iter(world, q);
+
+    ecs_iter_to_json_desc_t desc = {
+        .serialize_entity_ids = true
+    };
+
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    test_int(ecs_iter_to_cbor_buf(world, &it, &buf, &desc), 0);
+    ecs_size_t size = ecs_strbuf_written(&buf);
+    char *data = ecs_strbuf_get(&buf);
+
+    /* Entity ids are written as typed array of uint64 */
+    const char member[] = "\x6a" "entity_ids";
+    char *ptr = NULL;
+    ecs_size_t i;
+    for (i = 0; i < size - 11; i ++) {
+        if (!memcmp(&data[i], member, 11)) {
+            ptr = &data[i + 11];
+            break;
+        }
+    }
+
+    test_assert(ptr != NULL);
+    test_int((uint8_t)ptr[0], 0xd8);
+    test_assert((uint8_t)ptr[1] == 67 || (uint8_t)ptr[1] == 71);
+    test_int((uint8_t)ptr[2], 0x50);
+    ecs_entity_t ids[2];
+    memcpy(ids, &ptr[3], 16);
+    test_uint(ids[0], e1);
+    test_uint(ids[1], e2);
+    ecs_os_free(data);
+
+    ecs_fini(world);
+}
@@ -4140,3 +4140,375 @@ void SerializeToJson_serialize_paged_iterator_w_vars() {
 
     ecs_fini(world);
 }
+
+void SerializeToJson_serialize_iterator_w_threads() {
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_id(Position),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"y", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    /* Create tables with different sizes, so that threads get an uneven 
+     * number of results */
+    for (int i = 0; i < 100; i ++) {
+        ecs_entity_t tag = ecs_new_id(world);
+        for (int j = 0; j < (i % 7) * 10; j ++) {
+            char name[32];
+            ecs_os_sprintf(name, "e_%d_%d", i, j);
+            ecs_entity_t e = ecs_new_entity(world, name);
+            ecs_set(world, e, Position, {i, j});
+            ecs_add_id(world, e, tag);
+        }
+    }
+
+    ECS_TAG(world, Tag);
+    ecs_add(world, ecs_new(world, Position), Tag);
+
+    ecs_query_t *q = ecs_query_new(world, "Position, ?Tag");
+    ecs_iter_to_json_desc_t desc = ECS_ITER_TO_JSON_INIT;
+    desc.serialize_entity_ids = true;
+    desc.serialize_entity_labels = true;
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    char *expect = ecs_iter_to_json(world, &it, &desc);
+    test_assert(expect != NULL);
+
+    for (int t = 2; t <= 8; t ++) {
+        desc.threads = t;
+        it = ecs_query_iter(world, q);
+        char *json = ecs_iter_to_json(world, &it, &desc);
+        test_assert(json != NULL);
+        test_str(json, expect);
+        ecs_os_free(json);
+    }
+
+    ecs_os_free(expect);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_serialize_iterator_w_threads_vars() {
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Rel);
+
+    for (int i = 0; i < 20; i ++) {
+        char name[32];
+        ecs_os_sprintf(name, "tgt_%d", i);
+        ecs_entity_t tgt = ecs_new_entity(world, name);
+        ecs_os_sprintf(name, "src_%d", i);
+        ecs_entity_t src = ecs_new_entity(world, name);
+        ecs_add_pair(world, src, Rel, tgt);
+    }
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "(Rel, $X)"
+    });
+
+    ecs_iter_to_json_desc_t desc = ECS_ITER_TO_JSON_INIT;
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    char *expect = ecs_iter_to_json(world, &it, &desc);
+    test_assert(expect != NULL);
+
+    desc.threads = 4;
+    it = ecs_rule_iter(world, r);
+    char *json = ecs_iter_to_json(world, &it, &desc);
+    test_assert(json != NULL);
+    test_str(json, expect);
+
+    ecs_os_free(json);
+    ecs_os_free(expect);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_serialize_iterator_w_threads_empty() {
+    ecs_set_os_api_impl();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_iter_to_json_desc_t desc = ECS_ITER_TO_JSON_INIT;
+    desc.threads = 4;
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    char *json = ecs_iter_to_json(world, &it, &desc);
+    test_assert(json != NULL);
+    test_str(json, "{\"ids\":[\"Position\"], \"results\":[]}");
+    ecs_os_free(json);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_struct_w_program() {
+    typedef struct {
+        ecs_bool_t b;
+        ecs_i8_t i8;
+        ecs_u16_t u16;
+        ecs_i64_t i64;
+        ecs_u64_t u64;
+        ecs_f32_t f32;
+        ecs_f64_t f64;
+        ecs_string_t str;
+        ecs_entity_t e;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"b", ecs_id(ecs_bool_t)},
+            {"i8", ecs_id(ecs_i8_t)},
+            {"u16", ecs_id(ecs_u16_t)},
+            {"i64", ecs_id(ecs_i64_t)},
+            {"u64", ecs_id(ecs_u64_t)},
+            {"f32", ecs_id(ecs_f32_t)},
+            {"f64", ecs_id(ecs_f64_t)},
+            {"str", ecs_id(ecs_string_t)},
+            {"e", ecs_id(ecs_entity_t)}
+        }
+    });
+
+    const EcsMetaTypeSerialized *ser = ecs_get(world, t, EcsMetaTypeSerialized);
+    test_assert(ser != NULL);
+    test_assert(ser->json_ops != NULL);
+    test_int(ecs_vector_count(ser->json_ops), 10);
+
+    T value = {true, -10, 20, INT64_MIN, UINT64_MAX, 10.5, 
+        -20.5, "Hello \"World\"", t};
+    char *expr = ecs_ptr_to_json(world, t, &value);
+    test_assert(expr != NULL);
+    test_str(expr, "{\"b\":true, \"i8\":-10, \"u16\":20, "
+        "\"i64\":-9223372036854775808, \"u64\":18446744073709551615, "
+        "\"f32\":10.5, \"f64\":-20.5, \"str\":\"Hello \\\"World\\\"\", "
+        "\"e\":\"T\"}");
+    ecs_os_free(expr);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_struct_nested_w_program() {
+    typedef struct {
+        ecs_f32_t x;
+        ecs_f32_t y;
+    } N1;
+
+    typedef struct {
+        ecs_i32_t a;
+        N1 n_1;
+        N1 n_2;
+        ecs_i32_t b;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t n1 = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "N1"}),
+        .members = {
+            {"x", ecs_id(ecs_f32_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"a", ecs_id(ecs_i32_t)},
+            {"n_1", n1},
+            {"n_2", n1},
+            {"b", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    const EcsMetaTypeSerialized *ser = ecs_get(world, t, EcsMetaTypeSerialized);
+    test_assert(ser != NULL);
+    test_assert(ser->json_ops != NULL);
+    test_int(ecs_vector_count(ser->json_ops), 7);
+
+    T value[] = {
+        {10, {1, 2}, {3, 4}, 20},
+        {30, {5, 6}, {7, 8}, 40}
+    };
+
+    char *expr = ecs_array_to_json(world, t, value, 2);
+    test_assert(expr != NULL);
+    test_str(expr, "["
+        "{\"a\":10, \"n_1\":{\"x\":1, \"y\":2}, \"n_2\":{\"x\":3, \"y\":4}, \"b\":20}, "
+        "{\"a\":30, \"n_1\":{\"x\":5, \"y\":6}, \"n_2\":{\"x\":7, \"y\":8}, \"b\":40}"
+    "]");
+    ecs_os_free(expr);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_struct_w_enum_no_program() {
+    typedef enum {
+        Red, Blue, Green
+    } E;
+
+    typedef struct {
+        ecs_i32_t x;
+        E e;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t e = ecs_enum_init(world, &(ecs_enum_desc_t){
+        .entity = ecs_entity(world, {.name = "E"}),
+        .constants = {
+            {"Red"}, {"Blue"}, {"Green"}
+        }
+    });
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"e", e}
+        }
+    });
+
+    const EcsMetaTypeSerialized *ser = ecs_get(world, t, EcsMetaTypeSerialized);
+    test_assert(ser != NULL);
+    test_assert(ser->json_ops == NULL);
+
+    T value = {10, Blue};
+    char *expr = ecs_ptr_to_json(world, t, &value);
+    test_assert(expr != NULL);
+    test_str(expr, "{\"x\":10, \"e\":\"Blue\"}");
+    ecs_os_free(expr);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_struct_w_array_no_program() {
+    typedef struct {
+        ecs_i32_t x[2];
+        ecs_i32_t y;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_i32_t), 2},
+            {"y", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    const EcsMetaTypeSerialized *ser = ecs_get(world, t, EcsMetaTypeSerialized);
+    test_assert(ser != NULL);
+    test_assert(ser->json_ops == NULL);
+
+    T value = {{10, 20}, 30};
+    char *expr = ecs_ptr_to_json(world, t, &value);
+    test_assert(expr != NULL);
+    test_str(expr, "{\"x\":[10, 20], \"y\":30}");
+    ecs_os_free(expr);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_struct_w_vector_of_program() {
+    typedef struct {
+        ecs_i32_t x;
+        ecs_i32_t y;
+    } N1;
+
+    typedef struct {
+        ecs_vector_t *v;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t n1 = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "N1"}),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"y", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    ecs_entity_t vt = ecs_vector_init(world, &(ecs_vector_desc_t){
+        .entity = ecs_entity(world, {.name = "VN1"}),
+        .type = n1
+    });
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"v", vt}
+        }
+    });
+
+    const EcsMetaTypeSerialized *ser = ecs_get(world, n1, EcsMetaTypeSerialized);
+    test_assert(ser != NULL);
+    test_assert(ser->json_ops != NULL);
+
+    T value = {0};
+    N1 *elem = ecs_vector_add(&value.v, N1);
+    elem->x = 10; elem->y = 20;
+    elem = ecs_vector_add(&value.v, N1);
+    elem->x = 30; elem->y = 40;
+
+    char *expr = ecs_ptr_to_json(world, t, &value);
+    test_assert(expr != NULL);
+    test_str(expr, "{\"v\":[{\"x\":10, \"y\":20}, {\"x\":30, \"y\":40}]}");
+    ecs_os_free(expr);
+
+    ecs_vector_free(value.v);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_struct_w_program_long_literal() {
+    typedef struct {
+        ecs_i32_t x;
+        ecs_i32_t y;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"yyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyy"
+             "yyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyy"
+             "yyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyy"
+             "yyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyy", 
+                ecs_id(ecs_i32_t)}
+        }
+    });
+
+    const EcsMetaTypeSerialized *ser = ecs_get(world, t, EcsMetaTypeSerialized);
+    test_assert(ser != NULL);
+    test_assert(ser->json_ops != NULL);
+
+    T value = {10, 20};
+    char *expr = ecs_ptr_to_json(world, t, &value);
+    test_assert(expr != NULL);
+    test_str(expr, "{\"x\":10, \"yyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyy"
+             "yyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyy"
+             "yyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyy"
+             "yyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyy\":20}");
+    ecs_os_free(expr);
+
+    ecs_fini(world);
+}
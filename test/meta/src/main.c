@@ -580,6 +580,15 @@ void SerializeToJson_serialize_paged_iterator(void);
 void SerializeToJson_serialize_paged_iterator_w_optional_component(void);
 void SerializeToJson_serialize_paged_iterator_w_optional_tag(void);
 void SerializeToJson_serialize_paged_iterator_w_vars(void);
+void SerializeToJson_serialize_iterator_w_threads(void);
+void SerializeToJson_serialize_iterator_w_threads_vars(void);
+void SerializeToJson_serialize_iterator_w_threads_empty(void);
+void SerializeToJson_struct_w_program(void);
+void SerializeToJson_struct_nested_w_program(void);
+void SerializeToJson_struct_w_enum_no_program(void);
+void SerializeToJson_struct_w_array_no_program(void);
+void SerializeToJson_struct_w_vector_of_program(void);
+void SerializeToJson_struct_w_program_long_literal(void);
 
 // Testsuite 'SerializeTypeInfoToJson'
 void SerializeTypeInfoToJson_bool(void);
@@ -607,6 +616,20 @@ void SerializeTypeInfoToJson_struct_array_i32_2(void);
 void SerializeTypeInfoToJson_struct_array_struct_2(void);
 void SerializeTypeInfoToJson_struct_array_type(void);
 
+// Testsuite 'SerializeToCbor'
+void SerializeToCbor_struct_int(void);
+void SerializeToCbor_struct_mixed(void);
+void SerializeToCbor_struct_enum_bitmask(void);
+void SerializeToCbor_struct_nested(void);
+void SerializeToCbor_array_packed(void);
+void SerializeToCbor_array_not_packed(void);
+void SerializeToCbor_array_padding_not_packed(void);
+void SerializeToCbor_parse_swapped_endianness(void);
+void SerializeToCbor_parse_invalid(void);
+void SerializeToCbor_serialize_entity(void);
+void SerializeToCbor_serialize_iterator(void);
+void SerializeToCbor_serialize_iterator_entity_ids(void);
+
 // Testsuite 'MetaUtils'
 void MetaUtils_struct_w_2_i32(void);
 void MetaUtils_struct_w_2_bool(void);
@@ -735,6 +758,47 @@ void DeserExprOperators_mul_int_shift_left_int(void);
 void DeserExprOperators_add_int_shift_left_int_add_int(void);
 void DeserExprOperators_mul_int_shift_left_int_mul_int(void);
 
+// Testsuite 'MemberIndex'
+void MemberIndex_sorted_find_eq(void);
+void MemberIndex_sorted_find_range(void);
+void MemberIndex_sorted_find_unbounded(void);
+void MemberIndex_sorted_find_negative(void);
+void MemberIndex_sorted_find_float(void);
+void MemberIndex_sorted_update_value(void);
+void MemberIndex_sorted_remove_component(void);
+void MemberIndex_sorted_delete_entity(void);
+void MemberIndex_hash_find_eq(void);
+void MemberIndex_hash_update_value(void);
+void MemberIndex_hash_delete_entity(void);
+void MemberIndex_populate_existing(void);
+void MemberIndex_delete_index(void);
+void MemberIndex_index_non_member(void);
+void MemberIndex_index_string_member(void);
+void MemberIndex_iter(void);
+void MemberIndex_iter_chain_filter(void);
+void MemberIndex_sorted_many(void);
+void MemberIndex_filter_w_index(void);
+void MemberIndex_filter_w_hash_index(void);
+void MemberIndex_filter_w_index_many(void);
+void MemberIndex_filter_w_index_exclusive(void);
+void MemberIndex_filter_w_index_w_this_var(void);
+void MemberIndex_query_w_index(void);
+void MemberIndex_filter_w_index_invalid_op(void);
+void MemberIndex_filter_w_hash_index_range(void);
+void MemberIndex_filter_w_index_other_component(void);
+void MemberIndex_filter_w_index_up(void);
+void MemberIndex_rule_w_predicate(void);
+
+// Testsuite 'Predicate'
+void Predicate_member_offset(void);
+void Predicate_filter_member(void);
+void Predicate_filter_nested_member(void);
+void Predicate_filter_enum_member(void);
+void Predicate_filter_bitmask_member(void);
+void Predicate_filter_unknown_member(void);
+void Predicate_filter_string_member(void);
+void Predicate_query_member(void);
+
 bake_test_case PrimitiveTypes_testcases[] = {
     {
         "bool",
@@ -2954,6 +3018,42 @@ bake_test_case SerializeToJson_testcases[] = {
     {
         "serialize_paged_iterator_w_vars",
         SerializeToJson_serialize_paged_iterator_w_vars
+    },
+    {
+        "serialize_iterator_w_threads",
+        SerializeToJson_serialize_iterator_w_threads
+    },
+    {
+        "serialize_iterator_w_threads_vars",
+        SerializeToJson_serialize_iterator_w_threads_vars
+    },
+    {
+        "serialize_iterator_w_threads_empty",
+        SerializeToJson_serialize_iterator_w_threads_empty
+    },
+    {
+        "struct_w_program",
+        SerializeToJson_struct_w_program
+    },
+    {
+        "struct_nested_w_program",
+        SerializeToJson_struct_nested_w_program
+    },
+    {
+        "struct_w_enum_no_program",
+        SerializeToJson_struct_w_enum_no_program
+    },
+    {
+        "struct_w_array_no_program",
+        SerializeToJson_struct_w_array_no_program
+    },
+    {
+        "struct_w_vector_of_program",
+        SerializeToJson_struct_w_vector_of_program
+    },
+    {
+        "struct_w_program_long_literal",
+        SerializeToJson_struct_w_program_long_literal
     }
 };
 
@@ -3056,6 +3156,57 @@ bake_test_case SerializeTypeInfoToJson_testcases[] = {
     }
 };
 
+bake_test_case SerializeToCbor_testcases[] = {
+    {
+        "struct_int",
+        SerializeToCbor_struct_int
+    },
+    {
+        "struct_mixed",
+        SerializeToCbor_struct_mixed
+    },
+    {
+        "struct_enum_bitmask",
+        SerializeToCbor_struct_enum_bitmask
+    },
+    {
+        "struct_nested",
+        SerializeToCbor_struct_nested
+    },
+    {
+        "array_packed",
+        SerializeToCbor_array_packed
+    },
+    {
+        "array_not_packed",
+        SerializeToCbor_array_not_packed
+    },
+    {
+        "array_padding_not_packed",
+        SerializeToCbor_array_padding_not_packed
+    },
+    {
+        "parse_swapped_endianness",
+        SerializeToCbor_parse_swapped_endianness
+    },
+    {
+        "parse_invalid",
+        SerializeToCbor_parse_invalid
+    },
+    {
+        "serialize_entity",
+        SerializeToCbor_serialize_entity
+    },
+    {
+        "serialize_iterator",
+        SerializeToCbor_serialize_iterator
+    },
+    {
+        "serialize_iterator_entity_ids",
+        SerializeToCbor_serialize_iterator_entity_ids
+    }
+};
+
 bake_test_case MetaUtils_testcases[] = {
     {
         "struct_w_2_i32",
@@ -3553,6 +3704,160 @@ bake_test_case DeserExprOperators_testcases[] = {
     }
 };
 
+bake_test_case MemberIndex_testcases[] = {
+    {
+        "sorted_find_eq",
+        MemberIndex_sorted_find_eq
+    },
+    {
+        "sorted_find_range",
+        MemberIndex_sorted_find_range
+    },
+    {
+        "sorted_find_unbounded",
+        MemberIndex_sorted_find_unbounded
+    },
+    {
+        "sorted_find_negative",
+        MemberIndex_sorted_find_negative
+    },
+    {
+        "sorted_find_float",
+        MemberIndex_sorted_find_float
+    },
+    {
+        "sorted_update_value",
+        MemberIndex_sorted_update_value
+    },
+    {
+        "sorted_remove_component",
+        MemberIndex_sorted_remove_component
+    },
+    {
+        "sorted_delete_entity",
+        MemberIndex_sorted_delete_entity
+    },
+    {
+        "hash_find_eq",
+        MemberIndex_hash_find_eq
+    },
+    {
+        "hash_update_value",
+        MemberIndex_hash_update_value
+    },
+    {
+        "hash_delete_entity",
+        MemberIndex_hash_delete_entity
+    },
+    {
+        "populate_existing",
+        MemberIndex_populate_existing
+    },
+    {
+        "delete_index",
+        MemberIndex_delete_index
+    },
+    {
+        "index_non_member",
+        MemberIndex_index_non_member
+    },
+    {
+        "index_string_member",
+        MemberIndex_index_string_member
+    },
+    {
+        "iter",
+        MemberIndex_iter
+    },
+    {
+        "iter_chain_filter",
+        MemberIndex_iter_chain_filter
+    },
+    {
+        "sorted_many",
+        MemberIndex_sorted_many
+    },
+    {
+        "filter_w_index",
+        MemberIndex_filter_w_index
+    },
+    {
+        "filter_w_hash_index",
+        MemberIndex_filter_w_hash_index
+    },
+    {
+        "filter_w_index_many",
+        MemberIndex_filter_w_index_many
+    },
+    {
+        "filter_w_index_exclusive",
+        MemberIndex_filter_w_index_exclusive
+    },
+    {
+        "filter_w_index_w_this_var",
+        MemberIndex_filter_w_index_w_this_var
+    },
+    {
+        "query_w_index",
+        MemberIndex_query_w_index
+    },
+    {
+        "filter_w_index_invalid_op",
+        MemberIndex_filter_w_index_invalid_op
+    },
+    {
+        "filter_w_hash_index_range",
+        MemberIndex_filter_w_hash_index_range
+    },
+    {
+        "filter_w_index_other_component",
+        MemberIndex_filter_w_index_other_component
+    },
+    {
+        "filter_w_index_up",
+        MemberIndex_filter_w_index_up
+    },
+    {
+        "rule_w_predicate",
+        MemberIndex_rule_w_predicate
+    }
+};
+
+bake_test_case Predicate_testcases[] = {
+    {
+        "member_offset",
+        Predicate_member_offset
+    },
+    {
+        "filter_member",
+        Predicate_filter_member
+    },
+    {
+        "filter_nested_member",
+        Predicate_filter_nested_member
+    },
+    {
+        "filter_enum_member",
+        Predicate_filter_enum_member
+    },
+    {
+        "filter_bitmask_member",
+        Predicate_filter_bitmask_member
+    },
+    {
+        "filter_unknown_member",
+        Predicate_filter_unknown_member
+    },
+    {
+        "filter_string_member",
+        Predicate_filter_string_member
+    },
+    {
+        "query_member",
+        Predicate_query_member
+    }
+};
+
 static bake_test_suite suites[] = {
     {
         "PrimitiveTypes",
@@ -3649,7 +3954,7 @@ static bake_test_suite suites[] = {
         "SerializeToJson",
         NULL,
         NULL,
-        117,
+        126,
         SerializeToJson_testcases
     },
     {
@@ -3659,6 +3964,13 @@ static bake_test_suite suites[] = {
         24,
         SerializeTypeInfoToJson_testcases
     },
+    {
+        "SerializeToCbor",
+        NULL,
+        NULL,
+        12,
+        SerializeToCbor_testcases
+    },
     {
         "MetaUtils",
         NULL,
@@ -3679,9 +3991,23 @@ static bake_test_suite suites[] = {
         NULL,
         91,
         DeserExprOperators_testcases
+    },
+    {
+        "MemberIndex",
+        NULL,
+        NULL,
+        29,
+        MemberIndex_testcases
+    },
+    {
+        "Predicate",
+        NULL,
+        NULL,
+        8,
+        Predicate_testcases
     }
 };
 
 int main(int argc, char *argv[]) {
-    return bake_test_run("meta", argc, argv, suites, 18);
+    return bake_test_run("meta", argc, argv, suites, 21);
 }